@@ -20,6 +20,8 @@
 
 int	zbx_get_agent_protocol_version_int(const char *version_str);
 void	zbx_agent_prepare_request(struct zbx_json *j, const char *key, int timeout);
+void	zbx_agent_request_keep_alive(struct zbx_json *j, int keep_alive);
+int	zbx_agent_get_keep_alive(const char *buffer);
 int	zbx_agent_handle_response(char *buffer, size_t read_bytes, ssize_t received_len, const char *addr,
 		AGENT_RESULT *result, int *version);
 
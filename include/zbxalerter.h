@@ -79,9 +79,12 @@ typedef struct
 }
 zbx_thread_alert_manager_args;
 
+typedef void	(*zbx_add_problem_tags_f)(zbx_uint64_t eventid, const zbx_vector_tags_ptr_t *tags);
+
 typedef struct
 {
 	int			confsyncer_frequency;
+	zbx_add_problem_tags_f	add_problem_tags_cb;
 }
 zbx_thread_alert_syncer_args;
 
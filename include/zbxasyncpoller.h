@@ -25,6 +25,7 @@
 typedef enum
 {
 	ZBX_ASYNC_TASK_READ,
+	ZBX_ASYNC_TASK_READ_NEW_REQUEST,	/* wait for response to new request, restarting the timeout */
 	ZBX_ASYNC_TASK_WRITE,
 	ZBX_ASYNC_TASK_STOP,
 	ZBX_ASYNC_TASK_RESOLVE_REVERSE
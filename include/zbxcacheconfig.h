@@ -26,6 +26,7 @@
 #include "zbxautoreg.h"
 #include "zbxpgservice.h"
 #include "zbxalgo.h"
+#include "zbxcachevalue.h"
 
 #define	ZBX_NO_POLLER			255
 #define	ZBX_POLLER_TYPE_NORMAL		0
@@ -328,6 +329,8 @@ typedef struct _DC_TRIGGER
 	char			*event_name;
 	unsigned char		*expression_bin;
 	unsigned char		*recovery_expression_bin;
+	zbx_eval_code_t		*expression_code;
+	zbx_eval_code_t		*recovery_expression_code;
 	zbx_timespec_t		timespec;
 	int			lastchange;
 	unsigned char		topoindex;
@@ -823,6 +826,8 @@ void	zbx_dc_config_get_functions_by_functionids(zbx_dc_function_t *functions,
 void	zbx_dc_config_clean_functions(zbx_dc_function_t *functions, int *errcodes, size_t num);
 void	zbx_dc_config_clean_triggers(zbx_dc_trigger_t *triggers, int *errcodes, size_t num);
 
+void	zbx_dc_get_item_history_ranges(zbx_vector_vc_item_range_t *ranges, int process_num, int process_forks);
+
 typedef struct zbx_hc_data
 {
 	zbx_history_value_t	value;
@@ -1013,6 +1018,7 @@ void	zbx_dc_correlation_rules_get(zbx_correlation_rules_t *rules);
 
 void	zbx_dc_get_nested_hostgroupids(zbx_uint64_t *groupids, int groupids_num, zbx_vector_uint64_t *nested_groupids);
 void	zbx_dc_get_hostids_by_group_name(const char *name, zbx_vector_uint64_t *hostids);
+zbx_uint64_t	zbx_dc_get_item_query_revision(void);
 
 void	zbx_free_item_tag(zbx_item_tag_t *item_tag);
 
@@ -1081,6 +1087,7 @@ typedef struct
 	zbx_uint64_t	connector;
 	zbx_uint64_t	proxy_group;		/* summary revision of all proxy groups */
 	zbx_uint64_t	proxy;			/* summary revision of all proxies */
+	zbx_uint64_t	item_query;		/* revision of configuration used to resolve item queries */
 }
 zbx_dc_revision_t;
 
@@ -35,6 +35,9 @@
 #define ZBX_SYNC_DONE		0
 #define	ZBX_SYNC_MORE		1
 
+/* the maximum number of history cache shards, each shard has its own lock and shared memory segments */
+#define ZBX_HC_SHARDS_MAX	8
+
 typedef struct
 {
 	zbx_uint64_t	history_counter;	/* the total number of processed values */
@@ -119,6 +122,7 @@ void	zbx_dc_update_trends(zbx_vector_uint64_pair_t *trends_diff);
 void	zbx_db_flush_trends(ZBX_DC_TREND *trends, int *trends_num, zbx_vector_uint64_pair_t *trends_diff);
 void	zbx_dc_mass_update_trends(const zbx_dc_history_t *history, int history_num, ZBX_DC_TREND **trends,
 		int *trends_num, int compression_age);
+void	zbx_dc_get_due_trends(ZBX_DC_TREND **trends, int *trends_num);
 int	zbx_trend_compare(const void *d1, const void *d2);
 void	zbx_dc_export_history_and_trends(const zbx_dc_history_t *history, int history_num,
 		const zbx_vector_uint64_t *itemids, zbx_history_sync_item_t *items, const int *errcodes,
@@ -147,8 +151,8 @@ typedef void (*zbx_history_sync_f)(int *values_num, int *triggers_num, const zbx
 		zbx_ipc_async_socket_t *rtc, int config_history_storage_pipelines, int *more);
 
 int	zbx_init_database_cache(zbx_get_program_type_f get_program_type, zbx_history_sync_f sync_history,
-		zbx_uint64_t history_cache_size, zbx_uint64_t history_index_cache_size, zbx_uint64_t *trends_cache_size,
-		char **error);
+		zbx_uint64_t history_cache_size, zbx_uint64_t history_index_cache_size, int history_cache_shards,
+		zbx_uint64_t *trends_cache_size, int trends_flush_period, char **error);
 
 void	zbx_free_database_cache(int sync, const zbx_events_funcs_t *events_cbs, int config_history_storage_pipelines);
 
@@ -166,10 +170,8 @@ int	zbx_hc_proxyqueue_dequeue(zbx_uint64_t proxyid);
 void	zbx_hc_proxyqueue_clear(void);
 void	zbx_dbcache_lock(void);
 void	zbx_dbcache_unlock(void);
-void	zbx_dbcache_set_history_num(int num);
-int	zbx_dbcache_get_history_num(void);
 
-zbx_shmem_info_t	*zbx_dbcache_get_hc_mem(void);
+double	zbx_dbcache_get_hc_pused(void);
 
 void	zbx_dbcache_setproxyqueue_state(int proxyqueue_state);
 int	zbx_dbcache_getproxyqueue_state(void);
@@ -45,6 +45,16 @@
  *   either zbx_history_record_vector_destroy() function (free the zbx_vc_get_values()
  *   call output) or zbx_history_record_clear() function (free the zbx_vc_get_value() call output).
  *
+ *   Count, sum, average, minimum and maximum of numeric values can be calculated with
+ *   zbx_vc_get_aggregate() function without copying the values out of cache. The
+ *   zbx_vc_get_aggregates() function does the same for multiple items at once.
+ *
+ * Prefetching
+ *
+ *   On startup the history ranges required by trigger and calculated item functions can be
+ *   loaded into cache with zbx_vc_prefetch() function. The history is read with few range
+ *   queries covering many items instead of reading it item by item on the first request.
+ *
  * Locking
  *
  *   The cache ensures synchronization between processes by using automatic locks whenever
@@ -78,6 +88,24 @@ typedef struct
 }
 zbx_vc_stats_t;
 
+/* the aggregates of item values */
+typedef struct
+{
+	/* the number of aggregated values */
+	int			values_num;
+
+	/* the following fields are calculated only for numeric values and are valid if values_num is not 0 */
+	zbx_history_value_t	min;
+	zbx_history_value_t	max;
+
+	/* unsigned integer sum wraps around on overflow */
+	zbx_history_value_t	sum;
+
+	/* running average, calculated without summing values to avoid overflows */
+	double			avg;
+}
+zbx_vc_aggregate_t;
+
 /* item diagnostic statistics */
 typedef struct
 {
@@ -89,6 +117,19 @@ zbx_vc_item_stats_t;
 
 ZBX_PTR_VECTOR_DECL(vc_item_stats_ptr, zbx_vc_item_stats_t *)
 
+/* item history range to be loaded into cache */
+typedef struct
+{
+	zbx_uint64_t	itemid;
+	unsigned char	value_type;
+
+	/* the history period in seconds */
+	int		seconds;
+}
+zbx_vc_item_range_t;
+
+ZBX_VECTOR_DECL(vc_item_range, zbx_vc_item_range_t)
+
 void	zbx_vc_item_stats_free(zbx_vc_item_stats_t *vc_item_stats);
 
 int	zbx_vc_init(zbx_uint64_t value_cache_size, char **error);
@@ -107,6 +148,12 @@ int	zbx_vc_get_values(zbx_uint64_t itemid, unsigned char value_type, zbx_vector_
 int	zbx_vc_get_value(zbx_uint64_t itemid, unsigned char value_type, const zbx_timespec_t *ts,
 		zbx_history_record_t *value);
 
+int	zbx_vc_get_aggregate(zbx_uint64_t itemid, unsigned char value_type, int seconds, int count,
+		const zbx_timespec_t *ts, zbx_vc_aggregate_t *aggr);
+
+void	zbx_vc_get_aggregates(const zbx_uint64_t *itemids, const unsigned char *value_types, int items_num,
+		int seconds, int count, const zbx_timespec_t *ts, zbx_vc_aggregate_t *aggrs, int *errcodes);
+
 int	zbx_vc_add_values(zbx_vector_dc_history_ptr_t *history, int *ret_flush, int config_history_storage_pipelines);
 
 int	zbx_vc_get_statistics(zbx_vc_stats_t *stats);
@@ -120,4 +167,6 @@ void	zbx_vc_flush_stats(void);
 
 void	zbx_vc_add_new_items(const zbx_vector_uint64_pair_t *items);
 
+int	zbx_vc_prefetch(zbx_vector_vc_item_range_t *ranges);
+
 #endif
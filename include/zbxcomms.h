@@ -431,6 +431,7 @@ typedef size_t	(*zbx_find_psk_in_cache_f)(const unsigned char *, unsigned char *
 
 void	zbx_tls_init_child(const zbx_config_tls_t *config_tls, zbx_get_program_type_f zbx_get_program_type_cb_arg,
 		zbx_find_psk_in_cache_f zbx_find_psk_in_cache_cb_arg);
+void	zbx_tls_enable_session_resumption(void);
 
 void	zbx_tls_free(void);
 void	zbx_tls_free_on_signal(void);
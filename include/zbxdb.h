@@ -39,6 +39,15 @@ typedef union
 }
 zbx_db_value_t;
 
+/* prepared statement parameter */
+typedef struct
+{
+	/* ZBX_TYPE_INT, ZBX_TYPE_UINT, ZBX_TYPE_ID, ZBX_TYPE_FLOAT or ZBX_TYPE_CHAR */
+	unsigned char	type;
+	zbx_db_value_t	value;
+}
+zbx_db_param_t;
+
 typedef struct
 {
 	char	*config_dbhost;
@@ -54,6 +63,7 @@ typedef struct
 	char	*config_db_tls_cipher;
 	char	*config_db_tls_cipher_13;
 	int	config_dbport;
+	int	config_db_prepared_statements;
 }
 zbx_config_dbhigh_t;
 
@@ -84,6 +94,8 @@ int	zbx_db_rollback_basic(void);
 int	zbx_db_txn_level(void);
 int	zbx_db_txn_error(void);
 int	zbx_db_txn_end_error(void);
+void	zbx_db_batch_begin(void);
+void	zbx_db_batch_end(void);
 const char	*zbx_db_last_strerr(void);
 
 typedef enum
@@ -135,11 +147,13 @@ int		zbx_db_statement_execute(int iters);
 void	zbx_mysql_escape_bin(const char *src, char *dst, size_t size);
 #elif defined(HAVE_POSTGRESQL)
 void	zbx_postgresql_escape_bin(const char *src, char **dst, size_t size);
+int	zbx_db_copy_from(const char *sql, const char *data, size_t data_len);
 #endif
 
 int		zbx_db_vexecute(const char *fmt, va_list args);
 zbx_db_result_t	zbx_db_vselect(const char *fmt, va_list args);
 zbx_db_result_t	zbx_db_select_n_basic(const char *query, int n);
+zbx_db_result_t	zbx_db_select_prepared_basic(const char *sql, const zbx_db_param_t *params, int params_num, int n);
 
 int		zbx_db_get_row_num(zbx_db_result_t result);
 zbx_db_row_t		zbx_db_fetch_basic(zbx_db_result_t result);
@@ -504,6 +504,8 @@ int		zbx_db_execute_once(const char *fmt, ...) __zbx_attr_format_printf(1, 2);
 zbx_db_result_t	zbx_db_select_once(const char *fmt, ...)__zbx_attr_format_printf(1, 2);
 zbx_db_result_t	zbx_db_select(const char *fmt, ...) __zbx_attr_format_printf(1, 2);
 zbx_db_result_t	zbx_db_select_n(const char *query, int n);
+zbx_db_result_t	zbx_db_select_prepared(const char *sql, const zbx_db_param_t *params, int params_num);
+zbx_db_result_t	zbx_db_select_prepared_n(const char *sql, const zbx_db_param_t *params, int params_num, int n);
 zbx_db_row_t	zbx_db_fetch(zbx_db_result_t result);
 int		zbx_db_is_null(const char *field);
 void		zbx_db_begin(void);
@@ -623,6 +625,7 @@ typedef void	(*zbx_reset_event_recovery_func_t)(void);
 typedef void	(*zbx_export_events_func_t)(int events_export_enabled, zbx_vector_connector_filter_t *connector_filters,
 		unsigned char **data, size_t *data_alloc, size_t *data_offset);
 typedef void	(*zbx_events_update_itservices_func_t)(void);
+typedef void	(*zbx_events_update_problem_index_func_t)(void);
 
 typedef struct
 {
@@ -632,6 +635,7 @@ typedef struct
 	zbx_reset_event_recovery_func_t		reset_event_recovery_cb;
 	zbx_export_events_func_t		export_events_cb;
 	zbx_events_update_itservices_func_t	events_update_itservices_cb;
+	zbx_events_update_problem_index_func_t	events_update_problem_index_cb;
 } zbx_events_funcs_t;
 
 /* events callbacks end */
@@ -24,6 +24,7 @@ typedef struct
 	int				config_histsyncer_frequency;
 	int				config_timeout;
 	int				config_history_storage_pipelines;
+	zbx_get_config_forks_f		get_process_forks_cb_arg;
 }
 zbx_thread_dbsyncer_args;
 
@@ -224,6 +224,13 @@ void	zbx_eval_compose_expression(const zbx_eval_context_t *ctx, char **expressio
 int	zbx_eval_execute(zbx_eval_context_t *ctx, const zbx_timespec_t *ts, zbx_variant_t *value, char **error);
 int	zbx_eval_execute_ext(zbx_eval_context_t *ctx, const zbx_timespec_t *ts, zbx_eval_function_cb_t common_func_cb,
 		zbx_eval_function_cb_t history_func_cb, void *data, zbx_variant_t *value, char **error);
+
+typedef struct zbx_eval_code	zbx_eval_code_t;
+
+zbx_eval_code_t	*zbx_eval_compile(const zbx_eval_context_t *ctx, zbx_mem_malloc_func_t malloc_func);
+zbx_eval_code_t	*zbx_eval_code_dup(const zbx_eval_code_t *code);
+int	zbx_eval_execute_code(const zbx_eval_context_t *ctx, const zbx_eval_code_t *code, double *result);
+
 void	zbx_eval_get_functionids(zbx_eval_context_t *ctx, zbx_vector_uint64_t *functionids);
 void	zbx_eval_get_functionids_ordered(zbx_eval_context_t *ctx, zbx_vector_uint64_t *functionids);
 int	zbx_eval_expand_user_macros(const zbx_eval_context_t *ctx, const zbx_uint64_t *hostids, int hostids_num,
@@ -24,6 +24,7 @@ typedef struct
 	zbx_get_config_str_f	get_fping6_location;
 	zbx_get_config_str_f	get_tmpdir;
 	zbx_get_progname_f	get_progname;
+	zbx_get_config_int_f	get_native_ping;	/* optional, ping using in-process ICMP sockets if set */
 }
 zbx_config_icmpping_t;
 
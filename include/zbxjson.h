@@ -146,6 +146,7 @@
 #define ZBX_PROTO_TAG_MAX_REPS			"max_repetitions"
 #define ZBX_PROTO_TAG_IPMI_SENSOR		"ipmi_sensor"
 #define ZBX_PROTO_TAG_TIMEOUT			"timeout"
+#define ZBX_PROTO_TAG_KEEP_ALIVE		"keep_alive"
 #define ZBX_PROTO_TAG_URL			"url"
 #define ZBX_PROTO_TAG_QUERY_FIELDS		"query_fields"
 #define ZBX_PROTO_TAG_POSTS			"posts"
@@ -394,6 +395,8 @@ typedef struct zbx_jsonpath_index zbx_jsonpath_index_t;
 int	zbx_jsonpath_compile(const char *path, zbx_jsonpath_t *jsonpath);
 int	zbx_jsonpath_query(const struct zbx_json_parse *jp, const char *path, char **output);
 int	zbx_jsonobj_query_ext(zbx_jsonobj_t *obj, zbx_jsonpath_index_t *index, const char *path, char **output);
+int	zbx_jsonobj_query_path(zbx_jsonobj_t *obj, zbx_jsonpath_index_t *index, zbx_jsonpath_t *jsonpath,
+		char **output);
 void	zbx_jsonpath_clear(zbx_jsonpath_t *jsonpath);
 
 zbx_jsonpath_index_t	*zbx_jsonpath_index_create(char **error);
@@ -52,6 +52,16 @@ typedef enum
 	ZBX_MUTEX_REMOTE_COMMANDS,
 	ZBX_MUTEX_PROXY_BUFFER,
 	ZBX_MUTEX_VPS_MONITOR,
+	/* history cache shards, the first shard uses ZBX_MUTEX_CACHE */
+	ZBX_MUTEX_CACHE_SHARD1,
+	ZBX_MUTEX_CACHE_SHARD2,
+	ZBX_MUTEX_CACHE_SHARD3,
+	ZBX_MUTEX_CACHE_SHARD4,
+	ZBX_MUTEX_CACHE_SHARD5,
+	ZBX_MUTEX_CACHE_SHARD6,
+	ZBX_MUTEX_CACHE_SHARD7,
+	ZBX_MUTEX_PREPROC_BUFFER,
+	ZBX_MUTEX_PROBLEM_INDEX,
 	/* NOTE: Do not forget to sync changes here with mutex names in diag_add_locks_info()! */
 	ZBX_MUTEX_COUNT
 }
@@ -49,6 +49,7 @@ typedef struct
 	int			config_unreachable_period;
 	int			config_unreachable_delay;
 	int			config_max_concurrent_checks_per_poller;
+	int			config_agent_keep_alive;
 	zbx_get_config_forks_f	get_config_forks;
 	const char		*config_java_gateway;
 	int			config_java_gateway_port;
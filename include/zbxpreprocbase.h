@@ -83,6 +83,9 @@ typedef struct
 
 	zbx_pp_history_t	*history;	/* the preprocessing history */
 	int			history_num;	/* the number of preprocessing steps requiring history */
+
+	void			*compiled;	/* the compiled preprocessing steps (optional) */
+	zbx_clean_func_t	compiled_free;	/* the compiled preprocessing steps destructor */
 }
 zbx_pp_item_preproc_t;
 
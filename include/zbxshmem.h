@@ -23,10 +23,22 @@
 #define SHMEM_MAX_BUCKET_SIZE		256 /* starting from this size all free chunks are put into the same bucket */
 #define ZBX_SHMEM_BUCKET_COUNT		((SHMEM_MAX_BUCKET_SIZE - ZBX_SHMEM_MIN_BUCKET_SIZE) / 8 + 1)
 
+#define ZBX_SHMEM_SLAB_CLASS_COUNT	8	/* the number of slab size classes, see zbx_shmem_enable_slabs() */
+
+/* the slab size class data */
+typedef struct
+{
+	void		*pages;		/* the slab pages having free slots */
+	unsigned int	pages_num;
+	unsigned int	used_num;	/* the number of used slots */
+}
+zbx_shmem_slab_t;
+
 typedef struct
 {
 	void		*base;
 	void		**buckets;
+	zbx_shmem_slab_t	*slabs;
 	void		*lo_bound;
 	void		*hi_bound;
 	zbx_uint64_t	free_size;
@@ -40,6 +52,9 @@ typedef struct
 	/* Set this flag to 1 to allow execution in out of memory situations.     */
 	char		allow_oom;
 
+	/* allocate small objects from fixed size class slabs */
+	char		slab_mode;
+
 	const char	*mem_descr;
 	const char	*mem_param;
 }
@@ -55,6 +70,14 @@ typedef struct
 	unsigned int	chunks_num[ZBX_SHMEM_BUCKET_COUNT];
 	unsigned int	free_chunks;
 	unsigned int	used_chunks;
+	struct
+	{
+		zbx_uint64_t	size;	/* slot size */
+		unsigned int	pages;
+		unsigned int	used;	/* used slots */
+		unsigned int	total;	/* total slots */
+	}
+	slabs[ZBX_SHMEM_SLAB_CLASS_COUNT];
 }
 zbx_shmem_stats_t;
 
@@ -63,6 +86,7 @@ int	zbx_shmem_create(zbx_shmem_info_t **info, zbx_uint64_t size, const char *des
 int	zbx_shmem_create_min(zbx_shmem_info_t **info, zbx_uint64_t size, const char *descr, const char *param,
 		int allow_oom, char **error);
 void	zbx_shmem_destroy(zbx_shmem_info_t *info);
+void	zbx_shmem_enable_slabs(zbx_shmem_info_t *info);
 
 #define	zbx_shmem_malloc(info, old, size) __zbx_shmem_malloc(__FILE__, __LINE__, info, old, size)
 #define	zbx_shmem_realloc(info, old, size) __zbx_shmem_realloc(__FILE__, __LINE__, info, old, size)
@@ -83,6 +107,7 @@ void	zbx_shmem_clear(zbx_shmem_info_t *info);
 
 void	zbx_shmem_get_stats(const zbx_shmem_info_t *info, zbx_shmem_stats_t *stats);
 void	zbx_shmem_dump_stats(int level, zbx_shmem_info_t *info);
+double	zbx_shmem_stats_fragmentation(const zbx_shmem_stats_t *stats);
 
 size_t		zbx_shmem_required_size(int chunks_num, const char *descr, const char *param);
 zbx_uint64_t	zbx_shmem_required_chunk_size(zbx_uint64_t size);
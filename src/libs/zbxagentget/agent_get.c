@@ -17,6 +17,7 @@
 #include "zbxversion.h"
 #include "zbxstr.h"
 #include "zbxjson.h"
+#include "zbxnum.h"
 
 #include <stddef.h>
 
@@ -44,6 +45,47 @@ void	zbx_agent_prepare_request(struct zbx_json *j, const char *key, int timeout)
 	zbx_json_close(j);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: requests agent to keep connection open after response             *
+ *                                                                            *
+ * Parameters: j          - [IN/OUT] request prepared by                      *
+ *                                   zbx_agent_prepare_request()              *
+ *             keep_alive - [IN] number of seconds to keep connection open    *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_agent_request_keep_alive(struct zbx_json *j, int keep_alive)
+{
+	zbx_json_close(j);
+	zbx_json_addint64(j, ZBX_PROTO_TAG_KEEP_ALIVE, (zbx_int64_t)keep_alive);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets number of seconds agent agreed to keep connection open       *
+ *                                                                            *
+ * Parameters: buffer - [IN] agent response                                   *
+ *                                                                            *
+ * Return value: keep-alive period in seconds, 0 if agent will close          *
+ *               connection                                                   *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_agent_get_keep_alive(const char *buffer)
+{
+	struct zbx_json_parse	jp;
+	char			tmp[MAX_ID_LEN + 1];
+	int			keep_alive;
+
+	if (SUCCEED != zbx_json_open(buffer, &jp) ||
+			SUCCEED != zbx_json_value_by_name(&jp, ZBX_PROTO_TAG_KEEP_ALIVE, tmp, sizeof(tmp), NULL) ||
+			SUCCEED != zbx_is_uint31(tmp, &keep_alive))
+	{
+		return 0;
+	}
+
+	return keep_alive;
+}
+
 int	zbx_agent_handle_response(char *buffer, size_t read_bytes, ssize_t received_len, const char *addr,
 		AGENT_RESULT *result, int *version)
 {
@@ -749,13 +749,15 @@ static void	am_service_add_event_tags(zbx_vector_events_tags_t *events_tags)
  *                                                                            *
  * Purpose: flushes alert results to database                                 *
  *                                                                            *
- * Parameters: mediatypes - [IN]                                              *
- *             data       - [IN] serialized alert results                     *
+ * Parameters: mediatypes          - [IN]                                     *
+ *             data                - [IN] serialized alert results            *
+ *             add_problem_tags_cb - [IN] callback to update problem tags     *
  *                                                                            *
  * Return value: count of results                                             *
  *                                                                            *
  ******************************************************************************/
-static int	am_db_flush_results(zbx_hashset_t *mediatypes, const unsigned char *data)
+static int	am_db_flush_results(zbx_hashset_t *mediatypes, const unsigned char *data,
+		zbx_add_problem_tags_f add_problem_tags_cb)
 {
 	int				results_num;
 	zbx_vector_events_tags_t	update_events_tags;
@@ -842,8 +844,18 @@ static int	am_db_flush_results(zbx_hashset_t *mediatypes, const unsigned char *d
 		while (ZBX_DB_DOWN == (ret = zbx_db_commit()));
 
 		if (ZBX_DB_OK == ret)
+		{
 			am_service_add_event_tags(&update_events_tags);
 
+			for (int i = 0; i < update_events_tags.values_num; i++)
+			{
+				zbx_event_tags_t	*event_tags = update_events_tags.values[i];
+
+				if (0 != event_tags->need_to_add_problem_tag)
+					add_problem_tags_cb(event_tags->eventid, &event_tags->tags);
+			}
+		}
+
 		for (int i = 0; i < results_num; i++)
 		{
 			zbx_am_result_t	*result = results[i];
@@ -1090,7 +1102,8 @@ ZBX_THREAD_ENTRY(zbx_alert_syncer_thread, args)
 					req_alerts = 1;
 					break;
 				case ZBX_IPC_ALERTER_RESULTS:
-					results_num = am_db_flush_results(&amdb.mediatypes, message->data);
+					results_num = am_db_flush_results(&amdb.mediatypes, message->data,
+							alert_syncer_args_in->add_problem_tags_cb);
 					break;
 				default:
 					zabbix_log(LOG_LEVEL_WARNING, "unrecognized message in alert syncer %d",
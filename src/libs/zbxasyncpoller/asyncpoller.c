@@ -67,6 +67,8 @@ static const char	*task_state_to_str(zbx_async_task_state_t task_state)
 			return "ZBX_ASYNC_TASK_WRITE";
 		case ZBX_ASYNC_TASK_READ:
 			return "ZBX_ASYNC_TASK_READ";
+		case ZBX_ASYNC_TASK_READ_NEW_REQUEST:
+			return "ZBX_ASYNC_TASK_READ_NEW_REQUEST";
 		case ZBX_ASYNC_TASK_STOP:
 			return "ZBX_ASYNC_TASK_STOP";
 		case ZBX_ASYNC_TASK_RESOLVE_REVERSE:
@@ -110,6 +112,14 @@ static void	async_event(evutil_socket_t fd, short what, void *arg)
 						async_reverse_dns_event, task);
 			}
 			break;
+		case ZBX_ASYNC_TASK_READ_NEW_REQUEST:
+			if (NULL != task->timeout_event)
+			{
+				struct timeval	tv = {task->timeout, 0};
+
+				evtimer_add(task->timeout_event, &tv);
+			}
+			ZBX_FALLTHROUGH;
 		case ZBX_ASYNC_TASK_READ:
 			if (fd_in != fd && NULL != task->tx_event)
 			{
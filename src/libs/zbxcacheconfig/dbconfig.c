@@ -3005,6 +3005,32 @@ static unsigned char	*config_decode_serialized_expression(const char *src)
 	return dst;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compiles serialized trigger expression for fast evaluation        *
+ *                                                                            *
+ * Parameters: expression - [IN] trigger expression                           *
+ *             data       - [IN] serialized expression                        *
+ *                                                                            *
+ * Return value: The compiled expression code allocated in configuration      *
+ *               cache or NULL if the expression cannot be compiled.          *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_eval_code_t	*config_compile_expression(const char *expression, const unsigned char *data)
+{
+	zbx_eval_context_t	ctx;
+	zbx_eval_code_t		*code;
+
+	if (NULL == data)
+		return NULL;
+
+	zbx_eval_deserialize(&ctx, expression, ZBX_EVAL_TRIGGER_EXPRESSION, data);
+	code = zbx_eval_compile(&ctx, __config_shmem_malloc_func);
+	zbx_eval_clear(&ctx);
+
+	return code;
+}
+
 static void	dc_preprocitem_free(ZBX_DC_PREPROCITEM *preprocitem)
 {
 	zbx_vector_ptr_destroy(&preprocitem->preproc_ops);
@@ -4155,10 +4181,17 @@ static void	DCsync_triggers(zbx_dbsync_t *sync, zbx_uint64_t revision)
 				__config_shmem_free_func((void *)trigger->expression_bin);
 			if (NULL != trigger->recovery_expression_bin)
 				__config_shmem_free_func((void *)trigger->recovery_expression_bin);
+			if (NULL != trigger->expression_code)
+				__config_shmem_free_func((void *)trigger->expression_code);
+			if (NULL != trigger->recovery_expression_code)
+				__config_shmem_free_func((void *)trigger->recovery_expression_code);
 		}
 
 		trigger->expression_bin = config_decode_serialized_expression(row[16]);
 		trigger->recovery_expression_bin = config_decode_serialized_expression(row[17]);
+		trigger->expression_code = config_compile_expression(trigger->expression, trigger->expression_bin);
+		trigger->recovery_expression_code = config_compile_expression(trigger->recovery_expression,
+				trigger->recovery_expression_bin);
 		trigger->timer = atoi(row[18]);
 		trigger->revision = revision;
 	}
@@ -4203,6 +4236,10 @@ static void	DCsync_triggers(zbx_dbsync_t *sync, zbx_uint64_t revision)
 					__config_shmem_free_func((void *)trigger->expression_bin);
 				if (NULL != trigger->recovery_expression_bin)
 					__config_shmem_free_func((void *)trigger->recovery_expression_bin);
+				if (NULL != trigger->expression_code)
+					__config_shmem_free_func((void *)trigger->expression_code);
+				if (NULL != trigger->recovery_expression_code)
+					__config_shmem_free_func((void *)trigger->recovery_expression_code);
 
 				if (NULL != trigger->itemids)
 					__config_shmem_free_func((void *)trigger->itemids);
@@ -7706,6 +7743,37 @@ static void	dc_add_new_items_to_trends(const zbx_vector_dc_item_ptr_t *items)
 	}
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: updates item query revision if items matching item queries might  *
+ *          have changed                                                      *
+ *                                                                            *
+ * Parameters: update_flags     - [IN] the configuration update flags         *
+ *             hgroup_host_sync - [IN] the host group membership changes      *
+ *             item_tag_sync    - [IN] the item tag changes                   *
+ *             host_tag_sync    - [IN] the host tag changes                   *
+ *             htmpl_sync       - [IN] the template link changes              *
+ *             revision         - [IN] the new configuration revision         *
+ *                                                                            *
+ * Comments: Item tag filters match host and template tags too, so changes    *
+ *           of host tags and template links also affect item queries.        *
+ *                                                                            *
+ ******************************************************************************/
+static void	dc_update_item_query_revision(zbx_uint64_t update_flags, const zbx_dbsync_t *hgroup_host_sync,
+		const zbx_dbsync_t *item_tag_sync, const zbx_dbsync_t *host_tag_sync, const zbx_dbsync_t *htmpl_sync,
+		zbx_uint64_t revision)
+{
+	if (0 != (update_flags & (ZBX_DBSYNC_UPDATE_HOSTS | ZBX_DBSYNC_UPDATE_ITEMS | ZBX_DBSYNC_UPDATE_HOST_GROUPS |
+			ZBX_DBSYNC_UPDATE_MACROS)) ||
+			0 != hgroup_host_sync->add_num + hgroup_host_sync->update_num + hgroup_host_sync->remove_num ||
+			0 != item_tag_sync->add_num + item_tag_sync->update_num + item_tag_sync->remove_num ||
+			0 != host_tag_sync->add_num + host_tag_sync->update_num + host_tag_sync->remove_num ||
+			0 != htmpl_sync->add_num + htmpl_sync->update_num + htmpl_sync->remove_num)
+	{
+		config->revision.item_query = revision;
+	}
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: Synchronize configuration data from database                      *
@@ -8317,6 +8385,9 @@ zbx_uint64_t	zbx_dc_sync_configuration(unsigned char mode, zbx_synced_new_config
 		dc_schedule_trigger_timers((ZBX_DBSYNC_INIT == mode ? &trend_queue : NULL), time(NULL));
 	}
 
+	dc_update_item_query_revision(update_flags, &hgroup_host_sync, &item_tag_sync, &host_tag_sync, &htmpl_sync,
+			new_revision);
+
 	update_sec = zbx_time() - sec;
 
 	config->revision.config = new_revision;
@@ -10178,6 +10249,8 @@ void	DCget_trigger(zbx_dc_trigger_t *dst_trigger, const ZBX_DC_TRIGGER *src_trig
 
 	dst_trigger->expression_bin = dup_serialized_expression(src_trigger->expression_bin);
 	dst_trigger->recovery_expression_bin = dup_serialized_expression(src_trigger->recovery_expression_bin);
+	dst_trigger->expression_code = zbx_eval_code_dup(src_trigger->expression_code);
+	dst_trigger->recovery_expression_code = zbx_eval_code_dup(src_trigger->recovery_expression_code);
 
 	dst_trigger->eval_ctx = NULL;
 	dst_trigger->eval_ctx_r = NULL;
@@ -10235,6 +10308,8 @@ static void	DCclean_trigger(zbx_dc_trigger_t *trigger)
 	zbx_free(trigger->event_name);
 	zbx_free(trigger->expression_bin);
 	zbx_free(trigger->recovery_expression_bin);
+	zbx_free(trigger->expression_code);
+	zbx_free(trigger->recovery_expression_code);
 
 	zbx_vector_tags_ptr_clear_ext(&trigger->tags, zbx_free_tag);
 	zbx_vector_tags_ptr_destroy(&trigger->tags);
@@ -10729,6 +10804,313 @@ void	zbx_dc_config_clean_triggers(zbx_dc_trigger_t *triggers, int *errcodes, siz
 	}
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculates item history range required by function period       *
+ *                                                                            *
+ * Parameters: item   - [IN] the item                                         *
+ *             period - [IN] the function period parameter                    *
+ *                           (sec|#num[:timeshift])                           *
+ *             now    - [IN] the current time                                 *
+ *                                                                            *
+ * Return value: The history range in seconds or 0 if it cannot be          *
+ *               calculated.                                                  *
+ *                                                                            *
+ * Comments: The range of count based periods is estimated from item update   *
+ *           interval.                                                        *
+ *                                                                            *
+ ******************************************************************************/
+static int	dc_get_item_history_range(const ZBX_DC_ITEM *item, const char *period, int now)
+{
+	char	*param, *shift;
+	int	value, seconds = 0;
+
+	param = dc_expand_user_and_func_macros_dyn(period, &item->hostid, 1, ZBX_MACRO_ENV_NONSECURE);
+
+	if (NULL != (shift = strchr(param, ':')))
+		*shift++ = '\0';
+
+	if ('\0' == *param || '#' == *param)
+	{
+		char	*delay_s;
+		int	delay, ret;
+
+		if ('\0' == *param)
+			value = 1;
+		else if (SUCCEED != zbx_is_uint31(param + 1, &value) || 0 >= value)
+			goto out;
+
+		delay_s = dc_expand_user_and_func_macros_dyn(item->delay, &item->hostid, 1, ZBX_MACRO_ENV_NONSECURE);
+		ret = zbx_interval_preproc(delay_s, &delay, NULL, NULL);
+		zbx_free(delay_s);
+
+		/* the range cannot be estimated for items without update interval */
+		if (SUCCEED != ret || 0 >= delay || ZBX_JAN_2038 / delay < value)
+			goto out;
+
+		value *= delay;
+	}
+	else if (SUCCEED != zbx_is_time_suffix(param, &value, ZBX_LENGTH_UNLIMITED) || 0 >= value)
+		goto out;
+
+	if (NULL != shift)
+	{
+		struct tm	tm;
+		char		*error = NULL;
+		int		end;
+
+		if (SUCCEED != zbx_trends_parse_timeshift(now, shift, &tm, &error))
+		{
+			zbx_free(error);
+			goto out;
+		}
+
+		if (-1 == (end = (int)mktime(&tm)) || ZBX_JAN_2038 - value < now - end)
+			goto out;
+
+		value += now - end;
+	}
+
+	if (0 < value)
+		seconds = value;
+out:
+	zbx_free(param);
+
+	return seconds;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds item history range to the ranges vector                      *
+ *                                                                            *
+ * Parameters: ranges - [OUT] the item history ranges                         *
+ *             item   - [IN] the item                                         *
+ *             period - [IN] the function period parameter                    *
+ *             now    - [IN] the current time                                 *
+ *                                                                            *
+ ******************************************************************************/
+static void	dc_add_item_history_range(zbx_vector_vc_item_range_t *ranges, const ZBX_DC_ITEM *item,
+		const char *period, int now)
+{
+	zbx_vc_item_range_t	range;
+
+	if (ITEM_STATUS_ACTIVE != item->status || ITEM_VALUE_TYPE_BIN == item->value_type)
+		return;
+
+	if (0 == (range.seconds = dc_get_item_history_range(item, period, now)))
+		return;
+
+	range.itemid = item->itemid;
+	range.value_type = item->value_type;
+	zbx_vector_vc_item_range_append(ranges, range);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets history ranges of items used by calculated item formula      *
+ *                                                                            *
+ * Parameters: ranges        - [OUT] the item history ranges                  *
+ *             calcitem      - [IN] the calculated item                       *
+ *             process_num   - [IN] the history syncer process number         *
+ *             process_forks - [IN] the number of history syncer processes    *
+ *             now           - [IN] the current time                          *
+ *                                                                            *
+ * Comments: Only single item queries without filters are resolved. Only the  *
+ *           ranges of referenced items assigned to the history syncer are    *
+ *           returned.                                                        *
+ *                                                                            *
+ ******************************************************************************/
+static void	dc_get_calcitem_history_ranges(zbx_vector_vc_item_range_t *ranges, const ZBX_DC_ITEM *calcitem,
+		int process_num, int process_forks, int now)
+{
+	zbx_eval_context_t	ctx;
+
+	zbx_eval_deserialize(&ctx, calcitem->itemtype.calcitem->params, ZBX_EVAL_PARSE_CALC_EXPRESSION,
+			calcitem->itemtype.calcitem->formula_bin);
+
+	for (int i = 0; i < ctx.stack.values_num; i++)
+	{
+		const zbx_eval_token_t	*token = &ctx.stack.values[i], *func = NULL;
+		zbx_item_query_t	query;
+		const ZBX_DC_ITEM	*item;
+		char			*name, *period;
+		zbx_function_type_t	type;
+
+		if (ZBX_EVAL_TOKEN_ARG_QUERY != token->type)
+			continue;
+
+		/* query is the first argument of the closest history function preceding it in expression */
+		for (int j = i + 1; j < ctx.stack.values_num; j++)
+		{
+			const zbx_eval_token_t	*next = &ctx.stack.values[j];
+
+			if (ZBX_EVAL_TOKEN_HIST_FUNCTION == next->type && next->loc.l < token->loc.l &&
+					(NULL == func || func->loc.l < next->loc.l))
+			{
+				func = next;
+			}
+		}
+
+		if (NULL == func)
+			continue;
+
+		name = zbx_substr(ctx.expression, func->loc.l, func->loc.r);
+		type = zbx_get_function_type(name);
+		zbx_free(name);
+
+		if (ZBX_FUNCTION_TYPE_HISTORY != type)
+			continue;
+
+		if (0 == zbx_eval_parse_query(ctx.expression + token->loc.l, token->loc.r - token->loc.l + 1, &query))
+			continue;
+
+		item = NULL;
+
+		if (NULL == query.filter && NULL == strchr(query.key, '*'))
+		{
+			if (NULL == query.host || 0 == strcmp(query.host, "{HOST.HOST}"))
+			{
+				item = DCfind_item(calcitem->hostid, query.key);
+			}
+			else if ('*' != *query.host)
+			{
+				const ZBX_DC_HOST	*host;
+
+				if (NULL != (host = DCfind_host(query.host)))
+					item = DCfind_item(host->hostid, query.key);
+			}
+		}
+
+		zbx_eval_clear_query(&query);
+
+		if (NULL == item || (zbx_uint64_t)(process_num - 1) != item->itemid % (zbx_uint64_t)process_forks)
+			continue;
+
+		if (i + 1 < ctx.stack.values_num && ZBX_EVAL_TOKEN_ARG_PERIOD == ctx.stack.values[i + 1].type)
+		{
+			const zbx_eval_token_t	*arg = &ctx.stack.values[i + 1];
+
+			if (ZBX_VARIANT_STR == arg->value.type)
+				period = zbx_strdup(NULL, arg->value.data.str);
+			else
+				period = zbx_substr(ctx.expression, arg->loc.l, arg->loc.r);
+		}
+		else
+			period = zbx_strdup(NULL, "");
+
+		dc_add_item_history_range(ranges, item, period, now);
+		zbx_free(period);
+	}
+
+	zbx_eval_clear(&ctx);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets history ranges of items used in enabled trigger and          *
+ *          calculated item history functions                                 *
+ *                                                                            *
+ * Parameters: ranges        - [OUT] the item history ranges, sorted by       *
+ *                                   itemid                                   *
+ *             process_num   - [IN] the history syncer process number         *
+ *             process_forks - [IN] the number of history syncer processes    *
+ *                                                                            *
+ * Comments: Items are distributed between history syncers by itemid. If an   *
+ *           item is used by several functions, its largest range is          *
+ *           returned.                                                        *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_dc_get_item_history_ranges(zbx_vector_vc_item_range_t *ranges, int process_num, int process_forks)
+{
+	zbx_hashset_iter_t	iter;
+	const ZBX_DC_FUNCTION	*function;
+	const ZBX_DC_ITEM	*item;
+	int			i, j, now;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	now = (int)time(NULL);
+
+	RDLOCK_CACHE;
+
+	zbx_hashset_iter_reset(&config->functions, &iter);
+
+	while (NULL != (function = (const ZBX_DC_FUNCTION *)zbx_hashset_iter_next(&iter)))
+	{
+		const ZBX_DC_TRIGGER	*trigger;
+		const ZBX_DC_HOST	*host;
+		char			*period;
+
+		if (ZBX_FUNCTION_TYPE_HISTORY != function->type)
+			continue;
+
+		if ((zbx_uint64_t)(process_num - 1) != function->itemid % (zbx_uint64_t)process_forks)
+			continue;
+
+		if (NULL == (trigger = (const ZBX_DC_TRIGGER *)zbx_hashset_search(&config->triggers,
+				&function->triggerid)) || TRIGGER_STATUS_ENABLED != trigger->status)
+		{
+			continue;
+		}
+
+		if (NULL == (item = (const ZBX_DC_ITEM *)zbx_hashset_search(&config->items, &function->itemid)))
+			continue;
+
+		if (NULL == (host = (const ZBX_DC_HOST *)zbx_hashset_search(&config->hosts, &item->hostid)) ||
+				HOST_STATUS_MONITORED != host->status)
+		{
+			continue;
+		}
+
+		if (NULL == (period = zbx_function_get_param_dyn(function->parameter, 1)))
+			period = zbx_strdup(NULL, "");
+
+		dc_add_item_history_range(ranges, item, period, now);
+		zbx_free(period);
+	}
+
+	zbx_hashset_iter_reset(&config->items, &iter);
+
+	while (NULL != (item = (const ZBX_DC_ITEM *)zbx_hashset_iter_next(&iter)))
+	{
+		const ZBX_DC_HOST	*host;
+
+		if (ITEM_TYPE_CALCULATED != item->type || ITEM_STATUS_ACTIVE != item->status ||
+				NULL == item->itemtype.calcitem->formula_bin)
+		{
+			continue;
+		}
+
+		if (NULL == (host = (const ZBX_DC_HOST *)zbx_hashset_search(&config->hosts, &item->hostid)) ||
+				HOST_STATUS_MONITORED != host->status)
+		{
+			continue;
+		}
+
+		dc_get_calcitem_history_ranges(ranges, item, process_num, process_forks, now);
+	}
+
+	UNLOCK_CACHE;
+
+	zbx_vector_vc_item_range_sort(ranges, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	for (i = 0, j = 1; j < ranges->values_num; j++)
+	{
+		if (ranges->values[i].itemid == ranges->values[j].itemid)
+		{
+			if (ranges->values[i].seconds < ranges->values[j].seconds)
+				ranges->values[i].seconds = ranges->values[j].seconds;
+		}
+		else
+			ranges->values[++i] = ranges->values[j];
+	}
+
+	if (0 != ranges->values_num)
+		ranges->values_num = i + 1;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() ranges:%d", __func__, ranges->values_num);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: Lock triggers for specified items so that multiple processes do   *
@@ -14698,6 +15080,25 @@ void	zbx_dc_get_hostids_by_group_name(const char *name, zbx_vector_uint64_t *hos
 	zbx_vector_uint64_uniq(hostids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets revision of configuration used to resolve item queries       *
+ *                                                                            *
+ * Return value: The revision, changed when hosts, host groups, items, item   *
+ *               tags or user macros are updated.                             *
+ *                                                                            *
+ ******************************************************************************/
+zbx_uint64_t	zbx_dc_get_item_query_revision(void)
+{
+	zbx_uint64_t	revision;
+
+	RDLOCK_CACHE;
+	revision = config->revision.item_query;
+	UNLOCK_CACHE;
+
+	return revision;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: gets active proxy data by its name from configuration cache       *
@@ -17057,6 +17458,7 @@ void	zbx_dc_get_unused_macro_templates(zbx_hashset_t *templates, const zbx_vecto
 #ifdef HAVE_TESTS
 #	include "../../../tests/libs/zbxcacheconfig/dc_item_poller_type_update_test.c"
 #	include "../../../tests/libs/zbxcacheconfig/dc_function_calculate_nextcheck_test.c"
+#	include "../../../tests/libs/zbxcacheconfig/dc_update_item_query_revision_test.c"
 #endif
 
 void	zbx_recalc_time_period(time_t *ts_from, int table_group)
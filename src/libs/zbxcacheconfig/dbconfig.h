@@ -49,6 +49,8 @@ typedef struct
 	const char		*event_name;
 	const unsigned char	*expression_bin;
 	const unsigned char	*recovery_expression_bin;
+	const zbx_eval_code_t	*expression_code;
+	const zbx_eval_code_t	*recovery_expression_code;
 	int			lastchange;
 	zbx_uint64_t		revision;
 	zbx_uint64_t		timer_revision;
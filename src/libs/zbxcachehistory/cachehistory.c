@@ -38,18 +38,21 @@
 #include "zbxvariant.h"
 #include "zbxipcservice.h"
 
+/* history data and index memory of the currently locked history cache shard */
 static zbx_shmem_info_t	*hc_index_mem = NULL;
 static zbx_shmem_info_t	*hc_mem = NULL;
 static zbx_shmem_info_t	*trend_mem = NULL;
 
-#define	LOCK_CACHE	zbx_mutex_lock(cache_lock)
-#define	UNLOCK_CACHE	zbx_mutex_unlock(cache_lock)
+/* The first history cache shard also holds the global cache data (statistics of trends, proxy queue, */
+/* sync progress) and its lock is the global cache lock. When several shard locks must be held at     */
+/* the same time they are always acquired in ascending shard order.                                   */
+#define	LOCK_CACHE	hc_shard_lock(0)
+#define	UNLOCK_CACHE	hc_shard_unlock(0)
 #define	LOCK_TRENDS	zbx_mutex_lock(trends_lock)
 #define	UNLOCK_TRENDS	zbx_mutex_unlock(trends_lock)
 #define	LOCK_CACHE_IDS		zbx_mutex_lock(cache_ids_lock)
 #define	UNLOCK_CACHE_IDS	zbx_mutex_unlock(cache_ids_lock)
 
-static zbx_mutex_t	cache_lock = ZBX_MUTEX_NULL;
 static zbx_mutex_t	trends_lock = ZBX_MUTEX_NULL;
 static zbx_mutex_t	cache_ids_lock = ZBX_MUTEX_NULL;
 
@@ -59,12 +62,18 @@ static size_t		sql_alloc = 4 * ZBX_KIBIBYTE;
 static zbx_get_program_type_f	get_program_type_cb = NULL;
 static zbx_history_sync_f	sync_history_cb = NULL;
 
+/* period in seconds to spread writing of the previous hour trends over, 0 - write them at once */
+static int	trends_flush_period = 0;
+
 #define ZBX_IDS_SIZE	14
 
 #define ZBX_HC_ITEMS_INIT_SIZE	1000
 
 #define ZBX_TRENDS_CLEANUP_TIME	(SEC_PER_MIN * 55)
 
+/* the number of trends written by single upsert statement */
+#define ZBX_TRENDS_UPSERT_MAX	1000
+
 /* the maximum number of characters for history cache values (except binary) */
 #define ZBX_HISTORY_VALUE_LEN		(1024 * 64)
 
@@ -91,15 +100,39 @@ typedef struct
 }
 zbx_hc_proxyqueue_t;
 
+/* history cache shard, items are assigned to shards by itemid */
 typedef struct
 {
-	zbx_hashset_t		trends;
-	zbx_dc_stats_t		stats;
-
 	zbx_hashset_t		history_items;
 	zbx_binary_heap_t	history_queue;
-
+	zbx_dc_stats_t		stats;
 	int			history_num;
+}
+zbx_hc_shard_t;
+
+static int		hc_shards_num = 0;
+static zbx_hc_shard_t	*hc_shards[ZBX_HC_SHARDS_MAX];
+static zbx_shmem_info_t	*hc_shards_mem[ZBX_HC_SHARDS_MAX];
+static zbx_shmem_info_t	*hc_shards_index_mem[ZBX_HC_SHARDS_MAX];
+static zbx_mutex_t	hc_shards_lock[ZBX_HC_SHARDS_MAX];
+
+/* shared memory segments selected before the shard was locked, restored on unlock */
+static zbx_shmem_info_t	*hc_shards_prev_mem[ZBX_HC_SHARDS_MAX];
+static zbx_shmem_info_t	*hc_shards_prev_index_mem[ZBX_HC_SHARDS_MAX];
+
+/* the shard to start popping items from, rotated to balance syncing between shards */
+static int		hc_shard_pop = 0;
+
+typedef struct
+{
+	zbx_hashset_t		trends;
+
+	/* previous hour trends waiting to be written during trend flush period */
+	zbx_hashset_t		trends_pending;
+	int			trends_pending_hour;
+	int			trends_pending_num;
+	int			trends_pending_flushed;
+
 	int			trends_num;
 	int			trends_last_cleanup_hour;
 	int			history_num_total;
@@ -156,10 +189,135 @@ static size_t		string_values_alloc = 0, string_values_offset = 0;
 static dc_item_value_t	*item_values = NULL;
 static size_t		item_values_alloc = 0, item_values_num = 0;
 
-static void	hc_add_item_values(dc_item_value_t *values, int values_num);
-static void	hc_queue_item(zbx_hc_item_t *item);
+static dc_item_value_t	*shard_values = NULL;
+static size_t		shard_values_alloc = 0;
+
+static void	hc_add_item_values(int index, dc_item_value_t *values, int values_num);
+static void	hc_queue_item(zbx_hc_shard_t *shard, zbx_hc_item_t *item);
 static int	hc_queue_elem_compare_func(const void *d1, const void *d2);
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns index of history cache shard the item belongs to          *
+ *                                                                            *
+ ******************************************************************************/
+static int	hc_shard_index(zbx_uint64_t itemid)
+{
+	return (int)(itemid % (zbx_uint64_t)hc_shards_num);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: locks history cache shard and selects its shared memory segments  *
+ *          for history data allocations                                      *
+ *                                                                            *
+ * Comments: Shards can be locked while holding the global cache lock (first  *
+ *           shard), so the previously selected segments are saved and        *
+ *           restored by hc_shard_unlock().                                   *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_shard_lock(int index)
+{
+	zbx_mutex_lock(hc_shards_lock[index]);
+
+	hc_shards_prev_mem[index] = hc_mem;
+	hc_shards_prev_index_mem[index] = hc_index_mem;
+
+	hc_mem = hc_shards_mem[index];
+	hc_index_mem = hc_shards_index_mem[index];
+}
+
+static void	hc_shard_unlock(int index)
+{
+	hc_mem = hc_shards_prev_mem[index];
+	hc_index_mem = hc_shards_prev_index_mem[index];
+
+	zbx_mutex_unlock(hc_shards_lock[index]);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets total and free size of history data memory in all shards     *
+ *                                                                            *
+ * Comments: The global cache lock (first shard) must be held by caller.      *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_get_mem_size(zbx_uint64_t *total_size, zbx_uint64_t *free_size, zbx_uint64_t *index_total_size,
+		zbx_uint64_t *index_free_size)
+{
+	int	i;
+
+	*total_size = hc_shards_mem[0]->total_size;
+	*free_size = hc_shards_mem[0]->free_size;
+	*index_total_size = hc_shards_index_mem[0]->total_size;
+	*index_free_size = hc_shards_index_mem[0]->free_size;
+
+	for (i = 1; i < hc_shards_num; i++)
+	{
+		hc_shard_lock(i);
+
+		*total_size += hc_shards_mem[i]->total_size;
+		*free_size += hc_shards_mem[i]->free_size;
+		*index_total_size += hc_shards_index_mem[i]->total_size;
+		*index_free_size += hc_shards_index_mem[i]->free_size;
+
+		hc_shard_unlock(i);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sums value statistics of all shards                               *
+ *                                                                            *
+ * Comments: The global cache lock (first shard) must be held by caller.      *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_get_stats(zbx_dc_stats_t *stats)
+{
+	int	i;
+
+	*stats = hc_shards[0]->stats;
+
+	for (i = 1; i < hc_shards_num; i++)
+	{
+		hc_shard_lock(i);
+
+		stats->history_counter += hc_shards[i]->stats.history_counter;
+		stats->history_float_counter += hc_shards[i]->stats.history_float_counter;
+		stats->history_uint_counter += hc_shards[i]->stats.history_uint_counter;
+		stats->history_str_counter += hc_shards[i]->stats.history_str_counter;
+		stats->history_log_counter += hc_shards[i]->stats.history_log_counter;
+		stats->history_text_counter += hc_shards[i]->stats.history_text_counter;
+		stats->history_bin_counter += hc_shards[i]->stats.history_bin_counter;
+		stats->notsupported_counter += hc_shards[i]->stats.notsupported_counter;
+
+		hc_shard_unlock(i);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns number of values in all shards                            *
+ *                                                                            *
+ * Comments: The global cache lock (first shard) must be held by caller.      *
+ *                                                                            *
+ ******************************************************************************/
+static int	hc_get_history_num(void)
+{
+	int	i, history_num;
+
+	history_num = hc_shards[0]->history_num;
+
+	for (i = 1; i < hc_shards_num; i++)
+	{
+		hc_shard_lock(i);
+		history_num += hc_shards[i]->history_num;
+		hc_shard_unlock(i);
+	}
+
+	return history_num;
+}
+
 void	zbx_pp_value_opt_clear(zbx_pp_value_opt_t *opt)
 {
 	if (0 != (opt->flags & ZBX_PP_VALUE_OPT_LOG))
@@ -177,11 +335,9 @@ void	zbx_dc_get_stats_all(zbx_wcache_info_t *wcache_info)
 {
 	LOCK_CACHE;
 
-	wcache_info->stats = cache->stats;
-	wcache_info->history_free = hc_mem->free_size;
-	wcache_info->history_total = hc_mem->total_size;
-	wcache_info->index_free = hc_index_mem->free_size;
-	wcache_info->index_total = hc_index_mem->total_size;
+	hc_get_stats(&wcache_info->stats);
+	hc_get_mem_size(&wcache_info->history_total, &wcache_info->history_free, &wcache_info->index_total,
+			&wcache_info->index_free);
 
 	if (0 != (get_program_type_cb() & ZBX_PROGRAM_TYPE_SERVER))
 	{
@@ -202,57 +358,62 @@ void	*zbx_dc_get_stats(int request)
 	static zbx_uint64_t	value_uint;
 	static double		value_double;
 	void			*ret;
+	zbx_dc_stats_t		stats;
+	zbx_uint64_t		hc_total, hc_free, hc_index_total, hc_index_free;
 
 	LOCK_CACHE;
 
+	hc_get_stats(&stats);
+	hc_get_mem_size(&hc_total, &hc_free, &hc_index_total, &hc_index_free);
+
 	switch (request)
 	{
 		case ZBX_STATS_HISTORY_COUNTER:
-			value_uint = cache->stats.history_counter;
+			value_uint = stats.history_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_FLOAT_COUNTER:
-			value_uint = cache->stats.history_float_counter;
+			value_uint = stats.history_float_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_UINT_COUNTER:
-			value_uint = cache->stats.history_uint_counter;
+			value_uint = stats.history_uint_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_STR_COUNTER:
-			value_uint = cache->stats.history_str_counter;
+			value_uint = stats.history_str_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_LOG_COUNTER:
-			value_uint = cache->stats.history_log_counter;
+			value_uint = stats.history_log_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_TEXT_COUNTER:
-			value_uint = cache->stats.history_text_counter;
+			value_uint = stats.history_text_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_NOTSUPPORTED_COUNTER:
-			value_uint = cache->stats.notsupported_counter;
+			value_uint = stats.notsupported_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_TOTAL:
-			value_uint = hc_mem->total_size;
+			value_uint = hc_total;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_USED:
-			value_uint = hc_mem->total_size - hc_mem->free_size;
+			value_uint = hc_total - hc_free;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_FREE:
-			value_uint = hc_mem->free_size;
+			value_uint = hc_free;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_PUSED:
-			value_double = 100 * (double)(hc_mem->total_size - hc_mem->free_size) / hc_mem->total_size;
+			value_double = 100 * (double)(hc_total - hc_free) / hc_total;
 			ret = (void *)&value_double;
 			break;
 		case ZBX_STATS_HISTORY_PFREE:
-			value_double = 100 * (double)hc_mem->free_size / hc_mem->total_size;
+			value_double = 100 * (double)hc_free / hc_total;
 			ret = (void *)&value_double;
 			break;
 		case ZBX_STATS_TREND_TOTAL:
@@ -277,28 +438,28 @@ void	*zbx_dc_get_stats(int request)
 			ret = (void *)&value_double;
 			break;
 		case ZBX_STATS_HISTORY_INDEX_TOTAL:
-			value_uint = hc_index_mem->total_size;
+			value_uint = hc_index_total;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_INDEX_USED:
-			value_uint = hc_index_mem->total_size - hc_index_mem->free_size;
+			value_uint = hc_index_total - hc_index_free;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_INDEX_FREE:
-			value_uint = hc_index_mem->free_size;
+			value_uint = hc_index_free;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_INDEX_PUSED:
-			value_double = 100 * (double)(hc_index_mem->total_size - hc_index_mem->free_size) /
-					hc_index_mem->total_size;
+			value_double = 100 * (double)(hc_index_total - hc_index_free) /
+					hc_index_total;
 			ret = (void *)&value_double;
 			break;
 		case ZBX_STATS_HISTORY_INDEX_PFREE:
-			value_double = 100 * (double)hc_index_mem->free_size / hc_index_mem->total_size;
+			value_double = 100 * (double)hc_index_free / hc_index_total;
 			ret = (void *)&value_double;
 			break;
 		case ZBX_STATS_HISTORY_BIN_COUNTER:
-			value_uint = cache->stats.history_bin_counter;
+			value_uint = stats.history_bin_counter;
 			ret = (void *)&value_uint;
 			break;
 		default:
@@ -638,6 +799,174 @@ static void	dc_trends_fetch_and_update(ZBX_DC_TREND *trends, int trends_num, zbx
 		zbx_db_execute("%s", sql);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: write trends to database with upsert statements, merging them     *
+ *          with already existing trends of the same hour                     *
+ *                                                                            *
+ * Parameters: trends      - [IN/OUT] trends to write, the written trends are *
+ *                                    marked by zero itemid                   *
+ *             trends_num  - [IN] number of trends                            *
+ *             value_type  - [IN] value type of trends to write               *
+ *             table_name  - [IN] trends table name                           *
+ *             clock       - [IN] hour of trends to write                     *
+ *             trends_diff - [OUT] disable_from updates, optional             *
+ *                                                                            *
+ * Comments: MySQL "on duplicate key update", PostgreSQL "on conflict" and    *
+ *           Oracle "merge" statements are used. Unsigned averages are merged *
+ *           with integer arithmetic and rounded to the nearest integer.      *
+ *                                                                            *
+ ******************************************************************************/
+static void	dc_upsert_trends_in_db(ZBX_DC_TREND *trends, int trends_num, unsigned char value_type,
+		const char *table_name, int clock, zbx_vector_uint64_pair_t *trends_diff)
+{
+	ZBX_DC_TREND	*trend;
+	int		i, rows_num = 0;
+	size_t		sql_offset = 0;
+	const char	*update;
+
+#if defined(HAVE_MYSQL)
+	if (ITEM_VALUE_TYPE_FLOAT == value_type)
+	{
+		update = " on duplicate key update"
+				" value_avg=(value_avg*num+values(value_avg)*values(num))/(num+values(num)),"
+				"value_min=least(value_min,values(value_min)),"
+				"value_max=greatest(value_max,values(value_max)),"
+				"num=num+values(num)";
+	}
+	else
+	{
+		/* avg=(2*sum+num) div (2*num), decimal division is not exact, so the remainder is subtracted first */
+		update = " on duplicate key update"
+				" value_avg=(2*(cast(value_avg as decimal(40,0))*num+"
+					"cast(values(value_avg) as decimal(40,0))*values(num))+num+values(num)-"
+					"mod(2*(cast(value_avg as decimal(40,0))*num+"
+					"cast(values(value_avg) as decimal(40,0))*values(num))+num+values(num),"
+					"2*(num+values(num))))/(2*(num+values(num))),"
+				"value_min=least(value_min,values(value_min)),"
+				"value_max=greatest(value_max,values(value_max)),"
+				"num=num+values(num)";
+	}
+#elif defined(HAVE_ORACLE)
+	if (ITEM_VALUE_TYPE_FLOAT == value_type)
+	{
+		update = ") s on (t.itemid=s.itemid and t.clock=s.clock)"
+				" when matched then update set"
+				" t.num=t.num+s.num,"
+				"t.value_min=least(t.value_min,s.value_min),"
+				"t.value_avg=(t.value_avg*t.num+s.value_avg*s.num)/(t.num+s.num),"
+				"t.value_max=greatest(t.value_max,s.value_max)"
+				" when not matched then insert (itemid,clock,num,value_min,value_avg,value_max)"
+				" values (s.itemid,s.clock,s.num,s.value_min,s.value_avg,s.value_max)";
+	}
+	else
+	{
+		update = ") s on (t.itemid=s.itemid and t.clock=s.clock)"
+				" when matched then update set"
+				" t.num=t.num+s.num,"
+				"t.value_min=least(t.value_min,s.value_min),"
+				"t.value_avg=trunc((2*(t.value_avg*t.num+s.value_avg*s.num)+t.num+s.num)/"
+					"(2*(t.num+s.num))),"
+				"t.value_max=greatest(t.value_max,s.value_max)"
+				" when not matched then insert (itemid,clock,num,value_min,value_avg,value_max)"
+				" values (s.itemid,s.clock,s.num,s.value_min,s.value_avg,s.value_max)";
+	}
+#else
+	if (ITEM_VALUE_TYPE_FLOAT == value_type)
+	{
+		update = " on conflict (itemid,clock) do update set"
+				" num=t.num+excluded.num,"
+				"value_min=least(t.value_min,excluded.value_min),"
+				"value_avg=(t.value_avg*t.num+excluded.value_avg*excluded.num)/(t.num+excluded.num),"
+				"value_max=greatest(t.value_max,excluded.value_max)";
+	}
+	else
+	{
+		update = " on conflict (itemid,clock) do update set"
+				" num=t.num+excluded.num,"
+				"value_min=least(t.value_min,excluded.value_min),"
+				"value_avg=div(2*(t.value_avg*t.num+excluded.value_avg*excluded.num)+t.num+excluded.num,"
+					"2*(t.num+excluded.num)),"
+				"value_max=greatest(t.value_max,excluded.value_max)";
+	}
+#endif
+	for (i = 0; i < trends_num; i++)
+	{
+		trend = &trends[i];
+
+		if (0 == trend->itemid)
+			continue;
+
+		if (clock != trend->clock || value_type != trend->value_type)
+			continue;
+
+#if defined(HAVE_ORACLE)
+		/* the first row of merge source only names the columns */
+		if (0 == rows_num)
+		{
+			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "merge into %s t using ("
+					"select 0 itemid,0 clock,0 num,0 value_min,0 value_avg,0 value_max"
+					" from dual where 1=0", table_name);
+		}
+
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " union all select ");
+#else
+		if (0 == rows_num)
+		{
+			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "insert into %s"
+#if !defined(HAVE_MYSQL)
+					" as t"
+#endif
+					" (itemid,clock,num,value_min,value_avg,value_max) values (", table_name);
+		}
+		else
+			zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, ",(");
+#endif
+		if (ITEM_VALUE_TYPE_FLOAT == value_type)
+		{
+			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, ZBX_FS_UI64 ",%d,%d," ZBX_FS_DBL64_SQL ","
+					ZBX_FS_DBL64_SQL "," ZBX_FS_DBL64_SQL, trend->itemid, trend->clock,
+					trend->num, trend->value_min.dbl, trend->value_avg.dbl, trend->value_max.dbl);
+		}
+		else
+		{
+			zbx_uint128_t	sum, avg;
+
+			/* calculate the trend average value, rounded to the nearest integer */
+			sum = trend->value_avg.ui64;
+			zbx_uinc128_64(&sum, (zbx_uint64_t)(trend->num / 2));
+			zbx_udiv128_64(&avg, &sum, trend->num);
+
+			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, ZBX_FS_UI64 ",%d,%d," ZBX_FS_UI64 ","
+					ZBX_FS_UI64 "," ZBX_FS_UI64, trend->itemid, trend->clock, trend->num,
+					trend->value_min.ui64, avg.lo, trend->value_max.ui64);
+		}
+#if defined(HAVE_ORACLE)
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " from dual");
+#else
+		zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, ')');
+#endif
+		if (NULL != trends_diff && (0 == trend->disable_from || trend->disable_from <= clock))
+		{
+			zbx_uint64_pair_t	pair = {.first = trend->itemid, .second = clock + SEC_PER_HOUR};
+
+			zbx_vector_uint64_pair_append(trends_diff, pair);
+		}
+
+		trend->itemid = 0;
+
+		if (ZBX_TRENDS_UPSERT_MAX == ++rows_num)
+		{
+			zbx_db_execute("%s%s", sql, update);
+			sql_offset = 0;
+			rows_num = 0;
+		}
+	}
+
+	if (0 != rows_num)
+		zbx_db_execute("%s%s", sql, update);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: flush trend to the database                                       *
@@ -668,6 +997,12 @@ void	zbx_db_flush_trends(ZBX_DC_TREND *trends, int *trends_num, zbx_vector_uint6
 			assert(0);
 	}
 
+	if (0 != trends_flush_period)
+	{
+		dc_upsert_trends_in_db(trends, *trends_num, value_type, table_name, clock, trends_diff);
+		goto clean;
+	}
+
 	itemids_alloc = MIN(ZBX_HC_SYNC_MAX, *trends_num);
 	itemids = (zbx_uint64_t *)zbx_malloc(itemids, itemids_alloc * sizeof(zbx_uint64_t));
 
@@ -744,7 +1079,7 @@ void	zbx_db_flush_trends(ZBX_DC_TREND *trends, int *trends_num, zbx_vector_uint6
 
 	if (0 != inserts_num)
 		dc_insert_trends_in_db(trends, trends_to, value_type, table_name, clock);
-
+clean:
 	/* clean trends */
 	for (i = 0, num = 0; i < *trends_num; i++)
 	{
@@ -758,6 +1093,20 @@ void	zbx_db_flush_trends(ZBX_DC_TREND *trends, int *trends_num, zbx_vector_uint6
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reset trend data after it was moved for flushing                  *
+ *                                                                            *
+ ******************************************************************************/
+static void	DCreset_trend(ZBX_DC_TREND *trend)
+{
+	trend->clock = 0;
+	trend->num = 0;
+	memset(&trend->value_min, 0, sizeof(zbx_history_value_t));
+	memset(&trend->value_avg, 0, sizeof(zbx_value_avg_t));
+	memset(&trend->value_max, 0, sizeof(zbx_history_value_t));
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: move trend to the array of trends for flushing to DB              *
@@ -774,11 +1123,155 @@ static void	DCflush_trend(ZBX_DC_TREND *trend, ZBX_DC_TREND **trends, int *trend
 	memcpy(&(*trends)[*trends_num], trend, sizeof(ZBX_DC_TREND));
 	(*trends_num)++;
 
-	trend->clock = 0;
-	trend->num = 0;
-	memset(&trend->value_min, 0, sizeof(zbx_history_value_t));
-	memset(&trend->value_avg, 0, sizeof(zbx_value_avg_t));
-	memset(&trend->value_max, 0, sizeof(zbx_history_value_t));
+	DCreset_trend(trend);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: move pending trends to the array of trends for flushing to DB     *
+ *                                                                            *
+ * Parameters: trends       - [IN/OUT] trends for flushing                    *
+ *             trends_alloc - [IN/OUT] size of trends array                   *
+ *             trends_num   - [IN/OUT] number of trends                       *
+ *             limit        - [IN] the maximum number of trends to move       *
+ *                                                                            *
+ ******************************************************************************/
+static void	DCflush_pending_trends(ZBX_DC_TREND **trends, int *trends_alloc, int *trends_num, int limit)
+{
+	zbx_hashset_iter_t	iter;
+	ZBX_DC_TREND		*trend;
+
+	zbx_hashset_iter_reset(&cache->trends_pending, &iter);
+
+	while (0 < limit-- && NULL != (trend = (ZBX_DC_TREND *)zbx_hashset_iter_next(&iter)))
+	{
+		DCflush_trend(trend, trends, trends_alloc, trends_num);
+		zbx_hashset_iter_remove(&iter);
+		cache->trends_pending_flushed++;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: move pending trends due by the current time to the array of       *
+ *          trends for flushing to DB                                         *
+ *                                                                            *
+ * Parameters: trends       - [IN/OUT] trends for flushing                    *
+ *             trends_alloc - [IN/OUT] size of trends array                   *
+ *             trends_num   - [IN/OUT] number of trends                       *
+ *             now          - [IN] current time                               *
+ *                                                                            *
+ * Comments: Pending trends are flushed evenly during trend flush period.     *
+ *                                                                            *
+ ******************************************************************************/
+static void	DCflush_due_trends(ZBX_DC_TREND **trends, int *trends_alloc, int *trends_num, int now)
+{
+	int	elapsed, limit;
+
+	elapsed = now - cache->trends_pending_hour - SEC_PER_HOUR;
+
+	if (trends_flush_period <= elapsed)
+	{
+		limit = cache->trends_pending.num_data;
+	}
+	else if (0 > elapsed)
+	{
+		return;
+	}
+	else
+	{
+		limit = (int)((zbx_uint64_t)cache->trends_pending_num * (zbx_uint64_t)(elapsed + 1) /
+				(zbx_uint64_t)trends_flush_period) - cache->trends_pending_flushed;
+	}
+
+	if (0 < limit)
+		DCflush_pending_trends(trends, trends_alloc, trends_num, limit);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get pending trends due by the current time for flushing to DB     *
+ *                                                                            *
+ * Parameters: trends     - [OUT] trends to flush into database               *
+ *             trends_num - [OUT] number of trends                            *
+ *                                                                            *
+ * Comments: Pending trends are flushed together with new history values.    *
+ *           History syncers call this function when there are no values to   *
+ *           sync, so pending trends are written during trend flush period    *
+ *           even if no new values are received.                              *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_dc_get_due_trends(ZBX_DC_TREND **trends, int *trends_num)
+{
+	int	trends_alloc = 0;
+
+	if (0 == trends_flush_period)
+		return;
+
+	LOCK_TRENDS;
+
+	if (0 != cache->trends_pending.num_data)
+		DCflush_due_trends(trends, &trends_alloc, trends_num, (int)time(NULL));
+
+	UNLOCK_TRENDS;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: move trend to pending trends or to the array of trends for        *
+ *          flushing to DB                                                    *
+ *                                                                            *
+ * Parameters: trend        - [IN/OUT] trend to flush                         *
+ *             trends       - [IN/OUT] trends for flushing                    *
+ *             trends_alloc - [IN/OUT] size of trends array                   *
+ *             trends_num   - [IN/OUT] number of trends                       *
+ *             now          - [IN] current time                               *
+ *                                                                            *
+ * Comments: Trends of the previous hour are kept in cache and flushed        *
+ *           gradually during trend flush period to avoid writing trends of   *
+ *           all items at the start of the hour. Other trends are flushed at  *
+ *           once, as well as trends of items already having pending trend    *
+ *           or when trend cache is running out of memory.                    *
+ *                                                                            *
+ ******************************************************************************/
+static void	DCflush_trend_deferred(ZBX_DC_TREND *trend, ZBX_DC_TREND **trends, int *trends_alloc,
+		int *trends_num, int now)
+{
+	int	hour;
+
+	hour = now - now % SEC_PER_HOUR;
+
+	if (0 == trends_flush_period || trend->clock != hour - SEC_PER_HOUR || now - hour >= trends_flush_period)
+		goto flush;
+
+	if (cache->trends_pending_hour != trend->clock)
+	{
+		/* trends left from older hours are overdue */
+		DCflush_pending_trends(trends, trends_alloc, trends_num, cache->trends_pending.num_data);
+
+		cache->trends_pending_hour = trend->clock;
+		cache->trends_pending_num = 0;
+		cache->trends_pending_flushed = 0;
+	}
+
+	if (NULL != zbx_hashset_search(&cache->trends_pending, &trend->itemid))
+		goto flush;
+
+	/* leave at least quarter of trend cache for the current hour trends */
+	if (trend_mem->free_size < trend_mem->orig_size / 4 +
+			(zbx_uint64_t)cache->trends_pending.num_slots * sizeof(void *) * 2)
+	{
+		goto flush;
+	}
+
+	zbx_hashset_insert(&cache->trends_pending, trend, sizeof(ZBX_DC_TREND));
+	cache->trends_pending_num++;
+
+	DCreset_trend(trend);
+
+	return;
+flush:
+	DCflush_trend(trend, trends, trends_alloc, trends_num);
 }
 
 /******************************************************************************
@@ -786,7 +1279,8 @@ static void	DCflush_trend(ZBX_DC_TREND *trend, ZBX_DC_TREND **trends, int *trend
  * Purpose: add new value to the trends                                       *
  *                                                                            *
  ******************************************************************************/
-static void	DCadd_trend(const zbx_dc_history_t *history, ZBX_DC_TREND **trends, int *trends_alloc, int *trends_num)
+static void	DCadd_trend(const zbx_dc_history_t *history, ZBX_DC_TREND **trends, int *trends_alloc, int *trends_num,
+		int now)
 {
 	ZBX_DC_TREND	*trend = NULL;
 	int		hour;
@@ -798,7 +1292,7 @@ static void	DCadd_trend(const zbx_dc_history_t *history, ZBX_DC_TREND **trends,
 	if (trend->num > 0 && (trend->clock != hour || trend->value_type != history->value_type) &&
 			SUCCEED == zbx_history_requires_trends(trend->value_type))
 	{
-		DCflush_trend(trend, trends, trends_alloc, trends_num);
+		DCflush_trend_deferred(trend, trends, trends_alloc, trends_num, now);
 	}
 
 	trend->value_type = history->value_type;
@@ -861,9 +1355,12 @@ void	zbx_dc_mass_update_trends(const zbx_dc_history_t *history, int history_num,
 		if (0 != (ZBX_DC_FLAGS_NOT_FOR_TRENDS & h->flags))
 			continue;
 
-		DCadd_trend(h, trends, &trends_alloc, trends_num);
+		DCadd_trend(h, trends, &trends_alloc, trends_num, ts.sec);
 	}
 
+	if (0 != cache->trends_pending.num_data)
+		DCflush_due_trends(trends, &trends_alloc, trends_num, ts.sec);
+
 	if (cache->trends_last_cleanup_hour < hour && ZBX_TRENDS_CLEANUP_TIME < seconds)
 	{
 		zbx_hashset_iter_t	iter;
@@ -1633,6 +2130,16 @@ static void	DCsync_trends(void)
 
 	LOCK_TRENDS;
 
+	zbx_hashset_iter_reset(&cache->trends_pending, &iter);
+
+	while (NULL != (trend = (ZBX_DC_TREND *)zbx_hashset_iter_next(&iter)))
+	{
+		if (trend->clock >= compression_age)
+			DCflush_trend(trend, &trends, &trends_alloc, &trends_num);
+
+		zbx_hashset_iter_remove(&iter);
+	}
+
 	zbx_hashset_iter_reset(&cache->trends, &iter);
 
 	while (NULL != (trend = (ZBX_DC_TREND *)zbx_hashset_iter_next(&iter)))
@@ -1805,12 +2312,14 @@ void	zbx_db_mass_update_items(const zbx_vector_item_diff_ptr_t *item_diff,
  ******************************************************************************/
 static void	sync_history_cache_full(const zbx_events_funcs_t *events_cbs, int config_history_storage_pipelines)
 {
-	int			values_num = 0, triggers_num = 0, more;
+	int			values_num = 0, triggers_num = 0, more, i, history_num;
 	zbx_hashset_iter_t	iter;
 	zbx_hc_item_t		*item;
-	zbx_binary_heap_t	tmp_history_queue;
+	zbx_binary_heap_t	tmp_history_queue[ZBX_HC_SHARDS_MAX];
+
+	history_num = hc_get_history_num();
 
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() history_num:%d", __func__, cache->history_num);
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() history_num:%d", __func__, history_num);
 
 	/* History index cache might be full without any space left for queueing items from history index to  */
 	/* history queue. The solution: replace the shared-memory history queue with heap-allocated one. Add  */
@@ -1829,18 +2338,24 @@ static void	sync_history_cache_full(const zbx_events_funcs_t *events_cbs, int co
 		zbx_dc_config_unlock_all_triggers();
 	}
 
-	tmp_history_queue = cache->history_queue;
+	for (i = 0; i < hc_shards_num; i++)
+	{
+		zbx_hc_shard_t	*shard = hc_shards[i];
+
+		tmp_history_queue[i] = shard->history_queue;
 
-	zbx_binary_heap_create(&cache->history_queue, hc_queue_elem_compare_func, ZBX_BINARY_HEAP_OPTION_EMPTY);
-	zbx_hashset_iter_reset(&cache->history_items, &iter);
+		zbx_binary_heap_create(&shard->history_queue, hc_queue_elem_compare_func,
+				ZBX_BINARY_HEAP_OPTION_EMPTY);
+		zbx_hashset_iter_reset(&shard->history_items, &iter);
 
-	/* add all items from history index to the new history queue */
-	while (NULL != (item = (zbx_hc_item_t *)zbx_hashset_iter_next(&iter)))
-	{
-		if (NULL != item->tail)
+		/* add all items from history index to the new history queue */
+		while (NULL != (item = (zbx_hc_item_t *)zbx_hashset_iter_next(&iter)))
 		{
-			item->status = ZBX_HC_ITEM_STATUS_NORMAL;
-			hc_queue_item(item);
+			if (NULL != item->tail)
+			{
+				item->status = ZBX_HC_ITEM_STATUS_NORMAL;
+				hc_queue_item(shard, item);
+			}
 		}
 	}
 
@@ -1854,15 +2369,18 @@ static void	sync_history_cache_full(const zbx_events_funcs_t *events_cbs, int co
 					&more);
 
 			zabbix_log(LOG_LEVEL_WARNING, "syncing history data... " ZBX_FS_DBL "%%",
-					(double)values_num / (cache->history_num + values_num) * 100);
+					(double)values_num / (hc_get_history_num() + values_num) * 100);
 		}
 		while (0 != zbx_hc_queue_get_size());
 
 		zabbix_log(LOG_LEVEL_WARNING, "syncing history data done");
 	}
 
-	zbx_binary_heap_destroy(&cache->history_queue);
-	cache->history_queue = tmp_history_queue;
+	for (i = 0; i < hc_shards_num; i++)
+	{
+		zbx_binary_heap_destroy(&hc_shards[i]->history_queue);
+		hc_shards[i]->history_queue = tmp_history_queue[i];
+	}
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
@@ -1875,7 +2393,7 @@ static void	sync_history_cache_full(const zbx_events_funcs_t *events_cbs, int co
 void	zbx_log_sync_history_cache_progress(void)
 {
 	double		pcnt = -1.0;
-	int		ts_last, ts_next, sec;
+	int		ts_last, ts_next, sec, history_num;
 
 	LOCK_CACHE;
 
@@ -1887,19 +2405,20 @@ void	zbx_log_sync_history_cache_progress(void)
 
 	ts_last = cache->history_progress_ts;
 	sec = time(NULL);
+	history_num = hc_get_history_num();
 
 	if (0 == cache->history_progress_ts)
 	{
-		cache->history_num_total = cache->history_num;
+		cache->history_num_total = history_num;
 		cache->history_progress_ts = sec;
 	}
 
-	if (ZBX_HC_SYNC_TIME_MAX <= sec - cache->history_progress_ts || 0 == cache->history_num)
+	if (ZBX_HC_SYNC_TIME_MAX <= sec - cache->history_progress_ts || 0 == history_num)
 	{
 		if (0 != cache->history_num_total)
-			pcnt = 100 * (double)(cache->history_num_total - cache->history_num) / cache->history_num_total;
+			pcnt = 100 * (double)(cache->history_num_total - history_num) / cache->history_num_total;
 
-		cache->history_progress_ts = (0 == cache->history_num ? INT_MAX : sec);
+		cache->history_progress_ts = (0 == history_num ? INT_MAX : sec);
 	}
 
 	ts_next = cache->history_progress_ts;
@@ -1934,7 +2453,7 @@ void	zbx_log_sync_history_cache_progress(void)
 void	zbx_sync_history_cache(const zbx_events_funcs_t *events_cbs, zbx_ipc_async_socket_t *rtc,
 		int config_history_storage_pipelines, int *values_num, int *triggers_num, int *more)
 {
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() history_num:%d", __func__, cache->history_num);
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
 	*values_num = 0;
 	*triggers_num = 0;
@@ -2443,16 +2962,62 @@ void	zbx_dc_add_history_variant(zbx_uint64_t itemid, unsigned char value_type, u
 
 void	zbx_dc_flush_history(void)
 {
+	int	i, shard_values_offset[ZBX_HC_SHARDS_MAX + 1];
+	size_t	j;
+
 	if (0 == item_values_num)
 		return;
 
-	LOCK_CACHE;
+	if (1 == hc_shards_num)
+	{
+		LOCK_CACHE;
 
-	hc_add_item_values(item_values, item_values_num);
+		hc_add_item_values(0, item_values, item_values_num);
+		hc_shards[0]->history_num += item_values_num;
 
-	cache->history_num += item_values_num;
+		UNLOCK_CACHE;
 
-	UNLOCK_CACHE;
+		goto out;
+	}
+
+	/* distribute values by shards with stable counting sort to keep order of item values */
+
+	memset(shard_values_offset, 0, sizeof(shard_values_offset));
+
+	for (j = 0; j < item_values_num; j++)
+		shard_values_offset[hc_shard_index(item_values[j].itemid) + 1]++;
+
+	for (i = 1; i <= hc_shards_num; i++)
+		shard_values_offset[i] += shard_values_offset[i - 1];
+
+	if (shard_values_alloc < item_values_alloc)
+	{
+		shard_values_alloc = item_values_alloc;
+		shard_values = (dc_item_value_t *)zbx_realloc(shard_values, sizeof(dc_item_value_t) *
+				shard_values_alloc);
+	}
+
+	for (j = 0; j < item_values_num; j++)
+		shard_values[shard_values_offset[hc_shard_index(item_values[j].itemid)]++] = item_values[j];
+
+	/* after distribution offsets point to the end of shard values */
+	for (i = 0; i < hc_shards_num; i++)
+	{
+		int	values_start, values_num;
+
+		values_start = (0 == i ? 0 : shard_values_offset[i - 1]);
+
+		if (0 == (values_num = shard_values_offset[i] - values_start))
+			continue;
+
+		hc_shard_lock(i);
+
+		hc_add_item_values(i, shard_values + values_start, values_num);
+		hc_shards[i]->history_num += values_num;
+
+		hc_shard_unlock(i);
+	}
+out:
 
 	zbx_vps_monitor_add_collected((zbx_uint64_t)item_values_num);
 
@@ -2467,6 +3032,7 @@ void	zbx_dc_flush_history(void)
  ******************************************************************************/
 ZBX_SHMEM_FUNC_IMPL(__hc_index, hc_index_mem)
 ZBX_SHMEM_FUNC_IMPL(__hc, hc_mem)
+ZBX_SHMEM_FUNC_IMPL(__hc_global, hc_shards_index_mem[0])
 
 /******************************************************************************
  *                                                                            *
@@ -2535,46 +3101,49 @@ static void	hc_free_data(zbx_hc_data_t *data)
  *                                                                            *
  * Purpose: put back item into history queue                                  *
  *                                                                            *
- * Parameters: data - [IN] history item data                                  *
+ * Parameters: shard - [IN] history cache shard                               *
+ *             item  - [IN] history item                                      *
  *                                                                            *
  ******************************************************************************/
-static void	hc_queue_item(zbx_hc_item_t *item)
+static void	hc_queue_item(zbx_hc_shard_t *shard, zbx_hc_item_t *item)
 {
 	zbx_binary_heap_elem_t	elem = {item->itemid, (void *)item};
 
-	zbx_binary_heap_insert(&cache->history_queue, &elem);
+	zbx_binary_heap_insert(&shard->history_queue, &elem);
 }
 
 /******************************************************************************
  *                                                                            *
  * Purpose: returns history item by itemid                                    *
  *                                                                            *
- * Parameters: itemid - [IN] the item id                                      *
+ * Parameters: shard  - [IN] the history cache shard                         *
+ *             itemid - [IN] the item id                                      *
  *                                                                            *
  * Return value: the history item or NULL if the requested item is not in     *
  *               history cache                                                *
  *                                                                            *
  ******************************************************************************/
-static zbx_hc_item_t	*hc_get_item(zbx_uint64_t itemid)
+static zbx_hc_item_t	*hc_get_item(zbx_hc_shard_t *shard, zbx_uint64_t itemid)
 {
-	return (zbx_hc_item_t *)zbx_hashset_search(&cache->history_items, &itemid);
+	return (zbx_hc_item_t *)zbx_hashset_search(&shard->history_items, &itemid);
 }
 
 /******************************************************************************
  *                                                                            *
  * Purpose: adds a new item to history cache                                  *
  *                                                                            *
- * Parameters: itemid - [IN] the item id                                      *
- *                      [IN] the item data                                    *
+ * Parameters: shard  - [IN] the history cache shard                         *
+ *             itemid - [IN] the item id                                      *
+ *             data   - [IN] the item data                                    *
  *                                                                            *
  * Return value: the added history item                                       *
  *                                                                            *
  ******************************************************************************/
-static zbx_hc_item_t	*hc_add_item(zbx_uint64_t itemid, zbx_hc_data_t *data)
+static zbx_hc_item_t	*hc_add_item(zbx_hc_shard_t *shard, zbx_uint64_t itemid, zbx_hc_data_t *data)
 {
 	zbx_hc_item_t	item_local = {itemid, ZBX_HC_ITEM_STATUS_NORMAL, 0, data, data};
 
-	return (zbx_hc_item_t *)zbx_hashset_insert(&cache->history_items, &item_local, sizeof(item_local));
+	return (zbx_hc_item_t *)zbx_hashset_insert(&shard->history_items, &item_local, sizeof(item_local));
 }
 
 /******************************************************************************
@@ -2671,7 +3240,8 @@ static int	hc_clone_history_log_data(zbx_log_value_t **dst, const dc_item_value_
  *                                                                            *
  * Purpose: clones item value from local cache into history cache             *
  *                                                                            *
- * Parameters: data       - [IN/OUT] a reference to the cloned value          *
+ * Parameters: stats      - [IN/OUT] the history cache shard statistics       *
+ *             data       - [IN/OUT] a reference to the cloned value          *
  *             item_value - [IN] the item value                               *
  *                                                                            *
  * Return value: SUCCESS - the item value was cloned successfully             *
@@ -2681,7 +3251,7 @@ static int	hc_clone_history_log_data(zbx_log_value_t **dst, const dc_item_value_
  *           until it finishes cloning item value.                            *
  *                                                                            *
  ******************************************************************************/
-static int	hc_clone_history_data(zbx_hc_data_t **data, const dc_item_value_t *item_value)
+static int	hc_clone_history_data(zbx_dc_stats_t *stats, zbx_hc_data_t **data, const dc_item_value_t *item_value)
 {
 	if (NULL == *data)
 	{
@@ -2707,7 +3277,7 @@ static int	hc_clone_history_data(zbx_hc_data_t **data, const dc_item_value_t *it
 			return FAIL;
 
 		(*data)->value_type = item_value->value_type;
-		cache->stats.notsupported_counter++;
+		stats->notsupported_counter++;
 
 		return SUCCEED;
 	}
@@ -2719,8 +3289,8 @@ static int	hc_clone_history_data(zbx_hc_data_t **data, const dc_item_value_t *it
 
 		(*data)->value_type = ITEM_VALUE_TYPE_TEXT;
 
-		cache->stats.history_text_counter++;
-		cache->stats.history_counter++;
+		stats->history_text_counter++;
+		stats->history_counter++;
 
 		return SUCCEED;
 	}
@@ -2757,22 +3327,22 @@ static int	hc_clone_history_data(zbx_hc_data_t **data, const dc_item_value_t *it
 		switch (item_value->item_value_type)
 		{
 			case ITEM_VALUE_TYPE_FLOAT:
-				cache->stats.history_float_counter++;
+				stats->history_float_counter++;
 				break;
 			case ITEM_VALUE_TYPE_UINT64:
-				cache->stats.history_uint_counter++;
+				stats->history_uint_counter++;
 				break;
 			case ITEM_VALUE_TYPE_STR:
-				cache->stats.history_str_counter++;
+				stats->history_str_counter++;
 				break;
 			case ITEM_VALUE_TYPE_TEXT:
-				cache->stats.history_text_counter++;
+				stats->history_text_counter++;
 				break;
 			case ITEM_VALUE_TYPE_LOG:
-				cache->stats.history_log_counter++;
+				stats->history_log_counter++;
 				break;
 			case ITEM_VALUE_TYPE_BIN:
-				cache->stats.history_bin_counter++;
+				stats->history_bin_counter++;
 				break;
 			case ITEM_VALUE_TYPE_NONE:
 			default:
@@ -2780,7 +3350,7 @@ static int	hc_clone_history_data(zbx_hc_data_t **data, const dc_item_value_t *it
 				exit(EXIT_FAILURE);
 		}
 
-		cache->stats.history_counter++;
+		stats->history_counter++;
 	}
 
 	(*data)->value_type = item_value->value_type;
@@ -2792,7 +3362,8 @@ static int	hc_clone_history_data(zbx_hc_data_t **data, const dc_item_value_t *it
  *                                                                            *
  * Purpose: adds item values to the history cache                             *
  *                                                                            *
- * Parameters: values     - [IN] the item values to add                       *
+ * Parameters: index      - [IN] the locked history cache shard index         *
+ *             values     - [IN] the item values to add                       *
  *             values_num - [IN] the number of item values to add             *
  *                                                                            *
  * Comments: If the history cache is full this function will wait until       *
@@ -2800,11 +3371,12 @@ static int	hc_clone_history_data(zbx_hc_data_t **data, const dc_item_value_t *it
  *           the new value.                                                   *
  *                                                                            *
  ******************************************************************************/
-static void	hc_add_item_values(dc_item_value_t *values, int values_num)
+static void	hc_add_item_values(int index, dc_item_value_t *values, int values_num)
 {
 	dc_item_value_t	*item_value;
 	int		i;
 	zbx_hc_item_t	*item;
+	zbx_hc_shard_t	*shard = hc_shards[index];
 
 	for (i = 0; i < values_num; i++)
 	{
@@ -2814,7 +3386,8 @@ static void	hc_add_item_values(dc_item_value_t *values, int values_num)
 
 		/* a record with metadata and no value can be dropped if  */
 		/* the metadata update is copied to the last queued value */
-		if (NULL != (item = hc_get_item(item_value->itemid)) && 0 != (item_value->flags & ZBX_DC_FLAG_NOVALUE))
+		if (NULL != (item = hc_get_item(shard, item_value->itemid)) &&
+				0 != (item_value->flags & ZBX_DC_FLAG_NOVALUE))
 		{
 			/* skip metadata updates when only one value is queued, */
 			/* because the item might be already being processed    */
@@ -2831,26 +3404,26 @@ static void	hc_add_item_values(dc_item_value_t *values, int values_num)
 			}
 		}
 
-		if (SUCCEED != hc_clone_history_data(&data, item_value))
+		if (SUCCEED != hc_clone_history_data(&shard->stats, &data, item_value))
 		{
 			do
 			{
-				UNLOCK_CACHE;
+				hc_shard_unlock(index);
 
 				zabbix_log(LOG_LEVEL_DEBUG, "History cache is full. Sleeping for 1 second.");
 				sleep(1);
 
-				LOCK_CACHE;
+				hc_shard_lock(index);
 			}
-			while (SUCCEED != hc_clone_history_data(&data, item_value));
+			while (SUCCEED != hc_clone_history_data(&shard->stats, &data, item_value));
 
-			item = hc_get_item(item_value->itemid);
+			item = hc_get_item(shard, item_value->itemid);
 		}
 
 		if (NULL == item)
 		{
-			item = hc_add_item(item_value->itemid, data);
-			hc_queue_item(item);
+			item = hc_add_item(shard, item_value->itemid, data);
+			hc_queue_item(shard, item);
 		}
 		else
 		{
@@ -2935,22 +3508,44 @@ static void	hc_copy_history_data(zbx_dc_history_t *history, zbx_uint64_t itemid,
  * Parameters: history_items - [OUT] the locked history items                 *
  *                                                                            *
  * Comments: The history_items must be returned back to history cache with    *
- *           zbx_hc_push_items() function after they have been processed.         *
+ *           zbx_hc_push_items() function after they have been processed.     *
+ *           Items are taken from all history cache shards, locking each      *
+ *           shard separately.                                                *
  *                                                                            *
  ******************************************************************************/
 void	zbx_hc_pop_items(zbx_vector_hc_item_ptr_t *history_items)
 {
 	zbx_binary_heap_elem_t	*elem;
 	zbx_hc_item_t		*item;
+	int			i;
 
-	while (ZBX_HC_SYNC_MAX > history_items->values_num && FAIL == zbx_binary_heap_empty(&cache->history_queue))
+	for (i = 0; i < hc_shards_num && ZBX_HC_SYNC_MAX > history_items->values_num; i++)
 	{
-		elem = zbx_binary_heap_find_min(&cache->history_queue);
-		item = elem->data;
-		zbx_vector_hc_item_ptr_append(history_items, item);
+		int		index, items_max;
+		zbx_hc_shard_t	*shard;
+
+		index = (hc_shard_pop + i) % hc_shards_num;
+		shard = hc_shards[index];
+
+		/* split the remaining batch space evenly between the remaining shards */
+		items_max = history_items->values_num + (ZBX_HC_SYNC_MAX - history_items->values_num) /
+				(hc_shards_num - i);
+
+		hc_shard_lock(index);
+
+		while (items_max > history_items->values_num && FAIL == zbx_binary_heap_empty(&shard->history_queue))
+		{
+			elem = zbx_binary_heap_find_min(&shard->history_queue);
+			item = elem->data;
+			zbx_vector_hc_item_ptr_append(history_items, item);
+
+			zbx_binary_heap_remove_min(&shard->history_queue);
+		}
 
-		zbx_binary_heap_remove_min(&cache->history_queue);
+		hc_shard_unlock(index);
 	}
+
+	hc_shard_pop = (hc_shard_pop + 1) % hc_shards_num;
 }
 
 /******************************************************************************
@@ -2989,36 +3584,57 @@ void	zbx_hc_get_item_values(zbx_dc_history_t *history, zbx_vector_hc_item_ptr_t
  * Comments: This function removes processed value from history cache.        *
  *           If there is no more data for this item, then the item itself is  *
  *           removed from history index.                                      *
+ *           Items are returned to their history cache shards, locking each   *
+ *           shard separately.                                                *
  *                                                                            *
  ******************************************************************************/
 void	zbx_hc_push_items(zbx_vector_hc_item_ptr_t *history_items)
 {
-	int		i;
+	int		i, index;
 	zbx_hc_item_t	*item;
 	zbx_hc_data_t	*data_free;
 
-	for (i = 0; i < history_items->values_num; i++)
+	for (index = 0; index < hc_shards_num; index++)
 	{
-		item = history_items->values[i];
+		zbx_hc_shard_t	*shard = hc_shards[index];
+		int		locked = 0;
 
-		switch (item->status)
+		for (i = 0; i < history_items->values_num; i++)
 		{
-			case ZBX_HC_ITEM_STATUS_BUSY:
-				/* reset item status before returning it to queue */
-				item->status = ZBX_HC_ITEM_STATUS_NORMAL;
-				hc_queue_item(item);
-				break;
-			case ZBX_HC_ITEM_STATUS_NORMAL:
-				item->values_num--;
-				data_free = item->tail;
-				item->tail = item->tail->next;
-				hc_free_data(data_free);
-				if (NULL == item->tail)
-					zbx_hashset_remove(&cache->history_items, item);
-				else
-					hc_queue_item(item);
-				break;
+			item = history_items->values[i];
+
+			if (1 != hc_shards_num && index != hc_shard_index(item->itemid))
+				continue;
+
+			if (0 == locked)
+			{
+				hc_shard_lock(index);
+				locked = 1;
+			}
+
+			switch (item->status)
+			{
+				case ZBX_HC_ITEM_STATUS_BUSY:
+					/* reset item status before returning it to queue */
+					item->status = ZBX_HC_ITEM_STATUS_NORMAL;
+					hc_queue_item(shard, item);
+					break;
+				case ZBX_HC_ITEM_STATUS_NORMAL:
+					item->values_num--;
+					shard->history_num--;
+					data_free = item->tail;
+					item->tail = item->tail->next;
+					hc_free_data(data_free);
+					if (NULL == item->tail)
+						zbx_hashset_remove(&shard->history_items, item);
+					else
+						hc_queue_item(shard, item);
+					break;
+			}
 		}
+
+		if (0 != locked)
+			hc_shard_unlock(index);
 	}
 }
 
@@ -3029,7 +3645,16 @@ void	zbx_hc_push_items(zbx_vector_hc_item_ptr_t *history_items)
  ******************************************************************************/
 int	zbx_hc_queue_get_size(void)
 {
-	return cache->history_queue.elems_num;
+	int	i, size = 0;
+
+	for (i = 0; i < hc_shards_num; i++)
+	{
+		hc_shard_lock(i);
+		size += hc_shards[i]->history_queue.elems_num;
+		hc_shard_unlock(i);
+	}
+
+	return size;
 }
 
 int	zbx_hc_get_history_compression_age(void)
@@ -3093,6 +3718,14 @@ static int	init_trend_cache(zbx_uint64_t *trends_cache_size, char **error)
 			ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC, NULL,
 			__trend_shmem_malloc_func, __trend_shmem_realloc_func, __trend_shmem_free_func);
 
+	zbx_hashset_create_ext(&cache->trends_pending, 0,
+			ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC, NULL,
+			__trend_shmem_malloc_func, __trend_shmem_realloc_func, __trend_shmem_free_func);
+
+	cache->trends_pending_hour = 0;
+	cache->trends_pending_num = 0;
+	cache->trends_pending_flushed = 0;
+
 #undef INIT_HASHSET_SIZE
 out:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
@@ -3106,15 +3739,16 @@ out:
  *                                                                            *
  ******************************************************************************/
 int	zbx_init_database_cache(zbx_get_program_type_f get_program_type, zbx_history_sync_f sync_history,
-		zbx_uint64_t history_cache_size, zbx_uint64_t history_index_cache_size,zbx_uint64_t *trends_cache_size,
-		char **error)
+		zbx_uint64_t history_cache_size, zbx_uint64_t history_index_cache_size, int history_cache_shards,
+		zbx_uint64_t *trends_cache_size, int flush_period, char **error)
 {
-	int	ret;
+	int	ret, i;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
 	get_program_type_cb = get_program_type;
 	sync_history_cb = sync_history;
+	trends_flush_period = flush_period;
 
 	if (NULL != cache)
 	{
@@ -3122,45 +3756,71 @@ int	zbx_init_database_cache(zbx_get_program_type_f get_program_type, zbx_history
 		goto out;
 	}
 
-	if (SUCCEED != (ret = zbx_mutex_create(&cache_lock, ZBX_MUTEX_CACHE, error)))
+	if (1 > history_cache_shards || ZBX_HC_SHARDS_MAX < history_cache_shards)
+	{
+		*error = zbx_dsprintf(*error, "invalid number of history cache shards: %d", history_cache_shards);
+		ret = FAIL;
 		goto out;
+	}
 
 	if (SUCCEED != (ret = zbx_mutex_create(&cache_ids_lock, ZBX_MUTEX_CACHE_IDS, error)))
 		goto out;
 
-	if (SUCCEED != (ret = zbx_shmem_create(&hc_mem, history_cache_size, "history cache",
-			"HistoryCacheSize", 1, error)))
+	/* the history cache and history index cache memory is split evenly between shards */
+	for (i = 0; i < history_cache_shards; i++)
 	{
-		goto out;
-	}
+		zbx_mutex_name_t	lock_name = (0 == i ? ZBX_MUTEX_CACHE : ZBX_MUTEX_CACHE_SHARD1 + i - 1);
 
-	if (SUCCEED != (ret = zbx_shmem_create(&hc_index_mem, history_index_cache_size, "history index cache",
-			"HistoryIndexCacheSize", 0, error)))
-	{
-		goto out;
+		if (SUCCEED != (ret = zbx_mutex_create(&hc_shards_lock[i], lock_name, error)))
+			goto out;
+
+		if (SUCCEED != (ret = zbx_shmem_create(&hc_shards_mem[i], history_cache_size / history_cache_shards,
+				"history cache", "HistoryCacheSize", 1, error)))
+		{
+			goto out;
+		}
+
+		/* history values and their string data are small objects, use slabs to limit fragmentation */
+		zbx_shmem_enable_slabs(hc_shards_mem[i]);
+
+		if (SUCCEED != (ret = zbx_shmem_create(&hc_shards_index_mem[i],
+				history_index_cache_size / history_cache_shards, "history index cache",
+				"HistoryIndexCacheSize", 0, error)))
+		{
+			goto out;
+		}
+
+		hc_index_mem = hc_shards_index_mem[i];
+
+		hc_shards[i] = (zbx_hc_shard_t *)__hc_index_shmem_malloc_func(NULL, sizeof(zbx_hc_shard_t));
+		memset(hc_shards[i], 0, sizeof(zbx_hc_shard_t));
+
+		zbx_hashset_create_ext(&hc_shards[i]->history_items, ZBX_HC_ITEMS_INIT_SIZE / history_cache_shards,
+				ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC, NULL,
+				__hc_index_shmem_malloc_func, __hc_index_shmem_realloc_func,
+				__hc_index_shmem_free_func);
+
+		zbx_binary_heap_create_ext(&hc_shards[i]->history_queue, hc_queue_elem_compare_func,
+				ZBX_BINARY_HEAP_OPTION_EMPTY, __hc_index_shmem_malloc_func,
+				__hc_index_shmem_realloc_func, __hc_index_shmem_free_func);
 	}
 
-	cache = (ZBX_DC_CACHE *)__hc_index_shmem_malloc_func(NULL, sizeof(ZBX_DC_CACHE));
+	hc_shards_num = history_cache_shards;
+
+	cache = (ZBX_DC_CACHE *)__hc_global_shmem_malloc_func(NULL, sizeof(ZBX_DC_CACHE));
 	memset(cache, 0, sizeof(ZBX_DC_CACHE));
 
-	ids = (ZBX_DC_IDS *)__hc_index_shmem_malloc_func(NULL, sizeof(ZBX_DC_IDS));
+	ids = (ZBX_DC_IDS *)__hc_global_shmem_malloc_func(NULL, sizeof(ZBX_DC_IDS));
 	memset(ids, 0, sizeof(ZBX_DC_IDS));
 
-	zbx_hashset_create_ext(&cache->history_items, ZBX_HC_ITEMS_INIT_SIZE,
-			ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC, NULL,
-			__hc_index_shmem_malloc_func, __hc_index_shmem_realloc_func, __hc_index_shmem_free_func);
-
-	zbx_binary_heap_create_ext(&cache->history_queue, hc_queue_elem_compare_func, ZBX_BINARY_HEAP_OPTION_EMPTY,
-			__hc_index_shmem_malloc_func, __hc_index_shmem_realloc_func, __hc_index_shmem_free_func);
-
 	if (0 != (get_program_type_cb() & ZBX_PROGRAM_TYPE_SERVER))
 	{
 		zbx_hashset_create_ext(&(cache->proxyqueue.index), ZBX_HC_SYNC_MAX,
 			ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC, NULL,
-			__hc_index_shmem_malloc_func, __hc_index_shmem_realloc_func, __hc_index_shmem_free_func);
+			__hc_global_shmem_malloc_func, __hc_global_shmem_realloc_func, __hc_global_shmem_free_func);
 
-		zbx_list_create_ext(&(cache->proxyqueue.list), __hc_index_shmem_malloc_func,
-				__hc_index_shmem_free_func);
+		zbx_list_create_ext(&(cache->proxyqueue.list), __hc_global_shmem_malloc_func,
+				__hc_global_shmem_free_func);
 
 		cache->proxyqueue.state = ZBX_HC_PROXYQUEUE_STATE_NORMAL;
 
@@ -3205,6 +3865,8 @@ static void	DCsync_all(const zbx_events_funcs_t *events_cbs, int config_history_
  ******************************************************************************/
 void	zbx_free_database_cache(int sync, const zbx_events_funcs_t *events_cbs, int config_history_storage_pipelines)
 {
+	int	i;
+
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
 	if (ZBX_SYNC_ALL == sync)
@@ -3212,12 +3874,21 @@ void	zbx_free_database_cache(int sync, const zbx_events_funcs_t *events_cbs, int
 
 	cache = NULL;
 
-	zbx_shmem_destroy(hc_mem);
+	for (i = 0; i < hc_shards_num; i++)
+	{
+		zbx_shmem_destroy(hc_shards_mem[i]);
+		hc_shards_mem[i] = NULL;
+		zbx_shmem_destroy(hc_shards_index_mem[i]);
+		hc_shards_index_mem[i] = NULL;
+		hc_shards[i] = NULL;
+
+		zbx_mutex_destroy(&hc_shards_lock[i]);
+	}
+
+	hc_shards_num = 0;
 	hc_mem = NULL;
-	zbx_shmem_destroy(hc_index_mem);
 	hc_index_mem = NULL;
 
-	zbx_mutex_destroy(&cache_lock);
 	zbx_mutex_destroy(&cache_ids_lock);
 
 	if (0 != (get_program_type_cb() & ZBX_PROGRAM_TYPE_SERVER))
@@ -3338,12 +4009,66 @@ out:
  ******************************************************************************/
 void	zbx_hc_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num)
 {
-	LOCK_CACHE;
+	int	i;
 
-	*values_num = cache->history_num;
-	*items_num = cache->history_items.num_data;
+	*values_num = 0;
+	*items_num = 0;
 
-	UNLOCK_CACHE;
+	for (i = 0; i < hc_shards_num; i++)
+	{
+		hc_shard_lock(i);
+
+		*values_num += hc_shards[i]->history_num;
+		*items_num += hc_shards[i]->history_items.num_data;
+
+		hc_shard_unlock(i);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds shared memory allocator statistics of a shard segment to     *
+ *          the total statistics                                              *
+ *                                                                            *
+ * Parameters: info  - [IN] the shard memory segment                          *
+ *             total - [IN/OUT] the total statistics                          *
+ *             first - [IN] 1 if this is the first segment, 0 otherwise       *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_shmem_stats_add(const zbx_shmem_info_t *info, zbx_shmem_stats_t *total, int first)
+{
+	zbx_shmem_stats_t	stats;
+	int			i;
+
+	if (0 != first)
+	{
+		zbx_shmem_get_stats(info, total);
+		return;
+	}
+
+	zbx_shmem_get_stats(info, &stats);
+
+	total->free_size += stats.free_size;
+	total->used_size += stats.used_size;
+	total->overhead += stats.overhead;
+	total->free_chunks += stats.free_chunks;
+	total->used_chunks += stats.used_chunks;
+
+	if (stats.min_chunk_size < total->min_chunk_size)
+		total->min_chunk_size = stats.min_chunk_size;
+
+	if (stats.max_chunk_size > total->max_chunk_size)
+		total->max_chunk_size = stats.max_chunk_size;
+
+	for (i = 0; i < ZBX_SHMEM_BUCKET_COUNT; i++)
+		total->chunks_num[i] += stats.chunks_num[i];
+
+	for (i = 0; i < ZBX_SHMEM_SLAB_CLASS_COUNT; i++)
+	{
+		total->slabs[i].pages += stats.slabs[i].pages;
+		total->slabs[i].used += stats.slabs[i].used;
+		total->slabs[i].total += stats.slabs[i].total;
+	}
 }
 
 /******************************************************************************
@@ -3353,15 +4078,20 @@ void	zbx_hc_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num)
  ******************************************************************************/
 void	zbx_hc_get_mem_stats(zbx_shmem_stats_t *data, zbx_shmem_stats_t *index)
 {
-	LOCK_CACHE;
+	int	i;
 
-	if (NULL != data)
-		zbx_shmem_get_stats(hc_mem, data);
+	for (i = 0; i < hc_shards_num; i++)
+	{
+		hc_shard_lock(i);
 
-	if (NULL != index)
-		zbx_shmem_get_stats(hc_index_mem, index);
+		if (NULL != data)
+			hc_shmem_stats_add(hc_shards_mem[i], data, 0 == i);
 
-	UNLOCK_CACHE;
+		if (NULL != index)
+			hc_shmem_stats_add(hc_shards_index_mem[i], index, 0 == i);
+
+		hc_shard_unlock(i);
+	}
 }
 
 /******************************************************************************
@@ -3373,19 +4103,23 @@ void	zbx_hc_get_items(zbx_vector_uint64_pair_t *items)
 {
 	zbx_hashset_iter_t	iter;
 	zbx_hc_item_t		*item;
+	int			i;
 
-	LOCK_CACHE;
+	for (i = 0; i < hc_shards_num; i++)
+	{
+		hc_shard_lock(i);
 
-	zbx_vector_uint64_pair_reserve(items, cache->history_items.num_data);
+		zbx_vector_uint64_pair_reserve(items, items->values_num + hc_shards[i]->history_items.num_data);
 
-	zbx_hashset_iter_reset(&cache->history_items, &iter);
-	while (NULL != (item = (zbx_hc_item_t *)zbx_hashset_iter_next(&iter)))
-	{
-		zbx_uint64_pair_t	pair = {item->itemid, item->values_num};
-		zbx_vector_uint64_pair_append_ptr(items, &pair);
-	}
+		zbx_hashset_iter_reset(&hc_shards[i]->history_items, &iter);
+		while (NULL != (item = (zbx_hc_item_t *)zbx_hashset_iter_next(&iter)))
+		{
+			zbx_uint64_pair_t	pair = {item->itemid, item->values_num};
+			zbx_vector_uint64_pair_append_ptr(items, &pair);
+		}
 
-	UNLOCK_CACHE;
+		hc_shard_unlock(i);
+	}
 }
 
 /******************************************************************************
@@ -3495,19 +4229,20 @@ void	zbx_dbcache_unlock(void)
 	UNLOCK_CACHE;
 }
 
-void	zbx_dbcache_set_history_num(int num)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns percentage of used history cache memory in all shards     *
+ *                                                                            *
+ * Comments: The history cache must be locked with zbx_dbcache_lock().        *
+ *                                                                            *
+ ******************************************************************************/
+double	zbx_dbcache_get_hc_pused(void)
 {
-	cache->history_num = num;
-}
+	zbx_uint64_t	total_size, free_size, index_total_size, index_free_size;
 
-int	zbx_dbcache_get_history_num(void)
-{
-	return cache->history_num;
-}
+	hc_get_mem_size(&total_size, &free_size, &index_total_size, &index_free_size);
 
-zbx_shmem_info_t	*zbx_dbcache_get_hc_mem(void)
-{
-	return hc_mem;
+	return 100 * (double)(total_size - free_size) / total_size;
 }
 
 void	zbx_dbcache_setproxyqueue_state(int proxyqueue_state)
@@ -87,6 +87,18 @@ ZBX_SHMEM_FUNC_IMPL(__vc, vc_mem)
 
 #define ZBX_VC_ITEM_EXPIRE_PERIOD	SEC_PER_DAY
 
+/* the item history is being loaded by prefetch, new values must be cached meanwhile */
+#define ZBX_ITEM_STATUS_PREFETCH	2
+
+/* the maximum number of items prefetched with one history request */
+#define ZBX_VC_PREFETCH_BATCH_SIZE	500
+
+/* the number of items prefetched with one request until the history size per item second is known */
+#define ZBX_VC_PREFETCH_PROBE_SIZE	16
+
+/* the maximum ratio of the largest and smallest item range in one prefetch batch */
+#define ZBX_VC_PREFETCH_RANGE_FACTOR	2
+
 /* the data chunk used to store data fragment */
 typedef struct zbx_vc_chunk
 {
@@ -102,9 +114,18 @@ typedef struct zbx_vc_chunk
 	/* the index of last (newest) value in chunk */
 	int			last_value;
 
-	/* the number of item value slots in chunk */
+	/* the number of item value slots in chunk, for packed chunks - the number of encoded values */
 	int			slots_num;
 
+	/* The size of packed value data in bytes or 0 if the chunk is not packed.           */
+	/* Packed chunks keep decoded copies of the first and last values in slots[0] and    */
+	/* slots[1], followed by the encoded values (see vch_chunk_pack() for the format).   */
+	int			packed_size;
+
+	/* The aggregates of sealed numeric chunk values. They are valid only while the number */
+	/* of aggregated values matches the number of values in chunk.                         */
+	zbx_vc_aggregate_t	summary;
+
 	/* the item value data */
 	zbx_history_record_t	slots[1];
 }
@@ -118,6 +139,9 @@ zbx_vc_chunk_t;
 #define ZBX_VC_MAX_CHUNK_RECORDS	((64 * ZBX_KIBIBYTE - sizeof(zbx_vc_chunk_t)) / \
 		sizeof(zbx_history_record_t) + 1)
 
+/* the minimum number of values in chunk to be worth packing */
+#define ZBX_VC_MIN_PACK_RECORDS		8
+
 /* the value cache item data */
 typedef struct
 {
@@ -256,6 +280,8 @@ zbx_vc_item_update_t;
 ZBX_VECTOR_DECL(vc_itemupdate, zbx_vc_item_update_t)
 ZBX_VECTOR_IMPL(vc_itemupdate, zbx_vc_item_update_t)
 
+ZBX_VECTOR_IMPL(vc_item_range, zbx_vc_item_range_t)
+
 static zbx_vector_vc_itemupdate_t	vc_itemupdates;
 
 static void	vc_cache_item_update(zbx_uint64_t itemid, zbx_vc_item_update_type_t type, int arg1, int arg2)
@@ -1267,238 +1293,921 @@ static void	vc_item_update_db_cached_from(zbx_vc_item_t *item, int timestamp)
  * range) are automatically removed from cache.
  */
 
+/*
+ * Sealed chunks of numeric (float and unsigned) items can be packed to save
+ * memory. Packed chunks store the values as a bit stream:
+ *
+ *   the first value - 32 bits of seconds, 30 bits of nanoseconds and 64 bits
+ *                     of value data;
+ *   other values    - delta-of-delta encoded seconds, nanoseconds either
+ *                     flagged as unchanged or written as 30 bits, and value
+ *                     data XORed with the previous value, storing only the
+ *                     meaningful bits.
+ *
+ * Packed chunks are read only - they are unpacked before values are inserted
+ * in them and decoded in local process buffer before values are read.
+ */
+
+/* the upper bound of bits required to encode one value */
+#define ZBX_VC_PACKED_VALUE_BITS_MAX	(4 + 64 + 1 + 30 + 2 + 6 + 6 + 64)
+
+typedef struct
+{
+	unsigned char	*data;
+	size_t		pos;
+}
+zbx_vc_bitstream_t;
+
+/* the number of recently decoded packed chunks kept in local process memory */
+#define ZBX_VC_UNPACKED_CACHE_SIZE	4
+
+/* decoded packed chunk, identified by its encoded data */
+typedef struct
+{
+	zbx_history_record_t	*values;
+	int			values_alloc;
+	int			values_num;
+	unsigned char		*data;
+	int			data_alloc;
+	int			data_size;
+}
+zbx_vc_unpacked_t;
+
+static zbx_vc_unpacked_t	vc_unpacked[ZBX_VC_UNPACKED_CACHE_SIZE];
+static int			vc_unpacked_next = 0;
+
+static unsigned char	*vc_pack_buf = NULL;
+static size_t		vc_pack_alloc = 0;
+
 /******************************************************************************
  *                                                                            *
- * Purpose: updates item range with current request range                     *
+ * Purpose: writes the lowest bits of value to bit stream                     *
  *                                                                            *
- * Parameters: item   - [IN] the item                                         *
- *             range  - [IN] the request range                                *
- *             now    - [IN] the current timestamp                            *
+ * Comments: The stream buffer must be zero initialized and large enough.     *
  *                                                                            *
  ******************************************************************************/
-static void	vch_item_update_range(zbx_vc_item_t *item, int range, int now)
+static void	vc_bits_write(zbx_vc_bitstream_t *bs, zbx_uint64_t value, int bits)
 {
-	int		diff, last_value_timestamp;
-	unsigned char	hour;
+	while (0 < bits)
+	{
+		int	offset = (int)(bs->pos & 7), n = 8 - offset;
 
-	if (VC_MIN_RANGE > range)
-		range = VC_MIN_RANGE;
+		if (n > bits)
+			n = bits;
 
-	if (item->daily_range < range)
-		item->daily_range = range;
+		bs->data[bs->pos >> 3] |= (unsigned char)(((value >> (bits - n)) & ((1u << n) - 1)) <<
+				(8 - offset - n));
+		bs->pos += (size_t)n;
+		bits -= n;
+	}
+}
 
-	hour = (unsigned char)((now / SEC_PER_HOUR) & 0xff);
+static zbx_uint64_t	vc_bits_read(zbx_vc_bitstream_t *bs, int bits)
+{
+	zbx_uint64_t	value = 0;
 
-	if (0 > (diff = hour - item->range_sync_hour))
-		diff += 0xff;
+	while (0 < bits)
+	{
+		int	offset = (int)(bs->pos & 7), n = 8 - offset;
 
-	if (NULL != item->head)
-		last_value_timestamp = item->head->slots[item->head->last_value].timestamp.sec;
-	else
-		last_value_timestamp = now;
+		if (n > bits)
+			n = bits;
 
-	if (item->active_range < item->daily_range || (ZBX_VC_RANGE_SYNC_PERIOD < diff &&
-			(now - last_value_timestamp) / SEC_PER_HOUR < ZBX_VC_RANGE_SYNC_PERIOD))
-	{
-		item->active_range = item->daily_range;
-		item->daily_range = range;
-		item->range_sync_hour = hour;
+		value = (value << n) | ((bs->data[bs->pos >> 3] >> (8 - offset - n)) & ((1u << n) - 1));
+		bs->pos += (size_t)n;
+		bits -= n;
 	}
+
+	return value;
 }
 
-/******************************************************************************
- *                                                                            *
- * Purpose: calculates optimal number of slots for an item data chunk         *
- *                                                                            *
- * Parameters:  item        - [IN] the item                                   *
- *              values_new  - [IN] the number of values to be added           *
- *                                                                            *
- * Return value: the number of slots for a new item data chunk                *
- *                                                                            *
- * Comments: From size perspective the optimal slot count per chunk is        *
- *           approximately square root of the number of cached values.        *
- *           Still creating too many chunks might affect timeshift request    *
- *           performance, so don't try creating more than 32 chunks unless    *
- *           the calculated slot count exceeds the maximum limit.             *
- *                                                                            *
- ******************************************************************************/
-static int	vch_item_chunk_slot_count(zbx_vc_item_t *item, int values_new)
+static int	vc_bits_leading_zeros(zbx_uint64_t x)
 {
-	int	nslots, values;
+	int	n = 0;
 
-	values = item->values_total + values_new;
+	if (0 == (x & __UINT64_C(0xffffffff00000000)))
+	{
+		n += 32;
+		x <<= 32;
+	}
+	if (0 == (x & __UINT64_C(0xffff000000000000)))
+	{
+		n += 16;
+		x <<= 16;
+	}
+	if (0 == (x & __UINT64_C(0xff00000000000000)))
+	{
+		n += 8;
+		x <<= 8;
+	}
 
-	nslots = (int)zbx_isqrt32((unsigned int)values);
+	while (0 == (x & __UINT64_C(0x8000000000000000)))
+	{
+		n++;
+		x <<= 1;
+	}
 
-	if ((values + nslots - 1) / nslots + 1 > 32)
-		nslots = values / 32;
+	return n;
+}
 
-	if (nslots > (int)ZBX_VC_MAX_CHUNK_RECORDS)
-		nslots = ZBX_VC_MAX_CHUNK_RECORDS;
-	if (nslots < (int)ZBX_VC_MIN_CHUNK_RECORDS)
-		nslots = ZBX_VC_MIN_CHUNK_RECORDS;
+static int	vc_bits_trailing_zeros(zbx_uint64_t x)
+{
+	int	n = 0;
 
-	return nslots;
+	if (0 == (x & __UINT64_C(0xffffffff)))
+	{
+		n += 32;
+		x >>= 32;
+	}
+	if (0 == (x & __UINT64_C(0xffff)))
+	{
+		n += 16;
+		x >>= 16;
+	}
+	if (0 == (x & __UINT64_C(0xff)))
+	{
+		n += 8;
+		x >>= 8;
+	}
+
+	while (0 == (x & 1))
+	{
+		n++;
+		x >>= 1;
+	}
+
+	return n;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: adds a new data chunk at the end of item's history data list      *
+ * Purpose: encodes numeric history records into bit stream                   *
  *                                                                            *
- * Parameters: item          - [IN/OUT] the item to add chunk to              *
- *             nslots        - [IN] the number of slots in the new chunk      *
- *             insert_before - [IN] the target chunk before which the new     *
- *                             chunk must be inserted. If this value is NULL  *
- *                             then the new chunk is appended at the end of   *
- *                             chunk list (making it the newest chunk).       *
+ * Parameters: values     - [IN] the records to encode                        *
+ *             values_num - [IN] the number of records                        *
+ *             data       - [OUT] the zero initialized output buffer, at      *
+ *                                least ZBX_VC_PACKED_VALUE_BITS_MAX bits per *
+ *                                record                                      *
  *                                                                            *
- * Return value:  SUCCEED - the chunk was added successfully                  *
- *                FAIL - failed to create a new chunk (not enough memory)     *
+ * Return value: the number of bytes written                                  *
  *                                                                            *
  ******************************************************************************/
-static int	vch_item_add_chunk(zbx_vc_item_t *item, int nslots, zbx_vc_chunk_t *insert_before)
+static size_t	vch_values_encode(const zbx_history_record_t *values, int values_num, unsigned char *data)
 {
-	zbx_vc_chunk_t	*chunk;
-	size_t		chunk_size;
+	zbx_vc_bitstream_t	bs = {data, 0};
+	zbx_int64_t		delta_prev = 0;
+	zbx_uint64_t		value_prev;
+	int			i, lead_prev = -1, trail_prev = 0;
 
-	chunk_size =sizeof(zbx_vc_chunk_t) + sizeof(zbx_history_record_t) * (size_t)(nslots - 1);
+	vc_bits_write(&bs, (zbx_uint64_t)(unsigned int)values[0].timestamp.sec, 32);
+	vc_bits_write(&bs, (zbx_uint64_t)values[0].timestamp.ns, 30);
+	vc_bits_write(&bs, values[0].value.ui64, 64);
+	value_prev = values[0].value.ui64;
 
-	if (NULL == (chunk = (zbx_vc_chunk_t *)vc_item_malloc(item, chunk_size)))
-		return FAIL;
+	for (i = 1; i < values_num; i++)
+	{
+		zbx_int64_t	delta, dod;
+		zbx_uint64_t	zz, x;
 
-	memset(chunk, 0, sizeof(zbx_vc_chunk_t));
-	chunk->slots_num = nslots;
+		delta = (zbx_int64_t)values[i].timestamp.sec - values[i - 1].timestamp.sec;
+		dod = delta - delta_prev;
+		delta_prev = delta;
+		zz = (0 > dod ? ((zbx_uint64_t)(-(dod + 1)) << 1) | 1 : (zbx_uint64_t)dod << 1);
 
-	chunk->next = insert_before;
+		if (0 == zz)
+		{
+			vc_bits_write(&bs, 0, 1);
+		}
+		else if (zz < (1 << 7))
+		{
+			vc_bits_write(&bs, 2, 2);
+			vc_bits_write(&bs, zz, 7);
+		}
+		else if (zz < (1 << 9))
+		{
+			vc_bits_write(&bs, 6, 3);
+			vc_bits_write(&bs, zz, 9);
+		}
+		else if (zz < (1 << 12))
+		{
+			vc_bits_write(&bs, 14, 4);
+			vc_bits_write(&bs, zz, 12);
+		}
+		else
+		{
+			vc_bits_write(&bs, 15, 4);
+			vc_bits_write(&bs, zz, 64);
+		}
 
-	if (NULL == insert_before)
-	{
-		chunk->prev = item->head;
+		if (values[i].timestamp.ns == values[i - 1].timestamp.ns)
+		{
+			vc_bits_write(&bs, 0, 1);
+		}
+		else
+		{
+			vc_bits_write(&bs, 1, 1);
+			vc_bits_write(&bs, (zbx_uint64_t)values[i].timestamp.ns, 30);
+		}
 
-		if (NULL != item->head)
-			item->head->next = chunk;
+		if (0 == (x = values[i].value.ui64 ^ value_prev))
+		{
+			vc_bits_write(&bs, 0, 1);
+		}
 		else
-			item->tail = chunk;
+		{
+			int	lead, trail;
 
-		item->head = chunk;
-	}
-	else
-	{
-		chunk->prev = insert_before->prev;
-		insert_before->prev = chunk;
+			lead = vc_bits_leading_zeros(x);
+			trail = vc_bits_trailing_zeros(x);
 
-		if (item->tail == insert_before)
-			item->tail = chunk;
-		else
-			chunk->prev->next = chunk;
+			if (-1 != lead_prev && lead >= lead_prev && trail >= trail_prev)
+			{
+				vc_bits_write(&bs, 2, 2);
+				vc_bits_write(&bs, x >> trail_prev, 64 - lead_prev - trail_prev);
+			}
+			else
+			{
+				vc_bits_write(&bs, 3, 2);
+				vc_bits_write(&bs, (zbx_uint64_t)lead, 6);
+				vc_bits_write(&bs, (zbx_uint64_t)(64 - lead - trail - 1), 6);
+				vc_bits_write(&bs, x >> trail, 64 - lead - trail);
+				lead_prev = lead;
+				trail_prev = trail;
+			}
+		}
+
+		value_prev = values[i].value.ui64;
 	}
 
-	return SUCCEED;
+	return (bs.pos + 7) >> 3;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: find the index of the last value in chunk with timestamp less or  *
- *          equal to the specified timestamp.                                 *
- *                                                                            *
- * Parameters:  chunk - [IN] the chunk                                        *
- *              ts    - [IN] the target timestamp                             *
+ * Purpose: decodes numeric history records from bit stream                   *
  *                                                                            *
- * Return value: The index of the last value in chunk with timestamp less or  *
- *               equal to the specified timestamp.                            *
- *               -1 is returned in the case of failure (meaning that all      *
- *               values have timestamps greater than the target timestamp).   *
+ * Parameters: data       - [IN] the encoded data                             *
+ *             values_num - [IN] the number of encoded records                *
+ *             values     - [OUT] the decoded records                         *
  *                                                                            *
  ******************************************************************************/
-static int	vch_chunk_find_last_value_before(const zbx_vc_chunk_t *chunk, const zbx_timespec_t *ts)
+static void	vch_values_decode(const unsigned char *data, int values_num, zbx_history_record_t *values)
 {
-	int	start = chunk->first_value, end = chunk->last_value, middle;
-
-	/* check if the last value timestamp is already greater or equal to the specified timestamp */
-	if (0 >= zbx_timespec_compare(&chunk->slots[end].timestamp, ts))
-		return end;
+	zbx_vc_bitstream_t	bs = {(unsigned char *)data, 0};
+	zbx_int64_t		delta = 0;
+	int			i, lead = 0, trail = 0;
 
-	/* chunk contains only one value, which did not pass the above check, return failure */
-	if (start == end)
-		return -1;
+	values[0].timestamp.sec = (int)vc_bits_read(&bs, 32);
+	values[0].timestamp.ns = (int)vc_bits_read(&bs, 30);
+	values[0].value.ui64 = vc_bits_read(&bs, 64);
 
-	/* perform value lookup using binary search */
-	while (start != end)
+	for (i = 1; i < values_num; i++)
 	{
-		middle = start + (end - start) / 2;
+		zbx_uint64_t	zz = 0, x = 0;
 
-		if (0 < zbx_timespec_compare(&chunk->slots[middle].timestamp, ts))
+		if (0 != vc_bits_read(&bs, 1))
 		{
-			end = middle;
-			continue;
+			if (0 == vc_bits_read(&bs, 1))
+				zz = vc_bits_read(&bs, 7);
+			else if (0 == vc_bits_read(&bs, 1))
+				zz = vc_bits_read(&bs, 9);
+			else if (0 == vc_bits_read(&bs, 1))
+				zz = vc_bits_read(&bs, 12);
+			else
+				zz = vc_bits_read(&bs, 64);
 		}
 
-		if (0 >= zbx_timespec_compare(&chunk->slots[middle + 1].timestamp, ts))
+		delta += (0 != (zz & 1) ? -(zbx_int64_t)(zz >> 1) - 1 : (zbx_int64_t)(zz >> 1));
+		values[i].timestamp.sec = (int)(values[i - 1].timestamp.sec + delta);
+
+		if (0 == vc_bits_read(&bs, 1))
+			values[i].timestamp.ns = values[i - 1].timestamp.ns;
+		else
+			values[i].timestamp.ns = (int)vc_bits_read(&bs, 30);
+
+		if (0 != vc_bits_read(&bs, 1))
 		{
-			start = middle;
-			continue;
+			int	len;
+
+			if (0 == vc_bits_read(&bs, 1))
+			{
+				len = 64 - lead - trail;
+			}
+			else
+			{
+				lead = (int)vc_bits_read(&bs, 6);
+				len = (int)vc_bits_read(&bs, 6) + 1;
+				trail = 64 - lead - len;
+			}
+
+			x = vc_bits_read(&bs, len) << trail;
 		}
 
-		return middle;
+		values[i].value.ui64 = values[i - 1].value.ui64 ^ x;
 	}
+}
 
-	return -1;
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns the oldest value in chunk                                 *
+ *                                                                            *
+ ******************************************************************************/
+static const zbx_history_record_t	*vch_chunk_first(const zbx_vc_chunk_t *chunk)
+{
+	return 0 == chunk->packed_size ? &chunk->slots[chunk->first_value] : &chunk->slots[0];
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: gets the chunk and index of the last value with a timestamp less  *
- *          or equal to the specified timestamp                               *
+ * Purpose: returns the newest value in chunk                                 *
  *                                                                            *
- * Parameters:  item          - [IN] the item                                 *
- *              ts            - [IN] the target timestamp                     *
- *                                   (NULL - current time)                    *
- *              pchunk        - [OUT] the chunk containing the target value   *
- *              pindex        - [OUT] the index of the target value           *
+ ******************************************************************************/
+static const zbx_history_record_t	*vch_chunk_last(const zbx_vc_chunk_t *chunk)
+{
+	return 0 == chunk->packed_size ? &chunk->slots[chunk->last_value] : &chunk->slots[1];
+}
+
+/******************************************************************************
  *                                                                            *
- * Return value: SUCCEED - the last value was found successfully              *
- *               FAIL - all values in cache have timestamps greater than the  *
- *                      target (timeshift) timestamp.                         *
+ * Purpose: returns the memory size allocated for chunk                       *
  *                                                                            *
- * Comments: If end_timestamp value is 0, then simply the last item value in  *
- *           cache is returned.                                               *
+ ******************************************************************************/
+static size_t	vch_chunk_size(const zbx_vc_chunk_t *chunk)
+{
+	if (0 != chunk->packed_size)
+		return sizeof(zbx_vc_chunk_t) + sizeof(zbx_history_record_t) + (size_t)chunk->packed_size;
+
+	return sizeof(zbx_vc_chunk_t) + (size_t)(chunk->slots_num - 1) * sizeof(zbx_history_record_t);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns chunk value slots                                         *
+ *                                                                            *
+ * Parameters: chunk - [IN] the chunk                                         *
+ *                                                                            *
+ * Return value: The chunk value slots, indexed by chunk first_value and      *
+ *               last_value indexes.                                          *
+ *                                                                            *
+ * Comments: Packed chunks are decoded into local buffer. The last decoded    *
+ *           chunks are kept and looked up by their encoded data, so repeated *
+ *           reads of the same chunk (also after it has been freed and packed *
+ *           again at the same address) are decoded only once. The returned  *
+ *           buffer is valid until ZBX_VC_UNPACKED_CACHE_SIZE other chunks    *
+ *           are decoded.                                                     *
  *                                                                            *
  ******************************************************************************/
-static int	vch_item_get_last_value(const zbx_vc_item_t *item, const zbx_timespec_t *ts, zbx_vc_chunk_t **pchunk,
-		int *pindex)
+static zbx_history_record_t	*vch_chunk_get_slots(zbx_vc_chunk_t *chunk)
 {
-	zbx_vc_chunk_t	*chunk = item->head;
-	int		index;
+	const unsigned char	*data;
+	zbx_vc_unpacked_t	*unpacked;
+	int			i;
 
-	if (NULL == chunk)
-		return FAIL;
+	if (0 == chunk->packed_size)
+		return chunk->slots;
 
-	index = chunk->last_value;
+	data = (const unsigned char *)&chunk->slots[2];
 
-	if (0 < zbx_timespec_compare(&chunk->slots[index].timestamp, ts))
+	for (i = 0; i < ZBX_VC_UNPACKED_CACHE_SIZE; i++)
 	{
-		while (0 < zbx_timespec_compare(&chunk->slots[chunk->first_value].timestamp, ts))
+		unpacked = &vc_unpacked[i];
+
+		if (unpacked->values_num == chunk->slots_num && unpacked->data_size == chunk->packed_size &&
+				0 == memcmp(unpacked->data, data, (size_t)chunk->packed_size))
 		{
-			chunk = chunk->prev;
-			/* there are no values for requested range, return failure */
-			if (NULL == chunk)
-				return FAIL;
+			return unpacked->values;
 		}
-		index = vch_chunk_find_last_value_before(chunk, ts);
 	}
 
-	*pchunk = chunk;
-	*pindex = index;
+	unpacked = &vc_unpacked[vc_unpacked_next];
+	vc_unpacked_next = (vc_unpacked_next + 1) % ZBX_VC_UNPACKED_CACHE_SIZE;
 
-	return SUCCEED;
+	if (unpacked->values_alloc < chunk->slots_num)
+	{
+		unpacked->values_alloc = chunk->slots_num;
+		unpacked->values = (zbx_history_record_t *)zbx_realloc(unpacked->values,
+				sizeof(zbx_history_record_t) * (size_t)unpacked->values_alloc);
+	}
+
+	if (unpacked->data_alloc < chunk->packed_size)
+	{
+		unpacked->data_alloc = chunk->packed_size;
+		unpacked->data = (unsigned char *)zbx_realloc(unpacked->data, (size_t)unpacked->data_alloc);
+	}
+
+	vch_values_decode(data, chunk->slots_num, unpacked->values);
+
+	memcpy(unpacked->data, data, (size_t)chunk->packed_size);
+	unpacked->data_size = chunk->packed_size;
+	unpacked->values_num = chunk->slots_num;
+
+	return unpacked->values;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: copies value in the specified item's chunk slot                   *
+ * Purpose: replaces chunk in item chunk list                                 *
  *                                                                            *
- * Parameters: chunk        - [IN/OUT] the target chunk                       *
- *             index        - [IN] the target slot                            *
+ ******************************************************************************/
+static void	vch_item_replace_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk, zbx_vc_chunk_t *new_chunk)
+{
+	new_chunk->prev = chunk->prev;
+	new_chunk->next = chunk->next;
+
+	if (NULL != chunk->prev)
+		chunk->prev->next = new_chunk;
+	else
+		item->tail = new_chunk;
+
+	if (NULL != chunk->next)
+		chunk->next->prev = new_chunk;
+	else
+		item->head = new_chunk;
+
+	__vc_shmem_free_func(chunk);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: packs sealed chunk of numeric item values                         *
+ *                                                                            *
+ * Parameters: item  - [IN] the chunk owner item                              *
+ *             chunk - [IN] the chunk to pack                                 *
+ *                                                                            *
+ * Comments: The chunk is left as it is if packing would not save memory or   *
+ *           there is not enough memory to allocate the packed chunk.         *
+ *                                                                            *
+ ******************************************************************************/
+static void	vch_item_pack_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk)
+{
+	zbx_vc_chunk_t	*packed;
+	size_t		size, packed_size;
+	int		values_num = chunk->last_value - chunk->first_value + 1;
+
+	if (ITEM_VALUE_TYPE_FLOAT != item->value_type && ITEM_VALUE_TYPE_UINT64 != item->value_type)
+		return;
+
+	if (0 != chunk->packed_size || ZBX_VC_MIN_PACK_RECORDS > values_num)
+		return;
+
+	size = ((size_t)values_num * ZBX_VC_PACKED_VALUE_BITS_MAX + 7) >> 3;
+
+	if (vc_pack_alloc < size)
+	{
+		vc_pack_alloc = size;
+		vc_pack_buf = (unsigned char *)zbx_realloc(vc_pack_buf, vc_pack_alloc);
+	}
+
+	memset(vc_pack_buf, 0, size);
+	packed_size = vch_values_encode(&chunk->slots[chunk->first_value], values_num, vc_pack_buf);
+	size = sizeof(zbx_vc_chunk_t) + sizeof(zbx_history_record_t) + packed_size;
+
+	if (size >= vch_chunk_size(chunk))
+		return;
+
+	/* packing is an optimization, don't release cache space for it */
+	if (NULL == (packed = (zbx_vc_chunk_t *)__vc_shmem_malloc_func(NULL, size)))
+		return;
+
+	packed->first_value = 0;
+	packed->last_value = values_num - 1;
+	packed->slots_num = values_num;
+	packed->packed_size = (int)packed_size;
+	packed->summary = chunk->summary;
+	packed->slots[0] = chunk->slots[chunk->first_value];
+	packed->slots[1] = chunk->slots[chunk->last_value];
+	memcpy(&packed->slots[2], vc_pack_buf, packed_size);
+
+	vch_item_replace_chunk(item, chunk, packed);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: unpacks packed chunk                                              *
+ *                                                                            *
+ * Parameters: item  - [IN] the chunk owner item                              *
+ *             chunk - [IN] the chunk to unpack                               *
+ *                                                                            *
+ * Return value: the unpacked chunk or NULL if there was not enough memory    *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_vc_chunk_t	*vch_item_unpack_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk)
+{
+	zbx_vc_chunk_t		*unpacked;
+	zbx_history_record_t	*slots;
+	int			values_num = chunk->last_value - chunk->first_value + 1;
+
+	if (0 == chunk->packed_size)
+		return chunk;
+
+	if (NULL == (unpacked = (zbx_vc_chunk_t *)vc_item_malloc(item, sizeof(zbx_vc_chunk_t) +
+			sizeof(zbx_history_record_t) * (size_t)(values_num - 1))))
+	{
+		return NULL;
+	}
+
+	slots = vch_chunk_get_slots(chunk);
+
+	unpacked->first_value = 0;
+	unpacked->last_value = values_num - 1;
+	unpacked->slots_num = values_num;
+	unpacked->packed_size = 0;
+	unpacked->summary = chunk->summary;
+	memcpy(unpacked->slots, &slots[chunk->first_value], sizeof(zbx_history_record_t) * (size_t)values_num);
+
+	vch_item_replace_chunk(item, chunk, unpacked);
+
+	return unpacked;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes the oldest value from chunk                               *
+ *                                                                            *
+ * Parameters: item  - [IN] the chunk owner item                              *
+ *             chunk - [IN] the chunk                                         *
+ *                                                                            *
+ * Comments: The chunk must contain more than one value.                      *
+ *                                                                            *
+ ******************************************************************************/
+static void	vch_item_chunk_remove_first_value(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk)
+{
+	chunk->summary.values_num = 0;
+
+	if (0 == chunk->packed_size)
+	{
+		vc_item_free_values(item, chunk->slots, chunk->first_value, chunk->first_value);
+		chunk->first_value++;
+
+		return;
+	}
+
+	/* packed chunks hold only numeric values which don't need to be freed */
+	item->values_total--;
+	chunk->first_value++;
+	chunk->slots[0] = vch_chunk_get_slots(chunk)[chunk->first_value];
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: merges aggregates                                                 *
+ *                                                                            *
+ * Parameters: aggr       - [IN/OUT] the target aggregates                    *
+ *             value_type - [IN] the value type                               *
+ *             src        - [IN] the aggregates to merge                      *
+ *                                                                            *
+ * Comments: Only the number of values is aggregated for non numeric values.  *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_aggregate_merge(zbx_vc_aggregate_t *aggr, unsigned char value_type, const zbx_vc_aggregate_t *src)
+{
+	if (ITEM_VALUE_TYPE_FLOAT != value_type && ITEM_VALUE_TYPE_UINT64 != value_type)
+	{
+		aggr->values_num += src->values_num;
+		return;
+	}
+
+	if (0 == aggr->values_num)
+	{
+		*aggr = *src;
+		return;
+	}
+
+	aggr->values_num += src->values_num;
+	aggr->avg += src->avg / aggr->values_num * src->values_num - aggr->avg / aggr->values_num * src->values_num;
+
+	if (ITEM_VALUE_TYPE_FLOAT == value_type)
+	{
+		aggr->sum.dbl += src->sum.dbl;
+
+		if (src->min.dbl < aggr->min.dbl)
+			aggr->min.dbl = src->min.dbl;
+
+		if (src->max.dbl > aggr->max.dbl)
+			aggr->max.dbl = src->max.dbl;
+	}
+	else
+	{
+		aggr->sum.ui64 += src->sum.ui64;
+
+		if (src->min.ui64 < aggr->min.ui64)
+			aggr->min.ui64 = src->min.ui64;
+
+		if (src->max.ui64 > aggr->max.ui64)
+			aggr->max.ui64 = src->max.ui64;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds value to aggregates                                          *
+ *                                                                            *
+ * Parameters: aggr       - [IN/OUT] the aggregates                           *
+ *             value_type - [IN] the value type                               *
+ *             value      - [IN] the value to add                             *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_aggregate_add_value(zbx_vc_aggregate_t *aggr, unsigned char value_type,
+		const zbx_history_value_t *value)
+{
+	zbx_vc_aggregate_t	src;
+
+	src.values_num = 1;
+	src.min = *value;
+	src.max = *value;
+	src.sum = *value;
+
+	switch (value_type)
+	{
+		case ITEM_VALUE_TYPE_FLOAT:
+			src.avg = value->dbl;
+			break;
+		case ITEM_VALUE_TYPE_UINT64:
+			src.avg = (double)value->ui64;
+			break;
+		default:
+			src.avg = 0;
+	}
+
+	vc_aggregate_merge(aggr, value_type, &src);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: seals chunk that is full and won't get new values anymore         *
+ *                                                                            *
+ * Parameters: item  - [IN] the chunk owner item                              *
+ *             chunk - [IN] the chunk to seal                                 *
+ *                                                                            *
+ * Comments: The aggregates of numeric chunk values are calculated, so        *
+ *           aggregate requests can skip whole chunks, and the chunk is       *
+ *           packed.                                                          *
+ *                                                                            *
+ ******************************************************************************/
+static void	vch_item_seal_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk)
+{
+	int	i;
+
+	if (ITEM_VALUE_TYPE_FLOAT != item->value_type && ITEM_VALUE_TYPE_UINT64 != item->value_type)
+		return;
+
+	/* packed chunks are already sealed */
+	if (0 != chunk->packed_size)
+		return;
+
+	memset(&chunk->summary, 0, sizeof(chunk->summary));
+
+	/* aggregate values in the same order as they are requested - from the newest to the oldest */
+	for (i = chunk->last_value; i >= chunk->first_value; i--)
+		vc_aggregate_add_value(&chunk->summary, item->value_type, &chunk->slots[i].value);
+
+	vch_item_pack_chunk(item, chunk);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: updates item range with current request range                     *
+ *                                                                            *
+ * Parameters: item   - [IN] the item                                         *
+ *             range  - [IN] the request range                                *
+ *             now    - [IN] the current timestamp                            *
+ *                                                                            *
+ ******************************************************************************/
+static void	vch_item_update_range(zbx_vc_item_t *item, int range, int now)
+{
+	int		diff, last_value_timestamp;
+	unsigned char	hour;
+
+	if (VC_MIN_RANGE > range)
+		range = VC_MIN_RANGE;
+
+	if (item->daily_range < range)
+		item->daily_range = range;
+
+	hour = (unsigned char)((now / SEC_PER_HOUR) & 0xff);
+
+	if (0 > (diff = hour - item->range_sync_hour))
+		diff += 0xff;
+
+	if (NULL != item->head)
+		last_value_timestamp = vch_chunk_last(item->head)->timestamp.sec;
+	else
+		last_value_timestamp = now;
+
+	if (item->active_range < item->daily_range || (ZBX_VC_RANGE_SYNC_PERIOD < diff &&
+			(now - last_value_timestamp) / SEC_PER_HOUR < ZBX_VC_RANGE_SYNC_PERIOD))
+	{
+		item->active_range = item->daily_range;
+		item->daily_range = range;
+		item->range_sync_hour = hour;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculates optimal number of slots for an item data chunk         *
+ *                                                                            *
+ * Parameters:  item        - [IN] the item                                   *
+ *              values_new  - [IN] the number of values to be added           *
+ *                                                                            *
+ * Return value: the number of slots for a new item data chunk                *
+ *                                                                            *
+ * Comments: From size perspective the optimal slot count per chunk is        *
+ *           approximately square root of the number of cached values.        *
+ *           Still creating too many chunks might affect timeshift request    *
+ *           performance, so don't try creating more than 32 chunks unless    *
+ *           the calculated slot count exceeds the maximum limit.             *
+ *                                                                            *
+ ******************************************************************************/
+static int	vch_item_chunk_slot_count(zbx_vc_item_t *item, int values_new)
+{
+	int	nslots, values;
+
+	values = item->values_total + values_new;
+
+	nslots = (int)zbx_isqrt32((unsigned int)values);
+
+	if ((values + nslots - 1) / nslots + 1 > 32)
+		nslots = values / 32;
+
+	if (nslots > (int)ZBX_VC_MAX_CHUNK_RECORDS)
+		nslots = ZBX_VC_MAX_CHUNK_RECORDS;
+	if (nslots < (int)ZBX_VC_MIN_CHUNK_RECORDS)
+		nslots = ZBX_VC_MIN_CHUNK_RECORDS;
+
+	return nslots;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds a new data chunk at the end of item's history data list      *
+ *                                                                            *
+ * Parameters: item          - [IN/OUT] the item to add chunk to              *
+ *             nslots        - [IN] the number of slots in the new chunk      *
+ *             insert_before - [IN] the target chunk before which the new     *
+ *                             chunk must be inserted. If this value is NULL  *
+ *                             then the new chunk is appended at the end of   *
+ *                             chunk list (making it the newest chunk).       *
+ *                                                                            *
+ * Return value:  SUCCEED - the chunk was added successfully                  *
+ *                FAIL - failed to create a new chunk (not enough memory)     *
+ *                                                                            *
+ ******************************************************************************/
+static int	vch_item_add_chunk(zbx_vc_item_t *item, int nslots, zbx_vc_chunk_t *insert_before)
+{
+	zbx_vc_chunk_t	*chunk;
+	size_t		chunk_size;
+
+	chunk_size =sizeof(zbx_vc_chunk_t) + sizeof(zbx_history_record_t) * (size_t)(nslots - 1);
+
+	if (NULL == (chunk = (zbx_vc_chunk_t *)vc_item_malloc(item, chunk_size)))
+		return FAIL;
+
+	memset(chunk, 0, sizeof(zbx_vc_chunk_t));
+	chunk->slots_num = nslots;
+
+	chunk->next = insert_before;
+
+	if (NULL == insert_before)
+	{
+		chunk->prev = item->head;
+
+		if (NULL != item->head)
+			item->head->next = chunk;
+		else
+			item->tail = chunk;
+
+		item->head = chunk;
+	}
+	else
+	{
+		chunk->prev = insert_before->prev;
+		insert_before->prev = chunk;
+
+		if (item->tail == insert_before)
+			item->tail = chunk;
+		else
+			chunk->prev->next = chunk;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: find the index of the last value in chunk with timestamp less or  *
+ *          equal to the specified timestamp.                                 *
+ *                                                                            *
+ * Parameters:  chunk - [IN] the chunk                                        *
+ *              slots - [IN] the chunk value slots                            *
+ *              ts    - [IN] the target timestamp                             *
+ *                                                                            *
+ * Return value: The index of the last value in chunk with timestamp less or  *
+ *               equal to the specified timestamp.                            *
+ *               -1 is returned in the case of failure (meaning that all      *
+ *               values have timestamps greater than the target timestamp).   *
+ *                                                                            *
+ ******************************************************************************/
+static int	vch_chunk_find_last_value_before(const zbx_vc_chunk_t *chunk, const zbx_history_record_t *slots,
+		const zbx_timespec_t *ts)
+{
+	int	start = chunk->first_value, end = chunk->last_value, middle;
+
+	/* check if the last value timestamp is already greater or equal to the specified timestamp */
+	if (0 >= zbx_timespec_compare(&slots[end].timestamp, ts))
+		return end;
+
+	/* chunk contains only one value, which did not pass the above check, return failure */
+	if (start == end)
+		return -1;
+
+	/* perform value lookup using binary search */
+	while (start != end)
+	{
+		middle = start + (end - start) / 2;
+
+		if (0 < zbx_timespec_compare(&slots[middle].timestamp, ts))
+		{
+			end = middle;
+			continue;
+		}
+
+		if (0 >= zbx_timespec_compare(&slots[middle + 1].timestamp, ts))
+		{
+			start = middle;
+			continue;
+		}
+
+		return middle;
+	}
+
+	return -1;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets the chunk and index of the last value with a timestamp less  *
+ *          or equal to the specified timestamp                               *
+ *                                                                            *
+ * Parameters:  item          - [IN] the item                                 *
+ *              ts            - [IN] the target timestamp                     *
+ *                                   (NULL - current time)                    *
+ *              pchunk        - [OUT] the chunk containing the target value   *
+ *              pindex        - [OUT] the index of the target value           *
+ *              pslots        - [OUT] the value slots of the target chunk     *
+ *                                    (optional)                              *
+ *                                                                            *
+ * Return value: SUCCEED - the last value was found successfully              *
+ *               FAIL - all values in cache have timestamps greater than the  *
+ *                      target (timeshift) timestamp.                         *
+ *                                                                            *
+ * Comments: If end_timestamp value is 0, then simply the last item value in  *
+ *           cache is returned.                                               *
+ *                                                                            *
+ ******************************************************************************/
+static int	vch_item_get_last_value(const zbx_vc_item_t *item, const zbx_timespec_t *ts, zbx_vc_chunk_t **pchunk,
+		int *pindex, zbx_history_record_t **pslots)
+{
+	zbx_vc_chunk_t		*chunk = item->head;
+	zbx_history_record_t	*slots = NULL;
+	int			index;
+
+	if (NULL == chunk)
+		return FAIL;
+
+	index = chunk->last_value;
+
+	if (0 < zbx_timespec_compare(&vch_chunk_last(chunk)->timestamp, ts))
+	{
+		while (0 < zbx_timespec_compare(&vch_chunk_first(chunk)->timestamp, ts))
+		{
+			chunk = chunk->prev;
+			/* there are no values for requested range, return failure */
+			if (NULL == chunk)
+				return FAIL;
+		}
+
+		slots = vch_chunk_get_slots(chunk);
+		index = vch_chunk_find_last_value_before(chunk, slots, ts);
+	}
+	else if (NULL != pslots)
+		slots = vch_chunk_get_slots(chunk);
+
+	*pchunk = chunk;
+	*pindex = index;
+
+	if (NULL != pslots)
+		*pslots = slots;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: copies value in the specified item's chunk slot                   *
+ *                                                                            *
+ * Parameters: chunk        - [IN/OUT] the target chunk                       *
+ *             index        - [IN] the target slot                            *
  *             source_value - [IN] the value to copy                          *
  *                                                                            *
  * Return value: SUCCEED - the value was copied successfully                  *
@@ -1558,6 +2267,8 @@ static int	vch_item_copy_values_at_tail(zbx_vc_item_t *item, const zbx_history_r
 {
 	int	i, ret = FAIL, first_value = item->tail->first_value;
 
+	item->tail->summary.values_num = 0;
+
 	switch (item->value_type)
 	{
 		case ITEM_VALUE_TYPE_STR:
@@ -1615,7 +2326,7 @@ static size_t	vch_item_free_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk)
 {
 	size_t	freed;
 
-	freed = sizeof(zbx_vc_chunk_t) + (size_t)(chunk->slots_num - 1) * sizeof(zbx_history_record_t);
+	freed = vch_chunk_size(chunk);
 	freed += vc_item_free_values(item, chunk->slots, chunk->first_value, chunk->last_value);
 
 	__vc_shmem_free_func(chunk);
@@ -1671,9 +2382,8 @@ static void	vch_item_clean_cache(zbx_vc_item_t *item, int timestamp)
 		/* Try to remove chunks with all history values older than maximum request range, maximum */
 		/* request range should be calculated from last received value with which active range    */
 		/* was calculated to avoid dropping of chunks that might be still used in count request.  */
-		while (NULL != chunk && chunk->slots[chunk->last_value].timestamp.sec < timestamp &&
-				chunk->slots[chunk->last_value].timestamp.sec !=
-						item->head->slots[item->head->last_value].timestamp.sec)
+		while (NULL != chunk && vch_chunk_last(chunk)->timestamp.sec < timestamp &&
+				vch_chunk_last(chunk)->timestamp.sec != vch_chunk_last(item->head)->timestamp.sec)
 		{
 			/* don't remove the head chunk */
 			if (NULL == (next = chunk->next))
@@ -1687,18 +2397,14 @@ static void	vch_item_clean_cache(zbx_vc_item_t *item, int timestamp)
 			/* In this case increase the first value index of the next chunk until the first  */
 			/* value timestamp is greater.                                                    */
 
-			if (next->slots[next->first_value].timestamp.sec != next->slots[next->last_value].timestamp.sec)
+			if (vch_chunk_first(next)->timestamp.sec != vch_chunk_last(next)->timestamp.sec)
 			{
-				while (next->slots[next->first_value].timestamp.sec ==
-						chunk->slots[chunk->last_value].timestamp.sec)
-				{
-					vc_item_free_values(item, next->slots, next->first_value, next->first_value);
-					next->first_value++;
-				}
+				while (vch_chunk_first(next)->timestamp.sec == vch_chunk_last(chunk)->timestamp.sec)
+					vch_item_chunk_remove_first_value(item, next);
 			}
 
 			/* set the database cached from timestamp to the last (oldest) removed value timestamp + 1 */
-			item->db_cached_from = chunk->slots[chunk->last_value].timestamp.sec + 1;
+			item->db_cached_from = vch_chunk_last(chunk)->timestamp.sec + 1;
 
 			vch_item_remove_chunk(item, chunk);
 
@@ -1729,20 +2435,17 @@ static void	vch_item_remove_values(zbx_vc_item_t *item, int timestamp)
 		item->status = 0;
 
 	/* try to remove chunks with all history values older than the timestamp */
-	while (NULL != chunk && chunk->slots[chunk->first_value].timestamp.sec < timestamp)
+	while (NULL != chunk && vch_chunk_first(chunk)->timestamp.sec < timestamp)
 	{
 		zbx_vc_chunk_t	*next;
 
 		/* If chunk contains values with timestamp greater or equal - remove */
 		/* only the values with less timestamp. Otherwise remove the while   */
 		/* chunk and check next one.                                         */
-		if (chunk->slots[chunk->last_value].timestamp.sec >= timestamp)
+		if (vch_chunk_last(chunk)->timestamp.sec >= timestamp)
 		{
-			while (chunk->slots[chunk->first_value].timestamp.sec < timestamp)
-			{
-				vc_item_free_values(item, chunk->slots, chunk->first_value, chunk->first_value);
-				chunk->first_value++;
-			}
+			while (vch_chunk_first(chunk)->timestamp.sec < timestamp)
+				vch_item_chunk_remove_first_value(item, chunk);
 
 			break;
 		}
@@ -1753,6 +2456,37 @@ static void	vch_item_remove_values(zbx_vc_item_t *item, int timestamp)
 	}
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: unpacks the newest item chunks down to the chunk where the        *
+ *          specified value must be inserted                                  *
+ *                                                                            *
+ * Parameters:  item   - [IN] the item                                        *
+ *              value  - [IN] the value to insert                             *
+ *                                                                            *
+ * Return value: SUCCEED - the chunks were unpacked successfully              *
+ *               FAIL - failed to unpack chunks (not enough memory)           *
+ *                                                                            *
+ ******************************************************************************/
+static int	vch_item_unpack_chunks(zbx_vc_item_t *item, const zbx_history_record_t *value)
+{
+	zbx_vc_chunk_t	*chunk;
+
+	for (chunk = item->head; NULL != chunk; chunk = chunk->prev)
+	{
+		if (NULL == (chunk = vch_item_unpack_chunk(item, chunk)))
+			return FAIL;
+
+		/* chunk values will be moved */
+		chunk->summary.values_num = 0;
+
+		if (0 >= zbx_history_record_compare_asc_func(vch_chunk_first(chunk), value))
+			break;
+	}
+
+	return SUCCEED;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: adds one item history value at the end of current item's history  *
@@ -1771,13 +2505,17 @@ static void	vch_item_remove_values(zbx_vc_item_t *item, int timestamp)
 static int	vch_item_add_value_at_head(zbx_vc_item_t *item, const zbx_history_record_t *value)
 {
 	int		ret = FAIL, index, sindex, nslots = 0;
-	zbx_vc_chunk_t	*chunk, *schunk;
+	zbx_vc_chunk_t	*chunk, *schunk, *sealed = NULL;
 
-	if (NULL != item->head &&
-			0 < zbx_history_record_compare_asc_func(&item->head->slots[item->head->last_value], value))
+	if (NULL != item->head && 0 < zbx_history_record_compare_asc_func(vch_chunk_last(item->head), value))
 	{
-		if (0 < zbx_history_record_compare_asc_func(&item->tail->slots[item->tail->first_value], value))
+		if (0 < zbx_history_record_compare_asc_func(vch_chunk_first(item->tail), value))
 		{
+			/* the history being prefetched might not contain the value, so the item must be */
+			/* removed and cached again when accessed next time                             */
+			if (ZBX_ITEM_STATUS_PREFETCH == item->status)
+				goto out;
+
 			/* If the added value has the same or older timestamp as the first value in cache */
 			/* we can't add it to keep cache consistency. Additionally we must make sure no   */
 			/* values with matching timestamp seconds are kept in cache.                      */
@@ -1797,6 +2535,10 @@ static int	vch_item_add_value_at_head(zbx_vc_item_t *item, const zbx_history_rec
 			goto out;
 		}
 
+		/* values will be moved to free the slot for the new value, packed chunks must be unpacked first */
+		if (FAIL == vch_item_unpack_chunks(item, value))
+			goto out;
+
 		sindex = item->head->last_value;
 		schunk = item->head;
 
@@ -1804,6 +2546,8 @@ static int	vch_item_add_value_at_head(zbx_vc_item_t *item, const zbx_history_rec
 		{
 			if (FAIL == vch_item_add_chunk(item, vch_item_chunk_slot_count(item, 1), NULL))
 				goto out;
+
+			sealed = item->head->prev;
 		}
 		else
 			item->head->last_value++;
@@ -1838,13 +2582,15 @@ static int	vch_item_add_value_at_head(zbx_vc_item_t *item, const zbx_history_rec
 	else
 	{
 		/* find the number of free slots on the right side in last (head) chunk */
-		if (NULL != item->head)
+		if (NULL != item->head && 0 == item->head->packed_size)
 			nslots = item->head->slots_num - item->head->last_value - 1;
 
 		if (0 == nslots)
 		{
 			if (FAIL == vch_item_add_chunk(item, vch_item_chunk_slot_count(item, 1), NULL))
 				goto out;
+
+			sealed = item->head->prev;
 		}
 		else
 			item->head->last_value++;
@@ -1858,6 +2604,9 @@ static int	vch_item_add_value_at_head(zbx_vc_item_t *item, const zbx_history_rec
 	if (SUCCEED != vch_item_copy_value(item, chunk, index, value))
 		goto out;
 
+	if (NULL != sealed)
+		vch_item_seal_chunk(item, sealed);
+
 	ret = SUCCEED;
 out:
 	return ret;
@@ -1886,7 +2635,7 @@ static int	vch_item_add_values_at_tail(zbx_vc_item_t *item, const zbx_history_re
 	/* skip values already added to the item cache by another process */
 	if (NULL != item->tail)
 	{
-		int	sec = item->tail->slots[item->tail->first_value].timestamp.sec;
+		int	sec = vch_chunk_first(item->tail)->timestamp.sec;
 
 		while (--count >= 0 && values[count].timestamp.sec >= sec)
 			;
@@ -1898,7 +2647,7 @@ static int	vch_item_add_values_at_tail(zbx_vc_item_t *item, const zbx_history_re
 		int	copy_slots, nslots = 0;
 
 		/* find the number of free slots on the left side in first (tail) chunk */
-		if (NULL != item->tail)
+		if (NULL != item->tail && 0 == item->tail->packed_size)
 			nslots = item->tail->first_value;
 
 		if (0 == nslots)
@@ -1910,6 +2659,10 @@ static int	vch_item_add_values_at_tail(zbx_vc_item_t *item, const zbx_history_re
 
 			item->tail->last_value = nslots - 1;
 			item->tail->first_value = nslots;
+
+			/* the previous tail chunk is full and won't be changed anymore, except for the head chunk */
+			if (NULL != item->tail->next && item->tail->next != item->head)
+				vch_item_seal_chunk(item, item->tail->next);
 		}
 
 		/* copy values to chunk */
@@ -1957,7 +2710,7 @@ static int	vch_item_cache_values_by_time(zbx_vc_item_t **item, int range_start)
 	if (NULL != (*item)->tail)
 	{
 		/* we need to get item values before the first cached value, but not including it */
-		range_end = (*item)->tail->slots[(*item)->tail->first_value].timestamp.sec - 1;
+		range_end = vch_chunk_first((*item)->tail)->timestamp.sec - 1;
 	}
 	else
 		range_end = ZBX_JAN_2038;
@@ -2051,7 +2804,7 @@ static int	vch_item_cache_values_by_time_and_count(zbx_vc_item_t **item, int ran
 		zbx_vc_chunk_t	*chunk;
 		int		index;
 
-		if (SUCCEED == vch_item_get_last_value(*item, ts, &chunk, &index))
+		if (SUCCEED == vch_item_get_last_value(*item, ts, &chunk, &index, NULL))
 		{
 			cached_records = index - chunk->first_value + 1;
 
@@ -2066,7 +2819,7 @@ static int	vch_item_cache_values_by_time_and_count(zbx_vc_item_t **item, int ran
 
 	/* get the end timestamp to which (including) the values should be cached */
 	if (NULL != (*item)->head)
-		range_end = (*item)->tail->slots[(*item)->tail->first_value].timestamp.sec - 1;
+		range_end = vch_chunk_first((*item)->tail)->timestamp.sec - 1;
 	else
 		range_end = ZBX_JAN_2038;
 
@@ -2125,7 +2878,7 @@ static int	vch_item_cache_values_by_time_and_count(zbx_vc_item_t **item, int ran
 	if ((count <= records.values_num || 0 == range_start) && 0 != records.values_num)
 	{
 		vc_item_update_db_cached_from(*item,
-				(*item)->tail->slots[(*item)->tail->first_value].timestamp.sec);
+				vch_chunk_first((*item)->tail)->timestamp.sec);
 	}
 	else if (0 != range_start)
 		vc_item_update_db_cached_from(*item, range_start);
@@ -2150,15 +2903,16 @@ out:
 static void	vch_item_get_values_by_time(const zbx_vc_item_t *item, zbx_vector_history_record_t *values, int seconds,
 		const zbx_timespec_t *ts)
 {
-	int		index, now;
-	zbx_timespec_t	start = {ts->sec - seconds, ts->ns};
-	zbx_vc_chunk_t	*chunk;
+	int			index, now;
+	zbx_timespec_t		start = {ts->sec - seconds, ts->ns};
+	zbx_vc_chunk_t		*chunk;
+	zbx_history_record_t	*slots;
 
 	now = (int)time(NULL);
 	/* add another second to include nanosecond shifts */
 	vc_cache_item_update(item->itemid, ZBX_VC_UPDATE_RANGE, seconds + now - ts->sec + 1, now);
 
-	if (FAIL == vch_item_get_last_value(item, ts, &chunk, &index))
+	if (FAIL == vch_item_get_last_value(item, ts, &chunk, &index, &slots))
 	{
 		/* Cache does not contain records for the specified timeshift & seconds range. */
 		/* Return empty vector with success.                                           */
@@ -2166,18 +2920,54 @@ static void	vch_item_get_values_by_time(const zbx_vc_item_t *item, zbx_vector_hi
 	}
 
 	/* fill the values vector with item history values until the start timestamp is reached */
-	while (0 < zbx_timespec_compare(&chunk->slots[chunk->last_value].timestamp, &start))
+	while (0 < zbx_timespec_compare(&vch_chunk_last(chunk)->timestamp, &start))
 	{
-		while (index >= chunk->first_value && 0 < zbx_timespec_compare(&chunk->slots[index].timestamp, &start))
-			vc_history_record_vector_append(values, item->value_type, &chunk->slots[index--]);
+		while (index >= chunk->first_value && 0 < zbx_timespec_compare(&slots[index].timestamp, &start))
+			vc_history_record_vector_append(values, item->value_type, &slots[index--]);
 
 		if (NULL == (chunk = chunk->prev))
 			break;
 
+		slots = vch_chunk_get_slots(chunk);
 		index = chunk->last_value;
 	}
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: updates item range after count based request                      *
+ *                                                                            *
+ * Parameters: item       - [IN] the item                                     *
+ *             seconds    - [IN] the time period                              *
+ *             count      - [IN] the number of requested values               *
+ *             ts         - [IN] the target timestamp                         *
+ *             values_num - [IN] the number of retrieved values               *
+ *             oldest_sec - [IN] the oldest retrieved value timestamp         *
+ *                                                                            *
+ ******************************************************************************/
+static void	vch_item_update_count_range(const zbx_vc_item_t *item, int seconds, int count, const zbx_timespec_t *ts,
+		int values_num, int oldest_sec)
+{
+	int	now, range_timestamp;
+
+	if (count > values_num)
+	{
+		if (0 == seconds)
+			return;
+
+		/* set the range equal to the period plus one second to include nanosecond shifts */
+		range_timestamp = ts->sec - seconds;
+	}
+	else
+	{
+		/* the requested number of values was retrieved, set the range to the oldest value timestamp */
+		range_timestamp = oldest_sec - 1;
+	}
+
+	now = (int)time(NULL);
+	vc_cache_item_update(item->itemid, ZBX_VC_UPDATE_RANGE, now - range_timestamp, now);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: retrieves item history data from cache                            *
@@ -2196,9 +2986,10 @@ static void	vch_item_get_values_by_time(const zbx_vc_item_t *item, zbx_vector_hi
 static void	vch_item_get_values_by_time_and_count(zbx_vc_item_t *item, zbx_vector_history_record_t *values,
 		int seconds, int count, const zbx_timespec_t *ts)
 {
-	int		index, now, range_timestamp;
-	zbx_vc_chunk_t	*chunk;
-	zbx_timespec_t	start;
+	int			index;
+	zbx_vc_chunk_t		*chunk;
+	zbx_history_record_t	*slots;
+	zbx_timespec_t		start;
 
 	/* set start timestamp of the requested time period */
 	if (0 != seconds)
@@ -2212,7 +3003,7 @@ static void	vch_item_get_values_by_time_and_count(zbx_vc_item_t *item, zbx_vecto
 		start.ns = 0;
 	}
 
-	if (FAIL == vch_item_get_last_value(item, ts, &chunk, &index))
+	if (FAIL == vch_item_get_last_value(item, ts, &chunk, &index, &slots))
 	{
 		/* return empty vector with success */
 		goto out;
@@ -2221,38 +3012,25 @@ static void	vch_item_get_values_by_time_and_count(zbx_vc_item_t *item, zbx_vecto
 	/* fill the values vector with item history values until the <count> values are read    */
 	/* or no more values within specified time period                                       */
 	/* fill the values vector with item history values until the start timestamp is reached */
-	while (0 < zbx_timespec_compare(&chunk->slots[chunk->last_value].timestamp, &start))
+	while (0 < zbx_timespec_compare(&vch_chunk_last(chunk)->timestamp, &start))
 	{
-		while (index >= chunk->first_value && 0 < zbx_timespec_compare(&chunk->slots[index].timestamp, &start))
+		while (index >= chunk->first_value && 0 < zbx_timespec_compare(&slots[index].timestamp, &start))
 		{
-			vc_history_record_vector_append(values, item->value_type, &chunk->slots[index--]);
+			vc_history_record_vector_append(values, item->value_type, &slots[index--]);
 
 			if (values->values_num == count)
 				goto out;
-		}
-
-		if (NULL == (chunk = chunk->prev))
-			break;
-
-		index = chunk->last_value;
-	}
-out:
-	if (count > values->values_num)
-	{
-		if (0 == seconds)
-			return;
-
-		/* set the range equal to the period plus one second to include nanosecond shifts */
-		range_timestamp = ts->sec - seconds;
-	}
-	else
-	{
-		/* the requested number of values was retrieved, set the range to the oldest value timestamp */
-		range_timestamp = values->values[values->values_num - 1].timestamp.sec - 1;
-	}
+		}
 
-	now = (int)time(NULL);
-	vc_cache_item_update(item->itemid, ZBX_VC_UPDATE_RANGE, now - range_timestamp, now);
+		if (NULL == (chunk = chunk->prev))
+			break;
+
+		slots = vch_chunk_get_slots(chunk);
+		index = chunk->last_value;
+	}
+out:
+	vch_item_update_count_range(item, seconds, count, ts, values->values_num,
+			0 != values->values_num ? values->values[values->values_num - 1].timestamp.sec : 0);
 }
 
 /******************************************************************************
@@ -2328,6 +3106,153 @@ out:
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: aggregates cached item values                                     *
+ *                                                                            *
+ * Parameters: item   - [IN] the item                                         *
+ *             start  - [IN] the requested period start timestamp (excluded)  *
+ *             count  - [IN] the maximum number of values to aggregate,       *
+ *                           0 - unlimited                                    *
+ *             ts     - [IN] the requested period end timestamp               *
+ *             aggr   - [OUT] the aggregates                                  *
+ *             oldest - [OUT] the oldest aggregated value timestamp           *
+ *                                                                            *
+ * Comments: The values are walked the same way as they are retrieved by      *
+ *           vch_item_get_values_by_time_and_count() function, except that    *
+ *           sealed chunks covered by the request are not decoded - their     *
+ *           aggregates are used instead.                                     *
+ *                                                                            *
+ ******************************************************************************/
+static void	vch_item_aggregate_values(const zbx_vc_item_t *item, const zbx_timespec_t *start, int count,
+		const zbx_timespec_t *ts, zbx_vc_aggregate_t *aggr, zbx_timespec_t *oldest)
+{
+	int			index, values_num, numeric;
+	zbx_vc_chunk_t		*chunk;
+	zbx_history_record_t	*slots;
+
+	if (FAIL == vch_item_get_last_value(item, ts, &chunk, &index, &slots))
+		return;
+
+	numeric = (ITEM_VALUE_TYPE_FLOAT == item->value_type || ITEM_VALUE_TYPE_UINT64 == item->value_type);
+
+	while (0 < zbx_timespec_compare(&vch_chunk_last(chunk)->timestamp, start))
+	{
+		values_num = chunk->last_value - chunk->first_value + 1;
+
+		/* use chunk aggregates if all chunk values are requested */
+		if (index == chunk->last_value && 0 < zbx_timespec_compare(&vch_chunk_first(chunk)->timestamp, start) &&
+				(0 == count || values_num <= count - aggr->values_num) &&
+				(0 == numeric || values_num == chunk->summary.values_num))
+		{
+			if (0 == numeric)
+				aggr->values_num += values_num;
+			else
+				vc_aggregate_merge(aggr, item->value_type, &chunk->summary);
+
+			*oldest = vch_chunk_first(chunk)->timestamp;
+
+			if (aggr->values_num == count)
+				return;
+		}
+		else
+		{
+			if (NULL == slots)
+				slots = vch_chunk_get_slots(chunk);
+
+			while (index >= chunk->first_value && 0 < zbx_timespec_compare(&slots[index].timestamp, start))
+			{
+				vc_aggregate_add_value(aggr, item->value_type, &slots[index].value);
+				*oldest = slots[index--].timestamp;
+
+				if (aggr->values_num == count)
+					return;
+			}
+		}
+
+		if (NULL == (chunk = chunk->prev))
+			break;
+
+		slots = NULL;
+		index = chunk->last_value;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get aggregates of item values for the specified range             *
+ *                                                                            *
+ * Parameters: item      - [IN] the item                                      *
+ *             seconds   - [IN] the time period to aggregate data for         *
+ *             count     - [IN] the number of history values to aggregate     *
+ *             ts        - [IN] the target timestamp                          *
+ *             aggr      - [OUT] the aggregates                               *
+ *                                                                            *
+ * Return value:  SUCCEED - the aggregates were calculated successfully       *
+ *                FAIL    - the item history data was not cached              *
+ *                                                                            *
+ * Comments: This function updates cache from DB if necessary in the same     *
+ *           way as vch_item_get_values() function.                           *
+ *                                                                            *
+ ******************************************************************************/
+static int	vch_item_get_aggregate(zbx_vc_item_t *item, int seconds, int count, const zbx_timespec_t *ts,
+		zbx_vc_aggregate_t *aggr)
+{
+	int		ret, records_read, hits, misses, range_start, now;
+	zbx_timespec_t	start = {0, 0}, oldest = {0, 0};
+
+	memset(aggr, 0, sizeof(zbx_vc_aggregate_t));
+
+	if (0 == count)
+	{
+		if (0 > (range_start = ts->sec - seconds))
+			range_start = 0;
+
+		if (FAIL == (ret = vch_item_cache_values_by_time(&item, range_start)))
+			goto out;
+
+		records_read = ret;
+
+		now = (int)time(NULL);
+		/* add another second to include nanosecond shifts */
+		vc_cache_item_update(item->itemid, ZBX_VC_UPDATE_RANGE, seconds + now - ts->sec + 1, now);
+
+		start.sec = ts->sec - seconds;
+		start.ns = ts->ns;
+		vch_item_aggregate_values(item, &start, 0, ts, aggr, &oldest);
+	}
+	else
+	{
+		range_start = (0 == seconds ? 0 : ts->sec - seconds);
+
+		if (FAIL == (ret = vch_item_cache_values_by_time_and_count(&item, range_start, count, ts)))
+			goto out;
+
+		records_read = ret;
+
+		if (0 != seconds)
+		{
+			start.sec = ts->sec - seconds;
+			start.ns = ts->ns;
+		}
+
+		vch_item_aggregate_values(item, &start, count, ts, aggr, &oldest);
+		vch_item_update_count_range(item, seconds, count, ts, aggr->values_num, oldest.sec);
+	}
+
+	if (records_read > aggr->values_num)
+		records_read = aggr->values_num;
+
+	hits = aggr->values_num - records_read;
+	misses = records_read;
+
+	vc_cache_item_update(item->itemid, ZBX_VC_UPDATE_STATS, hits, misses);
+
+	ret = SUCCEED;
+out:
+	return ret;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: frees resources allocated for item history data                   *
@@ -2391,6 +3316,9 @@ int	zbx_vc_init(zbx_uint64_t value_cache_size, char **error)
 
 	value_cache_size -= size_reserved;
 
+	/* slabs are not enabled - memory freed by evicting data must be returned to the general free */
+	/* lists, otherwise the freed size accounted by eviction would not be available for new data  */
+
 	vc_cache = (zbx_vc_cache_t *)__vc_shmem_malloc_func(vc_cache, sizeof(zbx_vc_cache_t));
 
 	if (NULL == vc_cache)
@@ -2549,14 +3477,15 @@ int	zbx_vc_add_values(zbx_vector_dc_history_ptr_t *history, int *ret_flush, int
 		}
 
 		/* cache new values only after the item history database status is known */
-		if (NULL != item && (ZBX_ITEM_STATUS_CACHED_ALL == item->status || 0 != item->db_cached_from))
+		if (NULL != item && (ZBX_ITEM_STATUS_CACHED_ALL == item->status ||
+				ZBX_ITEM_STATUS_PREFETCH == item->status || 0 != item->db_cached_from))
 		{
 			zbx_history_record_t	record = {h->ts, h->value};
 			zbx_vc_chunk_t		*head = item->head;
 			int			last_value_timestamp;
 
 			if (NULL != head)
-				last_value_timestamp = head->slots[head->last_value].timestamp.sec;
+				last_value_timestamp = vch_chunk_last(head)->timestamp.sec;
 			else
 				last_value_timestamp = (int)time(NULL);
 
@@ -2620,86 +3549,285 @@ int	zbx_vc_get_values(zbx_uint64_t itemid, unsigned char value_type, zbx_vector_
 	if (ZBX_VC_DISABLED == vc_state)
 		goto out;
 
-	if (ZBX_VC_MODE_LOWMEM == vc_cache->mode)
+	if (ZBX_VC_MODE_LOWMEM == vc_cache->mode)
+		vc_warn_low_memory();
+
+	if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)))
+	{
+		if (ZBX_VC_MODE_NORMAL != vc_cache->mode)
+			goto out;
+
+		memset(&new_item, 0, sizeof(new_item));
+		new_item.itemid = itemid;
+		new_item.value_type = value_type;
+		item = &new_item;
+	}
+	else if (item->value_type != value_type)
+		goto out;
+
+	ret = vch_item_get_values(item, values, seconds, count, ts);
+out:
+	if (FAIL == ret)
+	{
+		cache_used = 0;
+
+		UNLOCK_CACHE;
+		ret = vc_db_get_values(itemid, value_type, values, seconds, count, ts);
+		WRLOCK_CACHE;
+
+		if (ZBX_VC_DISABLED != vc_state)
+			vc_remove_item_by_id(itemid);
+
+		if (SUCCEED == ret)
+			vc_update_statistics(NULL, 0, values->values_num, (int)time(NULL));
+	}
+
+	UNLOCK_CACHE;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s count:%d cached:%d",
+			__func__, zbx_result_string(ret), values->values_num, cache_used);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get the last history value with a timestamp less or equal to the  *
+ *          target timestamp                                                  *
+ *                                                                            *
+ * Parameters: itemid     - [IN] the item id                                  *
+ *             value_type - [IN] the item value type                          *
+ *             ts         - [IN] the target timestamp                         *
+ *             value      - [OUT] the value found                             *
+ *                                                                            *
+ * Return Value: SUCCEED - the item was retrieved                             *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: Depending on the value type this function might allocate memory  *
+ *           to store value data. To free it use zbx_vc_history_value_clear() *
+ *           function.                                                        *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_vc_get_value(zbx_uint64_t itemid, unsigned char value_type, const zbx_timespec_t *ts,
+		zbx_history_record_t *value)
+{
+	zbx_vector_history_record_t	values;
+	int				ret = FAIL;
+
+	zbx_history_record_vector_create(&values);
+
+	if (SUCCEED != zbx_vc_get_values(itemid, value_type, &values, ts->sec, 1, ts) || 0 == values.values_num)
+		goto out;
+
+	*value = values.values[0];
+
+	/* reset values vector size so the returned value is not cleared when destroying the vector */
+	values.values_num = 0;
+
+	ret = SUCCEED;
+out:
+	zbx_history_record_vector_destroy(&values, value_type);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get aggregates of item values from cache                          *
+ *                                                                            *
+ * Parameters: itemid     - [IN] the item id                                  *
+ *             value_type - [IN] the item value type                          *
+ *             seconds    - [IN] the time period to aggregate data for        *
+ *             count      - [IN] the number of history values to aggregate    *
+ *             ts         - [IN] the period end timestamp                     *
+ *             aggr       - [OUT] the aggregates                              *
+ *                                                                            *
+ * Return value:  SUCCEED - the aggregates were calculated successfully       *
+ *                FAIL    - the aggregates must be calculated from database   *
+ *                                                                            *
+ * Comments: The cache must be locked.                                        *
+ *                                                                            *
+ ******************************************************************************/
+static int	vc_item_get_aggregate(zbx_uint64_t itemid, unsigned char value_type, int seconds, int count,
+		const zbx_timespec_t *ts, zbx_vc_aggregate_t *aggr)
+{
+	zbx_vc_item_t	*item, new_item;
+
+	if (ZBX_VC_DISABLED == vc_state)
+		return FAIL;
+
+	if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)))
+	{
+		if (ZBX_VC_MODE_NORMAL != vc_cache->mode)
+			return FAIL;
+
+		memset(&new_item, 0, sizeof(new_item));
+		new_item.itemid = itemid;
+		new_item.value_type = value_type;
+		item = &new_item;
+	}
+	else if (item->value_type != value_type)
+		return FAIL;
+
+	return vch_item_get_aggregate(item, seconds, count, ts, aggr);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get aggregates of item values directly from database              *
+ *                                                                            *
+ * Parameters: itemid     - [IN] the item id                                  *
+ *             value_type - [IN] the item value type                          *
+ *             seconds    - [IN] the time period to aggregate data for        *
+ *             count      - [IN] the number of history values to aggregate    *
+ *             ts         - [IN] the period end timestamp                     *
+ *             aggr       - [OUT] the aggregates                              *
+ *                                                                            *
+ * Return value:  SUCCEED - the aggregates were calculated successfully       *
+ *                FAIL    - the item history data was not retrieved           *
+ *                                                                            *
+ * Comments: The cache must be unlocked. The item is removed from cache.      *
+ *                                                                            *
+ ******************************************************************************/
+static int	vc_db_get_aggregate(zbx_uint64_t itemid, unsigned char value_type, int seconds, int count,
+		const zbx_timespec_t *ts, zbx_vc_aggregate_t *aggr)
+{
+	zbx_vector_history_record_t	values;
+	int				ret, i;
+
+	zbx_history_record_vector_create(&values);
+
+	ret = vc_db_get_values(itemid, value_type, &values, seconds, count, ts);
+
+	WRLOCK_CACHE;
+
+	if (ZBX_VC_DISABLED != vc_state)
+		vc_remove_item_by_id(itemid);
+
+	if (SUCCEED == ret)
+	{
+		memset(aggr, 0, sizeof(zbx_vc_aggregate_t));
+
+		for (i = 0; i < values.values_num; i++)
+			vc_aggregate_add_value(aggr, value_type, &values.values[i].value);
+
+		vc_update_statistics(NULL, 0, values.values_num, (int)time(NULL));
+	}
+
+	UNLOCK_CACHE;
+
+	zbx_history_record_vector_destroy(&values, value_type);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get aggregates of item history data for the specified time period *
+ *                                                                            *
+ * Parameters: itemid     - [IN] the item id                                  *
+ *             value_type - [IN] the item value type                          *
+ *             seconds    - [IN] the time period to aggregate data for        *
+ *             count      - [IN] the number of history values to aggregate    *
+ *             ts         - [IN] the period end timestamp                     *
+ *             aggr       - [OUT] the aggregates                              *
+ *                                                                            *
+ * Return value:  SUCCEED - the aggregates were calculated successfully       *
+ *                FAIL    - the item history data was not retrieved           *
+ *                                                                            *
+ * Comments: The value range is defined in the same way as in                 *
+ *           zbx_vc_get_values() function.                                    *
+ *                                                                            *
+ *           Sealed chunks keep aggregates of their values, so only the       *
+ *           chunks at the range boundaries are iterated value by value.      *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_vc_get_aggregate(zbx_uint64_t itemid, unsigned char value_type, int seconds, int count,
+		const zbx_timespec_t *ts, zbx_vc_aggregate_t *aggr)
+{
+	int 		ret, cache_used = 1;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() itemid:" ZBX_FS_UI64 " value_type:%d count:%d period:%d end_timestamp"
+			" '%s'", __func__, itemid, value_type, count, seconds, zbx_timespec_str(ts));
+
+	RDLOCK_CACHE;
+
+	if (ZBX_VC_DISABLED != vc_state && ZBX_VC_MODE_LOWMEM == vc_cache->mode)
 		vc_warn_low_memory();
 
-	if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)))
-	{
-		if (ZBX_VC_MODE_NORMAL != vc_cache->mode)
-			goto out;
+	ret = vc_item_get_aggregate(itemid, value_type, seconds, count, ts, aggr);
 
-		memset(&new_item, 0, sizeof(new_item));
-		new_item.itemid = itemid;
-		new_item.value_type = value_type;
-		item = &new_item;
-	}
-	else if (item->value_type != value_type)
-		goto out;
+	UNLOCK_CACHE;
 
-	ret = vch_item_get_values(item, values, seconds, count, ts);
-out:
 	if (FAIL == ret)
 	{
 		cache_used = 0;
-
-		UNLOCK_CACHE;
-		ret = vc_db_get_values(itemid, value_type, values, seconds, count, ts);
-		WRLOCK_CACHE;
-
-		if (ZBX_VC_DISABLED != vc_state)
-			vc_remove_item_by_id(itemid);
-
-		if (SUCCEED == ret)
-			vc_update_statistics(NULL, 0, values->values_num, (int)time(NULL));
+		ret = vc_db_get_aggregate(itemid, value_type, seconds, count, ts, aggr);
 	}
 
-	UNLOCK_CACHE;
-
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s count:%d cached:%d",
-			__func__, zbx_result_string(ret), values->values_num, cache_used);
+			__func__, zbx_result_string(ret), SUCCEED == ret ? aggr->values_num : 0, cache_used);
 
 	return ret;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: get the last history value with a timestamp less or equal to the  *
- *          target timestamp                                                  *
- *                                                                            *
- * Parameters: itemid     - [IN] the item id                                  *
- *             value_type - [IN] the item value type                          *
- *             ts         - [IN] the target timestamp                         *
- *             value      - [OUT] the value found                             *
+ * Purpose: get aggregates of history data of multiple items for the          *
+ *          specified time period                                             *
  *                                                                            *
- * Return Value: SUCCEED - the item was retrieved                             *
- *               FAIL    - otherwise                                          *
+ * Parameters: itemids     - [IN] the item ids                                *
+ *             value_types - [IN] the item value types                        *
+ *             items_num   - [IN] the number of items                         *
+ *             seconds     - [IN] the time period to aggregate data for       *
+ *             count       - [IN] the number of history values to aggregate   *
+ *             ts          - [IN] the period end timestamp                    *
+ *             aggrs       - [OUT] the aggregates of each item                *
+ *             errcodes    - [OUT] SUCCEED if the item aggregates were        *
+ *                                 calculated, FAIL otherwise                 *
  *                                                                            *
- * Comments: Depending on the value type this function might allocate memory  *
- *           to store value data. To free it use zbx_vc_history_value_clear() *
- *           function.                                                        *
+ * Comments: This function returns the same results as zbx_vc_get_aggregate() *
+ *           called for each item, but locks the cache once for all cached    *
+ *           items. Items with data missing from cache are read from          *
+ *           database after the cache is unlocked.                            *
  *                                                                            *
  ******************************************************************************/
-int	zbx_vc_get_value(zbx_uint64_t itemid, unsigned char value_type, const zbx_timespec_t *ts,
-		zbx_history_record_t *value)
+void	zbx_vc_get_aggregates(const zbx_uint64_t *itemids, const unsigned char *value_types, int items_num,
+		int seconds, int count, const zbx_timespec_t *ts, zbx_vc_aggregate_t *aggrs, int *errcodes)
 {
-	zbx_vector_history_record_t	values;
-	int				ret = FAIL;
+	int	i, cached_num = 0;
 
-	zbx_history_record_vector_create(&values);
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() items:%d count:%d period:%d end_timestamp '%s'", __func__, items_num,
+			count, seconds, zbx_timespec_str(ts));
 
-	if (SUCCEED != zbx_vc_get_values(itemid, value_type, &values, ts->sec, 1, ts) || 0 == values.values_num)
-		goto out;
+	RDLOCK_CACHE;
 
-	*value = values.values[0];
+	if (ZBX_VC_DISABLED != vc_state && ZBX_VC_MODE_LOWMEM == vc_cache->mode)
+		vc_warn_low_memory();
 
-	/* reset values vector size so the returned value is not cleared when destroying the vector */
-	values.values_num = 0;
+	for (i = 0; i < items_num; i++)
+	{
+		if (SUCCEED == (errcodes[i] = vc_item_get_aggregate(itemids[i], value_types[i], seconds, count, ts,
+				&aggrs[i])))
+		{
+			cached_num++;
+		}
+	}
 
-	ret = SUCCEED;
-out:
-	zbx_history_record_vector_destroy(&values, value_type);
+	UNLOCK_CACHE;
 
-	return ret;
+	if (cached_num != items_num)
+	{
+		for (i = 0; i < items_num; i++)
+		{
+			if (SUCCEED == errcodes[i])
+				continue;
+
+			errcodes[i] = vc_db_get_aggregate(itemids[i], value_types[i], seconds, count, ts, &aggrs[i]);
+		}
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() cached:%d", __func__, cached_num);
 }
 
 /******************************************************************************
@@ -2923,3 +4051,361 @@ void	zbx_vc_add_new_items(const zbx_vector_uint64_pair_t *items)
 
 	UNLOCK_CACHE;
 }
+
+static int	vc_item_range_compare_func(const void *d1, const void *d2)
+{
+	const zbx_vc_item_range_t	*range1 = (const zbx_vc_item_range_t *)d1;
+	const zbx_vc_item_range_t	*range2 = (const zbx_vc_item_range_t *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(range1->value_type, range2->value_type);
+	ZBX_RETURN_IF_NOT_EQUAL(range1->seconds, range2->seconds);
+	ZBX_RETURN_IF_NOT_EQUAL(range1->itemid, range2->itemid);
+
+	return 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: marks items to be loaded by prefetch                              *
+ *                                                                            *
+ * Parameters: ranges  - [IN/OUT] the item ranges sorted by itemid, ranges of *
+ *                                items that cannot be prefetched are reset   *
+ *             num     - [IN] the number of item ranges                       *
+ *             itemids - [OUT] the identifiers of items to prefetch           *
+ *             now     - [IN] the current time                                *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_prefetch_mark_items(zbx_vc_item_range_t *ranges, int num, zbx_vector_uint64_t *itemids, int now)
+{
+	for (int i = 0; i < num; i++)
+	{
+		zbx_vc_item_t	*item;
+
+		if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &ranges[i].itemid)))
+		{
+			zbx_vc_item_t	item_local = {
+					.itemid = ranges[i].itemid,
+					.value_type = ranges[i].value_type,
+					.status = ZBX_ITEM_STATUS_PREFETCH,
+					.last_accessed = now
+			};
+
+			if (NULL == zbx_hashset_insert(&vc_cache->items, &item_local, sizeof(item_local)))
+			{
+				/* out of memory - cache will switch to low memory mode on next caching request */
+				for (; i < num; i++)
+					ranges[i].seconds = 0;
+
+				break;
+			}
+		}
+		else if (item->value_type != ranges[i].value_type || 0 != item->status || 0 != item->db_cached_from ||
+				NULL != item->head)
+		{
+			/* the item is already cached or being cached by another process */
+			ranges[i].seconds = 0;
+			continue;
+		}
+		else
+			item->status = ZBX_ITEM_STATUS_PREFETCH;
+
+		zbx_vector_uint64_append(itemids, ranges[i].itemid);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes items that were not loaded by prefetch                    *
+ *                                                                            *
+ * Parameters: ranges - [IN] the prefetched item ranges                       *
+ *             num    - [IN] the number of item ranges                        *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_prefetch_release_items(const zbx_vc_item_range_t *ranges, int num)
+{
+	for (int i = 0; i < num; i++)
+	{
+		zbx_vc_item_t	*item;
+
+		if (0 == ranges[i].seconds)
+			continue;
+
+		if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &ranges[i].itemid)))
+			continue;
+
+		if (ZBX_ITEM_STATUS_PREFETCH == item->status)
+			vc_remove_item(item);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: caches prefetched item history                                    *
+ *                                                                            *
+ * Parameters: ranges     - [IN] the prefetched item ranges sorted by itemid  *
+ *             num        - [IN] the number of item ranges                    *
+ *             value_type - [IN] the item value type                          *
+ *             values     - [IN] the item history sorted by itemid            *
+ *             now        - [IN] the time the item ranges were calculated at  *
+ *                                                                            *
+ * Return value: The number of cached values.                                 *
+ *                                                                            *
+ * Comments: Items can be accessed by other processes during prefetch. If the *
+ *           item was removed or its history was read from database by other  *
+ *           process meanwhile, only the history not cached yet is added.     *
+ *                                                                            *
+ ******************************************************************************/
+static int	vc_prefetch_cache_items(const zbx_vc_item_range_t *ranges, int num, unsigned char value_type,
+		const zbx_vector_history_item_record_t *values, int now)
+{
+	zbx_vector_history_record_t	records;
+	int				i, j = 0, values_num = 0;
+
+	zbx_history_record_vector_create(&records);
+
+	for (i = 0; i < num; i++)
+	{
+		zbx_vc_item_t	*item;
+		int		range_start;
+
+		if (0 == ranges[i].seconds)
+			continue;
+
+		range_start = now - ranges[i].seconds;
+		zbx_vector_history_record_clear(&records);
+
+		for (; j < values->values_num && values->values[j].itemid < ranges[i].itemid; j++)
+			;
+
+		for (; j < values->values_num && values->values[j].itemid == ranges[i].itemid; j++)
+		{
+			if (values->values[j].record.timestamp.sec >= range_start)
+				zbx_vector_history_record_append_ptr(&records, &values->values[j].record);
+		}
+
+		if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &ranges[i].itemid)))
+			continue;
+
+		if (item->value_type != value_type || ZBX_ITEM_STATUS_CACHED_ALL == item->status)
+			continue;
+
+		if (ZBX_ITEM_STATUS_PREFETCH != item->status && (0 == item->db_cached_from ||
+				range_start >= item->db_cached_from))
+		{
+			continue;
+		}
+
+		if (0 != records.values_num)
+		{
+			zbx_vector_history_record_sort(&records,
+					(zbx_compare_func_t)zbx_history_record_compare_asc_func);
+
+			if (FAIL == vch_item_add_values_at_tail(item, records.values, records.values_num))
+			{
+				vc_remove_item(item);
+				continue;
+			}
+		}
+
+		item->status = 0;
+		vc_item_update_db_cached_from(item, range_start);
+		vch_item_update_range(item, ranges[i].seconds, now);
+		values_num += records.values_num;
+	}
+
+	zbx_vector_history_record_destroy(&records);
+
+	return values_num;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculates the memory used by history values read from database  *
+ *                                                                            *
+ * Parameters: values     - [IN] the history values                           *
+ *             value_type - [IN] the value type                               *
+ *                                                                            *
+ * Return value: The size of history values in bytes.                        *
+ *                                                                            *
+ ******************************************************************************/
+static size_t	vc_prefetch_values_size(const zbx_vector_history_item_record_t *values, unsigned char value_type)
+{
+	size_t	size = (size_t)values->values_num * sizeof(zbx_history_item_record_t);
+
+	for (int i = 0; i < values->values_num; i++)
+	{
+		const zbx_history_value_t	*value = &values->values[i].record.value;
+
+		switch (value_type)
+		{
+			case ITEM_VALUE_TYPE_STR:
+			case ITEM_VALUE_TYPE_TEXT:
+				size += strlen(value->str) + 1;
+				break;
+			case ITEM_VALUE_TYPE_LOG:
+				size += sizeof(zbx_log_value_t) + strlen(value->log->value) + 1;
+				if (NULL != value->log->source)
+					size += strlen(value->log->source) + 1;
+				break;
+		}
+	}
+
+	return size;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculates the number of items to prefetch with one request       *
+ *                                                                            *
+ * Parameters: ranges       - [IN] the remaining item ranges, sorted by value *
+ *                                 type and range                             *
+ *             ranges_num   - [IN] the number of remaining item ranges        *
+ *             size         - [IN] the size of values read so far for the     *
+ *                                 same value type                            *
+ *             item_seconds - [IN] the sum of item ranges the values were     *
+ *                                 read for                                   *
+ *             free_size    - [IN] the free value cache memory                *
+ *                                                                            *
+ * Return value: The number of items in the batch.                            *
+ *                                                                            *
+ * Comments: The values of a batch are read into process memory before they  *
+ *           are cached. Batches are limited to the items with similar ranges *
+ *           and, based on the history size per item second read so far, to   *
+ *           the values expected to fit in the free value cache memory.       *
+ *                                                                            *
+ ******************************************************************************/
+static int	vc_prefetch_batch_size(const zbx_vc_item_range_t *ranges, int ranges_num, zbx_uint64_t size,
+		zbx_uint64_t item_seconds, zbx_uint64_t free_size)
+{
+	int	num, max_num = ZBX_VC_PREFETCH_BATCH_SIZE;
+
+	if (0 == item_seconds)
+	{
+		max_num = ZBX_VC_PREFETCH_PROBE_SIZE;
+	}
+	else if (0 != size)
+	{
+		double	batch_size;
+
+		/* expected size of values of one item with the largest range allowed in batch */
+		batch_size = (double)size / (double)item_seconds * (double)ranges[0].seconds *
+				ZBX_VC_PREFETCH_RANGE_FACTOR;
+
+		if ((double)free_size < batch_size * max_num)
+			max_num = MAX(1, (int)((double)free_size / batch_size));
+	}
+
+	for (num = 1; num < max_num && num < ranges_num && ranges[0].value_type == ranges[num].value_type &&
+			ranges[num].seconds <= ranges[0].seconds * ZBX_VC_PREFETCH_RANGE_FACTOR; num++)
+		;
+
+	return num;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: loads item history ranges into value cache                        *
+ *                                                                            *
+ * Parameters: ranges - [IN] the item history ranges, sorted during prefetch  *
+ *                                                                            *
+ * Return value: The number of cached values.                                 *
+ *                                                                            *
+ * Comments: The history of items with the same value type and similar ranges *
+ *           is read with one request per batch of items. Items already       *
+ *           present in cache are skipped and prefetch is stopped when cache  *
+ *           runs out of memory.                                              *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_vc_prefetch(zbx_vector_vc_item_range_t *ranges)
+{
+	zbx_vector_uint64_t			itemids;
+	zbx_vector_history_item_record_t	values;
+	int					i, now, values_num = 0;
+	zbx_uint64_t				size = 0, item_seconds = 0, free_size = 0;
+	unsigned char				value_type = ITEM_VALUE_TYPE_NONE;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() ranges:%d", __func__, ranges->values_num);
+
+	if (ZBX_VC_DISABLED == vc_state)
+		goto out;
+
+	zbx_vector_uint64_create(&itemids);
+	zbx_vector_history_item_record_create(&values);
+
+	/* items with shorter ranges are prefetched first, so most of them are cached if cache is not large enough */
+	zbx_vector_vc_item_range_sort(ranges, vc_item_range_compare_func);
+
+	now = (int)time(NULL);
+
+	for (i = 0; i < ranges->values_num;)
+	{
+		zbx_vc_item_range_t	*batch = &ranges->values[i];
+		int			j, num, seconds, ret;
+
+		/* history size per item second depends on value type */
+		if (value_type != batch->value_type)
+		{
+			value_type = batch->value_type;
+			size = 0;
+			item_seconds = 0;
+		}
+
+		num = vc_prefetch_batch_size(batch, ranges->values_num - i, size, item_seconds, free_size);
+		i += num;
+		seconds = batch[num - 1].seconds;
+
+		qsort(batch, (size_t)num, sizeof(zbx_vc_item_range_t), ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+		WRLOCK_CACHE;
+
+		if (ZBX_VC_MODE_NORMAL != vc_cache->mode)
+		{
+			UNLOCK_CACHE;
+			break;
+		}
+
+		vc_prefetch_mark_items(batch, num, &itemids, now);
+
+		UNLOCK_CACHE;
+
+		if (0 == itemids.values_num)
+			continue;
+
+		/* the range start is excluded by history backend */
+		ret = zbx_history_get_items_values(itemids.values, itemids.values_num, value_type, now - seconds - 1,
+				&values);
+
+		if (SUCCEED == ret)
+		{
+			size += vc_prefetch_values_size(&values, value_type);
+			item_seconds += (zbx_uint64_t)itemids.values_num * (zbx_uint64_t)seconds;
+		}
+
+		WRLOCK_CACHE;
+
+		if (SUCCEED == ret)
+			values_num += vc_prefetch_cache_items(batch, num, value_type, &values, now);
+		else
+			vc_prefetch_release_items(batch, num);
+
+		free_size = vc_mem->free_size;
+
+		UNLOCK_CACHE;
+
+		for (j = 0; j < values.values_num; j++)
+			zbx_history_record_clear(&values.values[j].record, value_type);
+
+		zbx_vector_history_item_record_clear(&values);
+		zbx_vector_uint64_clear(&itemids);
+
+		if (SUCCEED != ret)
+			break;
+	}
+
+	zbx_vector_history_item_record_destroy(&values);
+	zbx_vector_uint64_destroy(&itemids);
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() values:%d", __func__, values_num);
+
+	return values_num;
+}
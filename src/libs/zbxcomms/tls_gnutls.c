@@ -1129,6 +1129,18 @@ void	zbx_tls_init_child(const zbx_config_tls_t *config_tls, zbx_get_program_type
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: enables resumption of outgoing certificate-based TLS sessions     *
+ *                                                                            *
+ * Comments: Session resumption is not implemented with GnuTLS, every         *
+ *           connection performs full handshake.                              *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_tls_enable_session_resumption(void)
+{
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: release TLS library resources allocated in zbx_tls_init_parent()  *
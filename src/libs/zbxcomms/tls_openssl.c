@@ -213,6 +213,24 @@ static ZBX_THREAD_LOCAL char			incoming_connection_psk_id[PSK_MAX_IDENTITY_LEN +
 /* buffer for messages produced by zbx_openssl_info_cb() */
 ZBX_THREAD_LOCAL char				info_buf[256];
 
+#if OPENSSL_VERSION_NUMBER >= 0x1010100fL && !defined(LIBRESSL_VERSION_NUMBER)	/* only OpenSSL 1.1.1 or newer */
+#define ZBX_TLS_SESSION_CACHE_SIZE	1024
+
+/* certificate-based session of outgoing connection, kept for resumption by next connection to the same peer */
+typedef struct
+{
+	char		peer[ZBX_MAX_DNSNAME_LEN + 1];
+	SSL_SESSION	*session;
+}
+zbx_tls_session_t;
+
+static ZBX_THREAD_LOCAL zbx_tls_session_t	*session_cache = NULL;
+
+/* session ticket keys shared by all agentd listeners so that any of them can resume session */
+static unsigned char	ticket_keys[80];
+static int		ticket_keys_set = 0;
+#endif
+
 /******************************************************************************
  *                                                                            *
  * Purpose: get state, alert, error information on TLS connection             *
@@ -808,6 +826,14 @@ void	zbx_tls_init_parent(zbx_get_program_type_f zbx_get_program_type_cb_arg)
 	zbx_get_program_type_cb = zbx_get_program_type_cb_arg;
 
 	zbx_tls_library_init(ZBX_TLS_INIT_THREADS);
+
+#if OPENSSL_VERSION_NUMBER >= 0x1010100fL && !defined(LIBRESSL_VERSION_NUMBER)	/* only OpenSSL 1.1.1 or newer */
+	if (0 != (zbx_get_program_type_cb() & ZBX_PROGRAM_TYPE_AGENTD) &&
+			1 == RAND_bytes(ticket_keys, sizeof(ticket_keys)))
+	{
+		ticket_keys_set = 1;
+	}
+#endif
 }
 
 static const char	*zbx_ctx_name(SSL_CTX *param)
@@ -1159,6 +1185,21 @@ void	zbx_tls_init_child(const zbx_config_tls_t *config_tls, zbx_get_program_type
 		/* disable session caching */
 		SSL_CTX_set_session_cache_mode(ctx_cert, SSL_SESS_CACHE_OFF);
 
+#if OPENSSL_VERSION_NUMBER >= 0x1010100fL && !defined(LIBRESSL_VERSION_NUMBER)	/* only OpenSSL 1.1.1 or newer */
+		/* Allow agentd to resume certificate-based sessions with stateless tickets. Peer certificate is */
+		/* stored in ticket, so issuer and subject are still verified on resumed connection. */
+		if (0 != ticket_keys_set)
+		{
+			if (1 != SSL_CTX_set_tlsext_ticket_keys(ctx_cert, ticket_keys, sizeof(ticket_keys)))
+			{
+				zabbix_log(LOG_LEVEL_WARNING, "cannot set TLS session ticket keys, session resumption"
+						" is disabled");
+			}
+			else
+				SSL_CTX_clear_options(ctx_cert, SSL_OP_NO_TICKET);
+		}
+#endif
+
 		/* try to enable ECDH ciphersuites */
 		if (SUCCEED == zbx_set_ecdhe_parameters(ctx_cert))
 			ciphers = ZBX_CIPHERS_CERT_ECDHE ZBX_CIPHERS_CERT;
@@ -1465,6 +1506,20 @@ out1:
  ******************************************************************************/
 void	zbx_tls_free(void)
 {
+#if OPENSSL_VERSION_NUMBER >= 0x1010100fL && !defined(LIBRESSL_VERSION_NUMBER)	/* only OpenSSL 1.1.1 or newer */
+	if (NULL != session_cache)
+	{
+		int	i;
+
+		for (i = 0; i < ZBX_TLS_SESSION_CACHE_SIZE; i++)
+		{
+			if (NULL != session_cache[i].session)
+				SSL_SESSION_free(session_cache[i].session);
+		}
+
+		zbx_free(session_cache);
+	}
+#endif
 	if (NULL != ctx_cert)
 		SSL_CTX_free(ctx_cert);
 
@@ -1558,6 +1613,73 @@ static const char	*tls_error_string(int err)
 	}
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: enables resumption of outgoing certificate-based TLS sessions     *
+ *                                                                            *
+ * Comments: Intended for processes connecting to the same peers repeatedly.  *
+ *           Session of closed connection is kept per peer address and is     *
+ *           offered on next connection to it.                                *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_tls_enable_session_resumption(void)
+{
+#if OPENSSL_VERSION_NUMBER >= 0x1010100fL && !defined(LIBRESSL_VERSION_NUMBER)	/* only OpenSSL 1.1.1 or newer */
+	if (NULL != session_cache)
+		return;
+
+	session_cache = (zbx_tls_session_t *)zbx_malloc(NULL, ZBX_TLS_SESSION_CACHE_SIZE * sizeof(zbx_tls_session_t));
+	memset(session_cache, 0, ZBX_TLS_SESSION_CACHE_SIZE * sizeof(zbx_tls_session_t));
+#endif
+}
+
+#if OPENSSL_VERSION_NUMBER >= 0x1010100fL && !defined(LIBRESSL_VERSION_NUMBER)	/* only OpenSSL 1.1.1 or newer */
+static zbx_tls_session_t	*tls_session_cache_slot(const char *peer)
+{
+	zbx_uint32_t	hash = 5381;
+
+	while ('\0' != *peer)
+		hash = hash * 33 + (unsigned char)*peer++;
+
+	return &session_cache[hash % ZBX_TLS_SESSION_CACHE_SIZE];
+}
+
+static void	tls_session_resume(SSL *ctx, const char *peer)
+{
+	zbx_tls_session_t	*slot;
+
+	SSL_clear_options(ctx, SSL_OP_NO_TICKET);
+
+	slot = tls_session_cache_slot(peer);
+
+	if (NULL != slot->session && 0 == strcmp(slot->peer, peer) && 1 != SSL_set_session(ctx, slot->session))
+		zabbix_log(LOG_LEVEL_DEBUG, "cannot set TLS session for resumption with %s", peer);
+}
+
+static void	tls_session_store(SSL *ctx, const char *peer)
+{
+	zbx_tls_session_t	*slot;
+	SSL_SESSION		*session;
+
+	if (NULL == (session = SSL_get1_session(ctx)))
+		return;
+
+	if (1 != SSL_SESSION_is_resumable(session))
+	{
+		SSL_SESSION_free(session);
+		return;
+	}
+
+	slot = tls_session_cache_slot(peer);
+
+	if (NULL != slot->session)
+		SSL_SESSION_free(slot->session);
+
+	zbx_strlcpy(slot->peer, peer, sizeof(slot->peer));
+	slot->session = session;
+}
+#endif
+
 /******************************************************************************
  *                                                                            *
  * Purpose: establish a TLS connection over an established TCP connection     *
@@ -1625,6 +1747,10 @@ int	zbx_tls_connect(zbx_socket_t *s, unsigned int tls_connect, const char *tls_a
 				zbx_tls_error_msg(error, &error_alloc, &error_offset);
 				goto out;
 			}
+#if OPENSSL_VERSION_NUMBER >= 0x1010100fL && !defined(LIBRESSL_VERSION_NUMBER)	/* only OpenSSL 1.1.1 or newer */
+			if (NULL != session_cache)
+				tls_session_resume(s->tls_ctx->ctx, s->peer);
+#endif
 		}
 	}
 	else if (ZBX_TCP_SEC_TLS_PSK == tls_connect)
@@ -1778,6 +1904,14 @@ int	zbx_tls_connect(zbx_socket_t *s, unsigned int tls_connect, const char *tls_a
 		/* log peer certificate information for debugging */
 		zbx_log_peer_cert(__func__, s->tls_ctx);
 
+#if OPENSSL_VERSION_NUMBER >= 0x1010100fL && !defined(LIBRESSL_VERSION_NUMBER)	/* only OpenSSL 1.1.1 or newer */
+		if (NULL != session_cache)
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "%s(): TLS session with %s %s", __func__, s->peer,
+					1 == SSL_session_reused(s->tls_ctx->ctx) ? "resumed" : "not resumed");
+		}
+#endif
+
 		/* perform basic verification of peer certificate */
 		if (X509_V_OK != (verify_result = SSL_get_verify_result(s->tls_ctx->ctx)))
 		{
@@ -2221,6 +2355,13 @@ void	zbx_tls_close(zbx_socket_t *s)
 
 	if (NULL != s->tls_ctx->ctx)
 	{
+#if OPENSSL_VERSION_NUMBER >= 0x1010100fL && !defined(LIBRESSL_VERSION_NUMBER)	/* only OpenSSL 1.1.1 or newer */
+		if (NULL != session_cache && ZBX_TCP_SEC_TLS_CERT == s->connection_type &&
+				0 == SSL_is_server(s->tls_ctx->ctx))
+		{
+			tls_session_store(s->tls_ctx->ctx, s->peer);
+		}
+#endif
 		info_buf[0] = '\0';	/* empty buffer for zbx_openssl_info_cb() messages */
 
 		/* After TLS shutdown the TCP connection will be closed. So, there is no need to do a bidirectional */
@@ -17,6 +17,8 @@
 #include "zbxstr.h"
 #include "zbxtime.h"
 #include "zbxjson.h"
+#include "zbxalgo.h"
+#include "zbxdbschema.h"
 #include "zbx_dbversion_constants.h"
 
 #if defined(HAVE_MYSQL)
@@ -25,7 +27,6 @@
 #	include "mysqld_error.h"
 #elif defined(HAVE_ORACLE)
 #	include "zbxcrypto.h"
-#	include "zbxdbschema.h"
 #	include "oci.h"
 #elif defined(HAVE_POSTGRESQL)
 #	include <libpq-fe.h>
@@ -36,10 +37,35 @@
 #if defined(HAVE_SQLITE3)
 #	include "zbxmutexs.h"
 #endif
+
+#if defined(HAVE_MYSQL) || defined(HAVE_POSTGRESQL)
+/* cached prepared statement */
+typedef struct
+{
+	char		*sql;
+#if defined(HAVE_MYSQL)
+	MYSQL_STMT	*handle;
+	/* result set of the statement being fetched, NULL if the statement is not in use */
+	zbx_db_result_t	result;
+#else
+	char		name[ZBX_MAX_UINT64_LEN + 10];
+#endif
+}
+zbx_db_stmt_t;
+#endif
+
 struct zbx_db_result
 {
 #if defined(HAVE_MYSQL)
 	MYSQL_RES	*result;
+
+	/* prepared statement result set */
+	MYSQL_STMT	*stmt;
+	zbx_db_stmt_t	*stmt_cached;	/* the cached statement, NULL if statement must be closed with result */
+	MYSQL_BIND	*bind;
+	unsigned long	*lengths;
+	int		fld_num;
+	zbx_db_row_t	values;
 #elif defined(HAVE_ORACLE)
 	OCIStmt		*stmthp;	/* the statement handle for select operations */
 	int		ncolumn;
@@ -71,6 +97,23 @@ static int		config_log_slow_queries;
 
 static int		db_auto_increment;
 
+#if defined(HAVE_MYSQL) || defined(HAVE_POSTGRESQL)
+#define ZBX_DB_BATCH_SIZE_MAX	(512 * ZBX_KIBIBYTE)
+
+static int		batch_mode = 0;		/* statements within transaction are batched */
+static int		batch_txn_begin = 0;	/* transaction begin statement is batched */
+static char		*batch_sql = NULL;	/* batched statements not sent to database yet */
+static size_t		batch_sql_alloc = 0, batch_sql_offset = 0;
+
+#define ZBX_DB_STMT_CACHE_MAX	256
+
+static int		stmt_enabled = 1;	/* server side prepared statements are used */
+static zbx_hashset_t	stmt_cache;	/* prepared statements of the current connection by their SQL text */
+static zbx_uint64_t	stmt_num = 0;
+
+static void	db_stmt_cache_clear(void);
+#endif
+
 #if defined(HAVE_MYSQL)
 static MYSQL			*conn = NULL;
 static int			mysql_err_cnt = 0;
@@ -78,8 +121,6 @@ static zbx_uint32_t		ZBX_MYSQL_SVERSION = ZBX_DBVERSION_UNDEFINED;
 static int			ZBX_MARIADB_SFORK = OFF;
 static int			txn_begin = 0;	/* transaction begin statement is executed */
 #elif defined(HAVE_ORACLE)
-#include "zbxalgo.h"
-
 typedef struct
 {
 	OCIEnv			*envhp;
@@ -446,6 +487,10 @@ int	zbx_db_connect_basic(const zbx_config_dbhigh_t *cfg)
 	txn_error = ZBX_DB_OK;
 	txn_level = 0;
 
+#if defined(HAVE_MYSQL) || defined(HAVE_POSTGRESQL)
+	stmt_enabled = cfg->config_db_prepared_statements;
+#endif
+
 #if defined(HAVE_MYSQL)
 	if (NULL == (conn = mysql_init(NULL)))
 	{
@@ -1012,7 +1057,81 @@ void	zbx_db_close_basic(void)
 		conn = NULL;
 	}
 #endif
+#if defined(HAVE_MYSQL) || defined(HAVE_POSTGRESQL)
+	db_stmt_cache_clear();
+
+	zbx_free(batch_sql);
+	batch_sql_alloc = 0;
+	batch_sql_offset = 0;
+	batch_txn_begin = 0;
+#endif
+}
+
+#if defined(HAVE_MYSQL) || defined(HAVE_POSTGRESQL)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sends batched statements to database in a single round trip       *
+ *                                                                            *
+ * Return value: ZBX_DB_FAIL (on error) or ZBX_DB_DOWN (on recoverable error) *
+ *               or number of rows affected (on success)                      *
+ *                                                                            *
+ * Comments: Transaction is marked as failed if the statements cannot be      *
+ *           executed, so it will be rolled back on commit.                   *
+ *                                                                            *
+ ******************************************************************************/
+static int	db_batch_flush(void)
+{
+	int	ret, mode = batch_mode;
+
+	if (0 == batch_sql_offset)
+		return ZBX_DB_OK;
+
+	batch_mode = 0;
+	ret = zbx_db_execute_basic("%s", batch_sql);
+	batch_mode = mode;
+
+	batch_sql_offset = 0;
+	batch_txn_begin = 0;
+
+	if (ZBX_DB_OK > ret && 0 < txn_level)
+		txn_error = ret;
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds statement to batch, sending the batch to database first if   *
+ *          it would grow too large                                           *
+ *                                                                            *
+ * Return value: ZBX_DB_OK (on success), ZBX_DB_FAIL (on error) or            *
+ *               ZBX_DB_DOWN (on recoverable error)                           *
+ *                                                                            *
+ ******************************************************************************/
+static int	db_batch_add(const char *sql)
+{
+	size_t	len;
+	int	ret;
+
+	len = strlen(sql);
+
+	if (0 != batch_sql_offset && ZBX_DB_BATCH_SIZE_MAX < batch_sql_offset + len &&
+			ZBX_DB_OK > (ret = db_batch_flush()))
+	{
+		return ret;
+	}
+
+	zbx_strcpy_alloc(&batch_sql, &batch_sql_alloc, &batch_sql_offset, sql);
+
+	while (0 < len && NULL != strchr(" \t\r\n", sql[len - 1]))
+		len--;
+
+	if (0 == len || ';' != sql[len - 1])
+		zbx_strcpy_alloc(&batch_sql, &batch_sql_alloc, &batch_sql_offset, ";\n");
+
+	return ZBX_DB_OK;
 }
+#endif
 
 /******************************************************************************
  *                                                                            *
@@ -1037,6 +1156,7 @@ int	zbx_db_begin_basic(void)
 
 #if defined(HAVE_MYSQL) || defined(HAVE_POSTGRESQL)
 	rc = zbx_db_execute_basic("begin;");
+	batch_txn_begin = (0 != batch_sql_offset);
 #elif defined(HAVE_SQLITE3)
 	zbx_mutex_lock(sqlite_access);
 	rc = zbx_db_execute_basic("begin;");
@@ -1080,6 +1200,10 @@ int	zbx_db_commit_basic(void)
 #elif defined(HAVE_MYSQL) || defined(HAVE_POSTGRESQL) || defined(HAVE_SQLITE3)
 	rc = zbx_db_execute_basic("commit;");
 #endif
+#if defined(HAVE_MYSQL) || defined(HAVE_POSTGRESQL)
+	if (ZBX_DB_OK <= rc)
+		rc = db_batch_flush();
+#endif
 
 	if (ZBX_DB_OK > rc) { /* commit failed */
 		txn_error = rc;
@@ -1123,7 +1247,19 @@ int	zbx_db_rollback_basic(void)
 	txn_error = ZBX_DB_OK;
 
 #if defined(HAVE_MYSQL) || defined(HAVE_POSTGRESQL)
-	rc = zbx_db_execute_basic("rollback;");
+	batch_sql_offset = 0;
+
+	/* nothing was sent to database if the transaction begin statement is still batched */
+	if (0 == batch_txn_begin)
+	{
+		int	mode = batch_mode;
+
+		batch_mode = 0;
+		rc = zbx_db_execute_basic("rollback;");
+		batch_mode = mode;
+	}
+
+	batch_txn_begin = 0;
 #elif defined(HAVE_ORACLE)
 	if (OCI_SUCCESS != (err = OCITransRollback(oracle.svchp, oracle.errhp, OCI_DEFAULT)))
 		rc = OCI_handle_sql_error(ERR_Z3005, err, "rollback failed");
@@ -1159,6 +1295,38 @@ int	zbx_db_txn_end_error(void)
 	return txn_end_error;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: starts batching statements executed within transactions           *
+ *                                                                            *
+ * Comments: Batched statements are sent to database together in a single     *
+ *           round trip before the next select, copy or transaction commit.   *
+ *           Because of that the execution of batched statements always       *
+ *           returns ZBX_DB_OK instead of the number of affected rows, and    *
+ *           errors are reported later, when the batch is sent.               *
+ *           Batching is supported only with MySQL and PostgreSQL.            *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_db_batch_begin(void)
+{
+#if defined(HAVE_MYSQL) || defined(HAVE_POSTGRESQL)
+	batch_mode = 1;
+#endif
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: stops batching statements, sending the pending ones to database   *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_db_batch_end(void)
+{
+#if defined(HAVE_MYSQL) || defined(HAVE_POSTGRESQL)
+	db_batch_flush();
+	batch_mode = 0;
+#endif
+}
+
 #ifdef HAVE_ORACLE
 static sword	zbx_oracle_statement_prepare(const char *sql)
 {
@@ -1452,6 +1620,145 @@ void	zbx_postgresql_escape_bin(const char *src, char **dst, size_t size)
 
 	*dst = (char*)PQescapeByteaConn(conn, (const unsigned char*)src, size, &dst_size);
 }
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: logs failed non-select statement error                            *
+ *                                                                            *
+ * Parameters: result - [IN] the failed statement result                      *
+ *             sql    - [IN] the statement                                    *
+ *                                                                            *
+ * Return value: ZBX_DB_FAIL or ZBX_DB_DOWN (on recoverable error)            *
+ *                                                                            *
+ ******************************************************************************/
+static int	zbx_postgresql_execute_error(const PGresult *result, const char *sql)
+{
+	zbx_err_codes_t	errcode;
+	char		*error = NULL;
+
+	zbx_postgresql_error(&error, result);
+
+	if (0 == zbx_strcmp_null(PQresultErrorField(result, PG_DIAG_SQLSTATE), ZBX_PG_UNIQUE_VIOLATION))
+		errcode = ERR_Z3008;
+	else if (0 == zbx_strcmp_null(PQresultErrorField(result, PG_DIAG_SQLSTATE), ZBX_PG_READ_ONLY))
+		errcode = ERR_Z3009;
+	else
+		errcode = ERR_Z3005;
+
+	zbx_db_errlog(errcode, 0, error, sql);
+	zbx_free(error);
+
+	return SUCCEED == is_recoverable_postgresql_error(conn, result) ? ZBX_DB_DOWN : ZBX_DB_FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: copies rows into table with COPY FROM STDIN statement             *
+ *                                                                            *
+ * Parameters: sql      - [IN] the copy statement                             *
+ *             data     - [IN] the rows in COPY text format                   *
+ *             data_len - [IN] the data length                                *
+ *                                                                            *
+ * Return value: ZBX_DB_FAIL (on error) or ZBX_DB_DOWN (on recoverable error) *
+ *               or number of rows copied (on success)                        *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_db_copy_from(const char *sql, const char *data, size_t data_len)
+{
+#define ZBX_PG_COPY_CHUNK_SIZE	ZBX_MEBIBYTE
+	PGresult	*result;
+	int		ret = ZBX_DB_OK;
+	double		sec = 0;
+
+	if (0 != config_log_slow_queries)
+		sec = zbx_time();
+
+	if (0 == txn_level)
+		zabbix_log(LOG_LEVEL_DEBUG, "query without transaction detected");
+
+	if (ZBX_DB_OK != txn_error)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "ignoring query [txnlev:%d] [%s] within failed transaction", txn_level,
+				sql);
+		return ZBX_DB_FAIL;
+	}
+
+	/* batched statements are sent together with copy command, which must be the last one */
+	if (0 != batch_sql_offset)
+	{
+		zbx_strcpy_alloc(&batch_sql, &batch_sql_alloc, &batch_sql_offset, sql);
+		sql = batch_sql;
+		batch_sql_offset = 0;
+		batch_txn_begin = 0;
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "query [txnlev:%d] [%s] data size:" ZBX_FS_SIZE_T, txn_level, sql,
+			(zbx_fs_size_t)data_len);
+
+	if (NULL == (result = PQexec(conn, sql)))
+	{
+		zbx_db_errlog(ERR_Z3005, 0, "result is NULL", sql);
+		ret = (CONNECTION_OK == PQstatus(conn) ? ZBX_DB_FAIL : ZBX_DB_DOWN);
+		goto out;
+	}
+
+	if (PGRES_COPY_IN != PQresultStatus(result))
+	{
+		ret = zbx_postgresql_execute_error(result, sql);
+		PQclear(result);
+		goto out;
+	}
+
+	PQclear(result);
+
+	while (0 != data_len)
+	{
+		int	chunk_len = (int)MIN(data_len, ZBX_PG_COPY_CHUNK_SIZE);
+
+		if (1 != PQputCopyData(conn, data, chunk_len))
+			break;
+
+		data += chunk_len;
+		data_len -= (size_t)chunk_len;
+	}
+
+	/* the copy is aborted with error message if not all data was sent */
+	if (1 != PQputCopyEnd(conn, 0 == data_len ? NULL : "cannot send data"))
+	{
+		zbx_db_errlog(ERR_Z3005, 0, PQerrorMessage(conn), sql);
+		ret = (CONNECTION_OK == PQstatus(conn) ? ZBX_DB_FAIL : ZBX_DB_DOWN);
+	}
+
+	/* read all results to finish the copy */
+	while (NULL != (result = PQgetResult(conn)))
+	{
+		if (ZBX_DB_OK == ret)
+		{
+			if (PGRES_COMMAND_OK != PQresultStatus(result))
+				ret = zbx_postgresql_execute_error(result, sql);
+			else
+				ret = atoi(PQcmdTuples(result));
+		}
+
+		PQclear(result);
+	}
+out:
+	if (0 != config_log_slow_queries)
+	{
+		sec = zbx_time() - sec;
+		if (sec > (double)config_log_slow_queries / 1000.0)
+			zabbix_log(LOG_LEVEL_WARNING, "slow query: " ZBX_FS_DBL " sec, \"%s\"", sec, sql);
+	}
+
+	if (ZBX_DB_FAIL == ret && 0 < txn_level)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "query [%s] failed, setting transaction as failed", sql);
+		txn_error = ZBX_DB_FAIL;
+	}
+
+	return ret;
+#undef ZBX_PG_COPY_CHUNK_SIZE
+}
 #endif
 
 static char	*db_replace_nonprintable_chars(const char *sql, char **sql_printable)
@@ -1483,7 +1790,6 @@ int	zbx_db_vexecute(const char *fmt, va_list args)
 	sword		err = OCI_SUCCESS;
 #elif defined(HAVE_POSTGRESQL)
 	PGresult	*result;
-	char		*error = NULL;
 #elif defined(HAVE_SQLITE3)
 	int		err;
 	char		*error = NULL;
@@ -1505,6 +1811,13 @@ int	zbx_db_vexecute(const char *fmt, va_list args)
 		goto clean;
 	}
 
+#if defined(HAVE_MYSQL) || defined(HAVE_POSTGRESQL)
+	if (0 != batch_mode && 0 < txn_level)
+	{
+		ret = db_batch_add(sql);
+		goto clean;
+	}
+#endif
 	zabbix_log(LOG_LEVEL_DEBUG, "query [txnlev:%d] [%s]", txn_level,
 			db_replace_nonprintable_chars(sql, &sql_printable));
 
@@ -1581,23 +1894,7 @@ int	zbx_db_vexecute(const char *fmt, va_list args)
 		ret = (CONNECTION_OK == PQstatus(conn) ? ZBX_DB_FAIL : ZBX_DB_DOWN);
 	}
 	else if (PGRES_COMMAND_OK != PQresultStatus(result))
-	{
-		zbx_err_codes_t	errcode;
-
-		zbx_postgresql_error(&error, result);
-
-		if (0 == zbx_strcmp_null(PQresultErrorField(result, PG_DIAG_SQLSTATE), ZBX_PG_UNIQUE_VIOLATION))
-			errcode = ERR_Z3008;
-		else if (0 == zbx_strcmp_null(PQresultErrorField(result, PG_DIAG_SQLSTATE), ZBX_PG_READ_ONLY))
-			errcode = ERR_Z3009;
-		else
-			errcode = ERR_Z3005;
-
-		zbx_db_errlog(errcode, 0, error, sql);
-		zbx_free(error);
-
-		ret = (SUCCEED == is_recoverable_postgresql_error(conn, result) ? ZBX_DB_DOWN : ZBX_DB_FAIL);
-	}
+		ret = zbx_postgresql_execute_error(result, sql);
 
 	if (ZBX_DB_OK == ret)
 		ret = atoi(PQcmdTuples(result));
@@ -1662,6 +1959,55 @@ clean:
 	return ret;
 }
 
+#if defined(HAVE_POSTGRESQL)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: creates select statement result                                   *
+ *                                                                            *
+ * Parameters: pg_result - [IN] query result                                  *
+ *             sql       - [IN] query, used for error logging                 *
+ *                                                                            *
+ * Return value: data, NULL (on error) or (zbx_db_result_t)ZBX_DB_DOWN        *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_db_result_t	db_pg_result_create(PGresult *pg_result, const char *sql)
+{
+	zbx_db_result_t	result;
+	char		*error = NULL;
+
+	result = zbx_malloc(NULL, sizeof(struct zbx_db_result));
+	result->pg_result = pg_result;
+	result->values = NULL;
+	result->cursor = 0;
+	result->row_num = 0;
+
+	if (NULL == result->pg_result)
+		zbx_db_errlog(ERR_Z3005, 0, "result is NULL", sql);
+
+	if (PGRES_TUPLES_OK != PQresultStatus(result->pg_result))
+	{
+		zbx_postgresql_error(&error, result->pg_result);
+		zbx_db_errlog(ERR_Z3005, 0, error, sql);
+		zbx_free(error);
+
+		if (SUCCEED == is_recoverable_postgresql_error(conn, result->pg_result))
+		{
+			zbx_db_free_result(result);
+			result = (zbx_db_result_t)ZBX_DB_DOWN;
+		}
+		else
+		{
+			zbx_db_free_result(result);
+			result = NULL;
+		}
+	}
+	else	/* init rownum */
+		result->row_num = PQntuples(result->pg_result);
+
+	return result;
+}
+#endif
+
 /******************************************************************************
  *                                                                            *
  * Purpose: execute a select statement                                        *
@@ -1674,13 +2020,15 @@ zbx_db_result_t	zbx_db_vselect(const char *fmt, va_list args)
 	char		*sql = NULL;
 	zbx_db_result_t	result = NULL;
 	double		sec = 0;
-#if defined(HAVE_ORACLE)
+#if defined(HAVE_MYSQL)
+	int		ret;
+#elif defined(HAVE_ORACLE)
 	sword		err = OCI_SUCCESS;
 	ub4		prefetch_rows = 200, counter;
 
 	ZBX_UNUSED(counter);
 #elif defined(HAVE_POSTGRESQL)
-	char		*error = NULL;
+	int		ret;
 #elif defined(HAVE_SQLITE3)
 	int		ret = FAIL;
 	char		*error = NULL;
@@ -1697,11 +2045,23 @@ zbx_db_result_t	zbx_db_vselect(const char *fmt, va_list args)
 		goto clean;
 	}
 
+#if defined(HAVE_MYSQL) || defined(HAVE_POSTGRESQL)
+	/* select results might depend on the batched statements */
+	if (ZBX_DB_OK > (ret = db_batch_flush()))
+	{
+		if (ZBX_DB_DOWN == ret)
+			result = (zbx_db_result_t)ZBX_DB_DOWN;
+
+		goto clean;
+	}
+#endif
+
 	zabbix_log(LOG_LEVEL_DEBUG, "query [txnlev:%d] [%s]", txn_level, sql);
 
 #if defined(HAVE_MYSQL)
 	result = (zbx_db_result_t)zbx_malloc(NULL, sizeof(struct zbx_db_result));
 	result->result = NULL;
+	result->stmt = NULL;
 
 	if (NULL == conn)
 	{
@@ -1884,34 +2244,7 @@ error:
 		result = (ZBX_DB_DOWN == server_status ? (zbx_db_result_t)(intptr_t)server_status : NULL);
 	}
 #elif defined(HAVE_POSTGRESQL)
-	result = zbx_malloc(NULL, sizeof(struct zbx_db_result));
-	result->pg_result = PQexec(conn, sql);
-	result->values = NULL;
-	result->cursor = 0;
-	result->row_num = 0;
-
-	if (NULL == result->pg_result)
-		zbx_db_errlog(ERR_Z3005, 0, "result is NULL", sql);
-
-	if (PGRES_TUPLES_OK != PQresultStatus(result->pg_result))
-	{
-		zbx_postgresql_error(&error, result->pg_result);
-		zbx_db_errlog(ERR_Z3005, 0, error, sql);
-		zbx_free(error);
-
-		if (SUCCEED == is_recoverable_postgresql_error(conn, result->pg_result))
-		{
-			zbx_db_free_result(result);
-			result = (zbx_db_result_t)ZBX_DB_DOWN;
-		}
-		else
-		{
-			zbx_db_free_result(result);
-			result = NULL;
-		}
-	}
-	else	/* init rownum */
-		result->row_num = PQntuples(result->pg_result);
+	result = db_pg_result_create(PQexec(conn, sql), sql);
 #elif defined(HAVE_SQLITE3)
 	if (0 == txn_level)
 		zbx_mutex_lock(sqlite_access);
@@ -1977,6 +2310,570 @@ zbx_db_result_t	zbx_db_select_n_basic(const char *query, int n)
 #endif
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: appends prepared statement parameter to SQL text as literal       *
+ *                                                                            *
+ ******************************************************************************/
+static void	db_param_format(char **sql, size_t *sql_alloc, size_t *sql_offset, const zbx_db_param_t *param)
+{
+	char	*str_esc;
+
+	switch (param->type)
+	{
+		case ZBX_TYPE_INT:
+			zbx_snprintf_alloc(sql, sql_alloc, sql_offset, "%d", param->value.i32);
+			break;
+		case ZBX_TYPE_UINT:
+		case ZBX_TYPE_ID:
+			zbx_snprintf_alloc(sql, sql_alloc, sql_offset, ZBX_FS_UI64, param->value.ui64);
+			break;
+		case ZBX_TYPE_FLOAT:
+			zbx_snprintf_alloc(sql, sql_alloc, sql_offset, ZBX_FS_DBL64_SQL, param->value.dbl);
+			break;
+		case ZBX_TYPE_CHAR:
+			str_esc = zbx_db_dyn_escape_string_basic(param->value.str, ZBX_SIZE_T_MAX, ZBX_SIZE_T_MAX,
+					ESCAPE_SEQUENCE_ON);
+			zbx_snprintf_alloc(sql, sql_alloc, sql_offset, "'%s'", str_esc);
+			zbx_free(str_esc);
+			break;
+		default:
+			THIS_SHOULD_NEVER_HAPPEN;
+			exit(EXIT_FAILURE);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: replaces parameter markers in prepared statement SQL text         *
+ *                                                                            *
+ * Parameters: sql        - [IN] SQL text with '?' parameter markers          *
+ *             params     - [IN] parameter values to substitute markers with, *
+ *                               optional                                     *
+ *             params_num - [IN] number of parameters                         *
+ *                                                                            *
+ * Return value: The SQL text with markers replaced by parameter values or by *
+ *               PostgreSQL style $1, $2, ... markers if values are not given.*
+ *                                                                            *
+ ******************************************************************************/
+static char	*db_stmt_sql_replace(const char *sql, const zbx_db_param_t *params, int params_num)
+{
+	char		*text = NULL;
+	size_t		text_alloc = 0, text_offset = 0;
+	const char	*ptr;
+	int		i;
+
+	for (i = 0; i < params_num && NULL != (ptr = strchr(sql, '?')); i++)
+	{
+		zbx_strncpy_alloc(&text, &text_alloc, &text_offset, sql, (size_t)(ptr - sql));
+
+		if (NULL != params)
+			db_param_format(&text, &text_alloc, &text_offset, &params[i]);
+		else
+			zbx_snprintf_alloc(&text, &text_alloc, &text_offset, "$%d", i + 1);
+
+		sql = ptr + 1;
+	}
+
+	zbx_strcpy_alloc(&text, &text_alloc, &text_offset, sql);
+
+	return text;
+}
+
+#if defined(HAVE_MYSQL) || defined(HAVE_POSTGRESQL)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets prepared statement from cache of the current connection      *
+ *                                                                            *
+ * Return value: The cached statement or NULL if the statement is not cached. *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_db_stmt_t	*db_stmt_cache_get(const char *sql)
+{
+	zbx_db_stmt_t	stmt_local;
+
+	if (NULL == stmt_cache.slots)
+	{
+		zbx_hashset_create(&stmt_cache, 100, ZBX_DEFAULT_STRING_PTR_HASH_FUNC,
+				ZBX_DEFAULT_STR_COMPARE_FUNC);
+	}
+
+	stmt_local.sql = (char *)sql;
+
+	return (zbx_db_stmt_t *)zbx_hashset_search(&stmt_cache, &stmt_local);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes all prepared statements from cache                        *
+ *                                                                            *
+ * Comments: The prepared statements are released on database side together   *
+ *           with connection.                                                 *
+ *                                                                            *
+ ******************************************************************************/
+static void	db_stmt_cache_clear(void)
+{
+	zbx_hashset_iter_t	iter;
+	zbx_db_stmt_t		*stmt;
+
+	if (NULL == stmt_cache.slots)
+		return;
+
+	zbx_hashset_iter_reset(&stmt_cache, &iter);
+
+	while (NULL != (stmt = (zbx_db_stmt_t *)zbx_hashset_iter_next(&iter)))
+	{
+#if defined(HAVE_MYSQL)
+		/* statement being fetched is closed when its result is freed */
+		if (NULL != stmt->result)
+			stmt->result->stmt_cached = NULL;
+		else
+			mysql_stmt_close(stmt->handle);
+#endif
+		zbx_free(stmt->sql);
+	}
+
+	zbx_hashset_destroy(&stmt_cache);
+}
+#endif
+
+#if defined(HAVE_POSTGRESQL)
+/* PostgreSQL data type identifiers of prepared statement parameters */
+#define ZBX_PG_INT8OID		20
+#define ZBX_PG_INT4OID		23
+#define ZBX_PG_TEXTOID		25
+#define ZBX_PG_FLOAT8OID	701
+#define ZBX_PG_NUMERICOID	1700
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: executes prepared select statement, preparing and caching it on   *
+ *          the first execution                                               *
+ *                                                                            *
+ * Return value: data, NULL (on error) or (zbx_db_result_t)ZBX_DB_DOWN        *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_db_result_t	db_pg_select_prepared(const char *sql, const zbx_db_param_t *params, int params_num)
+{
+	zbx_db_stmt_t	*stmt;
+	PGresult	*pg_result = NULL;
+	const char	**values;
+	char		*buf;
+	int		i;
+
+	values = (const char **)zbx_malloc(NULL, sizeof(char *) * (size_t)params_num);
+	buf = (char *)zbx_malloc(NULL, (ZBX_MAX_DOUBLE_LEN + 1) * (size_t)params_num);
+
+	/* parameters are sent in text format and converted by server to the declared types */
+	for (i = 0; i < params_num; i++)
+	{
+		char	*value = buf + (ZBX_MAX_DOUBLE_LEN + 1) * i;
+
+		switch (params[i].type)
+		{
+			case ZBX_TYPE_INT:
+				zbx_snprintf(value, ZBX_MAX_DOUBLE_LEN + 1, "%d", params[i].value.i32);
+				break;
+			case ZBX_TYPE_UINT:
+			case ZBX_TYPE_ID:
+				zbx_snprintf(value, ZBX_MAX_DOUBLE_LEN + 1, ZBX_FS_UI64, params[i].value.ui64);
+				break;
+			case ZBX_TYPE_FLOAT:
+				zbx_snprintf(value, ZBX_MAX_DOUBLE_LEN + 1, ZBX_FS_DBL64, params[i].value.dbl);
+				break;
+			case ZBX_TYPE_CHAR:
+				value = params[i].value.str;
+				break;
+			default:
+				THIS_SHOULD_NEVER_HAPPEN;
+				exit(EXIT_FAILURE);
+		}
+
+		values[i] = value;
+	}
+
+	if (NULL == (stmt = db_stmt_cache_get(sql)))
+	{
+		char	*sql_pg;
+		Oid	*types;
+
+		sql_pg = db_stmt_sql_replace(sql, NULL, params_num);
+		types = (Oid *)zbx_malloc(NULL, sizeof(Oid) * (size_t)params_num);
+
+		for (i = 0; i < params_num; i++)
+		{
+			switch (params[i].type)
+			{
+				case ZBX_TYPE_INT:
+					types[i] = ZBX_PG_INT4OID;
+					break;
+				case ZBX_TYPE_UINT:
+					types[i] = ZBX_PG_NUMERICOID;
+					break;
+				case ZBX_TYPE_ID:
+					types[i] = ZBX_PG_INT8OID;
+					break;
+				case ZBX_TYPE_FLOAT:
+					types[i] = ZBX_PG_FLOAT8OID;
+					break;
+				default:
+					types[i] = ZBX_PG_TEXTOID;
+					break;
+			}
+		}
+
+		if (ZBX_DB_STMT_CACHE_MAX > stmt_cache.num_data)
+		{
+			zbx_db_stmt_t	stmt_local;
+
+			zbx_snprintf(stmt_local.name, sizeof(stmt_local.name), "zbx_stmt_" ZBX_FS_UI64, ++stmt_num);
+
+			pg_result = PQprepare(conn, stmt_local.name, sql_pg, params_num, types);
+
+			if (PGRES_COMMAND_OK == PQresultStatus(pg_result))
+			{
+				PQclear(pg_result);
+				pg_result = NULL;
+
+				stmt_local.sql = zbx_strdup(NULL, sql);
+				stmt = (zbx_db_stmt_t *)zbx_hashset_insert(&stmt_cache, &stmt_local,
+						sizeof(stmt_local));
+			}
+		}
+		else
+			pg_result = PQexecParams(conn, sql_pg, params_num, types, values, NULL, NULL, 0);
+
+		zbx_free(types);
+		zbx_free(sql_pg);
+	}
+
+	if (NULL != stmt)
+		pg_result = PQexecPrepared(conn, stmt->name, params_num, values, NULL, NULL, 0);
+
+	zbx_free(buf);
+	zbx_free(values);
+
+	return db_pg_result_create(pg_result, sql);
+}
+
+#undef ZBX_PG_INT8OID
+#undef ZBX_PG_INT4OID
+#undef ZBX_PG_TEXTOID
+#undef ZBX_PG_FLOAT8OID
+#undef ZBX_PG_NUMERICOID
+#elif defined(HAVE_MYSQL)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: executes prepared select statement, preparing and caching it on   *
+ *          the first execution                                               *
+ *                                                                            *
+ * Return value: data, NULL (on error) or (zbx_db_result_t)ZBX_DB_DOWN        *
+ *                                                                            *
+ * Comments: A new statement is prepared without caching if the cached one is *
+ *           still being fetched.                                             *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_db_result_t	db_mysql_select_prepared(const char *sql, const zbx_db_param_t *params, int params_num)
+{
+#define ZBX_MYSQL_STMT_FIELD_LEN	64
+	zbx_db_stmt_t	*stmt;
+	zbx_db_result_t	result;
+	MYSQL_BIND	*bind;
+	int		i, err_no;
+
+	if (NULL == conn)
+	{
+		zbx_db_errlog(ERR_Z3003, 0, NULL, NULL);
+		return NULL;
+	}
+
+	result = (zbx_db_result_t)zbx_malloc(NULL, sizeof(struct zbx_db_result));
+	memset(result, 0, sizeof(struct zbx_db_result));
+
+	if (NULL == (stmt = db_stmt_cache_get(sql)) || NULL != stmt->result)
+	{
+		if (NULL == (result->stmt = mysql_stmt_init(conn)))
+		{
+			err_no = (int)mysql_errno(conn);
+			mysql_err_cnt++;
+			zbx_db_errlog(ERR_Z3005, err_no, mysql_error(conn), sql);
+			zbx_db_free_result(result);
+
+			return SUCCEED == is_recoverable_mysql_error(err_no) ? (zbx_db_result_t)ZBX_DB_DOWN : NULL;
+		}
+
+		if (0 != mysql_stmt_prepare(result->stmt, sql, (unsigned long)strlen(sql)))
+			goto error;
+
+		if (NULL == stmt && ZBX_DB_STMT_CACHE_MAX > stmt_cache.num_data)
+		{
+			zbx_db_stmt_t	stmt_local;
+
+			stmt_local.sql = zbx_strdup(NULL, sql);
+			stmt_local.handle = result->stmt;
+			stmt = (zbx_db_stmt_t *)zbx_hashset_insert(&stmt_cache, &stmt_local, sizeof(stmt_local));
+		}
+		else
+			stmt = NULL;
+	}
+	else
+		result->stmt = stmt->handle;
+
+	if (NULL != (result->stmt_cached = stmt))
+		stmt->result = result;
+
+	bind = (MYSQL_BIND *)zbx_malloc(NULL, sizeof(MYSQL_BIND) * (size_t)params_num);
+	memset(bind, 0, sizeof(MYSQL_BIND) * (size_t)params_num);
+
+	for (i = 0; i < params_num; i++)
+	{
+		switch (params[i].type)
+		{
+			case ZBX_TYPE_INT:
+				bind[i].buffer_type = MYSQL_TYPE_LONG;
+				bind[i].buffer = (void *)&params[i].value.i32;
+				break;
+			case ZBX_TYPE_UINT:
+			case ZBX_TYPE_ID:
+				bind[i].buffer_type = MYSQL_TYPE_LONGLONG;
+				bind[i].buffer = (void *)&params[i].value.ui64;
+				bind[i].is_unsigned = 1;
+				break;
+			case ZBX_TYPE_FLOAT:
+				bind[i].buffer_type = MYSQL_TYPE_DOUBLE;
+				bind[i].buffer = (void *)&params[i].value.dbl;
+				break;
+			case ZBX_TYPE_CHAR:
+				bind[i].buffer_type = MYSQL_TYPE_STRING;
+				bind[i].buffer = params[i].value.str;
+				bind[i].buffer_length = (unsigned long)strlen(params[i].value.str);
+				break;
+			default:
+				THIS_SHOULD_NEVER_HAPPEN;
+				exit(EXIT_FAILURE);
+		}
+	}
+
+	if (0 != mysql_stmt_bind_param(result->stmt, bind) || 0 != mysql_stmt_execute(result->stmt))
+	{
+		zbx_free(bind);
+		goto error;
+	}
+
+	zbx_free(bind);
+
+	if (0 != mysql_stmt_store_result(result->stmt))
+		goto error;
+
+	/* all columns are fetched as strings, like with text protocol */
+	result->fld_num = (int)mysql_stmt_field_count(result->stmt);
+	result->bind = (MYSQL_BIND *)zbx_malloc(NULL, sizeof(MYSQL_BIND) * (size_t)result->fld_num);
+	result->lengths = (unsigned long *)zbx_malloc(NULL, sizeof(unsigned long) * (size_t)result->fld_num);
+	result->values = (zbx_db_row_t)zbx_malloc(NULL, sizeof(char *) * (size_t)result->fld_num);
+	memset(result->bind, 0, sizeof(MYSQL_BIND) * (size_t)result->fld_num);
+
+	for (i = 0; i < result->fld_num; i++)
+	{
+		bind = &result->bind[i];
+		bind->buffer_type = MYSQL_TYPE_STRING;
+		bind->buffer_length = ZBX_MYSQL_STMT_FIELD_LEN;
+		bind->buffer = zbx_malloc(NULL, ZBX_MYSQL_STMT_FIELD_LEN + 1);
+		bind->length = &result->lengths[i];
+		bind->is_null = &bind->is_null_value;
+		bind->error = &bind->error_value;
+	}
+
+	if (0 != mysql_stmt_bind_result(result->stmt, result->bind))
+		goto error;
+
+	return result;
+error:
+	err_no = (int)mysql_stmt_errno(result->stmt);
+	mysql_err_cnt++;
+
+	if (FAIL == is_inhibited_mysql_error(err_no))
+		zbx_db_errlog(ERR_Z3005, err_no, mysql_stmt_error(result->stmt), sql);
+
+	zbx_db_free_result(result);
+
+	return SUCCEED == is_recoverable_mysql_error(err_no) ? (zbx_db_result_t)ZBX_DB_DOWN : NULL;
+#undef ZBX_MYSQL_STMT_FIELD_LEN
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: fetches next row of prepared statement result                     *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_db_row_t	db_mysql_stmt_fetch(zbx_db_result_t result)
+{
+	int	i, rc, rebind = 0;
+
+	if (0 != (rc = mysql_stmt_fetch(result->stmt)) && MYSQL_DATA_TRUNCATED != rc)
+	{
+		if (MYSQL_NO_DATA != rc)
+		{
+			zbx_db_errlog(ERR_Z3006, (int)mysql_stmt_errno(result->stmt), mysql_stmt_error(result->stmt),
+					NULL);
+		}
+
+		return NULL;
+	}
+
+	for (i = 0; i < result->fld_num; i++)
+	{
+		MYSQL_BIND	*bind = &result->bind[i];
+
+		if (0 != *bind->is_null)
+		{
+			result->values[i] = NULL;
+			continue;
+		}
+
+		/* fetch truncated column again into enlarged buffer */
+		if (result->lengths[i] > bind->buffer_length)
+		{
+			bind->buffer_length = result->lengths[i];
+			bind->buffer = zbx_realloc(bind->buffer, bind->buffer_length + 1);
+
+			if (0 != mysql_stmt_fetch_column(result->stmt, bind, (unsigned int)i, 0))
+			{
+				zbx_db_errlog(ERR_Z3006, (int)mysql_stmt_errno(result->stmt),
+						mysql_stmt_error(result->stmt), NULL);
+				return NULL;
+			}
+
+			rebind = 1;
+		}
+
+		result->values[i] = (char *)bind->buffer;
+		result->values[i][result->lengths[i]] = '\0';
+	}
+
+	/* use the enlarged buffers for the next rows */
+	if (0 != rebind && 0 != mysql_stmt_bind_result(result->stmt, result->bind))
+	{
+		zbx_db_errlog(ERR_Z3006, (int)mysql_stmt_errno(result->stmt), mysql_stmt_error(result->stmt), NULL);
+		return NULL;
+	}
+
+	return result->values;
+}
+#endif
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: executes select statement with parameters                         *
+ *                                                                            *
+ * Parameters: sql        - [IN] SQL text with '?' parameter markers          *
+ *             params     - [IN] parameter values                             *
+ *             params_num - [IN] number of parameters                         *
+ *             n          - [IN] maximum number of rows to select, 0 - all    *
+ *                                                                            *
+ * Return value: data, NULL (on error) or (zbx_db_result_t)ZBX_DB_DOWN        *
+ *                                                                            *
+ * Comments: With MySQL and PostgreSQL the statement is prepared on the first *
+ *           execution and cached for the lifetime of connection, so the SQL  *
+ *           text must not contain variable data. Other databases, or when    *
+ *           prepared statements are disabled by DBPreparedStatements,        *
+ *           execute the statement text with parameter values substituted.    *
+ *                                                                            *
+ ******************************************************************************/
+zbx_db_result_t	zbx_db_select_prepared_basic(const char *sql, const zbx_db_param_t *params, int params_num, int n)
+{
+	zbx_db_result_t	result = NULL;
+	zbx_db_param_t	*params_limit = NULL;
+	char		*sql_limit = NULL, *text = NULL;
+	double		sec = 0;
+
+	if (0 != config_log_slow_queries)
+		sec = zbx_time();
+
+	/* the row limit is passed as parameter, so the statement does not depend on it */
+	if (0 != n)
+	{
+#if defined(HAVE_ORACLE)
+		sql_limit = zbx_dsprintf(NULL, "select * from (%s) where rownum<=?", sql);
+#else
+		sql_limit = zbx_dsprintf(NULL, "%s limit ?", sql);
+#endif
+		params_limit = (zbx_db_param_t *)zbx_malloc(NULL, sizeof(zbx_db_param_t) * (size_t)(params_num + 1));
+		memcpy(params_limit, params, sizeof(zbx_db_param_t) * (size_t)params_num);
+		params_limit[params_num].type = ZBX_TYPE_INT;
+		params_limit[params_num].value.i32 = n;
+
+		sql = sql_limit;
+		params = params_limit;
+		params_num++;
+	}
+
+	if (ZBX_DB_OK != txn_error)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "ignoring query [txnlev:%d] [%s] within failed transaction", txn_level, sql);
+		goto clean;
+	}
+
+#if defined(HAVE_MYSQL) || defined(HAVE_POSTGRESQL)
+	/* select results might depend on the batched statements */
+	{
+		int	ret;
+
+		if (ZBX_DB_OK > (ret = db_batch_flush()))
+		{
+			if (ZBX_DB_DOWN == ret)
+				result = (zbx_db_result_t)ZBX_DB_DOWN;
+
+			goto clean;
+		}
+	}
+#endif
+
+	if (SUCCEED == ZBX_CHECK_LOG_LEVEL(LOG_LEVEL_DEBUG))
+		text = db_stmt_sql_replace(sql, params, params_num);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "query [txnlev:%d] [%s]", txn_level, ZBX_NULL2EMPTY_STR(text));
+
+#if defined(HAVE_POSTGRESQL)
+	if (0 != stmt_enabled)
+		result = db_pg_select_prepared(sql, params, params_num);
+	else
+#elif defined(HAVE_MYSQL)
+	if (0 != stmt_enabled)
+		result = db_mysql_select_prepared(sql, params, params_num);
+	else
+#endif
+	{
+		if (NULL == text)
+			text = db_stmt_sql_replace(sql, params, params_num);
+
+		result = zbx_db_select_basic("%s", text);
+	}
+
+	if (0 != config_log_slow_queries)
+	{
+		sec = zbx_time() - sec;
+		if (sec > (double)config_log_slow_queries / 1000.0)
+		{
+			if (NULL == text)
+				text = db_stmt_sql_replace(sql, params, params_num);
+
+			zabbix_log(LOG_LEVEL_WARNING, "slow query: " ZBX_FS_DBL " sec, \"%s\"", sec, text);
+		}
+	}
+
+	if (NULL == result && 0 < txn_level)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "query [%s] failed, setting transaction as failed", sql);
+		txn_error = ZBX_DB_FAIL;
+	}
+clean:
+	zbx_free(text);
+	zbx_free(params_limit);
+	zbx_free(sql_limit);
+
+	return result;
+}
+
 #if defined(HAVE_ORACLE)
 static void	db_set_fetch_error(int dberr)
 {
@@ -1993,6 +2890,9 @@ int	zbx_db_get_row_num(zbx_db_result_t result)
 #if defined(HAVE_POSTGRESQL)
 	return result->row_num;
 #elif defined(HAVE_MYSQL)
+	if (NULL != result->stmt)
+		return (int)mysql_stmt_num_rows(result->stmt);
+
 	return (int)mysql_num_rows(result->result);
 #else
 	ZBX_UNUSED(result);
@@ -2013,6 +2913,9 @@ zbx_db_row_t	zbx_db_fetch_basic(zbx_db_result_t result)
 		return NULL;
 
 #if defined(HAVE_MYSQL)
+	if (NULL != result->stmt)
+		return db_mysql_stmt_fetch(result);
+
 	if (NULL == result->result)
 		return NULL;
 
@@ -2214,6 +3117,25 @@ void	zbx_db_free_result(zbx_db_result_t result)
 	if (NULL == result)
 		return;
 
+	if (NULL != result->stmt)
+	{
+		int	i;
+
+		mysql_stmt_free_result(result->stmt);
+
+		if (NULL != result->stmt_cached)
+			result->stmt_cached->result = NULL;
+		else
+			mysql_stmt_close(result->stmt);
+
+		for (i = 0; i < result->fld_num; i++)
+			zbx_free(result->bind[i].buffer);
+
+		zbx_free(result->bind);
+		zbx_free(result->lengths);
+		zbx_free(result->values);
+	}
+
 	mysql_free_result(result->result);
 	zbx_free(result);
 #elif defined(HAVE_ORACLE)
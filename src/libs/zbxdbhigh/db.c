@@ -158,6 +158,7 @@ zbx_config_dbhigh_t	*zbx_config_dbhigh_new(void)
 
 	config_dbhigh = (zbx_config_dbhigh_t *)zbx_malloc(NULL, sizeof(zbx_config_dbhigh_t));
 	memset(config_dbhigh, 0, sizeof(zbx_config_dbhigh_t));
+	config_dbhigh->config_db_prepared_statements = 1;
 
 	return config_dbhigh;
 }
@@ -591,6 +592,53 @@ zbx_db_result_t	zbx_db_select_n(const char *query, int n)
 	return rc;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: execute a select statement with parameters and get the first N    *
+ *          entries                                                           *
+ *                                                                            *
+ * Parameters: sql        - [IN] SQL text with '?' parameter markers          *
+ *             params     - [IN] parameter values                             *
+ *             params_num - [IN] number of parameters                         *
+ *             n          - [IN] maximum number of rows to select, 0 - all    *
+ *                                                                            *
+ * Comments: retry until DB is up                                             *
+ *                                                                            *
+ ******************************************************************************/
+zbx_db_result_t	zbx_db_select_prepared_n(const char *sql, const zbx_db_param_t *params, int params_num, int n)
+{
+	zbx_db_result_t	rc;
+
+	rc = zbx_db_select_prepared_basic(sql, params, params_num, n);
+
+	while ((zbx_db_result_t)ZBX_DB_DOWN == rc)
+	{
+		zbx_db_close();
+		zbx_db_connect(ZBX_DB_CONNECT_NORMAL);
+
+		if ((zbx_db_result_t)ZBX_DB_DOWN == (rc = zbx_db_select_prepared_basic(sql, params, params_num, n)))
+		{
+			zabbix_log(LOG_LEVEL_ERR, "database is down: retrying in %d seconds", ZBX_DB_WAIT_DOWN);
+			connection_failure = 1;
+			sleep(ZBX_DB_WAIT_DOWN);
+		}
+	}
+
+	return rc;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: execute a select statement with parameters                        *
+ *                                                                            *
+ * Comments: retry until DB is up                                             *
+ *                                                                            *
+ ******************************************************************************/
+zbx_db_result_t	zbx_db_select_prepared(const char *sql, const zbx_db_param_t *params, int params_num)
+{
+	return zbx_db_select_prepared_n(sql, params, params_num, 0);
+}
+
 #ifdef HAVE_MYSQL
 static size_t	get_string_field_size(const zbx_db_field_t *field)
 {
@@ -2822,7 +2870,9 @@ void	zbx_db_insert_add_values_dyn(zbx_db_insert_t *self, zbx_db_value_t **values
 			case ZBX_TYPE_SHORTTEXT:
 			case ZBX_TYPE_CUID:
 			case ZBX_TYPE_BLOB:
-#ifdef HAVE_ORACLE
+#if defined(HAVE_ORACLE) || defined(HAVE_POSTGRESQL)
+				/* values are bound (Oracle) or copied (PostgreSQL) unescaped, */
+				/* they are escaped when building SQL statement if needed      */
 				row[i].str = DBdyn_escape_field_len(field, value->str, ESCAPE_SEQUENCE_OFF);
 #else
 				row[i].str = DBdyn_escape_field_len(field, value->str, ESCAPE_SEQUENCE_ON);
@@ -2944,6 +2994,176 @@ static void	decode_and_escape_binary_value_for_sql(char **sql_insert_data)
 }
 #endif
 
+#ifdef HAVE_POSTGRESQL
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if bulk insert can be executed with COPY statement         *
+ *                                                                            *
+ * Parameters: self - [IN] the bulk insert data                               *
+ *                                                                            *
+ * Return value: SUCCEED - COPY statement can be used                         *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: COPY needs two round trips to the server, so it is used only     *
+ *           for larger batches. Binary and upper case fields require         *
+ *           conversion by SQL statement.                                     *
+ *                                                                            *
+ ******************************************************************************/
+static int	db_insert_copy_supported(const zbx_db_insert_t *self)
+{
+#define ZBX_DB_COPY_ROWS_MIN	16
+	if (ZBX_DB_COPY_ROWS_MIN > self->rows.values_num)
+		return FAIL;
+
+	for (int i = 0; i < self->fields.values_num; i++)
+	{
+		const zbx_db_field_t	*field = self->fields.values[i];
+
+		if (ZBX_TYPE_BLOB == field->type || 0 != (field->flags & ZBX_UPPER))
+			return FAIL;
+	}
+
+	return SUCCEED;
+#undef ZBX_DB_COPY_ROWS_MIN
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: appends string escaped for COPY text format                       *
+ *                                                                            *
+ ******************************************************************************/
+static void	db_copy_escape_alloc(char **data, size_t *data_alloc, size_t *data_offset, const char *str)
+{
+	size_t	len;
+
+	while ('\0' != *str)
+	{
+		if (0 != (len = strcspn(str, "\\\t\n\r")))
+		{
+			zbx_strncpy_alloc(data, data_alloc, data_offset, str, len);
+
+			if ('\0' == *(str += len))
+				break;
+		}
+
+		zbx_chrcpy_alloc(data, data_alloc, data_offset, '\\');
+
+		switch (*str)
+		{
+			case '\t':
+				zbx_chrcpy_alloc(data, data_alloc, data_offset, 't');
+				break;
+			case '\n':
+				zbx_chrcpy_alloc(data, data_alloc, data_offset, 'n');
+				break;
+			case '\r':
+				zbx_chrcpy_alloc(data, data_alloc, data_offset, 'r');
+				break;
+			default:
+				zbx_chrcpy_alloc(data, data_alloc, data_offset, *str);
+		}
+
+		str++;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: executes the prepared database bulk insert operation with COPY    *
+ *          statement                                                         *
+ *                                                                            *
+ * Parameters: self - [IN] the bulk insert data                               *
+ *                                                                            *
+ * Return value: SUCCEED if the operation completed successfully or           *
+ *               FAIL otherwise.                                              *
+ *                                                                            *
+ ******************************************************************************/
+static int	db_insert_copy(const zbx_db_insert_t *self)
+{
+	char	*sql = NULL, *data;
+	size_t	sql_alloc = 0, sql_offset = 0, data_alloc = 16 * ZBX_KIBIBYTE, data_offset = 0;
+	int	rc;
+
+	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "copy %s (", self->table->table);
+
+	for (int i = 0; i < self->fields.values_num; i++)
+	{
+		if (0 != i)
+			zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, ',');
+
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, self->fields.values[i]->name);
+	}
+
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, ") from stdin");
+
+	data = (char *)zbx_malloc(NULL, data_alloc);
+
+	for (int i = 0; i < self->rows.values_num; i++)
+	{
+		const zbx_db_value_t	*values = self->rows.values[i];
+
+		for (int j = 0; j < self->fields.values_num; j++)
+		{
+			const zbx_db_value_t	*value = &values[j];
+
+			if (0 != j)
+				zbx_chrcpy_alloc(&data, &data_alloc, &data_offset, '\t');
+
+			switch (self->fields.values[j]->type)
+			{
+				case ZBX_TYPE_CHAR:
+				case ZBX_TYPE_TEXT:
+				case ZBX_TYPE_SHORTTEXT:
+				case ZBX_TYPE_LONGTEXT:
+				case ZBX_TYPE_CUID:
+					db_copy_escape_alloc(&data, &data_alloc, &data_offset, value->str);
+					break;
+				case ZBX_TYPE_INT:
+					zbx_snprintf_alloc(&data, &data_alloc, &data_offset, "%d", value->i32);
+					break;
+				case ZBX_TYPE_FLOAT:
+					zbx_snprintf_alloc(&data, &data_alloc, &data_offset, ZBX_FS_DBL64, value->dbl);
+					break;
+				case ZBX_TYPE_UINT:
+					zbx_snprintf_alloc(&data, &data_alloc, &data_offset, ZBX_FS_UI64, value->ui64);
+					break;
+				case ZBX_TYPE_ID:
+					if (0 == value->ui64)
+						zbx_strcpy_alloc(&data, &data_alloc, &data_offset, "\\N");
+					else
+						zbx_snprintf_alloc(&data, &data_alloc, &data_offset, ZBX_FS_UI64, value->ui64);
+					break;
+				default:
+					THIS_SHOULD_NEVER_HAPPEN;
+					exit(EXIT_FAILURE);
+			}
+		}
+
+		zbx_chrcpy_alloc(&data, &data_alloc, &data_offset, '\n');
+	}
+
+	rc = zbx_db_copy_from(sql, data, data_offset);
+
+	while (ZBX_DB_DOWN == rc)
+	{
+		zbx_db_close();
+		zbx_db_connect(ZBX_DB_CONNECT_NORMAL);
+
+		if (ZBX_DB_DOWN == (rc = zbx_db_copy_from(sql, data, data_offset)))
+		{
+			zabbix_log(LOG_LEVEL_ERR, "database is down: retrying in %d seconds", ZBX_DB_WAIT_DOWN);
+			connection_failure = 1;
+			sleep(ZBX_DB_WAIT_DOWN);
+		}
+	}
+
+	zbx_free(data);
+	zbx_free(sql);
+
+	return ZBX_DB_OK > rc ? FAIL : SUCCEED;
+}
+#endif
+
 /******************************************************************************
  *                                                                            *
  * Purpose: executes the prepared database bulk insert operation              *
@@ -2968,6 +3188,8 @@ int	zbx_db_insert_execute(zbx_db_insert_t *self)
 #	ifdef HAVE_MYSQL
 	char		*sql_values = NULL;
 	size_t		sql_values_alloc = 0, sql_values_offset = 0;
+#	elif defined(HAVE_POSTGRESQL)
+	char		*str_esc;
 #	endif
 #else
 	zbx_db_bind_context_t	*contexts;
@@ -2996,6 +3218,11 @@ int	zbx_db_insert_execute(zbx_db_insert_t *self)
 		self->autoincrement = -1;
 	}
 
+#ifdef HAVE_POSTGRESQL
+	if (SUCCEED == db_insert_copy_supported(self))
+		return db_insert_copy(self);
+#endif
+
 #ifndef HAVE_ORACLE
 	sql = (char *)zbx_malloc(NULL, sql_alloc);
 #endif
@@ -3151,8 +3378,13 @@ retry_oracle:
 					}
 					else
 						zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, '\'');
-
+#	ifdef HAVE_POSTGRESQL
+					str_esc = zbx_db_dyn_escape_string(value->str);
+					zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, str_esc);
+					zbx_free(str_esc);
+#	else
 					zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, value->str);
+#	endif
 
 					if (0 != (field->flags & ZBX_UPPER))
 					{
@@ -22,6 +22,7 @@
 #include "zbxprof.h"
 #include "zbxtimekeeper.h"
 #include "zbxcacheconfig.h"
+#include "zbxcachevalue.h"
 #include "zbxdbhigh.h"
 #include "zbxstr.h"
 #include "zbxthreads.h"
@@ -91,6 +92,40 @@ static void	db_trigger_queue_cleanup(void)
 	zbx_db_trigger_queue_unlock();
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: loads history used by trigger and calculated item functions into  *
+ *          value cache                                                       *
+ *                                                                            *
+ * Parameters: process_num   - [IN] the history syncer process number         *
+ *             process_forks - [IN] the number of history syncer processes    *
+ *                                                                            *
+ * Comments: Each history syncer prefetches its own share of items.           *
+ *                                                                            *
+ ******************************************************************************/
+static void	dbsyncer_prefetch_value_cache(int process_num, int process_forks)
+{
+	zbx_vector_vc_item_range_t	ranges;
+	double				sec;
+
+	sec = zbx_time();
+
+	zbx_vector_vc_item_range_create(&ranges);
+	zbx_dc_get_item_history_ranges(&ranges, process_num, process_forks);
+
+	if (0 != ranges.values_num)
+	{
+		int	items_num = ranges.values_num, values_num;
+
+		values_num = zbx_vc_prefetch(&ranges);
+
+		zabbix_log(LOG_LEVEL_INFORMATION, "prefetched %d values of %d items into value cache in " ZBX_FS_DBL
+				" sec", values_num, items_num, zbx_time() - sec);
+	}
+
+	zbx_vector_vc_item_range_destroy(&ranges);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: periodically synchronises data in memory cache with database      *
@@ -139,6 +174,16 @@ ZBX_THREAD_ENTRY(zbx_dbsyncer_thread, args)
 
 	zbx_unblock_signals(&orig_mask);
 
+	if (0 != (info->program_type & ZBX_PROGRAM_TYPE_SERVER))
+	{
+		zbx_setproctitle("%s #%d [prefetching value cache]", process_name, process_num);
+
+		zbx_block_signals(&orig_mask);
+		dbsyncer_prefetch_value_cache(process_num,
+				dbsyncer_args->get_process_forks_cb_arg(ZBX_PROCESS_TYPE_HISTSYNCER));
+		zbx_unblock_signals(&orig_mask);
+	}
+
 	if (SUCCEED == zbx_is_export_enabled(ZBX_FLAG_EXPTYPE_HISTORY))
 		history_export = zbx_history_export_init(get_history_export, "history-syncer", process_num);
 
@@ -85,6 +85,26 @@ typedef struct
 }
 zbx_history_table_t;
 
+/* locations of the tag values in history data row */
+typedef struct
+{
+	const char	*itemid;
+	const char	*host;
+	const char	*key;
+	const char	*clock;
+	const char	*ns;
+	const char	*state;
+	const char	*lastlogsize;
+	const char	*mtime;
+	const char	*value;
+	const char	*timestamp;
+	const char	*source;
+	const char	*severity;
+	const char	*logeventid;
+	const char	*id;
+}
+zbx_history_row_t;
+
 typedef int	(*zbx_client_item_validator_t)(zbx_history_recv_item_t *item, zbx_socket_t *sock, void *args,
 		char **error);
 
@@ -868,11 +888,87 @@ static void	log_client_timediff(int level, struct zbx_json_parse *jp, const zbx_
 	}
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: locates tags of history data json row in a single pass            *
+ *                                                                            *
+ * Parameters: jp_row - [IN] JSON with history data row                       *
+ *             row    - [OUT] the tag values                                  *
+ *                                                                            *
+ * Comments: Only the first occurrence of each tag is used, as it would be    *
+ *           with lookups by name.                                            *
+ *                                                                            *
+ ******************************************************************************/
+static void	parse_history_data_row(const struct zbx_json_parse *jp_row, zbx_history_row_t *row)
+{
+	char		name[MAX_STRING_LEN];
+	const char	*p = NULL, **ptag;
+
+	memset(row, 0, sizeof(zbx_history_row_t));
+
+	while (NULL != (p = zbx_json_pair_next(jp_row, p, name, sizeof(name))))
+	{
+		if (0 == strcmp(name, ZBX_PROTO_TAG_ITEMID))
+			ptag = &row->itemid;
+		else if (0 == strcmp(name, ZBX_PROTO_TAG_CLOCK))
+			ptag = &row->clock;
+		else if (0 == strcmp(name, ZBX_PROTO_TAG_NS))
+			ptag = &row->ns;
+		else if (0 == strcmp(name, ZBX_PROTO_TAG_VALUE))
+			ptag = &row->value;
+		else if (0 == strcmp(name, ZBX_PROTO_TAG_ID))
+			ptag = &row->id;
+		else if (0 == strcmp(name, ZBX_PROTO_TAG_HOST))
+			ptag = &row->host;
+		else if (0 == strcmp(name, ZBX_PROTO_TAG_KEY))
+			ptag = &row->key;
+		else if (0 == strcmp(name, ZBX_PROTO_TAG_STATE))
+			ptag = &row->state;
+		else if (0 == strcmp(name, ZBX_PROTO_TAG_LASTLOGSIZE))
+			ptag = &row->lastlogsize;
+		else if (0 == strcmp(name, ZBX_PROTO_TAG_MTIME))
+			ptag = &row->mtime;
+		else if (0 == strcmp(name, ZBX_PROTO_TAG_LOGTIMESTAMP))
+			ptag = &row->timestamp;
+		else if (0 == strcmp(name, ZBX_PROTO_TAG_LOGSOURCE))
+			ptag = &row->source;
+		else if (0 == strcmp(name, ZBX_PROTO_TAG_LOGSEVERITY))
+			ptag = &row->severity;
+		else if (0 == strcmp(name, ZBX_PROTO_TAG_LOGEVENTID))
+			ptag = &row->logeventid;
+		else
+			continue;
+
+		if (NULL == *ptag)
+			*ptag = p;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: decodes history data row tag value                                *
+ *                                                                            *
+ * Parameters: tag          - [IN] the tag value location (can be NULL)       *
+ *             string       - [IN/OUT] the output buffer                      *
+ *             string_alloc - [IN/OUT] the output buffer size                 *
+ *                                                                            *
+ * Return value:  SUCCEED - the tag value was decoded successfully            *
+ *                FAIL    - the tag was not found or its value is invalid     *
+ *                                                                            *
+ ******************************************************************************/
+static int	history_data_row_decode(const char *tag, char **string, size_t *string_alloc)
+{
+	if (NULL == tag || NULL == zbx_json_decodevalue_dyn(tag, string, string_alloc, NULL))
+		return FAIL;
+
+	return SUCCEED;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: parses agent value from history data json row                     *
  *                                                                            *
- * Parameters: jp_row       - [IN] JSON with history data row                 *
+ * Parameters: row          - [IN] the history data row tags                  *
  *             unique_shift - [IN/OUT] auto increment nanoseconds to ensure   *
  *                                     unique value of timestamps             *
  *             av           - [OUT] the agent value                           *
@@ -881,21 +977,21 @@ static void	log_client_timediff(int level, struct zbx_json_parse *jp, const zbx_
  *                FAIL    - otherwise                                         *
  *                                                                            *
  ******************************************************************************/
-static int	parse_history_data_row_value(const struct zbx_json_parse *jp_row, zbx_timespec_t *unique_shift,
+static int	parse_history_data_row_value(const zbx_history_row_t *row, zbx_timespec_t *unique_shift,
 		zbx_agent_value_t *av)
 {
 	char	*tmp = NULL;
-	size_t	tmp_alloc = 0;
+	size_t	tmp_alloc = 0, str_alloc;
 	int	ret = FAIL;
 
 	memset(av, 0, sizeof(zbx_agent_value_t));
 
-	if (SUCCEED == zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_CLOCK, &tmp, &tmp_alloc, NULL))
+	if (SUCCEED == history_data_row_decode(row->clock, &tmp, &tmp_alloc))
 	{
 		if (FAIL == zbx_is_uint31(tmp, &av->ts.sec))
 			goto out;
 
-		if (SUCCEED == zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_NS, &tmp, &tmp_alloc, NULL))
+		if (SUCCEED == history_data_row_decode(row->ns, &tmp, &tmp_alloc))
 		{
 			if (FAIL == zbx_is_uint_n_range(tmp, tmp_alloc, &av->ts.ns, sizeof(av->ts.ns),
 				0LL, 999999999LL))
@@ -920,49 +1016,50 @@ static int	parse_history_data_row_value(const struct zbx_json_parse *jp_row, zbx
 	else
 		zbx_timespec(&av->ts);
 
-	if (SUCCEED == zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_STATE, &tmp, &tmp_alloc, NULL))
+	if (SUCCEED == history_data_row_decode(row->state, &tmp, &tmp_alloc))
 		av->state = (unsigned char)atoi(tmp);
 
 	/* Unsupported item meta information must be ignored for backwards compatibility. */
 	/* New agents will not send meta information for items in unsupported state.      */
 	if (ITEM_STATE_NOTSUPPORTED != av->state)
 	{
-		if (SUCCEED == zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_LASTLOGSIZE, &tmp, &tmp_alloc, NULL))
+		if (SUCCEED == history_data_row_decode(row->lastlogsize, &tmp, &tmp_alloc))
 		{
 			av->meta = 1;	/* contains meta information */
 
 			zbx_is_uint64(tmp, &av->lastlogsize);
 
-			if (SUCCEED == zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_MTIME, &tmp, &tmp_alloc, NULL))
+			if (SUCCEED == history_data_row_decode(row->mtime, &tmp, &tmp_alloc))
 				av->mtime = atoi(tmp);
 		}
 	}
 
-	if (SUCCEED == zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_VALUE, &tmp, &tmp_alloc, NULL))
-		av->value = zbx_strdup(av->value, tmp);
+	/* decode strings directly into the agent value to avoid copying them */
 
-	if (SUCCEED == zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_LOGTIMESTAMP, &tmp, &tmp_alloc, NULL))
+	str_alloc = 0;
+	if (SUCCEED != history_data_row_decode(row->value, &av->value, &str_alloc))
+		zbx_free(av->value);
+
+	if (SUCCEED == history_data_row_decode(row->timestamp, &tmp, &tmp_alloc))
 		av->timestamp = atoi(tmp);
 
-	if (SUCCEED == zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_LOGSOURCE, &tmp, &tmp_alloc, NULL))
-		av->source = zbx_strdup(av->source, tmp);
+	str_alloc = 0;
+	if (SUCCEED != history_data_row_decode(row->source, &av->source, &str_alloc))
+		zbx_free(av->source);
 
-	if (SUCCEED == zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_LOGSEVERITY, &tmp, &tmp_alloc, NULL))
+	if (SUCCEED == history_data_row_decode(row->severity, &tmp, &tmp_alloc))
 		av->severity = atoi(tmp);
 
-	if (SUCCEED == zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_LOGEVENTID, &tmp, &tmp_alloc, NULL))
+	if (SUCCEED == history_data_row_decode(row->logeventid, &tmp, &tmp_alloc))
 		av->logeventid = atoi(tmp);
 
-	if (SUCCEED != zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_ID, &tmp, &tmp_alloc, NULL) ||
-			SUCCEED != zbx_is_uint64(tmp, &av->id))
-	{
+	if (SUCCEED != history_data_row_decode(row->id, &tmp, &tmp_alloc) || SUCCEED != zbx_is_uint64(tmp, &av->id))
 		av->id = 0;
-	}
-
-	zbx_free(tmp);
 
 	ret = SUCCEED;
 out:
+	zbx_free(tmp);
+
 	return ret;
 }
 
@@ -970,18 +1067,18 @@ out:
  *                                                                            *
  * Purpose: parses item identifier from history data json row                 *
  *                                                                            *
- * Parameters: jp_row - [IN] JSON with history data row                       *
+ * Parameters: row    - [IN] the history data row tags                        *
  *             itemid - [OUT] the item identifier                             *
  *                                                                            *
  * Return value:  SUCCEED - the item identifier was parsed successfully       *
  *                FAIL    - otherwise                                         *
  *                                                                            *
  ******************************************************************************/
-static int	parse_history_data_row_itemid(const struct zbx_json_parse *jp_row, zbx_uint64_t *itemid)
+static int	parse_history_data_row_itemid(const zbx_history_row_t *row, zbx_uint64_t *itemid)
 {
 	char	buffer[MAX_ID_LEN + 1];
 
-	if (SUCCEED != zbx_json_value_by_name(jp_row, ZBX_PROTO_TAG_ITEMID, buffer, sizeof(buffer), NULL))
+	if (NULL == row->itemid || NULL == zbx_json_decodevalue(row->itemid, buffer, sizeof(buffer), NULL))
 		return FAIL;
 
 	if (SUCCEED != zbx_is_uint64(buffer, itemid))
@@ -993,27 +1090,27 @@ static int	parse_history_data_row_itemid(const struct zbx_json_parse *jp_row, zb
  *                                                                            *
  * Purpose: parses host,key pair from history data json row                   *
  *                                                                            *
- * Parameters: jp_row - [IN] JSON with history data row                       *
- *             hk     - [OUT] the host,key pair                               *
+ * Parameters: row - [IN] the history data row tags                           *
+ *             hk  - [OUT] the host,key pair                                  *
  *                                                                            *
  * Return value:  SUCCEED - the host,key pair was parsed successfully         *
  *                FAIL    - otherwise                                         *
  *                                                                            *
  ******************************************************************************/
-static int	parse_history_data_row_hostkey(const struct zbx_json_parse *jp_row, zbx_host_key_t *hk)
+static int	parse_history_data_row_hostkey(const zbx_history_row_t *row, zbx_host_key_t *hk)
 {
 	size_t str_alloc;
 
 	str_alloc = 0;
 	zbx_free(hk->host);
 
-	if (SUCCEED != zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_HOST, &hk->host, &str_alloc, NULL))
+	if (SUCCEED != history_data_row_decode(row->host, &hk->host, &str_alloc))
 		return FAIL;
 
 	str_alloc = 0;
 	zbx_free(hk->key);
 
-	if (SUCCEED != zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_KEY, &hk->key, &str_alloc, NULL))
+	if (SUCCEED != history_data_row_decode(row->key, &hk->key, &str_alloc))
 	{
 		zbx_free(hk->host);
 		return FAIL;
@@ -1046,6 +1143,7 @@ static int	parse_history_data(struct zbx_json_parse *jp_data, const char **pnext
 		zbx_host_key_t *hostkeys, int *values_num, int *parsed_num, zbx_timespec_t *unique_shift)
 {
 	struct zbx_json_parse	jp_row;
+	zbx_history_row_t	row;
 	int			ret = FAIL;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
@@ -1073,10 +1171,12 @@ static int	parse_history_data(struct zbx_json_parse *jp_data, const char **pnext
 
 		(*parsed_num)++;
 
-		if (SUCCEED != parse_history_data_row_hostkey(&jp_row, &hostkeys[*values_num]))
+		parse_history_data_row(&jp_row, &row);
+
+		if (SUCCEED != parse_history_data_row_hostkey(&row, &hostkeys[*values_num]))
 			continue;
 
-		if (SUCCEED != parse_history_data_row_value(&jp_row, unique_shift, &values[*values_num]))
+		if (SUCCEED != parse_history_data_row_value(&row, unique_shift, &values[*values_num]))
 			continue;
 
 		(*values_num)++;
@@ -1121,6 +1221,7 @@ static int	parse_history_data_by_itemids(struct zbx_json_parse *jp_data, const c
 		zbx_timespec_t *unique_shift, char **error)
 {
 	struct zbx_json_parse	jp_row;
+	zbx_history_row_t	row;
 	int			ret = FAIL;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
@@ -1148,10 +1249,12 @@ static int	parse_history_data_by_itemids(struct zbx_json_parse *jp_data, const c
 
 		(*parsed_num)++;
 
-		if (SUCCEED != parse_history_data_row_itemid(&jp_row, &itemids[*values_num]))
+		parse_history_data_row(&jp_row, &row);
+
+		if (SUCCEED != parse_history_data_row_itemid(&row, &itemids[*values_num]))
 			continue;
 
-		if (SUCCEED != parse_history_data_row_value(&jp_row, unique_shift, &values[*values_num]))
+		if (SUCCEED != parse_history_data_row_value(&row, unique_shift, &values[*values_num]))
 			continue;
 
 		(*values_num)++;
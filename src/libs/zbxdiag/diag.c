@@ -196,6 +196,25 @@ void	zbx_diag_add_mem_stats(struct zbx_json *json, const char *name, const zbx_s
 	}
 
 	zbx_json_close(json);
+	zbx_json_close(json);
+
+	zbx_json_addfloat(json, "fragmentation", zbx_shmem_stats_fragmentation(stats));
+
+	zbx_json_addarray(json, "slabs");
+
+	for (i = 0; i < ZBX_SHMEM_SLAB_CLASS_COUNT; i++)
+	{
+		if (0 == stats->slabs[i].pages)
+			continue;
+
+		zbx_json_addobject(json, NULL);
+		zbx_json_adduint64(json, "size", stats->slabs[i].size);
+		zbx_json_adduint64(json, "pages", stats->slabs[i].pages);
+		zbx_json_adduint64(json, "used", stats->slabs[i].used);
+		zbx_json_adduint64(json, "total", stats->slabs[i].total);
+		zbx_json_close(json);
+	}
+
 	zbx_json_close(json);
 	zbx_json_close(json);
 }
@@ -416,14 +435,20 @@ void	zbx_diag_add_locks_info(struct zbx_json *json)
 				"ZBX_MUTEX_VALUECACHE", "ZBX_MUTEX_VMWARE", "ZBX_MUTEX_SQLITE3",
 				"ZBX_MUTEX_PROCSTAT", "ZBX_MUTEX_PROXY_HISTORY", "ZBX_MUTEX_KSTAT", "ZBX_MUTEX_MODBUS",
 				"ZBX_MUTEX_TREND_FUNC", "ZBX_MUTEX_REMOTE_COMMANDS", "ZBX_MUTEX_PROXY_BUFFER",
-				"ZBX_MUTEX_VPS_MONITOR"};
+				"ZBX_MUTEX_VPS_MONITOR", "ZBX_MUTEX_CACHE_SHARD1", "ZBX_MUTEX_CACHE_SHARD2",
+				"ZBX_MUTEX_CACHE_SHARD3", "ZBX_MUTEX_CACHE_SHARD4", "ZBX_MUTEX_CACHE_SHARD5",
+				"ZBX_MUTEX_CACHE_SHARD6", "ZBX_MUTEX_CACHE_SHARD7",
+				"ZBX_MUTEX_PREPROC_BUFFER", "ZBX_MUTEX_PROBLEM_INDEX"};
 #else
 	const char	*names[ZBX_MUTEX_COUNT] = {"ZBX_MUTEX_LOG", "ZBX_MUTEX_CACHE", "ZBX_MUTEX_TRENDS",
 				"ZBX_MUTEX_CACHE_IDS", "ZBX_MUTEX_SELFMON", "ZBX_MUTEX_CPUSTATS", "ZBX_MUTEX_DISKSTATS",
 				"ZBX_MUTEX_VALUECACHE", "ZBX_MUTEX_VMWARE", "ZBX_MUTEX_SQLITE3",
 				"ZBX_MUTEX_PROCSTAT", "ZBX_MUTEX_PROXY_HISTORY", "ZBX_MUTEX_MODBUS",
 				"ZBX_MUTEX_TREND_FUNC", "ZBX_MUTEX_REMOTE_COMMANDS", "ZBX_MUTEX_PROXY_BUFFER",
-				"ZBX_MUTEX_VPS_MONITOR"};
+				"ZBX_MUTEX_VPS_MONITOR", "ZBX_MUTEX_CACHE_SHARD1", "ZBX_MUTEX_CACHE_SHARD2",
+				"ZBX_MUTEX_CACHE_SHARD3", "ZBX_MUTEX_CACHE_SHARD4", "ZBX_MUTEX_CACHE_SHARD5",
+				"ZBX_MUTEX_CACHE_SHARD6", "ZBX_MUTEX_CACHE_SHARD7",
+				"ZBX_MUTEX_PREPROC_BUFFER", "ZBX_MUTEX_PROBLEM_INDEX"};
 #endif
 	zbx_json_addarray(json, ZBX_DIAG_LOCKS);
 
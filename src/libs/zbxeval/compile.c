@@ -0,0 +1,201 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxeval.h"
+#include "eval.h"
+
+#include "zbxvariant.h"
+#include "zbxnum.h"
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: parses numeric constant the same way as interpreter does          *
+ *                                                                            *
+ * Parameters: ctx   - [IN] evaluation context                                *
+ *             token - [IN] numeric constant token                            *
+ *             value - [OUT] constant value                                   *
+ *                                                                            *
+ * Return value: SUCCEED - constant was parsed successfully                   *
+ *               FAIL    - token has non-numeric value                        *
+ *                                                                            *
+ ******************************************************************************/
+static int	eval_compile_constant(const zbx_eval_context_t *ctx, const zbx_eval_token_t *token,
+		zbx_variant_t *value)
+{
+	zbx_uint64_t	ui64;
+
+	switch (token->value.type)
+	{
+		case ZBX_VARIANT_NONE:
+			break;
+		case ZBX_VARIANT_UI64:
+		case ZBX_VARIANT_DBL:
+			*value = token->value;
+			return SUCCEED;
+		default:
+			return FAIL;
+	}
+
+	if (SUCCEED == zbx_is_uint64_n(ctx->expression + token->loc.l, token->loc.r - token->loc.l + 1, &ui64))
+	{
+		zbx_variant_set_ui64(value, ui64);
+	}
+	else
+	{
+		zbx_variant_set_dbl(value, atof(ctx->expression + token->loc.l) *
+				suffix2factor(ctx->expression[token->loc.r]));
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compiles parsed expression into code for fast numeric evaluation  *
+ *                                                                            *
+ * Parameters: ctx         - [IN] parsed evaluation context                   *
+ *             malloc_func - [IN] code memory allocation function, optional   *
+ *                                (by default the code is allocated in heap)  *
+ *                                                                            *
+ * Return value: The compiled code or NULL if the expression contains         *
+ *               anything besides numeric constants, function results, user   *
+ *               macros and operators.                                        *
+ *                                                                            *
+ * Comments: Numeric constants are parsed and operators with constant         *
+ *           operands are calculated during compilation. The code refers      *
+ *           function and user macro tokens by their index in evaluation      *
+ *           context stack, so it can be executed only with contexts created  *
+ *           from the same expression.                                        *
+ *                                                                            *
+ ******************************************************************************/
+zbx_eval_code_t	*zbx_eval_compile(const zbx_eval_context_t *ctx, zbx_mem_malloc_func_t malloc_func)
+{
+	zbx_eval_instr_t	*instrs, *instr;
+	zbx_eval_code_t		*code = NULL;
+	int			i, instrs_num = 0, depth = 0;
+
+	if (0 == ctx->stack.values_num)
+		return NULL;
+
+	instrs = (zbx_eval_instr_t *)zbx_malloc(NULL, sizeof(zbx_eval_instr_t) * (size_t)ctx->stack.values_num);
+
+	for (i = 0; i < ctx->stack.values_num; i++)
+	{
+		const zbx_eval_token_t	*token = &ctx->stack.values[i];
+
+		instr = &instrs[instrs_num];
+		instr->type = token->type;
+		instr->index = (zbx_uint32_t)i;
+		zbx_variant_set_none(&instr->value);
+
+		if (0 != (token->type & ZBX_EVAL_CLASS_OPERATOR2))
+		{
+			if (2 > depth)
+				goto out;
+
+			depth--;
+
+			/* calculate operators with constant operands */
+			if (2 <= instrs_num && ZBX_EVAL_TOKEN_VAR_NUM == instr[-1].type &&
+					ZBX_EVAL_TOKEN_VAR_NUM == instr[-2].type)
+			{
+				zbx_variant_t	value = instr[-2].value;
+
+				if (SUCCEED == eval_execute_code_op_binary(token->type, &value, &instr[-1].value))
+				{
+					instr[-2].value = value;
+					instrs_num--;
+					continue;
+				}
+			}
+		}
+		else if (0 != (token->type & ZBX_EVAL_CLASS_OPERATOR1))
+		{
+			if (1 > depth)
+				goto out;
+
+			if (1 <= instrs_num && ZBX_EVAL_TOKEN_VAR_NUM == instr[-1].type)
+			{
+				zbx_variant_t	value = instr[-1].value;
+
+				if (SUCCEED == eval_execute_code_op_unary(token->type, &value))
+				{
+					instr[-1].value = value;
+					continue;
+				}
+			}
+		}
+		else
+		{
+			switch (token->type)
+			{
+				case ZBX_EVAL_TOKEN_NOP:
+					continue;
+				case ZBX_EVAL_TOKEN_VAR_NUM:
+					if (SUCCEED != eval_compile_constant(ctx, token, &instr->value))
+						goto out;
+					break;
+				case ZBX_EVAL_TOKEN_FUNCTIONID:
+				case ZBX_EVAL_TOKEN_VAR_USERMACRO:
+					break;
+				default:
+					goto out;
+			}
+
+			if (EVAL_CODE_STACK_SIZE < ++depth)
+				goto out;
+		}
+
+		instrs_num++;
+	}
+
+	if (1 != depth)
+		goto out;
+
+	if (NULL == malloc_func)
+		malloc_func = ZBX_DEFAULT_MEM_MALLOC_FUNC;
+
+	code = (zbx_eval_code_t *)malloc_func(NULL, sizeof(zbx_eval_code_t) +
+			sizeof(zbx_eval_instr_t) * (size_t)instrs_num);
+	code->instr_num = (zbx_uint64_t)instrs_num;
+	memcpy(EVAL_CODE_INSTR(code), instrs, sizeof(zbx_eval_instr_t) * (size_t)instrs_num);
+out:
+	zbx_free(instrs);
+
+	return code;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: copies compiled expression code into heap                         *
+ *                                                                            *
+ * Parameters: code - [IN] compiled expression code, optional                 *
+ *                                                                            *
+ * Return value: The copied code or NULL if no code was given.                *
+ *                                                                            *
+ ******************************************************************************/
+zbx_eval_code_t	*zbx_eval_code_dup(const zbx_eval_code_t *code)
+{
+	zbx_eval_code_t	*dst;
+	size_t		size;
+
+	if (NULL == code)
+		return NULL;
+
+	size = sizeof(zbx_eval_code_t) + sizeof(zbx_eval_instr_t) * (size_t)code->instr_num;
+	dst = (zbx_eval_code_t *)zbx_malloc(NULL, size);
+	memcpy(dst, code, size);
+
+	return dst;
+}
@@ -17,9 +17,30 @@
 
 #include "zbxeval.h"
 
+/* the maximum number of values in compiled expression code stack */
+#define EVAL_CODE_STACK_SIZE	32
+
+typedef struct
+{
+	zbx_token_type_t	type;
+	zbx_uint32_t		index;	/* index of the source token in evaluation context stack */
+	zbx_variant_t		value;
+}
+zbx_eval_instr_t;
+
+/* compiled expression code is stored in a single memory block - header followed by instructions */
+struct zbx_eval_code
+{
+	zbx_uint64_t	instr_num;
+};
+
+#define EVAL_CODE_INSTR(code)	((zbx_eval_instr_t *)((code) + 1))
+
 int	eval_suffixed_number_parse(const char *value, char *suffix);
 int	eval_compare_token(const zbx_eval_context_t *ctx, const zbx_strloc_t *loc, const char *text,
 		size_t len);
 size_t	eval_parse_query(const char *str, const char **phost, const char **pkey, const char **pfilter);
+int	eval_execute_code_op_unary(zbx_token_type_t type, zbx_variant_t *value);
+int	eval_execute_code_op_binary(zbx_token_type_t type, zbx_variant_t *left, const zbx_variant_t *right);
 
 #endif
@@ -1060,6 +1060,31 @@ static int	eval_execute_function_length(const zbx_eval_context_t *ctx, const zbx
 	return SUCCEED;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: converts time to local time in caller provided buffer             *
+ *                                                                            *
+ * Parameters: time - [IN] the time to convert                                *
+ *             tm   - [OUT] the local time                                    *
+ *                                                                            *
+ * Return value: pointer to tm or NULL on failure                             *
+ *                                                                            *
+ * Comments: Expressions can be evaluated by several threads at once, so      *
+ *           localtime() static buffer cannot be used.                        *
+ *                                                                            *
+ ******************************************************************************/
+static struct tm	*eval_localtime(time_t time, struct tm *tm)
+{
+#if defined(_WINDOWS) || defined(__MINGW32__)
+	if (0 != localtime_r(&time, tm))
+		return NULL;
+
+	return tm;
+#else
+	return localtime_r(&time, tm);
+#endif
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: evaluates date() function                                         *
@@ -1077,7 +1102,7 @@ static int	eval_execute_function_date(const zbx_eval_context_t *ctx, const zbx_e
 		zbx_vector_var_t *output, char **error)
 {
 	zbx_variant_t	value;
-	struct tm	*tm;
+	struct tm	tm_local, *tm;
 	time_t		now;
 
 	if (0 != token->opt)
@@ -1088,7 +1113,7 @@ static int	eval_execute_function_date(const zbx_eval_context_t *ctx, const zbx_e
 	}
 
 	now = ctx->ts.sec;
-	if (NULL == (tm = localtime(&now)))
+	if (NULL == (tm = eval_localtime(now, &tm_local)))
 	{
 		*error = zbx_dsprintf(*error, "cannot convert time for function at \"%s\": %s",
 				ctx->expression + token->loc.l, zbx_strerror(errno));
@@ -1118,7 +1143,7 @@ static int	eval_execute_function_time(const zbx_eval_context_t *ctx, const zbx_e
 		zbx_vector_var_t *output, char **error)
 {
 	zbx_variant_t	value;
-	struct tm	*tm;
+	struct tm	tm_local, *tm;
 	time_t		now;
 
 	if (0 != token->opt)
@@ -1129,7 +1154,7 @@ static int	eval_execute_function_time(const zbx_eval_context_t *ctx, const zbx_e
 	}
 
 	now = ctx->ts.sec;
-	if (NULL == (tm = localtime(&now)))
+	if (NULL == (tm = eval_localtime(now, &tm_local)))
 	{
 		*error = zbx_dsprintf(*error, "cannot convert time for function at \"%s\": %s",
 				ctx->expression + token->loc.l, zbx_strerror(errno));
@@ -1187,7 +1212,7 @@ static int	eval_execute_function_dayofweek(const zbx_eval_context_t *ctx, const
 		zbx_vector_var_t *output, char **error)
 {
 	zbx_variant_t	value;
-	struct tm	*tm;
+	struct tm	tm_local, *tm;
 	time_t		now;
 
 	if (0 != token->opt)
@@ -1198,7 +1223,7 @@ static int	eval_execute_function_dayofweek(const zbx_eval_context_t *ctx, const
 	}
 
 	now = ctx->ts.sec;
-	if (NULL == (tm = localtime(&now)))
+	if (NULL == (tm = eval_localtime(now, &tm_local)))
 	{
 		*error = zbx_dsprintf(*error, "cannot convert time for function at \"%s\": %s",
 				ctx->expression + token->loc.l, zbx_strerror(errno));
@@ -1227,7 +1252,7 @@ static int	eval_execute_function_dayofmonth(const zbx_eval_context_t *ctx, const
 		zbx_vector_var_t *output, char **error)
 {
 	zbx_variant_t	value;
-	struct tm	*tm;
+	struct tm	tm_local, *tm;
 	time_t		now;
 
 	if (0 != token->opt)
@@ -1238,7 +1263,7 @@ static int	eval_execute_function_dayofmonth(const zbx_eval_context_t *ctx, const
 	}
 
 	now = ctx->ts.sec;
-	if (NULL == (tm = localtime(&now)))
+	if (NULL == (tm = eval_localtime(now, &tm_local)))
 	{
 		*error = zbx_dsprintf(*error, "cannot convert time for function at \"%s\": %s",
 				ctx->expression + token->loc.l, zbx_strerror(errno));
@@ -3395,3 +3420,237 @@ int	zbx_eval_execute_ext(zbx_eval_context_t *ctx, const zbx_timespec_t *ts, zbx_
 
 	return eval_execute(ctx, value, error);
 }
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets floating point value of compiled code stack value            *
+ *                                                                            *
+ ******************************************************************************/
+static double	eval_code_value_dbl(const zbx_variant_t *value)
+{
+	return ZBX_VARIANT_UI64 == value->type ? (double)value->data.ui64 : value->data.dbl;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: evaluates unary operator with numeric operand                     *
+ *                                                                            *
+ * Parameters: type  - [IN] operator token type                               *
+ *             value - [IN/OUT] operand and the result                        *
+ *                                                                            *
+ * Return value: SUCCEED - operator was evaluated successfully                *
+ *               FAIL    - operator must be evaluated by interpreter to get   *
+ *                         the error message                                  *
+ *                                                                            *
+ * Comments: The results must match eval_execute_op_unary() results.          *
+ *                                                                            *
+ ******************************************************************************/
+int	eval_execute_code_op_unary(zbx_token_type_t type, zbx_variant_t *value)
+{
+	double	result;
+
+	switch (type)
+	{
+		case ZBX_EVAL_TOKEN_OP_MINUS:
+			result = -eval_code_value_dbl(value);
+			break;
+		case ZBX_EVAL_TOKEN_OP_NOT:
+			result = (SUCCEED == zbx_double_compare(eval_code_value_dbl(value), 0) ? 1 : 0);
+			break;
+		default:
+			return FAIL;
+	}
+
+	if (FP_ZERO != fpclassify(result) && FP_NORMAL != fpclassify(result))
+		return FAIL;
+
+	zbx_variant_set_dbl(value, result);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: evaluates binary operator with numeric operands                   *
+ *                                                                            *
+ * Parameters: type  - [IN] operator token type                               *
+ *             left  - [IN/OUT] left operand and the result                   *
+ *             right - [IN] right operand                                     *
+ *                                                                            *
+ * Return value: SUCCEED - operator was evaluated successfully                *
+ *               FAIL    - operator must be evaluated by interpreter to get   *
+ *                         the error message                                  *
+ *                                                                            *
+ * Comments: The results must match eval_execute_op_binary() results.         *
+ *                                                                            *
+ ******************************************************************************/
+int	eval_execute_code_op_binary(zbx_token_type_t type, zbx_variant_t *left, const zbx_variant_t *right)
+{
+	zbx_variant_t	left_dbl, right_dbl;
+	double		result;
+
+	/* equality is checked before converting operands to floating point values, */
+	/* so unsigned integers are compared without precision loss                 */
+	switch (type)
+	{
+		case ZBX_EVAL_TOKEN_OP_EQ:
+			result = (0 == zbx_variant_compare(left, right) ? 1 : 0);
+			goto out;
+		case ZBX_EVAL_TOKEN_OP_NE:
+			result = (0 == zbx_variant_compare(left, right) ? 0 : 1);
+			goto out;
+	}
+
+	zbx_variant_set_dbl(&left_dbl, eval_code_value_dbl(left));
+	zbx_variant_set_dbl(&right_dbl, eval_code_value_dbl(right));
+
+	switch (type)
+	{
+		case ZBX_EVAL_TOKEN_OP_AND:
+			if (SUCCEED == zbx_double_compare(left_dbl.data.dbl, 0) ||
+					SUCCEED == zbx_double_compare(right_dbl.data.dbl, 0))
+			{
+				result = 0;
+			}
+			else
+				result = 1;
+			goto out;
+		case ZBX_EVAL_TOKEN_OP_OR:
+			if (SUCCEED != zbx_double_compare(left_dbl.data.dbl, 0) ||
+					SUCCEED != zbx_double_compare(right_dbl.data.dbl, 0))
+			{
+				result = 1;
+			}
+			else
+				result = 0;
+			goto out;
+		case ZBX_EVAL_TOKEN_OP_LT:
+			result = (0 > zbx_variant_compare(&left_dbl, &right_dbl) ? 1 : 0);
+			break;
+		case ZBX_EVAL_TOKEN_OP_LE:
+			result = (0 >= zbx_variant_compare(&left_dbl, &right_dbl) ? 1 : 0);
+			break;
+		case ZBX_EVAL_TOKEN_OP_GT:
+			result = (0 < zbx_variant_compare(&left_dbl, &right_dbl) ? 1 : 0);
+			break;
+		case ZBX_EVAL_TOKEN_OP_GE:
+			result = (0 <= zbx_variant_compare(&left_dbl, &right_dbl) ? 1 : 0);
+			break;
+		case ZBX_EVAL_TOKEN_OP_ADD:
+			result = left_dbl.data.dbl + right_dbl.data.dbl;
+			break;
+		case ZBX_EVAL_TOKEN_OP_SUB:
+			result = left_dbl.data.dbl - right_dbl.data.dbl;
+			break;
+		case ZBX_EVAL_TOKEN_OP_MUL:
+			result = left_dbl.data.dbl * right_dbl.data.dbl;
+			break;
+		case ZBX_EVAL_TOKEN_OP_DIV:
+			if (SUCCEED == zbx_double_compare(right_dbl.data.dbl, 0))
+				return FAIL;
+			result = left_dbl.data.dbl / right_dbl.data.dbl;
+			break;
+		default:
+			return FAIL;
+	}
+
+	if (FP_ZERO != fpclassify(result) && FP_NORMAL != fpclassify(result))
+		return FAIL;
+out:
+	zbx_variant_set_dbl(left, result);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: loads numeric token value into compiled code stack                *
+ *                                                                            *
+ * Parameters: ctx   - [IN] evaluation context                                *
+ *             instr - [IN] load instruction                                  *
+ *             value - [OUT] loaded value                                     *
+ *                                                                            *
+ * Return value: SUCCEED - value was loaded successfully                      *
+ *               FAIL    - token value is not numeric                         *
+ *                                                                            *
+ ******************************************************************************/
+static int	eval_execute_code_load(const zbx_eval_context_t *ctx, const zbx_eval_instr_t *instr,
+		zbx_variant_t *value)
+{
+	const zbx_eval_token_t	*token;
+
+	/* evaluation context stack might have been replaced with exception */
+	if ((int)instr->index >= ctx->stack.values_num || instr->type != ctx->stack.values[instr->index].type)
+		return FAIL;
+
+	token = &ctx->stack.values[instr->index];
+
+	switch (token->value.type)
+	{
+		case ZBX_VARIANT_UI64:
+		case ZBX_VARIANT_DBL:
+			*value = token->value;
+			return SUCCEED;
+		case ZBX_VARIANT_STR:
+			if (ZBX_EVAL_TOKEN_VAR_USERMACRO != token->type)
+				return FAIL;
+
+			return variant_convert_suffixed_num(value, &token->value);
+		default:
+			return FAIL;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: evaluates compiled expression code                                *
+ *                                                                            *
+ * Parameters: ctx    - [IN] evaluation context the code was compiled from,   *
+ *                           with function and macro token values set         *
+ *             code   - [IN] compiled expression code                         *
+ *             result - [OUT] resulting value                                 *
+ *                                                                            *
+ * Return value: SUCCEED - expression was evaluated successfully              *
+ *               FAIL    - expression must be evaluated with                  *
+ *                         zbx_eval_execute() function                        *
+ *                                                                            *
+ * Comments: Only numeric values are processed without memory allocations.    *
+ *           Failure is returned for anything else (non-numeric or error      *
+ *           values, division by zero, overflows), leaving the error          *
+ *           processing and reporting to the interpreter.                     *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_eval_execute_code(const zbx_eval_context_t *ctx, const zbx_eval_code_t *code, double *result)
+{
+	zbx_variant_t		stack[EVAL_CODE_STACK_SIZE];
+	const zbx_eval_instr_t	*instr, *end;
+	int			depth = 0;
+
+	for (instr = EVAL_CODE_INSTR(code), end = instr + code->instr_num; instr < end; instr++)
+	{
+		if (0 != (instr->type & ZBX_EVAL_CLASS_OPERATOR2))
+		{
+			if (SUCCEED != eval_execute_code_op_binary(instr->type, &stack[depth - 2], &stack[depth - 1]))
+				return FAIL;
+			depth--;
+		}
+		else if (0 != (instr->type & ZBX_EVAL_CLASS_OPERATOR1))
+		{
+			if (SUCCEED != eval_execute_code_op_unary(instr->type, &stack[depth - 1]))
+				return FAIL;
+		}
+		else if (ZBX_EVAL_TOKEN_VAR_NUM == instr->type)
+		{
+			stack[depth++] = instr->value;
+		}
+		else
+		{
+			if (SUCCEED != eval_execute_code_load(ctx, instr, &stack[depth++]))
+				return FAIL;
+		}
+	}
+
+	*result = eval_code_value_dbl(&stack[0]);
+
+	return SUCCEED;
+}
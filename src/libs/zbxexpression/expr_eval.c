@@ -67,6 +67,20 @@ typedef struct
 }
 zbx_expression_query_many_t;
 
+/* resolved many items query - matching itemids for the query and host of evaluated item */
+typedef struct
+{
+	zbx_item_query_t	ref;
+	zbx_uint64_t		hostid;
+	zbx_vector_uint64_t	itemids;
+}
+zbx_expression_itemset_t;
+
+/* the resolved many item queries are cached until configuration used to resolve them is changed */
+static zbx_hashset_t	expression_itemsets;
+static zbx_uint64_t	expression_itemsets_revision;
+static int		expression_itemsets_initialized = 0;
+
 ZBX_PTR_VECTOR_IMPL(expression_group_ptr, zbx_expression_group_t *)
 ZBX_PTR_VECTOR_IMPL(expression_item_ptr, zbx_expression_item_t *)
 ZBX_PTR_VECTOR_IMPL(expression_query_ptr, zbx_expression_query_t *)
@@ -619,36 +633,149 @@ static int	expression_eval_filter(const char *name, size_t len, int args_num, zb
 	}
 }
 
+static zbx_hash_t	expression_itemset_hash(const void *data)
+{
+	const zbx_expression_itemset_t	*itemset = (const zbx_expression_itemset_t *)data;
+	zbx_hash_t			hash;
+	const char			*host, *key, *filter;
+
+	host = ZBX_NULL2EMPTY_STR(itemset->ref.host);
+	key = ZBX_NULL2EMPTY_STR(itemset->ref.key);
+	filter = ZBX_NULL2EMPTY_STR(itemset->ref.filter);
+
+	hash = ZBX_DEFAULT_UINT64_HASH_FUNC(&itemset->hostid);
+	hash = ZBX_DEFAULT_STRING_HASH_ALGO(host, strlen(host), hash);
+	hash = ZBX_DEFAULT_STRING_HASH_ALGO(key, strlen(key), hash);
+
+	return ZBX_DEFAULT_STRING_HASH_ALGO(filter, strlen(filter), hash);
+}
+
+static int	expression_itemset_compare(const void *d1, const void *d2)
+{
+	const zbx_expression_itemset_t	*itemset1 = (const zbx_expression_itemset_t *)d1;
+	const zbx_expression_itemset_t	*itemset2 = (const zbx_expression_itemset_t *)d2;
+	int				ret;
+
+	ZBX_RETURN_IF_NOT_EQUAL(itemset1->hostid, itemset2->hostid);
+
+	if (0 != (ret = strcmp(ZBX_NULL2EMPTY_STR(itemset1->ref.host), ZBX_NULL2EMPTY_STR(itemset2->ref.host))))
+		return ret;
+
+	if (0 != (ret = strcmp(ZBX_NULL2EMPTY_STR(itemset1->ref.key), ZBX_NULL2EMPTY_STR(itemset2->ref.key))))
+		return ret;
+
+	return strcmp(ZBX_NULL2EMPTY_STR(itemset1->ref.filter), ZBX_NULL2EMPTY_STR(itemset2->ref.filter));
+}
+
+static void	expression_itemset_clear(void *data)
+{
+	zbx_expression_itemset_t	*itemset = (zbx_expression_itemset_t *)data;
+
+	zbx_eval_clear_query(&itemset->ref);
+	zbx_vector_uint64_destroy(&itemset->itemids);
+}
+
 /******************************************************************************
  *                                                                            *
- * Purpose: initialize many item query.                                       *
+ * Purpose: get cached items matching many item query.                        *
+ *                                                                            *
+ * Parameters: eval  - [IN] evaluation data                                   *
+ *             query - [IN] many item query                                   *
+ *                                                                            *
+ * Return value: the cached item set or NULL if the query was not resolved    *
+ *               with current configuration.                                  *
+ *                                                                            *
+ * Comments: The cached item sets are dropped when configuration used to      *
+ *           resolve item queries changes.                                    *
+ *                                                                            *
+ ******************************************************************************/
+static const zbx_expression_itemset_t	*expression_get_itemset(const zbx_expression_eval_t *eval,
+		const zbx_expression_query_t *query)
+{
+	zbx_expression_itemset_t	itemset_local;
+	zbx_uint64_t			revision;
+
+	revision = zbx_dc_get_item_query_revision();
+
+	if (0 == expression_itemsets_initialized)
+	{
+		zbx_hashset_create_ext(&expression_itemsets, 100, expression_itemset_hash, expression_itemset_compare,
+				expression_itemset_clear, ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC,
+				ZBX_DEFAULT_MEM_FREE_FUNC);
+		expression_itemsets_revision = revision;
+		expression_itemsets_initialized = 1;
+	}
+	else if (revision != expression_itemsets_revision)
+	{
+		zbx_hashset_clear(&expression_itemsets);
+		expression_itemsets_revision = revision;
+	}
+
+	itemset_local.ref = query->ref;
+	itemset_local.hostid = (0 != (query->flags & ZBX_ITEM_QUERY_HOST_SELF) ? eval->hostid : 0);
+
+	return (const zbx_expression_itemset_t *)zbx_hashset_search(&expression_itemsets, &itemset_local);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: cache items matching many item query.                             *
  *                                                                            *
  * Parameters: eval    - [IN] evaluation data                                 *
- *             query   - [IN] query to initialize                             *
+ *             query   - [IN] many item query                                 *
+ *             itemids - [IN] matching item identifiers                       *
+ *                                                                            *
+ * Comments: The item set is cached with configuration revision checked by    *
+ *           expression_get_itemset() before resolving the query.             *
  *                                                                            *
  ******************************************************************************/
-static void	expression_init_query_many(zbx_expression_eval_t *eval, zbx_expression_query_t *query)
+static void	expression_add_itemset(const zbx_expression_eval_t *eval, const zbx_expression_query_t *query,
+		const zbx_vector_uint64_t *itemids)
 {
-	zbx_expression_query_many_t	*data;
-	char				*error = NULL, *errmsg = NULL, *filter_template = NULL;
+	zbx_expression_itemset_t	itemset_local, *itemset;
+
+	itemset_local.ref.host = (NULL != query->ref.host ? zbx_strdup(NULL, query->ref.host) : NULL);
+	itemset_local.ref.key = (NULL != query->ref.key ? zbx_strdup(NULL, query->ref.key) : NULL);
+	itemset_local.ref.filter = (NULL != query->ref.filter ? zbx_strdup(NULL, query->ref.filter) : NULL);
+	itemset_local.hostid = (0 != (query->flags & ZBX_ITEM_QUERY_HOST_SELF) ? eval->hostid : 0);
+
+	itemset = (zbx_expression_itemset_t *)zbx_hashset_insert(&expression_itemsets, &itemset_local,
+			sizeof(itemset_local));
+
+	zbx_vector_uint64_create(&itemset->itemids);
+	zbx_vector_uint64_append_array(&itemset->itemids, itemids->values, itemids->values_num);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: resolve items matching many item query.                           *
+ *                                                                            *
+ * Parameters: eval    - [IN] evaluation data                                 *
+ *             query   - [IN] query to resolve                                *
+ *             itemids - [OUT] matching item identifiers                      *
+ *             error   - [OUT]                                                *
+ *                                                                            *
+ * Return value: SUCCEED - the query was resolved successfully                *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	expression_resolve_query_many(zbx_expression_eval_t *eval, zbx_expression_query_t *query,
+		zbx_vector_uint64_t *itemids, char **error)
+{
+	char				*errmsg = NULL, *filter_template = NULL;
 	int				i, ret = FAIL;
 	zbx_eval_context_t		ctx;
 	zbx_vector_uint64_pair_t	itemhosts;
 	zbx_vector_str_t		groups;
-	zbx_vector_uint64_t		itemids;
-
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() /%s/%s?[%s]", __func__, ZBX_NULL2EMPTY_STR(query->ref.host),
-			ZBX_NULL2EMPTY_STR(query->ref.key), ZBX_NULL2EMPTY_STR(query->ref.filter));
 
 	zbx_eval_init(&ctx);
 
-	zbx_vector_uint64_create(&itemids);
 	zbx_vector_uint64_pair_create(&itemhosts);
 	zbx_vector_str_create(&groups);
 
 	if (ZBX_ITEM_QUERY_ITEM_ANY == (query->flags & ZBX_ITEM_QUERY_ITEM_ANY))
 	{
-		error = zbx_strdup(NULL, "item query must have at least a host or an item key defined");
+		*error = zbx_strdup(NULL, "item query must have at least a host or an item key defined");
 		goto out;
 	}
 
@@ -657,7 +784,7 @@ static void	expression_init_query_many(zbx_expression_eval_t *eval, zbx_expressi
 		if (SUCCEED != zbx_eval_parse_expression(&ctx, query->ref.filter, ZBX_EVAL_PARSE_QUERY_EXPRESSION,
 				&errmsg))
 		{
-			error = zbx_dsprintf(NULL, "failed to parse item query filter: %s", errmsg);
+			*error = zbx_dsprintf(NULL, "failed to parse item query filter: %s", errmsg);
 			zbx_free(errmsg);
 			goto out;
 		}
@@ -666,7 +793,7 @@ static void	expression_init_query_many(zbx_expression_eval_t *eval, zbx_expressi
 
 		if (FAIL == zbx_eval_get_group_filter(&ctx, &groups, &filter_template, &errmsg))
 		{
-			error = zbx_dsprintf(NULL, "failed to extract groups from item filter: %s", errmsg);
+			*error = zbx_dsprintf(NULL, "failed to extract groups from item filter: %s", errmsg);
 			zbx_free(errmsg);
 			goto out;
 		}
@@ -705,13 +832,65 @@ static void	expression_init_query_many(zbx_expression_eval_t *eval, zbx_expressi
 			}
 
 			if (SUCCEED != zbx_double_compare(filter_value.data.dbl, 0))
-				zbx_vector_uint64_append(&itemids, eval_data.itemid);
+				zbx_vector_uint64_append(itemids, eval_data.itemid);
 		}
 	}
 	else
 	{
 		for (i = 0; i < itemhosts.values_num; i++)
-			zbx_vector_uint64_append(&itemids, itemhosts.values[i].first);
+			zbx_vector_uint64_append(itemids, itemhosts.values[i].first);
+	}
+
+	ret = SUCCEED;
+out:
+	if (0 != (query->flags & ZBX_ITEM_QUERY_FILTER) && SUCCEED == zbx_eval_status(&ctx))
+		zbx_eval_clear(&ctx);
+
+	zbx_free(filter_template);
+
+	zbx_vector_uint64_pair_destroy(&itemhosts);
+
+	zbx_vector_str_clear_ext(&groups, zbx_str_free);
+	zbx_vector_str_destroy(&groups);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: initialize many item query.                                       *
+ *                                                                            *
+ * Parameters: eval    - [IN] evaluation data                                 *
+ *             query   - [IN] query to initialize                             *
+ *                                                                            *
+ * Comments: Aggregate expressions are evaluated periodically, so their item  *
+ *           queries are resolved once per configuration change.              *
+ *                                                                            *
+ ******************************************************************************/
+static void	expression_init_query_many(zbx_expression_eval_t *eval, zbx_expression_query_t *query)
+{
+	zbx_expression_query_many_t	*data;
+	const zbx_expression_itemset_t	*itemset = NULL;
+	char				*error = NULL;
+	int				i, ret = FAIL;
+	zbx_vector_uint64_t		itemids;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() /%s/%s?[%s]", __func__, ZBX_NULL2EMPTY_STR(query->ref.host),
+			ZBX_NULL2EMPTY_STR(query->ref.key), ZBX_NULL2EMPTY_STR(query->ref.filter));
+
+	zbx_vector_uint64_create(&itemids);
+
+	if (ZBX_EXPRESSION_AGGREGATE == eval->mode && NULL != (itemset = expression_get_itemset(eval, query)))
+	{
+		zbx_vector_uint64_append_array(&itemids, itemset->itemids.values, itemset->itemids.values_num);
+	}
+	else
+	{
+		if (SUCCEED != expression_resolve_query_many(eval, query, &itemids, &error))
+			goto out;
+
+		if (ZBX_EXPRESSION_AGGREGATE == eval->mode)
+			expression_add_itemset(eval, query, &itemids);
 	}
 
 	if (SUCCEED == ZBX_CHECK_LOG_LEVEL(LOG_LEVEL_DEBUG))
@@ -727,9 +906,6 @@ static void	expression_init_query_many(zbx_expression_eval_t *eval, zbx_expressi
 
 	ret = SUCCEED;
 out:
-	if (0 != (query->flags & ZBX_ITEM_QUERY_FILTER) && SUCCEED == zbx_eval_status(&ctx))
-		zbx_eval_clear(&ctx);
-
 	if (SUCCEED != ret)
 	{
 		query->error = error;
@@ -737,14 +913,8 @@ out:
 		zbx_vector_uint64_destroy(&itemids);
 	}
 
-	zbx_free(filter_template);
-
-	zbx_vector_uint64_pair_destroy(&itemhosts);
-
-	zbx_vector_str_clear_ext(&groups, zbx_str_free);
-	zbx_vector_str_destroy(&groups);
-
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() items:%d", __func__, (SUCCEED == ret ? data->itemids.values_num : -1));
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() items:%d cached:%d", __func__,
+			(SUCCEED == ret ? data->itemids.values_num : -1), (NULL != itemset ? 1 : 0));
 }
 
 /******************************************************************************
@@ -1615,6 +1785,177 @@ out:
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: check if function can be calculated from value cache aggregates   *
+ *          for items of the specified value type.                            *
+ *                                                                            *
+ * Parameters: item_func  - [IN] function id                                  *
+ *             value_type - [IN] item value type                              *
+ *             operator   - [IN] count function operator, optional            *
+ *             pattern    - [IN] count function pattern, optional             *
+ *                                                                            *
+ * Return value: SUCCEED - function can be calculated from aggregates         *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	expression_is_aggregate_func(int item_func, unsigned char value_type, const char *operator,
+		const char *pattern)
+{
+	switch (item_func)
+	{
+		case ZBX_VALUE_FUNC_LAST:
+		case ZBX_VALUE_FUNC_MIN:
+		case ZBX_VALUE_FUNC_AVG:
+		case ZBX_VALUE_FUNC_MAX:
+		case ZBX_VALUE_FUNC_SUM:
+			if (ITEM_VALUE_TYPE_FLOAT != value_type && ITEM_VALUE_TYPE_UINT64 != value_type)
+				return FAIL;
+
+			return SUCCEED;
+		case ZBX_VALUE_FUNC_COUNT:
+			/* all values are counted without operator and pattern */
+			if ((NULL != operator && '\0' != *operator) || (NULL != pattern && '\0' != *pattern))
+				return FAIL;
+
+			return SUCCEED;
+		default:
+			return FAIL;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get value cache aggregates of multiple items.                     *
+ *                                                                            *
+ * Parameters: dcitems   - [IN] items to aggregate                            *
+ *             item_func - [IN] function id                                   *
+ *             operator  - [IN] count function operator, optional             *
+ *             pattern   - [IN] count function pattern, optional              *
+ *             seconds   - [IN] time period to aggregate values for           *
+ *             count     - [IN] number of values to aggregate                 *
+ *             ts        - [IN] period end timestamp                          *
+ *             aggrs     - [OUT] aggregates of each item                      *
+ *             errcodes  - [OUT] SUCCEED if item aggregates were retrieved,   *
+ *                               FAIL if they were not retrieved,             *
+ *                               NOTSUPPORTED if function cannot be           *
+ *                               calculated from aggregates for the item      *
+ *                                                                            *
+ * Comments: Value cache is locked once for all items instead of copying      *
+ *           values of each item out of cache.                                *
+ *                                                                            *
+ ******************************************************************************/
+static void	expression_get_aggregates(const zbx_vector_dc_item_t *dcitems, int item_func, const char *operator,
+		const char *pattern, int seconds, int count, const zbx_timespec_t *ts, zbx_vc_aggregate_t *aggrs,
+		int *errcodes)
+{
+	zbx_uint64_t		*itemids;
+	unsigned char		*value_types;
+	zbx_vc_aggregate_t	*items_aggrs;
+	int			*items_errcodes, i, items_num = 0;
+
+	itemids = (zbx_uint64_t *)zbx_malloc(NULL, sizeof(zbx_uint64_t) * (size_t)dcitems->values_num);
+	value_types = (unsigned char *)zbx_malloc(NULL, sizeof(unsigned char) * (size_t)dcitems->values_num);
+
+	for (i = 0; i < dcitems->values_num; i++)
+	{
+		const zbx_dc_item_t	*dcitem = dcitems->values[i];
+
+		if (SUCCEED != expression_is_aggregate_func(item_func, dcitem->value_type, operator, pattern))
+		{
+			errcodes[i] = NOTSUPPORTED;
+			continue;
+		}
+
+		itemids[items_num] = dcitem->itemid;
+		value_types[items_num] = dcitem->value_type;
+		items_num++;
+	}
+
+	if (0 != items_num)
+	{
+		items_aggrs = (zbx_vc_aggregate_t *)zbx_malloc(NULL, sizeof(zbx_vc_aggregate_t) * (size_t)items_num);
+		items_errcodes = (int *)zbx_malloc(NULL, sizeof(int) * (size_t)items_num);
+
+		zbx_vc_get_aggregates(itemids, value_types, items_num, seconds, count, ts, items_aggrs, items_errcodes);
+
+		for (i = 0, items_num = 0; i < dcitems->values_num; i++)
+		{
+			if (NOTSUPPORTED == errcodes[i])
+				continue;
+
+			aggrs[i] = items_aggrs[items_num];
+			errcodes[i] = items_errcodes[items_num];
+			items_num++;
+		}
+
+		zbx_free(items_errcodes);
+		zbx_free(items_aggrs);
+	}
+
+	zbx_free(value_types);
+	zbx_free(itemids);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: convert value cache aggregates to function result and append to   *
+ *          variant vector.                                                   *
+ *                                                                            *
+ * Parameters: aggr           - [IN] item value aggregates                    *
+ *             value_type     - [IN] type of item                             *
+ *             item_func      - [IN] function id                              *
+ *             results_vector - [OUT] resulting vector                        *
+ *                                                                            *
+ * Comments: Results are the same as calculated from values retrieved by      *
+ *           zbx_vc_get_values() - function results are added only if there   *
+ *           are values in the requested range, except for count function.    *
+ *                                                                            *
+ ******************************************************************************/
+static void	var_vector_append_aggregate(const zbx_vc_aggregate_t *aggr, unsigned char value_type, int item_func,
+		zbx_vector_var_t *results_vector)
+{
+	zbx_variant_t	result;
+
+	if (0 == aggr->values_num && ZBX_VALUE_FUNC_COUNT != item_func)
+		return;
+
+	switch (item_func)
+	{
+		case ZBX_VALUE_FUNC_LAST:
+			/* the only aggregated value is the last value */
+			zbx_history_value2variant(&aggr->max, value_type, &result);
+			break;
+		case ZBX_VALUE_FUNC_MIN:
+			zbx_variant_set_dbl(&result, ITEM_VALUE_TYPE_UINT64 == value_type ? (double)aggr->min.ui64 :
+					aggr->min.dbl);
+			break;
+		case ZBX_VALUE_FUNC_MAX:
+			zbx_variant_set_dbl(&result, ITEM_VALUE_TYPE_UINT64 == value_type ? (double)aggr->max.ui64 :
+					aggr->max.dbl);
+			break;
+		case ZBX_VALUE_FUNC_SUM:
+			if (ITEM_VALUE_TYPE_FLOAT == value_type)
+				zbx_variant_set_dbl(&result, aggr->sum.dbl);
+			else if (aggr->max.ui64 <= ZBX_MAX_UINT64 / (zbx_uint64_t)aggr->values_num)
+				zbx_variant_set_dbl(&result, (double)aggr->sum.ui64);
+			else	/* unsigned integer sum might have wrapped around */
+				zbx_variant_set_dbl(&result, aggr->avg * aggr->values_num);
+			break;
+		case ZBX_VALUE_FUNC_AVG:
+			zbx_variant_set_dbl(&result, aggr->avg);
+			break;
+		case ZBX_VALUE_FUNC_COUNT:
+			zbx_variant_set_dbl(&result, (double)aggr->values_num);
+			break;
+		default:
+			THIS_SHOULD_NEVER_HAPPEN;
+			return;
+	}
+
+	zbx_vector_var_append(results_vector, result);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: evaluate historical function for multiple items (aggregate        *
@@ -1644,6 +1985,9 @@ static int	expression_eval_many(zbx_expression_eval_t *eval, zbx_expression_quer
 	zbx_vector_var_t		*results_var_vector;
 	double				result;
 	char				*operator = NULL, *pattern = NULL;
+	zbx_vector_dc_item_t		dcitems;
+	zbx_vc_aggregate_t		*aggrs = NULL;
+	int				*errcodes = NULL;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() %.*s(/%s/%s?[%s],...)", __func__, (int)len, name,
 			ZBX_NULL2EMPTY_STR(query->ref.host), ZBX_NULL2EMPTY_STR(query->ref.key),
@@ -1654,6 +1998,8 @@ static int	expression_eval_many(zbx_expression_eval_t *eval, zbx_expression_quer
 	data = (zbx_expression_query_many_t *)query->data;
 	item_func = get_function_by_name(name, len);
 
+	zbx_vector_dc_item_create(&dcitems);
+
 	switch (item_func)
 	{
 		case ZBX_ITEM_FUNC_EXISTS:
@@ -1762,9 +2108,6 @@ static int	expression_eval_many(zbx_expression_eval_t *eval, zbx_expression_quer
 			goto out;
 	}
 
-	results_var_vector = (zbx_vector_var_t *)zbx_malloc(NULL, sizeof(zbx_vector_var_t));
-	zbx_vector_var_create(results_var_vector);
-
 	for (i = 0; i < data->itemids.values_num; i++)
 	{
 		zbx_dc_item_t			*dcitem;
@@ -1784,7 +2127,34 @@ static int	expression_eval_many(zbx_expression_eval_t *eval, zbx_expression_quer
 		if (ITEM_VALUE_TYPE_NONE == dcitem->value_type)
 			continue;
 
-		if (ZBX_VALUE_FUNC_COUNT == item_func)
+		zbx_vector_dc_item_append(&dcitems, dcitem);
+	}
+
+	if (0 != dcitems.values_num)
+	{
+		aggrs = (zbx_vc_aggregate_t *)zbx_malloc(NULL, sizeof(zbx_vc_aggregate_t) * (size_t)dcitems.values_num);
+		errcodes = (int *)zbx_malloc(NULL, sizeof(int) * (size_t)dcitems.values_num);
+
+		expression_get_aggregates(&dcitems, item_func, operator, pattern, (int)seconds, count, ts, aggrs,
+				errcodes);
+	}
+
+	results_var_vector = (zbx_vector_var_t *)zbx_malloc(NULL, sizeof(zbx_vector_var_t));
+	zbx_vector_var_create(results_var_vector);
+
+	for (i = 0; i < dcitems.values_num; i++)
+	{
+		zbx_dc_item_t	*dcitem = dcitems.values[i];
+
+		if (NOTSUPPORTED != errcodes[i])
+		{
+			if (SUCCEED == errcodes[i])
+			{
+				var_vector_append_aggregate(&aggrs[i], dcitem->value_type, item_func,
+						results_var_vector);
+			}
+		}
+		else if (ZBX_VALUE_FUNC_COUNT == item_func)
 		{
 			if (FAIL == (ret = evaluate_count_many(operator, pattern, dcitem, seconds, count, ts,
 					results_var_vector, error)))
@@ -1825,6 +2195,10 @@ static int	expression_eval_many(zbx_expression_eval_t *eval, zbx_expression_quer
 
 	ret = SUCCEED;
 out:
+	zbx_free(errcodes);
+	zbx_free(aggrs);
+	zbx_vector_dc_item_destroy(&dcitems);
+
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s value:%s flags:%s", __func__, zbx_result_string(ret),
 			zbx_variant_value_desc(value), zbx_variant_type_desc(value));
 
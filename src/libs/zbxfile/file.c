@@ -207,6 +207,10 @@ int	zbx_write_all(int fd, const char *buf, size_t n)
 
 #endif	/* not _WINDOWS */
 
+/* non-zero if any byte of 64-bit word x is less than n (n <= 128) */
+#define ZBX_WORD_HAS_BYTE_LESS(x, n)	\
+		(((x) - __UINT64_C(0x0101010101010101) * (n)) & ~(x) & __UINT64_C(0x8080808080808080))
+
 /******************************************************************************
  *                                                                            *
  * Purpose: find next newline in buffer using newline encoding                *
@@ -230,6 +234,22 @@ char	*zbx_find_buf_newline(char *p, char **p_next, const char *p_end, const char
 	{
 		for (; p < p_end; p++)
 		{
+			/* skip 8 bytes at a time while none of them is a control character in range 0x00 - 0x0d */
+			while (p_end - p >= (ptrdiff_t)sizeof(zbx_uint64_t))
+			{
+				zbx_uint64_t	word;
+
+				memcpy(&word, p, sizeof(word));
+
+				if (0 != ZBX_WORD_HAS_BYTE_LESS(word, 0x0e))
+					break;
+
+				p += sizeof(word);
+			}
+
+			if (p >= p_end)
+				break;
+
 			/* detect NULL byte and replace it with '?' character */
 			if (0x0 == *p)
 			{
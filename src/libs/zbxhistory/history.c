@@ -22,6 +22,7 @@
 #include "zbxvariant.h"
 
 ZBX_VECTOR_IMPL(history_record, zbx_history_record_t)
+ZBX_VECTOR_IMPL(history_item_record, zbx_history_item_record_t)
 
 ZBX_PTR_VECTOR_IMPL(dc_history_ptr, zbx_dc_history_t *)
 
@@ -191,6 +192,73 @@ int	zbx_history_get_values(zbx_uint64_t itemid, int value_type, int start, int c
 	return ret;
 }
 
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: gets values of multiple items from history storage                      *
+ *                                                                                  *
+ * Parameters:  itemids     - [IN] the item identifiers, sorted                     *
+ *              itemids_num - [IN] the number of item identifiers                   *
+ *              value_type  - [IN] the items value type                             *
+ *              start       - [IN] the period start timestamp                       *
+ *              values      - [OUT] the item history data values                    *
+ *                                                                                  *
+ * Return value: SUCCEED - the history data were read successfully                  *
+ *               FAIL - otherwise                                                   *
+ *                                                                                  *
+ * Comments: This function reads all values from ]<start>,now] interval. The        *
+ *           values are grouped by items in the order of their identifiers.         *
+ *                                                                                  *
+ ************************************************************************************/
+int	zbx_history_get_items_values(const zbx_uint64_t *itemids, int itemids_num, int value_type, int start,
+		zbx_vector_history_item_record_t *values)
+{
+	int			ret = SUCCEED, pos;
+	zbx_history_iface_t	*writer = &history_ifaces[value_type];
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() items:%d value_type:%d start:%d", __func__, itemids_num, value_type,
+			start);
+
+	pos = values->values_num;
+
+	if (NULL != writer->get_items_values)
+	{
+		ret = writer->get_items_values(writer, itemids, itemids_num, start, values);
+	}
+	else
+	{
+		zbx_vector_history_record_t	records;
+
+		zbx_history_record_vector_create(&records);
+
+		for (int i = 0; i < itemids_num; i++)
+		{
+			if (SUCCEED != (ret = writer->get_values(writer, itemids[i], start, 0, ZBX_JAN_2038, &records)))
+				break;
+
+			zbx_vector_history_record_sort(&records,
+					(zbx_compare_func_t)zbx_history_record_compare_asc_func);
+
+			for (int j = 0; j < records.values_num; j++)
+			{
+				zbx_history_item_record_t	value;
+
+				value.itemid = itemids[i];
+				value.record = records.values[j];
+				zbx_vector_history_item_record_append_ptr(values, &value);
+			}
+
+			zbx_vector_history_record_clear(&records);
+		}
+
+		zbx_history_record_vector_destroy(&records, value_type);
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s values:%d", __func__, zbx_result_string(ret),
+			values->values_num - pos);
+
+	return ret;
+}
+
 /************************************************************************************
  *                                                                                  *
  * Purpose: checks if the value type requires trends data calculations              *
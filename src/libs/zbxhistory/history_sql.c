@@ -343,12 +343,17 @@ static int	db_read_values_by_time(zbx_uint64_t itemid, int value_type, zbx_vecto
 	zbx_db_row_t		row;
 	zbx_vc_history_table_t	*table = &vc_history_tables[value_type];
 	time_t			time_from;
+	zbx_db_param_t		params[3];
+	int			params_num = 0;
 
 	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
 			"select clock,ns,%s"
 			" from %s"
-			" where itemid=" ZBX_FS_UI64,
-			table->fields, table->name, itemid);
+			" where itemid=?",
+			table->fields, table->name);
+
+	params[params_num].type = ZBX_TYPE_ID;
+	params[params_num++].value.ui64 = itemid;
 
 	time_from = end_timestamp - seconds;
 
@@ -356,7 +361,9 @@ static int	db_read_values_by_time(zbx_uint64_t itemid, int value_type, zbx_vecto
 
 	if (ZBX_JAN_2038 == end_timestamp)
 	{
-		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, " and clock>" ZBX_FS_I64, time_from);
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " and clock>?");
+		params[params_num].type = ZBX_TYPE_INT;
+		params[params_num++].value.i32 = (int)time_from;
 	}
 	else if (1 == seconds)
 	{
@@ -366,15 +373,20 @@ static int	db_read_values_by_time(zbx_uint64_t itemid, int value_type, zbx_vecto
 			goto out;
 		}
 
-		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, " and clock=%d", end_timestamp);
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " and clock=?");
+		params[params_num].type = ZBX_TYPE_INT;
+		params[params_num++].value.i32 = end_timestamp;
 	}
 	else
 	{
-		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, " and clock>" ZBX_FS_I64 " and clock<=%d",
-				time_from, end_timestamp);
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " and clock>? and clock<=?");
+		params[params_num].type = ZBX_TYPE_INT;
+		params[params_num++].value.i32 = (int)time_from;
+		params[params_num].type = ZBX_TYPE_INT;
+		params[params_num++].value.i32 = end_timestamp;
 	}
 
-	result = zbx_db_select("%s", sql);
+	result = zbx_db_select_prepared(sql, params, params_num);
 
 	zbx_free(sql);
 
@@ -431,6 +443,8 @@ static int	db_read_values_by_count(zbx_uint64_t itemid, int value_type, zbx_vect
 	zbx_vc_history_table_t	*table = &vc_history_tables[value_type];
 	const int		periods[] = {SEC_PER_HOUR, 12 * SEC_PER_HOUR, SEC_PER_DAY, SEC_PER_DAY, SEC_PER_WEEK,
 					SEC_PER_MONTH, 0, -1};
+	zbx_db_param_t		params[3];
+	int			params_num;
 
 	clock_to = end_timestamp;
 
@@ -447,19 +461,27 @@ static int	db_read_values_by_count(zbx_uint64_t itemid, int value_type, zbx_vect
 		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
 				"select clock,ns,%s"
 				" from %s"
-				" where itemid=" ZBX_FS_UI64
-					" and clock<=%d",
-				table->fields, table->name, itemid, clock_to);
+				" where itemid=?"
+					" and clock<=?",
+				table->fields, table->name);
+
+		params[0].type = ZBX_TYPE_ID;
+		params[0].value.ui64 = itemid;
+		params[1].type = ZBX_TYPE_INT;
+		params[1].value.i32 = clock_to;
+		params_num = 2;
 
 		if (clock_from != clock_to)
 		{
 			zbx_recalc_time_period(&clock_from, ZBX_RECALC_TIME_PERIOD_HISTORY);
-			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, " and clock>" ZBX_FS_I64, clock_from);
+			zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " and clock>?");
+			params[params_num].type = ZBX_TYPE_INT;
+			params[params_num++].value.i32 = (int)clock_from;
 		}
 
 		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " order by clock desc");
 
-		result = zbx_db_select_n(sql, count);
+		result = zbx_db_select_prepared_n(sql, params, params_num, count);
 
 		if (NULL == result)
 			goto out;
@@ -534,24 +556,34 @@ static int	db_read_values_by_time_and_count(zbx_uint64_t itemid, int value_type,
 	zbx_db_result_t		result;
 	zbx_db_row_t		row;
 	zbx_vc_history_table_t	*table = &vc_history_tables[value_type];
+	zbx_db_param_t		params[3];
+	int			params_num = 0;
 
 	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
 			"select clock,ns,%s"
 			" from %s"
-			" where itemid=" ZBX_FS_UI64,
-			table->fields, table->name, itemid);
+			" where itemid=?",
+			table->fields, table->name);
+
+	params[params_num].type = ZBX_TYPE_ID;
+	params[params_num++].value.ui64 = itemid;
 
 	if (1 == seconds)
 	{
-		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, " and clock=%d", end_timestamp);
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " and clock=?");
+		params[params_num].type = ZBX_TYPE_INT;
+		params[params_num++].value.i32 = end_timestamp;
 	}
 	else
 	{
-		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, " and clock>%d and clock<=%d order by clock desc",
-				end_timestamp - seconds, end_timestamp);
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " and clock>? and clock<=? order by clock desc");
+		params[params_num].type = ZBX_TYPE_INT;
+		params[params_num++].value.i32 = end_timestamp - seconds;
+		params[params_num].type = ZBX_TYPE_INT;
+		params[params_num++].value.i32 = end_timestamp;
 	}
 
-	result = zbx_db_select_n(sql, count);
+	result = zbx_db_select_prepared_n(sql, params, params_num, count);
 
 	zbx_free(sql);
 
@@ -596,6 +628,67 @@ out:
 	return ret;
 }
 
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: reads history data of multiple items from database                      *
+ *                                                                                  *
+ * Parameters:  itemids     - [IN] the item identifiers                             *
+ *              itemids_num - [IN] the number of item identifiers                   *
+ *              value_type  - [IN] the value type (see ITEM_VALUE_TYPE_* defs)      *
+ *              values      - [OUT] the item history data values                    *
+ *              start       - [IN] the period start timestamp                       *
+ *                                                                                  *
+ * Return value: SUCCEED - the history data were read successfully                  *
+ *               FAIL - otherwise                                                   *
+ *                                                                                  *
+ * Comments: This function reads all values with timestamps greater than <start>    *
+ *           with a single range query ordered by item identifiers.                 *
+ *                                                                                  *
+ ************************************************************************************/
+static int	db_read_items_values_by_time(const zbx_uint64_t *itemids, int itemids_num, int value_type,
+		zbx_vector_history_item_record_t *values, int start)
+{
+	char			*sql = NULL;
+	size_t			sql_alloc = 0, sql_offset = 0;
+	zbx_db_result_t		result;
+	zbx_db_row_t		row;
+	zbx_vc_history_table_t	*table = &vc_history_tables[value_type];
+	time_t			time_from = start;
+
+	zbx_recalc_time_period(&time_from, ZBX_RECALC_TIME_PERIOD_HISTORY);
+
+	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
+			"select itemid,clock,ns,%s"
+			" from %s"
+			" where",
+			table->fields, table->name);
+
+	zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "itemid", itemids, itemids_num);
+	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, " and clock>%d order by itemid", (int)time_from);
+
+	result = zbx_db_select("%s", sql);
+
+	zbx_free(sql);
+
+	if (NULL == result)
+		return FAIL;
+
+	while (NULL != (row = zbx_db_fetch(result)))
+	{
+		zbx_history_item_record_t	value;
+
+		ZBX_STR2UINT64(value.itemid, row[0]);
+		value.record.timestamp.sec = atoi(row[1]);
+		value.record.timestamp.ns = atoi(row[2]);
+		table->rtov(&value.record.value, row + 3);
+
+		zbx_vector_history_item_record_append_ptr(values, &value);
+	}
+	zbx_db_free_result(result);
+
+	return SUCCEED;
+}
+
 /******************************************************************************************************************
  *                                                                                                                *
  * history interface support                                                                                      *
@@ -644,6 +737,26 @@ static int	sql_get_values(zbx_history_iface_t *hist, zbx_uint64_t itemid, int st
 	return db_read_values_by_time_and_count(itemid, hist->value_type, values, end - start, count, end);
 }
 
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: gets history data of multiple items from history storage                *
+ *                                                                                  *
+ * Parameters:  hist        - [IN] the history storage interface                    *
+ *              itemids     - [IN] the item identifiers                             *
+ *              itemids_num - [IN] the number of item identifiers                   *
+ *              start       - [IN] the period start timestamp                       *
+ *              values      - [OUT] the item history data values                    *
+ *                                                                                  *
+ * Return value: SUCCEED - the history data were read successfully                  *
+ *               FAIL - otherwise                                                   *
+ *                                                                                  *
+ ************************************************************************************/
+static int	sql_get_items_values(zbx_history_iface_t *hist, const zbx_uint64_t *itemids, int itemids_num,
+		int start, zbx_vector_history_item_record_t *values)
+{
+	return db_read_items_values_by_time(itemids, itemids_num, hist->value_type, values, start);
+}
+
 /**********************************************************************************************
  *                                                                                            *
  * Purpose: sends history data to storage                                                     *
@@ -708,6 +821,7 @@ void	zbx_history_sql_init(zbx_history_iface_t *hist, unsigned char value_type)
 	hist->add_values = sql_add_values;
 	hist->flush = sql_flush;
 	hist->get_values = sql_get_values;
+	hist->get_items_values = sql_get_items_values;
 
 	switch (value_type)
 	{
@@ -13,6 +13,7 @@
 **/
 
 #include "zbxicmpping.h"
+#include "icmpping_native.h"
 
 #ifdef HAVE_IPV6
 #	include "zbxcomms.h"
@@ -47,6 +48,9 @@ static ZBX_THREAD_LOCAL int		fping_ipv6_supported;
 static ZBX_THREAD_LOCAL time_t		fping_check_reset_at;	/* time of the last fping options expiration */
 static ZBX_THREAD_LOCAL char		tmpfile_uniq[255] = {'\0'};
 
+/* set after the first failure to use native pinging, to log the fallback to fping only once */
+static ZBX_THREAD_LOCAL unsigned char	native_ping_failed;
+
 typedef struct
 {
 	zbx_fping_host_t	*hosts;
@@ -1173,6 +1177,35 @@ void	zbx_init_icmpping_env(const char *prefix, long int id)
 	zbx_remove_chars(tmpfile_uniq, " ");
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets minimum interval between packets for native pinging          *
+ *                                                                            *
+ * Return value: interval in milliseconds                                     *
+ *                                                                            *
+ * Comments: Native pinging keeps the same interval as passed to fping with   *
+ *           -i option. If fping interval was not detected yet, the smallest  *
+ *           interval accepted by fping built with "safe limits" is used.     *
+ *                                                                            *
+ ******************************************************************************/
+static int	get_native_interval(void)
+{
+#define ICMPPING_NATIVE_DEFAULT_INTERVAL	1
+	int	interval = FPING_UNINITIALIZED_VALUE;
+
+	/* detected options are valid only after they have been reset at least once */
+	if (0 != fping_check_reset_at)
+	{
+		interval = packet_interval;
+#ifdef HAVE_IPV6
+		interval = MAX(interval, packet_interval6);
+#endif
+	}
+
+	return FPING_UNINITIALIZED_VALUE == interval ? ICMPPING_NATIVE_DEFAULT_INTERVAL : interval;
+#undef ICMPPING_NATIVE_DEFAULT_INTERVAL
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: ping hosts listed in the host files                               *
@@ -1199,18 +1232,31 @@ void	zbx_init_icmpping_env(const char *prefix, long int id)
  * Return value: SUCCEED - successfully processed hosts                       *
  *               NOTSUPPORTED - otherwise                                     *
  *                                                                            *
- * Comments: use external binary 'fping' to avoid superuser privileges        *
+ * Comments: use external binary 'fping' to avoid superuser privileges,       *
+ *           unless native pinging is enabled and ICMP sockets can be opened  *
  *                                                                            *
  ******************************************************************************/
 int	zbx_ping(zbx_fping_host_t *hosts, int hosts_count, int requests_count, int period, int size, int timeout,
 		unsigned char allow_redirect, int rdns, char *error, size_t max_error_len)
 {
-	int	ret;
+	int	ret = FAIL;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() hosts_count:%d", __func__, hosts_count);
 
-	if (NOTSUPPORTED == (ret = hosts_ping(hosts, hosts_count, requests_count, period, size, timeout,
-			allow_redirect, rdns, error, max_error_len)))
+	if (NULL != config_icmpping->get_native_ping && 0 != config_icmpping->get_native_ping())
+	{
+		if (FAIL == (ret = icmpping_native_ping(hosts, hosts_count, requests_count, period,
+				get_native_interval(), size, timeout, allow_redirect, rdns,
+				config_icmpping->get_source_ip(), error, max_error_len)) &&
+				0 == native_ping_failed)
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "cannot use native ICMP ping, falling back to fping: %s", error);
+			native_ping_failed = 1;
+		}
+	}
+
+	if (FAIL == ret && NOTSUPPORTED == (ret = hosts_ping(hosts, hosts_count, requests_count, period, size,
+			timeout, allow_redirect, rdns, error, max_error_len)))
 	{
 		zabbix_log(LOG_LEVEL_ERR, "%s", error);
 	}
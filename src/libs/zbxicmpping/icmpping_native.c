@@ -0,0 +1,740 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "icmpping_native.h"
+
+#include "zbxcomms.h"
+#include "zbxstr.h"
+#include "zbxtime.h"
+
+#include <event2/event.h>
+#include <event2/util.h>
+
+/* fping defaults for packet interval to one target (-p) and amount of ping data (-b), in milliseconds and bytes */
+#define ICMPPING_DEFAULT_PERIOD		1000
+#define ICMPPING_DEFAULT_SIZE		56
+
+/* in count mode fping uses the packet interval as timeout, but not more than 2 seconds */
+#define ICMPPING_MAX_DEFAULT_TIMEOUT	2000
+
+/* maximum number of requests sent before giving way to reply processing */
+#define ICMPPING_SEND_BURST		64
+
+/* delay before retrying to send request when socket send buffer is full, in seconds */
+#define ICMPPING_SEND_RETRY_DELAY	0.001
+
+#define ICMPPING_RCVBUF_SIZE		(1024 * 1024)
+
+#define ICMPPING_HEADER_SIZE		8
+#define ICMPPING_IP_HEADER_MIN_SIZE	20
+
+#define ICMPPING_ECHO_REQUEST		8
+#define ICMPPING_ECHO_REPLY		0
+#define ICMPPING_ECHO6_REQUEST		128
+#define ICMPPING_ECHO6_REPLY		129
+
+#define ICMPPING_SOCKET_IPV4		0
+#define ICMPPING_SOCKET_IPV6		1
+
+/* data placed at the beginning of request payload to match replies with requests */
+typedef struct
+{
+	zbx_uint32_t	cookie;
+	zbx_uint32_t	target;
+	zbx_uint32_t	request;
+}
+zbx_icmpping_payload_t;
+
+typedef struct zbx_icmpping zbx_icmpping_t;
+
+typedef struct
+{
+	zbx_icmpping_t	*ping;
+	struct event	*event;
+	int		fd;
+	int		family;
+	int		type;	/* SOCK_DGRAM - unprivileged ICMP socket, SOCK_RAW - raw socket */
+}
+zbx_icmpping_socket_t;
+
+typedef struct
+{
+	zbx_fping_host_t	*host;
+	zbx_icmpping_socket_t	*socket;
+	ZBX_SOCKADDR		addr;
+	socklen_t		addr_len;
+
+	/* the time when the next request can be sent to the target */
+	double			next_send;
+
+	/* send times of the requests, indexed by request number */
+	double			*sent;
+	int			sent_num;
+}
+zbx_icmpping_target_t;
+
+struct zbx_icmpping
+{
+	zbx_icmpping_target_t	*targets;
+	int			targets_num;
+
+	/* targets waiting for the next request, ordered by their next send time */
+	int			*queue;
+	int			queue_head;
+	int			queue_num;
+
+	zbx_icmpping_socket_t	sockets[2];
+	struct event_base	*base;
+	struct event		*timer;
+
+	unsigned char		*packet;
+	size_t			packet_size;
+	unsigned char		*buffer;
+	size_t			buffer_size;
+
+	int			requests_count;
+	double			period;
+	double			interval;
+	double			timeout;
+	unsigned char		allow_redirect;
+
+	zbx_uint32_t		cookie;
+	unsigned short		ident;
+	unsigned short		sequence;
+
+	int			sent_num;
+	int			replies_num;
+	double			last_sent;
+};
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculates internet checksum (RFC 1071) of ICMP packet            *
+ *                                                                            *
+ ******************************************************************************/
+static unsigned short	icmpping_checksum(const unsigned char *data, size_t len)
+{
+	zbx_uint32_t	sum = 0;
+
+	for (; 1 < len; data += 2, len -= 2)
+		sum += (zbx_uint32_t)(data[0] << 8 | data[1]);
+
+	if (0 != len)
+		sum += (zbx_uint32_t)(data[0] << 8);
+
+	while (0 != (sum >> 16))
+		sum = (sum & 0xffff) + (sum >> 16);
+
+	return (unsigned short)~sum;
+}
+
+static int	icmpping_addr_equal(const ZBX_SOCKADDR *addr1, const ZBX_SOCKADDR *addr2)
+{
+	const struct sockaddr	*sa1 = (const struct sockaddr *)addr1, *sa2 = (const struct sockaddr *)addr2;
+
+	if (sa1->sa_family != sa2->sa_family)
+		return FAIL;
+
+	if (AF_INET == sa1->sa_family)
+	{
+		const struct sockaddr_in	*in1 = (const struct sockaddr_in *)sa1;
+		const struct sockaddr_in	*in2 = (const struct sockaddr_in *)sa2;
+
+		return 0 == memcmp(&in1->sin_addr, &in2->sin_addr, sizeof(struct in_addr)) ? SUCCEED : FAIL;
+	}
+#ifdef HAVE_IPV6
+	if (AF_INET6 == sa1->sa_family)
+	{
+		const struct sockaddr_in6	*in1 = (const struct sockaddr_in6 *)sa1;
+		const struct sockaddr_in6	*in2 = (const struct sockaddr_in6 *)sa2;
+
+		return 0 == memcmp(&in1->sin6_addr, &in2->sin6_addr, sizeof(struct in6_addr)) ? SUCCEED : FAIL;
+	}
+#endif
+	return FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: resolves address into socket address of the specified family      *
+ *                                                                            *
+ * Parameters: addr     - [IN] host name or IP address                        *
+ *             family   - [IN] address family, AF_UNSPEC for any              *
+ *             flags    - [IN] getaddrinfo() flags                            *
+ *             sa       - [OUT] resolved address                              *
+ *             sa_len   - [OUT] length of resolved address                    *
+ *                                                                            *
+ * Return value: SUCCEED - address was resolved                               *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	icmpping_resolve(const char *addr, int family, int flags, ZBX_SOCKADDR *sa, socklen_t *sa_len)
+{
+	struct addrinfo	hints, *ai;
+
+	memset(&hints, 0, sizeof(hints));
+#ifdef HAVE_IPV6
+	hints.ai_family = family;
+#else
+	ZBX_UNUSED(family);
+	hints.ai_family = AF_INET;
+#endif
+	hints.ai_socktype = SOCK_DGRAM;
+	hints.ai_flags = flags;
+
+	if (0 != getaddrinfo(addr, NULL, &hints, &ai))
+		return FAIL;
+
+	memcpy(sa, ai->ai_addr, (size_t)ai->ai_addrlen);
+	*sa_len = ai->ai_addrlen;
+	freeaddrinfo(ai);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: opens ICMP socket of the specified address family                 *
+ *                                                                            *
+ * Parameters: sock          - [OUT] socket                                   *
+ *             family        - [IN] address family                            *
+ *             source_ip     - [IN] source address to bind to, optional       *
+ *             error         - [OUT] error message                            *
+ *             max_error_len - [IN] size of error buffer                      *
+ *                                                                            *
+ * Return value: SUCCEED - socket was opened                                  *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: Unprivileged ICMP datagram sockets are preferred, raw sockets    *
+ *           are used when the process group is not allowed to open them.     *
+ *                                                                            *
+ ******************************************************************************/
+static int	icmpping_socket_open(zbx_icmpping_socket_t *sock, int family, const char *source_ip, char *error,
+		size_t max_error_len)
+{
+	int		protocol = IPPROTO_ICMP, rcvbuf = ICMPPING_RCVBUF_SIZE;
+	ZBX_SOCKADDR	sa;
+	socklen_t	sa_len;
+
+#ifdef HAVE_IPV6
+	if (AF_INET6 == family)
+		protocol = IPPROTO_ICMPV6;
+#endif
+	if (-1 != (sock->fd = socket(family, SOCK_DGRAM, protocol)))
+	{
+		sock->type = SOCK_DGRAM;
+	}
+	else if (-1 != (sock->fd = socket(family, SOCK_RAW, protocol)))
+	{
+		sock->type = SOCK_RAW;
+	}
+	else
+	{
+		zbx_snprintf(error, max_error_len, "cannot open %s ICMP socket: %s",
+				AF_INET == family ? "IPv4" : "IPv6", zbx_strerror(errno));
+		return FAIL;
+	}
+
+	sock->family = family;
+
+	if (0 != evutil_make_socket_nonblocking(sock->fd))
+	{
+		zbx_snprintf(error, max_error_len, "cannot make ICMP socket non-blocking: %s", zbx_strerror(errno));
+		goto fail;
+	}
+
+	if (-1 == setsockopt(sock->fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf)))
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "cannot set ICMP socket receive buffer size: %s", zbx_strerror(errno));
+	}
+
+	if (NULL != source_ip)
+	{
+		if (SUCCEED != icmpping_resolve(source_ip, family, AI_NUMERICHOST, &sa, &sa_len))
+		{
+			zbx_snprintf(error, max_error_len, "invalid source IP address \"%s\"", source_ip);
+			goto fail;
+		}
+
+		if (-1 == bind(sock->fd, (struct sockaddr *)&sa, sa_len))
+		{
+			zbx_snprintf(error, max_error_len, "cannot bind ICMP socket to \"%s\": %s", source_ip,
+					zbx_strerror(errno));
+			goto fail;
+		}
+	}
+
+	return SUCCEED;
+fail:
+	close(sock->fd);
+	sock->fd = -1;
+
+	return FAIL;
+}
+
+static void	icmpping_queue_push(zbx_icmpping_t *ping, int index)
+{
+	ping->queue[(ping->queue_head + ping->queue_num++) % ping->targets_num] = index;
+}
+
+static void	icmpping_timer_add(zbx_icmpping_t *ping, double delay)
+{
+	struct timeval	tv;
+
+	if (0 > delay)
+		delay = 0;
+
+	tv.tv_sec = (time_t)delay;
+	tv.tv_usec = (suseconds_t)((delay - (double)tv.tv_sec) * 1000000);
+
+	evtimer_add(ping->timer, &tv);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sends the next echo request to target                             *
+ *                                                                            *
+ * Parameters: ping   - [IN/OUT] ping context                                 *
+ *             index  - [IN] target index                                     *
+ *             now    - [IN] current time                                     *
+ *                                                                            *
+ * Return value: SUCCEED - request was sent or failed permanently, in which   *
+ *                         case it is counted as lost (like fping does)       *
+ *               FAIL    - socket send buffer is full, retry later            *
+ *                                                                            *
+ ******************************************************************************/
+static int	icmpping_send(zbx_icmpping_t *ping, int index, double now)
+{
+	zbx_icmpping_target_t	*target = &ping->targets[index];
+	zbx_icmpping_payload_t	payload;
+	unsigned char		*packet = ping->packet;
+	unsigned short		checksum;
+
+	packet[0] = (AF_INET == target->socket->family ? ICMPPING_ECHO_REQUEST : ICMPPING_ECHO6_REQUEST);
+	packet[1] = 0;
+	packet[2] = 0;
+	packet[3] = 0;
+	packet[4] = (unsigned char)(ping->ident >> 8);
+	packet[5] = (unsigned char)(ping->ident & 0xff);
+	packet[6] = (unsigned char)(ping->sequence >> 8);
+	packet[7] = (unsigned char)(ping->sequence & 0xff);
+
+	payload.cookie = ping->cookie;
+	payload.target = (zbx_uint32_t)index;
+	payload.request = (zbx_uint32_t)target->sent_num;
+	memcpy(packet + ICMPPING_HEADER_SIZE, &payload, sizeof(payload));
+
+	/* ICMPv6 checksum covers IPv6 pseudo header and is calculated by kernel */
+	if (AF_INET == target->socket->family)
+	{
+		checksum = icmpping_checksum(packet, ping->packet_size);
+		packet[2] = (unsigned char)(checksum >> 8);
+		packet[3] = (unsigned char)(checksum & 0xff);
+	}
+
+	if (-1 == sendto(target->socket->fd, packet, ping->packet_size, 0, (struct sockaddr *)&target->addr,
+			target->addr_len))
+	{
+		if (EAGAIN == errno || EWOULDBLOCK == errno || ENOBUFS == errno)
+			return FAIL;
+
+		zabbix_log(LOG_LEVEL_DEBUG, "cannot send ICMP echo request to \"%s\": %s", target->host->addr,
+				zbx_strerror(errno));
+	}
+
+	ping->sequence++;
+	target->sent[target->sent_num++] = now;
+	ping->sent_num++;
+	ping->last_sent = now;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sends requests to the targets whose time has come                 *
+ *                                                                            *
+ * Comments: Each target is queued again after sending request, so the next   *
+ *           request to the same target is sent not earlier than after the    *
+ *           configured period. Requests to any targets are separated by the  *
+ *           configured interval, without interval they are sent in bursts.   *
+ *           When there is nothing left to send the timer fires once more     *
+ *           after the reply timeout of the last request to finish pinging.   *
+ *                                                                            *
+ ******************************************************************************/
+static void	icmpping_send_cb(evutil_socket_t fd, short what, void *arg)
+{
+	zbx_icmpping_t	*ping = (zbx_icmpping_t *)arg;
+	double		now;
+	int		burst = 0;
+
+	ZBX_UNUSED(fd);
+	ZBX_UNUSED(what);
+
+	if (0 == ping->queue_num)
+	{
+		event_base_loopbreak(ping->base);
+		return;
+	}
+
+	now = zbx_time();
+
+	while (0 != ping->queue_num && ICMPPING_SEND_BURST > burst)
+	{
+		int			index = ping->queue[ping->queue_head];
+		zbx_icmpping_target_t	*target = &ping->targets[index];
+
+		if (target->next_send > now || ping->last_sent + ping->interval > now)
+			break;
+
+		if (SUCCEED != icmpping_send(ping, index, now))
+		{
+			icmpping_timer_add(ping, ICMPPING_SEND_RETRY_DELAY);
+			return;
+		}
+
+		ping->queue_head = (ping->queue_head + 1) % ping->targets_num;
+		ping->queue_num--;
+		burst++;
+
+		if (target->sent_num < ping->requests_count)
+		{
+			target->next_send = now + ping->period;
+			icmpping_queue_push(ping, index);
+		}
+	}
+
+	if (0 != ping->queue_num)
+	{
+		if (ICMPPING_SEND_BURST == burst)
+			icmpping_timer_add(ping, 0);
+		else
+		{
+			icmpping_timer_add(ping, MAX(ping->targets[ping->queue[ping->queue_head]].next_send,
+					ping->last_sent + ping->interval) - now);
+		}
+	}
+	else
+		icmpping_timer_add(ping, ping->last_sent + ping->timeout - now);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: matches received packet with sent request and updates target      *
+ *          statistics                                                        *
+ *                                                                            *
+ * Parameters: ping   - [IN/OUT] ping context                                 *
+ *             sock   - [IN] socket the packet was received from              *
+ *             data   - [IN] received packet                                  *
+ *             len    - [IN] received packet length                           *
+ *             from   - [IN] packet source address                            *
+ *             now    - [IN] packet receive time                              *
+ *                                                                            *
+ * Comments: Duplicate replies, replies received after timeout and replies    *
+ *           from other addresses than target address (unless redirects are   *
+ *           allowed) are ignored.                                            *
+ *                                                                            *
+ ******************************************************************************/
+static void	icmpping_process_reply(zbx_icmpping_t *ping, const zbx_icmpping_socket_t *sock,
+		const unsigned char *data, size_t len, const ZBX_SOCKADDR *from, double now)
+{
+	zbx_icmpping_payload_t	payload;
+	zbx_icmpping_target_t	*target;
+	zbx_fping_host_t	*host;
+	double			sec;
+
+	/* raw IPv4 sockets receive packets together with IP header */
+	if (SOCK_RAW == sock->type && AF_INET == sock->family)
+	{
+		size_t	ip_header_len;
+
+		if (ICMPPING_IP_HEADER_MIN_SIZE > len)
+			return;
+
+		if (len < (ip_header_len = (size_t)(data[0] & 0x0f) * 4))
+			return;
+
+		data += ip_header_len;
+		len -= ip_header_len;
+	}
+
+	if (ICMPPING_HEADER_SIZE + sizeof(payload) > len)
+		return;
+
+	if ((AF_INET == sock->family ? ICMPPING_ECHO_REPLY : ICMPPING_ECHO6_REPLY) != data[0])
+		return;
+
+	/* datagram sockets receive only replies to own requests, with identifier replaced by kernel */
+	if (SOCK_RAW == sock->type && ping->ident != (unsigned short)(data[4] << 8 | data[5]))
+		return;
+
+	memcpy(&payload, data + ICMPPING_HEADER_SIZE, sizeof(payload));
+
+	if (payload.cookie != ping->cookie || (zbx_uint32_t)ping->targets_num <= payload.target)
+		return;
+
+	target = &ping->targets[payload.target];
+	host = target->host;
+
+	if (target->socket != sock || (zbx_uint32_t)target->sent_num <= payload.request)
+		return;
+
+	if (0 != host->status[payload.request])
+		return;
+
+	if (0 == ping->allow_redirect && SUCCEED != icmpping_addr_equal(&target->addr, from))
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "ignoring redirected ICMP echo reply for \"%s\"", host->addr);
+		return;
+	}
+
+	if (ping->timeout < (sec = now - target->sent[payload.request]))
+		return;
+
+	host->status[payload.request] = 1;
+
+	if (0 == host->rcv || host->min > sec)
+		host->min = sec;
+	if (0 == host->rcv || host->max < sec)
+		host->max = sec;
+	host->sum += sec;
+	host->rcv++;
+
+	ping->replies_num++;
+}
+
+static void	icmpping_recv_cb(evutil_socket_t fd, short what, void *arg)
+{
+	zbx_icmpping_socket_t	*sock = (zbx_icmpping_socket_t *)arg;
+	zbx_icmpping_t		*ping = sock->ping;
+	ZBX_SOCKADDR		from;
+	socklen_t		from_len;
+	ssize_t			n;
+
+	ZBX_UNUSED(what);
+
+	for (;;)
+	{
+		from_len = sizeof(from);
+
+		if (-1 == (n = recvfrom(fd, ping->buffer, ping->buffer_size, 0, (struct sockaddr *)&from, &from_len)))
+			break;
+
+		icmpping_process_reply(ping, sock, ping->buffer, (size_t)n, &from, zbx_time());
+	}
+
+	/* all requests have been sent and answered */
+	if (0 == ping->queue_num && ping->replies_num == ping->sent_num)
+		event_base_loopbreak(ping->base);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: pings hosts using in-process ICMP sockets                         *
+ *                                                                            *
+ * Parameters: hosts          - [IN/OUT] target hosts                         *
+ *             hosts_count    - [IN] number of target hosts                   *
+ *             requests_count - [IN] number of requests to send to each host  *
+ *             period         - [IN] interval between requests to one host,   *
+ *                                   in milliseconds (0 - default)            *
+ *             interval       - [IN] minimum interval between requests to any *
+ *                                   hosts, in milliseconds (0 - no interval) *
+ *             size           - [IN] amount of request data, in bytes         *
+ *                                   (0 - default)                            *
+ *             timeout        - [IN] reply timeout, in milliseconds           *
+ *                                   (0 - default)                            *
+ *             allow_redirect - [IN] accept replies from other addresses      *
+ *             rdns           - [IN] resolve host IP addresses into names     *
+ *             source_ip      - [IN] source address, optional                 *
+ *             error          - [OUT] error message                           *
+ *             max_error_len  - [IN] size of error buffer                     *
+ *                                                                            *
+ * Return value: SUCCEED - hosts were pinged                                  *
+ *               FAIL    - ICMP sockets cannot be used                        *
+ *                                                                            *
+ * Comments: The statistics are gathered the same way as from fping output    *
+ *           in count mode - hosts that cannot be resolved are left with zero *
+ *           request count, lost requests are not retried.                    *
+ *                                                                            *
+ ******************************************************************************/
+int	icmpping_native_ping(zbx_fping_host_t *hosts, int hosts_count, int requests_count, int period,
+		int interval, int size, int timeout, unsigned char allow_redirect, int rdns, const char *source_ip,
+		char *error, size_t max_error_len)
+{
+	zbx_icmpping_t	ping;
+	ZBX_SOCKADDR	sa;
+	socklen_t	sa_len;
+	double		now, *sent = NULL;
+	int		i, ret = FAIL, family = AF_UNSPEC;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() hosts_count:%d", __func__, hosts_count);
+
+	memset(&ping, 0, sizeof(ping));
+	ping.sockets[ICMPPING_SOCKET_IPV4].fd = -1;
+	ping.sockets[ICMPPING_SOCKET_IPV6].fd = -1;
+
+	if (0 == period)
+		period = ICMPPING_DEFAULT_PERIOD;
+
+	if (0 == size)
+		size = ICMPPING_DEFAULT_SIZE;
+
+	if (0 == timeout)
+		timeout = MIN(period, ICMPPING_MAX_DEFAULT_TIMEOUT);
+
+	if (NULL != source_ip)
+	{
+		if (SUCCEED != icmpping_resolve(source_ip, AF_UNSPEC, AI_NUMERICHOST, &sa, &sa_len))
+		{
+			zbx_snprintf(error, max_error_len, "invalid source IP address \"%s\"", source_ip);
+			goto out;
+		}
+
+		family = ((struct sockaddr *)&sa)->sa_family;
+	}
+
+	ping.requests_count = requests_count;
+	ping.period = period / 1000.0;
+	ping.interval = interval / 1000.0;
+	ping.timeout = timeout / 1000.0;
+	ping.allow_redirect = allow_redirect;
+
+	ping.packet_size = ICMPPING_HEADER_SIZE + MAX((size_t)size, sizeof(zbx_icmpping_payload_t));
+	ping.packet = (unsigned char *)zbx_malloc(NULL, ping.packet_size);
+	memset(ping.packet, 0, ping.packet_size);
+	ping.buffer_size = ping.packet_size + 128;
+	ping.buffer = (unsigned char *)zbx_malloc(NULL, ping.buffer_size);
+
+	ping.targets = (zbx_icmpping_target_t *)zbx_malloc(NULL, sizeof(zbx_icmpping_target_t) * (size_t)hosts_count);
+	sent = (double *)zbx_malloc(NULL, sizeof(double) * (size_t)hosts_count * (size_t)requests_count);
+
+	for (i = 0; i < hosts_count; i++)
+	{
+		zbx_fping_host_t	*host = &hosts[i];
+		zbx_icmpping_target_t	*target = &ping.targets[ping.targets_num];
+		int			index;
+
+		host->status = (char *)zbx_malloc(NULL, (size_t)requests_count);
+		memset(host->status, 0, (size_t)requests_count);
+
+		if (SUCCEED != icmpping_resolve(host->addr, family, 0, &target->addr, &target->addr_len))
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "cannot resolve \"%s\"", host->addr);
+			continue;
+		}
+
+		index = (AF_INET == ((struct sockaddr *)&target->addr)->sa_family ? ICMPPING_SOCKET_IPV4 :
+				ICMPPING_SOCKET_IPV6);
+		target->socket = &ping.sockets[index];
+
+		if (-1 == target->socket->fd && SUCCEED != icmpping_socket_open(target->socket,
+				((struct sockaddr *)&target->addr)->sa_family, source_ip, error, max_error_len))
+		{
+			goto out;
+		}
+
+		target->host = host;
+		target->next_send = 0;
+		target->sent = sent + (size_t)ping.targets_num * (size_t)requests_count;
+		target->sent_num = 0;
+		ping.targets_num++;
+	}
+
+	if (0 == ping.targets_num)
+	{
+		ret = SUCCEED;
+		goto out;
+	}
+
+	if (NULL == (ping.base = event_base_new()))
+	{
+		zbx_strlcpy(error, "cannot create event base", max_error_len);
+		goto out;
+	}
+
+	for (i = 0; i < (int)ARRSIZE(ping.sockets); i++)
+	{
+		zbx_icmpping_socket_t	*sock = &ping.sockets[i];
+
+		if (-1 == sock->fd)
+			continue;
+
+		sock->ping = &ping;
+		sock->event = event_new(ping.base, sock->fd, EV_READ | EV_PERSIST, icmpping_recv_cb, sock);
+		event_add(sock->event, NULL);
+	}
+
+	ping.timer = evtimer_new(ping.base, icmpping_send_cb, &ping);
+
+	ping.queue = (int *)zbx_malloc(NULL, sizeof(int) * (size_t)ping.targets_num);
+
+	for (i = 0; i < ping.targets_num; i++)
+		icmpping_queue_push(&ping, i);
+
+	now = zbx_time();
+	ping.cookie = (zbx_uint32_t)zbx_get_thread_id() ^ (zbx_uint32_t)(now * 1000000);
+	ping.ident = (unsigned short)(getpid() & 0xffff);
+
+	icmpping_timer_add(&ping, 0);
+	event_base_dispatch(ping.base);
+
+	for (i = 0; i < ping.targets_num; i++)
+	{
+		zbx_icmpping_target_t	*target = &ping.targets[i];
+		char			name[NI_MAXHOST];
+
+		target->host->cnt += target->sent_num;
+
+		if (0 == rdns || (NULL != target->host->dnsname && '\0' != *target->host->dnsname))
+			continue;
+
+		if (0 != getnameinfo((struct sockaddr *)&target->addr, target->addr_len, name, sizeof(name), NULL, 0,
+				NI_NAMEREQD) || ZBX_MAX_DNSNAME_LEN < zbx_strlen_utf8(name))
+		{
+			*name = '\0';
+		}
+
+		target->host->dnsname = zbx_strdup(target->host->dnsname, name);
+	}
+
+	ret = SUCCEED;
+out:
+	for (i = 0; i < hosts_count; i++)
+		zbx_free(hosts[i].status);
+
+	for (i = 0; i < (int)ARRSIZE(ping.sockets); i++)
+	{
+		if (NULL != ping.sockets[i].event)
+			event_free(ping.sockets[i].event);
+
+		if (-1 != ping.sockets[i].fd)
+			close(ping.sockets[i].fd);
+	}
+
+	if (NULL != ping.timer)
+		event_free(ping.timer);
+
+	if (NULL != ping.base)
+		event_base_free(ping.base);
+
+	zbx_free(ping.queue);
+	zbx_free(sent);
+	zbx_free(ping.targets);
+	zbx_free(ping.buffer);
+	zbx_free(ping.packet);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
+
+	return ret;
+}
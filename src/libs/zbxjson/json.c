@@ -16,6 +16,7 @@
 
 #include "zbxjson.h"
 #include "json_parser.h"
+#include "json_scan.h"
 #include "jsonpath.h"
 
 #include "zbxnum.h"
@@ -584,12 +585,15 @@ static zbx_json_type_t	__zbx_json_type(const char *p)
 }
 
 /******************************************************************************
+ *                                                                            *
+ * Parameters: p   - [IN] position of the left bracket                        *
+ *             end - [IN] end of enclosing JSON data, NULL if not known       *
  *                                                                            *
  * Return value: position of the right bracket                                *
  *               NULL - an error occurred                                     *
  *                                                                            *
  ******************************************************************************/
-static const char	*__zbx_json_rbracket(const char *p)
+static const char	*__zbx_json_rbracket(const char *p, const char *end)
 {
 	int	level = 0;
 	int	state = 0; /* 0 - outside string; 1 - inside string */
@@ -632,6 +636,7 @@ static const char	*__zbx_json_rbracket(const char *p)
 				break;
 		}
 		p++;
+		p = (0 == state ? json_scan_structural(p, end) : json_scan_string(p, end));
 	}
 
 	return NULL;
@@ -739,6 +744,7 @@ const char	*zbx_json_next(const struct zbx_json_parse *jp, const char *p)
 				break;
 		}
 		p++;
+		p = (0 == state ? json_scan_structural(p, jp->end + 1) : json_scan_string(p, jp->end + 1));
 	}
 
 	return NULL;
@@ -915,6 +921,7 @@ unsigned int	zbx_json_decode_character(const char **p, unsigned char *bytes)
  *          converting escape sequences                                       *
  *                                                                            *
  * Parameters: p     - [IN] a pointer to the next character in string         *
+ *             end   - [IN] end of JSON data, NULL if not known               *
  *             out   - [OUT] the output buffer                                *
  *             size  - [IN] the output buffer size                            *
  *                                                                            *
@@ -922,9 +929,10 @@ unsigned int	zbx_json_decode_character(const char **p, unsigned char *bytes)
  *               string copying failed.                                       *
  *                                                                            *
  ******************************************************************************/
-const char	*json_copy_string(const char *p, char *out, size_t size)
+const char	*json_copy_string(const char *p, const char *end, char *out, size_t size)
 {
 	char	*start = out;
+	size_t	len;
 
 	if (0 == size)
 		return NULL;
@@ -954,7 +962,13 @@ const char	*json_copy_string(const char *p, char *out, size_t size)
 				*out = '\0';
 				return ++p;
 			default:
-				*out++ = *p++;
+				/* copy the whole run of characters up to the next quote or escape */
+				if ((len = (size_t)(json_scan_string(p + 1, end) - p)) > size - (size_t)(out - start))
+					len = size - (size_t)(out - start);
+
+				memcpy(out, p, len);
+				out += len;
+				p += len;
 		}
 
 		if ((size_t)(out - start) == size)
@@ -988,7 +1002,22 @@ static const char	*zbx_json_copy_unquoted_value(const char *p, size_t len, char
 	return p + len;
 }
 
-const char	*zbx_json_decodevalue(const char *p, char *string, size_t size, zbx_json_type_t *type)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: decodes primitive JSON value                                      *
+ *                                                                            *
+ * Parameters: p      - [IN] the value                                        *
+ *             end    - [IN] end of enclosing JSON data, NULL if not known    *
+ *             string - [OUT] the output buffer                               *
+ *             size   - [IN] the output buffer size                           *
+ *             type   - [OUT] the value type (optional)                       *
+ *                                                                            *
+ * Return value: A pointer to the next character after the value or NULL if   *
+ *               value decoding failed.                                       *
+ *                                                                            *
+ ******************************************************************************/
+static const char	*json_decodevalue(const char *p, const char *end, char *string, size_t size,
+		zbx_json_type_t *type)
 {
 	size_t		len;
 	zbx_json_type_t	type_local;
@@ -1001,7 +1030,7 @@ const char	*zbx_json_decodevalue(const char *p, char *string, size_t size, zbx_j
 			/* only primitive values are decoded */
 			return NULL;
 		default:
-			if (0 == (len = json_parse_value(p, NULL, 0, NULL)))
+			if (0 == (len = json_parse_value(p, end, NULL, 0, NULL)))
 				return NULL;
 	}
 
@@ -1011,7 +1040,7 @@ const char	*zbx_json_decodevalue(const char *p, char *string, size_t size, zbx_j
 	switch (type_local)
 	{
 		case ZBX_JSON_TYPE_STRING:
-			return json_copy_string(p, string, size);
+			return json_copy_string(p, p + len, string, size);
 		case ZBX_JSON_TYPE_NULL:
 			if (0 == size)
 				return NULL;
@@ -1022,7 +1051,28 @@ const char	*zbx_json_decodevalue(const char *p, char *string, size_t size, zbx_j
 	}
 }
 
-const char	*zbx_json_decodevalue_dyn(const char *p, char **string, size_t *string_alloc, zbx_json_type_t *type)
+const char	*zbx_json_decodevalue(const char *p, char *string, size_t size, zbx_json_type_t *type)
+{
+	return json_decodevalue(p, NULL, string, size, type);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: decodes primitive JSON value into dynamically allocated buffer    *
+ *                                                                            *
+ * Parameters: p            - [IN] the value                                  *
+ *             end          - [IN] end of enclosing JSON data, NULL if not    *
+ *                                 known                                      *
+ *             string       - [IN/OUT] the output buffer                      *
+ *             string_alloc - [IN/OUT] the output buffer size                 *
+ *             type         - [OUT] the value type (optional)                 *
+ *                                                                            *
+ * Return value: A pointer to the next character after the value or NULL if   *
+ *               value decoding failed.                                       *
+ *                                                                            *
+ ******************************************************************************/
+static const char	*json_decodevalue_dyn(const char *p, const char *end, char **string, size_t *string_alloc,
+		zbx_json_type_t *type)
 {
 	size_t		len;
 	zbx_json_type_t	type_local;
@@ -1035,7 +1085,7 @@ const char	*zbx_json_decodevalue_dyn(const char *p, char **string, size_t *strin
 			/* only primitive values are decoded */
 			return NULL;
 		default:
-			if (0 == (len = json_parse_value(p, NULL, 0, NULL)))
+			if (0 == (len = json_parse_value(p, end, NULL, 0, NULL)))
 				return NULL;
 	}
 
@@ -1051,7 +1101,7 @@ const char	*zbx_json_decodevalue_dyn(const char *p, char **string, size_t *strin
 	switch (type_local)
 	{
 		case ZBX_JSON_TYPE_STRING:
-			return json_copy_string(p, *string, *string_alloc);
+			return json_copy_string(p, p + len, *string, *string_alloc);
 		case ZBX_JSON_TYPE_NULL:
 			**string = '\0';
 			return p + len;
@@ -1060,6 +1110,11 @@ const char	*zbx_json_decodevalue_dyn(const char *p, char **string, size_t *strin
 	}
 }
 
+const char	*zbx_json_decodevalue_dyn(const char *p, char **string, size_t *string_alloc, zbx_json_type_t *type)
+{
+	return json_decodevalue_dyn(p, NULL, string, string_alloc, type);
+}
+
 const char	*zbx_json_pair_next(const struct zbx_json_parse *jp, const char *p, char *name, size_t len)
 {
 	if (NULL == (p = zbx_json_next(jp, p)))
@@ -1068,7 +1123,7 @@ const char	*zbx_json_pair_next(const struct zbx_json_parse *jp, const char *p, c
 	if (ZBX_JSON_TYPE_STRING != __zbx_json_type(p))
 		return NULL;
 
-	if (NULL == (p = json_copy_string(p, name, len)))
+	if (NULL == (p = json_copy_string(p, jp->end + 1, name, len)))
 		return NULL;
 
 	SKIP_WHITESPACE(p);
@@ -1110,7 +1165,7 @@ const char	*zbx_json_next_value(const struct zbx_json_parse *jp, const char *p,
 	if (NULL == (p = zbx_json_next(jp, p)))
 		return NULL;
 
-	return zbx_json_decodevalue(p, string, len, type);
+	return json_decodevalue(p, jp->end + 1, string, len, type);
 }
 
 const char	*zbx_json_next_value_dyn(const struct zbx_json_parse *jp, const char *p, char **string,
@@ -1119,7 +1174,7 @@ const char	*zbx_json_next_value_dyn(const struct zbx_json_parse *jp, const char
 	if (NULL == (p = zbx_json_next(jp, p)))
 		return NULL;
 
-	return zbx_json_decodevalue_dyn(p, string, string_alloc, type);
+	return json_decodevalue_dyn(p, jp->end + 1, string, string_alloc, type);
 }
 
 /******************************************************************************
@@ -1137,7 +1192,7 @@ int	zbx_json_value_by_name(const struct zbx_json_parse *jp, const char *name, ch
 	if (NULL == (p = zbx_json_pair_by_name(jp, name)))
 		return FAIL;
 
-	if (NULL == zbx_json_decodevalue(p, string, len, type))
+	if (NULL == json_decodevalue(p, jp->end + 1, string, len, type))
 		return FAIL;
 
 	return SUCCEED;
@@ -1158,21 +1213,25 @@ int	zbx_json_value_by_name_dyn(const struct zbx_json_parse *jp, const char *name
 	if (NULL == (p = zbx_json_pair_by_name(jp, name)))
 		return FAIL;
 
-	if (NULL == zbx_json_decodevalue_dyn(p, string, string_alloc, type))
+	if (NULL == json_decodevalue_dyn(p, jp->end + 1, string, string_alloc, type))
 		return FAIL;
 
 	return SUCCEED;
 }
 
 /******************************************************************************
+ *                                                                            *
+ * Parameters: p   - [IN] position of the left bracket                        *
+ *             end - [IN] end of enclosing JSON data, NULL if not known       *
+ *             jp  - [OUT] opened object or array                             *
  *                                                                            *
  * Return value: SUCCESS - processed successfully                             *
  *               FAIL - an error occurred                                     *
  *                                                                            *
  ******************************************************************************/
-int	zbx_json_brackets_open(const char *p, struct zbx_json_parse *jp)
+static int	json_brackets_open(const char *p, const char *end, struct zbx_json_parse *jp)
 {
-	if (NULL == (jp->end = __zbx_json_rbracket(p)))
+	if (NULL == (jp->end = __zbx_json_rbracket(p, end)))
 	{
 		zbx_set_json_strerror("cannot open JSON object or array \"%.64s\"", p);
 		return FAIL;
@@ -1185,6 +1244,17 @@ int	zbx_json_brackets_open(const char *p, struct zbx_json_parse *jp)
 	return SUCCEED;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Return value: SUCCESS - processed successfully                             *
+ *               FAIL - an error occurred                                     *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_json_brackets_open(const char *p, struct zbx_json_parse *jp)
+{
+	return json_brackets_open(p, NULL, jp);
+}
+
 /******************************************************************************
  *                                                                            *
  * Return value: SUCCESS - processed successfully                             *
@@ -1198,7 +1268,7 @@ int	zbx_json_brackets_by_name(const struct zbx_json_parse *jp, const char *name,
 	if (NULL == (p = zbx_json_pair_by_name(jp, name)))
 		return FAIL;
 
-	if (FAIL == zbx_json_brackets_open(p, out))
+	if (FAIL == json_brackets_open(p, jp->end + 1, out))
 		return FAIL;
 
 	return SUCCEED;
@@ -1261,7 +1331,7 @@ int	zbx_json_open_path(const struct zbx_json_parse *jp, const char *path, struct
 
 	for (i = 0; i < jsonpath.segments_num; i++)
 	{
-		const char		*p;
+		const char		*p, *end;
 		zbx_jsonpath_segment_t	*segment = &jsonpath.segments[i];
 
 		if (ZBX_JSONPATH_SEGMENT_MATCH_LIST != segment->type)
@@ -1297,10 +1367,11 @@ int	zbx_json_open_path(const struct zbx_json_parse *jp, const char *path, struct
 			}
 		}
 
+		end = object.end + 1;
 		object.start = p;
 
-		if (NULL == (object.end = __zbx_json_rbracket(p)))
-			object.end = p + json_parse_value(p, NULL, 0, NULL) - 1;
+		if (NULL == (object.end = __zbx_json_rbracket(p, end)))
+			object.end = p + json_parse_value(p, end, NULL, 0, NULL) - 1;
 	}
 
 	*out = object;
@@ -17,8 +17,9 @@
 
 #include "zbxstr.h"
 
+/* matches ZBX_WHITESPACE characters */
 #define SKIP_WHITESPACE(src)	\
-	while ('\0' != *(src) && NULL != strchr(ZBX_WHITESPACE, *(src))) (src)++
+	while (' ' == *(src) || '\t' == *(src) || '\r' == *(src) || '\n' == *(src)) (src)++
 
 /* can only be used on non empty string */
 #define SKIP_WHITESPACE_NEXT(src)\
@@ -27,7 +28,7 @@
 
 void	zbx_set_json_strerror(const char *fmt, ...) __zbx_attr_format_printf(1, 2);
 
-const char	*json_copy_string(const char *p, char *out, size_t size);
+const char	*json_copy_string(const char *p, const char *end, char *out, size_t size);
 unsigned int	zbx_json_decode_character(const char **p, unsigned char *bytes);
 
 #endif
@@ -15,6 +15,7 @@
 #include "json_parser.h"
 
 #include "json.h"
+#include "json_scan.h"
 #include "jsonobj.h"
 
 #include "zbxalgo.h"
@@ -54,6 +55,7 @@ zbx_int64_t	json_error(const char *message, const char *ptr, char **error)
  * Purpose: Parses JSON string value or object name                           *
  *                                                                            *
  * Parameters: start - [IN] the JSON data without leading whitespace          *
+ *             end   - [IN] the end of JSON data (can be NULL)                *
  *             str   - [OUT] the parsed unquoted string (can be NULL)         *
  *             error - [OUT] the parsing error message (can be NULL)          *
  *                                                                            *
@@ -62,14 +64,15 @@ zbx_int64_t	json_error(const char *message, const char *ptr, char **error)
  *               message.                                                     *
  *                                                                            *
  ******************************************************************************/
-static zbx_int64_t	json_parse_string(const char *start, char **str, char **error)
+static zbx_int64_t	json_parse_string(const char *start, const char *end, char **str, char **error)
 {
 	const char	*ptr = start;
 
 	/* skip starting '"' */
 	ptr++;
 
-	while ('"' != *ptr)
+	/* jump over plain characters, only quotes, escapes and control characters need attention */
+	while ('"' != *(ptr = json_scan_string(ptr, end)))
 	{
 		/* unexpected end of string data, failing */
 		if ('\0' == *ptr)
@@ -121,7 +124,7 @@ static zbx_int64_t	json_parse_string(const char *start, char **str, char **error
 	{
 		*str = (char *)zbx_malloc(NULL, (size_t)(ptr - start));
 
-		if (NULL == json_copy_string(start, *str, (size_t)(ptr - start)))
+		if (NULL == json_copy_string(start, ptr + 1, *str, (size_t)(ptr - start)))
 		{
 			zbx_free(*str);
 			return json_error("invalid string data", start, error);
@@ -136,6 +139,7 @@ static zbx_int64_t	json_parse_string(const char *start, char **str, char **error
  * Purpose: Parses JSON array value                                           *
  *                                                                            *
  * Parameters: start - [IN] the JSON data without leading whitespace          *
+ *             end   - [IN] the end of JSON data (can be NULL)                *
  *             obj   - [IN/OUT] the JSON object (can be NULL)                 *
  *             depth - [IN]                                                   *
  *             error - [OUT] the parsing error message (can be NULL)          *
@@ -145,7 +149,7 @@ static zbx_int64_t	json_parse_string(const char *start, char **str, char **error
  *               message.                                                     *
  *                                                                            *
  ******************************************************************************/
-zbx_int64_t	json_parse_array(const char *start, zbx_jsonobj_t *obj, int depth, char **error)
+zbx_int64_t	json_parse_array(const char *start, const char *end, zbx_jsonobj_t *obj, int depth, char **error)
 {
 	const char	*ptr = start;
 	zbx_int64_t	len;
@@ -171,7 +175,7 @@ zbx_int64_t	json_parse_array(const char *start, zbx_jsonobj_t *obj, int depth, c
 				value = NULL;
 
 			/* json_parse_value strips leading whitespace, so we don't have to do it here */
-			if (0 == (len = json_parse_value(ptr, value, depth, error)))
+			if (0 == (len = json_parse_value(ptr, end, value, depth, error)))
 			{
 				if (NULL != obj)
 				{
@@ -312,6 +316,7 @@ static zbx_int64_t	json_parse_literal(const char *start, const char *text, char
  * Purpose: Parses JSON object value                                          *
  *                                                                            *
  * Parameters: start - [IN] the JSON data                                     *
+ *             end   - [IN] the end of JSON data (can be NULL)                *
  *             obj   - [IN/OUT] JSON object (can be NULL)                     *
  *             depth - [IN]                                                   *
  *             error - [OUT] the parsing error message (can be NULL)          *
@@ -321,7 +326,7 @@ static zbx_int64_t	json_parse_literal(const char *start, const char *text, char
  *               message.                                                     *
  *                                                                            *
  ******************************************************************************/
-zbx_int64_t	json_parse_value(const char *start, zbx_jsonobj_t *obj, int depth, char **error)
+zbx_int64_t	json_parse_value(const char *start, const char *end, zbx_jsonobj_t *obj, int depth, char **error)
 {
 #define ZBX_MAX_JSON_DEPTH	64
 	const char	*ptr = start;
@@ -346,18 +351,18 @@ zbx_int64_t	json_parse_value(const char *start, zbx_jsonobj_t *obj, int depth, c
 		case '\0':
 			return json_error("unexpected end of object value", NULL, error);
 		case '"':
-			if (0 == (len = json_parse_string(ptr, (NULL != obj ? &str : NULL), error)))
+			if (0 == (len = json_parse_string(ptr, end, (NULL != obj ? &str : NULL), error)))
 				return 0;
 
 			if (NULL != obj)
 				jsonobj_set_string(obj, str);
 			break;
 		case '{':
-			if (0 == (len = json_parse_object(ptr, obj, depth, error)))
+			if (0 == (len = json_parse_object(ptr, end, obj, depth, error)))
 				return 0;
 			break;
 		case '[':
-			if (0 == (len = json_parse_array(ptr, obj, depth, error)))
+			if (0 == (len = json_parse_array(ptr, end, obj, depth, error)))
 				return 0;
 			break;
 		case 't':
@@ -412,6 +417,7 @@ zbx_int64_t	json_parse_value(const char *start, zbx_jsonobj_t *obj, int depth, c
  * Purpose: Parses JSON object                                                *
  *                                                                            *
  * Parameters: start - [IN] the JSON data                                     *
+ *             end   - [IN] the end of JSON data (can be NULL)                *
  *             obj   - [IN/OUT] the JSON object (can be NULL)                 *
  *             depth - [IN]                                                   *
  *             error - [OUT] the parsing error message (can be NULL)          *
@@ -421,7 +427,7 @@ zbx_int64_t	json_parse_value(const char *start, zbx_jsonobj_t *obj, int depth, c
  *               message.                                                     *
  *                                                                            *
  ******************************************************************************/
-zbx_int64_t	json_parse_object(const char *start, zbx_jsonobj_t *obj, int depth, char **error)
+zbx_int64_t	json_parse_object(const char *start, const char *end, zbx_jsonobj_t *obj, int depth, char **error)
 {
 	const char		*ptr = start;
 	zbx_int64_t		len;
@@ -447,7 +453,7 @@ zbx_int64_t	json_parse_object(const char *start, zbx_jsonobj_t *obj, int depth,
 			jsonobj_el_init(&el);
 
 			/* cannot parse object name, failing */
-			if (0 == (len = json_parse_string(ptr, (NULL != obj ? &el.name : NULL), error)))
+			if (0 == (len = json_parse_string(ptr, end, (NULL != obj ? &el.name : NULL), error)))
 				return 0;
 
 			ptr += len;
@@ -463,7 +469,7 @@ zbx_int64_t	json_parse_object(const char *start, zbx_jsonobj_t *obj, int depth,
 
 			ptr++;
 
-			if (0 == (len = json_parse_value(ptr, (NULL != obj ? &el.value : NULL), depth, error)))
+			if (0 == (len = json_parse_value(ptr, end, (NULL != obj ? &el.value : NULL), depth, error)))
 			{
 				jsonobj_el_clear(&el);
 				return 0;
@@ -521,18 +527,22 @@ zbx_int64_t	json_parse_object(const char *start, zbx_jsonobj_t *obj, int depth,
 zbx_int64_t	zbx_json_validate(const char *start, char **error)
 {
 	zbx_int64_t	len;
+	const char	*end;
 
 	/* parse object name */
 	SKIP_WHITESPACE(start);
 
+	/* data end is needed to scan it in blocks without reading past terminating zero */
+	end = start + strlen(start);
+
 	switch (*start)
 	{
 		case '{':
-			if (0 == (len = json_parse_object(start, NULL, 0, error)))
+			if (0 == (len = json_parse_object(start, end, NULL, 0, error)))
 				return 0;
 			break;
 		case '[':
-			if (0 == (len = json_parse_array(start, NULL, 0, error)))
+			if (0 == (len = json_parse_array(start, end, NULL, 0, error)))
 				return 0;
 			break;
 		default:
@@ -21,11 +21,11 @@
 
 zbx_int64_t	zbx_json_validate(const char *start, char **error);
 
-zbx_int64_t	json_parse_value(const char *start, zbx_jsonobj_t *obj, int depth, char **error);
+zbx_int64_t	json_parse_value(const char *start, const char *end, zbx_jsonobj_t *obj, int depth, char **error);
 
 zbx_int64_t	json_error(const char *message, const char *ptr, char **error);
 
-zbx_int64_t	json_parse_object(const char *start, zbx_jsonobj_t *obj, int depth, char **error);
-zbx_int64_t	json_parse_array(const char *start, zbx_jsonobj_t *obj, int depth, char **error);
+zbx_int64_t	json_parse_object(const char *start, const char *end, zbx_jsonobj_t *obj, int depth, char **error);
+zbx_int64_t	json_parse_array(const char *start, const char *end, zbx_jsonobj_t *obj, int depth, char **error);
 
 #endif
@@ -0,0 +1,171 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "json_scan.h"
+
+#include "zbxcommon.h"
+
+#if defined(__SSE2__) && defined(__GNUC__)
+#	define JSON_SCAN_SSE2
+#	include <emmintrin.h>
+#endif
+
+#define JSON_SCAN_STRING(p)									\
+	while ('"' != *(p) && '\\' != *(p) && 0x1f < (unsigned char)*(p))				\
+		(p)++
+
+#define JSON_SCAN_STRUCTURAL(p)									\
+	while ('\0' != *(p) && NULL == strchr("\",[]{}", *(p)))					\
+		(p)++
+
+#ifdef JSON_SCAN_SSE2
+
+#define JSON_SCAN_BLOCK_SIZE	16
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns bit mask of string terminating characters in the block    *
+ *                                                                            *
+ * Comments: String terminating characters are '"', '\\' and control          *
+ *           characters U+0000 - U+001F.                                      *
+ *                                                                            *
+ ******************************************************************************/
+static unsigned int	json_scan_string_mask(__m128i block)
+{
+	__m128i	quote, backslash, control;
+
+	quote = _mm_cmpeq_epi8(block, _mm_set1_epi8('"'));
+	backslash = _mm_cmpeq_epi8(block, _mm_set1_epi8('\\'));
+	/* unsigned block <= 0x1f check */
+	control = _mm_cmpeq_epi8(_mm_min_epu8(block, _mm_set1_epi8(0x1f)), block);
+
+	return (unsigned int)_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(quote, backslash), control));
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns bit mask of structural characters in the block            *
+ *                                                                            *
+ * Comments: Structural characters are '"', ',', '[', ']', '{', '}' and '\0'. *
+ *           Brackets differ from braces only by 0x20 bit, so they are        *
+ *           matched after setting it.                                        *
+ *                                                                            *
+ ******************************************************************************/
+static unsigned int	json_scan_structural_mask(__m128i block)
+{
+	__m128i	quote, comma, zero, lower, lbrace, rbrace;
+
+	quote = _mm_cmpeq_epi8(block, _mm_set1_epi8('"'));
+	comma = _mm_cmpeq_epi8(block, _mm_set1_epi8(','));
+	zero = _mm_cmpeq_epi8(block, _mm_setzero_si128());
+
+	lower = _mm_or_si128(block, _mm_set1_epi8(0x20));
+	lbrace = _mm_cmpeq_epi8(lower, _mm_set1_epi8('{'));
+	rbrace = _mm_cmpeq_epi8(lower, _mm_set1_epi8('}'));
+
+	return (unsigned int)_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(_mm_or_si128(quote, comma), zero),
+			_mm_or_si128(lbrace, rbrace)));
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finds the first character matched by mask function in the blocks *
+ *          lying entirely before the end of data                             *
+ *                                                                            *
+ * Parameters: p         - [IN/OUT] position to scan from, the matched        *
+ *                                  character or the rest of data on return   *
+ *             end       - [IN] end of data                                   *
+ *             mask_func - [IN] function returning bit mask of matched        *
+ *                              characters in the block                       *
+ *                                                                            *
+ * Return value: SUCCEED - matching character was found                       *
+ *               FAIL    - less than a block of data is left, it must be      *
+ *                         scanned by scalar loop                             *
+ *                                                                            *
+ * Comments: Only bytes before end are read, so terminating zero is never     *
+ *           passed.                                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	json_scan_blocks(const char **p, const char *end, unsigned int (*mask_func)(__m128i))
+{
+	const char	*block;
+	unsigned int	mask;
+
+	for (block = *p; JSON_SCAN_BLOCK_SIZE <= end - block; block += JSON_SCAN_BLOCK_SIZE)
+	{
+		if (0 != (mask = mask_func(_mm_loadu_si128((const __m128i *)block))))
+		{
+			*p = block + __builtin_ctz(mask);
+			return SUCCEED;
+		}
+	}
+
+	*p = block;
+
+	return FAIL;
+}
+
+#endif
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finds the next character inside JSON string requiring attention   *
+ *                                                                            *
+ * Parameters: p   - [IN] position inside string data                         *
+ *             end - [IN] end of data that can be read in blocks (terminating *
+ *                        zero or the position following enclosing JSON       *
+ *                        object), NULL if not known                          *
+ *                                                                            *
+ * Return value: pointer to the first '"', '\\' or control character          *
+ *               (including terminating zero) starting with p                 *
+ *                                                                            *
+ ******************************************************************************/
+const char	*json_scan_string(const char *p, const char *end)
+{
+#ifdef JSON_SCAN_SSE2
+	if (NULL != end && SUCCEED == json_scan_blocks(&p, end, json_scan_string_mask))
+		return p;
+#else
+	ZBX_UNUSED(end);
+#endif
+	JSON_SCAN_STRING(p);
+
+	return p;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finds the next structural character outside JSON string           *
+ *                                                                            *
+ * Parameters: p   - [IN] position outside string data                        *
+ *             end - [IN] end of data that can be read in blocks (terminating *
+ *                        zero or the position following enclosing JSON       *
+ *                        object), NULL if not known                          *
+ *                                                                            *
+ * Return value: pointer to the first '"', ',', '[', ']', '{', '}' or         *
+ *               terminating zero starting with p                             *
+ *                                                                            *
+ ******************************************************************************/
+const char	*json_scan_structural(const char *p, const char *end)
+{
+#ifdef JSON_SCAN_SSE2
+	if (NULL != end && SUCCEED == json_scan_blocks(&p, end, json_scan_structural_mask))
+		return p;
+#else
+	ZBX_UNUSED(end);
+#endif
+	JSON_SCAN_STRUCTURAL(p);
+
+	return p;
+}
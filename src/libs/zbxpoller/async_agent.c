@@ -22,11 +22,308 @@
 #include "zbxself.h"
 #include "zbxagentget.h"
 #include "zbxversion.h"
+#include "zbxalgo.h"
+#include "zbxstr.h"
 
 #if defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
 #	include "zbxip.h"
 #endif
 
+#define ZBX_AGENT_POOL_CONNS_MAX	2
+
+/* idle connection kept open by agent after response */
+typedef struct
+{
+	ZBX_SOCKET		socket;
+#if defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
+	zbx_tls_context_t	*tls_ctx;
+#endif
+	unsigned int		connection_type;
+	char			peer[ZBX_MAX_DNSNAME_LEN + 1];
+	time_t			expires;
+}
+zbx_agent_conn_t;
+
+/* idle connections of interface, reused only with the same connection parameters */
+typedef struct
+{
+	zbx_uint64_t		interfaceid;
+	char			*addr;
+	unsigned short		port;
+	unsigned char		tls_connect;
+	char			*tls_arg1;
+	char			*tls_arg2;
+	zbx_agent_conn_t	conns[ZBX_AGENT_POOL_CONNS_MAX];
+	int			conns_num;
+}
+zbx_agent_pool_entry_t;
+
+static ZBX_THREAD_LOCAL zbx_hashset_t	*agent_pool = NULL;
+static ZBX_THREAD_LOCAL int		agent_keep_alive;
+
+static void	agent_conn_close(zbx_agent_conn_t *conn)
+{
+	zbx_socket_t	s;
+
+	zbx_socket_clean(&s);
+	s.socket = conn->socket;
+#if defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
+	s.tls_ctx = conn->tls_ctx;
+#endif
+	s.connection_type = conn->connection_type;
+	s.timeout = 1;
+	zbx_strlcpy(s.peer, conn->peer, sizeof(s.peer));
+
+	zbx_tcp_close(&s);
+}
+
+static void	agent_pool_entry_flush(zbx_agent_pool_entry_t *entry)
+{
+	int	i;
+
+	for (i = 0; i < entry->conns_num; i++)
+		agent_conn_close(&entry->conns[i]);
+
+	entry->conns_num = 0;
+}
+
+static void	agent_pool_entry_clear(void *data)
+{
+	zbx_agent_pool_entry_t	*entry = (zbx_agent_pool_entry_t *)data;
+
+	agent_pool_entry_flush(entry);
+	zbx_free(entry->addr);
+	zbx_free(entry->tls_arg1);
+	zbx_free(entry->tls_arg2);
+}
+
+static int	agent_pool_entry_match(const zbx_agent_pool_entry_t *entry, const zbx_agent_context *agent_context)
+{
+	if (0 != strcmp(entry->addr, agent_context->item.interface.addr) ||
+			entry->port != agent_context->item.interface.port ||
+			entry->tls_connect != agent_context->tls_connect ||
+			0 != zbx_strcmp_null(entry->tls_arg1, agent_context->tls_arg1) ||
+			0 != zbx_strcmp_null(entry->tls_arg2, agent_context->tls_arg2))
+	{
+		return FAIL;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if idle connection was not closed by agent                 *
+ *                                                                            *
+ * Comments: Agent does not send anything on idle connection, so any pending  *
+ *           data means shutdown (or TLS close notification) from agent.      *
+ *                                                                            *
+ ******************************************************************************/
+static int	agent_conn_is_alive(const zbx_agent_conn_t *conn)
+{
+	char	c;
+
+	if (-1 == recv(conn->socket, &c, 1, MSG_PEEK | MSG_DONTWAIT) && (EAGAIN == errno || EWOULDBLOCK == errno))
+		return SUCCEED;
+
+	return FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets idle connection to item interface from pool                  *
+ *                                                                            *
+ * Parameters: agent_context - [IN/OUT] socket is set on success              *
+ *                                                                            *
+ * Return value: SUCCEED - connection was taken from pool                     *
+ *               FAIL    - no usable connection in pool                       *
+ *                                                                            *
+ ******************************************************************************/
+static int	agent_pool_acquire(zbx_agent_context *agent_context)
+{
+	zbx_agent_pool_entry_t	*entry;
+	time_t			now;
+
+	if (NULL == agent_pool || NULL == (entry = (zbx_agent_pool_entry_t *)zbx_hashset_search(agent_pool,
+			&agent_context->item.interface.interfaceid)))
+	{
+		return FAIL;
+	}
+
+	if (SUCCEED != agent_pool_entry_match(entry, agent_context))
+	{
+		/* interface or host encryption settings were changed, connections cannot be reused */
+		zbx_hashset_remove_direct(agent_pool, entry);
+		return FAIL;
+	}
+
+	now = time(NULL);
+
+	while (0 != entry->conns_num)
+	{
+		zbx_agent_conn_t	*conn = &entry->conns[--entry->conns_num];
+
+		if (conn->expires <= now || SUCCEED != agent_conn_is_alive(conn))
+		{
+			agent_conn_close(conn);
+			continue;
+		}
+
+		zbx_socket_clean(&agent_context->s);
+		agent_context->s.socket = conn->socket;
+#if defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
+		agent_context->s.tls_ctx = conn->tls_ctx;
+#endif
+		agent_context->s.connection_type = conn->connection_type;
+		agent_context->s.timeout = agent_context->config_timeout;
+		zbx_strlcpy(agent_context->s.peer, conn->peer, sizeof(agent_context->s.peer));
+		zbx_socket_set_deadline(&agent_context->s, agent_context->config_timeout);
+
+		return SUCCEED;
+	}
+
+	return FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns connection kept open by agent to pool                     *
+ *                                                                            *
+ * Parameters: agent_context - [IN/OUT] socket is detached from context if    *
+ *                                      connection was added to pool          *
+ *             keep_alive    - [IN] seconds agent keeps connection open       *
+ *                                                                            *
+ ******************************************************************************/
+static void	agent_pool_release(zbx_agent_context *agent_context, int keep_alive)
+{
+	zbx_agent_pool_entry_t	*entry;
+	zbx_agent_conn_t	*conn;
+	char			*buffer;
+
+	if (NULL != (entry = (zbx_agent_pool_entry_t *)zbx_hashset_search(agent_pool,
+			&agent_context->item.interface.interfaceid)) &&
+			SUCCEED != agent_pool_entry_match(entry, agent_context))
+	{
+		zbx_hashset_remove_direct(agent_pool, entry);
+		entry = NULL;
+	}
+
+	if (NULL == entry)
+	{
+		zbx_agent_pool_entry_t	entry_local = {.interfaceid = agent_context->item.interface.interfaceid};
+
+		entry = (zbx_agent_pool_entry_t *)zbx_hashset_insert(agent_pool, &entry_local, sizeof(entry_local));
+		entry->addr = zbx_strdup(NULL, agent_context->item.interface.addr);
+		entry->port = agent_context->item.interface.port;
+		entry->tls_connect = agent_context->tls_connect;
+		entry->tls_arg1 = (NULL != agent_context->tls_arg1 ? zbx_strdup(NULL, agent_context->tls_arg1) : NULL);
+		entry->tls_arg2 = (NULL != agent_context->tls_arg2 ? zbx_strdup(NULL, agent_context->tls_arg2) : NULL);
+	}
+
+	if (ZBX_AGENT_POOL_CONNS_MAX == entry->conns_num)
+		return;
+
+	conn = &entry->conns[entry->conns_num++];
+	conn->socket = agent_context->s.socket;
+#if defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
+	conn->tls_ctx = agent_context->s.tls_ctx;
+#endif
+	conn->connection_type = agent_context->s.connection_type;
+	zbx_strlcpy(conn->peer, agent_context->s.peer, sizeof(conn->peer));
+
+	/* leave a second of margin so that agent does not close connection while request is being sent */
+	conn->expires = time(NULL) + keep_alive - 1;
+
+	/* detach connection from context, so that closing context socket is no-op */
+	buffer = zbx_socket_detach_buffer(&agent_context->s);
+	zbx_free(buffer);
+	zbx_socket_clean(&agent_context->s);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: handles failure on reused connection which was closed by agent    *
+ *          while idle - other idle connections to the interface are closed   *
+ *          and check is retried with new connection                          *
+ *                                                                            *
+ ******************************************************************************/
+static void	agent_reconnect(zbx_agent_context *agent_context)
+{
+	zbx_agent_pool_entry_t	*entry;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "reused connection was closed by agent, itemid:" ZBX_FS_UI64,
+			agent_context->item.itemid);
+
+	if (NULL != (entry = (zbx_agent_pool_entry_t *)zbx_hashset_search(agent_pool,
+			&agent_context->item.interface.interfaceid)))
+	{
+		agent_pool_entry_flush(entry);
+	}
+
+	agent_context->reused = 0;
+	agent_context->step = ZABBIX_AGENT_STEP_CONNECT_INIT;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: enables keeping agent connections open between checks             *
+ *                                                                            *
+ * Parameters: keep_alive - [IN] seconds to ask agent to keep connection open *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_async_agent_pool_init(int keep_alive)
+{
+	agent_pool = (zbx_hashset_t *)zbx_malloc(NULL, sizeof(zbx_hashset_t));
+	zbx_hashset_create_ext(agent_pool, 100, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC,
+			agent_pool_entry_clear, ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC,
+			ZBX_DEFAULT_MEM_FREE_FUNC);
+	agent_keep_alive = keep_alive;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: closes idle connections which agent is going to close             *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_async_agent_pool_housekeep(void)
+{
+	static ZBX_THREAD_LOCAL time_t	last_hk;
+	zbx_hashset_iter_t		iter;
+	zbx_agent_pool_entry_t		*entry;
+	time_t				now;
+
+	if (NULL == agent_pool || last_hk == (now = time(NULL)))
+		return;
+
+	last_hk = now;
+
+	zbx_hashset_iter_reset(agent_pool, &iter);
+	while (NULL != (entry = (zbx_agent_pool_entry_t *)zbx_hashset_iter_next(&iter)))
+	{
+		int	i, conns_num = 0;
+
+		for (i = 0; i < entry->conns_num; i++)
+		{
+			if (entry->conns[i].expires <= now)
+				agent_conn_close(&entry->conns[i]);
+			else
+				entry->conns[conns_num++] = entry->conns[i];
+		}
+
+		if (0 == (entry->conns_num = conns_num))
+			zbx_hashset_iter_remove(&iter);
+	}
+}
+
+void	zbx_async_agent_pool_destroy(void)
+{
+	if (NULL == agent_pool)
+		return;
+
+	zbx_hashset_destroy(agent_pool);
+	zbx_free(agent_pool);
+}
+
 static const char	*get_agent_step_string(zbx_zabbix_agent_step_t step)
 {
 	switch (step)
@@ -137,6 +434,21 @@ static int	agent_task_process(short event, void *data, int *fd, const char *addr
 					ZBX_TCP_PROTOCOL, &agent_context->tcp_send_context);
 			}
 
+			if (0 != agent_keep_alive && ZBX_COMPONENT_VERSION(7, 0, 0) <= agent_context->item.version &&
+					SUCCEED == agent_pool_acquire(agent_context))
+			{
+				zabbix_log(LOG_LEVEL_DEBUG, "%s() reusing connection itemid:" ZBX_FS_UI64, __func__,
+						agent_context->item.itemid);
+
+				agent_context->reused = 1;
+				agent_context->step = ZABBIX_AGENT_STEP_SEND;
+				*fd = agent_context->s.socket;
+
+				return ZBX_ASYNC_TASK_WRITE;
+			}
+
+			agent_context->reused = 0;
+
 			if (SUCCEED != zbx_socket_connect(&agent_context->s, SOCK_STREAM,
 					agent_context->config_source_ip, addr, agent_context->item.interface.port,
 					agent_context->config_timeout))
@@ -214,6 +526,12 @@ static int	agent_task_process(short event, void *data, int *fd, const char *addr
 					return state;
 				}
 
+				if (0 != agent_context->reused)
+				{
+					agent_reconnect(agent_context);
+					break;
+				}
+
 				SET_MSG_RESULT(&agent_context->item.result, zbx_dsprintf(NULL, "Get value from agent"
 						" failed: cannot send: %s", zbx_socket_strerror()));
 				agent_context->item.ret = NETWORK_ERROR;
@@ -229,6 +547,12 @@ static int	agent_task_process(short event, void *data, int *fd, const char *addr
 			if (FAIL != (received_len = zbx_tcp_recv_context(&agent_context->s,
 					&agent_context->tcp_recv_context, agent_context->item.flags, &event_new)))
 			{
+				if (0 == received_len && 0 != agent_context->reused)
+				{
+					agent_reconnect(agent_context);
+					break;
+				}
+
 				if (FAIL == (agent_context->item.ret = zbx_agent_handle_response(
 						agent_context->s.buffer, agent_context->s.read_bytes, received_len,
 						agent_context->item.interface.addr, &agent_context->item.result,
@@ -237,6 +561,14 @@ static int	agent_task_process(short event, void *data, int *fd, const char *addr
 					/* retry with other protocol */
 					agent_context->step = ZABBIX_AGENT_STEP_CONNECT_INIT;
 				}
+				else if (0 != agent_keep_alive &&
+						ZBX_COMPONENT_VERSION(7, 0, 0) <= agent_context->item.version)
+				{
+					int	keep_alive;
+
+					if (1 < (keep_alive = zbx_agent_get_keep_alive(agent_context->s.buffer)))
+						agent_pool_release(agent_context, keep_alive);
+				}
 
 				if (ZABBIX_ASYNC_RESOLVE_REVERSE_DNS_YES == agent_context->resolve_reverse_dns &&
 						SUCCEED == agent_context->item.ret)
@@ -251,6 +583,12 @@ static int	agent_task_process(short event, void *data, int *fd, const char *addr
 			if (ZBX_ASYNC_TASK_STOP != (state = zbx_async_poller_get_task_state_for_event(event_new)))
 				return state;
 
+			if (0 != agent_context->reused)
+			{
+				agent_reconnect(agent_context);
+				break;
+			}
+
 			SET_MSG_RESULT(&agent_context->item.result, zbx_dsprintf(NULL, "Get value from agent failed:"
 					" cannot read response: %s", zbx_socket_strerror()));
 			agent_context->item.ret = NETWORK_ERROR;
@@ -363,8 +701,14 @@ int	zbx_async_check_agent(zbx_dc_item_t *item, AGENT_RESULT *result,  zbx_async_
 #endif
 
 	if (ZBX_COMPONENT_VERSION(7, 0, 0) <= agent_context->item.version)
+	{
 		zbx_agent_prepare_request(&agent_context->j, agent_context->item.key, item->timeout);
 
+		if (0 != agent_keep_alive)
+			zbx_agent_request_keep_alive(&agent_context->j, agent_keep_alive);
+	}
+
+	agent_context->reused = 0;
 	agent_context->step = ZABBIX_AGENT_STEP_CONNECT_INIT;
 
 	zbx_async_poller_add_task(base, dnsbase, agent_context->item.interface.addr, agent_context, item->timeout + 1,
@@ -39,6 +39,7 @@ typedef struct
 	zbx_tcp_recv_context_t		tcp_recv_context;
 	zbx_tcp_send_context_t		tcp_send_context;
 	zbx_zabbix_agent_step_t		step;
+	int				reused;
 	char				*server_name;
 	char				*tls_arg1;
 	char				*tls_arg2;
@@ -57,4 +58,8 @@ int	zbx_async_check_agent(zbx_dc_item_t *item, AGENT_RESULT *result,  zbx_async_
 		const char *config_source_ip, zbx_async_resolve_reverse_dns_t resolve_reverse_dns);
 void	zbx_async_check_agent_clean(zbx_agent_context *agent_context);
 
+void	zbx_async_agent_pool_init(int keep_alive);
+void	zbx_async_agent_pool_housekeep(void);
+void	zbx_async_agent_pool_destroy(void);
+
 #endif
@@ -260,7 +260,18 @@ static void	async_initiate_queued_checks(zbx_poller_config_t *poller_config, con
 		num = poller_items.values[j]->num;
 
 		total += num;
+#ifdef HAVE_NETSNMP
+		if (ZBX_POLLER_TYPE_SNMP == poller_config->poller_type)
+		{
+			zbx_set_snmp_bulkwalk_options(zbx_progname);
 
+			/* GET checks of the same interface in this batch are coalesced into multi-variable */
+			/* requests, checks from other batches are not waited for                           */
+			zbx_async_check_snmp_items(items, results, errcodes, num, process_snmp_result, poller_config,
+					poller_config, poller_config->base, poller_config->dnsbase,
+					poller_config->config_source_ip);
+		}
+#endif
 		for (int i = 0; i < num; i++)
 		{
 			if (SUCCEED != errcodes[i])
@@ -289,12 +300,7 @@ static void	async_initiate_queued_checks(zbx_poller_config_t *poller_config, con
 			else
 			{
 	#ifdef HAVE_NETSNMP
-				zbx_set_snmp_bulkwalk_options(zbx_progname);
-
-				errcodes[i] = zbx_async_check_snmp(&items[i], &results[i], process_snmp_result,
-						poller_config, poller_config, poller_config->base,
-						poller_config->dnsbase, poller_config->config_source_ip,
-						ZABBIX_ASYNC_RESOLVE_REVERSE_DNS_NO);
+				/* already started by zbx_async_check_snmp_items() */
 	#else
 				errcodes[i] = NOTSUPPORTED;
 				SET_MSG_RESULT(&results[i], zbx_strdup(NULL, "Support for SNMP checks was not compiled"
@@ -380,6 +386,7 @@ static void	async_poller_init(zbx_poller_config_t *poller_config, zbx_thread_pol
 	poller_config->config_unreachable_period = poller_args_in->config_unreachable_period;
 	poller_config->config_max_concurrent_checks_per_poller =
 			poller_args_in->config_max_concurrent_checks_per_poller;
+	poller_config->config_agent_keep_alive = poller_args_in->config_agent_keep_alive;
 	poller_config->clear_cache = 0;
 	poller_config->process_num = process_num;
 
@@ -559,6 +566,13 @@ ZBX_THREAD_ENTRY(zbx_async_poller_thread, args)
 				poller_args_in->zbx_get_program_type_cb_arg,
 				zbx_dc_get_psk_by_identity);
 #endif
+		if (0 != poller_config.config_agent_keep_alive)
+		{
+			zbx_async_agent_pool_init(poller_config.config_agent_keep_alive);
+#if defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
+			zbx_tls_enable_session_resumption();
+#endif
+		}
 	}
 	else
 	{
@@ -598,6 +612,9 @@ ZBX_THREAD_ENTRY(zbx_async_poller_thread, args)
 		if (ZBX_IS_RUNNING())
 			zbx_preprocessor_flush();
 
+		if (ZBX_POLLER_TYPE_AGENT == poller_type)
+			zbx_async_agent_pool_housekeep();
+
 		if (STAT_INTERVAL <= time(NULL) - last_stat_time)
 		{
 			zbx_update_env(get_process_type_string(process_type), zbx_time());
@@ -645,6 +662,8 @@ ZBX_THREAD_ENTRY(zbx_async_poller_thread, args)
 		if (ZBX_POLLER_TYPE_SNMP == poller_type)
 			zbx_destroy_snmp_engineid_cache();
 #endif
+		if (ZBX_POLLER_TYPE_AGENT == poller_type)
+			zbx_async_agent_pool_destroy();
 
 		async_poller_dns_destroy(&poller_config);
 	}
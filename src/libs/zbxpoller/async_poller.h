@@ -35,6 +35,7 @@ typedef struct
 	int			config_unreachable_delay;
 	int			config_unreachable_period;
 	int			config_max_concurrent_checks_per_poller;
+	int			config_agent_keep_alive;
 	int			config_timeout;
 	const char		*config_source_ip;
 	const char		*config_ssl_ca_location;
@@ -152,6 +152,9 @@ zbx_bulkwalk_context_t;
 ZBX_PTR_VECTOR_DECL(bulkwalk_context, zbx_bulkwalk_context_t*)
 ZBX_PTR_VECTOR_IMPL(bulkwalk_context, zbx_bulkwalk_context_t*)
 
+ZBX_PTR_VECTOR_DECL(snmp_context, zbx_snmp_context_t *)
+ZBX_PTR_VECTOR_IMPL(snmp_context, zbx_snmp_context_t *)
+
 struct zbx_snmp_context
 {
 	void				*arg;
@@ -181,8 +184,29 @@ struct zbx_snmp_context
 	zbx_async_resolve_reverse_dns_t	resolve_reverse_dns;
 	zbx_async_rdns_step_t		step;
 	char				*reverse_dns;
+
+	/* GET checks of the same interface coalesced into multi-variable requests of this context */
+	zbx_vector_snmp_context_t	coalesced;
+	zbx_async_task_clear_cb_t	clear_cb;
+	int				*vars;		/* bulkwalk context indexes of the request variables */
+	int				vars_num;
+	int				vars_max;
+	int				max_succeed;
+	int				min_fail;
+	char				*error;
 };
 
+/* number of coalesced GET checks relative to the suggested number of variables per request */
+#define ZBX_SNMP_GET_REQUESTS_MAX	4
+
+typedef struct
+{
+	zbx_uint64_t		interfaceid;
+	int			timeout;
+	zbx_snmp_context_t	*snmp_context;
+}
+zbx_snmp_coalesce_t;
+
 typedef struct
 {
 	AGENT_RESULT		*result;
@@ -2667,6 +2691,30 @@ out:
 	return ret;
 }
 
+static int	snmp_operation_to_status(int operation, int *status)
+{
+	switch (operation)
+	{
+		case NETSNMP_CALLBACK_OP_RECEIVED_MESSAGE:
+			*status = STAT_SUCCESS;
+			break;
+		case NETSNMP_CALLBACK_OP_TIMED_OUT:
+			*status = STAT_TIMEOUT;
+			break;
+		case NETSNMP_CALLBACK_OP_SEND_FAILED:
+		case NETSNMP_CALLBACK_OP_DISCONNECT:
+		case NETSNMP_CALLBACK_OP_SEC_ERROR:
+			*status = STAT_ERROR;
+			break;
+		case NETSNMP_CALLBACK_OP_CONNECT:
+		case NETSNMP_CALLBACK_OP_RESEND:
+		default:
+			return FAIL;
+	}
+
+	return SUCCEED;
+}
+
 static int	asynch_response(int operation, struct snmp_session *sp, int reqid, struct snmp_pdu *pdu, void *magic)
 {
 	zbx_bulkwalk_context_t	*bulkwalk_context;
@@ -2698,24 +2746,8 @@ static int	asynch_response(int operation, struct snmp_session *sp, int reqid, st
 		goto out;
 	}
 
-	switch (operation)
-	{
-		case NETSNMP_CALLBACK_OP_RECEIVED_MESSAGE:
-			stat = STAT_SUCCESS;
-			break;
-		case NETSNMP_CALLBACK_OP_TIMED_OUT:
-			stat = STAT_TIMEOUT;
-			break;
-		case NETSNMP_CALLBACK_OP_SEND_FAILED:
-		case NETSNMP_CALLBACK_OP_DISCONNECT:
-		case NETSNMP_CALLBACK_OP_SEC_ERROR:
-			stat = STAT_ERROR;
-			break;
-		case NETSNMP_CALLBACK_OP_CONNECT:
-		case NETSNMP_CALLBACK_OP_RESEND:
-		default:
-			goto out;
-	}
+	if (SUCCEED != snmp_operation_to_status(operation, &stat))
+		goto out;
 
 	if (NULL != pdu)
 	{
@@ -2739,6 +2771,239 @@ out:
 	return 1;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reduces number of variables in coalesced GET request after device *
+ *          failed to process it                                              *
+ *                                                                            *
+ ******************************************************************************/
+static void	snmp_get_reduce(zbx_snmp_context_t *snmp_context)
+{
+	if (snmp_context->min_fail > snmp_context->vars_num)
+		snmp_context->min_fail = snmp_context->vars_num;
+
+	snmp_context->vars_max = MAX(1, snmp_context->vars_num / 2);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "%s() host:'%s' vars_num:%d vars_max:%d", __func__, snmp_context->item.host,
+			snmp_context->vars_num, snmp_context->vars_max);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sets error of single variable of coalesced GET request            *
+ *                                                                            *
+ ******************************************************************************/
+static void	snmp_get_set_error(zbx_bulkwalk_context_t *bulkwalk_context, const char *error)
+{
+	bulkwalk_context->error = zbx_strdup(bulkwalk_context->error, error);
+	bulkwalk_context->running = 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: formats error of OID that was not received in time                *
+ *                                                                            *
+ ******************************************************************************/
+static char	*snmp_timeout_error(const zbx_snmp_context_t *snmp_context,
+		const zbx_bulkwalk_context_t *bulkwalk_context)
+{
+	char	buffer[MAX_OID_LEN];
+
+	snprint_objid(buffer, sizeof(buffer), bulkwalk_context->name, bulkwalk_context->name_length);
+
+	if (ZBX_IF_SNMP_VERSION_3 == snmp_context->snmp_version && 0 == snmp_context->probe)
+	{
+		return zbx_dsprintf(NULL, "Probe successful, cannot retrieve OID: '%s' from [[%s]:%hu]: timed out",
+				buffer, snmp_context->item.interface.addr, snmp_context->item.interface.port);
+	}
+
+	return zbx_dsprintf(NULL, "cannot retrieve OID: '%s' from [[%s]:%hu]: timed out", buffer,
+			snmp_context->item.interface.addr, snmp_context->item.interface.port);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: handles timeout of coalesced GET request                          *
+ *                                                                            *
+ * Return value: SUCCEED - request must be retried with fewer variables       *
+ *               FAIL    - request of single variable timed out, unfinished   *
+ *                         checks get timeout error of their own OID          *
+ *                                                                            *
+ * Comments: Timeout is counted per request, so the number of variables is    *
+ *           reduced only for the request that was not answered.              *
+ *                                                                            *
+ ******************************************************************************/
+static int	snmp_get_handle_timeout(zbx_snmp_context_t *snmp_context)
+{
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() vars_num:%d", __func__, snmp_context->vars_num);
+
+	/* some devices do not respond to requests with too many variables */
+	if (1 < snmp_context->vars_num && 0 == snmp_context->probe)
+	{
+		snmp_get_reduce(snmp_context);
+		return SUCCEED;
+	}
+
+	for (int i = snmp_context->i; i < snmp_context->bulkwalk_contexts.values_num; i++)
+	{
+		zbx_bulkwalk_context_t	*bulkwalk_context = snmp_context->bulkwalk_contexts.values[i];
+
+		if (0 == bulkwalk_context->running)
+			continue;
+
+		zbx_free(bulkwalk_context->error);
+		bulkwalk_context->error = snmp_timeout_error(snmp_context, bulkwalk_context);
+	}
+
+	return FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: distributes coalesced GET response variables between checks       *
+ *          requesting them                                                   *
+ *                                                                            *
+ * Parameters: snmp_context - [IN] context of coalesced checks                *
+ *             status       - [IN] response status                            *
+ *             response     - [IN]                                            *
+ *                                                                            *
+ * Comments: Request is retried with fewer variables if device could not      *
+ *           process it. Errors of single variable are set to the check       *
+ *           requesting it, while other errors fail all unfinished checks.    *
+ *                                                                            *
+ ******************************************************************************/
+static void	snmp_get_handle_response(zbx_snmp_context_t *snmp_context, int status, struct snmp_pdu *response)
+{
+	struct variable_list	*var;
+	zbx_bulkwalk_context_t	*bulkwalk_context;
+	char			error[MAX_STRING_LEN];
+	int			i;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() status:%d vars_num:%d", __func__, status, snmp_context->vars_num);
+
+	if (STAT_SUCCESS != status)
+	{
+		(void)zbx_get_snmp_response_error(snmp_context->ssp, &snmp_context->item.interface, status, response,
+				error, sizeof(error));
+		snmp_context->error = zbx_strdup(snmp_context->error, error);
+		goto out;
+	}
+
+	if (SNMP_ERR_NOERROR == response->errstat)
+	{
+		for (i = 0, var = response->variables; i < snmp_context->vars_num && NULL != var;
+				i++, var = var->next_variable)
+		{
+			bulkwalk_context = snmp_context->bulkwalk_contexts.values[snmp_context->vars[i]];
+
+			if (0 != snmp_oid_compare(bulkwalk_context->name, bulkwalk_context->name_length, var->name,
+					var->name_length))
+			{
+				break;
+			}
+		}
+
+		if (1 < snmp_context->vars_num && (i != snmp_context->vars_num || NULL != var))
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "SNMP response from host \"%s\" does not match %d requested"
+					" variables", snmp_context->item.host, snmp_context->vars_num);
+			snmp_get_reduce(snmp_context);
+			goto out;
+		}
+
+		for (i = 0, var = response->variables; i < snmp_context->vars_num; i++)
+		{
+			zbx_snmp_context_t	*owner;
+
+			bulkwalk_context = snmp_context->bulkwalk_contexts.values[snmp_context->vars[i]];
+			owner = (zbx_snmp_context_t *)bulkwalk_context->arg;
+
+			if (NULL == var)
+			{
+				snmp_get_set_error(bulkwalk_context, "No variables");
+				continue;
+			}
+
+			if (var->name_length < bulkwalk_context->p_oid->root_oid_len ||
+					0 != memcmp(bulkwalk_context->p_oid->root_oid, var->name,
+					bulkwalk_context->p_oid->root_oid_len * sizeof(oid)))
+			{
+				snmp_get_set_error(bulkwalk_context, "OID mismatched");
+			}
+			else if (SUCCEED != snmp_get_value_from_var(var, &owner->results, &owner->results_alloc,
+					&owner->results_offset, error, sizeof(error)))
+			{
+				snmp_get_set_error(bulkwalk_context, error);
+			}
+			else
+				bulkwalk_context->running = 0;
+
+			var = var->next_variable;
+		}
+
+		if (snmp_context->max_succeed < snmp_context->vars_num)
+			snmp_context->max_succeed = snmp_context->vars_num;
+	}
+	else if (SNMP_ERR_NOSUCHNAME == response->errstat && 0 < response->errindex &&
+			response->errindex <= snmp_context->vars_num)
+	{
+		/* SNMPv1 reports only the first variable that does not exist, retry the rest */
+		bulkwalk_context = snmp_context->bulkwalk_contexts.values[snmp_context->vars[response->errindex - 1]];
+
+		(void)zbx_get_snmp_response_error(snmp_context->ssp, &snmp_context->item.interface, status, response,
+				error, sizeof(error));
+		snmp_get_set_error(bulkwalk_context, error);
+	}
+	else if (1 < snmp_context->vars_num)
+	{
+		/* tooBig or error that cannot be attributed to a single variable */
+		snmp_get_reduce(snmp_context);
+	}
+	else
+	{
+		bulkwalk_context = snmp_context->bulkwalk_contexts.values[snmp_context->vars[0]];
+
+		(void)zbx_get_snmp_response_error(snmp_context->ssp, &snmp_context->item.interface, status, response,
+				error, sizeof(error));
+		snmp_get_set_error(bulkwalk_context, error);
+	}
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+}
+
+static int	asynch_get_response(int operation, struct snmp_session *sp, int reqid, struct snmp_pdu *pdu,
+		void *magic)
+{
+	zbx_snmp_context_t	*snmp_context = (zbx_snmp_context_t *)magic;
+	zbx_bulkwalk_context_t	*bulkwalk_context = snmp_context->bulkwalk_contexts.values[snmp_context->i];
+	int			stat;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	ZBX_UNUSED(sp);
+
+	if (reqid != bulkwalk_context->reqid && NULL != pdu && SNMP_MSG_REPORT != pdu->command)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "unexpected response request id:%d expected request id:%d command:%d"
+				" operation:%d", reqid, bulkwalk_context->reqid, pdu->command, operation);
+		return 0;
+	}
+
+	bulkwalk_context->waiting = 0;
+
+	if (1 == snmp_context->probe || SUCCEED != snmp_operation_to_status(operation, &stat))
+		goto out;
+
+	if (NULL != pdu)
+		snmp_get_handle_response(snmp_context, stat, pdu);
+	else
+		snmp_context->error = zbx_dsprintf(snmp_context->error, "SNMP error: [%d]", stat);
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+
+	return 1;
+}
+
 static netsnmp_pdu	*usm_probe_pdu_create(void)
 {
 	netsnmp_pdu	*pdu;
@@ -2783,15 +3048,79 @@ static void	snmp_bulkwalk_context_free(zbx_bulkwalk_context_t *bulkwalk_context)
 	zbx_free(bulkwalk_context);
 }
 
-static int	snmp_bulkwalk_add(zbx_snmp_context_t *snmp_context, int *fd, char *error, size_t max_error_len)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sends PDU and gets socket to wait for response on                 *
+ *                                                                            *
+ * Parameters: snmp_context     - [IN]                                        *
+ *             bulkwalk_context - [IN] context to store request id and file   *
+ *                                     descriptor set in                      *
+ *             pdu              - [IN] PDU to send, freed by the function     *
+ *             callback         - [IN] response callback                      *
+ *             magic            - [IN] response callback argument             *
+ *             fd               - [OUT] socket                                *
+ *             error            - [OUT]                                       *
+ *             max_error_len    - [IN]                                        *
+ *                                                                            *
+ ******************************************************************************/
+static int	snmp_pdu_send(zbx_snmp_context_t *snmp_context, zbx_bulkwalk_context_t *bulkwalk_context,
+		struct snmp_pdu *pdu, snmp_callback callback, void *magic, int *fd, char *error, size_t max_error_len)
 {
-	struct snmp_pdu			*pdu;
-	zbx_bulkwalk_context_t		*bulkwalk_context = snmp_context->bulkwalk_contexts.values[snmp_context->i];
 	struct netsnmp_transport_s	*transport;
 	int				ret, numfds = 0, block = 0;
 	struct timeval			timeout = {.tv_sec = snmp_context->config_timeout};
 	fd_set				fdset;
 
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() sending", __func__);
+
+	bulkwalk_context->reqid = -1;
+	bulkwalk_context->waiting = 1;
+
+	if (0 == (bulkwalk_context->reqid = snmp_sess_async_send(snmp_context->ssp, pdu, callback, magic)))
+	{
+		ret = zbx_get_snmp_response_error(snmp_context->ssp, &snmp_context->item.interface, STAT_ERROR, NULL,
+				error, max_error_len);
+		snmp_free_pdu(pdu);
+		goto out;
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() send completed", __func__);
+
+	FD_ZERO(&fdset);
+
+	netsnmp_copy_fd_set_to_large_fd_set(&bulkwalk_context->fdset, &fdset);
+
+	if (1 > snmp_sess_select_info2(snmp_context->ssp, &numfds, &bulkwalk_context->fdset, &timeout, &block))
+	{
+		zbx_strlcpy(error, "snmp_sess_select_info2(): cannot get socket.", max_error_len);
+		ret = NETWORK_ERROR;
+		snmp_sess_timeout(snmp_context->ssp);
+		goto out;
+	}
+
+	if (NULL == (transport = snmp_sess_transport(snmp_context->ssp)) || -1 == transport->sock)
+	{
+		zbx_strlcpy(error, "snmp_sess_transport(): cannot get socket.", max_error_len);
+		ret = NETWORK_ERROR;
+		snmp_sess_timeout(snmp_context->ssp);
+		goto out;
+	}
+
+	*fd = transport->sock;
+
+	ret = SUCCEED;
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s fd:%d", __func__, zbx_result_string(ret), *fd);
+
+	return ret;
+}
+
+static int	snmp_bulkwalk_add(zbx_snmp_context_t *snmp_context, int *fd, char *error, size_t max_error_len)
+{
+	struct snmp_pdu			*pdu;
+	zbx_bulkwalk_context_t		*bulkwalk_context = snmp_context->bulkwalk_contexts.values[snmp_context->i];
+	int				ret;
+
 	if (SUCCEED == ZBX_CHECK_LOG_LEVEL(LOG_LEVEL_DEBUG))
 	{
 		char	buffer[MAX_OID_LEN];
@@ -2839,49 +3168,167 @@ static int	snmp_bulkwalk_add(zbx_snmp_context_t *snmp_context, int *fd, char *er
 		}
 	}
 
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() sending", __func__);
+	ret = snmp_pdu_send(snmp_context, bulkwalk_context, pdu, asynch_response, bulkwalk_context, fd, error,
+			max_error_len);
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
-	bulkwalk_context->reqid = -1;
-	bulkwalk_context->waiting = 1;
+	return ret;
+}
 
-	if (0 == (bulkwalk_context->reqid = snmp_sess_async_send(snmp_context->ssp, pdu, asynch_response,
-			bulkwalk_context)))
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sends GET request with variables of coalesced checks that are not *
+ *          finished yet, starting from the current one                       *
+ *                                                                            *
+ ******************************************************************************/
+static int	snmp_get_add(zbx_snmp_context_t *snmp_context, int *fd, char *error, size_t max_error_len)
+{
+	struct snmp_pdu		*pdu;
+	zbx_bulkwalk_context_t	*bulkwalk_context = snmp_context->bulkwalk_contexts.values[snmp_context->i];
+	int			ret;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() i:%d vars_max:%d", __func__, snmp_context->i, snmp_context->vars_max);
+
+	if (1 == snmp_context->probe)
 	{
-		ret = zbx_get_snmp_response_error(snmp_context->ssp, &snmp_context->item.interface, STAT_ERROR, NULL,
-				error, max_error_len);
-		snmp_free_pdu(pdu);
-		goto out;
+		netsnmp_session	*session = snmp_sess_session(snmp_context->ssp);
+
+		session->flags |= SNMP_FLAGS_DONT_PROBE;
+
+		if (NULL == (pdu = usm_probe_pdu_create()))
+		{
+			zbx_strlcpy(error, "snmp_pdu_create(): cannot create PDU object.", max_error_len);
+			ret = CONFIG_ERROR;
+			goto out;
+		}
 	}
+	else
+	{
+		if (NULL == (pdu = snmp_pdu_create(SNMP_MSG_GET)))
+		{
+			zbx_strlcpy(error, "snmp_pdu_create(): cannot create PDU object.", max_error_len);
+			ret = CONFIG_ERROR;
+			goto out;
+		}
 
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() send completed", __func__);
+		snmp_context->vars_num = 0;
 
-	FD_ZERO(&fdset);
+		for (int i = snmp_context->i; i < snmp_context->bulkwalk_contexts.values_num &&
+				snmp_context->vars_num < snmp_context->vars_max; i++)
+		{
+			zbx_bulkwalk_context_t	*var_context = snmp_context->bulkwalk_contexts.values[i];
 
-	netsnmp_copy_fd_set_to_large_fd_set(&bulkwalk_context->fdset, &fdset);
+			if (0 == var_context->running)
+				continue;
 
-	if (1 > snmp_sess_select_info2(snmp_context->ssp, &numfds, &bulkwalk_context->fdset, &timeout, &block))
+			if (NULL == snmp_add_null_var(pdu, var_context->name, var_context->name_length))
+			{
+				zbx_strlcpy(error, "snmp_add_null_var(): cannot add null variable.", max_error_len);
+				ret = CONFIG_ERROR;
+				snmp_free_pdu(pdu);
+				goto out;
+			}
+
+			snmp_context->vars[snmp_context->vars_num++] = i;
+		}
+	}
+
+	ret = snmp_pdu_send(snmp_context, bulkwalk_context, pdu, asynch_get_response, snmp_context, fd, error,
+			max_error_len);
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s vars_num:%d", __func__, zbx_result_string(ret),
+			snmp_context->vars_num);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: moves to the first coalesced check that is not finished yet       *
+ *                                                                            *
+ * Return value: SUCCEED - unfinished check was found                         *
+ *               FAIL    - all checks are finished                            *
+ *                                                                            *
+ ******************************************************************************/
+static int	snmp_get_next(zbx_snmp_context_t *snmp_context)
+{
+	for (; snmp_context->i < snmp_context->bulkwalk_contexts.values_num; snmp_context->i++)
 	{
-		zbx_strlcpy(error, "snmp_sess_select_info2(): cannot get socket.", max_error_len);
-		ret = NETWORK_ERROR;
-		snmp_sess_timeout(snmp_context->ssp);
-		goto out;
+		if (0 != snmp_context->bulkwalk_contexts.values[snmp_context->i]->running)
+			return SUCCEED;
 	}
 
-	if (NULL == (transport = snmp_sess_transport(snmp_context->ssp)) || -1 == transport->sock)
+	return FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sets results of coalesced checks and updates interface SNMP       *
+ *          statistics                                                        *
+ *                                                                            *
+ * Comments: Checks that were not finished get the error of their OID if it   *
+ *           is known, otherwise the error of the task.                       *
+ *                                                                            *
+ ******************************************************************************/
+static void	snmp_get_finish(zbx_snmp_context_t *snmp_context)
+{
+	char	*error = NULL;
+	int	ret = snmp_context->item.ret;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() ret:%d", __func__, ret);
+
+	if (SUCCEED != ret && ZBX_ISSET_MSG(&snmp_context->item.result))
+		error = zbx_strdup(NULL, snmp_context->item.result.msg);
+
+	for (int i = 0; i < snmp_context->bulkwalk_contexts.values_num; i++)
 	{
-		zbx_strlcpy(error, "snmp_sess_transport(): cannot get socket.", max_error_len);
-		ret = NETWORK_ERROR;
-		snmp_sess_timeout(snmp_context->ssp);
-		goto out;
+		zbx_bulkwalk_context_t	*bulkwalk_context = snmp_context->bulkwalk_contexts.values[i];
+		zbx_snmp_context_t	*owner = (zbx_snmp_context_t *)bulkwalk_context->arg;
+
+		if (0 != bulkwalk_context->running)
+		{
+			owner->item.ret = ret;
+
+			/* error of the own OID takes precedence over the task error */
+			if (NULL != bulkwalk_context->error)
+			{
+				zbx_free_agent_result(&owner->item.result);
+				SET_MSG_RESULT(&owner->item.result, bulkwalk_context->error);
+				bulkwalk_context->error = NULL;
+			}
+			else if (owner != snmp_context)
+				SET_MSG_RESULT(&owner->item.result, zbx_strdup(NULL, NULL != error ? error : ""));
+
+			continue;
+		}
+
+		zbx_free_agent_result(&owner->item.result);
+
+		if (NULL != bulkwalk_context->error)
+		{
+			owner->item.ret = NOTSUPPORTED;
+			SET_MSG_RESULT(&owner->item.result, bulkwalk_context->error);
+			bulkwalk_context->error = NULL;
+		}
+		else
+		{
+			owner->item.ret = SUCCEED;
+			SET_TEXT_RESULT(&owner->item.result, NULL != owner->results ? owner->results :
+					zbx_strdup(NULL, ""));
+			owner->results = NULL;
+		}
 	}
 
-	*fd = transport->sock;
+	zbx_free(error);
 
-	ret = SUCCEED;
-out:
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s fd:%d", __func__, zbx_result_string(ret), *fd);
+	if (0 != snmp_context->max_succeed || ZBX_MAX_SNMP_ITEMS + 1 != snmp_context->min_fail)
+	{
+		zbx_dc_config_update_interface_snmp_stats(snmp_context->item.interface.interfaceid,
+				snmp_context->max_succeed, snmp_context->min_fail);
+	}
 
-	return ret;
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
 static ZBX_THREAD_LOCAL zbx_snmp_format_opts_t	default_opts;
@@ -2949,10 +3396,6 @@ static int	snmp_task_process(short event, void *data, int *fd, const char *addr,
 	{
 		if (0 != (event & EV_TIMEOUT))
 		{
-			char	buffer[MAX_OID_LEN];
-
-			snprint_objid(buffer, sizeof(buffer), bulkwalk_context->name, bulkwalk_context->name_length);
-
 			if (NULL != dnserr)
 			{
 				SET_MSG_RESULT(&snmp_context->item.result, zbx_dsprintf(NULL,
@@ -2960,23 +3403,14 @@ static int	snmp_task_process(short event, void *data, int *fd, const char *addr,
 						snmp_context->item.interface.addr, snmp_context->item.interface.port,
 						dnserr));
 				snmp_context->item.ret = TIMEOUT_ERROR;
+				goto stop;
 			}
-			else if (ZBX_IF_SNMP_VERSION_3 == snmp_context->snmp_version && 0 == snmp_context->probe)
-			{
-				SET_MSG_RESULT(&snmp_context->item.result, zbx_dsprintf(NULL,
-						"Probe successful, cannot retrieve OID: '%s' from [[%s]:%hu]:"
-						" timed out", buffer, snmp_context->item.interface.addr,
-						snmp_context->item.interface.port));
-				snmp_context->item.ret = TIMEOUT_ERROR;
-			}
-			else
-			{
-				SET_MSG_RESULT(&snmp_context->item.result, zbx_dsprintf(NULL,
-						"cannot retrieve OID: '%s' from [[%s]:%hu]:"
-						" timed out", buffer, snmp_context->item.interface.addr,
-						snmp_context->item.interface.port));
-				snmp_context->item.ret = TIMEOUT_ERROR;
-			}
+
+			if (0 != snmp_context->coalesced.values_num && SUCCEED == snmp_get_handle_timeout(snmp_context))
+				goto send;
+
+			SET_MSG_RESULT(&snmp_context->item.result, snmp_timeout_error(snmp_context, bulkwalk_context));
+			snmp_context->item.ret = TIMEOUT_ERROR;
 
 			goto stop;
 		}
@@ -3030,7 +3464,32 @@ static int	snmp_task_process(short event, void *data, int *fd, const char *addr,
 			snmp_context->probe = 0;
 		}
 
-		if (NULL != bulkwalk_context->error)
+		if (0 != snmp_context->coalesced.values_num)
+		{
+			if (1 == bulkwalk_context->waiting)
+			{
+				/* late response to request that timed out, keep waiting for the current one */
+				zabbix_log(LOG_LEVEL_DEBUG, "ignoring unexpected response for itemid:" ZBX_FS_UI64,
+						snmp_context->item.itemid);
+				task_ret = ZBX_ASYNC_TASK_READ;
+				goto stop;
+			}
+
+			if (NULL != snmp_context->error)
+			{
+				snmp_context->item.ret = NOTSUPPORTED;
+				SET_MSG_RESULT(&snmp_context->item.result, snmp_context->error);
+				snmp_context->error = NULL;
+				goto stop;
+			}
+
+			if (SUCCEED != snmp_get_next(snmp_context))
+			{
+				snmp_context->item.ret = SUCCEED;
+				goto stop;
+			}
+		}
+		else if (NULL != bulkwalk_context->error)
 		{
 			snmp_context->item.ret = NOTSUPPORTED;
 			SET_MSG_RESULT(&snmp_context->item.result, bulkwalk_context->error);
@@ -3044,7 +3503,11 @@ static int	snmp_task_process(short event, void *data, int *fd, const char *addr,
 					snmp_context->item.itemid);
 		}
 
-		if (0 == bulkwalk_context->running)
+		if (0 != snmp_context->coalesced.values_num)
+		{
+			/* send request with the remaining variables */
+		}
+		else if (0 == bulkwalk_context->running)
 		{
 			if (0 == bulkwalk_context->vars_num && SNMP_MSG_GETBULK == bulkwalk_context->pdu_type)
 			{
@@ -3092,14 +3555,28 @@ static int	snmp_task_process(short event, void *data, int *fd, const char *addr,
 		}
 	}
 
-	if (SUCCEED != (ret = snmp_bulkwalk_add(snmp_context, fd, error, sizeof(error))))
+send:
+	if (0 != snmp_context->coalesced.values_num)
+		ret = snmp_get_add(snmp_context, fd, error, sizeof(error));
+	else
+		ret = snmp_bulkwalk_add(snmp_context, fd, error, sizeof(error));
+
+	if (SUCCEED != ret)
 	{
 		snmp_context->item.ret = ret;
 		SET_MSG_RESULT(&snmp_context->item.result, zbx_dsprintf(NULL, "Get value failed: %s", error));
 	}
+	else if (0 != snmp_context->coalesced.values_num)
+	{
+		/* each of the sequential requests is given the full timeout */
+		task_ret = ZBX_ASYNC_TASK_READ_NEW_REQUEST;
+	}
 	else
 		task_ret = ZBX_ASYNC_TASK_READ;
 stop:
+	if (ZBX_ASYNC_TASK_STOP == task_ret && 0 != snmp_context->coalesced.values_num)
+		snmp_get_finish(snmp_context);
+
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 
 	return task_ret;
@@ -3141,12 +3618,32 @@ void	zbx_async_check_snmp_clean(zbx_snmp_context_t *snmp_context)
 	zbx_vector_bulkwalk_context_destroy(&snmp_context->bulkwalk_contexts);
 	zbx_vector_snmp_oid_clear_ext(&snmp_context->param_oids, vector_snmp_oid_free);
 	zbx_vector_snmp_oid_destroy(&snmp_context->param_oids);
+	zbx_vector_snmp_context_destroy(&snmp_context->coalesced);
+	zbx_free(snmp_context->vars);
+	zbx_free(snmp_context->error);
 	zbx_free(snmp_context);
 }
 
-int	zbx_async_check_snmp(zbx_dc_item_t *item, AGENT_RESULT *result, zbx_async_task_clear_cb_t clear_cb,
-		void *arg, void *arg_action, struct event_base *base, struct evdns_base *dnsbase,
-		const char *config_source_ip, zbx_async_resolve_reverse_dns_t resolve_reverse_dns)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: passes results of coalesced checks to the clear callback of each  *
+ *          check                                                             *
+ *                                                                            *
+ ******************************************************************************/
+static void	snmp_coalesced_clear(void *data)
+{
+	zbx_snmp_context_t		*snmp_context = (zbx_snmp_context_t *)data;
+	zbx_async_task_clear_cb_t	clear_cb = snmp_context->clear_cb;
+
+	for (int i = 0; i < snmp_context->coalesced.values_num; i++)
+		clear_cb(snmp_context->coalesced.values[i]);
+
+	clear_cb(snmp_context);
+}
+
+static int	snmp_context_create(zbx_dc_item_t *item, AGENT_RESULT *result, void *arg, void *arg_action,
+		const char *config_source_ip, zbx_async_resolve_reverse_dns_t resolve_reverse_dns,
+		zbx_snmp_context_t **snmp_context_out)
 {
 	int			ret = SUCCEED, pdu_type;
 	AGENT_REQUEST		request;
@@ -3158,6 +3655,15 @@ int	zbx_async_check_snmp(zbx_dc_item_t *item, AGENT_RESULT *result, zbx_async_ta
 
 	snmp_context = zbx_malloc(NULL, sizeof(zbx_snmp_context_t));
 
+	zbx_vector_snmp_context_create(&snmp_context->coalesced);
+	snmp_context->clear_cb = NULL;
+	snmp_context->vars = NULL;
+	snmp_context->vars_num = 0;
+	snmp_context->vars_max = 0;
+	snmp_context->max_succeed = 0;
+	snmp_context->min_fail = ZBX_MAX_SNMP_ITEMS + 1;
+	snmp_context->error = NULL;
+
 	snmp_context->resolve_reverse_dns = resolve_reverse_dns;
 	snmp_context->step = ZABBIX_ASYNC_STEP_DEFAULT;
 	snmp_context->reverse_dns = NULL;
@@ -3277,8 +3783,7 @@ int	zbx_async_check_snmp(zbx_dc_item_t *item, AGENT_RESULT *result, zbx_async_ta
 		zbx_vector_bulkwalk_context_append(&snmp_context->bulkwalk_contexts, bulkwalk_context);
 	}
 
-	zbx_async_poller_add_task(base, dnsbase, snmp_context->item.interface.addr, snmp_context, item->timeout,
-			snmp_task_process, clear_cb);
+	*snmp_context_out = snmp_context;
 
 	ret = SUCCEED;
 out:
@@ -3292,6 +3797,182 @@ out:
 	return ret;
 }
 
+int	zbx_async_check_snmp(zbx_dc_item_t *item, AGENT_RESULT *result, zbx_async_task_clear_cb_t clear_cb,
+		void *arg, void *arg_action, struct event_base *base, struct evdns_base *dnsbase,
+		const char *config_source_ip, zbx_async_resolve_reverse_dns_t resolve_reverse_dns)
+{
+	zbx_snmp_context_t	*snmp_context;
+	int			ret;
+
+	if (SUCCEED == (ret = snmp_context_create(item, result, arg, arg_action, config_source_ip,
+			resolve_reverse_dns, &snmp_context)))
+	{
+		zbx_async_poller_add_task(base, dnsbase, snmp_context->item.interface.addr, snmp_context,
+				item->timeout, snmp_task_process, clear_cb);
+	}
+
+	return ret;
+}
+
+static zbx_hash_t	snmp_coalesce_hash(const void *data)
+{
+	const zbx_snmp_coalesce_t	*coalesce = (const zbx_snmp_coalesce_t *)data;
+	zbx_hash_t			hash;
+
+	hash = ZBX_DEFAULT_UINT64_HASH_FUNC(&coalesce->interfaceid);
+
+	return ZBX_DEFAULT_HASH_ALGO(&coalesce->timeout, sizeof(coalesce->timeout), hash);
+}
+
+static int	snmp_coalesce_compare(const void *d1, const void *d2)
+{
+	const zbx_snmp_coalesce_t	*coalesce1 = (const zbx_snmp_coalesce_t *)d1;
+	const zbx_snmp_coalesce_t	*coalesce2 = (const zbx_snmp_coalesce_t *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(coalesce1->interfaceid, coalesce2->interfaceid);
+	ZBX_RETURN_IF_NOT_EQUAL(coalesce1->timeout, coalesce2->timeout);
+
+	return 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds GET check to be requested together with checks of another    *
+ *          context                                                           *
+ *                                                                            *
+ * Parameters: snmp_context - [IN] context performing the requests            *
+ *             peer         - [IN] check to add                               *
+ *                                                                            *
+ * Return value: SUCCEED - check was added                                    *
+ *               FAIL    - context has reached maximum number of checks       *
+ *                                                                            *
+ ******************************************************************************/
+static int	snmp_context_coalesce(zbx_snmp_context_t *snmp_context, zbx_snmp_context_t *peer)
+{
+	if (snmp_context->bulkwalk_contexts.values_num >= snmp_context->vars_max * ZBX_SNMP_GET_REQUESTS_MAX)
+		return FAIL;
+
+	if (NULL == snmp_context->vars)
+		snmp_context->vars = (int *)zbx_malloc(NULL, sizeof(int) * (size_t)snmp_context->vars_max);
+
+	zbx_vector_snmp_context_append(&snmp_context->coalesced, peer);
+
+	/* bulkwalk context keeps the peer as its owner to receive the value */
+	zbx_vector_bulkwalk_context_append(&snmp_context->bulkwalk_contexts, peer->bulkwalk_contexts.values[0]);
+	zbx_vector_bulkwalk_context_clear(&peer->bulkwalk_contexts);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: starts asynchronous SNMP checks, coalescing single variable GET   *
+ *          checks of the same interface into multi-variable requests         *
+ *                                                                            *
+ * Parameters: items            - [IN/OUT]                                    *
+ *             results          - [OUT] results of checks that failed to start*
+ *             errcodes         - [IN/OUT] only checks with SUCCEED are       *
+ *                                         started, set to error if check     *
+ *                                         cannot be started                  *
+ *             num              - [IN] number of items                        *
+ *             clear_cb         - [IN] callback for each finished check       *
+ *             arg              - [IN]                                        *
+ *             arg_action       - [IN]                                        *
+ *             base             - [IN]                                        *
+ *             dnsbase          - [IN]                                        *
+ *             config_source_ip - [IN]                                        *
+ *                                                                            *
+ * Comments: Number of variables in a request starts from the number          *
+ *           suggested by interface statistics and is reduced if device fails *
+ *           to process the request, the statistics are updated when checks   *
+ *           are finished. Each context performs up to                        *
+ *           ZBX_SNMP_GET_REQUESTS_MAX requests sequentially, larger groups   *
+ *           are split between contexts running in parallel.                  *
+ *           Only items passed in one call are coalesced, checks are not      *
+ *           delayed to wait for other items of the same interface. Items of  *
+ *           an interface are coalesced only when they are due in the same    *
+ *           configuration cache queue batch (for example, share the same     *
+ *           update interval and scheduling offset).                          *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_async_check_snmp_items(zbx_dc_item_t *items, AGENT_RESULT *results, int *errcodes, int num,
+		zbx_async_task_clear_cb_t clear_cb, void *arg, void *arg_action, struct event_base *base,
+		struct evdns_base *dnsbase, const char *config_source_ip)
+{
+	zbx_hashset_t			groups;
+	zbx_vector_snmp_context_t	snmp_contexts;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() num:%d", __func__, num);
+
+	zbx_hashset_create(&groups, (size_t)num, snmp_coalesce_hash, snmp_coalesce_compare);
+	zbx_vector_snmp_context_create(&snmp_contexts);
+
+	for (int i = 0; i < num; i++)
+	{
+		zbx_snmp_context_t	*snmp_context;
+		zbx_snmp_coalesce_t	*group, group_local;
+		int			bulk;
+
+		if (SUCCEED != errcodes[i] || ITEM_TYPE_SNMP != items[i].type)
+			continue;
+
+		if (SUCCEED != (errcodes[i] = snmp_context_create(&items[i], &results[i], arg, arg_action,
+				config_source_ip, ZABBIX_ASYNC_RESOLVE_REVERSE_DNS_NO, &snmp_context)))
+		{
+			continue;
+		}
+
+		if (ZBX_SNMP_GET == snmp_context->snmp_oid_type && 1 == snmp_context->bulkwalk_contexts.values_num)
+		{
+			group_local.interfaceid = snmp_context->item.interface.interfaceid;
+			group_local.timeout = snmp_context->config_timeout;
+
+			if (NULL == (group = (zbx_snmp_coalesce_t *)zbx_hashset_search(&groups, &group_local)))
+			{
+				group_local.snmp_context = NULL;
+				group = (zbx_snmp_coalesce_t *)zbx_hashset_insert(&groups, &group_local,
+						sizeof(group_local));
+			}
+
+			if (NULL != group->snmp_context && SUCCEED == snmp_context_coalesce(group->snmp_context,
+					snmp_context))
+			{
+				continue;
+			}
+
+			if (0 != (snmp_context->vars_max = zbx_dc_config_get_suggested_snmp_vars(
+					group_local.interfaceid, &bulk)) && SNMP_BULK_ENABLED == bulk)
+			{
+				group->snmp_context = snmp_context;
+			}
+			else
+				snmp_context->vars_max = 0;
+		}
+
+		zbx_vector_snmp_context_append(&snmp_contexts, snmp_context);
+	}
+
+	for (int i = 0; i < snmp_contexts.values_num; i++)
+	{
+		zbx_snmp_context_t		*snmp_context = snmp_contexts.values[i];
+		zbx_async_task_clear_cb_t	task_clear_cb = clear_cb;
+
+		if (0 != snmp_context->coalesced.values_num)
+		{
+			snmp_context->clear_cb = clear_cb;
+			task_clear_cb = snmp_coalesced_clear;
+		}
+
+		zbx_async_poller_add_task(base, dnsbase, snmp_context->item.interface.addr, snmp_context,
+				snmp_context->config_timeout, snmp_task_process, task_clear_cb);
+	}
+
+	zbx_vector_snmp_context_destroy(&snmp_contexts);
+	zbx_hashset_destroy(&groups);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+}
+
 static int	zbx_snmp_process_dynamic(zbx_snmp_sess_t ssp, const zbx_dc_item_t *items, AGENT_RESULT *results,
 		int *errcodes, int num, char *error, size_t max_error_len, int *max_succeed, int *min_fail, int bulk,
 		unsigned char poller_type)
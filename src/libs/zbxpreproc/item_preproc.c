@@ -617,13 +617,16 @@ int	item_preproc_2dec(zbx_variant_t *value, int op_type, char **errmsg)
  *                                                                            *
  * Parameters: value  - [IN/OUT] value to process                             *
  *             params - [IN] operation parameters                             *
+ *             regexp - [IN] precompiled pattern of the operation parameters  *
+ *                           (optional)                                       *
  *             errmsg - [OUT]                                                 *
  *                                                                            *
  * Return value: SUCCEED - the value was processed successfully               *
  *               FAIL - otherwise                                             *
  *                                                                            *
  ******************************************************************************/
-int	item_preproc_regsub_op(zbx_variant_t *value, const char *params, char **errmsg)
+int	item_preproc_regsub_op_ext(zbx_variant_t *value, const char *params, const zbx_regexp_t *regexp,
+		char **errmsg)
 {
 	char		*pattern, *output, *new_value = NULL;
 	char		*regex_error = NULL;
@@ -643,14 +646,20 @@ int	item_preproc_regsub_op(zbx_variant_t *value, const char *params, char **errm
 
 	*output++ = '\0';
 
-	if (FAIL == zbx_regexp_compile_ext(pattern, &regex, 0, &regex_error))	/* PCRE_MULTILINE is not used here */
+	if (NULL == regexp)
 	{
-		*errmsg = zbx_dsprintf(*errmsg, "invalid regular expression: %s", regex_error);
-		zbx_free(regex_error);
-		goto out;
+		/* PCRE_MULTILINE is not used here */
+		if (FAIL == zbx_regexp_compile_ext(pattern, &regex, 0, &regex_error))
+		{
+			*errmsg = zbx_dsprintf(*errmsg, "invalid regular expression: %s", regex_error);
+			zbx_free(regex_error);
+			goto out;
+		}
+
+		regexp = regex;
 	}
 
-	if (FAIL == zbx_mregexp_sub_precompiled(value->data.str, regex, output, ZBX_MAX_RECV_DATA_SIZE, &new_value))
+	if (FAIL == zbx_mregexp_sub_precompiled(value->data.str, regexp, output, ZBX_MAX_RECV_DATA_SIZE, &new_value))
 	{
 		*errmsg = zbx_strdup(*errmsg, "pattern does not match");
 		goto out;
@@ -669,6 +678,23 @@ out:
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: execute regular expression substitution operation                 *
+ *                                                                            *
+ * Parameters: value  - [IN/OUT] value to process                             *
+ *             params - [IN] operation parameters                             *
+ *             errmsg - [OUT]                                                 *
+ *                                                                            *
+ * Return value: SUCCEED - the value was processed successfully               *
+ *               FAIL - otherwise                                             *
+ *                                                                            *
+ ******************************************************************************/
+int	item_preproc_regsub_op(zbx_variant_t *value, const char *params, char **errmsg)
+{
+	return item_preproc_regsub_op_ext(value, params, NULL, errmsg);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: validates value to be within the specified range                  *
@@ -755,17 +781,19 @@ out:
  *                                                                            *
  * Parameters: value      - [IN/OUT] value to process                         *
  *             params     - [IN] operation parameters                         *
+ *             regexp     - [IN] precompiled regular expression (optional)    *
  *             error      - [OUT]                                             *
  *                                                                            *
  * Return value: SUCCEED - the preprocessing step finished successfully       *
  *               FAIL - otherwise, errmsg contains the error message          *
  *                                                                            *
  ******************************************************************************/
-int	item_preproc_validate_regex(const zbx_variant_t *value, const char *params, char **error)
+int	item_preproc_validate_regex_ext(const zbx_variant_t *value, const char *params, const zbx_regexp_t *regexp,
+		char **error)
 {
 	zbx_variant_t	value_str;
 	int		ret = FAIL;
-	zbx_regexp_t	*regex;
+	zbx_regexp_t	*regex = NULL;
 	char		*errptr = NULL;
 	char		*errmsg;
 
@@ -777,20 +805,27 @@ int	item_preproc_validate_regex(const zbx_variant_t *value, const char *params,
 		goto out;
 	}
 
-	if (FAIL == zbx_regexp_compile(params, &regex, &errptr))
+	if (NULL == regexp)
 	{
-		errmsg = zbx_dsprintf(NULL, "invalid regular expression pattern: %s", errptr);
-		zbx_free(errptr);
-		goto out;
+		if (FAIL == zbx_regexp_compile(params, &regex, &errptr))
+		{
+			errmsg = zbx_dsprintf(NULL, "invalid regular expression pattern: %s", errptr);
+			zbx_free(errptr);
+			goto out;
+		}
+
+		regexp = regex;
 	}
 
-	if (0 != zbx_regexp_match_precompiled(value_str.data.str, regex))
+	if (0 != zbx_regexp_match_precompiled(value_str.data.str, regexp))
 		errmsg = zbx_strdup(NULL, "value does not match regular expression");
 	else
 		ret = SUCCEED;
 
-	zbx_regexp_free(regex);
 out:
+	if (NULL != regex)
+		zbx_regexp_free(regex);
+
 	zbx_variant_clear(&value_str);
 
 	if (FAIL == ret)
@@ -804,23 +839,42 @@ out:
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: validates value to match regular expression                       *
+ *                                                                            *
+ * Parameters: value      - [IN/OUT] value to process                         *
+ *             params     - [IN] operation parameters                         *
+ *             error      - [OUT]                                             *
+ *                                                                            *
+ * Return value: SUCCEED - the preprocessing step finished successfully       *
+ *               FAIL - otherwise, errmsg contains the error message          *
+ *                                                                            *
+ ******************************************************************************/
+int	item_preproc_validate_regex(const zbx_variant_t *value, const char *params, char **error)
+{
+	return item_preproc_validate_regex_ext(value, params, NULL, error);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: validates value to not match regular expression                   *
  *                                                                            *
  * Parameters: value      - [IN/OUT] value to process                         *
  *             params     - [IN] operation parameters                         *
+ *             regexp     - [IN] precompiled regular expression (optional)    *
  *             error      - [OUT]                                             *
  *                                                                            *
  * Return value: SUCCEED - the preprocessing step finished successfully       *
  *               FAIL - otherwise, errmsg contains the error message          *
  *                                                                            *
  ******************************************************************************/
-int	item_preproc_validate_not_regex(const zbx_variant_t *value, const char *params, char **error)
+int	item_preproc_validate_not_regex_ext(const zbx_variant_t *value, const char *params,
+		const zbx_regexp_t *regexp, char **error)
 {
 	zbx_variant_t	value_str;
 	int		ret = FAIL;
-	zbx_regexp_t	*regex;
+	zbx_regexp_t	*regex = NULL;
 	char		*errptr = NULL;
 	char		*errmsg;
 
@@ -832,22 +886,29 @@ int	item_preproc_validate_not_regex(const zbx_variant_t *value, const char *para
 		goto out;
 	}
 
-	if (FAIL == zbx_regexp_compile(params, &regex, &errptr))
+	if (NULL == regexp)
 	{
-		errmsg = zbx_dsprintf(NULL, "invalid regular expression pattern: %s", errptr);
-		zbx_free(errptr);
-		goto out;
+		if (FAIL == zbx_regexp_compile(params, &regex, &errptr))
+		{
+			errmsg = zbx_dsprintf(NULL, "invalid regular expression pattern: %s", errptr);
+			zbx_free(errptr);
+			goto out;
+		}
+
+		regexp = regex;
 	}
 
-	if (0 == zbx_regexp_match_precompiled(value_str.data.str, regex))
+	if (0 == zbx_regexp_match_precompiled(value_str.data.str, regexp))
 	{
 		errmsg = zbx_strdup(NULL, "value matches regular expression");
 	}
 	else
 		ret = SUCCEED;
 
-	zbx_regexp_free(regex);
 out:
+	if (NULL != regex)
+		zbx_regexp_free(regex);
+
 	zbx_variant_clear(&value_str);
 
 	if (FAIL == ret)
@@ -861,6 +922,23 @@ out:
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: validates value to not match regular expression                   *
+ *                                                                            *
+ * Parameters: value      - [IN/OUT] value to process                         *
+ *             params     - [IN] operation parameters                         *
+ *             error      - [OUT]                                             *
+ *                                                                            *
+ * Return value: SUCCEED - the preprocessing step finished successfully       *
+ *               FAIL - otherwise, errmsg contains the error message          *
+ *                                                                            *
+ ******************************************************************************/
+int	item_preproc_validate_not_regex(const zbx_variant_t *value, const char *params, char **error)
+{
+	return item_preproc_validate_not_regex_ext(value, params, NULL, error);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: checks for presence of error field in json data                   *
@@ -913,6 +991,47 @@ out:
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks for presence of error field in parsed json data            *
+ *                                                                            *
+ * Parameters: obj      - [IN] parsed json data                               *
+ *             index    - [IN] jsonpath index (optional)                      *
+ *             params   - [IN] operation parameters                           *
+ *             jsonpath - [IN] compiled operation parameters (optional)       *
+ *             error    - [OUT]                                               *
+ *                                                                            *
+ * Return value: FAIL - preprocessing step error                              *
+ *               SUCCEED - preprocessing step succeeded, error may contain    *
+ *                         extracted error message                            *
+ *                                                                            *
+ ******************************************************************************/
+int	item_preproc_get_error_from_jsonobj(zbx_jsonobj_t *obj, zbx_jsonpath_index_t *index, const char *params,
+		zbx_jsonpath_t *jsonpath, char **error)
+{
+	int	ret;
+
+	if (NULL != jsonpath)
+		ret = zbx_jsonobj_query_path(obj, index, jsonpath, error);
+	else
+		ret = zbx_jsonobj_query_ext(obj, index, params, error);
+
+	if (FAIL == ret)
+	{
+		*error = zbx_strdup(NULL, zbx_json_strerror());
+		return FAIL;
+	}
+
+	if (NULL != *error)
+	{
+		zbx_lrtrim(*error, ZBX_WHITESPACE);
+		if ('\0' == **error)
+			zbx_free(*error);
+	}
+
+	return SUCCEED;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: checks for presence of error field in XML data                    *
@@ -17,6 +17,8 @@
 
 #include "zbxembed.h"
 #include "zbxtime.h"
+#include "zbxregexp.h"
+#include "zbxjson.h"
 
 int	zbx_item_preproc_convert_value_to_numeric(zbx_variant_t *value_num, const zbx_variant_t *value,
 		unsigned char value_type, char **errmsg);
@@ -29,12 +31,20 @@ int	item_preproc_trim(zbx_variant_t *value, int op_type, const char *params, cha
 int	item_preproc_delta(unsigned char value_type, zbx_variant_t *value, const zbx_timespec_t *ts,
 		int op_type, zbx_variant_t *history_value, zbx_timespec_t *history_ts, char **errmsg);
 int	item_preproc_regsub_op(zbx_variant_t *value, const char *params, char **errmsg);
+int	item_preproc_regsub_op_ext(zbx_variant_t *value, const char *params, const zbx_regexp_t *regexp,
+		char **errmsg);
 int	item_preproc_2dec(zbx_variant_t *value, int op_type, char **errmsg);
 int	item_preproc_validate_range(unsigned char value_type, const zbx_variant_t *value, const char *params,
 		char **errmsg);
 int	item_preproc_validate_regex(const zbx_variant_t *value, const char *params, char **error);
+int	item_preproc_validate_regex_ext(const zbx_variant_t *value, const char *params, const zbx_regexp_t *regexp,
+		char **error);
 int	item_preproc_validate_not_regex(const zbx_variant_t *value, const char *params, char **error);
+int	item_preproc_validate_not_regex_ext(const zbx_variant_t *value, const char *params,
+		const zbx_regexp_t *regexp, char **error);
 int	item_preproc_get_error_from_json(const zbx_variant_t *value, const char *params, char **error);
+int	item_preproc_get_error_from_jsonobj(zbx_jsonobj_t *obj, zbx_jsonpath_index_t *index, const char *params,
+		zbx_jsonpath_t *jsonpath, char **error);
 int	item_preproc_get_error_from_xml(const zbx_variant_t *value, const char *params, char **error);
 int	item_preproc_get_error_from_regex(const zbx_variant_t *value, const char *params, char **error);
 int	item_preproc_throttle_value(zbx_variant_t *value, const zbx_timespec_t *ts,
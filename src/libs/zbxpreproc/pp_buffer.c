@@ -0,0 +1,243 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "pp_buffer.h"
+#include "zbxpreproc.h"
+
+#include "zbxshmem.h"
+#include "zbxmutexs.h"
+#include "zbxnix.h"
+#include "zbxtime.h"
+
+/*
+ * The preprocessing buffer is an optional shared memory transport for item
+ * values sent to preprocessing manager. Producers append packed value batches
+ * to the buffer and notify the manager with an empty IPC message only when the
+ * buffer was drained since the last notification. The manager takes all queued
+ * batches at once and processes them directly from shared memory.
+ *
+ * When the buffer is full, producers wait until the manager has taken all
+ * queued batches before retrying. A batch is sent over the socket only if it
+ * does not fit in the drained buffer. At that point all older batches of the
+ * producer have been taken by the manager, which processes them before it
+ * receives the next socket message, so values of an item keep their order.
+ *
+ * The wait is limited by PP_BUFFER_DRAIN_TIMEOUT and ends at shutdown. After
+ * that the batch is sent over the socket and may overtake the buffered ones,
+ * but then the manager is either stalled or already gone.
+ */
+
+#define PP_BUFFER_DRAIN_TIMEOUT		10
+
+typedef struct
+{
+	zbx_pp_buffer_block_t	*head;
+	zbx_pp_buffer_block_t	*tail;
+
+	/* 1 - the manager was notified about queued batches and has not taken them yet */
+	int			notified;
+}
+zbx_pp_buffer_t;
+
+static zbx_shmem_info_t	*pp_buffer_mem = NULL;
+static zbx_pp_buffer_t	*pp_buffer = NULL;
+static zbx_mutex_t	pp_buffer_lock = ZBX_MUTEX_NULL;
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: initializes preprocessing buffer                                  *
+ *                                                                            *
+ * Parameters: size  - [IN] the buffer size, 0 - disables the buffer          *
+ *             error - [OUT]                                                  *
+ *                                                                            *
+ * Return value: SUCCEED - the buffer was initialized successfully            *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_pp_buffer_init(zbx_uint64_t size, char **error)
+{
+	if (0 == size)
+		return SUCCEED;
+
+	if (SUCCEED != zbx_mutex_create(&pp_buffer_lock, ZBX_MUTEX_PREPROC_BUFFER, error))
+		return FAIL;
+
+	if (SUCCEED != zbx_shmem_create(&pp_buffer_mem, size, "preprocessing buffer", "PreprocessingBufferSize", 1,
+			error))
+	{
+		return FAIL;
+	}
+
+	if (NULL == (pp_buffer = (zbx_pp_buffer_t *)zbx_shmem_malloc(pp_buffer_mem, NULL, sizeof(zbx_pp_buffer_t))))
+	{
+		*error = zbx_strdup(*error, "cannot allocate preprocessing buffer header");
+		return FAIL;
+	}
+
+	memset(pp_buffer, 0, sizeof(zbx_pp_buffer_t));
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: destroys preprocessing buffer                                     *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_pp_buffer_destroy(void)
+{
+	if (NULL == pp_buffer_mem)
+		return;
+
+	zbx_shmem_destroy(pp_buffer_mem);
+	pp_buffer_mem = NULL;
+	pp_buffer = NULL;
+	zbx_mutex_destroy(&pp_buffer_lock);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: appends packed value batch to preprocessing buffer                *
+ *                                                                            *
+ * Parameters: data   - [IN] the packed values                                *
+ *             size   - [IN] the packed values size                           *
+ *             notify - [OUT] 1 - the manager must be notified, 0 - otherwise *
+ *                                                                            *
+ * Return value: SUCCEED - the batch was added to the buffer                  *
+ *               FAIL    - the buffer is disabled or there is not enough      *
+ *                         space in it                                        *
+ *                                                                            *
+ ******************************************************************************/
+int	pp_buffer_push(const unsigned char *data, zbx_uint32_t size, int *notify)
+{
+	zbx_pp_buffer_block_t	*block;
+
+	if (NULL == pp_buffer)
+		return FAIL;
+
+	zbx_mutex_lock(pp_buffer_lock);
+
+	if (NULL == (block = (zbx_pp_buffer_block_t *)zbx_shmem_malloc(pp_buffer_mem, NULL,
+			offsetof(zbx_pp_buffer_block_t, data) + size)))
+	{
+		zbx_mutex_unlock(pp_buffer_lock);
+		return FAIL;
+	}
+
+	block->next = NULL;
+	block->size = size;
+	memcpy(block->data, data, size);
+
+	if (NULL != pp_buffer->tail)
+		pp_buffer->tail->next = block;
+	else
+		pp_buffer->head = block;
+
+	pp_buffer->tail = block;
+
+	*notify = (0 == pp_buffer->notified);
+	pp_buffer->notified = 1;
+
+	zbx_mutex_unlock(pp_buffer_lock);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: waits until preprocessing manager takes all queued value batches  *
+ *                                                                            *
+ * Return value: SUCCEED - the buffer is empty                                *
+ *               FAIL    - the buffer is disabled, the wait timed out or the  *
+ *                         process is shutting down                           *
+ *                                                                            *
+ ******************************************************************************/
+int	pp_buffer_wait_drained(void)
+{
+	struct timespec	delay = {0, 10000000L};
+	int		drained;
+	double		deadline;
+
+	if (NULL == pp_buffer)
+		return FAIL;
+
+	deadline = zbx_time() + PP_BUFFER_DRAIN_TIMEOUT;
+
+	while (1)
+	{
+		zbx_mutex_lock(pp_buffer_lock);
+		drained = (NULL == pp_buffer->head);
+		zbx_mutex_unlock(pp_buffer_lock);
+
+		if (0 != drained)
+			return SUCCEED;
+
+		if (!ZBX_IS_RUNNING() || zbx_time() >= deadline)
+			return FAIL;
+
+		nanosleep(&delay, NULL);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: takes all queued value batches from preprocessing buffer          *
+ *                                                                            *
+ * Return value: the list of value batches in the order they were added or    *
+ *               NULL if the buffer is empty or disabled                      *
+ *                                                                            *
+ * Comments: The returned batches must be freed with pp_buffer_free().        *
+ *                                                                            *
+ ******************************************************************************/
+zbx_pp_buffer_block_t	*pp_buffer_pop_all(void)
+{
+	zbx_pp_buffer_block_t	*blocks;
+
+	if (NULL == pp_buffer)
+		return NULL;
+
+	zbx_mutex_lock(pp_buffer_lock);
+
+	blocks = pp_buffer->head;
+	pp_buffer->head = NULL;
+	pp_buffer->tail = NULL;
+	pp_buffer->notified = 0;
+
+	zbx_mutex_unlock(pp_buffer_lock);
+
+	return blocks;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: frees value batches taken from preprocessing buffer               *
+ *                                                                            *
+ ******************************************************************************/
+void	pp_buffer_free(zbx_pp_buffer_block_t *blocks)
+{
+	if (NULL == blocks)
+		return;
+
+	zbx_mutex_lock(pp_buffer_lock);
+
+	while (NULL != blocks)
+	{
+		zbx_pp_buffer_block_t	*next = blocks->next;
+
+		zbx_shmem_free(pp_buffer_mem, blocks);
+		blocks = next;
+	}
+
+	zbx_mutex_unlock(pp_buffer_lock);
+}
@@ -0,0 +1,34 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#ifndef ZABBIX_PP_BUFFER_H
+#define ZABBIX_PP_BUFFER_H
+
+#include "zbxcommon.h"
+
+/* the packed item value batch in preprocessing buffer */
+typedef struct zbx_pp_buffer_block
+{
+	struct zbx_pp_buffer_block	*next;
+	zbx_uint32_t			size;
+	unsigned char			data[1];
+}
+zbx_pp_buffer_block_t;
+
+int	pp_buffer_push(const unsigned char *data, zbx_uint32_t size, int *notify);
+int	pp_buffer_wait_drained(void);
+zbx_pp_buffer_block_t	*pp_buffer_pop_all(void);
+void	pp_buffer_free(zbx_pp_buffer_block_t *blocks);
+
+#endif
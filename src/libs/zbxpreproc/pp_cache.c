@@ -34,21 +34,7 @@ zbx_pp_cache_t	*pp_cache_create(const zbx_pp_item_preproc_t *preproc, const zbx_
 {
 	zbx_pp_cache_t	*cache = (zbx_pp_cache_t *)zbx_malloc(NULL, sizeof(zbx_pp_cache_t));
 
-	if (0 != preproc->steps_num)
-	{
-		switch (preproc->steps[0].type)
-		{
-			/* 'prometheus pattern' cache is reused for 'prometheus to json' */
-			case ZBX_PREPROC_PROMETHEUS_TO_JSON:
-				cache->type = ZBX_PREPROC_PROMETHEUS_PATTERN;
-				break;
-			default:
-				cache->type = preproc->steps[0].type;
-		}
-	}
-	else
-		cache->type = ZBX_PREPROC_NONE;
-
+	cache->type = pp_cache_get_type(preproc);
 	zbx_variant_copy(&cache->value, value);
 	cache->data = NULL;
 	cache->refcount = 1;
@@ -119,6 +105,26 @@ zbx_pp_cache_t	*pp_cache_copy(zbx_pp_cache_t *cache)
 	return cache;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finish cache initialization                                       *
+ *                                                                            *
+ * Parameters: cache - [IN] preprocessing cache                               *
+ *                                                                            *
+ * Comments: This function is called after the task that initializes cache    *
+ *           has been finished and before cache is shared with other tasks.   *
+ *           If the cache data was not created (for example the first task    *
+ *           failed before reaching cached step) the cache is disabled, so    *
+ *           other tasks will not try to create cache data concurrently.      *
+ *           After this the cache is read only.                               *
+ *                                                                            *
+ ******************************************************************************/
+void	pp_cache_seal(zbx_pp_cache_t *cache)
+{
+	if (NULL != cache && NULL == cache->data && NULL == cache->error)
+		cache->type = ZBX_PREPROC_NONE;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: copy original value from cache if needed                          *
@@ -140,28 +146,84 @@ void	pp_cache_prepare_output_value(zbx_pp_cache_t *cache, int step_type, zbx_var
 
 /******************************************************************************
  *                                                                            *
- * Purpose: check if caching can be done for the specified preprocessing      *
- *          data                                                              *
+ * Purpose: check if preprocessing step passes the input value unchanged      *
+ *          when succeeded                                                    *
  *                                                                            *
- * Parameters: preproc  - [IN] preprocessing data                             *
+ * Parameters: type - [IN] preprocessing step type                            *
  *                                                                            *
- * Return value: SUCCEED - the preprocessing caching is possible              *
+ * Return value: SUCCEED - the step does not change value                     *
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-int	pp_cache_is_supported(zbx_pp_item_preproc_t *preproc)
+int	pp_cache_is_step_transparent(int type)
 {
-	if (0 < preproc->steps_num)
+	switch (type)
 	{
-		switch (preproc->steps[0].type)
+		case ZBX_PREPROC_VALIDATE_NOT_SUPPORTED:
+		case ZBX_PREPROC_VALIDATE_REGEX:
+		case ZBX_PREPROC_VALIDATE_NOT_REGEX:
+		case ZBX_PREPROC_ERROR_FIELD_JSON:
+		case ZBX_PREPROC_ERROR_FIELD_REGEX:
+			return SUCCEED;
+		default:
+			return FAIL;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get cache type for the specified preprocessing data               *
+ *                                                                            *
+ * Parameters: preproc  - [IN] preprocessing data                             *
+ *                                                                            *
+ * Return value: The type of first step that can use cache or                 *
+ *               ZBX_PREPROC_NONE if caching is not possible.                 *
+ *                                                                            *
+ * Comments: Cache can be used by the first step that can be cached and is    *
+ *           preceded only by steps that do not change input value.           *
+ *           Parsed json is shared by 'jsonpath' and 'check for error in      *
+ *           json' steps, 'prometheus pattern' cache is reused for            *
+ *           'prometheus to json'.                                            *
+ *                                                                            *
+ ******************************************************************************/
+int	pp_cache_get_type(const zbx_pp_item_preproc_t *preproc)
+{
+	for (int i = 0; i < preproc->steps_num; i++)
+	{
+		switch (preproc->steps[i].type)
 		{
 			case ZBX_PREPROC_JSONPATH:
+			case ZBX_PREPROC_ERROR_FIELD_JSON:
+				return ZBX_PREPROC_JSONPATH;
 			case ZBX_PREPROC_PROMETHEUS_PATTERN:
 			case ZBX_PREPROC_PROMETHEUS_TO_JSON:
+				return ZBX_PREPROC_PROMETHEUS_PATTERN;
 			case ZBX_PREPROC_SNMP_WALK_VALUE:
-				return SUCCEED;
+				return ZBX_PREPROC_SNMP_WALK_VALUE;
 		}
+
+		if (SUCCEED != pp_cache_is_step_transparent(preproc->steps[i].type))
+			break;
 	}
 
+	return ZBX_PREPROC_NONE;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: check if caching can be done for the specified preprocessing      *
+ *          data                                                              *
+ *                                                                            *
+ * Parameters: preproc  - [IN] preprocessing data                             *
+ *                                                                            *
+ * Return value: SUCCEED - the preprocessing caching is possible              *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	pp_cache_is_supported(zbx_pp_item_preproc_t *preproc)
+{
+	if (ZBX_PREPROC_NONE != pp_cache_get_type(preproc))
+		return SUCCEED;
+
 	return FAIL;
 }
@@ -40,7 +40,11 @@ zbx_pp_cache_t	*pp_cache_create(const zbx_pp_item_preproc_t *preproc, const zbx_
 void		pp_cache_release(zbx_pp_cache_t *cache);
 zbx_pp_cache_t	*pp_cache_copy(zbx_pp_cache_t *cache);
 
+void	pp_cache_seal(zbx_pp_cache_t *cache);
+
 void	pp_cache_prepare_output_value(zbx_pp_cache_t *cache, int step_type, zbx_variant_t *value);
+int	pp_cache_is_step_transparent(int type);
+int	pp_cache_get_type(const zbx_pp_item_preproc_t *preproc);
 int	pp_cache_is_supported(zbx_pp_item_preproc_t *preproc);
 
 #endif
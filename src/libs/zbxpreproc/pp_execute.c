@@ -16,6 +16,7 @@
 #include "pp_cache.h"
 #include "pp_error.h"
 #include "item_preproc.h"
+#include "pp_pipeline.h"
 #include "zbxpreprocbase.h"
 #include "zbxprometheus.h"
 #include "zbxxml.h"
@@ -201,17 +202,18 @@ static int	pp_execute_delta(int type, unsigned char value_type, zbx_variant_t *v
  *                                                                            *
  * Parameters: value  - [IN/OUT] input/output value                           *
  *             params - [IN] preprocessing parameters                         *
+ *             regexp - [IN] precompiled pattern (optional)                   *
  *                                                                            *
  * Result value: SUCCEED - the preprocessing step was executed successfully.  *
  *               FAIL    - otherwise. The error message is stored in value.   *
  *                                                                            *
  ******************************************************************************/
-static int	pp_execute_regsub(zbx_variant_t *value, const char *params)
+static int	pp_execute_regsub(zbx_variant_t *value, const char *params, const zbx_regexp_t *regexp)
 {
 	char	*errmsg = NULL, *ptr;
 	int	len;
 
-	if (SUCCEED == item_preproc_regsub_op(value, params, &errmsg))
+	if (SUCCEED == item_preproc_regsub_op_ext(value, params, regexp, &errmsg))
 		return SUCCEED;
 
 	if (NULL == (ptr = strchr(params, '\n')))
@@ -231,20 +233,78 @@ static int	pp_execute_regsub(zbx_variant_t *value, const char *params)
 
 /******************************************************************************
  *                                                                            *
- * Purpose: execute jsonpath query                                            *
+ * Purpose: get parsed json value from preprocessing cache                    *
  *                                                                            *
  * Parameters: cache  - [IN] preprocessing cache                              *
- *             value  - [IN/OUT] value to process                             *
- *             params - [IN] step parameters                                  *
+ *             value  - [IN/OUT] value to parse if cache is not initialized   *
  *             errmsg - [OUT]                                                 *
  *                                                                            *
+ * Result value: The parsed json value with jsonpath index or NULL in the    *
+ *               case of error.                                               *
+ *                                                                            *
+ * Comments: The json value is parsed only by the first task using cache.     *
+ *           After that it is shared between dependent items of the same      *
+ *           master item and is only read (the jsonpath index is protected by *
+ *           its own lock), so it can be queried by several workers at once.  *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_pp_cache_jsonpath_t	*pp_cache_get_jsonpath(zbx_pp_cache_t *cache, zbx_variant_t *value, char **errmsg)
+{
+	zbx_pp_cache_jsonpath_t	*index;
+
+	if (NULL != cache->error)
+	{
+		*errmsg = zbx_strdup(NULL, cache->error);
+		return NULL;
+	}
+
+	if (NULL == (index = (zbx_pp_cache_jsonpath_t *)cache->data))
+	{
+		if (FAIL == item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
+			return NULL;
+
+		index = (zbx_pp_cache_jsonpath_t *)zbx_malloc(NULL, sizeof(zbx_pp_cache_jsonpath_t));
+
+		if (SUCCEED != zbx_jsonobj_open(value->data.str, &index->obj))
+		{
+			cache->error = zbx_strdup(NULL, zbx_json_strerror());
+			*errmsg = zbx_strdup(NULL, cache->error);
+			zbx_free(index);
+			return NULL;
+		}
+
+		if (NULL == (index->index = zbx_jsonpath_index_create(errmsg)))
+		{
+			zbx_jsonobj_clear(&index->obj);
+			zbx_free(index);
+			cache->type = ZBX_PREPROC_NONE;
+			return NULL;
+		}
+
+		cache->data = (void *)index;
+	}
+
+	return index;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: execute jsonpath query                                            *
+ *                                                                            *
+ * Parameters: cache    - [IN] preprocessing cache                            *
+ *             value    - [IN/OUT] value to process                           *
+ *             params   - [IN] step parameters                                *
+ *             jsonpath - [IN] compiled jsonpath (optional)                   *
+ *             errmsg   - [OUT]                                               *
+ *                                                                            *
  * Result value: SUCCEED - the query was executed successfully.               *
  *               FAIL    - otherwise.                                         *
  *                                                                            *
  ******************************************************************************/
 static int	pp_excute_jsonpath_query(zbx_pp_cache_t *cache, zbx_variant_t *value, const char *params,
-		char **errmsg)
+		zbx_jsonpath_t *jsonpath, char **errmsg)
 {
+	int	ret;
 	char	*data = NULL;
 
 	if (NULL == cache || ZBX_PREPROC_JSONPATH != cache->type)
@@ -260,7 +320,12 @@ static int	pp_excute_jsonpath_query(zbx_pp_cache_t *cache, zbx_variant_t *value,
 			return FAIL;
 		}
 
-		if (FAIL == zbx_jsonobj_query(&obj, params, &data))
+		if (NULL != jsonpath)
+			ret = zbx_jsonobj_query_path(&obj, NULL, jsonpath, &data);
+		else
+			ret = zbx_jsonobj_query(&obj, params, &data);
+
+		if (FAIL == ret)
 		{
 			zbx_jsonobj_clear(&obj);
 			*errmsg = zbx_strdup(*errmsg, zbx_json_strerror());
@@ -273,39 +338,15 @@ static int	pp_excute_jsonpath_query(zbx_pp_cache_t *cache, zbx_variant_t *value,
 	{
 		zbx_pp_cache_jsonpath_t	*index;
 
-		if (NULL != cache->error)
-		{
-			*errmsg = zbx_strdup(NULL, cache->error);
+		if (NULL == (index = pp_cache_get_jsonpath(cache, value, errmsg)))
 			return FAIL;
-		}
-
-		if (NULL == (index = (zbx_pp_cache_jsonpath_t *)cache->data))
-		{
-			if (FAIL == item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
-				return FAIL;
 
-			index = (zbx_pp_cache_jsonpath_t *)zbx_malloc(NULL, sizeof(zbx_pp_cache_jsonpath_t));
-
-			if (SUCCEED != zbx_jsonobj_open(value->data.str, &index->obj))
-			{
-				cache->error = zbx_strdup(NULL, zbx_json_strerror());
-				*errmsg = zbx_strdup(NULL, cache->error);
-				zbx_free(index);
-				return FAIL;
-			}
-
-			if (NULL == (index->index = zbx_jsonpath_index_create(errmsg)))
-			{
-				zbx_jsonobj_clear(&index->obj);
-				zbx_free(index);
-				cache->type = ZBX_PREPROC_NONE;
-				return FAIL;
-			}
-
-			cache->data = (void *)index;
-		}
+		if (NULL != jsonpath)
+			ret = zbx_jsonobj_query_path(&index->obj, index->index, jsonpath, &data);
+		else
+			ret = zbx_jsonobj_query_ext(&index->obj, index->index, params, &data);
 
-		if (FAIL == zbx_jsonobj_query_ext(&index->obj, index->index, params, &data))
+		if (FAIL == ret)
 		{
 			*errmsg = zbx_strdup(*errmsg, zbx_json_strerror());
 			return FAIL;
@@ -328,19 +369,21 @@ static int	pp_excute_jsonpath_query(zbx_pp_cache_t *cache, zbx_variant_t *value,
  *                                                                            *
  * Purpose: execute 'jsonpath' step                                           *
  *                                                                            *
- * Parameters: cache  - [IN] preprocessing cache                              *
- *             value  - [IN/OUT] value to process                             *
- *             params - [IN] step parameters                                  *
+ * Parameters: cache    - [IN] preprocessing cache                            *
+ *             value    - [IN/OUT] value to process                           *
+ *             params   - [IN] step parameters                                *
+ *             jsonpath - [IN] compiled jsonpath (optional)                   *
  *                                                                            *
  * Result value: SUCCEED - the preprocessing step was executed successfully.  *
  *               FAIL    - otherwise. The error message is stored in value.   *
  *                                                                            *
  ******************************************************************************/
-static int	pp_execute_jsonpath(zbx_pp_cache_t *cache, zbx_variant_t *value, const char *params)
+static int	pp_execute_jsonpath(zbx_pp_cache_t *cache, zbx_variant_t *value, const char *params,
+		zbx_jsonpath_t *jsonpath)
 {
 	char	*errmsg = NULL;
 
-	if (SUCCEED == pp_excute_jsonpath_query(cache, value, params, &errmsg))
+	if (SUCCEED == pp_excute_jsonpath_query(cache, value, params, jsonpath, &errmsg))
 		return SUCCEED;
 
 	zbx_variant_clear(value);
@@ -485,16 +528,17 @@ static int	pp_validate_range(unsigned char value_type, zbx_variant_t *value, con
  *                                                                            *
  * Parameters: value  - [IN/OUT] value to process                             *
  *             params - [IN] step parameters                                  *
+ *             regexp - [IN] precompiled regular expression (optional)        *
  *                                                                            *
  * Result value: SUCCEED - the preprocessing step was executed successfully.  *
  *               FAIL    - otherwise. The error message is stored in value.   *
  *                                                                            *
  ******************************************************************************/
-static int	pp_validate_regex(zbx_variant_t *value, const char *params)
+static int	pp_validate_regex(zbx_variant_t *value, const char *params, const zbx_regexp_t *regexp)
 {
 	char	*errmsg = NULL;
 
-	if (SUCCEED == item_preproc_validate_regex(value, params, &errmsg))
+	if (SUCCEED == item_preproc_validate_regex_ext(value, params, regexp, &errmsg))
 		return SUCCEED;
 
 	zbx_variant_clear(value);
@@ -509,16 +553,17 @@ static int	pp_validate_regex(zbx_variant_t *value, const char *params)
  *                                                                            *
  * Parameters: value  - [IN/OUT] value to process                             *
  *             params - [IN] step parameters                                  *
+ *             regexp - [IN] precompiled regular expression (optional)        *
  *                                                                            *
  * Result value: SUCCEED - the preprocessing step was executed successfully.  *
  *               FAIL    - otherwise. The error message is stored in value.   *
  *                                                                            *
  ******************************************************************************/
-static int	pp_validate_not_regex(zbx_variant_t *value, const char *params)
+static int	pp_validate_not_regex(zbx_variant_t *value, const char *params, const zbx_regexp_t *regexp)
 {
 	char	*errmsg = NULL;
 
-	if (SUCCEED == item_preproc_validate_not_regex(value, params, &errmsg))
+	if (SUCCEED == item_preproc_validate_not_regex_ext(value, params, regexp, &errmsg))
 		return SUCCEED;
 
 	zbx_variant_clear(value);
@@ -531,19 +576,37 @@ static int	pp_validate_not_regex(zbx_variant_t *value, const char *params)
  *                                                                            *
  * Purpose: execute 'error from json' step                                    *
  *                                                                            *
- * Parameters: value  - [IN/OUT] value to process                             *
- *             params - [IN] step parameters                                  *
+ * Parameters: cache    - [IN] preprocessing cache                            *
+ *             value    - [IN/OUT] value to process                           *
+ *             params   - [IN] step parameters                                *
+ *             jsonpath - [IN] compiled jsonpath (optional)                   *
  *                                                                            *
  * Result value: SUCCEED - the preprocessing step was executed successfully.  *
  *               FAIL    - otherwise. The error message is stored in value.   *
  *                                                                            *
  ******************************************************************************/
-static int	pp_error_from_json(zbx_variant_t *value, const char *params)
+static int	pp_error_from_json(zbx_pp_cache_t *cache, zbx_variant_t *value, const char *params,
+		zbx_jsonpath_t *jsonpath)
 {
 	char	*errmsg = NULL;
 	int	ret;
 
-	ret = item_preproc_get_error_from_json(value, params, &errmsg);
+	/* the value is not changed by this step, so cache can be used only if no conversion is required */
+	if (NULL != cache && ZBX_PREPROC_JSONPATH == cache->type && ZBX_VARIANT_STR == value->type)
+	{
+		zbx_pp_cache_jsonpath_t	*index;
+
+		/* values that are not json do not contain error field */
+		if (NULL == (index = pp_cache_get_jsonpath(cache, value, &errmsg)))
+		{
+			zbx_free(errmsg);
+			return SUCCEED;
+		}
+
+		ret = item_preproc_get_error_from_jsonobj(&index->obj, index->index, params, jsonpath, &errmsg);
+	}
+	else
+		ret = item_preproc_get_error_from_json(value, params, &errmsg);
 
 	if (NULL != errmsg)
 	{
@@ -1039,35 +1102,59 @@ static int	pp_execute_snmp_get_to_value(zbx_variant_t *value, const char *params
  *             history_value    - [IN/OUT] last value                         *
  *             history_ts       - [IN/OUT] last value timestamp               *
  *             config_source_ip - [IN]                                        *
+ *             compiled         - [IN] compiled step (optional)               *
  *                                                                            *
  * Result value: SUCCEED - the preprocessing step was executed successfully.  *
  *               FAIL    - otherwise. The error message is stored in value.   *
  *                                                                            *
  ******************************************************************************/
-int	pp_execute_step(zbx_pp_context_t *ctx, zbx_pp_cache_t *cache, zbx_dc_um_shared_handle_t *um_handle,
-		zbx_uint64_t hostid, unsigned char value_type, zbx_variant_t *value, zbx_timespec_t ts,
-		zbx_pp_step_t *step, zbx_variant_t *history_value, zbx_timespec_t *history_ts,
-		const char *config_source_ip)
+static int	pp_execute_step_compiled(zbx_pp_context_t *ctx, zbx_pp_cache_t *cache,
+		zbx_dc_um_shared_handle_t *um_handle, zbx_uint64_t hostid, unsigned char value_type,
+		zbx_variant_t *value, zbx_timespec_t ts, zbx_pp_step_t *step, zbx_variant_t *history_value,
+		zbx_timespec_t *history_ts, const char *config_source_ip, const zbx_pp_step_compiled_t *compiled)
 {
-	int	ret;
-	char	*params = NULL;
+	int			ret;
+	char			*params = NULL, *params_dyn = NULL;
+	zbx_jsonpath_t		*jsonpath = NULL;
+	const zbx_regexp_t	*regexp = NULL;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() step:%d params:'%s' value:'%.*s' cache:%p", __func__,
 			step->type, step->params, PP_VALUE_LOG_LIMIT, zbx_variant_value_desc(value), (void *)cache);
 
-	params = zbx_strdup(NULL, step->params);
-
-	if (NULL != um_handle)
+	if (NULL != compiled && 0 == compiled->has_macros)
+	{
+		/* parameters without macros can be used as is */
+		params = step->params;
+	}
+	else
 	{
-		char		*error = NULL;
-		unsigned char	env = ZBX_PREPROC_SCRIPT == step->type ? ZBX_MACRO_ENV_SECURE : ZBX_MACRO_ENV_NONSECURE;
+		params = params_dyn = zbx_strdup(NULL, step->params);
 
-		if (SUCCEED != zbx_dc_expand_user_and_func_macros_from_cache(um_handle->um_cache, &params, &hostid, 1,
-				env, &error))
+		if (NULL != um_handle)
 		{
-			zabbix_log(LOG_LEVEL_DEBUG, "cannot resolve user macros: %s", error);
-			zbx_free(error);
+			char		*error = NULL;
+			unsigned char	env = ZBX_PREPROC_SCRIPT == step->type ? ZBX_MACRO_ENV_SECURE :
+					ZBX_MACRO_ENV_NONSECURE;
+
+			if (SUCCEED != zbx_dc_expand_user_and_func_macros_from_cache(um_handle->um_cache, &params_dyn,
+					&hostid, 1, env, &error))
+			{
+				zabbix_log(LOG_LEVEL_DEBUG, "cannot resolve user macros: %s", error);
+				zbx_free(error);
+			}
+
+			params = params_dyn;
 		}
+
+		/* user macros might have changed since the step was compiled */
+		if (NULL != compiled && (NULL == compiled->params || 0 != strcmp(params, compiled->params)))
+			compiled = NULL;
+	}
+
+	if (NULL != compiled)
+	{
+		jsonpath = compiled->jsonpath;
+		regexp = compiled->regexp;
 	}
 
 	switch (step->type)
@@ -1081,7 +1168,7 @@ int	pp_execute_step(zbx_pp_context_t *ctx, zbx_pp_cache_t *cache, zbx_dc_um_shar
 			ret = pp_execute_trim(step->type, value, params);
 			goto out;
 		case ZBX_PREPROC_REGSUB:
-			ret = pp_execute_regsub(value, params);
+			ret = pp_execute_regsub(value, params, regexp);
 			goto out;
 		case ZBX_PREPROC_BOOL2DEC:
 		case ZBX_PREPROC_OCT2DEC:
@@ -1096,22 +1183,22 @@ int	pp_execute_step(zbx_pp_context_t *ctx, zbx_pp_cache_t *cache, zbx_dc_um_shar
 			ret = pp_execute_xpath(value, params);
 			goto out;
 		case ZBX_PREPROC_JSONPATH:
-			ret = pp_execute_jsonpath(cache, value, params);
+			ret = pp_execute_jsonpath(cache, value, params, jsonpath);
 			goto out;
 		case ZBX_PREPROC_VALIDATE_RANGE:
 			ret = pp_validate_range(value_type, value, params);
 			goto out;
 		case ZBX_PREPROC_VALIDATE_REGEX:
-			ret = pp_validate_regex(value, params);
+			ret = pp_validate_regex(value, params, regexp);
 			goto out;
 		case ZBX_PREPROC_VALIDATE_NOT_REGEX:
-			ret = pp_validate_not_regex(value, params);
+			ret = pp_validate_not_regex(value, params, regexp);
 			goto out;
 		case ZBX_PREPROC_VALIDATE_NOT_SUPPORTED:
 			ret = pp_check_not_supported_error(value, params, &step->error_handler_params);
 			goto out;
 		case ZBX_PREPROC_ERROR_FIELD_JSON:
-			ret = pp_error_from_json(value, params);
+			ret = pp_error_from_json(cache, value, params, jsonpath);
 			goto out;
 		case ZBX_PREPROC_ERROR_FIELD_XML:
 			ret = pp_error_from_xml(value, params);
@@ -1158,7 +1245,7 @@ int	pp_execute_step(zbx_pp_context_t *ctx, zbx_pp_cache_t *cache, zbx_dc_um_shar
 			ret = FAIL;
 		}
 out:
-	zbx_free(params);
+	zbx_free(params_dyn);
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() ret:%s value:%.*s", __func__, zbx_result_string(ret),
 			PP_VALUE_LOG_LIMIT, zbx_variant_value_desc(value));
@@ -1166,6 +1253,35 @@ out:
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: execute preprocessing step                                        *
+ *                                                                            *
+ * Parameters: ctx              - [IN] worker specific execution context      *
+ *             cache            - [IN] preprocessing cache                    *
+ *             um_handle        - [IN] shared user macro cache handle         *
+ *             hostid           - [IN] item host identifier                   *
+ *             value_type       - [IN] item value type                        *
+ *             value            - [IN/OUT] input/output value                 *
+ *             ts               - [IN] value timestamp                        *
+ *             step             - [IN/OUT] step to execute                    *
+ *             history_value    - [IN/OUT] last value                         *
+ *             history_ts       - [IN/OUT] last value timestamp               *
+ *             config_source_ip - [IN]                                        *
+ *                                                                            *
+ * Result value: SUCCEED - the preprocessing step was executed successfully.  *
+ *               FAIL    - otherwise. The error message is stored in value.   *
+ *                                                                            *
+ ******************************************************************************/
+int	pp_execute_step(zbx_pp_context_t *ctx, zbx_pp_cache_t *cache, zbx_dc_um_shared_handle_t *um_handle,
+		zbx_uint64_t hostid, unsigned char value_type, zbx_variant_t *value, zbx_timespec_t ts,
+		zbx_pp_step_t *step, zbx_variant_t *history_value, zbx_timespec_t *history_ts,
+		const char *config_source_ip)
+{
+	return pp_execute_step_compiled(ctx, cache, um_handle, hostid, value_type, value, ts, step, history_value,
+			history_ts, config_source_ip, NULL);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: execute preprocessing steps                                       *
@@ -1189,7 +1305,7 @@ void	pp_execute(zbx_pp_context_t *ctx, zbx_pp_item_preproc_t *preproc, zbx_pp_ca
 {
 	zbx_pp_result_t		*results;
 	zbx_pp_history_t	*history;
-	int			quote_error, results_num, action;
+	int			quote_error, results_num, action, ret;
 	zbx_variant_t		value_raw;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s(): value:%.*s type:%s", __func__, PP_VALUE_LOG_LIMIT,
@@ -1236,8 +1352,9 @@ void	pp_execute(zbx_pp_context_t *ctx, zbx_pp_item_preproc_t *preproc, zbx_pp_ca
 
 		zbx_pp_history_pop(preproc->history, i, &history_value, &history_ts);
 
-		if (SUCCEED != pp_execute_step(ctx, cache, um_handle, preproc->hostid, preproc->value_type, value_out,
-				ts, preproc->steps + i, &history_value, &history_ts, config_source_ip))
+		if (SUCCEED != (ret = pp_execute_step_compiled(ctx, cache, um_handle, preproc->hostid,
+				preproc->value_type, value_out, ts, preproc->steps + i, &history_value, &history_ts,
+				config_source_ip, pp_pipeline_get_step(preproc, i))))
 		{
 			zbx_variant_copy(&value_raw, value_out);
 
@@ -1263,7 +1380,12 @@ void	pp_execute(zbx_pp_context_t *ctx, zbx_pp_item_preproc_t *preproc, zbx_pp_ca
 
 		zbx_variant_clear(&history_value);
 
-		cache = NULL;
+		/* the cache can be used by following steps while the value is not changed */
+		if (SUCCEED != ret || ZBX_VARIANT_ERR == value_out->type ||
+				SUCCEED != pp_cache_is_step_transparent(preproc->steps[i].type))
+		{
+			cache = NULL;
+		}
 
 		if (ZBX_VARIANT_NONE == value_out->type)
 			break;
@@ -16,6 +16,8 @@
 #include "pp_worker.h"
 #include "pp_queue.h"
 #include "pp_task.h"
+#include "pp_buffer.h"
+#include "pp_pipeline.h"
 #include "zbxpreproc.h"
 #include "zbxalgo.h"
 #include "zbxtimekeeper.h"
@@ -34,6 +36,7 @@
 #include "zbxthreads.h"
 #include "zbxtime.h"
 #include "zbxrtc.h"
+#include "zbxregexp.h"
 #include "zbxpreprocbase.h"
 #include "zbx_rtc_constants.h"
 
@@ -144,7 +147,7 @@ static zbx_pp_manager_t	*zbx_pp_manager_create(int workers_num, zbx_pp_notify_cb
 	manager = (zbx_pp_manager_t *)zbx_malloc(NULL, sizeof(zbx_pp_manager_t));
 	memset(manager, 0, sizeof(zbx_pp_manager_t));
 
-	if (SUCCEED != pp_task_queue_init(&manager->queue, error))
+	if (SUCCEED != pp_task_queue_init(&manager->queue, workers_num, error))
 		goto out;
 
 	manager->timekeeper = zbx_timekeeper_create(workers_num, NULL);
@@ -244,6 +247,7 @@ static void	zbx_pp_manager_free(zbx_pp_manager_t *manager)
 #endif
 	pp_curl_destroy();
 	pp_xml_destroy();
+	zbx_deinit_regexp_env();
 
 	zbx_ipc_async_socket_close(&manager->rtc);
 
@@ -344,22 +348,31 @@ static zbx_pp_task_t	*zbx_pp_manager_create_task(zbx_pp_manager_t *manager, zbx_
  * Return value: The first dependent item with cacheable preprocessing data   *
  *               or NULL.                                                     *
  *                                                                            *
+ * Comments: Dependent items using parsed json are preferred, because parsed  *
+ *           json usually is the most expensive cache to create and is shared *
+ *           by both 'jsonpath' and 'check for error in json' steps.          *
+ *                                                                            *
  ******************************************************************************/
 static zbx_pp_item_t	*pp_manager_get_cacheable_dependent_item(zbx_pp_manager_t *manager, zbx_uint64_t *itemids,
 		int itemids_num)
 {
-	zbx_pp_item_t	*item;
+	zbx_pp_item_t	*item, *item_cacheable = NULL;
 
 	for (int i = 0; i < itemids_num; i++)
 	{
+		int	type;
+
 		if (NULL == (item = (zbx_pp_item_t *)zbx_hashset_search(&manager->items, &itemids[i])))
 			continue;
 
-		if (SUCCEED == pp_cache_is_supported(item->preproc))
+		if (ZBX_PREPROC_JSONPATH == (type = pp_cache_get_type(item->preproc)))
 			return item;
+
+		if (NULL == item_cacheable && ZBX_PREPROC_NONE != type)
+			item_cacheable = item;
 	}
 
-	return NULL;
+	return item_cacheable;
 }
 
 /******************************************************************************
@@ -484,6 +497,10 @@ static zbx_pp_task_t	*pp_manager_queue_dependent_task_result(zbx_pp_manager_t *m
 	zbx_pp_task_value_t	*dp = (zbx_pp_task_value_t *)PP_TASK_DATA(task_value);
 
 	pp_manager_queue_value_task_result(manager, d->primary);
+
+	/* cache must not be changed after it is shared with other dependent items */
+	pp_cache_seal(d->cache);
+
 	pp_manager_queue_dependents(manager, d->preproc, dp->um_handle, task_value->itemid, &dp->result, dp->ts, d->cache);
 
 	d->primary = NULL;
@@ -590,9 +607,7 @@ static void	zbx_pp_manager_process_finished(zbx_pp_manager_t *manager, zbx_vecto
 		zbx_vector_pp_task_ptr_append(tasks, task);
 	}
 
-	*pending_num = manager->queue.pending_num;
-	*finished_num = manager->queue.finished_num;
-	*processing_num = manager->queue.processing_num;
+	pp_task_queue_get_stats(&manager->queue, pending_num, processing_num, finished_num);
 
 	pp_task_queue_unlock(&manager->queue);
 	zbx_prof_end();
@@ -662,12 +677,18 @@ zbx_hashset_t  *zbx_pp_manager_items(zbx_pp_manager_t *manager)
  *                                                                            *
  ******************************************************************************/
 static void	zbx_pp_manager_get_diag_stats(zbx_pp_manager_t *manager, zbx_uint64_t *preproc_num,
-		zbx_uint64_t *pending_num, zbx_uint64_t *finished_num, zbx_uint64_t *sequences_num)
+		zbx_uint64_t *pending_num, zbx_uint64_t *finished_num, zbx_uint64_t *sequences_num,
+		zbx_uint64_t *steal_num, zbx_uint64_t *idle_num)
 {
+	zbx_uint64_t	processing_num;
+
 	*preproc_num = (zbx_uint64_t)manager->items.num_data;
-	*pending_num = manager->queue.pending_num;
-	*finished_num = manager->queue.finished_num;
+
+	pp_task_queue_lock(&manager->queue);
+	pp_task_queue_get_stats(&manager->queue, pending_num, &processing_num, finished_num);
+	pp_task_queue_get_steal_stats(&manager->queue, steal_num, idle_num);
 	*sequences_num = (zbx_uint64_t)manager->queue.sequences.num_data;
+	pp_task_queue_unlock(&manager->queue);
 }
 
 /******************************************************************************
@@ -708,6 +729,17 @@ static void	preprocessor_sync_configuration(zbx_pp_manager_t *manager)
 	zbx_dc_config_get_preprocessable_items(&manager->items, &manager->um_handle, &revision);
 	manager->revision = revision;
 
+	if (revision != old_revision)
+	{
+		zbx_hashset_iter_t	iter;
+		zbx_pp_item_t		*item;
+
+		/* compile new item preprocessing steps before they are passed to workers */
+		zbx_hashset_iter_reset(&manager->items, &iter);
+		while (NULL != (item = (zbx_pp_item_t *)zbx_hashset_iter_next(&iter)))
+			pp_pipeline_compile(item->preproc, manager->um_handle);
+	}
+
 	if (SUCCEED == ZBX_CHECK_LOG_LEVEL(LOG_LEVEL_TRACE) && revision != old_revision)
 		zbx_pp_manager_dump_items(manager);
 
@@ -854,12 +886,13 @@ static void	preprocessing_flush_value(zbx_pp_manager_t *manager, zbx_uint64_t it
  * Purpose: handle new preprocessing request                                  *
  *                                                                            *
  * Parameters: manager - [IN] preprocessing manager                           *
- *             message - [IN] packed preprocessing request                    *
+ *             data    - [IN] packed item values                              *
+ *             size    - [IN] packed item values size                         *
  *                                                                            *
  *  Return value: The number of requests queued for preprocessing             *
  *                                                                            *
  ******************************************************************************/
-static zbx_uint64_t	preprocessor_add_request(zbx_pp_manager_t *manager, zbx_ipc_message_t *message)
+static zbx_uint64_t	preprocessor_add_request(zbx_pp_manager_t *manager, unsigned char *data, zbx_uint32_t size)
 {
 	zbx_uint32_t			offset = 0;
 	zbx_preproc_item_value_t	value;
@@ -873,14 +906,14 @@ static zbx_uint64_t	preprocessor_add_request(zbx_pp_manager_t *manager, zbx_ipc_
 
 	preprocessor_sync_configuration(manager);
 
-	while (offset < message->size)
+	while (offset < size)
 	{
 		zbx_variant_t		var;
 		zbx_pp_value_opt_t	var_opt;
 		zbx_timespec_t		ts;
 		zbx_pp_task_t		*task;
 
-		offset += zbx_preprocessor_unpack_value(&value, message->data + offset);
+		offset += zbx_preprocessor_unpack_value(&value, data + offset);
 		preproc_item_value_extract_data(&value, &var, &ts, &var_opt);
 
 		if (NULL == (task = zbx_pp_manager_create_task(manager, value.itemid, &var, ts, &var_opt)))
@@ -909,6 +942,31 @@ static zbx_uint64_t	preprocessor_add_request(zbx_pp_manager_t *manager, zbx_ipc_
 	return queued_num;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: handle item values queued in preprocessing buffer                 *
+ *                                                                            *
+ * Parameters: manager - [IN] preprocessing manager                           *
+ *                                                                            *
+ *  Return value: The number of requests queued for preprocessing             *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_uint64_t	preprocessor_add_buffered_requests(zbx_pp_manager_t *manager)
+{
+	zbx_pp_buffer_block_t	*blocks, *block;
+	zbx_uint64_t		queued_num = 0;
+
+	if (NULL == (blocks = pp_buffer_pop_all()))
+		return 0;
+
+	for (block = blocks; NULL != block; block = block->next)
+		queued_num += preprocessor_add_request(manager, block->data, block->size);
+
+	pp_buffer_free(blocks);
+
+	return queued_num;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: handle new preprocessing test request                             *
@@ -937,7 +995,11 @@ static void	preprocessor_add_test_request(zbx_pp_manager_t *manager, zbx_ipc_cli
 
 static void	preprocessor_reply_queue_size(zbx_pp_manager_t *manager, zbx_ipc_client_t *client)
 {
-	zbx_uint64_t	pending_num = manager->queue.pending_num;
+	zbx_uint64_t	pending_num, processing_num, finished_num;
+
+	pp_task_queue_lock(&manager->queue);
+	pp_task_queue_get_stats(&manager->queue, &pending_num, &processing_num, &finished_num);
+	pp_task_queue_unlock(&manager->queue);
 
 	zbx_ipc_client_send(client, ZBX_IPC_PREPROCESSOR_QUEUE, (unsigned char *)&pending_num, sizeof(pending_num));
 }
@@ -1026,12 +1088,14 @@ static void	preprocessor_flush_tasks(zbx_pp_manager_t *manager, zbx_vector_pp_ta
  ******************************************************************************/
 static void	preprocessor_reply_diag_info(zbx_pp_manager_t *manager, zbx_ipc_client_t *client)
 {
-	zbx_uint64_t	preproc_num, pending_num, finished_num, sequences_num;
+	zbx_uint64_t	preproc_num, pending_num, finished_num, sequences_num, steal_num, idle_num;
 	unsigned char	*data;
 	zbx_uint32_t	data_len;
 
-	zbx_pp_manager_get_diag_stats(manager, &preproc_num, &pending_num, &finished_num, &sequences_num);
-	data_len = zbx_preprocessor_pack_diag_stats(&data, preproc_num, pending_num, finished_num, sequences_num);
+	zbx_pp_manager_get_diag_stats(manager, &preproc_num, &pending_num, &finished_num, &sequences_num, &steal_num,
+			&idle_num);
+	data_len = zbx_preprocessor_pack_diag_stats(&data, preproc_num, pending_num, finished_num, sequences_num,
+			steal_num, idle_num);
 
 	zbx_ipc_client_send(client, ZBX_IPC_PREPROCESSOR_DIAG_STATS_RESULT, data, data_len);
 
@@ -1269,7 +1333,13 @@ ZBX_THREAD_ENTRY(zbx_pp_manager_thread, args)
 			switch (message->code)
 			{
 				case ZBX_IPC_PREPROCESSOR_REQUEST:
-					queued_num += preprocessor_add_request(manager, message);
+					/* values are sent by socket only after the sender's buffered values */
+					/* were taken, other buffered values are older than this request     */
+					queued_num += preprocessor_add_buffered_requests(manager);
+					queued_num += preprocessor_add_request(manager, message->data, message->size);
+					break;
+				case ZBX_IPC_PREPROCESSOR_BUFFER_NOTIFY:
+					queued_num += preprocessor_add_buffered_requests(manager);
 					break;
 				case ZBX_IPC_PREPROCESSOR_QUEUE:
 					preprocessor_reply_queue_size(manager, client);
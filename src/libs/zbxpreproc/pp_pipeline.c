@@ -0,0 +1,211 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "pp_pipeline.h"
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: free compiled preprocessing step data                             *
+ *                                                                            *
+ ******************************************************************************/
+static void	pp_step_compiled_clear(zbx_pp_step_compiled_t *step)
+{
+	if (NULL != step->jsonpath)
+	{
+		zbx_jsonpath_clear(step->jsonpath);
+		zbx_free(step->jsonpath);
+	}
+
+	if (NULL != step->regexp)
+		zbx_regexp_free(step->regexp);
+
+	zbx_free(step->params);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: free compiled item preprocessing steps                            *
+ *                                                                            *
+ ******************************************************************************/
+static void	pp_pipeline_free(void *data)
+{
+	zbx_pp_pipeline_t	*pipeline = (zbx_pp_pipeline_t *)data;
+
+	for (int i = 0; i < pipeline->steps_num; i++)
+		pp_step_compiled_clear(&pipeline->steps[i]);
+
+	zbx_free(pipeline->steps);
+	zbx_free(pipeline);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: check if preprocessing step parameters are parsed at compile time *
+ *                                                                            *
+ * Parameters: type - [IN] preprocessing step type                            *
+ *                                                                            *
+ * Return value: SUCCEED - step parameters are compiled                       *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	pp_step_is_compiled(unsigned char type)
+{
+	switch (type)
+	{
+		case ZBX_PREPROC_JSONPATH:
+		case ZBX_PREPROC_ERROR_FIELD_JSON:
+		case ZBX_PREPROC_REGSUB:
+		case ZBX_PREPROC_VALIDATE_REGEX:
+		case ZBX_PREPROC_VALIDATE_NOT_REGEX:
+			return SUCCEED;
+		default:
+			return FAIL;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compile preprocessing step parameters                             *
+ *                                                                            *
+ * Parameters: step      - [OUT] compiled step                                *
+ *             step_src  - [IN] preprocessing step                            *
+ *             hostid    - [IN] item host identifier                          *
+ *             um_handle - [IN] shared user macro cache handle (optional)     *
+ *                                                                            *
+ * Comments: Only jsonpath and regular expression parameters are compiled,    *
+ *           with user macros expanded at compile time. Parameters of other   *
+ *           steps (including scripts, which use secure macro environment)    *
+ *           are expanded when executing the step. If compilation fails the   *
+ *           step is left without compiled data, so the error is reported     *
+ *           when executing the step.                                         *
+ *                                                                            *
+ ******************************************************************************/
+static void	pp_step_compile(zbx_pp_step_compiled_t *step, const zbx_pp_step_t *step_src, zbx_uint64_t hostid,
+		zbx_dc_um_shared_handle_t *um_handle)
+{
+	char		*pattern, *ptr, *error = NULL;
+	const char	*params;
+
+	memset(step, 0, sizeof(zbx_pp_step_compiled_t));
+
+	if (NULL == step_src->params)
+		return;
+
+	if (NULL != strchr(step_src->params, '{'))
+		step->has_macros = 1;
+
+	if (SUCCEED != pp_step_is_compiled(step_src->type))
+		return;
+
+	if (0 != step->has_macros)
+	{
+		step->params = zbx_strdup(NULL, step_src->params);
+
+		if (NULL != um_handle && SUCCEED != zbx_dc_expand_user_and_func_macros_from_cache(
+				um_handle->um_cache, &step->params, &hostid, 1, ZBX_MACRO_ENV_NONSECURE, &error))
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "cannot resolve user macros: %s", error);
+			zbx_free(error);
+		}
+
+		params = step->params;
+	}
+	else
+		params = step_src->params;
+
+	switch (step_src->type)
+	{
+		case ZBX_PREPROC_JSONPATH:
+		case ZBX_PREPROC_ERROR_FIELD_JSON:
+			step->jsonpath = (zbx_jsonpath_t *)zbx_malloc(NULL, sizeof(zbx_jsonpath_t));
+
+			if (FAIL == zbx_jsonpath_compile(params, step->jsonpath))
+				zbx_free(step->jsonpath);
+			break;
+		case ZBX_PREPROC_REGSUB:
+			pattern = zbx_strdup(NULL, params);
+
+			/* PCRE_MULTILINE is not used here, see item_preproc_regsub_op_ext() */
+			if (NULL != (ptr = strchr(pattern, '\n')))
+			{
+				*ptr = '\0';
+
+				if (FAIL == zbx_regexp_compile_ext(pattern, &step->regexp, 0, &error))
+					step->regexp = NULL;
+			}
+
+			zbx_free(pattern);
+			break;
+		case ZBX_PREPROC_VALIDATE_REGEX:
+		case ZBX_PREPROC_VALIDATE_NOT_REGEX:
+			if (FAIL == zbx_regexp_compile(params, &step->regexp, &error))
+				step->regexp = NULL;
+			break;
+	}
+
+	zbx_free(error);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compile item preprocessing steps                                  *
+ *                                                                            *
+ * Parameters: preproc   - [IN/OUT] item preprocessing data                   *
+ *             um_handle - [IN] shared user macro cache handle (optional)     *
+ *                                                                            *
+ * Comments: Preprocessing steps are compiled only once, when new item        *
+ *           preprocessing data is received from configuration cache and      *
+ *           before it is passed to workers. After that the compiled steps    *
+ *           are only read, so they can be shared between workers.            *
+ *                                                                            *
+ ******************************************************************************/
+void	pp_pipeline_compile(zbx_pp_item_preproc_t *preproc, zbx_dc_um_shared_handle_t *um_handle)
+{
+	zbx_pp_pipeline_t	*pipeline;
+
+	if (NULL != preproc->compiled || 0 == preproc->steps_num)
+		return;
+
+	pipeline = (zbx_pp_pipeline_t *)zbx_malloc(NULL, sizeof(zbx_pp_pipeline_t));
+	pipeline->steps_num = preproc->steps_num;
+	pipeline->steps = (zbx_pp_step_compiled_t *)zbx_malloc(NULL,
+			sizeof(zbx_pp_step_compiled_t) * (size_t)preproc->steps_num);
+
+	for (int i = 0; i < preproc->steps_num; i++)
+		pp_step_compile(&pipeline->steps[i], &preproc->steps[i], preproc->hostid, um_handle);
+
+	preproc->compiled = pipeline;
+	preproc->compiled_free = pp_pipeline_free;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get compiled preprocessing step                                   *
+ *                                                                            *
+ * Parameters: preproc - [IN] item preprocessing data                         *
+ *             index   - [IN] step index                                      *
+ *                                                                            *
+ * Return value: The compiled step or NULL if item preprocessing steps were   *
+ *               not compiled.                                                *
+ *                                                                            *
+ ******************************************************************************/
+const zbx_pp_step_compiled_t	*pp_pipeline_get_step(const zbx_pp_item_preproc_t *preproc, int index)
+{
+	const zbx_pp_pipeline_t	*pipeline;
+
+	if (NULL == (pipeline = (const zbx_pp_pipeline_t *)preproc->compiled) || index >= pipeline->steps_num)
+		return NULL;
+
+	return &pipeline->steps[index];
+}
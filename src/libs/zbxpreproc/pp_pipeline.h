@@ -0,0 +1,44 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#ifndef ZABBIX_PP_PIPELINE_H
+#define ZABBIX_PP_PIPELINE_H
+
+#include "zbxpreprocbase.h"
+#include "zbxcacheconfig.h"
+#include "zbxjson.h"
+#include "zbxregexp.h"
+
+/* compiled preprocessing step */
+typedef struct
+{
+	int		has_macros;	/* 1 if step parameters contain macros, 0 otherwise */
+	char		*params;	/* compiled step parameters with macros expanded at compile time */
+	zbx_jsonpath_t	*jsonpath;	/* compiled jsonpath of 'jsonpath' and 'error from json' steps */
+	zbx_regexp_t	*regexp;	/* compiled pattern of 'regsub' and 'validate (not) regex' steps */
+}
+zbx_pp_step_compiled_t;
+
+/* compiled item preprocessing steps */
+typedef struct
+{
+	int			steps_num;
+	zbx_pp_step_compiled_t	*steps;
+}
+zbx_pp_pipeline_t;
+
+void	pp_pipeline_compile(zbx_pp_item_preproc_t *preproc, zbx_dc_um_shared_handle_t *um_handle);
+const zbx_pp_step_compiled_t	*pp_pipeline_get_step(const zbx_pp_item_preproc_t *preproc, int index);
+
+#endif
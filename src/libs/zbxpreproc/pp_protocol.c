@@ -13,6 +13,7 @@
 **/
 
 #include "pp_protocol.h"
+#include "pp_buffer.h"
 #include "zbxpreproc.h"
 
 #include "zbxserialize.h"
@@ -477,10 +478,13 @@ zbx_uint32_t	zbx_preprocessor_pack_test_result(unsigned char **data, const zbx_p
  *                               preprocessed                                 *
  *             finished_num  - [IN] number of values being preprocessed       *
  *             sequences_num - [IN] number of registered task sequences       *
+ *             steal_num     - [IN] number of tasks stolen by idle workers    *
+ *             idle_num      - [IN] number of times workers went idle         *
  *                                                                            *
  ******************************************************************************/
 zbx_uint32_t	zbx_preprocessor_pack_diag_stats(unsigned char **data, zbx_uint64_t preproc_num,
-		zbx_uint64_t pending_num, zbx_uint64_t finished_num, zbx_uint64_t sequences_num)
+		zbx_uint64_t pending_num, zbx_uint64_t finished_num, zbx_uint64_t sequences_num, zbx_uint64_t steal_num,
+		zbx_uint64_t idle_num)
 {
 	unsigned char	*ptr;
 	zbx_uint32_t	data_len = 0;
@@ -489,6 +493,8 @@ zbx_uint32_t	zbx_preprocessor_pack_diag_stats(unsigned char **data, zbx_uint64_t
 	zbx_serialize_prepare_value(data_len, pending_num);
 	zbx_serialize_prepare_value(data_len, finished_num);
 	zbx_serialize_prepare_value(data_len, sequences_num);
+	zbx_serialize_prepare_value(data_len, steal_num);
+	zbx_serialize_prepare_value(data_len, idle_num);
 
 	*data = (unsigned char *)zbx_malloc(NULL, data_len);
 
@@ -496,7 +502,9 @@ zbx_uint32_t	zbx_preprocessor_pack_diag_stats(unsigned char **data, zbx_uint64_t
 	ptr += zbx_serialize_value(ptr, preproc_num);
 	ptr += zbx_serialize_value(ptr, pending_num);
 	ptr += zbx_serialize_value(ptr, finished_num);
-	(void)zbx_serialize_value(ptr, sequences_num);
+	ptr += zbx_serialize_value(ptr, sequences_num);
+	ptr += zbx_serialize_value(ptr, steal_num);
+	(void)zbx_serialize_value(ptr, idle_num);
 
 	return data_len;
 }
@@ -699,18 +707,23 @@ void	zbx_preprocessor_unpack_test_result(zbx_vector_pp_result_ptr_t *results, zb
  *                               preprocessed                                 *
  *             finished_num  - [OUT] number of values being preprocessed      *
  *             sequences_num - [OUT] number of registered task sequences      *
+ *             steal_num     - [OUT] number of tasks stolen by idle workers   *
+ *             idle_num      - [OUT] number of times workers went idle        *
  *             data          - [OUT] data buffer                              *
  *                                                                            *
  ******************************************************************************/
 void	zbx_preprocessor_unpack_diag_stats(zbx_uint64_t *preproc_num, zbx_uint64_t *pending_num,
-		zbx_uint64_t *finished_num, zbx_uint64_t *sequences_num, const unsigned char *data)
+		zbx_uint64_t *finished_num, zbx_uint64_t *sequences_num, zbx_uint64_t *steal_num, zbx_uint64_t *idle_num,
+		const unsigned char *data)
 {
 	const unsigned char	*offset = data;
 
 	offset += zbx_deserialize_value(offset, preproc_num);
 	offset += zbx_deserialize_value(offset, pending_num);
 	offset += zbx_deserialize_value(offset, finished_num);
-	(void)zbx_deserialize_value(offset, sequences_num);
+	offset += zbx_deserialize_value(offset, sequences_num);
+	offset += zbx_deserialize_value(offset, steal_num);
+	(void)zbx_deserialize_value(offset, idle_num);
 }
 
 /******************************************************************************
@@ -901,7 +914,25 @@ void	zbx_preprocessor_flush(void)
 {
 	if (0 < cached_message.size)
 	{
-		preprocessor_send(ZBX_IPC_PREPROCESSOR_REQUEST, cached_message.data, cached_message.size, NULL);
+		int	ret, notify;
+
+		/* pass values through preprocessing buffer if possible - when it's full wait until manager */
+		/* takes the queued values, so values sent over socket cannot overtake the buffered ones.  */
+		/* If the wait times out or the process is stopping the values are sent over socket anyway */
+		/* and may overtake the buffered ones, as the manager is stalled or already gone.          */
+		if (SUCCEED != (ret = pp_buffer_push(cached_message.data, cached_message.size, &notify)) &&
+				SUCCEED == pp_buffer_wait_drained())
+		{
+			ret = pp_buffer_push(cached_message.data, cached_message.size, &notify);
+		}
+
+		if (SUCCEED == ret)
+		{
+			if (0 != notify)
+				preprocessor_send(ZBX_IPC_PREPROCESSOR_BUFFER_NOTIFY, NULL, 0, NULL);
+		}
+		else
+			preprocessor_send(ZBX_IPC_PREPROCESSOR_REQUEST, cached_message.data, cached_message.size, NULL);
 
 		zbx_ipc_message_clean(&cached_message);
 		zbx_ipc_message_init(&cached_message);
@@ -1056,7 +1087,8 @@ out:
  *                                                                            *
  ******************************************************************************/
 int	zbx_preprocessor_get_diag_stats(zbx_uint64_t *preproc_num, zbx_uint64_t *pending_num,
-		zbx_uint64_t *finished_num, zbx_uint64_t *sequences_num, char **error)
+		zbx_uint64_t *finished_num, zbx_uint64_t *sequences_num, zbx_uint64_t *steal_num, zbx_uint64_t *idle_num,
+		char **error)
 {
 	unsigned char	*result;
 
@@ -1066,7 +1098,8 @@ int	zbx_preprocessor_get_diag_stats(zbx_uint64_t *preproc_num, zbx_uint64_t *pen
 		return FAIL;
 	}
 
-	zbx_preprocessor_unpack_diag_stats(preproc_num, pending_num, finished_num, sequences_num, result);
+	zbx_preprocessor_unpack_diag_stats(preproc_num, pending_num, finished_num, sequences_num, steal_num, idle_num,
+			result);
 	zbx_free(result);
 
 	return SUCCEED;
@@ -35,27 +35,46 @@ zbx_pp_item_task_sequence_t;
  *                                                                            *
  * Purpose: initialize task queue                                             *
  *                                                                            *
- * Parameters: queue - [IN] task queue                                        *
- *             error - [OUT]                                                  *
+ * Parameters: queue      - [IN] task queue                                   *
+ *             deques_num - [IN] number of per worker task deques             *
+ *             error      - [OUT]                                             *
  *                                                                            *
  * Return value: SUCCEED - the task queue was initialized successfully        *
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-int	pp_task_queue_init(zbx_pp_queue_t *queue, char **error)
+int	pp_task_queue_init(zbx_pp_queue_t *queue, int deques_num, char **error)
 {
 	int	err, ret = FAIL;
 
 	queue->workers_num = 0;
-	queue->pending_num = 0;
+	queue->pushed_num = 0;
 	queue->finished_num = 0;
-	queue->processing_num = 0;
-	zbx_list_create(&queue->pending);
-	zbx_list_create(&queue->immediate);
+	queue->processed_num = 0;
+	queue->idle_num = 0;
 	zbx_list_create(&queue->finished);
 
 	zbx_hashset_create(&queue->sequences, 100, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
+	queue->deques_num = deques_num;
+	queue->deques_init_num = 0;
+	queue->deque_next = 0;
+	queue->deques = (zbx_pp_task_deque_t *)zbx_calloc(NULL, (size_t)deques_num, sizeof(zbx_pp_task_deque_t));
+
+	for (; queue->deques_init_num < deques_num; queue->deques_init_num++)
+	{
+		zbx_pp_task_deque_t	*deque = &queue->deques[queue->deques_init_num];
+
+		if (0 != (err = pthread_mutex_init(&deque->lock, NULL)))
+		{
+			*error = zbx_dsprintf(NULL, "cannot initialize task deque mutex: %s", zbx_strerror(err));
+			goto out;
+		}
+
+		zbx_list_create(&deque->pending);
+		zbx_list_create(&deque->immediate);
+	}
+
 	if (0 != (err = pthread_mutex_init(&queue->lock, NULL)))
 	{
 		*error = zbx_dsprintf(NULL, "cannot initialize task queue mutex: %s", zbx_strerror(err));
@@ -104,11 +123,22 @@ void	pp_task_queue_destroy(zbx_pp_queue_t *queue)
 	if (0 != (queue->init_flags & PP_TASK_QUEUE_INIT_EVENT))
 		pthread_cond_destroy(&queue->event);
 
-	pp_task_queue_clear_tasks(&queue->pending);
-	zbx_list_destroy(&queue->pending);
+	for (int i = 0; i < queue->deques_init_num; i++)
+	{
+		zbx_pp_task_deque_t	*deque = &queue->deques[i];
+
+		pthread_mutex_destroy(&deque->lock);
 
-	pp_task_queue_clear_tasks(&queue->immediate);
-	zbx_list_destroy(&queue->immediate);
+		pp_task_queue_clear_tasks(&deque->pending);
+		zbx_list_destroy(&deque->pending);
+
+		pp_task_queue_clear_tasks(&deque->immediate);
+		zbx_list_destroy(&deque->immediate);
+	}
+
+	zbx_free(queue->deques);
+	queue->deques_num = 0;
+	queue->deques_init_num = 0;
 
 	pp_task_queue_clear_tasks(&queue->finished);
 	zbx_list_destroy(&queue->finished);
@@ -194,6 +224,32 @@ static zbx_pp_task_t	*pp_task_queue_add_sequence(zbx_pp_queue_t *queue, zbx_pp_t
 	return new_task;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: append task to the next worker task deque                         *
+ *                                                                            *
+ * Parameters: queue     - [IN] task queue                                    *
+ *             task      - [IN] task to append                                *
+ *             immediate - [IN] 1 - task must be processed before normal      *
+ *                                  tasks                                     *
+ *                              0 - otherwise                                 *
+ *                                                                            *
+ * Comments: Tasks are distributed between worker deques in round robin       *
+ *           order, idle workers will steal them from busy ones.              *
+ *                                                                            *
+ ******************************************************************************/
+static void	pp_task_queue_append(zbx_pp_queue_t *queue, zbx_pp_task_t *task, int immediate)
+{
+	zbx_pp_task_deque_t	*deque = &queue->deques[queue->deque_next];
+
+	if (++queue->deque_next == queue->deques_num)
+		queue->deque_next = 0;
+
+	pthread_mutex_lock(&deque->lock);
+	(void)zbx_list_append(0 != immediate ? &deque->immediate : &deque->pending, task, NULL);
+	pthread_mutex_unlock(&deque->lock);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: queue task to be processed before normal tasks                    *
@@ -208,20 +264,20 @@ void	pp_task_queue_push_immediate(zbx_pp_queue_t *queue, zbx_pp_task_t *task)
 	{
 		case ZBX_PP_TASK_VALUE_SEQ:
 		case ZBX_PP_TASK_DEPENDENT:
-			queue->pending_num++;
+			queue->pushed_num++;
 			if (NULL == (task = pp_task_queue_add_sequence(queue, task)))
 				return;
 			break;
 		case ZBX_PP_TASK_SEQUENCE:
 			/* sequence task is just a container for other tasks - it does not affect statistics, */
-			/* so there is no need to increment queue->pending_num                                */
+			/* so there is no need to increment queue->pushed_num                                 */
 			break;
 		default:
-			queue->pending_num++;
+			queue->pushed_num++;
 			break;
 	}
 
-	(void)zbx_list_append(&queue->immediate, task, NULL);
+	pp_task_queue_append(queue, task, 1);
 }
 
 /******************************************************************************
@@ -247,8 +303,8 @@ void	pp_task_queue_remove_sequence(zbx_pp_queue_t *queue, zbx_uint64_t itemid)
  ******************************************************************************/
 void	pp_task_queue_push_test(zbx_pp_queue_t *queue, zbx_pp_task_t *task)
 {
-	queue->pending_num++;
-	(void)zbx_list_append(&queue->immediate, task, NULL);
+	queue->pushed_num++;
+	pp_task_queue_append(queue, task, 1);
 }
 
 /******************************************************************************
@@ -260,29 +316,55 @@ void	pp_task_queue_push_test(zbx_pp_queue_t *queue, zbx_pp_task_t *task)
  *                                                                            *
  * Comments: This function is used to push tasks created by new preprocessing *
  *           or testing requests.                                             *
+ *           Sequence tasks are registered in their item sequences here,      *
+ *           while pushing, so that their order is preserved regardless of    *
+ *           which worker picks or steals the sequence.                       *
  *                                                                            *
  ******************************************************************************/
 void	pp_task_queue_push(zbx_pp_queue_t *queue, zbx_pp_task_t *task)
 {
 	zbx_pp_task_value_t	*d = (zbx_pp_task_value_t *)PP_TASK_DATA(task);
-	queue->pending_num++;
+	int			immediate = (ITEM_TYPE_INTERNAL == d->preproc->type ? 1 : 0);
 
-	if (ITEM_TYPE_INTERNAL != d->preproc->type)
-	{
-		(void)zbx_list_append(&queue->pending, task, NULL);
+	queue->pushed_num++;
+
+	if (ZBX_PP_TASK_VALUE_SEQ == task->type && NULL == (task = pp_task_queue_add_sequence(queue, task)))
 		return;
-	}
 
-	if (ZBX_PP_TASK_VALUE == task->type)
+	pp_task_queue_append(queue, task, immediate);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: pop task from worker task deque                                   *
+ *                                                                            *
+ * Parameters: deque - [IN] worker task deque                                 *
+ *             steal - [IN] 1 - the task is being stolen by another worker    *
+ *                          0 - otherwise                                     *
+ *                                                                            *
+ * Return value: The popped task or NULL if the deque is empty.               *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_pp_task_t	*pp_task_deque_pop(zbx_pp_task_deque_t *deque, int steal)
+{
+	zbx_pp_task_t	*task = NULL;
+
+	pthread_mutex_lock(&deque->lock);
+
+	if (SUCCEED == zbx_list_pop(&deque->immediate, (void **)&task) ||
+			SUCCEED == zbx_list_pop(&deque->pending, (void **)&task))
 	{
-		(void)zbx_list_append(&queue->immediate, task, NULL);
-		return;
+		/* while sequence tasks do not affect statistics, the first task in sequence */
+		/* does, so the statistics can be updated for all tasks                      */
+		deque->popped_num++;
+
+		if (0 != steal)
+			deque->stolen_num++;
 	}
 
-	zbx_pp_task_t	*seq_task;
+	pthread_mutex_unlock(&deque->lock);
 
-	if (NULL != (seq_task = pp_task_queue_add_sequence(queue, task)))
-		(void)zbx_list_append(&queue->immediate, seq_task, NULL);
+	return task;
 }
 
 /******************************************************************************
@@ -290,45 +372,28 @@ void	pp_task_queue_push(zbx_pp_queue_t *queue, zbx_pp_task_t *task)
  * Purpose: pop task from task queue                                          *
  *                                                                            *
  * Parameters: queue - [IN] task queue                                        *
+ *             index - [IN] worker task deque index                           *
  *                                                                            *
  * Return value: The popped task or NULL if there are no tasks to be          *
  *               processed.                                                   *
  *                                                                            *
  * Comments: This function is used by workers to pop tasks for processing.    *
- *           Sequence tasks will be moved to existing tasks sequences or      *
- *           returned if there are no registered sequences for this item.     *
+ *           Tasks are popped from the worker's own deque first and stolen    *
+ *           from other worker deques when it is empty. Task queue lock is    *
+ *           not required, only the deque locks are used.                     *
  *                                                                            *
  ******************************************************************************/
-zbx_pp_task_t	*pp_task_queue_pop_new(zbx_pp_queue_t *queue)
+zbx_pp_task_t	*pp_task_queue_pop_new(zbx_pp_queue_t *queue, int index)
 {
-	zbx_pp_task_t	*task = NULL;
-
-	if (SUCCEED == zbx_list_pop(&queue->immediate, (void **)&task))
-	{
-		/* while sequence tasks do not affect statistics, the first task in sequence */
-		/* does, so the statistics can be updated for all tasks                      */
-		queue->pending_num--;
-		queue->processing_num++;
+	zbx_pp_task_t	*task;
 
-		return (zbx_pp_task_t *)task;
-	}
+	if (NULL != (task = pp_task_deque_pop(&queue->deques[index], 0)))
+		return task;
 
-	while (SUCCEED == zbx_list_pop(&queue->pending, (void **)&task))
+	for (int i = 1; i < queue->deques_num; i++)
 	{
-		if (ZBX_PP_TASK_VALUE_SEQ == task->type)
-		{
-			/* task is being moved from pending to immediate queue */
-			/* while still pending, so statistics are not affected */
-			task = pp_task_queue_add_sequence(queue, task);
-		}
-
-		if (NULL != task)
-		{
-			queue->pending_num--;
-			queue->processing_num++;
-
+		if (NULL != (task = pp_task_deque_pop(&queue->deques[(index + i) % queue->deques_num], 1)))
 			return task;
-		}
 	}
 
 	return NULL;
@@ -345,7 +410,7 @@ zbx_pp_task_t	*pp_task_queue_pop_new(zbx_pp_queue_t *queue)
 void	pp_task_queue_push_finished(zbx_pp_queue_t *queue, zbx_pp_task_t *task)
 {
 	queue->finished_num++;
-	queue->processing_num--;
+	queue->processed_num++;
 	(void)zbx_list_append(&queue->finished, task, NULL);
 }
 
@@ -388,6 +453,8 @@ int	pp_task_queue_wait(zbx_pp_queue_t *queue, char **error)
 {
 	int	err;
 
+	queue->idle_num++;
+
 	if (0 != (err = pthread_cond_wait(&queue->event, &queue->lock)))
 	{
 		*error = zbx_dsprintf(NULL, "cannot wait for conditional variable: %s", zbx_strerror(err));
@@ -437,6 +504,62 @@ void	pp_task_queue_notify_all(zbx_pp_queue_t *queue)
 	}
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get task queue statistics                                         *
+ *                                                                            *
+ * Parameters: queue          - [IN] task queue                               *
+ *             pending_num    - [OUT] number of tasks waiting to be processed *
+ *             processing_num - [OUT] number of tasks being processed         *
+ *             finished_num   - [OUT] number of finished tasks                *
+ *                                                                            *
+ * Comments: This function must be called with task queue locked.             *
+ *                                                                            *
+ ******************************************************************************/
+void	pp_task_queue_get_stats(zbx_pp_queue_t *queue, zbx_uint64_t *pending_num, zbx_uint64_t *processing_num,
+		zbx_uint64_t *finished_num)
+{
+	zbx_uint64_t	popped_num = 0;
+
+	for (int i = 0; i < queue->deques_num; i++)
+	{
+		pthread_mutex_lock(&queue->deques[i].lock);
+		popped_num += queue->deques[i].popped_num;
+		pthread_mutex_unlock(&queue->deques[i].lock);
+	}
+
+	*pending_num = queue->pushed_num - popped_num;
+	*processing_num = popped_num - queue->processed_num;
+	*finished_num = queue->finished_num;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get work stealing statistics                                      *
+ *                                                                            *
+ * Parameters: queue     - [IN] task queue                                    *
+ *             steal_num - [OUT] number of tasks stolen by idle workers from  *
+ *                               other worker deques                          *
+ *             idle_num  - [OUT] number of times workers had no tasks to      *
+ *                               process and went idle                        *
+ *                                                                            *
+ * Comments: This function must be called with task queue locked.             *
+ *                                                                            *
+ ******************************************************************************/
+void	pp_task_queue_get_steal_stats(zbx_pp_queue_t *queue, zbx_uint64_t *steal_num, zbx_uint64_t *idle_num)
+{
+	*steal_num = 0;
+
+	for (int i = 0; i < queue->deques_num; i++)
+	{
+		pthread_mutex_lock(&queue->deques[i].lock);
+		*steal_num += queue->deques[i].stolen_num;
+		pthread_mutex_unlock(&queue->deques[i].lock);
+	}
+
+	*idle_num = queue->idle_num;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: get registered task sequence statistics sorted by number of tasks *
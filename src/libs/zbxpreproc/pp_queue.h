@@ -18,18 +18,35 @@
 #include "zbxpreproc.h"
 #include "zbxalgo.h"
 
+/* per worker task queue, other workers steal tasks from it when their own queues are empty */
+typedef struct
+{
+	zbx_list_t	pending;
+	zbx_list_t	immediate;
+
+	zbx_uint64_t	popped_num;
+	zbx_uint64_t	stolen_num;
+
+	pthread_mutex_t	lock;
+}
+zbx_pp_task_deque_t;
+
 typedef struct
 {
 	zbx_uint32_t	init_flags;
 	int		workers_num;
-	zbx_uint64_t	pending_num;
+	zbx_uint64_t	pushed_num;
 	zbx_uint64_t	finished_num;
-	zbx_uint64_t	processing_num;
+	zbx_uint64_t	processed_num;
+	zbx_uint64_t	idle_num;
 
 	zbx_hashset_t	sequences;
 
-	zbx_list_t	pending;
-	zbx_list_t	immediate;
+	zbx_pp_task_deque_t	*deques;
+	int			deques_num;
+	int			deques_init_num;
+	int			deque_next;
+
 	zbx_list_t	finished;
 
 	pthread_mutex_t	lock;
@@ -37,7 +54,7 @@ typedef struct
 }
 zbx_pp_queue_t;
 
-int	pp_task_queue_init(zbx_pp_queue_t *queue, char **error);
+int	pp_task_queue_init(zbx_pp_queue_t *queue, int deques_num, char **error);
 void	pp_task_queue_destroy(zbx_pp_queue_t *queue);
 
 void	pp_task_queue_lock(zbx_pp_queue_t *queue);
@@ -53,11 +70,14 @@ void	pp_task_queue_notify_all(zbx_pp_queue_t *queue);
 void	pp_task_queue_push_test(zbx_pp_queue_t *queue, zbx_pp_task_t *task);
 void	pp_task_queue_push(zbx_pp_queue_t *queue, zbx_pp_task_t *task);
 
-zbx_pp_task_t	*pp_task_queue_pop_new(zbx_pp_queue_t *queue);
+zbx_pp_task_t	*pp_task_queue_pop_new(zbx_pp_queue_t *queue, int index);
 void	pp_task_queue_push_immediate(zbx_pp_queue_t *queue, zbx_pp_task_t *task);
 void	pp_task_queue_push_finished(zbx_pp_queue_t *queue, zbx_pp_task_t *task);
 zbx_pp_task_t	*pp_task_queue_pop_finished(zbx_pp_queue_t *queue);
 
+void	pp_task_queue_get_stats(zbx_pp_queue_t *queue, zbx_uint64_t *pending_num, zbx_uint64_t *processing_num,
+		zbx_uint64_t *finished_num);
+void	pp_task_queue_get_steal_stats(zbx_pp_queue_t *queue, zbx_uint64_t *steal_num, zbx_uint64_t *idle_num);
 void	pp_task_queue_get_sequence_stats(zbx_pp_queue_t *queue, zbx_vector_pp_sequence_stats_ptr_t *stats);
 
 #endif
@@ -130,60 +130,81 @@ static void	*pp_worker_entry(void *args)
 	pp_context_init(&worker->execute_ctx);
 	pp_task_queue_lock(queue);
 	pp_task_queue_register_worker(queue);
+	pp_task_queue_unlock(queue);
 
 	while (0 == worker->stop)
 	{
-		if (NULL != (in = pp_task_queue_pop_new(queue)))
+		if (NULL == (in = pp_task_queue_pop_new(queue, worker->id - 1)))
 		{
-			pp_task_queue_unlock(queue);
-
-			zbx_timekeeper_update(worker->timekeeper, worker->id - 1, ZBX_PROCESS_STATE_BUSY);
-
-			zabbix_log(LOG_LEVEL_TRACE, "%s() process task type:%u itemid:" ZBX_FS_UI64, __func__,
-					in->type, in->itemid);
+			pp_task_queue_lock(queue);
 
-			switch (in->type)
+			/* tasks are pushed within task queue lock, so check again before waiting */
+			/* to avoid missing notifications sent after the previous check           */
+			if (NULL == (in = pp_task_queue_pop_new(queue, worker->id - 1)))
 			{
-				case ZBX_PP_TASK_TEST:
-					pp_task_process_test(&worker->execute_ctx, in, worker->config_source_ip);
-					break;
-				case ZBX_PP_TASK_VALUE:
-				case ZBX_PP_TASK_VALUE_SEQ:
-					pp_task_process_value(&worker->execute_ctx, in, worker->config_source_ip);
-					break;
-				case ZBX_PP_TASK_DEPENDENT:
-					pp_task_process_dependent(&worker->execute_ctx, in, worker->config_source_ip);
-					break;
-				case ZBX_PP_TASK_SEQUENCE:
-					pp_task_process_sequence(&worker->execute_ctx, in, worker->config_source_ip);
-					break;
-			}
+				if (0 == worker->stop)
+				{
+					zbx_uint64_t	pending_num, processing_num, finished_num;
 
-			zbx_timekeeper_update(worker->timekeeper, worker->id - 1, ZBX_PROCESS_STATE_IDLE);
+					if (SUCCEED != pp_task_queue_wait(queue, &error))
+					{
+						zabbix_log(LOG_LEVEL_WARNING, "[%d] %s", worker->id, error);
+						zbx_free(error);
+						worker->stop = 1;
+					}
 
-			pp_task_queue_lock(queue);
-			pp_task_queue_push_finished(queue, in);
+					pp_task_queue_get_stats(queue, &pending_num, &processing_num, &finished_num);
+
+					if (1 < pending_num)
+						pp_task_queue_notify(queue);
+				}
 
-			if (NULL != worker->finished_cb)
-				worker->finished_cb(worker->finished_data);
+				pp_task_queue_unlock(queue);
+				continue;
+			}
 
-			continue;
+			pp_task_queue_unlock(queue);
 		}
 
-		if (SUCCEED != pp_task_queue_wait(queue, &error))
+		zbx_timekeeper_update(worker->timekeeper, worker->id - 1, ZBX_PROCESS_STATE_BUSY);
+
+		zabbix_log(LOG_LEVEL_TRACE, "%s() process task type:%u itemid:" ZBX_FS_UI64, __func__, in->type,
+				in->itemid);
+
+		switch (in->type)
 		{
-			zabbix_log(LOG_LEVEL_WARNING, "[%d] %s", worker->id, error);
-			zbx_free(error);
-			worker->stop = 1;
+			case ZBX_PP_TASK_TEST:
+				pp_task_process_test(&worker->execute_ctx, in, worker->config_source_ip);
+				break;
+			case ZBX_PP_TASK_VALUE:
+			case ZBX_PP_TASK_VALUE_SEQ:
+				pp_task_process_value(&worker->execute_ctx, in, worker->config_source_ip);
+				break;
+			case ZBX_PP_TASK_DEPENDENT:
+				pp_task_process_dependent(&worker->execute_ctx, in, worker->config_source_ip);
+				break;
+			case ZBX_PP_TASK_SEQUENCE:
+				pp_task_process_sequence(&worker->execute_ctx, in, worker->config_source_ip);
+				break;
 		}
 
-		if (1 < queue->pending_num)
-			pp_task_queue_notify(queue);
+		zbx_timekeeper_update(worker->timekeeper, worker->id - 1, ZBX_PROCESS_STATE_IDLE);
+
+		pp_task_queue_lock(queue);
+		pp_task_queue_push_finished(queue, in);
+
+		if (NULL != worker->finished_cb)
+			worker->finished_cb(worker->finished_data);
+
+		pp_task_queue_unlock(queue);
 	}
 
+	pp_task_queue_lock(queue);
 	pp_task_queue_deregister_worker(queue);
 	pp_task_queue_unlock(queue);
 
+	zbx_deinit_regexp_env();
+
 	zabbix_log(LOG_LEVEL_INFORMATION, "thread stopped [%s #%d]",
 			get_process_type_string(ZBX_PROCESS_TYPE_PREPROCESSOR), worker->id);
 
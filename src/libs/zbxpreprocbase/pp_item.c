@@ -51,6 +51,9 @@ zbx_pp_item_preproc_t	*zbx_pp_item_preproc_create(zbx_uint64_t hostid, unsigned
 
 	preproc->mode = ZBX_PP_PROCESS_PARALLEL;
 
+	preproc->compiled = NULL;
+	preproc->compiled_free = NULL;
+
 	return preproc;
 }
 
@@ -80,6 +83,9 @@ static void	pp_item_preproc_free(zbx_pp_item_preproc_t *preproc)
 	if (NULL != preproc->history)
 		zbx_pp_history_free(preproc->history);
 
+	if (NULL != preproc->compiled)
+		preproc->compiled_free(preproc->compiled);
+
 	zbx_free(preproc);
 }
 
@@ -159,8 +159,13 @@ static int	regexp_compile(const char *pattern, int flags, zbx_regexp_t **regexp,
 	if (NULL != regexp)
 	{
 		struct pcre_extra	*extra;
+		int			study_options = 0;
 
-		if (NULL == (extra = pcre_study(pcre_regexp, 0, &err_msg_static)) && NULL != err_msg_static)
+#ifdef PCRE_STUDY_JIT_COMPILE
+		/* JIT compilation failure is not reported as error, the pattern is interpreted then */
+		study_options |= PCRE_STUDY_JIT_COMPILE;
+#endif
+		if (NULL == (extra = pcre_study(pcre_regexp, study_options, &err_msg_static)) && NULL != err_msg_static)
 		{
 			if (NULL != err_msg)
 			{
@@ -200,6 +205,9 @@ static int	regexp_compile(const char *pattern, int flags, zbx_regexp_t **regexp,
 			return FAIL;
 		}
 
+		/* JIT compilation failure is not fatal, the pattern is interpreted then */
+		(void)pcre2_jit_compile(pcre2_regexp, PCRE2_JIT_COMPLETE);
+
 		*regexp = (zbx_regexp_t *)zbx_malloc(NULL, sizeof(zbx_regexp_t));
 		(*regexp)->pcre2_regexp = pcre2_regexp;
 		(*regexp)->match_ctx = match_ctx;
@@ -257,43 +265,144 @@ int	zbx_regexp_compile_ext(const char *pattern, zbx_regexp_t **regexp, int flags
 	return regexp_compile(pattern, flags, regexp, err_msg);
 }
 
+#define ZBX_REGEXP_CACHE_SIZE	128
+
+/* compiled regular expression cache entry */
+typedef struct zbx_regexp_cache_entry
+{
+	char				*pattern;
+	int				flags;
+	zbx_regexp_t			*regexp;
+
+	/* least recently used list links */
+	struct zbx_regexp_cache_entry	*prev;
+	struct zbx_regexp_cache_entry	*next;
+}
+zbx_regexp_cache_entry_t;
+
+typedef struct
+{
+	zbx_hashset_t			entries;
+
+	/* the most and the least recently used entries */
+	zbx_regexp_cache_entry_t	*head;
+	zbx_regexp_cache_entry_t	*tail;
+}
+zbx_regexp_cache_t;
+
+static zbx_hash_t	regexp_cache_entry_hash(const void *d)
+{
+	const zbx_regexp_cache_entry_t	*entry = (const zbx_regexp_cache_entry_t *)d;
+	zbx_hash_t			hash;
+
+	hash = ZBX_DEFAULT_STRING_HASH_FUNC(entry->pattern);
+
+	return ZBX_DEFAULT_HASH_ALGO(&entry->flags, sizeof(entry->flags), hash);
+}
+
+static int	regexp_cache_entry_compare(const void *d1, const void *d2)
+{
+	const zbx_regexp_cache_entry_t	*e1 = (const zbx_regexp_cache_entry_t *)d1;
+	const zbx_regexp_cache_entry_t	*e2 = (const zbx_regexp_cache_entry_t *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(e1->flags, e2->flags);
+
+	return strcmp(e1->pattern, e2->pattern);
+}
+
+static void	regexp_cache_unlink(zbx_regexp_cache_t *cache, zbx_regexp_cache_entry_t *entry)
+{
+	if (NULL != entry->prev)
+		entry->prev->next = entry->next;
+	else
+		cache->head = entry->next;
+
+	if (NULL != entry->next)
+		entry->next->prev = entry->prev;
+	else
+		cache->tail = entry->prev;
+}
+
+static void	regexp_cache_link_head(zbx_regexp_cache_t *cache, zbx_regexp_cache_entry_t *entry)
+{
+	entry->prev = NULL;
+
+	if (NULL != (entry->next = cache->head))
+		cache->head->prev = entry;
+	else
+		cache->tail = entry;
+
+	cache->head = entry;
+}
+
 /****************************************************************************************************
  *                                                                                                  *
- * Purpose: wrapper for zbx_regexp_compile. Caches and reuses the last used regexp.                 *
+ * Purpose: wrapper for zbx_regexp_compile. Caches and reuses recently used regexps.                *
+ *                                                                                                  *
+ * Comments: The compiled regular expressions are kept in thread local least recently used cache    *
+ *           of ZBX_REGEXP_CACHE_SIZE entries, keyed by pattern and compilation flags, so the       *
+ *           patterns are not recompiled when several patterns are matched alternately (log items, *
+ *           global regular expressions with several expressions, LLD filters).                    *
+ *           The returned regexp is owned by cache and is valid until the next call.                *
  *                                                                                                  *
  ****************************************************************************************************/
+static ZBX_THREAD_LOCAL zbx_regexp_cache_t	*regexp_cache = NULL;
+
 static int	regexp_prepare(const char *pattern, int flags, zbx_regexp_t **regexp, char **err_msg)
 {
-	static ZBX_THREAD_LOCAL zbx_regexp_t	*curr_regexp = NULL;
-	static ZBX_THREAD_LOCAL char		*curr_pattern = NULL;
-	static ZBX_THREAD_LOCAL int		curr_flags = 0;
-	int					ret = SUCCEED;
+	zbx_regexp_cache_t		*cache = regexp_cache;
+	zbx_regexp_cache_entry_t	entry_local, *entry;
 
-	if (NULL == curr_regexp || 0 != strcmp(curr_pattern, pattern) || curr_flags != flags)
+	if (NULL == cache)
 	{
-		if (NULL != curr_regexp)
-		{
-			zbx_regexp_free(curr_regexp);
-			zbx_free(curr_pattern);
-		}
+		cache = (zbx_regexp_cache_t *)zbx_malloc(NULL, sizeof(zbx_regexp_cache_t));
+		zbx_hashset_create(&cache->entries, ZBX_REGEXP_CACHE_SIZE, regexp_cache_entry_hash,
+				regexp_cache_entry_compare);
+		cache->head = NULL;
+		cache->tail = NULL;
+		regexp_cache = cache;
+	}
 
-		curr_regexp = NULL;
-		curr_pattern = NULL;
-		curr_flags = 0;
+	entry_local.pattern = (char *)(uintptr_t)pattern;
+	entry_local.flags = flags;
 
-		if (SUCCEED == regexp_compile(pattern, flags, &curr_regexp, err_msg))
+	if (NULL != (entry = (zbx_regexp_cache_entry_t *)zbx_hashset_search(&cache->entries, &entry_local)))
+	{
+		if (entry != cache->head)
 		{
-			curr_pattern = zbx_strdup(curr_pattern, pattern);
-			curr_flags = flags;
+			regexp_cache_unlink(cache, entry);
+			regexp_cache_link_head(cache, entry);
 		}
-		else
-			ret = FAIL;
+
+		*regexp = entry->regexp;
+
+		return SUCCEED;
 	}
 
-	*regexp = curr_regexp;
-	return ret;
+	if (SUCCEED != regexp_compile(pattern, flags, &entry_local.regexp, err_msg))
+		return FAIL;
+
+	if (ZBX_REGEXP_CACHE_SIZE <= cache->entries.num_data)
+	{
+		entry = cache->tail;
+		regexp_cache_unlink(cache, entry);
+
+		zbx_regexp_free(entry->regexp);
+		zbx_free(entry->pattern);
+		zbx_hashset_remove_direct(&cache->entries, entry);
+	}
+
+	entry_local.pattern = zbx_strdup(NULL, pattern);
+	entry = (zbx_regexp_cache_entry_t *)zbx_hashset_insert(&cache->entries, &entry_local, sizeof(entry_local));
+	regexp_cache_link_head(cache, entry);
+
+	*regexp = entry->regexp;
+
+	return SUCCEED;
 }
 
+#undef ZBX_REGEXP_CACHE_SIZE
+
 /* calculate recursion limit, PCRE man page suggests to reckon on about 500 bytes per recursion */
 /* but to be on the safe side - reckon on 800 bytes and do not set limit higher than 100000 */
 #define REGEXP_RECURSION_STEP	800
@@ -301,6 +410,13 @@ static int	regexp_prepare(const char *pattern, int flags, zbx_regexp_t **regexp,
 
 static ZBX_THREAD_LOCAL unsigned long	rxp_stacklimit = 0;
 
+#ifdef HAVE_PCRE2_H
+/* thread local matching resources, created on first match and freed by zbx_deinit_regexp_env() */
+static ZBX_THREAD_LOCAL pcre2_match_context	*rxp_match_ctx = NULL;
+static ZBX_THREAD_LOCAL pcre2_jit_stack		*rxp_jit_stack = NULL;
+static ZBX_THREAD_LOCAL pcre2_match_data	*rxp_match_data = NULL;
+#endif
+
 /****************************************************************************************************
  *                                                                                                  *
  * Purpose: initialize regular expression execution environment                                     *
@@ -315,6 +431,50 @@ void	zbx_init_regexp_env(void)
 #endif
 }
 
+/****************************************************************************************************
+ *                                                                                                  *
+ * Purpose: free regular expression execution environment of the calling thread - the compiled      *
+ *          regular expression cache and the match context, JIT stack and match data               *
+ *                                                                                                  *
+ ****************************************************************************************************/
+void	zbx_deinit_regexp_env(void)
+{
+	if (NULL != regexp_cache)
+	{
+		zbx_hashset_iter_t		iter;
+		zbx_regexp_cache_entry_t	*entry;
+
+		zbx_hashset_iter_reset(&regexp_cache->entries, &iter);
+		while (NULL != (entry = (zbx_regexp_cache_entry_t *)zbx_hashset_iter_next(&iter)))
+		{
+			zbx_regexp_free(entry->regexp);
+			zbx_free(entry->pattern);
+		}
+
+		zbx_hashset_destroy(&regexp_cache->entries);
+		zbx_free(regexp_cache);
+	}
+#ifdef HAVE_PCRE2_H
+	if (NULL != rxp_match_data)
+	{
+		pcre2_match_data_free(rxp_match_data);
+		rxp_match_data = NULL;
+	}
+
+	if (NULL != rxp_match_ctx)
+	{
+		pcre2_match_context_free(rxp_match_ctx);
+		rxp_match_ctx = NULL;
+	}
+
+	if (NULL != rxp_jit_stack)
+	{
+		pcre2_jit_stack_free(rxp_jit_stack);
+		rxp_jit_stack = NULL;
+	}
+#endif
+}
+
 static unsigned long int	compute_recursion_limit(void)
 {
 	if (0 == rxp_stacklimit)
@@ -398,20 +558,29 @@ static int	regexp_exec(const char *string, const zbx_regexp_t *regexp, int flags
 	else
 		ovector = matches_buff;
 
+	/* compiled regexp can be shared between threads, so match limits are set in a local copy of extra data */
 	if (NULL == regexp->extra)
-	{
-		pextra = &extra;
-		pextra->flags = 0;
-	}
+		extra.flags = 0;
 	else
-		pextra = regexp->extra;
+		extra = *regexp->extra;
+
+	pextra = &extra;
 #if defined(PCRE_EXTRA_MATCH_LIMIT) && defined(PCRE_EXTRA_MATCH_LIMIT_RECURSION)
 	pextra->flags |= PCRE_EXTRA_MATCH_LIMIT | PCRE_EXTRA_MATCH_LIMIT_RECURSION;
 	pextra->match_limit = 1000000;
 	pextra->match_limit_recursion = compute_recursion_limit();
 #endif
 	/* see "man pcreapi" about pcre_exec() return value and 'ovector' size and layout */
-	if (0 <= (r = pcre_exec(regexp->pcre_regexp, pextra, string, (int)strlen(string), flags, 0, ovector, ovecsize)))
+	r = pcre_exec(regexp->pcre_regexp, pextra, string, (int)strlen(string), flags, 0, ovector, ovecsize);
+#if defined(PCRE_ERROR_JIT_STACKLIMIT) && defined(PCRE_EXTRA_EXECUTABLE_JIT)
+	/* JIT stack is too small for the pattern, fall back to interpreter having own limits */
+	if (PCRE_ERROR_JIT_STACKLIMIT == r)
+	{
+		pextra->flags &= ~PCRE_EXTRA_EXECUTABLE_JIT;
+		r = pcre_exec(regexp->pcre_regexp, pextra, string, (int)strlen(string), flags, 0, ovector, ovecsize);
+	}
+#endif
+	if (0 <= r)
 	{
 		if (NULL != matches)
 			memcpy(matches, ovector, (size_t)((0 < r) ? MIN(r, count) : count) * sizeof(zbx_regmatch_t));
@@ -441,14 +610,38 @@ static int	regexp_exec(const char *string, const zbx_regexp_t *regexp, int flags
 #undef MATCHES_BUFF_SIZE
 #endif
 #ifdef HAVE_PCRE2_H
-	int			result, r, i;
-	pcre2_match_data	*match_data = NULL;
-	PCRE2_SIZE		*ovector = NULL;
+#define JIT_STACK_START_SIZE	(32 * ZBX_KIBIBYTE)
+#define JIT_STACK_MAX_SIZE	(512 * ZBX_KIBIBYTE)
+	int						result, r, i;
+	pcre2_match_data				*match_data = NULL;
+	PCRE2_SIZE					*ovector = NULL;
+	pcre2_match_context				*match_ctx;
+
+	/* compiled regexp can be shared between threads, so match limits are set in thread local match context */
+	if (NULL == rxp_match_ctx && NULL != (rxp_match_ctx = pcre2_match_context_create(NULL)))
+	{
+		/* JIT compiled patterns use the stack assigned to match context, without it */
+		/* only 32KB of machine stack is available for JIT matching                 */
+		if (NULL != (rxp_jit_stack = pcre2_jit_stack_create(JIT_STACK_START_SIZE, JIT_STACK_MAX_SIZE, NULL)))
+			pcre2_jit_stack_assign(rxp_match_ctx, NULL, rxp_jit_stack);
+	}
 
-	pcre2_set_match_limit(regexp->match_ctx, 1000000);
+	if (NULL == (match_ctx = rxp_match_ctx))
+		match_ctx = regexp->match_ctx;
+
+	pcre2_set_match_limit(match_ctx, 1000000);
+	pcre2_set_recursion_limit(match_ctx, (uint32_t)compute_recursion_limit());
+
+	/* match data for the supported number of capture groups is created once and reused */
+	if (ZBX_REGEXP_GROUPS_MAX >= count)
+	{
+		if (NULL == rxp_match_data)
+			rxp_match_data = pcre2_match_data_create(ZBX_REGEXP_GROUPS_MAX, NULL);
 
-	pcre2_set_recursion_limit(regexp->match_ctx, (uint32_t)compute_recursion_limit());
-	match_data = pcre2_match_data_create((uint32_t)count, NULL);
+		match_data = rxp_match_data;
+	}
+	else
+		match_data = pcre2_match_data_create((uint32_t)count, NULL);
 
 	if (NULL == match_data)
 	{
@@ -460,9 +653,17 @@ static int	regexp_exec(const char *string, const zbx_regexp_t *regexp, int flags
 #ifdef PCRE2_MATCH_INVALID_UTF
 		flags |= PCRE2_NO_UTF_CHECK;
 #endif
-
-		if (0 <= (r = pcre2_match(regexp->pcre2_regexp, (PCRE2_SPTR)string, PCRE2_ZERO_TERMINATED, 0, flags,
-			match_data, regexp->match_ctx)))
+		r = pcre2_match(regexp->pcre2_regexp, (PCRE2_SPTR)string, PCRE2_ZERO_TERMINATED, 0, flags, match_data,
+				match_ctx);
+#ifdef PCRE2_NO_JIT
+		/* JIT stack is too small for the pattern, fall back to interpreter having own limits */
+		if (PCRE2_ERROR_JIT_STACKLIMIT == r)
+		{
+			r = pcre2_match(regexp->pcre2_regexp, (PCRE2_SPTR)string, PCRE2_ZERO_TERMINATED, 0,
+					flags | PCRE2_NO_JIT, match_data, match_ctx);
+		}
+#endif
+		if (0 <= r)
 		{
 			if (NULL != matches)
 			{
@@ -492,9 +693,12 @@ static int	regexp_exec(const char *string, const zbx_regexp_t *regexp, int flags
 			result = FAIL;
 		}
 
-		pcre2_match_data_free(match_data);
+		if (match_data != rxp_match_data)
+			pcre2_match_data_free(match_data);
 	}
 
+#undef JIT_STACK_MAX_SIZE
+#undef JIT_STACK_START_SIZE
 	return result;
 #endif
 }
@@ -77,6 +77,22 @@
  *  lo_bound             `size' fields in chunk B                   hi_bound  *
  *  (aligned)            have SHMEM_FLG_USED bit set               (aligned)  *
  *                                                                            *
+ * (*) in slab mode small allocations are served from slab pages - used       *
+ *     chunks of SHMEM_SLAB_PAGE_SIZE bytes split into equal size slots       *
+ *                                                                            *
+ *              +-------------- slab page chunk --------------+               *
+ *              |                                             |               *
+ *              v                                             v               *
+ *                                                                            *
+ *     |--------|-- page header --|tag|--slot--|tag|--slot--|...|--------|    *
+ *                                                                            *
+ *     slot tags have SHMEM_FLG_USED and SHMEM_FLG_SLAB bits set and contain  *
+ *     offset of the slot from the page header, so slots are freed in O(1)    *
+ *     without affecting the neighbour chunk merging                          *
+ *                                                                            *
+ *     free slots of a page are kept in a singly-linked list, pages with free *
+ *     slots - in doubly-linked list of the size class                        *
+ *                                                                            *
  ******************************************************************************/
 
 static void	*ALIGN4(void *ptr);
@@ -99,6 +115,10 @@ static void	**mem_ptr_to_next_field(void *chunk, void **first_chunk);
 static void	mem_link_chunk(zbx_shmem_info_t *info, void *chunk);
 static void	mem_unlink_chunk(zbx_shmem_info_t *info, void *chunk);
 
+static void	*mem_slab_malloc(zbx_shmem_info_t *info, zbx_uint64_t size);
+static void	*mem_slab_realloc(zbx_shmem_info_t *info, void *slot, zbx_uint64_t size);
+static void	mem_slab_free(zbx_shmem_info_t *info, void *slot);
+
 static void	*__mem_malloc(zbx_shmem_info_t *info, zbx_uint64_t size);
 static void	*__mem_realloc(zbx_shmem_info_t *info, void *old, zbx_uint64_t size);
 static void	__mem_free(zbx_shmem_info_t *info, void *ptr);
@@ -106,6 +126,7 @@ static void	__mem_free(zbx_shmem_info_t *info, void *ptr);
 #define SHMEM_SIZE_FIELD	sizeof(zbx_uint64_t)
 
 #define SHMEM_FLG_USED		((__UINT64_C(1))<<63)
+#define SHMEM_FLG_SLAB		((__UINT64_C(1))<<62)
 
 #define FREE_CHUNK(ptr)		(((*(zbx_uint64_t *)(ptr)) & SHMEM_FLG_USED) == 0)
 #define CHUNK_SIZE(ptr)		((*(zbx_uint64_t *)(ptr)) & ~SHMEM_FLG_USED)
@@ -113,6 +134,28 @@ static void	__mem_free(zbx_shmem_info_t *info, void *ptr);
 #define SHMEM_MIN_SIZE		__UINT64_C(128)
 #define SHMEM_MAX_SIZE		__UINT64_C(0x1000000000)	/* 64 GB */
 
+#define SLAB_SLOT(ptr)		(((*(zbx_uint64_t *)(ptr)) & SHMEM_FLG_SLAB) != 0)
+#define SLAB_SLOT_OFFSET(ptr)	((*(zbx_uint64_t *)(ptr)) & ~(SHMEM_FLG_USED | SHMEM_FLG_SLAB))
+
+#define SHMEM_SLAB_PAGE_SIZE	4096
+
+/* slot sizes of slab classes, must be multiples of 8 and at least SHMEM_MIN_ALLOC */
+static const zbx_uint64_t	slab_sizes[ZBX_SHMEM_SLAB_CLASS_COUNT] = {24, 32, 48, 64, 96, 128, 192, 256};
+
+#define SHMEM_SLAB_MAX_ALLOC	256
+
+typedef struct zbx_shmem_slab_page
+{
+	struct zbx_shmem_slab_page	*prev;
+	struct zbx_shmem_slab_page	*next;
+	void				*free_slots;
+	unsigned int			used_num;
+	int				index;
+}
+zbx_shmem_slab_page_t;
+
+#define SHMEM_SLAB_PAGE_HEADER	((sizeof(zbx_shmem_slab_page_t) + 7) & ~(size_t)7)
+
 /* helper functions */
 
 static void	*ALIGN4(void *ptr)
@@ -227,6 +270,158 @@ static void	mem_unlink_chunk(zbx_shmem_info_t *info, void *chunk)
 		*prev_in_next_chunk = prev_chunk;
 }
 
+static int	mem_slab_index_by_size(zbx_uint64_t size)
+{
+	int	i;
+
+	for (i = 0; i < ZBX_SHMEM_SLAB_CLASS_COUNT; i++)
+	{
+		if (size <= slab_sizes[i])
+			return i;
+	}
+
+	return FAIL;
+}
+
+static unsigned int	mem_slab_page_slots_num(int index)
+{
+	return (unsigned int)((SHMEM_SLAB_PAGE_SIZE - SHMEM_SLAB_PAGE_HEADER) / (SHMEM_SIZE_FIELD + slab_sizes[index]));
+}
+
+static zbx_shmem_slab_page_t	*mem_slab_get_page(void *slot)
+{
+	return (zbx_shmem_slab_page_t *)((char *)slot - SLAB_SLOT_OFFSET(slot));
+}
+
+static void	*mem_slab_get_next_slot(void *slot)
+{
+	return *(void **)((char *)slot + SHMEM_SIZE_FIELD);
+}
+
+static void	mem_slab_set_next_slot(void *slot, void *next)
+{
+	*(void **)((char *)slot + SHMEM_SIZE_FIELD) = next;
+}
+
+static void	mem_slab_link_page(zbx_shmem_slab_t *slab, zbx_shmem_slab_page_t *page)
+{
+	page->prev = NULL;
+	page->next = (zbx_shmem_slab_page_t *)slab->pages;
+
+	if (NULL != page->next)
+		page->next->prev = page;
+
+	slab->pages = page;
+}
+
+static void	mem_slab_unlink_page(zbx_shmem_slab_t *slab, zbx_shmem_slab_page_t *page)
+{
+	if (NULL != page->prev)
+		page->prev->next = page->next;
+	else
+		slab->pages = page->next;
+
+	if (NULL != page->next)
+		page->next->prev = page->prev;
+}
+
+/* slab allocator functions */
+
+static void	*mem_slab_malloc(zbx_shmem_info_t *info, zbx_uint64_t size)
+{
+	int			index;
+	zbx_shmem_slab_t	*slab;
+	zbx_shmem_slab_page_t	*page;
+	void			*slot;
+
+	if (FAIL == (index = mem_slab_index_by_size(size)))
+		return NULL;
+
+	slab = &info->slabs[index];
+
+	if (NULL == (page = (zbx_shmem_slab_page_t *)slab->pages))
+	{
+		void		*chunk;
+		unsigned int	i;
+		zbx_uint64_t	slot_size = SHMEM_SIZE_FIELD + slab_sizes[index];
+
+		if (NULL == (chunk = __mem_malloc(info, SHMEM_SLAB_PAGE_SIZE)))
+			return NULL;
+
+		page = (zbx_shmem_slab_page_t *)((char *)chunk + SHMEM_SIZE_FIELD);
+		page->free_slots = NULL;
+		page->used_num = 0;
+		page->index = index;
+
+		/* link slots in reverse order, so they are allocated in address order */
+		for (i = mem_slab_page_slots_num(index); 0 < i--;)
+		{
+			slot = (char *)page + SHMEM_SLAB_PAGE_HEADER + i * slot_size;
+			*(zbx_uint64_t *)slot = SHMEM_FLG_USED | SHMEM_FLG_SLAB |
+					(zbx_uint64_t)((char *)slot - (char *)page);
+			mem_slab_set_next_slot(slot, page->free_slots);
+			page->free_slots = slot;
+		}
+
+		mem_slab_link_page(slab, page);
+		slab->pages_num++;
+	}
+
+	slot = page->free_slots;
+	page->free_slots = mem_slab_get_next_slot(slot);
+	page->used_num++;
+	slab->used_num++;
+
+	if (NULL == page->free_slots)
+		mem_slab_unlink_page(slab, page);
+
+	return slot;
+}
+
+static void	*mem_slab_realloc(zbx_shmem_info_t *info, void *slot, zbx_uint64_t size)
+{
+	void		*chunk;
+	zbx_uint64_t	slot_size;
+
+	slot_size = slab_sizes[mem_slab_get_page(slot)->index];
+
+	if (size <= slot_size)
+		return slot;
+
+	if (NULL == (chunk = __mem_malloc(info, size)))
+		return NULL;
+
+	memcpy((char *)chunk + SHMEM_SIZE_FIELD, (char *)slot + SHMEM_SIZE_FIELD, slot_size);
+	mem_slab_free(info, slot);
+
+	return chunk;
+}
+
+static void	mem_slab_free(zbx_shmem_info_t *info, void *slot)
+{
+	zbx_shmem_slab_page_t	*page;
+	zbx_shmem_slab_t	*slab;
+
+	page = mem_slab_get_page(slot);
+	slab = &info->slabs[page->index];
+
+	if (NULL == page->free_slots)
+		mem_slab_link_page(slab, page);
+
+	mem_slab_set_next_slot(slot, page->free_slots);
+	page->free_slots = slot;
+	page->used_num--;
+	slab->used_num--;
+
+	/* release empty pages, but keep the last page with free slots to avoid allocating it again right away */
+	if (0 == page->used_num && (slab->pages != page || NULL != page->next))
+	{
+		mem_slab_unlink_page(slab, page);
+		slab->pages_num--;
+		__mem_free(info, page);
+	}
+}
+
 /* private memory functions */
 
 static void	*__mem_malloc(zbx_shmem_info_t *info, zbx_uint64_t size)
@@ -237,6 +432,10 @@ static void	*__mem_malloc(zbx_shmem_info_t *info, zbx_uint64_t size)
 
 	size = mem_proper_alloc_size(size);
 
+	/* try to allocate small objects from slabs, fall back to chunks if there is no space for a new slab page */
+	if (0 != info->slab_mode && SHMEM_SLAB_MAX_ALLOC >= size && NULL != (chunk = mem_slab_malloc(info, size)))
+		return chunk;
+
 	/* try to find an appropriate chunk in special buckets */
 
 	index = mem_bucket_by_size(size);
@@ -323,6 +522,10 @@ static void	*__mem_realloc(zbx_shmem_info_t *info, void *old, zbx_uint64_t size)
 	size = mem_proper_alloc_size(size);
 
 	chunk = (void *)((char *)old - SHMEM_SIZE_FIELD);
+
+	if (SLAB_SLOT(chunk))
+		return mem_slab_realloc(info, chunk, size);
+
 	chunk_size = CHUNK_SIZE(chunk);
 
 	next_chunk = (void *)((char *)chunk + SHMEM_SIZE_FIELD + chunk_size + SHMEM_SIZE_FIELD);
@@ -458,6 +661,13 @@ static void	__mem_free(zbx_shmem_info_t *info, void *ptr)
 	int		prev_free, next_free;
 
 	chunk = (void *)((char *)ptr - SHMEM_SIZE_FIELD);
+
+	if (SLAB_SLOT(chunk))
+	{
+		mem_slab_free(info, chunk);
+		return;
+	}
+
 	chunk_size = CHUNK_SIZE(chunk);
 
 	info->used_size -= chunk_size;
@@ -581,6 +791,11 @@ int	zbx_shmem_create(zbx_shmem_info_t **info, zbx_uint64_t size, const char *des
 	size -= (char *)((*info)->buckets + ZBX_SHMEM_BUCKET_COUNT) - (char *)base;
 	base = (void *)((*info)->buckets + ZBX_SHMEM_BUCKET_COUNT);
 
+	(*info)->slabs = (zbx_shmem_slab_t *)ALIGN8(base);
+	memset((*info)->slabs, 0, ZBX_SHMEM_SLAB_CLASS_COUNT * sizeof(zbx_shmem_slab_t));
+	size -= (char *)((*info)->slabs + ZBX_SHMEM_SLAB_CLASS_COUNT) - (char *)base;
+	base = (void *)((*info)->slabs + ZBX_SHMEM_SLAB_CLASS_COUNT);
+
 	zbx_strlcpy((char *)base, descr, size);
 	(*info)->mem_descr = (char *)base;
 	size -= strlen(descr) + 1;
@@ -592,6 +807,7 @@ int	zbx_shmem_create(zbx_shmem_info_t **info, zbx_uint64_t size, const char *des
 	base = (void *)((char *)base + strlen(param) + 1);
 
 	(*info)->allow_oom = allow_oom;
+	(*info)->slab_mode = 0;
 
 	/* prepare shared memory for further allocation by creating one big chunk */
 	(*info)->lo_bound = ALIGN8(base);
@@ -644,6 +860,8 @@ int	zbx_shmem_create_min(zbx_shmem_info_t **info, zbx_uint64_t size, const char
 	base = (void *)((zbx_shmem_info_t *)(base) + 1);
 	base = ALIGNPTR(base);
 	base = (void *)((void **)base + ZBX_SHMEM_BUCKET_COUNT);
+	base = ALIGN8(base);
+	base = (void *)((zbx_shmem_slab_t *)base + ZBX_SHMEM_SLAB_CLASS_COUNT);
 	base = (void *)((char *)base + strlen(descr) + 1);
 	base = (void *)((char *)base + strlen(param) + 1);
 	base = ALIGN8(base);
@@ -661,6 +879,21 @@ void	zbx_shmem_destroy(zbx_shmem_info_t *info)
 	(void)shmdt(info->base);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: enables slab mode                                                 *
+ *                                                                            *
+ * Comments: In slab mode allocations up to 256 bytes are served in O(1) from *
+ *           slab pages of fixed size classes. This bounds fragmentation      *
+ *           caused by small objects at the cost of rounding their size up to *
+ *           the size class.                                                  *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_shmem_enable_slabs(zbx_shmem_info_t *info)
+{
+	info->slab_mode = 1;
+}
+
 void	*__zbx_shmem_malloc(const char *file, int line, zbx_shmem_info_t *info, const void *old, size_t size)
 {
 	void	*chunk;
@@ -751,6 +984,7 @@ void	zbx_shmem_clear(zbx_shmem_info_t *info)
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
 	memset(info->buckets, 0, ZBX_SHMEM_BUCKET_COUNT * ZBX_PTR_SIZE);
+	memset(info->slabs, 0, ZBX_SHMEM_SLAB_CLASS_COUNT * sizeof(zbx_shmem_slab_t));
 	index = mem_bucket_by_size(info->total_size);
 	info->buckets[index] = info->lo_bound;
 	mem_set_chunk_size(info->buckets[index], info->total_size);
@@ -792,6 +1026,14 @@ void	zbx_shmem_get_stats(const zbx_shmem_info_t *info, zbx_shmem_stats_t *stats)
 	if (__UINT64_C(0xffffffffffffffff) == stats->min_chunk_size)
 		stats->min_chunk_size = 0;
 
+	for (i = 0; i < ZBX_SHMEM_SLAB_CLASS_COUNT; i++)
+	{
+		stats->slabs[i].size = slab_sizes[i];
+		stats->slabs[i].pages = info->slabs[i].pages_num;
+		stats->slabs[i].used = info->slabs[i].used_num;
+		stats->slabs[i].total = info->slabs[i].pages_num * mem_slab_page_slots_num(i);
+	}
+
 	stats->overhead = info->total_size - info->used_size - info->free_size;
 	stats->used_chunks = stats->overhead / (2 * SHMEM_SIZE_FIELD) + 1 - stats->free_chunks;
 	stats->free_size = info->free_size;
@@ -828,10 +1070,36 @@ void	zbx_shmem_dump_stats(int level, zbx_shmem_info_t *info)
 			(unsigned long long)stats.used_size, (unsigned long long)stats.used_chunks);
 	zabbix_log(level, "of those, %10llu bytes are used by allocation overhead",
 			(unsigned long long)stats.overhead);
+	zabbix_log(level, "free memory fragmentation: %.2f%%", zbx_shmem_stats_fragmentation(&stats));
+
+	for (i = 0; i < ZBX_SHMEM_SLAB_CLASS_COUNT; i++)
+	{
+		if (0 == stats.slabs[i].pages)
+			continue;
+
+		zabbix_log(level, "slab slots of size %3d bytes: %8u used of %8u in %6u pages",
+				(int)stats.slabs[i].size, stats.slabs[i].used, stats.slabs[i].total,
+				stats.slabs[i].pages);
+	}
 
 	zabbix_log(level, "================================");
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculates free memory fragmentation                              *
+ *                                                                            *
+ * Return value: the percentage of free memory outside the largest free chunk *
+ *                                                                            *
+ ******************************************************************************/
+double	zbx_shmem_stats_fragmentation(const zbx_shmem_stats_t *stats)
+{
+	if (0 == stats->free_size)
+		return 0;
+
+	return (double)(stats->free_size - stats->max_chunk_size) * 100 / (double)stats->free_size;
+}
+
 size_t	zbx_shmem_required_size(int chunks_num, const char *descr, const char *param)
 {
 	size_t	size = 0;
@@ -847,6 +1115,8 @@ size_t	zbx_shmem_required_size(int chunks_num, const char *descr, const char *pa
 	size += sizeof(zbx_shmem_info_t);
 	size += ZBX_PTR_SIZE - 1;			/* ensure we allocate enough to align bucket pointers */
 	size += ZBX_PTR_SIZE * ZBX_SHMEM_BUCKET_COUNT;
+	size += 7;					/* ensure we allocate enough to 8-align slab classes */
+	size += sizeof(zbx_shmem_slab_t) * ZBX_SHMEM_SLAB_CLASS_COUNT;
 	size += strlen(descr) + 1;
 	size += strlen(param) + 1;
 	size += (SHMEM_SIZE_FIELD - 1) + 8;		/* ensure we allocate enough to align the first chunk */
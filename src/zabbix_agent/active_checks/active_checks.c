@@ -16,6 +16,8 @@
 
 #include "../agent_conf/agent_conf.h"
 #include "../logfiles/logfiles.h"
+#include "../logfiles/logwatch.h"
+#include "active_workers.h"
 #include "../metrics/metrics.h"
 
 #include "zbxcfg.h"
@@ -105,6 +107,9 @@ static ZBX_THREAD_LOCAL zbx_vector_persistent_inactive_t	persistent_inactive_vec
 
 static ZBX_THREAD_LOCAL int	history_upload = ZBX_HISTORY_UPLOAD_ENABLED;
 
+/* persistent buffer elements reserved for values of log checks executed by log check threads */
+static ZBX_THREAD_LOCAL int	log_slots_reserved = 0;
+
 typedef struct
 {
 	zbx_uint64_t	id;
@@ -151,6 +156,8 @@ static void	init_active_metrics(int config_buffer_size)
 
 static void	free_active_metric(zbx_active_metric_t *metric)
 {
+	zbx_log_watch_remove(metric->itemid);
+
 	zbx_free(metric->key);
 	zbx_free(metric->delay);
 
@@ -237,6 +244,10 @@ static int	get_min_nextcheck(void)
 	{
 		const zbx_active_metric_t	*metric = (const zbx_active_metric_t *)active_metrics.values[i];
 
+		/* metric being checked by worker is rescheduled when its result is processed */
+		if (0 != metric->in_progress)
+			continue;
+
 		if (metric->nextcheck < min || -1 == min)
 			min = metric->nextcheck;
 	}
@@ -281,6 +292,7 @@ static void	add_check(const char *key, zbx_uint64_t itemid, const char *delay, z
 			metric->logfiles_num = 0;
 			metric->start_time = 0.0;
 			metric->processed_bytes = 0;
+			zbx_log_watch_remove(metric->itemid);
 #if !defined(_WINDOWS) && !defined(__MINGW32__)
 			if (NULL != metric->persistent_file_name)
 			{
@@ -333,6 +345,7 @@ static void	add_check(const char *key, zbx_uint64_t itemid, const char *delay, z
 	metric->lastlogsize = lastlogsize;
 	metric->mtime = mtime;
 	metric->timeout = timeout;
+	metric->in_progress = 0;
 	/* existing log[], log.count[] and eventlog[] data can be skipped */
 	metric->skip_old_data = (0 != metric->lastlogsize ? 0 : 1);
 	metric->big_rec = 0;
@@ -1302,7 +1315,8 @@ static int	process_value(zbx_vector_addr_ptr_t *addrs, zbx_vector_ptr_t *agent2_
 	{
 		el = &buffer.data[buffer.count - 1];
 
-		if ((0 != (flags & ZBX_METRIC_FLAG_PERSISTENT) && config_buffer_size / 2 <= buffer.pcount) ||
+		if ((0 != (flags & ZBX_METRIC_FLAG_PERSISTENT) &&
+				config_buffer_size / 2 <= buffer.pcount + log_slots_reserved) ||
 				config_buffer_size <= buffer.count || el->itemid != itemid)
 		{
 			send_buffer(addrs, &pre_persistent_vec, config_tls, config_timeout, config_source_ip,
@@ -1310,7 +1324,7 @@ static int	process_value(zbx_vector_addr_ptr_t *addrs, zbx_vector_ptr_t *agent2_
 		}
 	}
 
-	if (0 != (ZBX_METRIC_FLAG_PERSISTENT & flags) && config_buffer_size / 2 <= buffer.pcount)
+	if (0 != (ZBX_METRIC_FLAG_PERSISTENT & flags) && config_buffer_size / 2 <= buffer.pcount + log_slots_reserved)
 	{
 		zabbix_log(LOG_LEVEL_WARNING, "buffer is full, cannot store persistent value");
 		goto out;
@@ -1389,7 +1403,8 @@ static int	process_value(zbx_vector_addr_ptr_t *addrs, zbx_vector_ptr_t *agent2_
 
 	/* If conditions are met then send buffer now. It is necessary for synchronization */
 	/* between sending data to server and writing of persistent files. */
-	if ((0 != (flags & ZBX_METRIC_FLAG_PERSISTENT) && config_buffer_size / 2 <= buffer.pcount) ||
+	if ((0 != (flags & ZBX_METRIC_FLAG_PERSISTENT) &&
+			config_buffer_size / 2 <= buffer.pcount + log_slots_reserved) ||
 			config_buffer_size <= buffer.count)
 	{
 		send_buffer(addrs, &pre_persistent_vec, config_tls, config_timeout, config_source_ip, host,
@@ -1480,38 +1495,56 @@ int	process_eventlog_check(zbx_vector_addr_ptr_t *addrs, zbx_vector_ptr_t *agent
 		int config_buffer_size, int config_eventlog_max_lines_per_second, char **error);
 #endif
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: processes result of common check executed by active checks        *
+ *          process or by its worker                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	process_common_result(zbx_vector_addr_ptr_t *addrs, zbx_active_metric_t *metric, int ret,
+		AGENT_RESULT *result, const zbx_config_tls_t *config_tls, int config_timeout,
+		const char *config_source_ip, const char *config_hostname, int config_buffer_send,
+		int config_buffer_size, char **error)
+{
+	char	**pvalue;
+
+	if (SUCCEED != ret)
+	{
+		if (NULL != (pvalue = ZBX_GET_MSG_RESULT(result)))
+			*error = zbx_strdup(*error, *pvalue);
+	}
+	else if (NULL != (pvalue = ZBX_GET_TEXT_RESULT(result)))
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "for key [%s] received value [%s]", metric->key, *pvalue);
+
+		process_value(addrs, NULL, metric->itemid, config_hostname, metric->key, *pvalue, ITEM_STATE_NORMAL,
+				NULL, NULL, NULL, NULL, NULL, NULL, metric->flags, config_tls, config_timeout,
+				config_source_ip, config_buffer_send, config_buffer_size);
+	}
+
+	return ret;
+}
+
 static int	process_common_check(zbx_vector_addr_ptr_t *addrs, zbx_active_metric_t *metric,
 		const zbx_config_tls_t *config_tls, int config_timeout, const char *config_source_ip,
 		const char *config_hostname, int config_buffer_send, int config_buffer_size, char **error)
 {
 	int		ret;
 	AGENT_RESULT	result;
-	char		**pvalue;
 
 	zbx_init_agent_result(&result);
 
 	if (ZBX_CHECK_TIMEOUT_UNDEFINED == metric->timeout)
 	{
 		SET_MSG_RESULT(&result, zbx_strdup(NULL, "Unsupported timeout value."));
-		*error = zbx_strdup(*error, *ZBX_GET_MSG_RESULT(&result));
 		ret = NOTSUPPORTED;
 	}
-	else if (SUCCEED != (ret = zbx_execute_agent_check(metric->key, 0, &result, metric->timeout)))
-	{
-		if (NULL != (pvalue = ZBX_GET_MSG_RESULT(&result)))
-			*error = zbx_strdup(*error, *pvalue);
-		goto out;
-	}
+	else
+		ret = zbx_execute_agent_check(metric->key, 0, &result, metric->timeout);
 
-	if (NULL != (pvalue = ZBX_GET_TEXT_RESULT(&result)))
-	{
-		zabbix_log(LOG_LEVEL_DEBUG, "for key [%s] received value [%s]", metric->key, *pvalue);
+	ret = process_common_result(addrs, metric, ret, &result, config_tls, config_timeout, config_source_ip,
+			config_hostname, config_buffer_send, config_buffer_size, error);
 
-		process_value(addrs, NULL, metric->itemid, config_hostname, metric->key, *pvalue, ITEM_STATE_NORMAL,
-				NULL, NULL, NULL, NULL, NULL, NULL, metric->flags, config_tls, config_timeout,
-				config_source_ip, config_buffer_send, config_buffer_size);
-	}
-out:
 	zbx_free_agent_result(&result);
 
 	return ret;
@@ -1604,6 +1637,290 @@ static void	process_active_commands(zbx_vector_addr_ptr_t *addrs, const zbx_conf
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: updates metric state after check, sends buffer and reschedules    *
+ *          metric if check took it past its next check time                  *
+ *                                                                            *
+ * Parameters: addrs            - [IN] server addresses                       *
+ *             metric           - [IN/OUT] checked metric                     *
+ *             ret              - [IN] check return code                      *
+ *             error            - [IN/OUT] check error message                *
+ *             lastlogsize_last - [IN] lastlogsize before check               *
+ *             mtime_last       - [IN] mtime before check                     *
+ *             lastlogsize_sent - [IN] last sent lastlogsize                  *
+ *             mtime_sent       - [IN] last sent mtime                        *
+ *             now              - [OUT] current time                          *
+ *                                                                            *
+ ******************************************************************************/
+static void	process_check_result(zbx_vector_addr_ptr_t *addrs, zbx_active_metric_t *metric, int ret, char **error,
+		zbx_uint64_t lastlogsize_last, int mtime_last, zbx_uint64_t lastlogsize_sent, int mtime_sent,
+		int *now, const zbx_config_tls_t *config_tls, int config_timeout, const char *config_source_ip,
+		const char *config_hostname, int config_buffer_send, int config_buffer_size)
+{
+	int	scheduling = FAIL;
+
+	if (SUCCEED != ret)
+	{
+		const char	*perror = (NULL != *error ? *error : ZBX_NOTSUPPORTED_MSG);
+
+		metric->state = ITEM_STATE_NOTSUPPORTED;
+		metric->error_count = 0;
+		metric->processed_bytes = 0;
+
+		zabbix_log(LOG_LEVEL_WARNING, "active check \"%s\" is not supported: %s", metric->key, perror);
+#if !defined(_WINDOWS) && !defined(__MINGW32__)
+		/* only for log*[] items */
+		if (0 != ((ZBX_METRIC_FLAG_LOG_LOG | ZBX_METRIC_FLAG_LOG_LOGRT) & metric->flags) &&
+				NULL != metric->persistent_file_name)
+		{
+			const struct st_logfile	*logfile = NULL;
+
+			if (0 < metric->logfiles_num)
+			{
+				logfile = find_last_processed_file_in_logfiles_list(metric->logfiles,
+						metric->logfiles_num);
+			}
+
+			zbx_fill_prep_vec_element(&pre_persistent_vec, metric->itemid,
+					metric->persistent_file_name, logfile, metric->lastlogsize,
+					metric->mtime);
+		}
+#endif
+		process_value(addrs, NULL, metric->itemid, config_hostname, metric->key, perror,
+				ITEM_STATE_NOTSUPPORTED, &metric->lastlogsize, &metric->mtime, NULL, NULL, NULL,
+				NULL, metric->flags, config_tls, config_timeout, config_source_ip,
+				config_buffer_send, config_buffer_size);
+
+		zbx_free(*error);
+	}
+	else
+	{
+		if (0 == metric->error_count)
+		{
+			unsigned char	old_state = metric->state;
+
+			if (ITEM_STATE_NOTSUPPORTED == metric->state)
+			{
+				/* item became supported */
+				metric->state = ITEM_STATE_NORMAL;
+			}
+
+			if (SUCCEED == need_meta_update(metric, lastlogsize_sent, mtime_sent, old_state,
+					lastlogsize_last, mtime_last))
+			{
+#if !defined(_WINDOWS) && !defined(__MINGW32__)
+				if (NULL != metric->persistent_file_name)
+				{
+					const struct st_logfile	*logfile = NULL;
+
+					if (0 < metric->logfiles_num)
+					{
+						logfile = find_last_processed_file_in_logfiles_list(
+								metric->logfiles, metric->logfiles_num);
+					}
+
+					zbx_fill_prep_vec_element(&pre_persistent_vec, metric->itemid,
+							metric->persistent_file_name, logfile,
+							metric->lastlogsize, metric->mtime);
+				}
+#endif
+				/* meta information update */
+				process_value(addrs, NULL, metric->itemid, config_hostname, metric->key, NULL,
+						metric->state, &metric->lastlogsize, &metric->mtime, NULL, NULL,
+						NULL, NULL, metric->flags, config_tls, config_timeout,
+						config_source_ip, config_buffer_send, config_buffer_size);
+			}
+
+			/* remove "new metric" flag */
+			metric->flags &= ~ZBX_METRIC_FLAG_NEW;
+		}
+	}
+
+	send_buffer(addrs, &pre_persistent_vec, config_tls, config_timeout, config_source_ip, config_hostname,
+			config_buffer_send, config_buffer_size);
+
+	if (metric->nextcheck <= (*now = (int)time(NULL)))
+	{
+		/* reschedule metric if polling took it past is scheduled next poll */
+
+		if (SUCCEED != zbx_get_agent_item_nextcheck(metric->itemid, metric->delay, *now,
+				&metric->nextcheck, &scheduling, error))
+		{
+			/* while not likely that another nextcheck calculation with the same     */
+			/* delay could result in an error - still it can be handled and reported */
+			process_value(addrs, NULL, metric->itemid, config_hostname, metric->key, *error,
+					ITEM_STATE_NOTSUPPORTED, &metric->lastlogsize, &metric->mtime, NULL,
+					NULL, NULL, NULL, metric->flags, config_tls, config_timeout,
+					config_source_ip, config_buffer_send, config_buffer_size);
+
+			metric->state = ITEM_STATE_NOTSUPPORTED;
+			metric->error_count = 0;
+
+			zbx_free(*error);
+		}
+	}
+}
+
+#if !defined(_WINDOWS) && !defined(__MINGW32__)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: passes log[] or logrt[] check to log check thread                 *
+ *                                                                            *
+ * Parameters: addrs  - [IN] server addresses                                 *
+ *             metric - [IN] metric to check                                  *
+ *                                                                            *
+ * Return value: SUCCEED - metric is being checked by log check thread        *
+ *               FAIL    - no thread or buffer space is available, metric     *
+ *                         must be checked by active checks process           *
+ *                                                                            *
+ * Comments: Buffer space for persistent values of the check is reserved, so  *
+ *           collected values can be added to buffer without losing them.     *
+ *           Free space is shared between threads.                            *
+ *                                                                            *
+ ******************************************************************************/
+static int	active_log_check(zbx_vector_addr_ptr_t *addrs, zbx_active_metric_t *metric,
+		const zbx_config_tls_t *config_tls, int config_timeout, const char *config_source_ip,
+		const char *config_hostname, int config_buffer_send, int config_buffer_size,
+		int config_max_lines_per_second)
+{
+	zbx_active_log_job_t	*job;
+	int			slots;
+
+	if (0 == zbx_active_workers_num())
+		return FAIL;
+
+	slots = MIN(config_buffer_size / 2 - buffer.pcount - log_slots_reserved,
+			MAX(config_buffer_size / 2 / zbx_active_workers_num(), 1));
+
+	if (0 >= slots)
+		return FAIL;
+
+	job = zbx_active_log_job_create(metric, addrs, &regexps, config_tls, config_timeout, config_source_ip,
+			config_hostname, config_buffer_send, config_buffer_size, config_max_lines_per_second, slots);
+
+	if (SUCCEED != zbx_active_log_check(job))
+	{
+		zbx_active_log_job_free(job);
+		return FAIL;
+	}
+
+	log_slots_reserved += slots;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds values of log check finished by log check thread to buffer   *
+ *          and updates metric state                                          *
+ *                                                                            *
+ * Parameters: addrs - [IN] server addresses                                  *
+ *             job   - [IN] finished log check                                *
+ *             now   - [OUT] current time                                     *
+ *                                                                            *
+ ******************************************************************************/
+static void	process_log_result(zbx_vector_addr_ptr_t *addrs, zbx_active_log_job_t *job, int *now,
+		const zbx_config_tls_t *config_tls, int config_timeout, const char *config_source_ip,
+		const char *config_hostname, int config_buffer_send, int config_buffer_size)
+{
+	zbx_active_metric_t	*metric = job->metric;
+	int			i;
+
+	/* values fit into space reserved for them, so they are added in the order they were read */
+	log_slots_reserved -= job->slots;
+
+	for (i = 0; i < job->values.values_num; i++)
+	{
+		zbx_active_log_value_t	*log_value = &job->values.values[i];
+
+		process_value(addrs, NULL, metric->itemid, config_hostname, metric->key, log_value->value,
+				log_value->state, &log_value->lastlogsize, &log_value->mtime, NULL, NULL, NULL, NULL,
+				log_value->flags, config_tls, config_timeout, config_source_ip, config_buffer_send,
+				config_buffer_size);
+	}
+
+	/* persistent file data is written when buffered values are sent */
+	for (i = 0; i < job->prep_vec.values_num; i++)
+	{
+		zbx_pre_persistent_t	*prep = &job->prep_vec.values[i], *prep_dst;
+		char			*persistent_file_name;
+
+		prep_dst = &pre_persistent_vec.values[zbx_find_or_create_prep_vec_element(&pre_persistent_vec,
+				prep->itemid, prep->persistent_file_name)];
+
+		zbx_free(prep_dst->filename);
+		persistent_file_name = prep_dst->persistent_file_name;
+		*prep_dst = *prep;
+		prep_dst->persistent_file_name = persistent_file_name;
+		prep->filename = NULL;
+	}
+
+	zbx_log_watch_update(metric, job->ret);
+
+	process_check_result(addrs, metric, job->ret, &job->error, job->lastlogsize_last, job->mtime_last,
+			job->lastlogsize_sent, job->mtime_sent, now, config_tls, config_timeout, config_source_ip,
+			config_hostname, config_buffer_send, config_buffer_size);
+}
+#endif
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: processes results of checks finished by worker processes and     *
+ *          log check threads                                                 *
+ *                                                                            *
+ * Parameters: addrs      - [IN] server addresses                             *
+ *             timeout_ms - [IN] 0 to process only already finished checks,   *
+ *                               -1 to wait until all workers are idle        *
+ *             now        - [OUT] current time                                *
+ *                                                                            *
+ * Return value: number of processed results                                  *
+ *                                                                            *
+ ******************************************************************************/
+static int	process_worker_results(zbx_vector_addr_ptr_t *addrs, int timeout_ms, int *now,
+		const zbx_config_tls_t *config_tls, int config_timeout, const char *config_source_ip,
+		const char *config_hostname, int config_buffer_send, int config_buffer_size)
+{
+	zbx_active_metric_t	*metric;
+	zbx_active_log_job_t	*job;
+	AGENT_RESULT		result;
+	int			ret, processed_num = 0;
+
+	zbx_init_agent_result(&result);
+
+	while (SUCCEED == zbx_active_workers_result(timeout_ms, &metric, &ret, &result, &job))
+	{
+		char	*error = NULL;
+
+		metric->in_progress = 0;
+		processed_num++;
+
+		if (NULL != job)
+		{
+#if !defined(_WINDOWS) && !defined(__MINGW32__)
+			process_log_result(addrs, job, now, config_tls, config_timeout, config_source_ip,
+					config_hostname, config_buffer_send, config_buffer_size);
+			zbx_active_log_job_free(job);
+#endif
+			continue;
+		}
+
+		ret = process_common_result(addrs, metric, ret, &result, config_tls, config_timeout,
+				config_source_ip, config_hostname, config_buffer_send, config_buffer_size, &error);
+
+		process_check_result(addrs, metric, ret, &error, metric->lastlogsize, metric->mtime,
+				metric->lastlogsize, metric->mtime, now, config_tls, config_timeout, config_source_ip,
+				config_hostname, config_buffer_send, config_buffer_size);
+
+		zbx_free_agent_result(&result);
+		zbx_init_agent_result(&result);
+	}
+
+	zbx_free_agent_result(&result);
+
+	return processed_num;
+}
+
 static void	process_active_checks(zbx_vector_addr_ptr_t *addrs, const zbx_config_tls_t *config_tls,
 		int config_timeout, const char *config_source_ip, const char *config_hostname, int config_buffer_send,
 		int config_buffer_size, int config_eventlog_max_lines_per_second, int config_max_lines_per_second)
@@ -1622,7 +1939,14 @@ static void	process_active_checks(zbx_vector_addr_ptr_t *addrs, const zbx_config
 		int			mtime_last, mtime_sent, ret, scheduling = FAIL;
 		zbx_active_metric_t	*metric = active_metrics.values[i];
 
-		if (metric->nextcheck > now)
+		if (0 != zbx_active_workers_busy())
+		{
+			process_worker_results(addrs, 0, &now, config_tls, config_timeout, config_source_ip,
+					config_hostname, config_buffer_send, config_buffer_size);
+		}
+
+		/* metric still being checked by worker must not be passed to another worker */
+		if (0 != metric->in_progress || metric->nextcheck > now)
 			continue;
 
 		if (SUCCEED != zbx_get_agent_item_nextcheck(metric->itemid, metric->delay, now, &metric->nextcheck,
@@ -1641,6 +1965,15 @@ static void	process_active_checks(zbx_vector_addr_ptr_t *addrs, const zbx_config
 			continue;
 		}
 
+		/* log items are checked by log check threads or by active checks process to keep their file state, */
+		/* other checks are passed to idle workers or checked here if all workers are busy                 */
+		if (0 == (ZBX_METRIC_FLAG_LOG & metric->flags) && ZBX_CHECK_TIMEOUT_UNDEFINED != metric->timeout &&
+				SUCCEED == zbx_active_worker_check(metric))
+		{
+			metric->in_progress = 1;
+			continue;
+		}
+
 		/* for meta information update we need to know if something was sent at all during the check */
 		lastlogsize_last = metric->lastlogsize;
 		mtime_last = metric->mtime;
@@ -1650,10 +1983,30 @@ static void	process_active_checks(zbx_vector_addr_ptr_t *addrs, const zbx_config
 
 		if (0 != ((ZBX_METRIC_FLAG_LOG_LOG | ZBX_METRIC_FLAG_LOG_LOGRT) & metric->flags))
 		{
-			ret = process_log_check(addrs, NULL, &regexps, metric, process_value, &lastlogsize_sent,
-					&mtime_sent, &error, &pre_persistent_vec, config_tls, config_timeout,
-					config_source_ip, config_hostname, config_buffer_send, config_buffer_size,
-					config_max_lines_per_second);
+			if (SUCCEED == zbx_log_watch_unchanged(metric))
+			{
+				zabbix_log(LOG_LEVEL_DEBUG, "skipping check \"%s\": log files did not change",
+						metric->key);
+				ret = SUCCEED;
+			}
+			else
+			{
+#if !defined(_WINDOWS) && !defined(__MINGW32__)
+				if (SUCCEED == active_log_check(addrs, metric, config_tls, config_timeout,
+						config_source_ip, config_hostname, config_buffer_send, config_buffer_size,
+						config_max_lines_per_second))
+				{
+					metric->in_progress = 1;
+					continue;
+				}
+#endif
+				ret = process_log_check(addrs, NULL, &regexps, metric, process_value,
+						&lastlogsize_sent, &mtime_sent, &error, &pre_persistent_vec, config_tls,
+						config_timeout, config_source_ip, config_hostname, config_buffer_send,
+						config_buffer_size, config_max_lines_per_second);
+
+				zbx_log_watch_update(metric, ret);
+			}
 		}
 		else if (0 != (ZBX_METRIC_FLAG_LOG_EVENTLOG & metric->flags))
 		{
@@ -1666,106 +2019,9 @@ static void	process_active_checks(zbx_vector_addr_ptr_t *addrs, const zbx_config
 			ret = process_common_check(addrs, metric, config_tls, config_timeout, config_source_ip,
 					config_hostname, config_buffer_send, config_buffer_size, &error);
 
-		if (SUCCEED != ret)
-		{
-			const char	*perror = (NULL != error ? error : ZBX_NOTSUPPORTED_MSG);
-
-			metric->state = ITEM_STATE_NOTSUPPORTED;
-			metric->error_count = 0;
-			metric->processed_bytes = 0;
-
-			zabbix_log(LOG_LEVEL_WARNING, "active check \"%s\" is not supported: %s", metric->key, perror);
-#if !defined(_WINDOWS) && !defined(__MINGW32__)
-			/* only for log*[] items */
-			if (0 != ((ZBX_METRIC_FLAG_LOG_LOG | ZBX_METRIC_FLAG_LOG_LOGRT) & metric->flags) &&
-					NULL != metric->persistent_file_name)
-			{
-				const struct st_logfile	*logfile = NULL;
-
-				if (0 < metric->logfiles_num)
-				{
-					logfile = find_last_processed_file_in_logfiles_list(metric->logfiles,
-							metric->logfiles_num);
-				}
-
-				zbx_fill_prep_vec_element(&pre_persistent_vec, metric->itemid,
-						metric->persistent_file_name, logfile, metric->lastlogsize,
-						metric->mtime);
-			}
-#endif
-			process_value(addrs, NULL, metric->itemid, config_hostname, metric->key, perror,
-					ITEM_STATE_NOTSUPPORTED, &metric->lastlogsize, &metric->mtime, NULL, NULL, NULL,
-					NULL, metric->flags, config_tls, config_timeout, config_source_ip,
-					config_buffer_send, config_buffer_size);
-
-			zbx_free(error);
-		}
-		else
-		{
-			if (0 == metric->error_count)
-			{
-				unsigned char	old_state = metric->state;
-
-				if (ITEM_STATE_NOTSUPPORTED == metric->state)
-				{
-					/* item became supported */
-					metric->state = ITEM_STATE_NORMAL;
-				}
-
-				if (SUCCEED == need_meta_update(metric, lastlogsize_sent, mtime_sent, old_state,
-						lastlogsize_last, mtime_last))
-				{
-#if !defined(_WINDOWS) && !defined(__MINGW32__)
-					if (NULL != metric->persistent_file_name)
-					{
-						const struct st_logfile	*logfile = NULL;
-
-						if (0 < metric->logfiles_num)
-						{
-							logfile = find_last_processed_file_in_logfiles_list(
-									metric->logfiles, metric->logfiles_num);
-						}
-
-						zbx_fill_prep_vec_element(&pre_persistent_vec, metric->itemid,
-								metric->persistent_file_name, logfile,
-								metric->lastlogsize, metric->mtime);
-					}
-#endif
-					/* meta information update */
-					process_value(addrs, NULL, metric->itemid, config_hostname, metric->key, NULL,
-							metric->state, &metric->lastlogsize, &metric->mtime, NULL, NULL,
-							NULL, NULL, metric->flags, config_tls, config_timeout,
-							config_source_ip, config_buffer_send, config_buffer_size);
-				}
-
-				/* remove "new metric" flag */
-				metric->flags &= ~ZBX_METRIC_FLAG_NEW;
-			}
-		}
-
-		send_buffer(addrs, &pre_persistent_vec, config_tls, config_timeout, config_source_ip, config_hostname,
+		process_check_result(addrs, metric, ret, &error, lastlogsize_last, mtime_last, lastlogsize_sent,
+				mtime_sent, &now, config_tls, config_timeout, config_source_ip, config_hostname,
 				config_buffer_send, config_buffer_size);
-
-		if (metric->nextcheck <= (now = (int)time(NULL)))
-		{
-			/* reschedule metric if polling took it past is scheduled next poll */
-
-			if (SUCCEED != zbx_get_agent_item_nextcheck(metric->itemid, metric->delay, now,
-					&metric->nextcheck, &scheduling, &error))
-			{
-				/* while not likely that another nextcheck calculation with the same     */
-				/* delay could result in an error - still it can be handled and reported */
-				process_value(addrs, NULL, metric->itemid, config_hostname, metric->key, error,
-						ITEM_STATE_NOTSUPPORTED, &metric->lastlogsize, &metric->mtime, NULL,
-						NULL, NULL, NULL, metric->flags, config_tls, config_timeout,
-						config_source_ip, config_buffer_send, config_buffer_size);
-
-				metric->state = ITEM_STATE_NOTSUPPORTED;
-				metric->error_count = 0;
-
-				zbx_free(error);
-			}
-		}
 	}
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
@@ -1856,7 +2112,7 @@ ZBX_THREAD_ENTRY(active_checks_thread, args)
 	zbx_thread_info_t		*info = &((zbx_thread_args_t *)args)->info;
 	unsigned char			process_type = ((zbx_thread_args_t *)args)->info.process_type;
 	int				server_num = ((zbx_thread_args_t *)args)->info.server_num,
-					process_num = ((zbx_thread_args_t *)args)->info.process_num;
+					process_num = ((zbx_thread_args_t *)args)->info.process_num, check_now;
 
 	activechks_args_in = (zbx_thread_activechk_args *)((((zbx_thread_args_t *)args))->args);
 
@@ -1877,6 +2133,28 @@ ZBX_THREAD_ENTRY(active_checks_thread, args)
 #endif
 	init_active_metrics(activechks_args_in->config_buffer_size);
 
+	if (1 == activechks_args_in->config_log_file_watch)
+	{
+		char	*error = NULL;
+
+		if (SUCCEED != zbx_log_watch_init(&error))
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "log files will be checked on every update interval: %s", error);
+			zbx_free(error);
+		}
+	}
+
+	if (0 != activechks_args_in->config_active_check_workers)
+	{
+		char	*error = NULL;
+
+		if (SUCCEED != zbx_active_workers_init(activechks_args_in->config_active_check_workers, &error))
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "active checks will be processed sequentially: %s", error);
+			zbx_free(error);
+		}
+	}
+
 #ifndef _WINDOWS
 	zbx_set_sigusr_handler(zbx_active_checks_sigusr_handler);
 #endif
@@ -1890,14 +2168,53 @@ ZBX_THREAD_ENTRY(active_checks_thread, args)
 		if (1 == need_update_userparam)
 		{
 			zbx_setproctitle("active checks #%d [reloading user parameters]", process_num);
+
+			/* checks started with old user parameters must finish before workers are restarted */
+			if (0 != zbx_active_workers_busy())
+			{
+				process_worker_results(&activechk_args.addrs, -1, &check_now,
+						activechks_args_in->zbx_config_tls, activechks_args_in->config_timeout,
+						activechks_args_in->config_source_ip, config_hostname,
+						activechks_args_in->config_buffer_send,
+						activechks_args_in->config_buffer_size);
+			}
+
 			reload_user_parameters(process_type, process_num, activechks_args_in->config_file,
 					activechks_args_in->config_user_parameters);
 			need_update_userparam = 0;
+
+			/* workers must be restarted to inherit reloaded user parameters */
+			if (0 != zbx_active_workers_num())
+			{
+				char	*error = NULL;
+
+				zbx_active_workers_destroy();
+
+				if (SUCCEED != zbx_active_workers_init(activechks_args_in->config_active_check_workers,
+						&error))
+				{
+					zabbix_log(LOG_LEVEL_WARNING, "active checks will be processed"
+							" sequentially: %s", error);
+					zbx_free(error);
+				}
+			}
 		}
 #endif
 
 		zbx_update_env(get_process_type_string(process_type), zbx_time());
 
+		if (0 != zbx_active_workers_busy() && 0 != process_worker_results(&activechk_args.addrs, 0,
+				&check_now, activechks_args_in->zbx_config_tls, activechks_args_in->config_timeout,
+				activechks_args_in->config_source_ip, config_hostname,
+				activechks_args_in->config_buffer_send, activechks_args_in->config_buffer_size))
+		{
+			time_t	min_nextcheck;
+
+			/* metrics checked by workers are rescheduled when their results are processed */
+			if (FAIL != (min_nextcheck = get_min_nextcheck()) && min_nextcheck < nextcheck)
+				nextcheck = min_nextcheck;
+		}
+
 		if ((now = time(NULL)) >= nextsend)
 		{
 			send_buffer(&activechk_args.addrs, &pre_persistent_vec, activechks_args_in->zbx_config_tls,
@@ -1920,6 +2237,16 @@ ZBX_THREAD_ENTRY(active_checks_thread, args)
 		{
 			zbx_setproctitle("active checks #%d [getting list of active checks]", process_num);
 
+			/* metrics must not be checked by workers when active checks are refreshed */
+			if (0 != zbx_active_workers_busy())
+			{
+				process_worker_results(&activechk_args.addrs, -1, &check_now,
+						activechks_args_in->zbx_config_tls, activechks_args_in->config_timeout,
+						activechks_args_in->config_source_ip, config_hostname,
+						activechks_args_in->config_buffer_send,
+						activechks_args_in->config_buffer_size);
+			}
+
 			if (FAIL == refresh_active_checks(&activechk_args.addrs, activechks_args_in->zbx_config_tls,
 					&config_revision_local, activechks_args_in->config_timeout,
 					activechks_args_in->config_source_ip, activechks_args_in->config_listen_ip,
@@ -1999,6 +2326,8 @@ ZBX_THREAD_ENTRY(active_checks_thread, args)
 	}
 
 	zbx_free(session_token);
+	zbx_active_workers_destroy();
+	zbx_log_watch_destroy();
 
 #ifdef _WINDOWS
 	zbx_vector_addr_ptr_clear_ext(&activechk_args.addrs, (zbx_clean_func_t)zbx_addr_free);
@@ -41,6 +41,8 @@ typedef struct
 	int			config_buffer_size;
 	int			config_eventlog_max_lines_per_second;
 	int			config_max_lines_per_second;
+	int			config_log_file_watch;
+	int			config_active_check_workers;
 	int			config_refresh_active_checks;
 	char			**config_user_parameters;
 }
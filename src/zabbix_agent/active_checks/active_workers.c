@@ -0,0 +1,1001 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "active_workers.h"
+
+#include "zbxsysinfo.h"
+#include "zbxstr.h"
+
+#if !defined(_WINDOWS) && !defined(__MINGW32__)
+#include "zbxnix.h"
+#include "zbxthreads.h"
+#include "zbxfile.h"
+#include "zbxcomms.h"
+
+/* Active checks worker is a process forked by active checks process, it executes agent checks received over   */
+/* socket one at a time and sends back results. Worker processes have their own alarm timers, which are used  */
+/* by system.run[], user parameters and other checks to enforce timeouts and can not be shared by threads.    */
+typedef struct
+{
+	pid_t			pid;
+	int			fd;
+	zbx_active_metric_t	*metric;	/* metric being checked by worker, NULL if worker is idle */
+}
+zbx_active_worker_t;
+
+static zbx_active_worker_t	*workers = NULL;
+static int			workers_num = 0;
+
+/* Log check threads run log[] and logrt[] checks of active checks process. Log checks do not use alarm timers,  */
+/* but they keep file state in metric, so metric is checked by one thread at a time and its collected values    */
+/* are added to buffer by active checks process in the order they were read.                                    */
+typedef struct
+{
+	pthread_t		*threads;
+	int			threads_num;
+
+	pthread_mutex_t		lock;
+	pthread_cond_t		cond_start;	/* signalled when job is queued or threads must exit */
+	pthread_cond_t		cond_idle;	/* signalled when thread finishes job */
+
+	zbx_vector_ptr_t	queued;
+	zbx_vector_ptr_t	done;
+	int			running;
+	int			stop;
+
+	/* threads write a byte to pipe after finishing job to wake up active checks process polling workers */
+	int			notify_fds[2];
+}
+zbx_active_log_pool_t;
+
+static zbx_active_log_pool_t	*log_pool = NULL;
+
+ZBX_VECTOR_IMPL(active_log_value, zbx_active_log_value_t)
+
+/* result types in worker response */
+#define ZBX_ACTIVE_WORKER_RESULT_NONE	'-'
+#define ZBX_ACTIVE_WORKER_RESULT_TEXT	't'
+#define ZBX_ACTIVE_WORKER_RESULT_MSG	'm'
+
+static int	active_worker_read(int fd, void *buf, size_t n)
+{
+	char	*ptr = (char *)buf;
+
+	while (0 < n)
+	{
+		ssize_t	rc;
+
+		if (0 >= (rc = read(fd, ptr, n)))
+		{
+			if (-1 == rc && EINTR == errno)
+				continue;
+
+			return FAIL;
+		}
+
+		ptr += rc;
+		n -= (size_t)rc;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reads length prefixed string                                      *
+ *                                                                            *
+ * Parameters: fd  - [IN]                                                     *
+ *             str - [OUT] null terminated string                             *
+ *                                                                            *
+ * Return value: SUCCEED - string was read                                    *
+ *               FAIL    - connection was closed or read error                *
+ *                                                                            *
+ ******************************************************************************/
+static int	active_worker_read_str(int fd, char **str)
+{
+	zbx_uint32_t	len;
+
+	if (SUCCEED != active_worker_read(fd, &len, sizeof(len)))
+		return FAIL;
+
+	*str = (char *)zbx_malloc(NULL, (size_t)len + 1);
+
+	if (SUCCEED != active_worker_read(fd, *str, len))
+	{
+		zbx_free(*str);
+		return FAIL;
+	}
+
+	(*str)[len] = '\0';
+
+	return SUCCEED;
+}
+
+static void	active_worker_pack_str(char **data, size_t *data_alloc, size_t *data_offset, const char *str)
+{
+	zbx_uint32_t	len = (zbx_uint32_t)strlen(str);
+
+	zbx_str_memcpy_alloc(data, data_alloc, data_offset, (const char *)&len, sizeof(len));
+	zbx_str_memcpy_alloc(data, data_alloc, data_offset, str, len);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: executes checks requested by active checks process                *
+ *                                                                            *
+ * Parameters: fd - [IN] socket connected to active checks process            *
+ *                                                                            *
+ * Comments: Request is [timeout][key length][key], response is               *
+ *           [return code][result type][value length][value]. Worker exits    *
+ *           when active checks process closes the socket.                    *
+ *                                                                            *
+ ******************************************************************************/
+static void	active_worker_run(int fd)
+{
+	char	*key = NULL, *data = NULL;
+	size_t	data_alloc = 0, data_offset;
+	int	timeout;
+
+	zbx_set_metric_thread_signal_handler();
+
+	while (SUCCEED == active_worker_read(fd, &timeout, sizeof(timeout)) &&
+			SUCCEED == active_worker_read_str(fd, &key))
+	{
+		AGENT_RESULT	result;
+		char		**pvalue, type;
+		int		ret;
+
+		zbx_init_agent_result(&result);
+
+		ret = zbx_execute_agent_check(key, 0, &result, timeout);
+
+		if (SUCCEED == ret && NULL != (pvalue = ZBX_GET_TEXT_RESULT(&result)))
+			type = ZBX_ACTIVE_WORKER_RESULT_TEXT;
+		else if (SUCCEED != ret && NULL != (pvalue = ZBX_GET_MSG_RESULT(&result)))
+			type = ZBX_ACTIVE_WORKER_RESULT_MSG;
+		else
+			type = ZBX_ACTIVE_WORKER_RESULT_NONE;
+
+		data_offset = 0;
+		zbx_str_memcpy_alloc(&data, &data_alloc, &data_offset, (const char *)&ret, sizeof(ret));
+		zbx_chrcpy_alloc(&data, &data_alloc, &data_offset, type);
+
+		if (ZBX_ACTIVE_WORKER_RESULT_NONE != type)
+			active_worker_pack_str(&data, &data_alloc, &data_offset, *pvalue);
+
+		zbx_free_agent_result(&result);
+		zbx_free(key);
+
+		if (SUCCEED != zbx_write_all(fd, data, data_offset))
+			break;
+	}
+
+	zbx_free(data);
+	zbx_free(key);
+	close(fd);
+
+	exit(EXIT_SUCCESS);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: waits until log check threads finish their running checks and    *
+ *          keeps them from starting new ones until resumed                   *
+ *                                                                            *
+ * Comments: Worker processes are forked while log check threads do not hold  *
+ *           any locks of the process, so that forked worker does not         *
+ *           inherit them locked.                                             *
+ *                                                                            *
+ ******************************************************************************/
+static void	active_log_threads_pause(void)
+{
+	if (NULL == log_pool)
+		return;
+
+	pthread_mutex_lock(&log_pool->lock);
+
+	while (0 != log_pool->running)
+		pthread_cond_wait(&log_pool->cond_idle, &log_pool->lock);
+}
+
+static void	active_log_threads_resume(void)
+{
+	if (NULL == log_pool)
+		return;
+
+	pthread_mutex_unlock(&log_pool->lock);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: collects value of log check executed by log check thread         *
+ *                                                                            *
+ * Comments: This function has zbx_process_value_func_t prototype, the job    *
+ *           is passed in agent2_result the same way as Agent2 passes its     *
+ *           log result. Persistent values are limited by buffer slots        *
+ *           reserved for the job, so values can be added to buffer later     *
+ *           without overwriting other persistent values. When the slots are  *
+ *           used up, the check stops at the last collected value as it does  *
+ *           when buffer is full.                                             *
+ *                                                                            *
+ ******************************************************************************/
+static int	active_log_value_cb(zbx_vector_addr_ptr_t *addrs, zbx_vector_ptr_t *agent2_result, zbx_uint64_t itemid,
+		const char *host, const char *key, const char *value, unsigned char state, zbx_uint64_t *lastlogsize,
+		const int *mtime, const unsigned long *timestamp, const char *source, const unsigned short *severity,
+		const unsigned long *logeventid, unsigned char flags, const zbx_config_tls_t *config_tls,
+		int config_timeout, const char *config_source_ip, int config_buffer_send, int config_buffer_size)
+{
+	zbx_active_log_job_t	*job = (zbx_active_log_job_t *)agent2_result;
+	zbx_active_log_value_t	log_value;
+
+	if (0 != (ZBX_METRIC_FLAG_PERSISTENT & flags) && job->values.values_num >= job->slots)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "buffer is full, cannot store persistent value of \"%s\"", key);
+		return FAIL;
+	}
+
+	log_value.value = (NULL != value ? zbx_strdup(NULL, value) : NULL);
+	log_value.lastlogsize = (NULL != lastlogsize ? *lastlogsize : 0);
+	log_value.mtime = (NULL != mtime ? *mtime : 0);
+	log_value.state = state;
+	log_value.flags = flags;
+
+	zbx_vector_active_log_value_append(&job->values, log_value);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: log check thread entry                                            *
+ *                                                                            *
+ ******************************************************************************/
+static void	*active_log_thread(void *args)
+{
+	zbx_active_log_pool_t	*pool = (zbx_active_log_pool_t *)args;
+
+	pthread_mutex_lock(&pool->lock);
+
+	while (1)
+	{
+		zbx_active_log_job_t	*job;
+		char			notify = 0;
+
+		while (0 == pool->stop && 0 == pool->queued.values_num)
+			pthread_cond_wait(&pool->cond_start, &pool->lock);
+
+		if (0 != pool->stop)
+			break;
+
+		job = (zbx_active_log_job_t *)pool->queued.values[0];
+		zbx_vector_ptr_remove(&pool->queued, 0);
+		pool->running++;
+		pthread_mutex_unlock(&pool->lock);
+
+		job->ret = process_log_check(&job->addrs, (zbx_vector_ptr_t *)job, job->regexps, job->metric,
+				active_log_value_cb, &job->lastlogsize_sent, &job->mtime_sent, &job->error,
+				&job->prep_vec, job->config_tls, job->config_timeout, job->config_source_ip,
+				job->config_hostname, job->config_buffer_send, job->config_buffer_size,
+				job->config_max_lines_per_second);
+
+		pthread_mutex_lock(&pool->lock);
+		zbx_vector_ptr_append(&pool->done, job);
+		pool->running--;
+		pthread_cond_signal(&pool->cond_idle);
+		pthread_mutex_unlock(&pool->lock);
+
+		/* pipe can not be full, there is at most one byte for each finished job */
+		if (SUCCEED != zbx_write_all(pool->notify_fds[1], &notify, sizeof(notify)))
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "cannot notify active checks process about finished log check:"
+					" %s", zbx_strerror(errno));
+		}
+
+		pthread_mutex_lock(&pool->lock);
+	}
+
+	pthread_mutex_unlock(&pool->lock);
+
+	return NULL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: discards notifications of finished log checks                     *
+ *                                                                            *
+ ******************************************************************************/
+static void	active_log_notify_clear(void)
+{
+	char	buf[16];
+	ssize_t	rc;
+
+	while (0 < (rc = read(log_pool->notify_fds[0], buf, sizeof(buf))) || (-1 == rc && EINTR == errno))
+		;
+}
+
+static void	active_log_pool_free(zbx_active_log_pool_t *pool)
+{
+	zbx_vector_ptr_clear_ext(&pool->queued, (zbx_clean_func_t)zbx_active_log_job_free);
+	zbx_vector_ptr_destroy(&pool->queued);
+	zbx_vector_ptr_clear_ext(&pool->done, (zbx_clean_func_t)zbx_active_log_job_free);
+	zbx_vector_ptr_destroy(&pool->done);
+
+	close(pool->notify_fds[0]);
+	close(pool->notify_fds[1]);
+
+	pthread_cond_destroy(&pool->cond_idle);
+	pthread_cond_destroy(&pool->cond_start);
+	pthread_mutex_destroy(&pool->lock);
+
+	zbx_free(pool->threads);
+	zbx_free(pool);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: starts log check threads                                          *
+ *                                                                            *
+ * Parameters: threads_num - [IN] number of threads                           *
+ *             error       - [OUT] error message                              *
+ *                                                                            *
+ * Return value: SUCCEED - at least one thread was started                    *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: All asynchronous signals are blocked in log check threads, so    *
+ *           they are delivered to active checks process main thread.         *
+ *                                                                            *
+ ******************************************************************************/
+static int	active_log_pool_create(int threads_num, char **error)
+{
+	zbx_active_log_pool_t	*pool;
+	pthread_attr_t		attr;
+	sigset_t		mask, orig_mask;
+	int			err;
+
+	pool = (zbx_active_log_pool_t *)zbx_malloc(NULL, sizeof(zbx_active_log_pool_t));
+	memset(pool, 0, sizeof(zbx_active_log_pool_t));
+
+	if (-1 == pipe(pool->notify_fds))
+	{
+		*error = zbx_dsprintf(*error, "cannot create pipe: %s", zbx_strerror(errno));
+		zbx_free(pool);
+		return FAIL;
+	}
+
+	if (-1 == fcntl(pool->notify_fds[0], F_SETFL, O_NONBLOCK))
+	{
+		*error = zbx_dsprintf(*error, "cannot set pipe to non-blocking mode: %s", zbx_strerror(errno));
+		close(pool->notify_fds[0]);
+		close(pool->notify_fds[1]);
+		zbx_free(pool);
+		return FAIL;
+	}
+
+	pthread_mutex_init(&pool->lock, NULL);
+	pthread_cond_init(&pool->cond_start, NULL);
+	pthread_cond_init(&pool->cond_idle, NULL);
+	zbx_vector_ptr_create(&pool->queued);
+	zbx_vector_ptr_create(&pool->done);
+
+	pool->threads = (pthread_t *)zbx_malloc(NULL, sizeof(pthread_t) * (size_t)threads_num);
+
+	/* threads inherit signal mask, synchronous signals are left unblocked to keep crash handling */
+	sigfillset(&mask);
+	sigdelset(&mask, SIGSEGV);
+	sigdelset(&mask, SIGBUS);
+	sigdelset(&mask, SIGFPE);
+	sigdelset(&mask, SIGILL);
+
+	if (0 != (err = pthread_sigmask(SIG_BLOCK, &mask, &orig_mask)))
+	{
+		*error = zbx_dsprintf(*error, "cannot block signals: %s", zbx_strerror(err));
+		active_log_pool_free(pool);
+		return FAIL;
+	}
+
+	zbx_pthread_init_attr(&attr);
+
+	for (int i = 0; i < threads_num; i++)
+	{
+		if (0 != (err = pthread_create(&pool->threads[pool->threads_num], &attr, active_log_thread, pool)))
+		{
+			*error = zbx_dsprintf(*error, "cannot create log check thread: %s", zbx_strerror(err));
+			break;
+		}
+
+		pool->threads_num++;
+	}
+
+	pthread_attr_destroy(&attr);
+
+	if (0 != (err = pthread_sigmask(SIG_SETMASK, &orig_mask, NULL)))
+		zabbix_log(LOG_LEVEL_WARNING, "cannot restore signal mask: %s", zbx_strerror(err));
+
+	if (0 == pool->threads_num)
+	{
+		active_log_pool_free(pool);
+		return FAIL;
+	}
+
+	if (pool->threads_num != threads_num)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "started %d of %d log check threads: %s", pool->threads_num,
+				threads_num, *error);
+		zbx_free(*error);
+	}
+
+	log_pool = pool;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: stops log check threads                                           *
+ *                                                                            *
+ * Comments: Running checks are finished, queued and finished checks are      *
+ *           discarded.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+static void	active_log_pool_destroy(void)
+{
+	if (NULL == log_pool)
+		return;
+
+	pthread_mutex_lock(&log_pool->lock);
+	log_pool->stop = 1;
+	pthread_cond_broadcast(&log_pool->cond_start);
+	pthread_mutex_unlock(&log_pool->lock);
+
+	for (int i = 0; i < log_pool->threads_num; i++)
+		pthread_join(log_pool->threads[i], NULL);
+
+	active_log_pool_free(log_pool);
+	log_pool = NULL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: forks worker process                                              *
+ *                                                                            *
+ * Parameters: index - [IN] index of worker                                   *
+ *             error - [OUT] error message                                    *
+ *                                                                            *
+ * Return value: SUCCEED - worker was started                                 *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	active_worker_start(int index, char **error)
+{
+	zbx_active_worker_t	*worker = &workers[index];
+	int			fds[2];
+
+	if (-1 == socketpair(AF_UNIX, SOCK_STREAM, 0, fds))
+	{
+		*error = zbx_dsprintf(*error, "cannot create socket pair: %s", zbx_strerror(errno));
+		return FAIL;
+	}
+
+	active_log_threads_pause();
+
+	if (-1 == (worker->pid = zbx_fork()))
+	{
+		active_log_threads_resume();
+		*error = zbx_dsprintf(*error, "cannot fork worker process: %s", zbx_strerror(errno));
+		close(fds[0]);
+		close(fds[1]);
+		return FAIL;
+	}
+
+	if (0 == worker->pid)
+	{
+		/* worker must see end of file when active checks process closes its sockets */
+		for (int i = 0; i < workers_num; i++)
+		{
+			if (-1 != workers[i].fd)
+				close(workers[i].fd);
+		}
+
+		if (NULL != log_pool)
+		{
+			close(log_pool->notify_fds[0]);
+			close(log_pool->notify_fds[1]);
+		}
+
+		close(fds[0]);
+		zbx_setproctitle("active checks worker #%d", index + 1);
+		active_worker_run(fds[1]);
+	}
+
+	active_log_threads_resume();
+	close(fds[1]);
+
+	worker->fd = fds[0];
+	worker->metric = NULL;
+
+	return SUCCEED;
+}
+
+static void	active_worker_stop(zbx_active_worker_t *worker)
+{
+	if (-1 == worker->fd)
+		return;
+
+	close(worker->fd);
+	worker->fd = -1;
+
+	while (-1 == waitpid(worker->pid, NULL, 0))
+	{
+		if (EINTR != errno)
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "cannot wait for active checks worker process: %s",
+					zbx_strerror(errno));
+			break;
+		}
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: starts worker processes                                           *
+ *                                                                            *
+ * Parameters: num   - [IN] number of worker processes                        *
+ *             error - [OUT] error message                                    *
+ *                                                                            *
+ * Return value: SUCCEED - all workers were started                           *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_active_workers_init(int num, char **error)
+{
+	workers = (zbx_active_worker_t *)zbx_malloc(NULL, sizeof(zbx_active_worker_t) * (size_t)num);
+
+	for (int i = 0; i < num; i++)
+		workers[i].fd = -1;
+
+	for (workers_num = 0; workers_num < num; workers_num++)
+	{
+		if (SUCCEED != active_worker_start(workers_num, error))
+		{
+			zbx_active_workers_destroy();
+			return FAIL;
+		}
+	}
+
+	/* threads are started after worker processes, so that initial workers are forked by single thread */
+	if (SUCCEED != active_log_pool_create(num, error))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "log checks will be processed by active checks process: %s", *error);
+		zbx_free(*error);
+	}
+
+	return SUCCEED;
+}
+
+void	zbx_active_workers_destroy(void)
+{
+	active_log_pool_destroy();
+
+	for (int i = 0; i < workers_num; i++)
+		active_worker_stop(&workers[i]);
+
+	zbx_free(workers);
+	workers_num = 0;
+}
+
+int	zbx_active_workers_num(void)
+{
+	return workers_num;
+}
+
+int	zbx_active_workers_busy(void)
+{
+	int	busy = 0;
+
+	for (int i = 0; i < workers_num; i++)
+	{
+		if (NULL != workers[i].metric)
+			busy++;
+	}
+
+	/* finished log checks are busy until their results are processed */
+	if (NULL != log_pool)
+	{
+		pthread_mutex_lock(&log_pool->lock);
+		busy += log_pool->queued.values_num + log_pool->running + log_pool->done.values_num;
+		pthread_mutex_unlock(&log_pool->lock);
+	}
+
+	return busy;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: passes metric to idle worker                                      *
+ *                                                                            *
+ * Parameters: metric - [IN] metric to check                                  *
+ *                                                                            *
+ * Return value: SUCCEED - metric is being checked by worker                  *
+ *               FAIL    - no worker is available                             *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_active_worker_check(zbx_active_metric_t *metric)
+{
+	char	*data = NULL;
+	size_t	data_alloc = 0, data_offset = 0;
+	int	i;
+
+	for (i = 0; i < workers_num; i++)
+	{
+		/* worker which could not be restarted has no socket */
+		if (NULL == workers[i].metric && -1 != workers[i].fd)
+			break;
+	}
+
+	if (i == workers_num)
+		return FAIL;
+
+	zbx_str_memcpy_alloc(&data, &data_alloc, &data_offset, (const char *)&metric->timeout, sizeof(metric->timeout));
+	active_worker_pack_str(&data, &data_alloc, &data_offset, metric->key);
+
+	/* write error will be detected when reading result */
+	if (SUCCEED != zbx_write_all(workers[i].fd, data, data_offset))
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "cannot send check \"%s\" to active checks worker: %s", metric->key,
+				zbx_strerror(errno));
+	}
+
+	workers[i].metric = metric;
+	zbx_free(data);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reads check result of worker                                      *
+ *                                                                            *
+ * Parameters: worker - [IN]                                                  *
+ *             ret    - [OUT] check return code                               *
+ *             result - [OUT] check result                                    *
+ *                                                                            *
+ * Return value: SUCCEED - result was read                                    *
+ *               FAIL    - worker terminated                                  *
+ *                                                                            *
+ ******************************************************************************/
+static int	active_worker_read_result(zbx_active_worker_t *worker, int *ret, AGENT_RESULT *result)
+{
+	char	type, *value;
+
+	if (SUCCEED != active_worker_read(worker->fd, ret, sizeof(*ret)) ||
+			SUCCEED != active_worker_read(worker->fd, &type, sizeof(type)))
+	{
+		return FAIL;
+	}
+
+	if (ZBX_ACTIVE_WORKER_RESULT_NONE == type)
+		return SUCCEED;
+
+	if (SUCCEED != active_worker_read_str(worker->fd, &value))
+		return FAIL;
+
+	if (ZBX_ACTIVE_WORKER_RESULT_TEXT == type)
+		SET_TEXT_RESULT(result, value);
+	else
+		SET_MSG_RESULT(result, value);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: takes first finished log check                                    *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_active_log_job_t	*active_log_pool_pop(void)
+{
+	zbx_active_log_job_t	*job = NULL;
+
+	if (NULL == log_pool)
+		return NULL;
+
+	pthread_mutex_lock(&log_pool->lock);
+
+	if (0 != log_pool->done.values_num)
+	{
+		job = (zbx_active_log_job_t *)log_pool->done.values[0];
+		zbx_vector_ptr_remove(&log_pool->done, 0);
+	}
+
+	pthread_mutex_unlock(&log_pool->lock);
+
+	return job;
+}
+
+static int	active_log_pool_busy(void)
+{
+	int	busy;
+
+	if (NULL == log_pool)
+		return 0;
+
+	pthread_mutex_lock(&log_pool->lock);
+	busy = log_pool->queued.values_num + log_pool->running;
+	pthread_mutex_unlock(&log_pool->lock);
+
+	return busy;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: waits for check result of any busy worker or log check thread     *
+ *                                                                            *
+ * Parameters: timeout_ms - [IN] time to wait in milliseconds, -1 to wait     *
+ *                               until any busy worker finishes its check     *
+ *             metric     - [OUT] checked metric                              *
+ *             ret        - [OUT] check return code                           *
+ *             result     - [OUT] check result                                *
+ *             job        - [OUT] finished log check, NULL if the result is   *
+ *                                returned in ret and result                  *
+ *                                                                            *
+ * Return value: SUCCEED - check result was received                          *
+ *               FAIL    - no worker finished its check in time               *
+ *                                                                            *
+ * Comments: Worker which terminated during check is restarted and the check  *
+ *           is reported as not supported.                                    *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_active_workers_result(int timeout_ms, zbx_active_metric_t **metric, int *ret, AGENT_RESULT *result,
+		zbx_active_log_job_t **job)
+{
+	zbx_pollfd_t		*pfds;
+	zbx_active_worker_t	*worker = NULL;
+	int			i, pfds_num, rc, notified;
+
+	pfds = (zbx_pollfd_t *)zbx_malloc(NULL, sizeof(zbx_pollfd_t) * (size_t)(workers_num + 1));
+
+	do
+	{
+		if (NULL != (*job = active_log_pool_pop()))
+		{
+			*metric = (*job)->metric;
+			zbx_free(pfds);
+
+			return SUCCEED;
+		}
+
+		for (pfds_num = 0, i = 0; i < workers_num; i++)
+		{
+			if (NULL == workers[i].metric)
+				continue;
+
+			pfds[pfds_num].fd = workers[i].fd;
+			pfds[pfds_num].events = POLLIN;
+			pfds[pfds_num].revents = 0;
+			pfds_num++;
+		}
+
+		if (0 != active_log_pool_busy())
+		{
+			pfds[pfds_num].fd = log_pool->notify_fds[0];
+			pfds[pfds_num].events = POLLIN;
+			pfds[pfds_num].revents = 0;
+			pfds_num++;
+		}
+
+		if (0 == pfds_num)
+			break;
+
+		while (-1 == (rc = zbx_socket_poll(pfds, (unsigned long)pfds_num, timeout_ms)) && EINTR == errno)
+			;
+
+		for (notified = 0, i = 0; 0 < rc && i < pfds_num; i++)
+		{
+			if (0 == pfds[i].revents)
+				continue;
+
+			if (NULL != log_pool && pfds[i].fd == log_pool->notify_fds[0])
+			{
+				active_log_notify_clear();
+				notified = 1;
+				continue;
+			}
+
+			for (int j = 0; j < workers_num; j++)
+			{
+				if (workers[j].fd == pfds[i].fd)
+				{
+					worker = &workers[j];
+					break;
+				}
+			}
+
+			break;
+		}
+	}
+	while (NULL == worker && 0 != notified);
+
+	zbx_free(pfds);
+
+	if (NULL == worker)
+		return FAIL;
+
+	*metric = worker->metric;
+	worker->metric = NULL;
+
+	if (SUCCEED != active_worker_read_result(worker, ret, result))
+	{
+		char	*error = NULL;
+
+		zbx_free_agent_result(result);
+		SET_MSG_RESULT(result, zbx_strdup(NULL, "Active checks worker process terminated unexpectedly."));
+		*ret = NOTSUPPORTED;
+
+		zabbix_log(LOG_LEVEL_WARNING, "active checks worker process (PID: %d) terminated while checking"
+				" \"%s\"", (int)worker->pid, (*metric)->key);
+
+		active_worker_stop(worker);
+
+		if (SUCCEED != active_worker_start((int)(worker - workers), &error))
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "cannot restart active checks worker process: %s", error);
+			zbx_free(error);
+		}
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: creates log check job                                             *
+ *                                                                            *
+ * Parameters: metric - [IN] log[] or logrt[] metric                          *
+ *             addrs  - [IN] server addresses                                 *
+ *             slots  - [IN] number of persistent values reserved in buffer   *
+ *                                                                            *
+ * Comments: Server addresses are copied to job, because active checks        *
+ *           process can switch to another server during check. Other         *
+ *           parameters must stay valid until job is freed.                   *
+ *                                                                            *
+ ******************************************************************************/
+zbx_active_log_job_t	*zbx_active_log_job_create(zbx_active_metric_t *metric, const zbx_vector_addr_ptr_t *addrs,
+		zbx_vector_expression_t *regexps, const zbx_config_tls_t *config_tls, int config_timeout,
+		const char *config_source_ip, const char *config_hostname, int config_buffer_send,
+		int config_buffer_size, int config_max_lines_per_second, int slots)
+{
+	zbx_active_log_job_t	*job;
+
+	job = (zbx_active_log_job_t *)zbx_malloc(NULL, sizeof(zbx_active_log_job_t));
+	memset(job, 0, sizeof(zbx_active_log_job_t));
+
+	job->metric = metric;
+	zbx_vector_addr_ptr_create(&job->addrs);
+	zbx_addr_copy(&job->addrs, addrs);
+	job->regexps = regexps;
+	job->config_tls = config_tls;
+	job->config_timeout = config_timeout;
+	job->config_source_ip = config_source_ip;
+	job->config_hostname = config_hostname;
+	job->config_buffer_send = config_buffer_send;
+	job->config_buffer_size = config_buffer_size;
+	job->config_max_lines_per_second = config_max_lines_per_second;
+	job->slots = slots;
+
+	job->lastlogsize_last = job->lastlogsize_sent = metric->lastlogsize;
+	job->mtime_last = job->mtime_sent = metric->mtime;
+
+	zbx_vector_active_log_value_create(&job->values);
+	zbx_vector_pre_persistent_create(&job->prep_vec);
+
+	return job;
+}
+
+void	zbx_active_log_job_free(zbx_active_log_job_t *job)
+{
+	for (int i = 0; i < job->values.values_num; i++)
+		zbx_free(job->values.values[i].value);
+
+	zbx_vector_active_log_value_destroy(&job->values);
+
+	zbx_clean_pre_persistent_elements(&job->prep_vec);
+	zbx_vector_pre_persistent_destroy(&job->prep_vec);
+
+	zbx_vector_addr_ptr_clear_ext(&job->addrs, zbx_addr_free);
+	zbx_vector_addr_ptr_destroy(&job->addrs);
+
+	zbx_free(job->error);
+	zbx_free(job);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: passes log check to idle log check thread                         *
+ *                                                                            *
+ * Parameters: job - [IN] log check, owned by log check threads on success    *
+ *                                                                            *
+ * Return value: SUCCEED - log check is being executed by thread              *
+ *               FAIL    - no thread is available                             *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_active_log_check(zbx_active_log_job_t *job)
+{
+	int	ret = FAIL;
+
+	if (NULL == log_pool)
+		return FAIL;
+
+	pthread_mutex_lock(&log_pool->lock);
+
+	if (log_pool->queued.values_num + log_pool->running < log_pool->threads_num)
+	{
+		zbx_vector_ptr_append(&log_pool->queued, job);
+		pthread_cond_signal(&log_pool->cond_start);
+		ret = SUCCEED;
+	}
+
+	pthread_mutex_unlock(&log_pool->lock);
+
+	return ret;
+}
+#else
+int	zbx_active_workers_init(int workers_num, char **error)
+{
+	ZBX_UNUSED(workers_num);
+
+	*error = zbx_strdup(*error, "active checks worker processes are not supported on this platform");
+
+	return FAIL;
+}
+
+void	zbx_active_workers_destroy(void)
+{
+}
+
+int	zbx_active_workers_num(void)
+{
+	return 0;
+}
+
+int	zbx_active_workers_busy(void)
+{
+	return 0;
+}
+
+int	zbx_active_log_check(zbx_active_log_job_t *job)
+{
+	ZBX_UNUSED(job);
+
+	return FAIL;
+}
+
+int	zbx_active_worker_check(zbx_active_metric_t *metric)
+{
+	ZBX_UNUSED(metric);
+
+	return FAIL;
+}
+
+int	zbx_active_workers_result(int timeout_ms, zbx_active_metric_t **metric, int *ret, AGENT_RESULT *result,
+		zbx_active_log_job_t **job)
+{
+	ZBX_UNUSED(timeout_ms);
+	ZBX_UNUSED(metric);
+	ZBX_UNUSED(ret);
+	ZBX_UNUSED(result);
+	ZBX_UNUSED(job);
+
+	return FAIL;
+}
+#endif
@@ -0,0 +1,81 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#ifndef ZABBIX_ACTIVE_WORKERS_H
+#define ZABBIX_ACTIVE_WORKERS_H
+
+#include "../metrics/metrics.h"
+#include "../logfiles/logfiles.h"
+#include "module.h"
+
+/* value collected by log check thread, added to buffer by active checks process */
+typedef struct
+{
+	char		*value;
+	zbx_uint64_t	lastlogsize;
+	int		mtime;
+	unsigned char	state;
+	unsigned char	flags;
+}
+zbx_active_log_value_t;
+
+ZBX_VECTOR_DECL(active_log_value, zbx_active_log_value_t)
+
+/* log[] or logrt[] check executed by log check thread */
+typedef struct
+{
+	zbx_active_metric_t		*metric;
+	zbx_vector_addr_ptr_t		addrs;
+	zbx_vector_expression_t		*regexps;
+	const zbx_config_tls_t		*config_tls;
+	const char			*config_source_ip;
+	const char			*config_hostname;
+	int				config_timeout;
+	int				config_buffer_send;
+	int				config_buffer_size;
+	int				config_max_lines_per_second;
+
+	/* number of persistent values reserved in buffer for this check */
+	int				slots;
+
+	/* metric state before check */
+	zbx_uint64_t			lastlogsize_last;
+	int				mtime_last;
+
+	/* check results */
+	zbx_vector_active_log_value_t	values;
+	zbx_vector_pre_persistent_t	prep_vec;
+	zbx_uint64_t			lastlogsize_sent;
+	int				mtime_sent;
+	int				ret;
+	char				*error;
+}
+zbx_active_log_job_t;
+
+int	zbx_active_workers_init(int workers_num, char **error);
+void	zbx_active_workers_destroy(void);
+int	zbx_active_workers_num(void);
+int	zbx_active_workers_busy(void);
+int	zbx_active_worker_check(zbx_active_metric_t *metric);
+int	zbx_active_workers_result(int timeout_ms, zbx_active_metric_t **metric, int *ret, AGENT_RESULT *result,
+		zbx_active_log_job_t **job);
+
+zbx_active_log_job_t	*zbx_active_log_job_create(zbx_active_metric_t *metric, const zbx_vector_addr_ptr_t *addrs,
+		zbx_vector_expression_t *regexps, const zbx_config_tls_t *config_tls, int config_timeout,
+		const char *config_source_ip, const char *config_hostname, int config_buffer_send,
+		int config_buffer_size, int config_max_lines_per_second, int slots);
+void	zbx_active_log_job_free(zbx_active_log_job_t *job);
+int	zbx_active_log_check(zbx_active_log_job_t *job);
+
+#endif
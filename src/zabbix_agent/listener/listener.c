@@ -22,6 +22,7 @@
 #include "zbxtime.h"
 #include "zbx_rtc_constants.h"
 #include "zbxjson.h"
+#include "zbxnum.h"
 
 #if defined(ZABBIX_SERVICE)
 #	include "zbxwinservice.h"
@@ -32,7 +33,23 @@
 #ifndef _WINDOWS
 static volatile sig_atomic_t	need_update_userparam;
 #endif
-static int	process_passive_checks_json(zbx_socket_t *s, int config_timeout, struct zbx_json_parse *jp)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: processes passive check request in JSON format                    *
+ *                                                                            *
+ * Parameters: s              - [IN] socket with received request             *
+ *             config_timeout - [IN]                                          *
+ *             jp             - [IN] parsed request                           *
+ *             keep_alive     - [OUT] number of seconds to wait for the next  *
+ *                                    request on the same connection, 0 if    *
+ *                                    the connection must be closed           *
+ *                                                                            *
+ * Return value: SUCCEED - response was sent                                  *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	process_passive_checks_json(zbx_socket_t *s, int config_timeout, struct zbx_json_parse *jp,
+		int *keep_alive)
 {
 	struct zbx_json_parse	jp_data, jp_row;
 	const char		*p = NULL;
@@ -43,6 +60,8 @@ static int	process_passive_checks_json(zbx_socket_t *s, int config_timeout, stru
 	AGENT_RESULT		result;
 	char			**value;
 
+	*keep_alive = 0;
+
 	zbx_json_init(&j, ZBX_JSON_STAT_BUF_LEN);
 	zbx_json_addstring(&j, ZBX_PROTO_TAG_VERSION, ZABBIX_VERSION, ZBX_JSON_TYPE_STRING);
 	zbx_json_addint64(&j, ZBX_PROTO_TAG_VARIANT, ZBX_PROGRAM_VARIANT_AGENT);
@@ -125,6 +144,16 @@ static int	process_passive_checks_json(zbx_socket_t *s, int config_timeout, stru
 	zbx_json_close(&j);
 
 	zbx_free_agent_result(&result);
+
+	/* keep-alive is negotiated by the requester, never keep connection longer than allowed by configuration */
+	if (SUCCEED == zbx_json_value_by_name(jp, ZBX_PROTO_TAG_KEEP_ALIVE, tmp, sizeof(tmp), NULL) &&
+			SUCCEED == zbx_is_uint31(tmp, keep_alive) && 0 != *keep_alive)
+	{
+		*keep_alive = MIN(*keep_alive, config_timeout);
+		zbx_json_addint64(&j, ZBX_PROTO_TAG_KEEP_ALIVE, *keep_alive);
+	}
+	else
+		*keep_alive = 0;
 fail:
 	if (NULL != error)
 		zbx_json_addstring(&j, ZBX_PROTO_TAG_ERROR, error, ZBX_JSON_TYPE_STRING);
@@ -142,68 +171,208 @@ fail:
 }
 
 
-static void	process_listener(zbx_socket_t *s, int config_timeout)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: processes received passive check request and sends response       *
+ *                                                                            *
+ * Parameters: s              - [IN] socket with received request             *
+ *             config_timeout - [IN]                                          *
+ *             keep_alive     - [OUT] number of seconds to wait for the next  *
+ *                                    request on the same connection, 0 if    *
+ *                                    the connection must be closed           *
+ *                                                                            *
+ * Return value: SUCCEED - response was sent                                  *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	process_request(zbx_socket_t *s, int config_timeout, int *keep_alive)
 {
-	int	ret;
+	struct zbx_json_parse	jp;
+	int			ret = SUCCEED;
 
-	if (SUCCEED == (ret = zbx_tcp_recv_to(s, config_timeout)))
-	{
-		struct zbx_json_parse	jp;
+	*keep_alive = 0;
 
-		zbx_rtrim(s->buffer, "\r\n");
+	zbx_rtrim(s->buffer, "\r\n");
 
-		zabbix_log(LOG_LEVEL_DEBUG, "Requested [%s]", s->buffer);
+	zabbix_log(LOG_LEVEL_DEBUG, "Requested [%s]", s->buffer);
 
-		if (SUCCEED == zbx_json_open(s->buffer, &jp))
+	if (SUCCEED == zbx_json_open(s->buffer, &jp))
+	{
+		ret = process_passive_checks_json(s, config_timeout, &jp, keep_alive);
+	}
+	else
+	{
+		AGENT_RESULT	result;
+		char		**value = NULL;
+
+		zbx_init_agent_result(&result);
+
+		if (SUCCEED == zbx_execute_agent_check(s->buffer, ZBX_PROCESS_WITH_ALIAS, &result, config_timeout))
 		{
-			ret = process_passive_checks_json(s, config_timeout, &jp);
+			if (NULL != (value = ZBX_GET_TEXT_RESULT(&result)))
+			{
+				zabbix_log(LOG_LEVEL_DEBUG, "Sending back [%s]", *value);
+				ret = zbx_tcp_send_to(s, *value, config_timeout);
+			}
 		}
 		else
 		{
-			AGENT_RESULT	result;
-			char		**value = NULL;
+			value = ZBX_GET_MSG_RESULT(&result);
 
-			zbx_init_agent_result(&result);
-
-			if (SUCCEED == zbx_execute_agent_check(s->buffer, ZBX_PROCESS_WITH_ALIAS, &result,
-					config_timeout))
+			if (NULL != value)
 			{
-				if (NULL != (value = ZBX_GET_TEXT_RESULT(&result)))
-				{
-					zabbix_log(LOG_LEVEL_DEBUG, "Sending back [%s]", *value);
-					ret = zbx_tcp_send_to(s, *value, config_timeout);
-				}
+				static char	*buffer = NULL;
+				static size_t	buffer_alloc = 256;
+				size_t		buffer_offset = 0;
+
+				zabbix_log(LOG_LEVEL_DEBUG, "Sending back [" ZBX_NOTSUPPORTED ": %s]", *value);
+
+				if (NULL == buffer)
+					buffer = (char *)zbx_malloc(buffer, buffer_alloc);
+
+				zbx_strncpy_alloc(&buffer, &buffer_alloc, &buffer_offset,
+						ZBX_NOTSUPPORTED, ZBX_CONST_STRLEN(ZBX_NOTSUPPORTED));
+				buffer_offset++;
+				zbx_strcpy_alloc(&buffer, &buffer_alloc, &buffer_offset, *value);
+
+				ret = zbx_tcp_send_bytes_to(s, buffer, buffer_offset, config_timeout);
 			}
 			else
 			{
-				value = ZBX_GET_MSG_RESULT(&result);
+				zabbix_log(LOG_LEVEL_DEBUG, "Sending back [" ZBX_NOTSUPPORTED "]");
+				ret = zbx_tcp_send_to(s, ZBX_NOTSUPPORTED, config_timeout);
+			}
+		}
 
-				if (NULL != value)
-				{
-					static char	*buffer = NULL;
-					static size_t	buffer_alloc = 256;
-					size_t		buffer_offset = 0;
+		zbx_free_agent_result(&result);
+	}
 
-					zabbix_log(LOG_LEVEL_DEBUG, "Sending back [" ZBX_NOTSUPPORTED ": %s]", *value);
+	return ret;
+}
 
-					if (NULL == buffer)
-						buffer = (char *)zbx_malloc(buffer, buffer_alloc);
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if connection is waiting to be accepted                    *
+ *                                                                            *
+ ******************************************************************************/
+static int	accept_is_pending(zbx_socket_t *s)
+{
+	zbx_pollfd_t	pds[ZBX_SOCKET_COUNT];
+	int		i;
 
-					zbx_strncpy_alloc(&buffer, &buffer_alloc, &buffer_offset,
-							ZBX_NOTSUPPORTED, ZBX_CONST_STRLEN(ZBX_NOTSUPPORTED));
-					buffer_offset++;
-					zbx_strcpy_alloc(&buffer, &buffer_alloc, &buffer_offset, *value);
+	for (i = 0; i < s->num_socks; i++)
+	{
+		pds[i].fd = s->sockets[i];
+		pds[i].events = POLLIN;
+	}
 
-					ret = zbx_tcp_send_bytes_to(s, buffer, buffer_offset, config_timeout);
-				}
-				else
-				{
-					zabbix_log(LOG_LEVEL_DEBUG, "Sending back [" ZBX_NOTSUPPORTED "]");
-					ret = zbx_tcp_send_to(s, ZBX_NOTSUPPORTED, config_timeout);
-				}
+	if (0 >= zbx_socket_poll(pds, (unsigned long)s->num_socks, 0))
+		return FAIL;
+
+	for (i = 0; i < s->num_socks; i++)
+	{
+		if (0 != (pds[i].revents & POLLIN))
+			return SUCCEED;
+	}
+
+	return FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: waits for the next request on connection kept alive by requester  *
+ *                                                                            *
+ * Parameters: s           - [IN] accepted socket                             *
+ *             keep_alive  - [IN] number of seconds to wait                   *
+ *             accept_time - [IN/OUT] time when pending connection was        *
+ *                                    noticed, 0 if there was none            *
+ *                                                                            *
+ * Return value: SUCCEED - request data is available                          *
+ *               FAIL    - keep-alive period expired, another connection is   *
+ *                         not accepted by other listeners or poll failed     *
+ *                                                                            *
+ * Comments: Idle listeners accept new connections at once, so connection     *
+ *           still pending after ACCEPT_WAIT means that all listeners are     *
+ *           busy. Only then keep-alive session is ended, so that kept        *
+ *           connections cannot starve other peers.                           *
+ *                                                                            *
+ ******************************************************************************/
+static int	wait_for_request(zbx_socket_t *s, int keep_alive, double *accept_time)
+{
+#define ACCEPT_WAIT	0.1
+	zbx_pollfd_t	pds[ZBX_SOCKET_COUNT + 1];
+	int		i;
+	unsigned long	pds_num;
+	double		now, timeout, deadline;
+
+	pds[0].fd = s->socket;
+	pds[0].events = POLLIN;
+
+	for (i = 0; i < s->num_socks; i++)
+	{
+		pds[i + 1].fd = s->sockets[i];
+		pds[i + 1].events = POLLIN;
+	}
+
+	deadline = zbx_time() + keep_alive;
+
+	while (deadline > (now = zbx_time()))
+	{
+		timeout = deadline - now;
+
+		if (0 != *accept_time)
+		{
+			if (*accept_time + ACCEPT_WAIT <= now)
+			{
+				if (SUCCEED == accept_is_pending(s))
+					return FAIL;
+
+				*accept_time = 0;
 			}
+			else
+				timeout = MIN(timeout, *accept_time + ACCEPT_WAIT - now);
+		}
 
-			zbx_free_agent_result(&result);
+		/* listen sockets stay readable until connection is accepted, so they are not polled while waiting */
+		/* for other listeners to accept it                                                                */
+		pds_num = (0 == *accept_time ? (unsigned long)s->num_socks + 1 : 1);
+
+		if (0 > zbx_socket_poll(pds, pds_num, (int)(timeout * 1000) + 1))
+			return FAIL;
+
+		for (i = 1; i < (int)pds_num; i++)
+		{
+			if (0 != (pds[i].revents & POLLIN))
+			{
+				*accept_time = zbx_time();
+				break;
+			}
+		}
+
+		if (0 != (pds[0].revents & (POLLIN | POLLHUP | POLLERR)))
+			return SUCCEED;
+	}
+
+	return FAIL;
+#undef ACCEPT_WAIT
+}
+
+static void	process_listener(zbx_socket_t *s, int config_timeout)
+{
+	int	ret, keep_alive;
+	double	accept_time = 0;
+
+	if (SUCCEED == (ret = zbx_tcp_recv_to(s, config_timeout)))
+	{
+		ret = process_request(s, config_timeout, &keep_alive);
+
+		/* serve further requests on the same connection while requester keeps it alive, */
+		/* closed connection or idle timeout is normal end of keep-alive session          */
+		while (SUCCEED == ret && 0 != keep_alive && ZBX_IS_RUNNING() &&
+				SUCCEED == wait_for_request(s, keep_alive, &accept_time) &&
+				0 < zbx_tcp_recv_ext(s, config_timeout, 0))
+		{
+			ret = process_request(s, config_timeout, &keep_alive);
 		}
 	}
 
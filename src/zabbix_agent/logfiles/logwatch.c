@@ -0,0 +1,530 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "logwatch.h"
+#include "logfiles.h"
+
+#include "zbxalgo.h"
+#include "zbxstr.h"
+#include "zbx_item_constants.h"
+
+#ifdef HAVE_SYS_INOTIFY_H
+#include <sys/inotify.h>
+
+/* events which may indicate new data in log file or log file rotation, our own reading generates none of them */
+#define ZBX_LOG_WATCH_MASK	(IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_DELETE_SELF | \
+		IN_MOVE_SELF | IN_MOVED_FROM | IN_MOVED_TO)
+
+/* inotify watch, shared by all items watching the same directory or file */
+typedef struct
+{
+	int		wd;
+	int		refcount;
+	int		removed;	/* 1 - watch was removed by kernel (watched object deleted or unmounted) */
+	zbx_uint64_t	events;		/* number of events received for the watch */
+}
+zbx_log_watch_t;
+
+/* watches of log[] or logrt[] item */
+typedef struct
+{
+	zbx_uint64_t		itemid;
+	zbx_vector_int32_t	wds;	/* watches of log file directories and of symbolic links to log files */
+	char			*paths;	/* log file directories and log files the watches were added for */
+	zbx_uint64_t		events;	/* number of watch events before the last check was started */
+	int			valid;	/* 1 - the last check processed all log file data with watches in place */
+}
+zbx_log_watch_item_t;
+
+static int		inotify_fd = -1;
+static zbx_hashset_t	log_watches;
+static zbx_hashset_t	log_watch_items;
+
+static zbx_hash_t	log_watch_hash(const void *data)
+{
+	const zbx_log_watch_t	*watch = (const zbx_log_watch_t *)data;
+
+	return ZBX_DEFAULT_HASH_ALGO(&watch->wd, sizeof(watch->wd), ZBX_DEFAULT_HASH_SEED);
+}
+
+static int	log_watch_compare(const void *d1, const void *d2)
+{
+	const zbx_log_watch_t	*w1 = (const zbx_log_watch_t *)d1;
+	const zbx_log_watch_t	*w2 = (const zbx_log_watch_t *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(w1->wd, w2->wd);
+
+	return 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: counts pending inotify events per watch                           *
+ *                                                                            *
+ ******************************************************************************/
+static void	log_watch_read_events(void)
+{
+	union
+	{
+		struct inotify_event	event;
+		char			buf[4 * ZBX_KIBIBYTE];
+	}
+	events;
+
+	for (;;)
+	{
+		ssize_t		n;
+		const char	*p;
+
+		if (-1 == (n = read(inotify_fd, events.buf, sizeof(events.buf))))
+		{
+			if (EINTR == errno)
+				continue;
+
+			if (EAGAIN != errno)
+				zabbix_log(LOG_LEVEL_DEBUG, "cannot read inotify events: %s", zbx_strerror(errno));
+
+			break;
+		}
+
+		for (p = events.buf; p < events.buf + n;)
+		{
+			const struct inotify_event	*event = (const struct inotify_event *)p;
+			zbx_log_watch_t			*watch, watch_local;
+
+			p += sizeof(struct inotify_event) + event->len;
+
+			if (0 != (IN_Q_OVERFLOW & event->mask))
+			{
+				zbx_hashset_iter_t	iter;
+
+				/* events were lost, treat every watch as changed */
+				zbx_hashset_iter_reset(&log_watches, &iter);
+
+				while (NULL != (watch = (zbx_log_watch_t *)zbx_hashset_iter_next(&iter)))
+					watch->events++;
+
+				continue;
+			}
+
+			watch_local.wd = event->wd;
+
+			if (NULL == (watch = (zbx_log_watch_t *)zbx_hashset_search(&log_watches, &watch_local)))
+				continue;
+
+			watch->events++;
+
+			if (0 != (IN_IGNORED & event->mask))
+				watch->removed = 1;
+		}
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds inotify watch or references existing one                     *
+ *                                                                            *
+ * Parameters: path - [IN] directory or file to watch                         *
+ *             wds  - [OUT] watch descriptors of item                         *
+ *                                                                            *
+ * Return value: SUCCEED - watch was added                                    *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	log_watch_add(const char *path, zbx_vector_int32_t *wds)
+{
+	zbx_log_watch_t	*watch, watch_local;
+
+	if (-1 == (watch_local.wd = inotify_add_watch(inotify_fd, path, ZBX_LOG_WATCH_MASK)))
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "cannot add inotify watch for \"%s\": %s", path, zbx_strerror(errno));
+		return FAIL;
+	}
+
+	if (NULL == (watch = (zbx_log_watch_t *)zbx_hashset_search(&log_watches, &watch_local)))
+	{
+		watch_local.refcount = 0;
+		watch_local.removed = 0;
+		watch_local.events = 0;
+
+		watch = (zbx_log_watch_t *)zbx_hashset_insert(&log_watches, &watch_local, sizeof(watch_local));
+	}
+	else
+		watch->removed = 0;	/* watch descriptor of removed watch was reused by kernel */
+
+	watch->refcount++;
+	zbx_vector_int32_append(wds, watch->wd);
+
+	return SUCCEED;
+}
+
+static void	log_watch_release(zbx_vector_int32_t *wds)
+{
+	for (int i = 0; i < wds->values_num; i++)
+	{
+		zbx_log_watch_t	*watch, watch_local;
+
+		watch_local.wd = wds->values[i];
+
+		if (NULL == (watch = (zbx_log_watch_t *)zbx_hashset_search(&log_watches, &watch_local)))
+			continue;
+
+		if (0 != --watch->refcount)
+			continue;
+
+		if (0 == watch->removed)
+			inotify_rm_watch(inotify_fd, watch->wd);
+
+		zbx_hashset_remove_direct(&log_watches, watch);
+	}
+
+	zbx_vector_int32_clear(wds);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sums up events of item watches                                    *
+ *                                                                            *
+ * Parameters: item   - [IN]                                                  *
+ *             events - [OUT] number of events received for item watches      *
+ *                                                                            *
+ * Return value: SUCCEED - all item watches are in place                      *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	log_watch_item_events(const zbx_log_watch_item_t *item, zbx_uint64_t *events)
+{
+	*events = 0;
+
+	for (int i = 0; i < item->wds.values_num; i++)
+	{
+		zbx_log_watch_t	*watch, watch_local;
+
+		watch_local.wd = item->wds.values[i];
+
+		if (NULL == (watch = (zbx_log_watch_t *)zbx_hashset_search(&log_watches, &watch_local)) ||
+				0 != watch->removed)
+		{
+			return FAIL;
+		}
+
+		*events += watch->events;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: lists log file directories and log files of item                  *
+ *                                                                            *
+ * Parameters: metric - [IN]                                                  *
+ *             paths  - [OUT] paths separated by newline                      *
+ *                                                                            *
+ ******************************************************************************/
+static void	log_watch_make_paths(const zbx_active_metric_t *metric, char **paths)
+{
+	size_t		paths_alloc = 0, paths_offset = 0, dir_len = 0;
+	const char	*dir = NULL;
+
+	for (int i = 0; i < metric->logfiles_num; i++)
+	{
+		const char	*filename = metric->logfiles[i].filename, *sep;
+		size_t		len;
+
+		if (NULL == (sep = strrchr(filename, '/')))
+			continue;
+
+		len = (size_t)(sep - filename + 1);
+
+		/* log files of logrt[] item share directory, list it only once */
+		if (NULL != dir && len == dir_len && 0 == strncmp(filename, dir, len))
+			continue;
+
+		zbx_strncpy_alloc(paths, &paths_alloc, &paths_offset, filename, len);
+		zbx_chrcpy_alloc(paths, &paths_alloc, &paths_offset, '\n');
+
+		dir = filename;
+		dir_len = len;
+	}
+
+	for (int i = 0; i < metric->logfiles_num; i++)
+	{
+		zbx_strcpy_alloc(paths, &paths_alloc, &paths_offset, metric->logfiles[i].filename);
+		zbx_chrcpy_alloc(paths, &paths_alloc, &paths_offset, '\n');
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: replaces item watches with watches for specified paths            *
+ *                                                                            *
+ * Parameters: item  - [IN/OUT]                                               *
+ *             paths - [IN] log file directories and log files separated by   *
+ *                          newline, directories end with '/'                 *
+ *                                                                            *
+ * Comments: Directory watch reports writes to files in directory but not     *
+ *           writes to files symbolic links in directory point to, therefore  *
+ *           symbolic links are watched separately.                           *
+ *                                                                            *
+ ******************************************************************************/
+static void	log_watch_item_register(zbx_log_watch_item_t *item, char *paths)
+{
+	zbx_vector_int32_t	wds;
+	char			*path, *next;
+
+	zbx_vector_int32_create(&wds);
+
+	for (path = paths; '\0' != *path; path = next + 1)
+	{
+		struct stat	st;
+		int		ret;
+
+		next = strchr(path, '\n');
+		*next = '\0';
+
+		if ('/' == *(next - 1) || (0 == lstat(path, &st) && S_ISLNK(st.st_mode)))
+			ret = log_watch_add(path, &wds);
+		else
+			ret = SUCCEED;
+
+		*next = '\n';
+
+		if (SUCCEED != ret)
+		{
+			log_watch_release(&wds);
+			zbx_free(paths);
+			break;
+		}
+	}
+
+	log_watch_release(&item->wds);
+	zbx_vector_int32_destroy(&item->wds);
+	item->wds = wds;
+
+	zbx_free(item->paths);
+	item->paths = paths;
+}
+
+static void	log_watch_item_clean(zbx_log_watch_item_t *item)
+{
+	log_watch_release(&item->wds);
+	zbx_vector_int32_destroy(&item->wds);
+	zbx_free(item->paths);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks whether item state allows to skip check                    *
+ *                                                                            *
+ ******************************************************************************/
+static int	log_watch_applicable(const zbx_active_metric_t *metric)
+{
+	/* log.count[] and logrt.count[] items send match count on every check */
+	if (0 != ((ZBX_METRIC_FLAG_LOG_COUNT | ZBX_METRIC_FLAG_NEW) & metric->flags) ||
+			0 == ((ZBX_METRIC_FLAG_LOG_LOG | ZBX_METRIC_FLAG_LOG_LOGRT) & metric->flags))
+	{
+		return FAIL;
+	}
+
+	if (ITEM_STATE_NORMAL != metric->state || 0 != metric->error_count || 0 == metric->logfiles_num)
+		return FAIL;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: initializes inotify based detection of log file changes           *
+ *                                                                            *
+ * Parameters: error - [OUT] error message                                    *
+ *                                                                            *
+ * Return value: SUCCEED - log file changes will be watched                   *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_log_watch_init(char **error)
+{
+	if (-1 == (inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC)))
+	{
+		*error = zbx_dsprintf(*error, "cannot initialize inotify: %s", zbx_strerror(errno));
+		return FAIL;
+	}
+
+	zbx_hashset_create(&log_watches, 100, log_watch_hash, log_watch_compare);
+	zbx_hashset_create(&log_watch_items, 100, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	return SUCCEED;
+}
+
+void	zbx_log_watch_destroy(void)
+{
+	zbx_hashset_iter_t	iter;
+	zbx_log_watch_item_t	*item;
+
+	if (-1 == inotify_fd)
+		return;
+
+	zbx_hashset_iter_reset(&log_watch_items, &iter);
+
+	while (NULL != (item = (zbx_log_watch_item_t *)zbx_hashset_iter_next(&iter)))
+		log_watch_item_clean(item);
+
+	zbx_hashset_destroy(&log_watch_items);
+	zbx_hashset_destroy(&log_watches);
+
+	close(inotify_fd);
+	inotify_fd = -1;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks whether log[] or logrt[] item check can be skipped         *
+ *                                                                            *
+ * Parameters: metric - [IN]                                                  *
+ *                                                                            *
+ * Return value: SUCCEED - no log file or log file directory of item changed  *
+ *                         since the previous check, which processed all data *
+ *               FAIL    - item must be checked                               *
+ *                                                                            *
+ * Comments: Skipped check would neither find new records nor change item     *
+ *           state, so persistent files and meta information stay untouched.  *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_log_watch_unchanged(const zbx_active_metric_t *metric)
+{
+	zbx_log_watch_item_t	*item;
+	zbx_uint64_t		events;
+	int			ret = FAIL;
+
+	if (-1 == inotify_fd)
+		return FAIL;
+
+	log_watch_read_events();
+
+	if (NULL == (item = (zbx_log_watch_item_t *)zbx_hashset_search(&log_watch_items, &metric->itemid)))
+		return FAIL;
+
+	if (SUCCEED != log_watch_item_events(item, &events))
+	{
+		item->valid = 0;
+		return FAIL;
+	}
+
+	if (1 == item->valid && events == item->events && SUCCEED == log_watch_applicable(metric))
+		ret = SUCCEED;
+
+	/* events arriving from now on are counted towards the next check */
+	item->events = events;
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: updates item watches after log[] or logrt[] item check            *
+ *                                                                            *
+ * Parameters: metric - [IN]                                                  *
+ *             ret    - [IN] result of item check                             *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_log_watch_update(const zbx_active_metric_t *metric, int ret)
+{
+	zbx_log_watch_item_t	*item;
+	char			*paths = NULL;
+	zbx_uint64_t		events;
+
+	if (-1 == inotify_fd || 0 != (ZBX_METRIC_FLAG_LOG_COUNT & metric->flags))
+		return;
+
+	if (NULL == (item = (zbx_log_watch_item_t *)zbx_hashset_search(&log_watch_items, &metric->itemid)))
+	{
+		zbx_log_watch_item_t	item_local = {.itemid = metric->itemid};
+
+		item = (zbx_log_watch_item_t *)zbx_hashset_insert(&log_watch_items, &item_local, sizeof(item_local));
+		zbx_vector_int32_create(&item->wds);
+	}
+
+	item->valid = 0;
+
+	if (SUCCEED != ret || 0 == metric->logfiles_num)
+		return;
+
+	log_watch_make_paths(metric, &paths);
+
+	if (NULL == item->paths || 0 != strcmp(item->paths, paths) || SUCCEED != log_watch_item_events(item, &events))
+	{
+		/* the check was done without watches for current log files, do not rely on them until next check */
+		log_watch_item_register(item, paths);
+		return;
+	}
+
+	zbx_free(paths);
+
+	if (0 != metric->error_count)
+		return;
+
+	for (int i = 0; i < metric->logfiles_num; i++)
+	{
+		/* more data left to process or read error is to be retried */
+		if (metric->logfiles[i].processed_size < metric->logfiles[i].size || 0 != metric->logfiles[i].retry)
+			return;
+	}
+
+	item->valid = 1;
+}
+
+void	zbx_log_watch_remove(zbx_uint64_t itemid)
+{
+	zbx_log_watch_item_t	*item;
+
+	if (-1 == inotify_fd)
+		return;
+
+	if (NULL == (item = (zbx_log_watch_item_t *)zbx_hashset_search(&log_watch_items, &itemid)))
+		return;
+
+	log_watch_item_clean(item);
+	zbx_hashset_remove_direct(&log_watch_items, item);
+}
+#else
+int	zbx_log_watch_init(char **error)
+{
+	*error = zbx_strdup(*error, "inotify is not supported on this platform");
+
+	return FAIL;
+}
+
+void	zbx_log_watch_destroy(void)
+{
+}
+
+int	zbx_log_watch_unchanged(const zbx_active_metric_t *metric)
+{
+	ZBX_UNUSED(metric);
+
+	return FAIL;
+}
+
+void	zbx_log_watch_update(const zbx_active_metric_t *metric, int ret)
+{
+	ZBX_UNUSED(metric);
+	ZBX_UNUSED(ret);
+}
+
+void	zbx_log_watch_remove(zbx_uint64_t itemid)
+{
+	ZBX_UNUSED(itemid);
+}
+#endif
@@ -0,0 +1,26 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#ifndef ZABBIX_LOGWATCH_H
+#define ZABBIX_LOGWATCH_H
+
+#include "../metrics/metrics.h"
+
+int	zbx_log_watch_init(char **error);
+void	zbx_log_watch_destroy(void);
+int	zbx_log_watch_unchanged(const zbx_active_metric_t *metric);
+void	zbx_log_watch_update(const zbx_active_metric_t *metric, int ret);
+void	zbx_log_watch_remove(zbx_uint64_t itemid);
+
+#endif
@@ -59,6 +59,8 @@ typedef struct
 	char			*persistent_file_name;	/* not used on Microsoft Windows */
 
 	int			timeout;
+	unsigned char		in_progress;	/* 1 - metric is being checked by active checks worker or */
+						/*     log check thread                                   */
 }
 zbx_active_metric_t;
 
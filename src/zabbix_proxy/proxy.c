@@ -186,6 +186,7 @@ ZBX_GET_CONFIG_VAR2(char *, const char *, zbx_config_pid_file, NULL)
 ZBX_GET_CONFIG_VAR2(char *, const char *, zbx_config_tmpdir, NULL)
 ZBX_GET_CONFIG_VAR2(char *, const char *, zbx_config_fping_location, NULL)
 ZBX_GET_CONFIG_VAR2(char *, const char *, zbx_config_fping6_location, NULL)
+ZBX_GET_CONFIG_VAR(int, zbx_config_native_ping, 0)
 
 static int	config_proxymode		= ZBX_PROXYMODE_ACTIVE;
 static sigset_t	orig_mask;
@@ -274,12 +275,15 @@ static int	config_vmware_timeout		= 10;
 static zbx_uint64_t	config_conf_cache_size		= 8 * ZBX_MEBIBYTE;
 static zbx_uint64_t	config_history_cache_size	= 16 * ZBX_MEBIBYTE;
 static zbx_uint64_t	config_history_index_cache_size	= 4 * ZBX_MEBIBYTE;
+static int		config_history_cache_shards	= 1;
+static zbx_uint64_t	config_preproc_buffer_size	= 0;
 static zbx_uint64_t	config_trends_cache_size	= 0;
 static zbx_uint64_t	config_vmware_cache_size	= 8 * ZBX_MEBIBYTE;
 
 static int	config_unreachable_period		= 45;
 static int	config_unreachable_delay		= 15;
 static int	config_max_concurrent_checks_per_poller	= 1000;
+static int	config_agent_keep_alive			= 0;
 
 static int	config_log_level		= LOG_LEVEL_WARNING;
 
@@ -341,7 +345,8 @@ static const zbx_events_funcs_t	events_cbs = {
 	.clean_events_cb		= NULL,
 	.reset_event_recovery_cb	= NULL,
 	.export_events_cb		= NULL,
-	.events_update_itservices_cb	= NULL
+	.events_update_itservices_cb	= NULL,
+	.events_update_problem_index_cb	= NULL
 };
 
 typedef struct
@@ -818,6 +823,13 @@ static void	zbx_validate_config(ZBX_TASK_EX *task)
 		}
 	}
 
+	if (0 != config_preproc_buffer_size && 128 * ZBX_KIBIBYTE > config_preproc_buffer_size)
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "\"PreprocessingBufferSize\" configuration parameter must be either 0"
+				" or greater than 128KB");
+		err = 1;
+	}
+
 	err |= (FAIL == zbx_db_validate_config_features(zbx_program_type, zbx_config_dbhigh));
 
 	if (0 != err)
@@ -897,6 +909,8 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 				ZBX_CONF_PARM_OPT,	128 * ZBX_KIBIBYTE,	__UINT64_C(2) * ZBX_GIBIBYTE},
 		{"HistoryIndexCacheSize",	&config_history_index_cache_size,	ZBX_CFG_TYPE_UINT64,
 				ZBX_CONF_PARM_OPT,	128 * ZBX_KIBIBYTE,	__UINT64_C(2) * ZBX_GIBIBYTE},
+		{"HistoryCacheShards",		&config_history_cache_shards,		ZBX_CFG_TYPE_INT,
+				ZBX_CONF_PARM_OPT,	1,			ZBX_HC_SHARDS_MAX},
 		{"HousekeepingFrequency",	&config_housekeeping_frequency,		ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	0,			24},
 		{"ProxyLocalBuffer",		&config_proxy_local_buffer,		ZBX_CFG_TYPE_INT,
@@ -917,6 +931,8 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 				ZBX_CONF_PARM_OPT,	0,			0},
 		{"Fping6Location",		&zbx_config_fping6_location,		ZBX_CFG_TYPE_STRING,
 				ZBX_CONF_PARM_OPT,	0,			0},
+		{"NativePing",			&zbx_config_native_ping,		ZBX_CFG_TYPE_INT,
+				ZBX_CONF_PARM_OPT,	0,			1},
 		{"Timeout",			&zbx_config_timeout,			ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	1,			30},
 		{"TrapperTimeout",		&zbx_config_trapper_timeout,		ZBX_CFG_TYPE_INT,
@@ -974,6 +990,9 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 				ZBX_CONF_PARM_OPT,	0,			0},
 		{"DBPort",			&(zbx_config_dbhigh->config_dbport),	ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	1024,			65535},
+		{"DBPreparedStatements",	&(zbx_config_dbhigh->config_db_prepared_statements),
+											ZBX_CFG_TYPE_INT,
+				ZBX_CONF_PARM_OPT,	0,			1},
 		{"AllowUnsupportedDBVersions",	&config_allow_unsupported_db_versions,	ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	0,			1},
 		{"DBTLSConnect",		&(zbx_config_dbhigh->config_db_tls_connect),
@@ -1065,6 +1084,8 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 		{"StartPreprocessors",		&config_forks[ZBX_PROCESS_TYPE_PREPROCESSOR],
 											ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	1,			1000},
+		{"PreprocessingBufferSize",	&config_preproc_buffer_size,		ZBX_CFG_TYPE_UINT64,
+				ZBX_CONF_PARM_OPT,	0,			__UINT64_C(2) * ZBX_GIBIBYTE},
 		{"ListenBacklog",		&config_tcp_max_backlog_size,		ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	0,			INT_MAX},
 		{"StartODBCPollers",		&config_forks[ZBX_PROCESS_TYPE_ODBCPOLLER],
@@ -1089,6 +1110,8 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 						&config_max_concurrent_checks_per_poller,
 											ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	1,			1000},
+		{"AgentKeepAlive",		&config_agent_keep_alive,		ZBX_CFG_TYPE_INT,
+				ZBX_CONF_PARM_OPT,	0,			30},
 		{"StartBrowserPollers",		&config_forks[ZBX_PROCESS_TYPE_BROWSERPOLLER],	ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	0,			1000},
 		{"WebDriverURL",		&config_webdriver_url,			ZBX_CFG_TYPE_STRING,
@@ -1174,6 +1197,8 @@ static void	zbx_on_exit(int ret, void *on_exit_args)
 	/* free vmware support */
 	zbx_vmware_destroy();
 
+	zbx_pp_buffer_destroy();
+
 	zbx_free_selfmon_collector();
 	free_proxy_history_lock(zbx_program_type);
 
@@ -1217,7 +1242,8 @@ int	main(int argc, char **argv)
 		get_zbx_config_fping_location,
 		get_zbx_config_fping6_location,
 		get_zbx_config_tmpdir,
-		get_zbx_progname};
+		get_zbx_progname,
+		get_zbx_config_native_ping};
 
 	ZBX_TASK_EX			t = {ZBX_TASK_START, 0, 0, NULL};
 	char				ch;
@@ -1469,7 +1495,8 @@ int	MAIN_ZABBIX_ENTRY(int flags)
 								config_unavailable_delay, config_unreachable_period,
 								config_unreachable_delay,
 								config_max_concurrent_checks_per_poller,
-								get_config_forks, config_java_gateway,
+								config_agent_keep_alive, get_config_forks,
+								config_java_gateway,
 								config_java_gateway_port, config_externalscripts,
 								zbx_get_value_internal_ext_proxy,
 								config_ssh_key_location, config_webdriver_url};
@@ -1526,7 +1553,8 @@ int	MAIN_ZABBIX_ENTRY(int flags)
 							.config_timeout = zbx_config_timeout,
 							zbx_config_source_ip};
 	zbx_thread_dbsyncer_args		dbsyncer_args = {&events_cbs, config_histsyncer_frequency,
-								zbx_config_timeout, config_history_storage_pipelines};
+								zbx_config_timeout, config_history_storage_pipelines,
+								get_config_forks};
 	zbx_thread_vmware_args			vmware_args = {zbx_config_source_ip, config_vmware_frequency,
 								config_vmware_perf_frequency, config_vmware_timeout};
 	zbx_thread_snmptrapper_args		snmptrapper_args = {.config_snmptrap_file = zbx_config_snmptrap_file,
@@ -1655,7 +1683,8 @@ int	MAIN_ZABBIX_ENTRY(int flags)
 	zbx_unblock_signals(&orig_mask);
 
 	if (SUCCEED != zbx_init_database_cache(get_zbx_program_type, zbx_sync_proxy_history, config_history_cache_size,
-			config_history_index_cache_size, &config_trends_cache_size, &error))
+			config_history_index_cache_size, config_history_cache_shards, &config_trends_cache_size, 0,
+			&error))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize database cache: %s", error);
 		zbx_free(error);
@@ -1714,6 +1743,13 @@ int	MAIN_ZABBIX_ENTRY(int flags)
 		exit(EXIT_FAILURE);
 	}
 
+	if (SUCCEED != zbx_pp_buffer_init(config_preproc_buffer_size, &error))
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize preprocessing buffer: %s", error);
+		zbx_free(error);
+		exit(EXIT_FAILURE);
+	}
+
 	if (FAIL == zbx_pb_create(config_proxy_buffer_mode, config_proxy_memory_buffer_size,
 			config_proxy_memory_buffer_age, config_proxy_offline_buffer * SEC_PER_HOUR, &error))
 	{
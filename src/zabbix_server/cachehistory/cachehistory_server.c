@@ -64,6 +64,65 @@ static void	DBmass_update_trends(const ZBX_DC_TREND *trends, int trends_num,
 	}
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: writes pending trends due by trend flush period when there are no *
+ *          history values to sync                                            *
+ *                                                                            *
+ * Parameters: connector_filters - [IN] history connector filters            *
+ *             data              - [IN/OUT] export data buffer                *
+ *             data_alloc        - [IN/OUT] export data buffer size           *
+ *                                                                            *
+ ******************************************************************************/
+static void	sync_server_due_trends(zbx_vector_connector_filter_t *connector_filters, unsigned char **data,
+		size_t *data_alloc)
+{
+	ZBX_DC_TREND			*trends = NULL;
+	int				trends_num = 0, txn_error;
+	zbx_vector_uint64_pair_t	trends_diff;
+
+	zbx_dc_get_due_trends(&trends, &trends_num);
+
+	if (0 == trends_num)
+		return;
+
+	zbx_vector_uint64_pair_create(&trends_diff);
+
+	zbx_tfc_invalidate_trends(trends, trends_num);
+
+	do
+	{
+		zbx_db_begin();
+
+		DBmass_update_trends(trends, trends_num, &trends_diff);
+
+		if (ZBX_DB_OK == (txn_error = zbx_db_commit()))
+			zbx_dc_update_trends(&trends_diff);
+
+		zbx_vector_uint64_pair_clear(&trends_diff);
+	}
+	while (ZBX_DB_DOWN == txn_error);
+
+	if (SUCCEED == zbx_is_export_enabled(ZBX_FLAG_EXPTYPE_TRENDS))
+	{
+		zbx_vector_uint64_t	itemids;
+		size_t			data_offset = 0;
+
+		zbx_vector_uint64_create(&itemids);
+
+		zbx_dc_export_history_and_trends(NULL, 0, &itemids, NULL, NULL, trends, trends_num, FAIL,
+				connector_filters, data, data_alloc, &data_offset);
+
+		if (0 != data_offset)
+			zbx_connector_send(ZBX_IPC_CONNECTOR_REQUEST, *data, (zbx_uint32_t)data_offset);
+
+		zbx_vector_uint64_destroy(&itemids);
+	}
+
+	zbx_vector_uint64_pair_destroy(&trends_diff);
+	zbx_free(trends);
+}
+
 /******************************************************************************
  *                                                                            *
  * Comments: helper function for process_triggers()                           *
@@ -1311,6 +1370,9 @@ void	zbx_sync_server_history(int *values_num, int *triggers_num, const zbx_event
 
 	item_retrieve_mode = 0 == zbx_has_export_dir() ? ZBX_ITEM_GET_SYNC : ZBX_ITEM_GET_SYNC_EXPORT;
 
+	/* send statements of history, trends, item and trigger update transactions without waiting for each result */
+	zbx_db_batch_begin();
+
 	do
 	{
 		int			trends_num = 0, timers_num = 0, ret = SUCCEED;
@@ -1318,18 +1380,14 @@ void	zbx_sync_server_history(int *values_num, int *triggers_num, const zbx_event
 
 		*more = ZBX_SYNC_DONE;
 
-		zbx_dbcache_lock();
 		zbx_hc_pop_items(&history_items);		/* select and take items out of history cache */
-		zbx_dbcache_unlock();
 
 		if (0 != history_items.values_num)
 		{
 			if (0 == (history_num = zbx_dc_config_lock_triggers_by_history_items(&history_items,
 					&triggerids)))
 			{
-				zbx_dbcache_lock();
 				zbx_hc_push_items(&history_items);
-				zbx_dbcache_unlock();
 				zbx_vector_hc_item_ptr_clear(&history_items);
 			}
 		}
@@ -1427,6 +1485,8 @@ void	zbx_sync_server_history(int *values_num, int *triggers_num, const zbx_event
 			zbx_vector_inventory_value_ptr_clear_ext(&inventory_values, DCinventory_value_free);
 			zbx_vector_item_diff_ptr_clear_ext(&item_diff, zbx_item_diff_free);
 		}
+		else
+			sync_server_due_trends(&connector_filters_history, &data, &data_alloc);
 
 		if (FAIL != ret)
 		{
@@ -1494,8 +1554,14 @@ void	zbx_sync_server_history(int *values_num, int *triggers_num, const zbx_event
 				}
 				while (ZBX_DB_DOWN == txn_error);
 
-				if (ZBX_DB_OK == txn_error && NULL != events_cbs->events_update_itservices_cb)
-					events_cbs->events_update_itservices_cb();
+				if (ZBX_DB_OK == txn_error)
+				{
+					if (NULL != events_cbs->events_update_problem_index_cb)
+						events_cbs->events_update_problem_index_cb();
+
+					if (NULL != events_cbs->events_update_itservices_cb)
+						events_cbs->events_update_itservices_cb();
+				}
 			}
 		}
 
@@ -1521,9 +1587,7 @@ void	zbx_sync_server_history(int *values_num, int *triggers_num, const zbx_event
 
 		if (0 != history_num)
 		{
-			zbx_dbcache_lock();
 			zbx_hc_push_items(&history_items);	/* return items to history cache */
-			zbx_dbcache_set_history_num(zbx_dbcache_get_history_num() - history_num);
 
 			if (0 != zbx_hc_queue_get_size())
 			{
@@ -1536,8 +1600,6 @@ void	zbx_sync_server_history(int *values_num, int *triggers_num, const zbx_event
 					*more = ZBX_SYNC_MORE;
 			}
 
-			zbx_dbcache_unlock();
-
 			*values_num += history_num;
 		}
 
@@ -1647,6 +1709,8 @@ void	zbx_sync_server_history(int *values_num, int *triggers_num, const zbx_event
 	}
 	while (ZBX_SYNC_MORE == *more && ZBX_HC_SYNC_TIME_MAX >= time(NULL) - sync_start);
 
+	zbx_db_batch_end();
+
 	zbx_free(items);
 	zbx_free(errcodes);
 	zbx_free(data);
@@ -1691,8 +1755,7 @@ int	zbx_hc_check_proxy(zbx_uint64_t proxyid)
 
 	zbx_dbcache_lock();
 
-	hc_pused = 100 * (double)(zbx_dbcache_get_hc_mem()->total_size - zbx_dbcache_get_hc_mem()->free_size) /
-			zbx_dbcache_get_hc_mem()->total_size;
+	hc_pused = zbx_dbcache_get_hc_pused();
 
 	if (20 >= hc_pused)
 	{
@@ -27,5 +27,6 @@ int	zbx_hc_check_proxy(zbx_uint64_t proxyid);
 
 void	zbx_evaluate_expressions(zbx_vector_dc_trigger_t *triggers, const zbx_vector_uint64_t *history_itemids,
 		const zbx_history_sync_item_t *history_items, const int *history_errcodes);
+void	zbx_set_trigger_eval_threads(int threads_num);
 
 #endif
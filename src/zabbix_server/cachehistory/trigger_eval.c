@@ -28,6 +28,7 @@
 #include "zbxeval.h"
 #include "zbxdbhigh.h"
 #include "zbxalgo.h"
+#include "zbxthreads.h"
 
 static void	extract_functionids(zbx_vector_uint64_t *functionids, zbx_vector_dc_trigger_t *triggers)
 {
@@ -520,12 +521,15 @@ empty:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
-static int	evaluate_expression(zbx_eval_context_t *ctx, const zbx_timespec_t *ts, double *result,
-		char **error)
+static int	evaluate_expression(zbx_eval_context_t *ctx, const zbx_eval_code_t *code, const zbx_timespec_t *ts,
+		double *result, char **error)
 {
 	zbx_variant_t	 value;
 
-	if (SUCCEED != zbx_eval_execute(ctx, ts, &value, error))
+	/* compiled code handles only numeric values, anything else is left for the interpreter */
+	if (NULL != code && SUCCEED == zbx_eval_execute_code(ctx, code, result))
+		zbx_variant_set_dbl(&value, *result);
+	else if (SUCCEED != zbx_eval_execute(ctx, ts, &value, error))
 		return FAIL;
 
 	if (SUCCEED == ZBX_CHECK_LOG_LEVEL(LOG_LEVEL_DEBUG))
@@ -595,6 +599,326 @@ static int	dc_item_compare_by_itemid(const void *d1, const void *d2)
 	return 0;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculates new trigger value based on its recovery mode and       *
+ *          expression evaluation                                             *
+ *                                                                            *
+ * Comments: Only the trigger itself is changed, so triggers can be           *
+ *           evaluated in parallel.                                           *
+ *                                                                            *
+ ******************************************************************************/
+static void	evaluate_trigger(zbx_dc_trigger_t *tr)
+{
+	double	expr_result;
+
+	if (NULL != tr->new_error)
+		return;
+
+	if (SUCCEED != evaluate_expression(tr->eval_ctx, tr->expression_code, &tr->timespec, &expr_result,
+			&tr->new_error))
+	{
+		return;
+	}
+
+	/* trigger expression evaluates to true, set PROBLEM value */
+	if (SUCCEED != zbx_double_compare(expr_result, 0.0))
+	{
+		if (0 == (tr->flags & ZBX_DC_TRIGGER_PROBLEM_EXPRESSION))
+		{
+			/* trigger value should remain unchanged and no PROBLEM events should be generated if */
+			/* problem expression evaluates to true, but trigger recalculation was initiated by a */
+			/* time-based function or a new value of an item in recovery expression */
+			tr->new_value = TRIGGER_VALUE_NONE;
+		}
+		else
+			tr->new_value = TRIGGER_VALUE_PROBLEM;
+
+		return;
+	}
+
+	/* otherwise try to recover trigger by setting OK value */
+	if (TRIGGER_VALUE_PROBLEM == tr->value && TRIGGER_RECOVERY_MODE_NONE != tr->recovery_mode)
+	{
+		if (TRIGGER_RECOVERY_MODE_EXPRESSION == tr->recovery_mode)
+		{
+			tr->new_value = TRIGGER_VALUE_OK;
+			return;
+		}
+
+		/* processing recovery expression mode */
+		if (SUCCEED != evaluate_expression(tr->eval_ctx_r, tr->recovery_expression_code, &tr->timespec,
+				&expr_result, &tr->new_error))
+		{
+			tr->new_value = TRIGGER_VALUE_UNKNOWN;
+			return;
+		}
+
+		if (SUCCEED != zbx_double_compare(expr_result, 0.0))
+		{
+			tr->new_value = TRIGGER_VALUE_OK;
+			return;
+		}
+	}
+
+	/* no changes, keep the old value */
+	tr->new_value = TRIGGER_VALUE_NONE;
+}
+
+/* the number of triggers taken by evaluation thread at once */
+#define TRIGGER_EVAL_BATCH_SIZE	64
+
+/* helper threads evaluating triggers together with the calling thread, created once per process */
+typedef struct
+{
+	pthread_t		*threads;
+	int			threads_num;
+
+	pthread_mutex_t		lock;
+	pthread_cond_t		cond_start;
+	pthread_cond_t		cond_done;
+
+	/* the triggers being evaluated, NULL when there is no evaluation in progress */
+	zbx_vector_dc_trigger_t	*triggers;
+	int			next;
+
+	/* the evaluation sequence number, increased when new triggers are posted */
+	zbx_uint64_t		job;
+
+	/* the number of helper threads taking part in the current evaluation */
+	int			active;
+}
+trigger_eval_pool_t;
+
+static int			trigger_eval_threads_num = 1;
+static trigger_eval_pool_t	*trigger_eval_pool = NULL;
+static int			trigger_eval_pool_failed = 0;
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sets the number of threads used to evaluate trigger expressions   *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_set_trigger_eval_threads(int threads_num)
+{
+	trigger_eval_threads_num = threads_num;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: evaluates trigger batches of the current evaluation until all     *
+ *          triggers are taken                                                *
+ *                                                                            *
+ ******************************************************************************/
+static void	trigger_eval_run(trigger_eval_pool_t *pool)
+{
+	zbx_vector_dc_trigger_t	*triggers;
+	int			i, start, end;
+
+	while (1)
+	{
+		pthread_mutex_lock(&pool->lock);
+
+		if (NULL == (triggers = pool->triggers) || pool->next >= triggers->values_num)
+		{
+			pthread_mutex_unlock(&pool->lock);
+			break;
+		}
+
+		start = pool->next;
+		pool->next += TRIGGER_EVAL_BATCH_SIZE;
+		pthread_mutex_unlock(&pool->lock);
+
+		end = MIN(start + TRIGGER_EVAL_BATCH_SIZE, triggers->values_num);
+
+		for (i = start; i < end; i++)
+			evaluate_trigger(triggers->values[i]);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: trigger evaluation helper thread entry                            *
+ *                                                                            *
+ ******************************************************************************/
+static void	*trigger_eval_worker(void *args)
+{
+	trigger_eval_pool_t	*pool = (trigger_eval_pool_t *)args;
+	zbx_uint64_t		job = 0;
+
+	pthread_mutex_lock(&pool->lock);
+
+	while (1)
+	{
+		while (job == pool->job)
+			pthread_cond_wait(&pool->cond_start, &pool->lock);
+
+		job = pool->job;
+		pool->active++;
+		pthread_mutex_unlock(&pool->lock);
+
+		trigger_eval_run(pool);
+
+		pthread_mutex_lock(&pool->lock);
+
+		if (0 == --pool->active)
+			pthread_cond_signal(&pool->cond_done);
+	}
+
+	return NULL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: creates trigger evaluation helper threads                         *
+ *                                                                            *
+ * Return value: SUCCEED - at least one helper thread was started             *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: The threads are created on first use in the process which        *
+ *           evaluates triggers and run until the process exits.              *
+ *           All asynchronous signals are blocked in the helper threads, so   *
+ *           they are delivered to the process main thread.                   *
+ *                                                                            *
+ ******************************************************************************/
+static int	trigger_eval_pool_create(int threads_num)
+{
+	trigger_eval_pool_t	*pool;
+	pthread_attr_t		attr;
+	sigset_t		mask, orig_mask;
+	int			i, err;
+
+	pool = (trigger_eval_pool_t *)zbx_malloc(NULL, sizeof(trigger_eval_pool_t));
+	memset(pool, 0, sizeof(trigger_eval_pool_t));
+
+	if (0 != (err = pthread_mutex_init(&pool->lock, NULL)))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot initialize trigger evaluation mutex: %s", zbx_strerror(err));
+		goto fail;
+	}
+
+	if (0 != (err = pthread_cond_init(&pool->cond_start, NULL)))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot initialize trigger evaluation condition variable: %s",
+				zbx_strerror(err));
+		goto fail_lock;
+	}
+
+	if (0 != (err = pthread_cond_init(&pool->cond_done, NULL)))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot initialize trigger evaluation condition variable: %s",
+				zbx_strerror(err));
+		goto fail_start;
+	}
+
+	pool->threads = (pthread_t *)zbx_malloc(NULL, sizeof(pthread_t) * (size_t)threads_num);
+
+	/* threads inherit signal mask, synchronous signals are left unblocked to keep crash handling */
+	sigfillset(&mask);
+	sigdelset(&mask, SIGSEGV);
+	sigdelset(&mask, SIGBUS);
+	sigdelset(&mask, SIGFPE);
+	sigdelset(&mask, SIGILL);
+
+	if (0 != (err = pthread_sigmask(SIG_BLOCK, &mask, &orig_mask)))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot block signals: %s", zbx_strerror(err));
+		goto fail_done;
+	}
+
+	zbx_pthread_init_attr(&attr);
+
+	for (i = 0; i < threads_num; i++)
+	{
+		if (0 != (err = pthread_create(&pool->threads[pool->threads_num], &attr, trigger_eval_worker, pool)))
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "cannot create trigger evaluation thread: %s", zbx_strerror(err));
+			break;
+		}
+
+		pool->threads_num++;
+	}
+
+	pthread_attr_destroy(&attr);
+
+	if (0 != (err = pthread_sigmask(SIG_SETMASK, &orig_mask, NULL)))
+		zabbix_log(LOG_LEVEL_WARNING, "cannot restore signal mask: %s", zbx_strerror(err));
+
+	/* started threads wait on pool synchronization objects, so the pool is kept even if not all started */
+	if (0 != pool->threads_num)
+	{
+		trigger_eval_pool = pool;
+		return SUCCEED;
+	}
+fail_done:
+	zbx_free(pool->threads);
+	pthread_cond_destroy(&pool->cond_done);
+fail_start:
+	pthread_cond_destroy(&pool->cond_start);
+fail_lock:
+	pthread_mutex_destroy(&pool->lock);
+fail:
+	zbx_free(pool);
+
+	return FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculates new trigger values                                     *
+ *                                                                            *
+ * Comments: Trigger functions are already substituted with their values at   *
+ *           this point, so expressions are evaluated without accessing       *
+ *           value cache, configuration cache or database and large trigger   *
+ *           sets are split between helper threads. Events are generated      *
+ *           later sequentially in trigger topological order, so the results  *
+ *           do not depend on the number of threads.                          *
+ *                                                                            *
+ ******************************************************************************/
+static void	evaluate_triggers(zbx_vector_dc_trigger_t *triggers)
+{
+	trigger_eval_pool_t	*pool;
+	int			i;
+
+	if (2 > trigger_eval_threads_num || 2 > triggers->values_num / TRIGGER_EVAL_BATCH_SIZE)
+		goto out;
+
+	/* the calling thread evaluates triggers too, so one helper thread less is needed */
+	if (NULL == trigger_eval_pool && (0 != trigger_eval_pool_failed ||
+			SUCCEED != trigger_eval_pool_create(trigger_eval_threads_num - 1)))
+	{
+		trigger_eval_pool_failed = 1;
+		goto out;
+	}
+
+	pool = trigger_eval_pool;
+
+	pthread_mutex_lock(&pool->lock);
+	pool->triggers = triggers;
+	pool->next = 0;
+	pool->job++;
+	pthread_cond_broadcast(&pool->cond_start);
+	pthread_mutex_unlock(&pool->lock);
+
+	trigger_eval_run(pool);
+
+	/* helper threads that have not joined yet will find no triggers to evaluate */
+	pthread_mutex_lock(&pool->lock);
+
+	while (0 != pool->active)
+		pthread_cond_wait(&pool->cond_done, &pool->lock);
+
+	pool->triggers = NULL;
+	pthread_mutex_unlock(&pool->lock);
+
+	return;
+out:
+	for (i = 0; i < triggers->values_num; i++)
+		evaluate_trigger(triggers->values[i]);
+}
+
+#undef TRIGGER_EVAL_BATCH_SIZE
+
 /******************************************************************************
  *                                                                            *
  * Purpose: evaluate trigger expressions.                                     *
@@ -610,7 +934,6 @@ void	zbx_evaluate_expressions(zbx_vector_dc_trigger_t *triggers, const zbx_vecto
 	zbx_dc_trigger_t	*tr;
 	zbx_history_sync_item_t	*items = NULL;
 	int			i, *items_err, items_num = 0;
-	double			expr_result;
 	zbx_dc_um_handle_t	*um_handle;
 	zbx_vector_uint64_t	hostids;
 
@@ -679,59 +1002,7 @@ void	zbx_evaluate_expressions(zbx_vector_dc_trigger_t *triggers, const zbx_vecto
 		zbx_free(items_err);
 	}
 
-	/* calculate new trigger values based on their recovery modes and expression evaluations */
-	for (i = 0; i < triggers->values_num; i++)
-	{
-		tr = triggers->values[i];
-
-		if (NULL != tr->new_error)
-			continue;
-
-		if (SUCCEED != evaluate_expression(tr->eval_ctx, &tr->timespec, &expr_result, &tr->new_error))
-			continue;
-
-		/* trigger expression evaluates to true, set PROBLEM value */
-		if (SUCCEED != zbx_double_compare(expr_result, 0.0))
-		{
-			if (0 == (tr->flags & ZBX_DC_TRIGGER_PROBLEM_EXPRESSION))
-			{
-				/* trigger value should remain unchanged and no PROBLEM events should be generated if */
-				/* problem expression evaluates to true, but trigger recalculation was initiated by a */
-				/* time-based function or a new value of an item in recovery expression */
-				tr->new_value = TRIGGER_VALUE_NONE;
-			}
-			else
-				tr->new_value = TRIGGER_VALUE_PROBLEM;
-
-			continue;
-		}
-
-		/* otherwise try to recover trigger by setting OK value */
-		if (TRIGGER_VALUE_PROBLEM == tr->value && TRIGGER_RECOVERY_MODE_NONE != tr->recovery_mode)
-		{
-			if (TRIGGER_RECOVERY_MODE_EXPRESSION == tr->recovery_mode)
-			{
-				tr->new_value = TRIGGER_VALUE_OK;
-				continue;
-			}
-
-			/* processing recovery expression mode */
-			if (SUCCEED != evaluate_expression(tr->eval_ctx_r, &tr->timespec, &expr_result, &tr->new_error))
-			{
-				tr->new_value = TRIGGER_VALUE_UNKNOWN;
-				continue;
-			}
-
-			if (SUCCEED != zbx_double_compare(expr_result, 0.0))
-			{
-				tr->new_value = TRIGGER_VALUE_OK;
-				continue;
-			}
-		}
-
-		/* no changes, keep the old value */
-		tr->new_value = TRIGGER_VALUE_NONE;
-	}
+	evaluate_triggers(triggers);
 
 	if (SUCCEED == ZBX_CHECK_LOG_LEVEL(LOG_LEVEL_DEBUG))
 	{
@@ -13,6 +13,7 @@
 **/
 
 #include "events.h"
+#include "problem_index.h"
 
 #include "../db_lengths_constants.h"
 #include "../actions/actions.h"
@@ -47,16 +48,6 @@ typedef struct
 }
 zbx_event_recovery_t;
 
-/* problem event, used to cache open problems for recovery attempts */
-typedef struct
-{
-	zbx_uint64_t		eventid;
-	zbx_uint64_t		triggerid;
-
-	zbx_vector_tags_ptr_t	tags;
-}
-zbx_event_problem_t;
-
 typedef enum
 {
 	CORRELATION_MATCH = 0,
@@ -1147,6 +1138,471 @@ static void	correlation_execute_operations(const zbx_correlation_t *correlation,
 #undef ZBX_CORR_OPERATION_CLOSE_OLD
 #undef ZBX_CORR_OPERATION_CLOSE_NEW
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if the correlation condition matches the old event         *
+ *                                                                            *
+ * Parameters: condition - [IN] correlation condition to check                *
+ *             event     - [IN] new event to match                            *
+ *             problem   - [IN] old event to match                            *
+ *                                                                            *
+ * Return value: "1" - correlation condition matches old event                *
+ *               "0" - correlation condition doesn't match old event          *
+ *               NULL - not an old event condition                            *
+ *                                                                            *
+ * Comments: The conditions are matched in the same way as the database       *
+ *           filters created by correlation_condition_get_event_filter().     *
+ *                                                                            *
+ ******************************************************************************/
+static const char	*correlation_condition_match_old_event(const zbx_corr_condition_t *condition,
+		const zbx_db_event *event, const zbx_event_problem_t *problem)
+{
+	const zbx_corr_condition_tag_value_t	*cond;
+	unsigned char				op;
+	int					ret = FAIL;
+
+	switch (condition->type)
+	{
+		case ZBX_CORR_CONDITION_OLD_EVENT_TAG:
+			for (int i = 0; i < problem->tags.values_num; i++)
+			{
+				if (0 == strcmp(problem->tags.values[i]->tag, condition->data.tag.tag))
+					return "1";
+			}
+			return "0";
+
+		case ZBX_CORR_CONDITION_OLD_EVENT_TAG_VALUE:
+			cond = &condition->data.tag_value;
+
+			/* negative operators match problems without any tag matching positive operator */
+			switch (cond->op)
+			{
+				case ZBX_CONDITION_OPERATOR_NOT_EQUAL:
+					op = ZBX_CONDITION_OPERATOR_EQUAL;
+					break;
+				case ZBX_CONDITION_OPERATOR_NOT_LIKE:
+					op = ZBX_CONDITION_OPERATOR_LIKE;
+					break;
+				default:
+					op = cond->op;
+			}
+
+			for (int i = 0; i < problem->tags.values_num; i++)
+			{
+				const zbx_tag_t	*tag = problem->tags.values[i];
+
+				if (0 == strcmp(tag->tag, cond->tag) &&
+						SUCCEED == zbx_strmatch_condition(tag->value, cond->value, op))
+				{
+					ret = SUCCEED;
+					break;
+				}
+			}
+
+			if (op != cond->op)
+				ret = (SUCCEED == ret ? FAIL : SUCCEED);
+
+			return (SUCCEED == ret ? "1" : "0");
+
+		case ZBX_CORR_CONDITION_EVENT_TAG_PAIR:
+			for (int i = 0; i < problem->tags.values_num; i++)
+			{
+				const zbx_tag_t	*tag = problem->tags.values[i];
+
+				if (0 != strcmp(tag->tag, condition->data.tag_pair.oldtag))
+					continue;
+
+				for (int j = 0; j < event->tags.values_num; j++)
+				{
+					const zbx_tag_t	*new_tag = event->tags.values[j];
+
+					if (0 == strcmp(new_tag->tag, condition->data.tag_pair.newtag) &&
+							0 == strcmp(new_tag->value, tag->value))
+					{
+						return "1";
+					}
+				}
+			}
+			return "0";
+	}
+
+	return NULL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: prepares correlation formula for matching old events              *
+ *                                                                            *
+ * Parameters: correlation - [IN] correlation rule                            *
+ *             event       - [IN] new event to match                          *
+ *                                                                            *
+ * Return value: The correlation formula with new event conditions replaced   *
+ *               by their values or NULL if formula refers to unknown         *
+ *               conditions.                                                  *
+ *                                                                            *
+ ******************************************************************************/
+static char	*correlation_prepare_old_event_expression(const zbx_correlation_t *correlation,
+		const zbx_db_event *event)
+{
+	char			*expression;
+	zbx_token_t		token;
+	int			pos = 0;
+	zbx_uint64_t		conditionid;
+	zbx_strloc_t		*loc;
+	zbx_corr_condition_t	*condition;
+
+	expression = zbx_strdup(NULL, correlation->formula);
+
+	for (; SUCCEED == zbx_token_find(expression, pos, &token, ZBX_TOKEN_SEARCH_BASIC); pos++)
+	{
+		if (ZBX_TOKEN_OBJECTID != token.type)
+			continue;
+
+		loc = &token.data.objectid.name;
+
+		if (SUCCEED != zbx_is_uint64_n(expression + loc->l, loc->r - loc->l + 1, &conditionid))
+			continue;
+
+		if (NULL == (condition = (zbx_corr_condition_t *)zbx_hashset_search(&correlation_rules.conditions,
+				&conditionid)))
+		{
+			zbx_free(expression);
+			break;
+		}
+
+		switch (condition->type)
+		{
+			case ZBX_CORR_CONDITION_NEW_EVENT_TAG:
+			case ZBX_CORR_CONDITION_NEW_EVENT_TAG_VALUE:
+			case ZBX_CORR_CONDITION_NEW_EVENT_HOSTGROUP:
+				zbx_replace_string(&expression, token.loc.l, &token.loc.r,
+						correlation_condition_match_new_event(condition, event, SUCCEED));
+				break;
+		}
+
+		pos = token.loc.r;
+	}
+
+	return expression;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if the prepared correlation formula matches the old event  *
+ *                                                                            *
+ * Parameters: expression - [IN] correlation formula prepared by              *
+ *                               correlation_prepare_old_event_expression()   *
+ *             event      - [IN] new event to match                           *
+ *             problem    - [IN] old event to match                           *
+ *                                                                            *
+ * Return value: SUCCEED - correlation rule matches old event                 *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	correlation_match_old_event(const char *expression, const zbx_db_event *event,
+		const zbx_event_problem_t *problem)
+{
+	char			*expr, error[256];
+	const char		*value;
+	zbx_token_t		token;
+	int			pos = 0, ret = FAIL;
+	zbx_uint64_t		conditionid;
+	zbx_strloc_t		*loc;
+	double			result;
+	zbx_corr_condition_t	*condition;
+
+	if ('\0' == *expression)
+		return SUCCEED;
+
+	expr = zbx_strdup(NULL, expression);
+
+	for (; SUCCEED == zbx_token_find(expr, pos, &token, ZBX_TOKEN_SEARCH_BASIC); pos++)
+	{
+		if (ZBX_TOKEN_OBJECTID != token.type)
+			continue;
+
+		loc = &token.data.objectid.name;
+
+		if (SUCCEED != zbx_is_uint64_n(expr + loc->l, loc->r - loc->l + 1, &conditionid))
+			continue;
+
+		if (NULL == (condition = (zbx_corr_condition_t *)zbx_hashset_search(&correlation_rules.conditions,
+				&conditionid)))
+		{
+			goto out;
+		}
+
+		if (NULL == (value = correlation_condition_match_old_event(condition, event, problem)))
+		{
+			THIS_SHOULD_NEVER_HAPPEN;
+			goto out;
+		}
+
+		zbx_replace_string(&expr, token.loc.l, &token.loc.r, value);
+		pos = token.loc.r;
+	}
+
+	if (SUCCEED == zbx_evaluate(&result, expr, error, sizeof(error), NULL) &&
+			SUCCEED == zbx_double_compare(result, 1))
+	{
+		ret = SUCCEED;
+	}
+out:
+	zbx_free(expr);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds problem tag filter                                           *
+ *                                                                            *
+ ******************************************************************************/
+static void	correlation_add_tag_filter(zbx_vector_problem_tag_filter_t *filters, const char *tag,
+		const char *value, unsigned char op)
+{
+	zbx_problem_tag_filter_t	filter = {.tag = tag, .value = value, .op = op};
+
+	zbx_vector_problem_tag_filter_append(filters, filter);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets filters of problems that can match old event conditions of   *
+ *          prepared correlation formula differently than problems without    *
+ *          tags                                                              *
+ *                                                                            *
+ * Parameters: expression - [IN] correlation formula prepared by              *
+ *                               correlation_prepare_old_event_expression()   *
+ *             event      - [IN] new event to match                           *
+ *             filters    - [OUT] problem tag filters (referencing            *
+ *                                correlation condition and event data)       *
+ *                                                                            *
+ ******************************************************************************/
+static void	correlation_get_old_event_filters(const char *expression, const zbx_db_event *event,
+		zbx_vector_problem_tag_filter_t *filters)
+{
+	zbx_token_t			token;
+	int				pos = 0;
+	zbx_uint64_t			conditionid;
+	zbx_strloc_t			*loc;
+	zbx_corr_condition_t		*condition;
+	zbx_corr_condition_tag_value_t	*cond;
+
+	for (; SUCCEED == zbx_token_find(expression, pos, &token, ZBX_TOKEN_SEARCH_BASIC); pos++)
+	{
+		if (ZBX_TOKEN_OBJECTID != token.type)
+			continue;
+
+		pos = token.loc.r;
+		loc = &token.data.objectid.name;
+
+		if (SUCCEED != zbx_is_uint64_n(expression + loc->l, loc->r - loc->l + 1, &conditionid))
+			continue;
+
+		if (NULL == (condition = (zbx_corr_condition_t *)zbx_hashset_search(&correlation_rules.conditions,
+				&conditionid)))
+		{
+			continue;
+		}
+
+		switch (condition->type)
+		{
+			case ZBX_CORR_CONDITION_OLD_EVENT_TAG:
+				correlation_add_tag_filter(filters, condition->data.tag.tag, NULL,
+						ZBX_CONDITION_OPERATOR_EXIST);
+				break;
+			case ZBX_CORR_CONDITION_OLD_EVENT_TAG_VALUE:
+				cond = &condition->data.tag_value;
+
+				switch (cond->op)
+				{
+					case ZBX_CONDITION_OPERATOR_EQUAL:
+					case ZBX_CONDITION_OPERATOR_NOT_EQUAL:
+						correlation_add_tag_filter(filters, cond->tag, cond->value,
+								ZBX_CONDITION_OPERATOR_EQUAL);
+						break;
+					case ZBX_CONDITION_OPERATOR_LIKE:
+					case ZBX_CONDITION_OPERATOR_NOT_LIKE:
+						correlation_add_tag_filter(filters, cond->tag, cond->value,
+								ZBX_CONDITION_OPERATOR_LIKE);
+						break;
+				}
+				break;
+			case ZBX_CORR_CONDITION_EVENT_TAG_PAIR:
+				for (int i = 0; i < event->tags.values_num; i++)
+				{
+					const zbx_tag_t	*tag = event->tags.values[i];
+
+					if (0 == strcmp(tag->tag, condition->data.tag_pair.newtag))
+					{
+						correlation_add_tag_filter(filters, condition->data.tag_pair.oldtag,
+								tag->value, ZBX_CONDITION_OPERATOR_EQUAL);
+					}
+				}
+				break;
+		}
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finds problem events that must be recovered by global correlation *
+ *          rules using problem index                                         *
+ *                                                                            *
+ * Parameters: event    - [IN] new event                                      *
+ *             corr_old - [IN] correlation rules matching new event and       *
+ *                             depending on old events                        *
+ *                                                                            *
+ * Return value: SUCCEED - the correlation rules were processed               *
+ *               FAIL    - problem index is not available or all problems     *
+ *                         must be checked                                    *
+ *                                                                            *
+ * Comments: Only problems having tags that can affect old event conditions   *
+ *           are checked. If a rule matches problems without tags (for        *
+ *           example rules with negative conditions), the problems are        *
+ *           selected from database instead, where the rule conditions are    *
+ *           used as query filter.                                            *
+ *                                                                            *
+ ******************************************************************************/
+static int	correlate_event_by_indexed_problems(zbx_db_event *event, const zbx_vector_ptr_t *corr_old)
+{
+	char			**expressions;
+	int				i, j, ret = SUCCEED;
+	zbx_vector_problem_tag_filter_t	filters;
+	zbx_vector_ptr_t		problems;
+	zbx_event_problem_t		problem_local;
+
+	expressions = (char **)zbx_calloc(NULL, (size_t)corr_old->values_num, sizeof(char *));
+	zbx_vector_problem_tag_filter_create(&filters);
+	zbx_vector_ptr_create(&problems);
+
+	problem_local.eventid = 0;
+	problem_local.triggerid = 0;
+	zbx_vector_tags_ptr_create(&problem_local.tags);
+
+	for (i = 0; i < corr_old->values_num; i++)
+	{
+		if (NULL == (expressions[i] = correlation_prepare_old_event_expression(
+				(const zbx_correlation_t *)corr_old->values[i], event)))
+		{
+			continue;
+		}
+
+		/* problems not matching any filter are matched by the rule in the same way as problems without tags, */
+		/* copying all indexed problems would be slower than selecting only matching problems from database  */
+		if (SUCCEED == correlation_match_old_event(expressions[i], event, &problem_local))
+		{
+			ret = FAIL;
+			goto out;
+		}
+
+		correlation_get_old_event_filters(expressions[i], event, &filters);
+	}
+
+	if (0 == filters.values_num)
+		goto out;
+
+	if (SUCCEED != (ret = problem_index_get_problems(&filters, &problems)))
+		goto out;
+
+	for (i = 0; i < problems.values_num; i++)
+	{
+		const zbx_event_problem_t	*problem = (const zbx_event_problem_t *)problems.values[i];
+
+		for (j = 0; j < corr_old->values_num; j++)
+		{
+			/* check if this event is not already recovered by another correlation rule */
+			if (NULL != zbx_hashset_search(&correlation_cache, &problem->eventid))
+				break;
+
+			if (NULL == expressions[j])
+				continue;
+
+			if (SUCCEED == correlation_match_old_event(expressions[j], event, problem))
+			{
+				correlation_execute_operations((zbx_correlation_t *)corr_old->values[j], event,
+						problem->eventid, problem->triggerid);
+			}
+		}
+	}
+out:
+	zbx_vector_ptr_clear_ext(&problems, (zbx_clean_func_t)event_problem_free);
+	zbx_vector_ptr_destroy(&problems);
+	zbx_vector_tags_ptr_destroy(&problem_local.tags);
+	zbx_vector_problem_tag_filter_destroy(&filters);
+
+	for (i = 0; i < corr_old->values_num; i++)
+		zbx_free(expressions[i]);
+	zbx_free(expressions);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finds problem events that must be recovered by global correlation *
+ *          rules using database                                              *
+ *                                                                            *
+ * Parameters: event    - [IN] new event                                      *
+ *             corr_old - [IN] correlation rules matching new event and       *
+ *                             depending on old events, sorted by             *
+ *                             correlationid                                  *
+ *                                                                            *
+ ******************************************************************************/
+static void	correlate_event_by_db_problems(zbx_db_event *event, const zbx_vector_ptr_t *corr_old)
+{
+	int			i;
+	zbx_correlation_t	*correlation;
+	char			*sql = NULL;
+	const char		*delim = "";
+	size_t			sql_alloc = 0, sql_offset = 0;
+	zbx_uint64_t		eventid, correlationid, objectid;
+	zbx_db_result_t		result;
+	zbx_db_row_t		row;
+
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, "select p.eventid,p.objectid,c.correlationid"
+							" from correlation c,problem p"
+							" where p.r_eventid is null"
+							" and p.source=" ZBX_STR(EVENT_SOURCE_TRIGGERS)
+							" and (");
+
+	for (i = 0; i < corr_old->values_num; i++)
+	{
+		correlation = (zbx_correlation_t *)corr_old->values[i];
+
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, delim);
+		correlation_add_event_filter(&sql, &sql_alloc, &sql_offset, correlation, event);
+		delim = " or ";
+	}
+
+	zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, ')');
+	result = zbx_db_select("%s", sql);
+
+	while (NULL != (row = zbx_db_fetch(result)))
+	{
+		ZBX_STR2UINT64(eventid, row[0]);
+
+		/* check if this event is not already recovered by another correlation rule */
+		if (NULL != zbx_hashset_search(&correlation_cache, &eventid))
+			continue;
+
+		ZBX_STR2UINT64(correlationid, row[2]);
+
+		if (FAIL == (i = zbx_vector_ptr_bsearch(corr_old, &correlationid, ZBX_DEFAULT_UINT64_PTR_COMPARE_FUNC)))
+		{
+			THIS_SHOULD_NEVER_HAPPEN;
+			continue;
+		}
+
+		ZBX_STR2UINT64(objectid, row[1]);
+		correlation_execute_operations((zbx_correlation_t *)corr_old->values[i], event, eventid, objectid);
+	}
+
+	zbx_db_free_result(result);
+	zbx_free(sql);
+}
+
 /* specifies correlation execution scope */
 typedef enum
 {
@@ -1163,7 +1619,9 @@ typedef enum
 	/* all problems are resolved */
 	ZBX_PROBLEM_STATE_RESOLVED,
 	/* at least one open problem exists */
-	ZBX_PROBLEM_STATE_OPEN
+	ZBX_PROBLEM_STATE_OPEN,
+	/* at least one open problem exists, open problems are indexed */
+	ZBX_PROBLEM_STATE_INDEXED
 }
 zbx_problem_state_t;
 
@@ -1181,8 +1639,9 @@ zbx_problem_state_t;
  *           The global event correlation matching is done in two parts:      *
  *             1) exclude correlations that can't possibly match the event    *
  *                based on new event tag/value/group conditions               *
- *             2) assemble sql statement to select problems/correlations      *
- *                based on the rest correlation conditions                    *
+ *             2) match the rest correlation conditions against open problems *
+ *                in problem index or, if the index is not available,         *
+ *                assemble sql statement to select problems/correlations      *
  *                                                                            *
  ******************************************************************************/
 static void	correlate_event_by_global_rules(zbx_db_event *event, zbx_problem_state_t *problem_state)
@@ -1190,10 +1649,6 @@ static void	correlate_event_by_global_rules(zbx_db_event *event, zbx_problem_sta
 	int			i;
 	zbx_correlation_t	*correlation;
 	zbx_vector_ptr_t	corr_old, corr_new;
-	char			*sql = NULL;
-	const char		*delim = "";
-	size_t			sql_alloc = 0, sql_offset = 0;
-	zbx_uint64_t		eventid, correlationid, objectid;
 
 	zbx_vector_ptr_create(&corr_old);
 	zbx_vector_ptr_create(&corr_new);
@@ -1227,16 +1682,27 @@ static void	correlate_event_by_global_rules(zbx_db_event *event, zbx_problem_sta
 			if (ZBX_PROBLEM_STATE_UNKNOWN == *problem_state)
 			{
 				zbx_db_result_t	result;
+				int		problems_num;
 
-				result = zbx_db_select_n("select eventid from problem"
-						" where r_eventid is null and source="
-						ZBX_STR(EVENT_SOURCE_TRIGGERS), 1);
-
-				if (NULL == zbx_db_fetch(result))
-					*problem_state = ZBX_PROBLEM_STATE_RESOLVED;
+				if (SUCCEED == problem_index_sync(&problems_num))
+				{
+					if (0 == problems_num)
+						*problem_state = ZBX_PROBLEM_STATE_RESOLVED;
+					else
+						*problem_state = ZBX_PROBLEM_STATE_INDEXED;
+				}
 				else
-					*problem_state = ZBX_PROBLEM_STATE_OPEN;
-				zbx_db_free_result(result);
+				{
+					result = zbx_db_select_n("select eventid from problem"
+							" where r_eventid is null and source="
+							ZBX_STR(EVENT_SOURCE_TRIGGERS), 1);
+
+					if (NULL == zbx_db_fetch(result))
+						*problem_state = ZBX_PROBLEM_STATE_RESOLVED;
+					else
+						*problem_state = ZBX_PROBLEM_STATE_OPEN;
+					zbx_db_free_result(result);
+				}
 			}
 
 			if (ZBX_PROBLEM_STATE_RESOLVED == *problem_state)
@@ -1264,53 +1730,13 @@ static void	correlate_event_by_global_rules(zbx_db_event *event, zbx_problem_sta
 
 	if (0 != corr_old.values_num)
 	{
-		zbx_db_result_t	result;
-		zbx_db_row_t	row;
-
 		/* Process correlations that matches new event and either uses old events in conditions */
 		/* or has operations involving old events.                                              */
-
-		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, "select p.eventid,p.objectid,c.correlationid"
-								" from correlation c,problem p"
-								" where p.r_eventid is null"
-								" and p.source=" ZBX_STR(EVENT_SOURCE_TRIGGERS)
-								" and (");
-
-		for (i = 0; i < corr_old.values_num; i++)
+		if (ZBX_PROBLEM_STATE_INDEXED != *problem_state ||
+				SUCCEED != correlate_event_by_indexed_problems(event, &corr_old))
 		{
-			correlation = (zbx_correlation_t *)corr_old.values[i];
-
-			zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, delim);
-			correlation_add_event_filter(&sql, &sql_alloc, &sql_offset, correlation, event);
-			delim = " or ";
+			correlate_event_by_db_problems(event, &corr_old);
 		}
-
-		zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, ')');
-		result = zbx_db_select("%s", sql);
-
-		while (NULL != (row = zbx_db_fetch(result)))
-		{
-			ZBX_STR2UINT64(eventid, row[0]);
-
-			/* check if this event is not already recovered by another correlation rule */
-			if (NULL != zbx_hashset_search(&correlation_cache, &eventid))
-				continue;
-
-			ZBX_STR2UINT64(correlationid, row[2]);
-
-			if (FAIL == (i = zbx_vector_ptr_bsearch(&corr_old, &correlationid,
-					ZBX_DEFAULT_UINT64_PTR_COMPARE_FUNC)))
-			{
-				THIS_SHOULD_NEVER_HAPPEN;
-				continue;
-			}
-
-			ZBX_STR2UINT64(objectid, row[1]);
-			correlation_execute_operations((zbx_correlation_t *)corr_old.values[i], event, eventid, objectid);
-		}
-
-		zbx_db_free_result(result);
-		zbx_free(sql);
 	}
 
 	zbx_vector_ptr_destroy(&corr_new);
@@ -2033,6 +2459,56 @@ void	zbx_events_update_itservices(void)
 	zbx_free(data);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: updates problem index with committed trigger problem changes      *
+ *                                                                            *
+ * Comments: Must be called after the transaction saving events is committed, *
+ *           so the index never contains problems that were rolled back.      *
+ *           New problems are added before removing recovered problems as     *
+ *           new problems might be closed by correlation in the same batch.   *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_events_update_problem_index(void)
+{
+	zbx_vector_ptr_t	problems;
+	zbx_vector_uint64_t	eventids;
+	zbx_hashset_iter_t	iter;
+	zbx_event_recovery_t	*recovery;
+
+	zbx_vector_ptr_create(&problems);
+	zbx_vector_uint64_create(&eventids);
+
+	for (int i = 0; i < events.values_num; i++)
+	{
+		zbx_db_event	*event = events.values[i];
+
+		if (0 == (event->flags & ZBX_FLAGS_DB_EVENT_CREATE))
+			continue;
+
+		if (EVENT_SOURCE_TRIGGERS != event->source || EVENT_OBJECT_TRIGGER != event->object ||
+				TRIGGER_VALUE_PROBLEM != event->value)
+		{
+			continue;
+		}
+
+		zbx_vector_ptr_append(&problems, event);
+	}
+
+	zbx_hashset_iter_reset(&event_recovery, &iter);
+	while (NULL != (recovery = (zbx_event_recovery_t *)zbx_hashset_iter_next(&iter)))
+	{
+		if (EVENT_SOURCE_TRIGGERS == recovery->r_event->source)
+			zbx_vector_uint64_append(&eventids, recovery->eventid);
+	}
+
+	problem_index_add_problems(&problems);
+	zbx_problem_index_remove(&eventids);
+
+	zbx_vector_uint64_destroy(&eventids);
+	zbx_vector_ptr_destroy(&problems);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: adds event suppress data for problem events matching active       *
@@ -2456,18 +2932,6 @@ static void	get_open_problems(const zbx_vector_uint64_t *triggerids, zbx_vector_
 	zbx_vector_uint64_destroy(&eventids);
 }
 
-/******************************************************************************
- *                                                                            *
- * Purpose: frees cached problem event                                        *
- *                                                                            *
- ******************************************************************************/
-static void	event_problem_free(zbx_event_problem_t *problem)
-{
-	zbx_vector_tags_ptr_clear_ext(&problem->tags, zbx_free_tag);
-	zbx_vector_tags_ptr_destroy(&problem->tags);
-	zbx_free(problem);
-}
-
 /******************************************************************************
  *                                                                            *
  * Purpose: frees trigger dependency                                          *
@@ -2979,6 +3443,7 @@ int	zbx_close_problem(zbx_uint64_t triggerid, zbx_uint64_t eventid, zbx_uint64_t
 
 			zbx_dc_config_triggers_apply_changes(&trigger_diff);
 
+			zbx_events_update_problem_index();
 			zbx_events_update_itservices();
 
 			zbx_vector_connector_filter_create(&connector_filters_events);
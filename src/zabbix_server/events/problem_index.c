@@ -0,0 +1,1117 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "problem_index.h"
+
+#include "zbxdbhigh.h"
+#include "zbxmutexs.h"
+#include "zbxshmem.h"
+#include "zbxnum.h"
+#include "zbxtime.h"
+#include "zbxdb.h"
+#include "zbxexpr.h"
+
+/* The problem index keeps open trigger problems with their tags in shared memory, so global      */
+/* correlation rules can be matched without querying problem tables for every new event. It is   */
+/* loaded from database when first needed and updated after problem table changes are committed.  */
+/* Periodic reload removes problems that were closed or deleted without updating the index. The   */
+/* index might still contain problems that were already closed by other processes, so the matched */
+/* problems are verified in database before returning them for correlation.                       */
+
+/* index reload period */
+#define PROBLEM_INDEX_SYNC_PERIOD	(10 * SEC_PER_MIN)
+
+/* Problems added to index less than the specified number of seconds before reload might not be  */
+/* visible to the reload query yet, so they are kept even when not found in database.            */
+#define PROBLEM_INDEX_SYNC_DELAY	SEC_PER_MIN
+
+/* index is empty, updates are ignored */
+#define PROBLEM_INDEX_EMPTY	0
+/* index contains all open problems */
+#define PROBLEM_INDEX_READY	1
+
+typedef struct zbx_pi_value zbx_pi_value_t;
+
+typedef struct
+{
+	const char	*tag;
+
+	/* values of this tag in open problems */
+	zbx_pi_value_t	**values;
+	int		values_num;
+	int		values_alloc;
+}
+zbx_pi_tag_t;
+
+struct zbx_pi_value
+{
+	zbx_pi_tag_t	*tag;
+	const char	*value;
+
+	/* index of the value in tag values array */
+	int		index;
+
+	/* sorted identifiers of open problems having this tag value */
+	zbx_uint64_t	*eventids;
+	int		eventids_num;
+	int		eventids_alloc;
+};
+
+typedef struct
+{
+	zbx_uint64_t	eventid;
+	zbx_uint64_t	triggerid;
+	zbx_pi_value_t	**tags;
+	int		tags_num;
+	int		lastupdate;
+}
+zbx_pi_problem_t;
+
+typedef struct
+{
+	zbx_hashset_t	problems;
+	zbx_hashset_t	tags;
+	zbx_hashset_t	values;
+
+	int		state;
+
+	/* set while the index is being loaded from database */
+	int		loading;
+
+	/* problems removed while the index is being loaded, they must not be restored by the load */
+	zbx_hashset_t	removed;
+
+	/* set when the index was cleared while being loaded, the loaded problems must be discarded */
+	int		discard;
+
+	/* the next time the index must be reloaded */
+	int		sync_time;
+}
+zbx_problem_index_t;
+
+static zbx_problem_index_t	*problem_index = NULL;
+
+static zbx_mutex_t	pi_lock = ZBX_MUTEX_NULL;
+static zbx_shmem_info_t	*pi_mem = NULL;
+
+ZBX_SHMEM_FUNC_IMPL(__pi, pi_mem)
+
+#define LOCK_PI		zbx_mutex_lock(pi_lock)
+#define UNLOCK_PI	zbx_mutex_unlock(pi_lock)
+
+ZBX_VECTOR_IMPL(problem_tag_filter, zbx_problem_tag_filter_t)
+
+static zbx_hash_t	pi_value_hash_func(const void *data)
+{
+	const zbx_pi_value_t	*value = (const zbx_pi_value_t *)data;
+	zbx_hash_t		hash;
+
+	hash = ZBX_DEFAULT_PTR_HASH_FUNC(&value->tag);
+
+	return ZBX_DEFAULT_STRING_HASH_ALGO(value->value, strlen(value->value), hash);
+}
+
+static int	pi_value_compare_func(const void *d1, const void *d2)
+{
+	const zbx_pi_value_t	*value1 = (const zbx_pi_value_t *)d1;
+	const zbx_pi_value_t	*value2 = (const zbx_pi_value_t *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(value1->tag, value2->tag);
+
+	return strcmp(value1->value, value2->value);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: frees cached problem event                                        *
+ *                                                                            *
+ ******************************************************************************/
+void	event_problem_free(zbx_event_problem_t *problem)
+{
+	zbx_vector_tags_ptr_clear_ext(&problem->tags, zbx_free_tag);
+	zbx_vector_tags_ptr_destroy(&problem->tags);
+	zbx_free(problem);
+}
+
+static char	*pi_strdup(const char *str)
+{
+	char	*dst;
+	size_t	len;
+
+	len = strlen(str) + 1;
+
+	if (NULL == (dst = (char *)__pi_shmem_malloc_func(NULL, len)))
+		return NULL;
+
+	memcpy(dst, str, len);
+
+	return dst;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes tag value from index if there are no problems having it   *
+ *                                                                            *
+ * Comments: The tag is removed from index together with its last value.      *
+ *                                                                            *
+ ******************************************************************************/
+static void	pi_value_release(zbx_pi_value_t *value)
+{
+	zbx_pi_tag_t	*tag = value->tag;
+
+	if (0 != value->eventids_num)
+		return;
+
+	if (value->index != --tag->values_num)
+	{
+		tag->values[value->index] = tag->values[tag->values_num];
+		tag->values[value->index]->index = value->index;
+	}
+
+	__pi_shmem_free_func(value->eventids);
+	__pi_shmem_free_func((void *)value->value);
+	zbx_hashset_remove_direct(&problem_index->values, value);
+
+	if (0 != tag->values_num)
+		return;
+
+	__pi_shmem_free_func(tag->values);
+	__pi_shmem_free_func((void *)tag->tag);
+	zbx_hashset_remove_direct(&problem_index->tags, tag);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets indexed tag value, adding it to index if necessary           *
+ *                                                                            *
+ * Parameters: name - [IN] tag name                                           *
+ *             str  - [IN] tag value                                          *
+ *                                                                            *
+ * Return value: The indexed tag value or NULL if there was not enough        *
+ *               memory.                                                      *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_pi_value_t	*pi_value_get(const char *name, const char *str)
+{
+	zbx_pi_tag_t	*tag, tag_local = {.tag = name};
+	zbx_pi_value_t	*value, value_local;
+
+	if (NULL == (tag = (zbx_pi_tag_t *)zbx_hashset_search(&problem_index->tags, &tag_local)))
+	{
+		if (NULL == (tag_local.tag = pi_strdup(name)))
+			return NULL;
+
+		if (NULL == (tag = (zbx_pi_tag_t *)zbx_hashset_insert(&problem_index->tags, &tag_local,
+				sizeof(tag_local))))
+		{
+			__pi_shmem_free_func((void *)tag_local.tag);
+			return NULL;
+		}
+	}
+
+	value_local.tag = tag;
+	value_local.value = str;
+
+	if (NULL != (value = (zbx_pi_value_t *)zbx_hashset_search(&problem_index->values, &value_local)))
+		return value;
+
+	if (tag->values_num == tag->values_alloc)
+	{
+		zbx_pi_value_t	**values;
+		int		alloc;
+
+		alloc = (0 == tag->values_alloc ? 4 : tag->values_alloc * 3 / 2);
+
+		if (NULL == (values = (zbx_pi_value_t **)__pi_shmem_realloc_func(tag->values,
+				sizeof(zbx_pi_value_t *) * (size_t)alloc)))
+		{
+			goto out;
+		}
+
+		tag->values = values;
+		tag->values_alloc = alloc;
+	}
+
+	if (NULL == (value_local.value = pi_strdup(str)))
+		goto out;
+
+	value_local.index = tag->values_num;
+	value_local.eventids = NULL;
+	value_local.eventids_num = 0;
+	value_local.eventids_alloc = 0;
+
+	if (NULL == (value = (zbx_pi_value_t *)zbx_hashset_insert(&problem_index->values, &value_local,
+			sizeof(value_local))))
+	{
+		__pi_shmem_free_func((void *)value_local.value);
+		goto out;
+	}
+
+	tag->values[tag->values_num++] = value;
+
+	return value;
+out:
+	if (0 == tag->values_num)
+	{
+		__pi_shmem_free_func(tag->values);
+		__pi_shmem_free_func((void *)tag->tag);
+		zbx_hashset_remove_direct(&problem_index->tags, tag);
+	}
+
+	return NULL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds problem to the tag value index                               *
+ *                                                                            *
+ * Parameters: name    - [IN] tag name                                        *
+ *             str     - [IN] tag value                                       *
+ *             eventid - [IN] problem event identifier                        *
+ *                                                                            *
+ * Return value: The indexed tag value or NULL if there was not enough        *
+ *               memory.                                                      *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_pi_value_t	*pi_value_add_eventid(const char *name, const char *str, zbx_uint64_t eventid)
+{
+	zbx_pi_value_t	*value;
+	int		i;
+
+	if (NULL == (value = pi_value_get(name, str)))
+		return NULL;
+
+	if (value->eventids_num == value->eventids_alloc)
+	{
+		zbx_uint64_t	*eventids;
+		int		alloc;
+
+		alloc = (0 == value->eventids_alloc ? 4 : value->eventids_alloc * 3 / 2);
+
+		if (NULL == (eventids = (zbx_uint64_t *)__pi_shmem_realloc_func(value->eventids,
+				sizeof(zbx_uint64_t) * (size_t)alloc)))
+		{
+			pi_value_release(value);
+			return NULL;
+		}
+
+		value->eventids = eventids;
+		value->eventids_alloc = alloc;
+	}
+
+	/* problems are mostly added in the order of their identifiers */
+	for (i = value->eventids_num; 0 < i && value->eventids[i - 1] > eventid; i--)
+		value->eventids[i] = value->eventids[i - 1];
+
+	value->eventids[i] = eventid;
+	value->eventids_num++;
+
+	return value;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes problem from the tag value index                          *
+ *                                                                            *
+ * Parameters: value   - [IN] indexed tag value                               *
+ *             eventid - [IN] problem event identifier                        *
+ *                                                                            *
+ ******************************************************************************/
+static void	pi_value_remove_eventid(zbx_pi_value_t *value, zbx_uint64_t eventid)
+{
+	zbx_uint64_t	*ptr;
+
+	if (NULL != (ptr = (zbx_uint64_t *)bsearch(&eventid, value->eventids, (size_t)value->eventids_num,
+			sizeof(zbx_uint64_t), ZBX_DEFAULT_UINT64_COMPARE_FUNC)))
+	{
+		memmove(ptr, ptr + 1, sizeof(zbx_uint64_t) * (size_t)(value->eventids + --value->eventids_num - ptr));
+	}
+
+	pi_value_release(value);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes indexed problem tags                                      *
+ *                                                                            *
+ ******************************************************************************/
+static void	pi_problem_clear_tags(zbx_pi_problem_t *problem)
+{
+	for (int i = 0; i < problem->tags_num; i++)
+		pi_value_remove_eventid(problem->tags[i], problem->eventid);
+
+	if (NULL != problem->tags)
+	{
+		__pi_shmem_free_func(problem->tags);
+		problem->tags = NULL;
+	}
+
+	problem->tags_num = 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds tags to indexed problem                                      *
+ *                                                                            *
+ * Parameters: problem - [IN] indexed problem                                 *
+ *             tags    - [IN] tags to add                                     *
+ *                                                                            *
+ * Return value: SUCCEED - the tags were added                                *
+ *               FAIL    - not enough memory                                  *
+ *                                                                            *
+ ******************************************************************************/
+static int	pi_problem_add_tags(zbx_pi_problem_t *problem, const zbx_vector_tags_ptr_t *tags)
+{
+	zbx_pi_value_t	**ptags;
+
+	if (0 == tags->values_num)
+		return SUCCEED;
+
+	if (NULL == (ptags = (zbx_pi_value_t **)__pi_shmem_realloc_func(problem->tags,
+			sizeof(zbx_pi_value_t *) * (size_t)(problem->tags_num + tags->values_num))))
+	{
+		return FAIL;
+	}
+
+	problem->tags = ptags;
+
+	for (int i = 0; i < tags->values_num; i++)
+	{
+		zbx_pi_value_t	*value;
+
+		if (NULL == (value = pi_value_add_eventid(tags->values[i]->tag, tags->values[i]->value,
+				problem->eventid)))
+		{
+			return FAIL;
+		}
+
+		problem->tags[problem->tags_num++] = value;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds problem to index or replaces already indexed problem         *
+ *                                                                            *
+ * Parameters: eventid   - [IN] problem event identifier                      *
+ *             triggerid - [IN] problem source trigger identifier             *
+ *             tags      - [IN] problem tags                                  *
+ *             now       - [IN] current time                                  *
+ *                                                                            *
+ * Return value: SUCCEED - the problem was indexed                            *
+ *               FAIL    - not enough memory                                  *
+ *                                                                            *
+ ******************************************************************************/
+static int	pi_problem_add(zbx_uint64_t eventid, zbx_uint64_t triggerid, const zbx_vector_tags_ptr_t *tags, int now)
+{
+	zbx_pi_problem_t	*problem, problem_local = {.eventid = eventid};
+
+	if (NULL == (problem = (zbx_pi_problem_t *)zbx_hashset_search(&problem_index->problems, &problem_local)))
+	{
+		if (NULL == (problem = (zbx_pi_problem_t *)zbx_hashset_insert(&problem_index->problems,
+				&problem_local, sizeof(problem_local))))
+		{
+			return FAIL;
+		}
+	}
+	else
+		pi_problem_clear_tags(problem);
+
+	problem->triggerid = triggerid;
+	problem->lastupdate = now;
+
+	return pi_problem_add_tags(problem, tags);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes problem from index                                        *
+ *                                                                            *
+ * Parameters: eventid - [IN] problem event identifier                        *
+ *                                                                            *
+ * Return value: SUCCEED - the problem was removed or was not indexed         *
+ *               FAIL    - not enough memory to remember the problem removed  *
+ *                         during load                                        *
+ *                                                                            *
+ ******************************************************************************/
+static int	pi_problem_remove(zbx_uint64_t eventid)
+{
+	zbx_pi_problem_t	*problem;
+
+	if (NULL != (problem = (zbx_pi_problem_t *)zbx_hashset_search(&problem_index->problems, &eventid)))
+	{
+		pi_problem_clear_tags(problem);
+		zbx_hashset_remove_direct(&problem_index->problems, problem);
+	}
+
+	if (0 != problem_index->loading && NULL == zbx_hashset_insert(&problem_index->removed, &eventid,
+			sizeof(eventid)))
+	{
+		return FAIL;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes all problems from index                                   *
+ *                                                                            *
+ ******************************************************************************/
+static void	pi_clear(void)
+{
+	zbx_hashset_iter_t	iter;
+	zbx_pi_problem_t	*problem;
+
+	zbx_hashset_iter_reset(&problem_index->problems, &iter);
+	while (NULL != (problem = (zbx_pi_problem_t *)zbx_hashset_iter_next(&iter)))
+	{
+		pi_problem_clear_tags(problem);
+		zbx_hashset_iter_remove(&iter);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: disables index after running out of memory                        *
+ *                                                                            *
+ * Comments: The index will be loaded again after the sync period. Meanwhile  *
+ *           correlation rules are matched with database queries.             *
+ *                                                                            *
+ ******************************************************************************/
+static void	pi_set_oom(int now)
+{
+	zabbix_log(LOG_LEVEL_WARNING, "problem index cache is full, event correlation will use database"
+			" queries, consider increasing ProblemIndexCacheSize configuration parameter");
+
+	pi_clear();
+	zbx_hashset_clear(&problem_index->removed);
+	problem_index->state = PROBLEM_INDEX_EMPTY;
+	problem_index->sync_time = now + PROBLEM_INDEX_SYNC_PERIOD;
+
+	if (0 != problem_index->loading)
+		problem_index->discard = 1;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if index must be kept up to date with problem changes      *
+ *                                                                            *
+ ******************************************************************************/
+static int	pi_is_active(void)
+{
+	return (PROBLEM_INDEX_READY == problem_index->state || 0 != problem_index->loading) ? SUCCEED : FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reads open trigger problems with their tags from database         *
+ *                                                                            *
+ * Parameters: problems - [OUT] open problems, sorted by eventid              *
+ *                                                                            *
+ ******************************************************************************/
+static void	pi_db_get_problems(zbx_vector_ptr_t *problems)
+{
+	zbx_db_result_t		result;
+	zbx_db_row_t		row;
+	zbx_event_problem_t	*problem;
+	zbx_tag_t		*tag;
+	zbx_uint64_t		eventid;
+	int			index;
+
+	result = zbx_db_select("select eventid,objectid from problem"
+			" where source=%d and object=%d and r_eventid is null",
+			EVENT_SOURCE_TRIGGERS, EVENT_OBJECT_TRIGGER);
+
+	while (NULL != (row = zbx_db_fetch(result)))
+	{
+		problem = (zbx_event_problem_t *)zbx_malloc(NULL, sizeof(zbx_event_problem_t));
+
+		ZBX_STR2UINT64(problem->eventid, row[0]);
+		ZBX_STR2UINT64(problem->triggerid, row[1]);
+		zbx_vector_tags_ptr_create(&problem->tags);
+		zbx_vector_ptr_append(problems, problem);
+	}
+	zbx_db_free_result(result);
+
+	if (0 == problems->values_num)
+		return;
+
+	zbx_vector_ptr_sort(problems, ZBX_DEFAULT_UINT64_PTR_COMPARE_FUNC);
+
+	result = zbx_db_select("select pt.eventid,pt.tag,pt.value from problem_tag pt,problem p"
+			" where pt.eventid=p.eventid"
+				" and p.source=%d and p.object=%d and p.r_eventid is null",
+			EVENT_SOURCE_TRIGGERS, EVENT_OBJECT_TRIGGER);
+
+	while (NULL != (row = zbx_db_fetch(result)))
+	{
+		ZBX_STR2UINT64(eventid, row[0]);
+
+		/* problem might be opened after the first query */
+		if (FAIL == (index = zbx_vector_ptr_bsearch(problems, &eventid, ZBX_DEFAULT_UINT64_PTR_COMPARE_FUNC)))
+			continue;
+
+		problem = (zbx_event_problem_t *)problems->values[index];
+
+		tag = (zbx_tag_t *)zbx_malloc(NULL, sizeof(zbx_tag_t));
+		tag->tag = zbx_strdup(NULL, row[1]);
+		tag->value = zbx_strdup(NULL, row[2]);
+		zbx_vector_tags_ptr_append(&problem->tags, tag);
+	}
+	zbx_db_free_result(result);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: loads open problems from database into index                      *
+ *                                                                            *
+ * Parameters: now - [IN] the load start time                                 *
+ *                                                                            *
+ * Comments: Problems added to index by other processes during the load are   *
+ *           kept and problems removed during the load are not restored.      *
+ *           Indexed problems not found in database are removed unless they   *
+ *           were added shortly before the load.                              *
+ *                                                                            *
+ ******************************************************************************/
+static void	pi_load(int now)
+{
+	zbx_vector_ptr_t	problems;
+	zbx_hashset_iter_t	iter;
+	zbx_pi_problem_t	*problem;
+	int			i = 0, removed_num = 0;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	zbx_vector_ptr_create(&problems);
+
+	pi_db_get_problems(&problems);
+
+	LOCK_PI;
+
+	if (0 != problem_index->discard)
+		goto out;
+
+	for (i = 0; i < problems.values_num; i++)
+	{
+		const zbx_event_problem_t	*db_problem = (const zbx_event_problem_t *)problems.values[i];
+
+		/* problem was closed after it was read from database */
+		if (NULL != zbx_hashset_search(&problem_index->removed, &db_problem->eventid))
+			continue;
+
+		if (SUCCEED != pi_problem_add(db_problem->eventid, db_problem->triggerid, &db_problem->tags, now))
+		{
+			pi_set_oom(now);
+			goto out;
+		}
+	}
+
+	zbx_hashset_iter_reset(&problem_index->problems, &iter);
+	while (NULL != (problem = (zbx_pi_problem_t *)zbx_hashset_iter_next(&iter)))
+	{
+		if (problem->lastupdate >= now - PROBLEM_INDEX_SYNC_DELAY)
+			continue;
+
+		pi_problem_clear_tags(problem);
+		zbx_hashset_iter_remove(&iter);
+		removed_num++;
+	}
+
+	problem_index->state = PROBLEM_INDEX_READY;
+	problem_index->sync_time = now + PROBLEM_INDEX_SYNC_PERIOD;
+out:
+	zbx_hashset_clear(&problem_index->removed);
+	problem_index->discard = 0;
+	problem_index->loading = 0;
+
+	UNLOCK_PI;
+
+	zbx_vector_ptr_clear_ext(&problems, (zbx_clean_func_t)event_problem_free);
+	zbx_vector_ptr_destroy(&problems);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() loaded:%d removed:%d", __func__, i, removed_num);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: initializes problem index                                         *
+ *                                                                            *
+ * Parameters: cache_size - [IN] problem index cache size, can be 0           *
+ *             error      - [OUT] the error message                           *
+ *                                                                            *
+ * Return value: SUCCEED - the index was initialized successfully             *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_problem_index_init(zbx_uint64_t cache_size, char **error)
+{
+	int	ret = FAIL;
+
+	if (0 == cache_size)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "%s(): problem index disabled", __func__);
+		return SUCCEED;
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	if (SUCCEED != zbx_mutex_create(&pi_lock, ZBX_MUTEX_PROBLEM_INDEX, error))
+		goto out;
+
+	if (SUCCEED != zbx_shmem_create(&pi_mem, cache_size, "problem index cache size", "ProblemIndexCacheSize", 1,
+			error))
+	{
+		goto out;
+	}
+
+	problem_index = (zbx_problem_index_t *)__pi_shmem_malloc_func(NULL, sizeof(zbx_problem_index_t));
+
+	zbx_hashset_create_ext(&problem_index->problems, 100, ZBX_DEFAULT_UINT64_HASH_FUNC,
+			ZBX_DEFAULT_UINT64_COMPARE_FUNC, NULL, __pi_shmem_malloc_func, __pi_shmem_realloc_func,
+			__pi_shmem_free_func);
+
+	zbx_hashset_create_ext(&problem_index->tags, 100, ZBX_DEFAULT_STRING_PTR_HASH_FUNC,
+			ZBX_DEFAULT_STR_COMPARE_FUNC, NULL, __pi_shmem_malloc_func, __pi_shmem_realloc_func,
+			__pi_shmem_free_func);
+
+	zbx_hashset_create_ext(&problem_index->values, 100, pi_value_hash_func, pi_value_compare_func, NULL,
+			__pi_shmem_malloc_func, __pi_shmem_realloc_func, __pi_shmem_free_func);
+
+	zbx_hashset_create_ext(&problem_index->removed, 0, ZBX_DEFAULT_UINT64_HASH_FUNC,
+			ZBX_DEFAULT_UINT64_COMPARE_FUNC, NULL, __pi_shmem_malloc_func, __pi_shmem_realloc_func,
+			__pi_shmem_free_func);
+
+	problem_index->state = PROBLEM_INDEX_EMPTY;
+	problem_index->loading = 0;
+	problem_index->discard = 0;
+	problem_index->sync_time = 0;
+
+	ret = SUCCEED;
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s(): %s", __func__, ZBX_NULL2EMPTY_STR(*error));
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: destroys problem index                                            *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_problem_index_destroy(void)
+{
+	if (NULL != pi_mem)
+	{
+		zbx_shmem_destroy(pi_mem);
+		pi_mem = NULL;
+		problem_index = NULL;
+		zbx_mutex_destroy(&pi_lock);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes closed or deleted problems from index                     *
+ *                                                                            *
+ * Parameters: eventids - [IN] problem event identifiers                      *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_problem_index_remove(const zbx_vector_uint64_t *eventids)
+{
+	if (NULL == problem_index || 0 == eventids->values_num)
+		return;
+
+	LOCK_PI;
+
+	if (SUCCEED == pi_is_active())
+	{
+		for (int i = 0; i < eventids->values_num; i++)
+		{
+			if (SUCCEED != pi_problem_remove(eventids->values[i]))
+			{
+				pi_set_oom((int)time(NULL));
+				break;
+			}
+		}
+	}
+
+	UNLOCK_PI;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds tags to indexed problem                                      *
+ *                                                                            *
+ * Parameters: eventid - [IN] problem event identifier                        *
+ *             tags    - [IN] new problem tags                                *
+ *                                                                            *
+ * Comments: The tags are ignored if the problem is not indexed.              *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_problem_index_add_tags(zbx_uint64_t eventid, const zbx_vector_tags_ptr_t *tags)
+{
+	zbx_pi_problem_t	*problem;
+
+	if (NULL == problem_index || 0 == tags->values_num)
+		return;
+
+	LOCK_PI;
+
+	if (SUCCEED == pi_is_active() && NULL != (problem = (zbx_pi_problem_t *)zbx_hashset_search(
+			&problem_index->problems, &eventid)))
+	{
+		if (SUCCEED != pi_problem_add_tags(problem, tags))
+			pi_set_oom((int)time(NULL));
+	}
+
+	UNLOCK_PI;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds new trigger problems to index                                *
+ *                                                                            *
+ * Parameters: events - [IN] new problem events                               *
+ *                                                                            *
+ * Comments: Must be called only after the problems have been committed to    *
+ *           database.                                                        *
+ *                                                                            *
+ ******************************************************************************/
+void	problem_index_add_problems(const zbx_vector_ptr_t *events)
+{
+	int	now;
+
+	if (NULL == problem_index || 0 == events->values_num)
+		return;
+
+	now = (int)time(NULL);
+
+	LOCK_PI;
+
+	if (SUCCEED == pi_is_active())
+	{
+		for (int i = 0; i < events->values_num; i++)
+		{
+			const zbx_db_event	*event = (const zbx_db_event *)events->values[i];
+
+			if (EVENT_SOURCE_TRIGGERS != event->source || EVENT_OBJECT_TRIGGER != event->object)
+				continue;
+
+			if (SUCCEED != pi_problem_add(event->eventid, event->objectid, &event->tags, now))
+			{
+				pi_set_oom(now);
+				break;
+			}
+		}
+	}
+
+	UNLOCK_PI;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: prepares problem index for matching                               *
+ *                                                                            *
+ * Parameters: problems_num - [OUT] the number of indexed problems            *
+ *                                                                            *
+ * Return value: SUCCEED - the index can be used                              *
+ *               FAIL    - the index is disabled, not loaded or being loaded, *
+ *                         problems must be queried from database             *
+ *                                                                            *
+ * Comments: Loads index from database on cold start or when the sync period  *
+ *           has passed. The index is loaded by one process at a time.        *
+ *                                                                            *
+ ******************************************************************************/
+int	problem_index_sync(int *problems_num)
+{
+	int	now, load = 0, ret;
+
+	if (NULL == problem_index)
+		return FAIL;
+
+	now = (int)time(NULL);
+
+	LOCK_PI;
+
+	if (0 == problem_index->loading && now >= problem_index->sync_time)
+	{
+		problem_index->loading = 1;
+		load = 1;
+	}
+
+	UNLOCK_PI;
+
+	if (0 != load)
+		pi_load(now);
+
+	LOCK_PI;
+
+	/* problems removed during load might still be indexed until the load is finished */
+	if (PROBLEM_INDEX_READY == problem_index->state && 0 == problem_index->loading)
+	{
+		*problems_num = problem_index->problems.num_data;
+		ret = SUCCEED;
+	}
+	else
+		ret = FAIL;
+
+	UNLOCK_PI;
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: copies indexed problem                                            *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_event_problem_t	*pi_problem_dup(const zbx_pi_problem_t *problem)
+{
+	zbx_event_problem_t	*dst;
+
+	dst = (zbx_event_problem_t *)zbx_malloc(NULL, sizeof(zbx_event_problem_t));
+	dst->eventid = problem->eventid;
+	dst->triggerid = problem->triggerid;
+	zbx_vector_tags_ptr_create(&dst->tags);
+	zbx_vector_tags_ptr_reserve(&dst->tags, (size_t)problem->tags_num);
+
+	for (int i = 0; i < problem->tags_num; i++)
+	{
+		zbx_tag_t	*tag;
+
+		tag = (zbx_tag_t *)zbx_malloc(NULL, sizeof(zbx_tag_t));
+		tag->tag = zbx_strdup(NULL, problem->tags[i]->tag->tag);
+		tag->value = zbx_strdup(NULL, problem->tags[i]->value);
+		zbx_vector_tags_ptr_append(&dst->tags, tag);
+	}
+
+	return dst;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets identifiers of problems having tags matching filter          *
+ *                                                                            *
+ * Parameters: filter   - [IN] tag filter                                     *
+ *             eventids - [OUT] problem event identifiers                     *
+ *                                                                            *
+ ******************************************************************************/
+static void	pi_get_eventids(const zbx_problem_tag_filter_t *filter, zbx_vector_uint64_t *eventids)
+{
+	zbx_pi_tag_t	*tag, tag_local = {.tag = filter->tag};
+	zbx_pi_value_t	*value, value_local;
+
+	if (NULL == (tag = (zbx_pi_tag_t *)zbx_hashset_search(&problem_index->tags, &tag_local)))
+		return;
+
+	switch (filter->op)
+	{
+		case ZBX_CONDITION_OPERATOR_EQUAL:
+			value_local.tag = tag;
+			value_local.value = filter->value;
+
+			if (NULL != (value = (zbx_pi_value_t *)zbx_hashset_search(&problem_index->values,
+					&value_local)))
+			{
+				zbx_vector_uint64_append_array(eventids, value->eventids, value->eventids_num);
+			}
+			break;
+		case ZBX_CONDITION_OPERATOR_LIKE:
+		case ZBX_CONDITION_OPERATOR_EXIST:
+			for (int i = 0; i < tag->values_num; i++)
+			{
+				value = tag->values[i];
+
+				if (ZBX_CONDITION_OPERATOR_LIKE == filter->op && SUCCEED != zbx_strmatch_condition(
+						value->value, filter->value, ZBX_CONDITION_OPERATOR_LIKE))
+				{
+					continue;
+				}
+
+				zbx_vector_uint64_append_array(eventids, value->eventids, value->eventids_num);
+			}
+			break;
+		default:
+			THIS_SHOULD_NEVER_HAPPEN;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes problems that are not open in database                    *
+ *                                                                            *
+ * Parameters: problems - [IN/OUT] indexed problems, sorted by eventid        *
+ *                                                                            *
+ * Comments: Problems closed or deleted without updating the index are also   *
+ *           removed from index, unless they were indexed shortly before and  *
+ *           might be not visible to the current transaction yet.             *
+ *                                                                            *
+ ******************************************************************************/
+static void	pi_db_verify_problems(zbx_vector_ptr_t *problems)
+{
+	zbx_vector_uint64_t	eventids, open_eventids;
+	char			*sql = NULL;
+	size_t			sql_alloc = 0, sql_offset = 0;
+	int			i, j;
+
+	if (0 == problems->values_num)
+		return;
+
+	zbx_vector_uint64_create(&eventids);
+	zbx_vector_uint64_create(&open_eventids);
+	zbx_vector_uint64_reserve(&eventids, (size_t)problems->values_num);
+
+	for (i = 0; i < problems->values_num; i++)
+		zbx_vector_uint64_append(&eventids, ((const zbx_event_problem_t *)problems->values[i])->eventid);
+
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, "select eventid from problem where r_eventid is null and");
+	zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "eventid", eventids.values, eventids.values_num);
+	zbx_db_select_uint64(sql, &open_eventids);
+	zbx_free(sql);
+
+	zbx_vector_uint64_clear(&eventids);
+
+	for (i = 0, j = 0; i < problems->values_num; i++)
+	{
+		zbx_event_problem_t	*problem = (zbx_event_problem_t *)problems->values[i];
+
+		if (FAIL != zbx_vector_uint64_bsearch(&open_eventids, problem->eventid,
+				ZBX_DEFAULT_UINT64_COMPARE_FUNC))
+		{
+			problems->values[j++] = problem;
+			continue;
+		}
+
+		zbx_vector_uint64_append(&eventids, problem->eventid);
+		event_problem_free(problem);
+	}
+
+	problems->values_num = j;
+
+	if (0 != eventids.values_num)
+	{
+		int	now;
+
+		now = (int)time(NULL);
+
+		LOCK_PI;
+
+		if (SUCCEED == pi_is_active())
+		{
+			for (i = 0; i < eventids.values_num; i++)
+			{
+				zbx_pi_problem_t	*problem;
+
+				if (NULL == (problem = (zbx_pi_problem_t *)zbx_hashset_search(&problem_index->problems,
+						&eventids.values[i])))
+				{
+					continue;
+				}
+
+				if (problem->lastupdate >= now - PROBLEM_INDEX_SYNC_DELAY)
+					continue;
+
+				if (SUCCEED != pi_problem_remove(eventids.values[i]))
+				{
+					pi_set_oom(now);
+					break;
+				}
+			}
+		}
+
+		UNLOCK_PI;
+	}
+
+	zbx_vector_uint64_destroy(&open_eventids);
+	zbx_vector_uint64_destroy(&eventids);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets indexed problems                                             *
+ *                                                                            *
+ * Parameters: filters  - [IN] tag filters, optional                          *
+ *             problems - [OUT] open problems having tags matching at least   *
+ *                              one of the filters or all open problems if    *
+ *                              filters were not specified, sorted by eventid *
+ *                                                                            *
+ * Return value: SUCCEED - the problems were retrieved                        *
+ *               FAIL    - the index is not loaded or is being loaded         *
+ *                                                                            *
+ * Comments: Indexed problems are verified in database, so correlation        *
+ *           operations are never executed for already closed problems.       *
+ *                                                                            *
+ ******************************************************************************/
+int	problem_index_get_problems(const zbx_vector_problem_tag_filter_t *filters, zbx_vector_ptr_t *problems)
+{
+	zbx_pi_problem_t	*problem;
+	int			ret = FAIL;
+
+	if (NULL == problem_index)
+		return FAIL;
+
+	LOCK_PI;
+
+	if (PROBLEM_INDEX_READY != problem_index->state || 0 != problem_index->loading)
+		goto out;
+
+	if (NULL == filters)
+	{
+		zbx_hashset_iter_t	iter;
+
+		zbx_vector_ptr_reserve(problems, (size_t)problem_index->problems.num_data);
+
+		zbx_hashset_iter_reset(&problem_index->problems, &iter);
+		while (NULL != (problem = (zbx_pi_problem_t *)zbx_hashset_iter_next(&iter)))
+			zbx_vector_ptr_append(problems, pi_problem_dup(problem));
+	}
+	else
+	{
+		zbx_vector_uint64_t	eventids;
+
+		zbx_vector_uint64_create(&eventids);
+
+		for (int i = 0; i < filters->values_num; i++)
+			pi_get_eventids(&filters->values[i], &eventids);
+
+		zbx_vector_uint64_sort(&eventids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+		zbx_vector_uint64_uniq(&eventids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+		for (int i = 0; i < eventids.values_num; i++)
+		{
+			if (NULL != (problem = (zbx_pi_problem_t *)zbx_hashset_search(&problem_index->problems,
+					&eventids.values[i])))
+			{
+				zbx_vector_ptr_append(problems, pi_problem_dup(problem));
+			}
+		}
+
+		zbx_vector_uint64_destroy(&eventids);
+	}
+
+	ret = SUCCEED;
+out:
+	UNLOCK_PI;
+
+	if (SUCCEED == ret)
+	{
+		zbx_vector_ptr_sort(problems, ZBX_DEFAULT_UINT64_PTR_COMPARE_FUNC);
+		pi_db_verify_problems(problems);
+	}
+
+	return ret;
+}
@@ -0,0 +1,55 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#ifndef ZABBIX_PROBLEM_INDEX_H
+#define ZABBIX_PROBLEM_INDEX_H
+
+#include "zbxalgo.h"
+
+/* problem event, used to cache open problems for recovery attempts */
+typedef struct
+{
+	zbx_uint64_t		eventid;
+	zbx_uint64_t		triggerid;
+
+	zbx_vector_tags_ptr_t	tags;
+}
+zbx_event_problem_t;
+
+void	event_problem_free(zbx_event_problem_t *problem);
+
+/* filter of problems having tag with the specified name and value */
+typedef struct
+{
+	const char	*tag;
+	const char	*value;
+
+	/* ZBX_CONDITION_OPERATOR_EQUAL, ZBX_CONDITION_OPERATOR_LIKE or ZBX_CONDITION_OPERATOR_EXIST (any value) */
+	unsigned char	op;
+}
+zbx_problem_tag_filter_t;
+
+ZBX_VECTOR_DECL(problem_tag_filter, zbx_problem_tag_filter_t)
+
+int	zbx_problem_index_init(zbx_uint64_t cache_size, char **error);
+void	zbx_problem_index_destroy(void);
+
+void	zbx_problem_index_remove(const zbx_vector_uint64_t *eventids);
+void	zbx_problem_index_add_tags(zbx_uint64_t eventid, const zbx_vector_tags_ptr_t *tags);
+
+int	problem_index_sync(int *problems_num);
+void	problem_index_add_problems(const zbx_vector_ptr_t *events);
+int	problem_index_get_problems(const zbx_vector_problem_tag_filter_t *filters, zbx_vector_ptr_t *problems);
+
+#endif
@@ -14,6 +14,8 @@
 
 #include "housekeeper_server.h"
 
+#include "../events/problem_index.h"
+
 #include "zbxtimekeeper.h"
 #include "zbxthreads.h"
 #include "zbxlog.h"
@@ -104,6 +106,7 @@ static int	housekeep_problems_without_triggers(void)
 			deleted = ids.values_num;
 
 		housekeep_service_problems(&ids);
+		zbx_problem_index_remove(&ids);
 	}
 fail:
 	zbx_vector_uint64_destroy(&ids);
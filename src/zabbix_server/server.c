@@ -33,6 +33,7 @@
 #include "lld/lld_worker.h"
 #include "reporter/reporter.h"
 #include "events/events.h"
+#include "events/problem_index.h"
 #include "ha/ha.h"
 #include "rtc/rtc_server.h"
 #include "stats/stats_server.h"
@@ -294,6 +295,7 @@ ZBX_GET_CONFIG_VAR2(char *, const char *, zbx_config_source_ip, NULL)
 ZBX_GET_CONFIG_VAR2(char *, const char *, zbx_config_tmpdir, NULL)
 ZBX_GET_CONFIG_VAR2(char *, const char *, zbx_config_fping_location, NULL)
 ZBX_GET_CONFIG_VAR2(char *, const char *, zbx_config_fping6_location, NULL)
+ZBX_GET_CONFIG_VAR(int, zbx_config_native_ping, 0)
 ZBX_GET_CONFIG_VAR2(char *, const char *, zbx_config_alert_scripts_path, NULL)
 ZBX_GET_CONFIG_VAR(int, zbx_config_timeout, 3)
 int	zbx_config_trapper_timeout = 300;
@@ -319,14 +321,19 @@ static int	config_vmware_timeout		= 10;
 static zbx_uint64_t	config_conf_cache_size		= 32 * ZBX_MEBIBYTE;
 static zbx_uint64_t	config_history_cache_size	= 16 * ZBX_MEBIBYTE;
 static zbx_uint64_t	config_history_index_cache_size	= 4 * ZBX_MEBIBYTE;
+static int		config_history_cache_shards	= 1;
 static zbx_uint64_t	config_trends_cache_size	= 4 * ZBX_MEBIBYTE;
+static int		config_trends_flush_period	= 0;
 static zbx_uint64_t	config_trend_func_cache_size	= 4 * ZBX_MEBIBYTE;
 static zbx_uint64_t	config_value_cache_size		= 8 * ZBX_MEBIBYTE;
+static zbx_uint64_t	config_problem_index_cache_size	= 8 * ZBX_MEBIBYTE;
+static zbx_uint64_t	config_preproc_buffer_size	= 0;
 static zbx_uint64_t	config_vmware_cache_size	= 8 * ZBX_MEBIBYTE;
 
 static int	config_unreachable_period		= 45;
 static int	config_unreachable_delay		= 15;
 static int	config_max_concurrent_checks_per_poller	= 1000;
+static int	config_agent_keep_alive			= 0;
 static int	config_log_level		= LOG_LEVEL_WARNING;
 static char	*config_externalscripts		= NULL;
 static int	config_allow_unsupported_db_versions = 0;
@@ -371,6 +378,7 @@ static char	*CONFIG_SOCKET_PATH	= NULL;
 static char	*config_history_storage_url		= NULL;
 static char	*config_history_storage_opts		= NULL;
 static int	config_history_storage_pipelines	= 0;
+static int	config_trigger_eval_threads		= 1;
 static char	*config_stats_allowed_ip		= NULL;
 static int	config_tcp_max_backlog_size		= SOMAXCONN;
 static char	*zbx_config_webservice_url		= NULL;
@@ -392,7 +400,8 @@ static	const zbx_events_funcs_t	events_cbs = {
 	.clean_events_cb		= zbx_clean_events,
 	.reset_event_recovery_cb	= zbx_reset_event_recovery,
 	.export_events_cb		= zbx_export_events,
-	.events_update_itservices_cb	= zbx_events_update_itservices
+	.events_update_itservices_cb	= zbx_events_update_itservices,
+	.events_update_problem_index_cb	= zbx_events_update_problem_index
 };
 
 typedef struct
@@ -739,6 +748,20 @@ static void	zbx_validate_config(ZBX_TASK_EX *task)
 		err = 1;
 	}
 
+	if (0 != config_problem_index_cache_size && 128 * ZBX_KIBIBYTE > config_problem_index_cache_size)
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "\"ProblemIndexCacheSize\" configuration parameter must be either 0"
+				" or greater than 128KB");
+		err = 1;
+	}
+
+	if (0 != config_preproc_buffer_size && 128 * ZBX_KIBIBYTE > config_preproc_buffer_size)
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "\"PreprocessingBufferSize\" configuration parameter must be either 0"
+				" or greater than 128KB");
+		err = 1;
+	}
+
 	if (NULL != zbx_config_source_ip && SUCCEED != zbx_is_supported_ip(zbx_config_source_ip))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "invalid \"SourceIP\" configuration parameter: '%s'", zbx_config_source_ip);
@@ -868,6 +891,8 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 		{"StartDBSyncers",		&config_forks[ZBX_PROCESS_TYPE_HISTSYNCER],
 											ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	1,			100},
+		{"TriggerEvaluationThreads",	&config_trigger_eval_threads,		ZBX_CFG_TYPE_INT,
+				ZBX_CONF_PARM_OPT,	1,			64},
 		{"StartDiscoverers",		&config_forks[ZBX_PROCESS_TYPE_DISCOVERER],
 											ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	0,			1000},
@@ -912,12 +937,18 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 				ZBX_CONF_PARM_OPT,	128 * ZBX_KIBIBYTE,	__UINT64_C(2) * ZBX_GIBIBYTE},
 		{"HistoryIndexCacheSize",	&config_history_index_cache_size,	ZBX_CFG_TYPE_UINT64,
 				ZBX_CONF_PARM_OPT,	128 * ZBX_KIBIBYTE,	__UINT64_C(2) * ZBX_GIBIBYTE},
+		{"HistoryCacheShards",		&config_history_cache_shards,		ZBX_CFG_TYPE_INT,
+				ZBX_CONF_PARM_OPT,	1,			ZBX_HC_SHARDS_MAX},
 		{"TrendCacheSize",		&config_trends_cache_size,		ZBX_CFG_TYPE_UINT64,
 				ZBX_CONF_PARM_OPT,	128 * ZBX_KIBIBYTE,	__UINT64_C(2) * ZBX_GIBIBYTE},
+		{"TrendFlushPeriod",		&config_trends_flush_period,		ZBX_CFG_TYPE_INT,
+				ZBX_CONF_PARM_OPT,	0,			50 * SEC_PER_MIN},
 		{"TrendFunctionCacheSize",	&config_trend_func_cache_size,		ZBX_CFG_TYPE_UINT64,
 				ZBX_CONF_PARM_OPT,	0,			__UINT64_C(2) * ZBX_GIBIBYTE},
 		{"ValueCacheSize",		&config_value_cache_size,		ZBX_CFG_TYPE_UINT64,
 				ZBX_CONF_PARM_OPT,	0,			__UINT64_C(64) * ZBX_GIBIBYTE},
+		{"ProblemIndexCacheSize",	&config_problem_index_cache_size,	ZBX_CFG_TYPE_UINT64,
+				ZBX_CONF_PARM_OPT,	0,			__UINT64_C(2) * ZBX_GIBIBYTE},
 		{"CacheUpdateFrequency",	&config_confsyncer_frequency,		ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	1,			SEC_PER_HOUR},
 		{"HousekeepingFrequency",	&config_housekeeping_frequency,		ZBX_CFG_TYPE_INT,
@@ -930,6 +961,8 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 				ZBX_CONF_PARM_OPT,	0,			0},
 		{"Fping6Location",		&zbx_config_fping6_location,		ZBX_CFG_TYPE_STRING,
 				ZBX_CONF_PARM_OPT,	0,			0},
+		{"NativePing",			&zbx_config_native_ping,		ZBX_CFG_TYPE_INT,
+				ZBX_CONF_PARM_OPT,	0,			1},
 		{"Timeout",			&zbx_config_timeout,			ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	1,			30},
 		{"TrapperTimeout",		&zbx_config_trapper_timeout,		ZBX_CFG_TYPE_INT,
@@ -989,6 +1022,9 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 				ZBX_CONF_PARM_OPT,	0,			0},
 		{"DBPort",			&(zbx_config_dbhigh->config_dbport),	ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	1024,			65535},
+		{"DBPreparedStatements",	&(zbx_config_dbhigh->config_db_prepared_statements),
+											ZBX_CFG_TYPE_INT,
+				ZBX_CONF_PARM_OPT,	0,			1},
 		{"AllowUnsupportedDBVersions",	&config_allow_unsupported_db_versions,	ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	0,			1},
 		{"DBTLSConnect",		&(zbx_config_dbhigh->config_db_tls_connect),
@@ -1072,6 +1108,8 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 		{"StartPreprocessors",		&config_forks[ZBX_PROCESS_TYPE_PREPROCESSOR],
 											ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	1,			1000},
+		{"PreprocessingBufferSize",	&config_preproc_buffer_size,		ZBX_CFG_TYPE_UINT64,
+				ZBX_CONF_PARM_OPT,	0,			__UINT64_C(2) * ZBX_GIBIBYTE},
 		{"HistoryStorageURL",		&config_history_storage_url,		ZBX_CFG_TYPE_STRING,
 				ZBX_CONF_PARM_OPT,	0,			0},
 		{"HistoryStorageTypes",		&config_history_storage_opts,		ZBX_CFG_TYPE_STRING_LIST,
@@ -1128,6 +1166,8 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 						&config_max_concurrent_checks_per_poller,
 											ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	1,			1000},
+		{"AgentKeepAlive",		&config_agent_keep_alive,		ZBX_CFG_TYPE_INT,
+				ZBX_CONF_PARM_OPT,	0,			30},
 		{"VPSLimit",			&config_vps_limit,			ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	0,			ZBX_MEBIBYTE},
 		{"VPSOvercommitLimit",		&config_vps_overcommit_limit,		ZBX_CFG_TYPE_INT,
@@ -1211,6 +1251,8 @@ static void	zbx_on_exit(int ret, void *on_exit_args)
 		/* free history value cache */
 		zbx_vc_destroy();
 
+		zbx_pp_buffer_destroy();
+
 		zbx_deinit_remote_commands_cache();
 
 		/* free vmware support */
@@ -1271,7 +1313,8 @@ int	main(int argc, char **argv)
 		get_zbx_config_fping_location,
 		get_zbx_config_fping6_location,
 		get_zbx_config_tmpdir,
-		get_zbx_progname};
+		get_zbx_progname,
+		get_zbx_config_native_ping};
 
 	ZBX_TASK_EX			t = {ZBX_TASK_START, 0, 0, NULL};
 	char				ch;
@@ -1390,6 +1433,7 @@ int	main(int argc, char **argv)
 		printf("Validating configuration file \"%s\"\n", config_file);
 
 	zbx_load_config(&t);
+	zbx_set_trigger_eval_threads(config_trigger_eval_threads);
 
 	if (ZBX_TASK_TEST_CONFIG == t.task)
 	{
@@ -1540,7 +1584,8 @@ static int	server_startup(zbx_socket_t *listen_sock, int *ha_stat, int *ha_failo
 	zbx_thread_poller_args		poller_args = {&config_comms, get_zbx_program_type, get_zbx_progname,
 							ZBX_NO_POLLER, config_startup_time, config_unavailable_delay,
 							config_unreachable_period, config_unreachable_delay,
-							config_max_concurrent_checks_per_poller, get_config_forks,
+							config_max_concurrent_checks_per_poller,
+							config_agent_keep_alive, get_config_forks,
 							config_java_gateway, config_java_gateway_port,
 							config_externalscripts, zbx_get_value_internal_ext_server,
 							config_ssh_key_location, config_webdriver_url};
@@ -1602,13 +1647,15 @@ static int	server_startup(zbx_socket_t *listen_sock, int *ha_stat, int *ha_failo
 									config_ssl_cert_location,
 									config_ssl_key_location};
 	zbx_thread_report_manager_args	report_manager_args = {get_config_forks};
-	zbx_thread_alert_syncer_args	alert_syncer_args = {config_confsyncer_frequency};
+	zbx_thread_alert_syncer_args	alert_syncer_args = {config_confsyncer_frequency,
+							zbx_problem_index_add_tags};
 	zbx_thread_alert_manager_args	alert_manager_args = {get_config_forks, get_zbx_config_alert_scripts_path,
 								zbx_config_dbhigh, zbx_config_source_ip};
 	zbx_thread_lld_manager_args	lld_manager_args = {get_config_forks};
 	zbx_thread_connector_manager_args	connector_manager_args = {get_config_forks};
 	zbx_thread_dbsyncer_args		dbsyncer_args = {&events_cbs, config_histsyncer_frequency,
-								zbx_config_timeout, config_history_storage_pipelines};
+								zbx_config_timeout, config_history_storage_pipelines,
+								get_config_forks};
 	zbx_thread_vmware_args			vmware_args = {zbx_config_source_ip, config_vmware_frequency,
 								config_vmware_perf_frequency, config_vmware_timeout};
 	zbx_thread_timer_args		timer_args = {get_config_forks};
@@ -1619,7 +1666,8 @@ static int	server_startup(zbx_socket_t *listen_sock, int *ha_stat, int *ha_failo
 								config_service_manager_sync_frequency};
 
 	if (SUCCEED != zbx_init_database_cache(get_zbx_program_type, zbx_sync_server_history, config_history_cache_size,
-			config_history_index_cache_size, &config_trends_cache_size, &error))
+			config_history_index_cache_size, config_history_cache_shards, &config_trends_cache_size,
+			config_trends_flush_period, &error))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize database cache: %s", error);
 		zbx_free(error);
@@ -1664,6 +1712,20 @@ static int	server_startup(zbx_socket_t *listen_sock, int *ha_stat, int *ha_failo
 		return FAIL;
 	}
 
+	if (SUCCEED != zbx_problem_index_init(config_problem_index_cache_size, &error))
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize problem index cache: %s", error);
+		zbx_free(error);
+		return FAIL;
+	}
+
+	if (SUCCEED != zbx_pp_buffer_init(config_preproc_buffer_size, &error))
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize preprocessing buffer: %s", error);
+		zbx_free(error);
+		return FAIL;
+	}
+
 	if (0 != config_forks[ZBX_PROCESS_TYPE_CONNECTORMANAGER])
 		zbx_connector_init();
 
@@ -2031,7 +2093,9 @@ static void	server_teardown(zbx_rtc_t *rtc, zbx_socket_t *listen_sock)
 
 	/* destroy shared caches */
 	zbx_tfc_destroy();
+	zbx_problem_index_destroy();
 	zbx_vc_destroy();
+	zbx_pp_buffer_destroy();
 	zbx_vmware_destroy();
 	zbx_free_selfmon_collector();
 	zbx_free_configuration_cache();
@@ -2293,7 +2357,8 @@ int	MAIN_ZABBIX_ENTRY(int flags)
 	}
 
 	if (SUCCEED != zbx_init_database_cache(get_zbx_program_type, zbx_sync_server_history, config_history_cache_size,
-			config_history_index_cache_size, &config_trends_cache_size, &error))
+			config_history_index_cache_size, config_history_cache_shards, &config_trends_cache_size,
+			config_trends_flush_period, &error))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize database cache: %s", error);
 		zbx_free(error);
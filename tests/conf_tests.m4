@@ -83,10 +83,15 @@ AC_DEFUN([CONF_TESTS],
 			tests/libs/zbxvariant/Makefile
 			tests/libs/zbxxml/Makefile
 			tests/zabbix_server/Makefile
+			tests/zabbix_server/cachehistory/Makefile
+			tests/zabbix_server/events/Makefile
 			tests/zabbix_server/pinger/Makefile
 			tests/zabbix_server/service/Makefile
 			tests/zabbix_server/trapper/Makefile
 			tests/zabbix_server/lld/Makefile
+			tests/zabbix_agent/Makefile
+			tests/zabbix_agent/active_checks/Makefile
+			tests/zabbix_agent/listener/Makefile
 			tests/mocks/Makefile
 			tests/mocks/configcache/Makefile
 			tests/mocks/valuecache/Makefile
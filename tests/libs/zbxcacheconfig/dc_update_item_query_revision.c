@@ -0,0 +1,94 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxcommon.h"
+
+int	zbx_dc_update_item_query_revision(zbx_uint64_t update_flags, zbx_uint64_t hgroup_host_changes,
+		zbx_uint64_t item_tag_changes, zbx_uint64_t host_tag_changes, zbx_uint64_t htmpl_changes);
+
+/* copied from zbxcacheconfig/dbsync.h */
+#define ZBX_DBSYNC_UPDATE_HOSTS			__UINT64_C(0x0001)
+#define ZBX_DBSYNC_UPDATE_ITEMS			__UINT64_C(0x0002)
+#define ZBX_DBSYNC_UPDATE_FUNCTIONS		__UINT64_C(0x0004)
+#define ZBX_DBSYNC_UPDATE_TRIGGERS		__UINT64_C(0x0008)
+#define ZBX_DBSYNC_UPDATE_HOST_GROUPS		__UINT64_C(0x0020)
+#define ZBX_DBSYNC_UPDATE_MACROS		__UINT64_C(0x0080)
+
+static zbx_uint64_t	str_to_update_flag(const char *str)
+{
+	if (0 == strcmp(str, "ZBX_DBSYNC_UPDATE_HOSTS"))
+		return ZBX_DBSYNC_UPDATE_HOSTS;
+	if (0 == strcmp(str, "ZBX_DBSYNC_UPDATE_ITEMS"))
+		return ZBX_DBSYNC_UPDATE_ITEMS;
+	if (0 == strcmp(str, "ZBX_DBSYNC_UPDATE_FUNCTIONS"))
+		return ZBX_DBSYNC_UPDATE_FUNCTIONS;
+	if (0 == strcmp(str, "ZBX_DBSYNC_UPDATE_TRIGGERS"))
+		return ZBX_DBSYNC_UPDATE_TRIGGERS;
+	if (0 == strcmp(str, "ZBX_DBSYNC_UPDATE_HOST_GROUPS"))
+		return ZBX_DBSYNC_UPDATE_HOST_GROUPS;
+	if (0 == strcmp(str, "ZBX_DBSYNC_UPDATE_MACROS"))
+		return ZBX_DBSYNC_UPDATE_MACROS;
+
+	fail_msg("unknown update flag: %s", str);
+
+	return 0;
+}
+
+static zbx_uint64_t	mock_get_changes(const char *name)
+{
+	zbx_mock_handle_t	hchanges;
+	zbx_uint64_t		changes;
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_parameter(name, &hchanges))
+		return 0;
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_uint64(hchanges, &changes))
+		fail_msg("invalid %s value", name);
+
+	return changes;
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_mock_handle_t	hflags, hflag;
+	zbx_mock_error_t	err;
+	zbx_uint64_t		update_flags = 0;
+	int			ret;
+
+	ZBX_UNUSED(state);
+
+	hflags = zbx_mock_get_parameter_handle("in.flags");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hflags, &hflag))))
+	{
+		const char	*flag;
+
+		if (ZBX_MOCK_SUCCESS != err || ZBX_MOCK_SUCCESS != (err = zbx_mock_string(hflag, &flag)))
+			fail_msg("Cannot read update flag: %s", zbx_mock_error_string(err));
+
+		update_flags |= str_to_update_flag(flag);
+	}
+
+	ret = zbx_dc_update_item_query_revision(update_flags, mock_get_changes("in.hgroup_host"),
+			mock_get_changes("in.item_tag"), mock_get_changes("in.host_tag"),
+			mock_get_changes("in.host_template"));
+
+	zbx_mock_assert_result_eq("item query revision update", zbx_mock_str_to_return_code(
+			zbx_mock_get_parameter_string("out.result")), ret);
+}
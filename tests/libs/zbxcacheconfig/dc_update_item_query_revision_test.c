@@ -0,0 +1,44 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+int	zbx_dc_update_item_query_revision(zbx_uint64_t update_flags, zbx_uint64_t hgroup_host_changes,
+		zbx_uint64_t item_tag_changes, zbx_uint64_t host_tag_changes, zbx_uint64_t htmpl_changes);
+
+int	zbx_dc_update_item_query_revision(zbx_uint64_t update_flags, zbx_uint64_t hgroup_host_changes,
+		zbx_uint64_t item_tag_changes, zbx_uint64_t host_tag_changes, zbx_uint64_t htmpl_changes)
+{
+	zbx_dc_config_t	*config_orig = config, config_local;
+	zbx_dbsync_t	hgroup_host_sync, item_tag_sync, host_tag_sync, htmpl_sync;
+
+	memset(&hgroup_host_sync, 0, sizeof(zbx_dbsync_t));
+	memset(&item_tag_sync, 0, sizeof(zbx_dbsync_t));
+	memset(&host_tag_sync, 0, sizeof(zbx_dbsync_t));
+	memset(&htmpl_sync, 0, sizeof(zbx_dbsync_t));
+
+	hgroup_host_sync.update_num = hgroup_host_changes;
+	item_tag_sync.update_num = item_tag_changes;
+	host_tag_sync.update_num = host_tag_changes;
+	htmpl_sync.update_num = htmpl_changes;
+
+	memset(&config_local, 0, sizeof(zbx_dc_config_t));
+	config_local.revision.item_query = 1;
+	config = &config_local;
+
+	dc_update_item_query_revision(update_flags, &hgroup_host_sync, &item_tag_sync, &host_tag_sync, &htmpl_sync,
+			2);
+
+	config = config_orig;
+
+	return 2 == config_local.revision.item_query ? SUCCEED : FAIL;
+}
@@ -16,6 +16,7 @@
 
 #include "valuecache_test.h"
 #include "zbxmocktest.h"
+#include "zbxmockassert.h"
 
 void	zbx_vc_set_mode(int mode)
 {
@@ -37,8 +38,10 @@ int	zbx_vc_get_cached_values(zbx_uint64_t itemid, unsigned char value_type, zbx_
 
 	for (chunk = item->tail; NULL != chunk; chunk = chunk->next)
 	{
+		zbx_history_record_t	*slots = vch_chunk_get_slots(chunk);
+
 		for (i = chunk->first_value; i <= chunk->last_value; i++)
-			vc_history_record_vector_append(values, value_type, &chunk->slots[i]);
+			vc_history_record_vector_append(values, value_type, &slots[i]);
 	}
 
 	return SUCCEED;
@@ -72,6 +75,32 @@ int	zbx_vc_precache_values(zbx_uint64_t itemid, int value_type, int seconds, int
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns the number of item chunks with valid stored aggregates    *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_vc_get_sealed_chunks(zbx_uint64_t itemid)
+{
+	zbx_vc_item_t	*item;
+	zbx_vc_chunk_t	*chunk;
+	int		sealed = 0;
+
+	if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)))
+		return 0;
+
+	for (chunk = item->tail; NULL != chunk; chunk = chunk->next)
+	{
+		if (0 != chunk->summary.values_num &&
+				chunk->summary.values_num == chunk->last_value - chunk->first_value + 1)
+		{
+			sealed++;
+		}
+	}
+
+	return sealed;
+}
+
 int	zbx_vc_get_item_state(zbx_uint64_t itemid, int *status, int *active_range, int *values_total,
 		int *db_cached_from)
 {
@@ -103,6 +132,79 @@ int	zbx_vc_get_cache_state(int *mode, zbx_uint64_t *hits, zbx_uint64_t *misses)
 	return SUCCEED;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: packs values into value cache chunk and reads them back           *
+ *                                                                            *
+ * Parameters: value_type - [IN] the value type                               *
+ *             values     - [IN] the values to pack                           *
+ *             decoded    - [OUT] the values encoded into bit stream and      *
+ *                                decoded back, numeric values only           *
+ *             unpacked   - [OUT] the values read from the packed chunk       *
+ *                                                                            *
+ * Return value: SUCCEED - the chunk was packed                               *
+ *               FAIL    - the chunk was left unpacked                        *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_vc_pack_values(unsigned char value_type, const zbx_vector_history_record_t *values,
+		zbx_vector_history_record_t *decoded, zbx_vector_history_record_t *unpacked)
+{
+	zbx_vc_item_t		item = {.value_type = value_type};
+	zbx_vc_chunk_t		*chunk;
+	zbx_history_record_t	*slots;
+	int			i, ret;
+
+	if (ITEM_VALUE_TYPE_FLOAT == value_type || ITEM_VALUE_TYPE_UINT64 == value_type)
+	{
+		unsigned char	*data;
+
+		data = (unsigned char *)zbx_malloc(NULL, ((size_t)values->values_num *
+				ZBX_VC_PACKED_VALUE_BITS_MAX + 7) >> 3);
+		memset(data, 0, ((size_t)values->values_num * ZBX_VC_PACKED_VALUE_BITS_MAX + 7) >> 3);
+
+		vch_values_encode(values->values, values->values_num, data);
+		zbx_vector_history_record_reserve(decoded, (size_t)values->values_num);
+		vch_values_decode(data, values->values_num, decoded->values);
+		decoded->values_num = values->values_num;
+
+		zbx_free(data);
+	}
+
+	chunk = (zbx_vc_chunk_t *)__vc_shmem_malloc_func(NULL, sizeof(zbx_vc_chunk_t) +
+			sizeof(zbx_history_record_t) * (size_t)(values->values_num - 1));
+	memset(chunk, 0, sizeof(zbx_vc_chunk_t));
+
+	chunk->first_value = 0;
+	chunk->last_value = values->values_num - 1;
+	chunk->slots_num = values->values_num;
+	memcpy(chunk->slots, values->values, sizeof(zbx_history_record_t) * (size_t)values->values_num);
+
+	item.head = item.tail = chunk;
+	item.values_total = values->values_num;
+
+	vch_item_pack_chunk(&item, chunk);
+	chunk = item.head;
+
+	ret = (0 != chunk->packed_size ? SUCCEED : FAIL);
+
+	/* the second read must return the same values from decoded chunk cache */
+	slots = vch_chunk_get_slots(chunk);
+	zbx_mock_assert_ptr_eq("decoded chunk", slots, vch_chunk_get_slots(chunk));
+
+	for (i = chunk->first_value; i <= chunk->last_value; i++)
+		vc_history_record_vector_append(unpacked, value_type, &slots[i]);
+
+	zbx_mock_assert_int_eq("first value seconds", values->values[0].timestamp.sec,
+			vch_chunk_first(chunk)->timestamp.sec);
+	zbx_mock_assert_int_eq("last value seconds", values->values[values->values_num - 1].timestamp.sec,
+			vch_chunk_last(chunk)->timestamp.sec);
+
+	/* string values are shared with the input vector and must not be freed */
+	__vc_shmem_free_func(chunk);
+
+	return ret;
+}
+
 /*
  * cache working mode handling
  */
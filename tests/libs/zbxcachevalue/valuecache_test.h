@@ -20,9 +20,12 @@
 void	zbx_vc_set_mode(int mode);
 int	zbx_vc_get_cached_values(zbx_uint64_t itemid, unsigned char value_type, zbx_vector_history_record_t *values);
 int	zbx_vc_precache_values(zbx_uint64_t itemid, int value_type, int seconds, int count, const zbx_timespec_t *ts);
+int	zbx_vc_get_sealed_chunks(zbx_uint64_t itemid);
 int	zbx_vc_get_item_state(zbx_uint64_t itemid, int *status, int *active_range, int *values_total,
 		int *db_cached_from);
 int	zbx_vc_get_cache_state(int *mode, zbx_uint64_t *hits, zbx_uint64_t *misses);
+int	zbx_vc_pack_values(unsigned char value_type, const zbx_vector_history_record_t *values,
+		zbx_vector_history_record_t *decoded, zbx_vector_history_record_t *unpacked);
 
 void	zbx_vcmock_set_mode(zbx_mock_handle_t hitem, const char *key);
 int	zbx_vcmock_str_to_cache_mode(const char *mode);
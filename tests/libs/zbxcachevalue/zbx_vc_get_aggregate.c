@@ -0,0 +1,177 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxmutexs.h"
+#include "zbxcachevalue.h"
+#include "valuecache_test.h"
+#include "mocks/valuecache/valuecache_mock.h"
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculates aggregates of values returned by zbx_vc_get_values()   *
+ *                                                                            *
+ ******************************************************************************/
+static void	mock_aggregate_values(unsigned char value_type, const zbx_vector_history_record_t *values,
+		zbx_vc_aggregate_t *aggr)
+{
+	memset(aggr, 0, sizeof(zbx_vc_aggregate_t));
+
+	for (int i = 0; i < values->values_num; i++)
+	{
+		const zbx_history_value_t	*value = &values->values[i].value;
+
+		if (ITEM_VALUE_TYPE_FLOAT == value_type)
+		{
+			if (0 == i || value->dbl < aggr->min.dbl)
+				aggr->min.dbl = value->dbl;
+
+			if (0 == i || value->dbl > aggr->max.dbl)
+				aggr->max.dbl = value->dbl;
+
+			aggr->sum.dbl += value->dbl;
+		}
+		else if (ITEM_VALUE_TYPE_UINT64 == value_type)
+		{
+			if (0 == i || value->ui64 < aggr->min.ui64)
+				aggr->min.ui64 = value->ui64;
+
+			if (0 == i || value->ui64 > aggr->max.ui64)
+				aggr->max.ui64 = value->ui64;
+
+			aggr->sum.ui64 += value->ui64;
+		}
+	}
+
+	if (0 != (aggr->values_num = values->values_num))
+	{
+		if (ITEM_VALUE_TYPE_FLOAT == value_type)
+			aggr->avg = aggr->sum.dbl / aggr->values_num;
+		else if (ITEM_VALUE_TYPE_UINT64 == value_type)
+			aggr->avg = (double)aggr->sum.ui64 / aggr->values_num;
+	}
+}
+
+static void	mock_assert_double_near(const char *prefix, double expected, double returned)
+{
+	/* running average and the sum of chunk sums are rounded differently than plain sum */
+	if (1e-9 * MAX(1.0, fabs(expected)) < fabs(expected - returned))
+		fail_msg("%s: expected value \"%.17g\" while got \"%.17g\"", prefix, expected, returned);
+}
+
+static void	mock_check_aggregate(unsigned char value_type, const zbx_vc_aggregate_t *expected,
+		const zbx_vc_aggregate_t *returned)
+{
+	zbx_mock_assert_int_eq("count", expected->values_num, returned->values_num);
+
+	if (0 == expected->values_num)
+		return;
+
+	if (ITEM_VALUE_TYPE_FLOAT == value_type)
+	{
+		zbx_mock_assert_double_eq("min", expected->min.dbl, returned->min.dbl);
+		zbx_mock_assert_double_eq("max", expected->max.dbl, returned->max.dbl);
+		mock_assert_double_near("sum", expected->sum.dbl, returned->sum.dbl);
+		mock_assert_double_near("avg", expected->avg, returned->avg);
+	}
+	else if (ITEM_VALUE_TYPE_UINT64 == value_type)
+	{
+		zbx_mock_assert_uint64_eq("min", expected->min.ui64, returned->min.ui64);
+		zbx_mock_assert_uint64_eq("max", expected->max.ui64, returned->max.ui64);
+		zbx_mock_assert_uint64_eq("sum", expected->sum.ui64, returned->sum.ui64);
+		mock_assert_double_near("avg", expected->avg, returned->avg);
+	}
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	int				err, seconds, count;
+	char				*error = NULL;
+	unsigned char			value_type;
+	zbx_uint64_t			itemid;
+	zbx_timespec_t			ts;
+	zbx_mock_handle_t		handle, hrequest;
+	zbx_mock_error_t		mock_err;
+	zbx_vector_history_record_t	values;
+
+	ZBX_UNUSED(state);
+
+	err = zbx_locks_create(&error);
+	zbx_mock_assert_result_eq("Lock initialization failed", SUCCEED, err);
+
+	err = zbx_vc_init(ZBX_MEBIBYTE, &error);
+	zbx_mock_assert_result_eq("Value cache initialization failed", SUCCEED, err);
+
+	zbx_vc_enable();
+
+	zbx_vcmock_ds_init();
+	zbx_history_record_vector_create(&values);
+
+	/* precache values, so that requests start and end inside chunks with stored aggregates */
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter("in.precache", &handle))
+	{
+		while (ZBX_MOCK_END_OF_VECTOR != (mock_err = (zbx_mock_vector_element(handle, &hrequest))))
+		{
+			zbx_vcmock_set_time(hrequest, "time");
+
+			zbx_vcmock_get_request_params(hrequest, &itemid, &value_type, &seconds, &count, &ts);
+			zbx_vc_precache_values(itemid, value_type, seconds, count, &ts);
+
+			zbx_mock_assert_int_eq("sealed chunks",
+					(int)zbx_mock_get_object_member_uint64(hrequest, "sealed chunks"),
+					zbx_vc_get_sealed_chunks(itemid));
+		}
+	}
+
+	handle = zbx_mock_get_parameter_handle("in.requests");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (mock_err = (zbx_mock_vector_element(handle, &hrequest))))
+	{
+		zbx_vc_aggregate_t	aggr, expected;
+
+		if (ZBX_MOCK_SUCCESS != mock_err)
+			fail_msg("Cannot read request: %s", zbx_mock_error_string(mock_err));
+
+		zbx_vcmock_set_time(hrequest, "time");
+		zbx_vcmock_set_mode(hrequest, "cache mode");
+
+		zbx_vcmock_get_request_params(hrequest, &itemid, &value_type, &seconds, &count, &ts);
+
+		err = zbx_vc_get_aggregate(itemid, value_type, seconds, count, &ts, &aggr);
+		zbx_mock_assert_result_eq("zbx_vc_get_aggregate() return value", SUCCEED, err);
+
+		/* aggregates must match the ones calculated from the values of the same range */
+		err = zbx_vc_get_values(itemid, value_type, &values, seconds, count, &ts);
+		zbx_mock_assert_result_eq("zbx_vc_get_values() return value", SUCCEED, err);
+
+		zbx_mock_assert_int_eq("values", (int)zbx_mock_get_object_member_uint64(hrequest, "values"),
+				values.values_num);
+
+		mock_aggregate_values(value_type, &values, &expected);
+		mock_check_aggregate(value_type, &expected, &aggr);
+
+		zbx_history_record_vector_clean(&values, value_type);
+	}
+
+	zbx_history_record_vector_destroy(&values, value_type);
+
+	zbx_vcmock_ds_destroy();
+
+	zbx_vc_reset();
+	zbx_vc_destroy();
+}
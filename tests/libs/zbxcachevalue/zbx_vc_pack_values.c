@@ -0,0 +1,59 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxmutexs.h"
+#include "zbxcachevalue.h"
+#include "valuecache_test.h"
+#include "mocks/valuecache/valuecache_mock.h"
+
+void	zbx_mock_test_entry(void **state)
+{
+	int				err;
+	char				*error = NULL;
+	unsigned char			value_type;
+	zbx_vector_history_record_t	values, decoded, unpacked;
+
+	ZBX_UNUSED(state);
+
+	err = zbx_locks_create(&error);
+	zbx_mock_assert_result_eq("Lock initialization failed", SUCCEED, err);
+
+	err = zbx_vc_init(ZBX_MEBIBYTE, &error);
+	zbx_mock_assert_result_eq("Value cache initialization failed", SUCCEED, err);
+
+	zbx_history_record_vector_create(&values);
+	zbx_history_record_vector_create(&decoded);
+	zbx_history_record_vector_create(&unpacked);
+
+	value_type = zbx_mock_str_to_value_type(zbx_mock_get_parameter_string("in.value type"));
+	zbx_vcmock_read_values(zbx_mock_get_parameter_handle("in.values"), value_type, &values);
+
+	err = zbx_vc_pack_values(value_type, &values, &decoded, &unpacked);
+	zbx_mock_assert_result_eq("zbx_vc_pack_values()",
+			zbx_mock_str_to_return_code(zbx_mock_get_parameter_string("out.packed")), err);
+
+	if (ITEM_VALUE_TYPE_FLOAT == value_type || ITEM_VALUE_TYPE_UINT64 == value_type)
+		zbx_vcmock_check_records("Decoded values", value_type, &values, &decoded);
+
+	zbx_vcmock_check_records("Unpacked values", value_type, &values, &unpacked);
+
+	zbx_history_record_vector_destroy(&unpacked, value_type);
+	zbx_history_record_vector_destroy(&decoded, value_type);
+	zbx_history_record_vector_destroy(&values, value_type);
+}
@@ -0,0 +1,101 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxcommon.h"
+#include "zbxeval.h"
+#include "zbxvariant.h"
+#include "mock_eval.h"
+
+/* function results are numeric values, while mocked token values are strings */
+static void	mock_convert_functionid_values(zbx_eval_context_t *ctx)
+{
+	int	i;
+
+	for (i = 0; i < ctx->stack.values_num; i++)
+	{
+		zbx_eval_token_t	*token = &ctx->stack.values[i];
+
+		if (ZBX_EVAL_TOKEN_FUNCTIONID != token->type || ZBX_VARIANT_STR != token->value.type)
+			continue;
+
+		if (SUCCEED != zbx_variant_convert(&token->value, ZBX_VARIANT_UI64))
+			zbx_variant_convert(&token->value, ZBX_VARIANT_DBL);
+	}
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_eval_context_t	ctx;
+	zbx_eval_code_t		*code;
+	char			*error = NULL;
+	zbx_uint64_t		rules;
+	int			expected_ret, returned_ret;
+	double			result;
+	zbx_variant_t		value;
+
+	ZBX_UNUSED(state);
+
+	rules = mock_eval_read_rules("in.rules");
+
+	if (SUCCEED != zbx_eval_parse_expression(&ctx, zbx_mock_get_parameter_string("in.expression"), rules,
+			&error))
+	{
+		fail_msg("failed to parse expression: %s", error);
+	}
+
+	code = zbx_eval_compile(&ctx, NULL);
+
+	expected_ret = zbx_mock_str_to_return_code(zbx_mock_get_parameter_string("out.compiled"));
+	zbx_mock_assert_result_eq("compilation result", expected_ret, NULL != code ? SUCCEED : FAIL);
+
+	if (NULL == code)
+		goto out;
+
+	mock_eval_read_values(&ctx, "in.replace");
+	mock_convert_functionid_values(&ctx);
+
+	expected_ret = zbx_mock_str_to_return_code(zbx_mock_get_parameter_string("out.result"));
+	returned_ret = zbx_eval_execute_code(&ctx, code, &result);
+	zbx_mock_assert_result_eq("return value", expected_ret, returned_ret);
+
+	if (SUCCEED == returned_ret)
+	{
+		double	expected_value;
+
+		expected_value = atof(zbx_mock_get_parameter_string("out.value"));
+
+		if (1e-12 < fabs(result - expected_value))
+			fail_msg("Expected value \"%f\" while got \"%f\"", expected_value, result);
+
+		/* compiled code results must match interpreter results */
+		if (SUCCEED != zbx_eval_execute(&ctx, NULL, &value, &error))
+			fail_msg("failed to evaluate expression: %s", error);
+
+		if (SUCCEED != zbx_variant_convert(&value, ZBX_VARIANT_DBL))
+			fail_msg("cannot convert expression result \"%s\"", zbx_variant_value_desc(&value));
+
+		if (1e-12 < fabs(result - value.data.dbl))
+			fail_msg("Interpreter returned \"%f\" while compiled code \"%f\"", value.data.dbl, result);
+	}
+
+	zbx_free(code);
+out:
+	zbx_free(error);
+	zbx_eval_clear(&ctx);
+}
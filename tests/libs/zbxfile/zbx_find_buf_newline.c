@@ -0,0 +1,78 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxfile.h"
+
+#include "zbxcommon.h"
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+static void	mock_get_binary(const char *path, const char **value, size_t *length)
+{
+	zbx_mock_error_t	err;
+
+	if (ZBX_MOCK_SUCCESS != (err = zbx_mock_binary(zbx_mock_get_parameter_handle(path), value, length)))
+		fail_msg("Cannot read \"%s\": %s", path, zbx_mock_error_string(err));
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	const char	*encoding, *data, *cr, *lf, *expected;
+	char		*buf, *p, *p_nl, *p_next = NULL;
+	size_t		data_len, expected_len, szbyte, offset;
+
+	ZBX_UNUSED(state);
+
+	encoding = zbx_mock_get_parameter_string("in.encoding");
+	mock_get_binary("in.buffer", &data, &data_len);
+	offset = (size_t)zbx_mock_get_parameter_uint64("in.offset");
+
+	if (offset > data_len)
+		fail_msg("offset " ZBX_FS_SIZE_T " is outside of buffer", (zbx_fs_size_t)offset);
+
+	zbx_find_cr_lf_szbyte(encoding, &cr, &lf, &szbyte);
+
+	/* copy to aligned buffer so that the offset defines alignment of the scanned data */
+	buf = (char *)zbx_malloc(NULL, data_len + 1);
+	memcpy(buf, data, data_len);
+	p = buf + offset;
+
+	p_nl = zbx_find_buf_newline(p, &p_next, buf + data_len, cr, lf, szbyte);
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter_exists("out.newline"))
+	{
+		zbx_mock_assert_ptr_ne("newline", NULL, p_nl);
+		zbx_mock_assert_int_eq("newline offset", (int)zbx_mock_get_parameter_uint64("out.newline"),
+				(int)(p_nl - buf));
+		zbx_mock_assert_int_eq("next line offset", (int)zbx_mock_get_parameter_uint64("out.next"),
+				(int)(p_next - buf));
+	}
+	else
+		zbx_mock_assert_ptr_eq("newline", NULL, p_nl);
+
+	/* null characters before the newline are replaced */
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter_exists("out.buffer"))
+	{
+		mock_get_binary("out.buffer", &expected, &expected_len);
+		zbx_mock_assert_int_eq("buffer size", (int)expected_len, (int)data_len);
+
+		if (0 != memcmp(expected, buf, data_len))
+			fail_msg("unexpected buffer contents");
+	}
+
+	zbx_free(buf);
+}
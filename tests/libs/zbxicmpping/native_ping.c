@@ -0,0 +1,59 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "../../../src/libs/zbxicmpping/icmpping_native.c"
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_fping_host_t	host;
+	char			error[MAX_STRING_LEN];
+	int			ret, count;
+
+	ZBX_UNUSED(state);
+
+#ifndef HAVE_IPV6
+	if (0 == strcmp(zbx_mock_get_parameter_string("in.family"), "ipv6"))
+		skip();
+#endif
+	memset(&host, 0, sizeof(host));
+	host.addr = (char *)zbx_mock_get_parameter_string("in.addr");
+	count = (int)zbx_mock_get_parameter_uint64("in.count");
+	error[0] = '\0';
+
+	ret = icmpping_native_ping(&host, 1, count, (int)zbx_mock_get_parameter_uint64("in.period"),
+			(int)zbx_mock_get_parameter_uint64("in.interval"), (int)zbx_mock_get_parameter_uint64("in.size"),
+			(int)zbx_mock_get_parameter_uint64("in.timeout"), 0, 0, NULL, error, sizeof(error));
+
+	/* ICMP sockets are not available to the user running tests */
+	if (FAIL == ret)
+		skip();
+
+	zbx_mock_assert_int_eq("icmpping_native_ping() return value", SUCCEED, ret);
+	zbx_mock_assert_int_eq("sent requests", (int)zbx_mock_get_parameter_uint64("out.cnt"), host.cnt);
+	zbx_mock_assert_int_eq("received replies", (int)zbx_mock_get_parameter_uint64("out.rcv"), host.rcv);
+	zbx_mock_assert_ptr_eq("response statuses", NULL, host.status);
+
+	if (0 != host.rcv)
+	{
+		double	avg = host.sum / host.rcv;
+
+		if (host.min > avg || avg > host.max)
+			fail_msg("invalid response times min:%f avg:%f max:%f", host.min, avg, host.max);
+	}
+}
@@ -0,0 +1,161 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxcommon.h"
+#include "zbxjson.h"
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "../../../src/libs/zbxjson/json_scan.h"
+
+/* data is placed at every offset within 16 byte block, so terminating zero */
+/* and escape sequences cross block boundary in all possible ways           */
+#define JSON_SCAN_ALIGNMENTS	16
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: copies data to the end of allocated buffer at the specified       *
+ *          offset from aligned address                                       *
+ *                                                                            *
+ * Comments: Buffer ends with terminating zero, so reads past it are detected *
+ *           by memory checkers.                                              *
+ *                                                                            *
+ ******************************************************************************/
+static char	*mock_place_data(const char *data, size_t len, size_t alignment, char **buffer)
+{
+	*buffer = (char *)zbx_malloc(NULL, alignment + len + 1);
+	memcpy(*buffer + alignment, data, len + 1);
+
+	return *buffer + alignment;
+}
+
+static void	mock_check_scan(const char *data, size_t len, size_t alignment)
+{
+	const char	*type, *ptr, *end;
+	char		*buffer, msg[MAX_STRING_LEN];
+	int		offset;
+
+	type = zbx_mock_get_parameter_string("in.type");
+	offset = (int)zbx_mock_get_parameter_uint64("out.offset");
+
+	ptr = mock_place_data(data, len, alignment, &buffer);
+
+	/* scanning with unknown and with known end of data must give the same result */
+	for (end = NULL; ; end = ptr + len)
+	{
+		const char	*p = NULL;
+
+		if (0 == strcmp(type, "string"))
+			p = json_scan_string(ptr, end);
+		else if (0 == strcmp(type, "structural"))
+			p = json_scan_structural(ptr, end);
+		else
+			fail_msg("unknown scan type \"%s\"", type);
+
+		zbx_snprintf(msg, sizeof(msg), "scan offset (alignment %d, %s end)", (int)alignment,
+				NULL == end ? "unknown" : "known");
+		zbx_mock_assert_int_eq(msg, offset, (int)(p - ptr));
+
+		if (NULL != end)
+			break;
+	}
+
+	zbx_free(buffer);
+}
+
+static void	mock_check_json(const char *data, size_t len, size_t alignment)
+{
+	const char		*ptr, *p, *value;
+	char			*buffer, *out = NULL, name[MAX_STRING_LEN], msg[MAX_STRING_LEN];
+	size_t			out_alloc = 0;
+	struct zbx_json_parse	jp;
+	zbx_mock_handle_t	hvalues, hvalue;
+	zbx_mock_error_t	err;
+	int			ret;
+
+	ptr = mock_place_data(data, len, alignment, &buffer);
+
+	zbx_snprintf(msg, sizeof(msg), "zbx_json_open() return value (alignment %d)", (int)alignment);
+	ret = zbx_json_open(ptr, &jp);
+	zbx_mock_assert_result_eq(msg, zbx_mock_str_to_return_code(zbx_mock_get_parameter_string("out.return")),
+			ret);
+
+	if (SUCCEED != ret)
+		goto out;
+
+	/* values are iterated in the order of object members */
+	hvalues = zbx_mock_get_parameter_handle("out.values");
+
+	for (p = NULL; NULL != (p = zbx_json_pair_next(&jp, p, name, sizeof(name)));)
+	{
+		zbx_json_type_t	type = zbx_json_valuetype(p);
+
+		/* nested objects and arrays must be skipped when scanning for the next member */
+		if (ZBX_JSON_TYPE_OBJECT == type || ZBX_JSON_TYPE_ARRAY == type)
+		{
+			struct zbx_json_parse	jp_nested;
+
+			if (SUCCEED != zbx_json_brackets_by_name(&jp, name, &jp_nested))
+				fail_msg("cannot open member \"%s\": %s", name, zbx_json_strerror());
+
+			continue;
+		}
+
+		if (ZBX_MOCK_SUCCESS != (err = zbx_mock_vector_element(hvalues, &hvalue)))
+			fail_msg("unexpected member \"%s\": %s", name, zbx_mock_error_string(err));
+
+		zbx_mock_assert_str_eq("member name", zbx_mock_get_object_member_string(hvalue, "name"), name);
+
+		if (NULL == zbx_json_decodevalue_dyn(p, &out, &out_alloc, NULL))
+			fail_msg("cannot decode value of member \"%s\"", name);
+
+		value = zbx_mock_get_object_member_string(hvalue, "value");
+		zbx_snprintf(msg, sizeof(msg), "member \"%s\" value (alignment %d)", name, (int)alignment);
+		zbx_mock_assert_str_eq(msg, value, out);
+
+		if (SUCCEED != zbx_json_value_by_name_dyn(&jp, name, &out, &out_alloc, NULL))
+			fail_msg("cannot find member \"%s\"", name);
+
+		zbx_mock_assert_str_eq(msg, value, out);
+	}
+
+	if (ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(hvalues, &hvalue))
+		fail_msg("expected more object members");
+out:
+	zbx_free(out);
+	zbx_free(buffer);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	const char	*data, *type;
+	size_t		len, alignment;
+
+	ZBX_UNUSED(state);
+
+	data = zbx_mock_get_parameter_string("in.data");
+	type = zbx_mock_get_parameter_string("in.type");
+	len = strlen(data);
+
+	for (alignment = 0; alignment < JSON_SCAN_ALIGNMENTS; alignment++)
+	{
+		if (0 == strcmp(type, "json"))
+			mock_check_json(data, len, alignment);
+		else
+			mock_check_scan(data, len, alignment);
+	}
+}
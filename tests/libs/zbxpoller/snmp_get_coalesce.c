@@ -0,0 +1,297 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+#include "zbxmockdata.h"
+
+#include "../../../src/libs/zbxpoller/checks_snmp.c"
+
+#ifdef HAVE_NETSNMP
+static void	mock_read_oid(const char *str, oid *name, size_t *name_length)
+{
+	char	*end;
+
+	for (*name_length = 0; '\0' != *str; (*name_length)++)
+	{
+		if ('.' == *str)
+			str++;
+
+		if (MAX_OID_LEN == *name_length)
+			fail_msg("OID \"%s\" is too long", str);
+
+		name[*name_length] = (oid)strtoul(str, &end, 10);
+
+		if (end == str)
+			fail_msg("invalid OID \"%s\"", str);
+
+		str = end;
+	}
+}
+
+static zbx_snmp_context_t	*mock_snmp_context_create(void)
+{
+	static char		addr[] = "127.0.0.1";
+	zbx_snmp_context_t	*snmp_context;
+
+	snmp_context = (zbx_snmp_context_t *)zbx_malloc(NULL, sizeof(zbx_snmp_context_t));
+	memset(snmp_context, 0, sizeof(zbx_snmp_context_t));
+
+	snmp_context->snmp_version = ZBX_IF_SNMP_VERSION_2;
+	snmp_context->item.interface.addr = addr;
+	snmp_context->item.interface.port = 161;
+	snmp_context->min_fail = ZBX_MAX_SNMP_ITEMS + 1;
+	zbx_vector_bulkwalk_context_create(&snmp_context->bulkwalk_contexts);
+	zbx_vector_snmp_context_create(&snmp_context->coalesced);
+
+	return snmp_context;
+}
+
+static void	mock_snmp_context_free(zbx_snmp_context_t *snmp_context)
+{
+	for (int i = 0; i < snmp_context->bulkwalk_contexts.values_num; i++)
+	{
+		zbx_bulkwalk_context_t	*bulkwalk_context = snmp_context->bulkwalk_contexts.values[i];
+
+		zbx_free(bulkwalk_context->p_oid);
+		zbx_free(bulkwalk_context->error);
+		zbx_free(bulkwalk_context);
+	}
+
+	for (int i = 0; i < snmp_context->coalesced.values_num; i++)
+	{
+		zbx_free(snmp_context->coalesced.values[i]->results);
+		zbx_vector_bulkwalk_context_destroy(&snmp_context->coalesced.values[i]->bulkwalk_contexts);
+		zbx_vector_snmp_context_destroy(&snmp_context->coalesced.values[i]->coalesced);
+		zbx_free(snmp_context->coalesced.values[i]);
+	}
+
+	zbx_vector_bulkwalk_context_destroy(&snmp_context->bulkwalk_contexts);
+	zbx_vector_snmp_context_destroy(&snmp_context->coalesced);
+	zbx_free(snmp_context->results);
+	zbx_free(snmp_context->vars);
+	zbx_free(snmp_context->error);
+	zbx_free(snmp_context);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: creates context of coalesced checks, the first check is owned by  *
+ *          the context itself and the rest by its peers                      *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_snmp_context_t	*mock_read_snmp_context(void)
+{
+	zbx_snmp_context_t	*snmp_context;
+	zbx_mock_handle_t	hchecks, hcheck;
+	zbx_mock_error_t	err;
+	int			requested;
+
+	snmp_context = mock_snmp_context_create();
+	hchecks = zbx_mock_get_parameter_handle("in.checks");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hchecks, &hcheck))))
+	{
+		zbx_bulkwalk_context_t	*bulkwalk_context;
+		const char		*str;
+
+		if (ZBX_MOCK_SUCCESS != err || ZBX_MOCK_SUCCESS != (err = zbx_mock_string(hcheck, &str)))
+			fail_msg("Cannot read check OID: %s", zbx_mock_error_string(err));
+
+		bulkwalk_context = (zbx_bulkwalk_context_t *)zbx_malloc(NULL, sizeof(zbx_bulkwalk_context_t));
+		memset(bulkwalk_context, 0, sizeof(zbx_bulkwalk_context_t));
+
+		bulkwalk_context->p_oid = (zbx_snmp_oid_t *)zbx_malloc(NULL, sizeof(zbx_snmp_oid_t));
+		mock_read_oid(str, bulkwalk_context->p_oid->root_oid, &bulkwalk_context->p_oid->root_oid_len);
+		memcpy(bulkwalk_context->name, bulkwalk_context->p_oid->root_oid,
+				bulkwalk_context->p_oid->root_oid_len * sizeof(oid));
+		bulkwalk_context->name_length = bulkwalk_context->p_oid->root_oid_len;
+		bulkwalk_context->running = 1;
+
+		if (0 == snmp_context->bulkwalk_contexts.values_num)
+		{
+			bulkwalk_context->arg = snmp_context;
+		}
+		else
+		{
+			zbx_snmp_context_t	*peer;
+
+			peer = mock_snmp_context_create();
+			zbx_vector_snmp_context_append(&snmp_context->coalesced, peer);
+			bulkwalk_context->arg = peer;
+		}
+
+		zbx_vector_bulkwalk_context_append(&snmp_context->bulkwalk_contexts, bulkwalk_context);
+	}
+
+	snmp_context->vars_max = (int)zbx_mock_get_parameter_uint64("in.vars_max");
+	snmp_context->vars = (int *)zbx_malloc(NULL, sizeof(int) * (size_t)snmp_context->vars_max);
+
+	/* the request contains variables of the first checks */
+	requested = (int)zbx_mock_get_parameter_uint64("in.requested");
+
+	for (snmp_context->vars_num = 0; snmp_context->vars_num < requested; snmp_context->vars_num++)
+		snmp_context->vars[snmp_context->vars_num] = snmp_context->vars_num;
+
+	return snmp_context;
+}
+
+static struct snmp_pdu	*mock_read_response(void)
+{
+	struct snmp_pdu		*pdu;
+	zbx_mock_handle_t	hvars, hvar;
+	zbx_mock_error_t	err;
+
+	if (NULL == (pdu = snmp_pdu_create(SNMP_MSG_RESPONSE)))
+		fail_msg("cannot create PDU");
+
+	pdu->errstat = (long)zbx_mock_get_parameter_uint64("in.response.errstat");
+	pdu->errindex = (long)zbx_mock_get_parameter_uint64("in.response.errindex");
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_parameter("in.response.variables", &hvars))
+		return pdu;
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hvars, &hvar))))
+	{
+		oid	name[MAX_OID_LEN];
+		size_t	name_length;
+		long	value;
+
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read response variable: %s", zbx_mock_error_string(err));
+
+		mock_read_oid(zbx_mock_get_object_member_string(hvar, "oid"), name, &name_length);
+		value = (long)zbx_mock_get_object_member_uint64(hvar, "value");
+
+		snmp_pdu_add_variable(pdu, name, name_length, ASN_INTEGER, (const void *)&value, sizeof(value));
+	}
+
+	return pdu;
+}
+
+static void	mock_check_results(zbx_snmp_context_t *snmp_context)
+{
+	zbx_mock_handle_t	hchecks, hcheck;
+	zbx_mock_error_t	err;
+	int			i = 0;
+
+	hchecks = zbx_mock_get_parameter_handle("out.checks");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hchecks, &hcheck))))
+	{
+		zbx_bulkwalk_context_t	*bulkwalk_context;
+		zbx_snmp_context_t	*owner;
+		const char		*state;
+		char			msg[MAX_STRING_LEN];
+
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read expected check: %s", zbx_mock_error_string(err));
+
+		if (i >= snmp_context->bulkwalk_contexts.values_num)
+			fail_msg("expected more checks than requested");
+
+		bulkwalk_context = snmp_context->bulkwalk_contexts.values[i];
+		owner = (zbx_snmp_context_t *)bulkwalk_context->arg;
+		state = zbx_mock_get_object_member_string(hcheck, "state");
+		zbx_snprintf(msg, sizeof(msg), "check #%d", i + 1);
+
+		if (0 == strcmp(state, "RUNNING"))
+		{
+			zbx_mock_assert_int_eq(msg, 1, bulkwalk_context->running);
+			zbx_mock_assert_ptr_eq(msg, NULL, bulkwalk_context->error);
+		}
+		else if (0 == strcmp(state, "SUCCEED"))
+		{
+			zbx_mock_assert_int_eq(msg, 0, bulkwalk_context->running);
+			zbx_mock_assert_ptr_eq(msg, NULL, bulkwalk_context->error);
+			zbx_mock_assert_str_eq(msg, zbx_mock_get_object_member_string(hcheck, "value"),
+					ZBX_NULL2EMPTY_STR(owner->results));
+		}
+		else if (0 == strcmp(state, "NOTSUPPORTED"))
+		{
+			zbx_mock_assert_int_eq(msg, 0, bulkwalk_context->running);
+			zbx_mock_assert_ptr_ne(msg, NULL, bulkwalk_context->error);
+		}
+		else if (0 == strcmp(state, "TIMEOUT"))
+		{
+			char	*error;
+
+			/* the check is failed with timeout error of its own OID */
+			zbx_mock_assert_int_eq(msg, 1, bulkwalk_context->running);
+			zbx_mock_assert_ptr_ne(msg, NULL, bulkwalk_context->error);
+
+			error = snmp_timeout_error(snmp_context, bulkwalk_context);
+			zbx_mock_assert_str_eq(msg, error, bulkwalk_context->error);
+			zbx_free(error);
+		}
+		else
+			fail_msg("unknown check state \"%s\"", state);
+
+		i++;
+	}
+
+	zbx_mock_assert_int_eq("number of checks", snmp_context->bulkwalk_contexts.values_num, i);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_snmp_context_t	*snmp_context;
+	const char		*event;
+	int			min_fail = ZBX_MAX_SNMP_ITEMS + 1;
+
+	ZBX_UNUSED(state);
+
+	snmp_context = mock_read_snmp_context();
+	event = zbx_mock_get_parameter_string("in.event");
+
+	if (0 == strcmp(event, "response"))
+	{
+		struct snmp_pdu	*pdu;
+
+		pdu = mock_read_response();
+		snmp_get_handle_response(snmp_context, STAT_SUCCESS, pdu);
+		snmp_free_pdu(pdu);
+	}
+	else if (0 == strcmp(event, "timeout"))
+	{
+		zbx_mock_assert_result_eq("snmp_get_handle_timeout() return value",
+				zbx_mock_str_to_return_code(zbx_mock_get_parameter_string("out.return")),
+				snmp_get_handle_timeout(snmp_context));
+	}
+	else
+		fail_msg("unknown event \"%s\"", event);
+
+	mock_check_results(snmp_context);
+
+	zbx_mock_assert_int_eq("vars_max", (int)zbx_mock_get_parameter_uint64("out.vars_max"),
+			snmp_context->vars_max);
+	zbx_mock_assert_int_eq("max_succeed", (int)zbx_mock_get_parameter_uint64("out.max_succeed"),
+			snmp_context->max_succeed);
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter_exists("out.min_fail"))
+		min_fail = (int)zbx_mock_get_parameter_uint64("out.min_fail");
+
+	zbx_mock_assert_int_eq("min_fail", min_fail, snmp_context->min_fail);
+
+	mock_snmp_context_free(snmp_context);
+}
+#else
+void	zbx_mock_test_entry(void **state)
+{
+	ZBX_UNUSED(state);
+
+	skip();
+}
+#endif
@@ -0,0 +1,312 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+#include "zbxmockdata.h"
+
+#include "zbx_item_constants.h"
+
+#include "../../../src/zabbix_agent/active_checks/active_workers.c"
+
+int	__wrap_zbx_execute_agent_check(const char *in_command, unsigned flags, AGENT_RESULT *result, int timeout);
+int	__wrap_process_log_check(zbx_vector_addr_ptr_t *addrs, zbx_vector_ptr_t *agent2_result,
+		zbx_vector_expression_t *regexps, zbx_active_metric_t *metric, zbx_process_value_func_t process_value_cb,
+		zbx_uint64_t *lastlogsize_sent, int *mtime_sent, char **error, zbx_vector_pre_persistent_t *prep_vec,
+		const zbx_config_tls_t *config_tls, int config_timeout, const char *config_source_ip,
+		const char *config_hostname, int config_buffer_send, int config_buffer_size, int config_max_lines_per_second);
+
+/* worker check result is selected by key: text[<value>] returns value, msg[<error>] returns error, */
+/* crash terminates worker process and other keys succeed without value                             */
+int	__wrap_zbx_execute_agent_check(const char *in_command, unsigned flags, AGENT_RESULT *result, int timeout)
+{
+	size_t	len = strlen(in_command);
+
+	ZBX_UNUSED(flags);
+	ZBX_UNUSED(timeout);
+
+	if (0 == strcmp(in_command, "crash"))
+		kill(getpid(), SIGKILL);
+
+	if (0 == strncmp(in_command, "text[", ZBX_CONST_STRLEN("text[")) && ']' == in_command[len - 1])
+	{
+		SET_TEXT_RESULT(result, zbx_dsprintf(NULL, "%.*s", (int)(len - ZBX_CONST_STRLEN("text[]")),
+				in_command + ZBX_CONST_STRLEN("text[")));
+		return SUCCEED;
+	}
+
+	if (0 == strncmp(in_command, "msg[", ZBX_CONST_STRLEN("msg[")) && ']' == in_command[len - 1])
+	{
+		SET_MSG_RESULT(result, zbx_dsprintf(NULL, "%.*s", (int)(len - ZBX_CONST_STRLEN("msg[]")),
+				in_command + ZBX_CONST_STRLEN("msg[")));
+		return NOTSUPPORTED;
+	}
+
+	return SUCCEED;
+}
+
+/* log check key lines[<number>] reads the number of lines, one byte each, until value buffer is full */
+int	__wrap_process_log_check(zbx_vector_addr_ptr_t *addrs, zbx_vector_ptr_t *agent2_result,
+		zbx_vector_expression_t *regexps, zbx_active_metric_t *metric, zbx_process_value_func_t process_value_cb,
+		zbx_uint64_t *lastlogsize_sent, int *mtime_sent, char **error, zbx_vector_pre_persistent_t *prep_vec,
+		const zbx_config_tls_t *config_tls, int config_timeout, const char *config_source_ip,
+		const char *config_hostname, int config_buffer_send, int config_buffer_size, int config_max_lines_per_second)
+{
+	int	i, lines;
+
+	ZBX_UNUSED(regexps);
+	ZBX_UNUSED(mtime_sent);
+	ZBX_UNUSED(error);
+	ZBX_UNUSED(prep_vec);
+	ZBX_UNUSED(config_max_lines_per_second);
+
+	lines = atoi(metric->key + ZBX_CONST_STRLEN("lines["));
+
+	for (i = 0; i < lines; i++)
+	{
+		zbx_uint64_t	lastlogsize = metric->lastlogsize + 1;
+		char		value[MAX_ID_LEN + 1];
+
+		zbx_snprintf(value, sizeof(value), ZBX_FS_UI64, lastlogsize);
+
+		if (SUCCEED != process_value_cb(addrs, agent2_result, metric->itemid, config_hostname, metric->key,
+				value, ITEM_STATE_NORMAL, &lastlogsize, &metric->mtime, NULL, NULL, NULL, NULL,
+				metric->flags | ZBX_METRIC_FLAG_PERSISTENT, config_tls, config_timeout,
+				config_source_ip, config_buffer_send, config_buffer_size))
+		{
+			break;
+		}
+
+		metric->lastlogsize = lastlogsize;
+		*lastlogsize_sent = lastlogsize;
+	}
+
+	return SUCCEED;
+}
+
+typedef struct
+{
+	zbx_active_metric_t	metric;
+	zbx_mock_handle_t	handle;
+	int			slots;
+	int			done;
+}
+mock_check_t;
+
+static mock_check_t	*mock_read_checks(const char *in_path, const char *out_path, int *checks_num)
+{
+	zbx_mock_handle_t	hchecks, hcheck, hresults, hresult, hslots;
+	zbx_mock_error_t	err;
+	mock_check_t		*checks = NULL;
+	int			checks_alloc = 0;
+
+	*checks_num = 0;
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_parameter(in_path, &hchecks))
+		return NULL;
+
+	hresults = zbx_mock_get_parameter_handle(out_path);
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hchecks, &hcheck))))
+	{
+		mock_check_t	*check;
+
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read check: %s", zbx_mock_error_string(err));
+
+		if (ZBX_MOCK_SUCCESS != zbx_mock_vector_element(hresults, &hresult))
+			fail_msg("Cannot read result of check #%d", *checks_num + 1);
+
+		if (*checks_num == checks_alloc)
+		{
+			checks_alloc += 8;
+			checks = (mock_check_t *)zbx_realloc(checks, sizeof(mock_check_t) * (size_t)checks_alloc);
+		}
+
+		check = &checks[(*checks_num)++];
+		memset(check, 0, sizeof(mock_check_t));
+
+		check->handle = hresult;
+		check->metric.itemid = (zbx_uint64_t)*checks_num;
+		check->metric.key = zbx_strdup(NULL, zbx_mock_get_object_member_string(hcheck, "key"));
+		check->metric.timeout = 3;
+
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hcheck, "slots", &hslots))
+			check->slots = (int)zbx_mock_get_object_member_uint64(hcheck, "slots");
+	}
+
+	return checks;
+}
+
+static void	mock_free_checks(mock_check_t *checks, int checks_num)
+{
+	for (int i = 0; i < checks_num; i++)
+		zbx_free(checks[i].metric.key);
+
+	zbx_free(checks);
+}
+
+static void	mock_check_result(mock_check_t *check, int ret, AGENT_RESULT *result)
+{
+	zbx_mock_handle_t	hvalue;
+	const char		*value;
+	char			**pvalue;
+
+	zbx_mock_assert_result_eq(check->metric.key, zbx_mock_str_to_return_code(
+			zbx_mock_get_object_member_string(check->handle, "return")), ret);
+
+	pvalue = (SUCCEED == ret ? ZBX_GET_TEXT_RESULT(result) : ZBX_GET_MSG_RESULT(result));
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_object_member(check->handle, "value", &hvalue))
+	{
+		if (NULL != pvalue)
+			fail_msg("check \"%s\" returned unexpected value \"%s\"", check->metric.key, *pvalue);
+
+		return;
+	}
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_string(hvalue, &value))
+		fail_msg("invalid value of check \"%s\"", check->metric.key);
+
+	if (NULL == pvalue)
+		fail_msg("check \"%s\" returned no value", check->metric.key);
+
+	zbx_mock_assert_str_eq(check->metric.key, value, *pvalue);
+}
+
+static void	mock_check_log_result(mock_check_t *check, zbx_active_log_job_t *job)
+{
+	int	values_num;
+
+	values_num = (int)zbx_mock_get_object_member_uint64(check->handle, "values");
+
+	zbx_mock_assert_result_eq(check->metric.key, SUCCEED, job->ret);
+	zbx_mock_assert_int_eq(check->metric.key, values_num, job->values.values_num);
+
+	/* values of one log check must keep the order they were read in */
+	for (int i = 0; i < job->values.values_num; i++)
+		zbx_mock_assert_uint64_eq(check->metric.key, (zbx_uint64_t)i + 1, job->values.values[i].lastlogsize);
+
+	zbx_mock_assert_uint64_eq(check->metric.key, (zbx_uint64_t)values_num, job->lastlogsize_sent);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	mock_check_t		*checks, *logs;
+	zbx_vector_addr_ptr_t	addrs;
+	int			checks_num, logs_num, checks_next = 0, logs_next = 0;
+	char			*error = NULL;
+
+	ZBX_UNUSED(state);
+
+	checks = mock_read_checks("in.checks", "out.checks", &checks_num);
+	logs = mock_read_checks("in.logs", "out.logs", &logs_num);
+
+	for (int i = 0; i < logs_num; i++)
+		logs[i].metric.flags = ZBX_METRIC_FLAG_LOG_LOG;
+
+	zbx_vector_addr_ptr_create(&addrs);
+
+	if (SUCCEED != zbx_active_workers_init((int)zbx_mock_get_parameter_uint64("in.workers"), &error))
+		fail_msg("cannot start active checks workers: %s", error);
+
+	if (NULL == log_pool)
+		fail_msg("log check threads were not started");
+
+	while (checks_next < checks_num || logs_next < logs_num)
+	{
+		zbx_active_metric_t	*metric;
+		zbx_active_log_job_t	*job;
+		AGENT_RESULT		result;
+		int			ret, started = checks_next + logs_next;
+
+		/* log checks are started first, so that workers are restarted while log checks are running */
+		while (logs_next < logs_num)
+		{
+			mock_check_t	*check = &logs[logs_next];
+
+			job = zbx_active_log_job_create(&check->metric, &addrs, NULL, NULL, 3, NULL, "host", 5, 100,
+					100, check->slots);
+
+			if (SUCCEED != zbx_active_log_check(job))
+			{
+				zbx_active_log_job_free(job);
+				break;
+			}
+
+			logs_next++;
+		}
+
+		while (checks_next < checks_num && SUCCEED == zbx_active_worker_check(&checks[checks_next].metric))
+			checks_next++;
+
+		if (started == checks_next + logs_next)
+			fail_msg("no idle workers or log check threads");
+
+		zbx_init_agent_result(&result);
+
+		while (0 != zbx_active_workers_busy())
+		{
+			if (SUCCEED != zbx_active_workers_result(-1, &metric, &ret, &result, &job))
+				fail_msg("no result while %d checks are busy", zbx_active_workers_busy());
+
+			if (NULL != job)
+			{
+				mock_check_t	*check = &logs[metric->itemid - 1];
+
+				if (metric != &check->metric)
+					fail_msg("unexpected log check \"%s\"", metric->key);
+
+				mock_check_log_result(check, job);
+				zbx_active_log_job_free(job);
+				check->done++;
+			}
+			else
+			{
+				mock_check_t	*check = &checks[metric->itemid - 1];
+
+				if (metric != &check->metric)
+					fail_msg("unexpected check \"%s\"", metric->key);
+
+				mock_check_result(check, ret, &result);
+				check->done++;
+			}
+
+			zbx_free_agent_result(&result);
+			zbx_init_agent_result(&result);
+		}
+
+		zbx_free_agent_result(&result);
+	}
+
+	for (int i = 0; i < checks_num; i++)
+		zbx_mock_assert_int_eq(checks[i].metric.key, 1, checks[i].done);
+
+	for (int i = 0; i < logs_num; i++)
+		zbx_mock_assert_int_eq(logs[i].metric.key, 1, logs[i].done);
+
+	/* crashed workers must be replaced */
+	for (int i = 0; i < workers_num; i++)
+	{
+		if (-1 == workers[i].fd)
+			fail_msg("active checks worker #%d was not restarted", i + 1);
+	}
+
+	zbx_active_workers_destroy();
+
+	zbx_vector_addr_ptr_destroy(&addrs);
+	mock_free_checks(logs, logs_num);
+	mock_free_checks(checks, checks_num);
+}
@@ -0,0 +1,259 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+#include "zbxmockdata.h"
+
+#include "zbxagentget.h"
+#include "zbxversion.h"
+
+#include "../../../src/zabbix_agent/listener/listener.c"
+
+int	__wrap_zbx_execute_agent_check(const char *in_command, unsigned flags, AGENT_RESULT *result, int timeout);
+
+/* every check returns its key as value */
+int	__wrap_zbx_execute_agent_check(const char *in_command, unsigned flags, AGENT_RESULT *result, int timeout)
+{
+	ZBX_UNUSED(flags);
+	ZBX_UNUSED(timeout);
+
+	SET_TEXT_RESULT(result, zbx_strdup(NULL, in_command));
+
+	return SUCCEED;
+}
+
+static void	mock_send_request(zbx_socket_t *requester, const char *key, int timeout, int keep_alive)
+{
+	struct zbx_json	j;
+
+	zbx_json_init(&j, ZBX_JSON_STAT_BUF_LEN);
+	zbx_agent_prepare_request(&j, key, timeout);
+
+	if (0 != keep_alive)
+		zbx_agent_request_keep_alive(&j, keep_alive);
+
+	if (SUCCEED != zbx_tcp_send_bytes_to(requester, j.buffer, j.buffer_size, timeout))
+		fail_msg("cannot send request: %s", zbx_socket_strerror());
+
+	zbx_json_free(&j);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: serves request on listener side and checks response on requester  *
+ *          side                                                              *
+ *                                                                            *
+ * Return value: keep-alive period granted by listener                        *
+ *                                                                            *
+ ******************************************************************************/
+static int	mock_serve_request(zbx_socket_t *listener, zbx_socket_t *requester, const char *key, int timeout)
+{
+	AGENT_RESULT	result;
+	int		ret, keep_alive, version = ZBX_COMPONENT_VERSION(7, 0, 0);
+	char		**value;
+
+	if (SUCCEED != zbx_tcp_recv_to(listener, timeout))
+		fail_msg("cannot receive request: %s", zbx_socket_strerror());
+
+	if (SUCCEED != process_request(listener, timeout, &keep_alive))
+		fail_msg("cannot process request: %s", zbx_socket_strerror());
+
+	if (SUCCEED != zbx_tcp_recv_to(requester, timeout))
+		fail_msg("cannot receive response: %s", zbx_socket_strerror());
+
+	/* requester must see the same keep-alive period as listener uses */
+	zbx_mock_assert_int_eq("keep-alive period in response", keep_alive,
+			zbx_agent_get_keep_alive(requester->buffer));
+
+	zbx_init_agent_result(&result);
+
+	ret = zbx_agent_handle_response(requester->buffer, requester->read_bytes, (ssize_t)requester->read_bytes,
+			"localhost", &result, &version);
+	zbx_mock_assert_result_eq("zbx_agent_handle_response()", SUCCEED, ret);
+
+	if (NULL == (value = ZBX_GET_TEXT_RESULT(&result)))
+		fail_msg("response has no value");
+
+	zbx_mock_assert_str_eq("response value", key, *value);
+	zbx_free_agent_result(&result);
+
+	return keep_alive;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: makes connection that waits to be accepted on listen socket       *
+ *                                                                            *
+ ******************************************************************************/
+static int	mock_connect_pending(zbx_socket_t *listener, int *client)
+{
+	struct sockaddr_in	addr;
+	socklen_t		addr_len = sizeof(addr);
+	int			fd;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	if (-1 == (fd = socket(AF_INET, SOCK_STREAM, 0)) || 0 != bind(fd, (struct sockaddr *)&addr, sizeof(addr)) ||
+			0 != listen(fd, 1) || 0 != getsockname(fd, (struct sockaddr *)&addr, &addr_len))
+	{
+		fail_msg("cannot create listen socket: %s", zbx_strerror(errno));
+	}
+
+	/* connection is completed by kernel and waits in backlog until it is accepted */
+	if (-1 == (*client = socket(AF_INET, SOCK_STREAM, 0)) ||
+			0 != connect(*client, (struct sockaddr *)&addr, sizeof(addr)))
+	{
+		fail_msg("cannot connect to listen socket: %s", zbx_strerror(errno));
+	}
+
+	listener->sockets[0] = fd;
+	listener->num_socks = 1;
+
+	return fd;
+}
+
+static void	mock_check_handshake(void)
+{
+	zbx_socket_t	listener, requester;
+	int		fds[2], timeout, keep_alive, listen_fd = -1, client = -1, ret;
+	const char	*key, *pending;
+	double		accept_time = 0, time_start;
+	pid_t		pid = 0;
+
+	key = zbx_mock_get_parameter_string("in.key");
+	timeout = (int)zbx_mock_get_parameter_uint64("in.timeout");
+	keep_alive = (int)zbx_mock_get_parameter_uint64("in.keep_alive");
+
+	if (0 != socketpair(AF_UNIX, SOCK_STREAM, 0, fds))
+		fail_msg("cannot create socket pair: %s", zbx_strerror(errno));
+
+	zbx_socket_clean(&listener);
+	listener.socket = fds[0];
+	listener.connection_type = ZBX_TCP_SEC_UNENCRYPTED;
+
+	zbx_socket_clean(&requester);
+	requester.socket = fds[1];
+	requester.connection_type = ZBX_TCP_SEC_UNENCRYPTED;
+
+	mock_send_request(&requester, key, timeout, keep_alive);
+	keep_alive = mock_serve_request(&listener, &requester, key, timeout);
+
+	zbx_mock_assert_int_eq("granted keep-alive period", (int)zbx_mock_get_parameter_uint64("out.keep_alive"),
+			keep_alive);
+
+	if (0 == keep_alive)
+		goto out;
+
+	pending = zbx_mock_get_parameter_string("in.pending");
+
+	if (0 == strcmp(pending, "none"))
+	{
+		/* the next request is served on the same connection */
+		mock_send_request(&requester, key, timeout, keep_alive);
+		zbx_mock_assert_result_eq("wait_for_request()", SUCCEED,
+				wait_for_request(&listener, keep_alive, &accept_time));
+		mock_serve_request(&listener, &requester, key, timeout);
+	}
+	else if (0 == strcmp(pending, "accepted"))
+	{
+		listen_fd = mock_connect_pending(&listener, &client);
+
+		/* another listener accepts pending connection, the next request arrives later */
+		if (0 == (pid = fork()))
+		{
+			struct timespec	delay = {0, 300000000};
+			int		fd;
+
+			if (-1 == (fd = accept(listen_fd, NULL, NULL)))
+				_exit(EXIT_FAILURE);
+
+			nanosleep(&delay, NULL);
+			mock_send_request(&requester, key, timeout, keep_alive);
+			close(fd);
+			_exit(EXIT_SUCCESS);
+		}
+
+		if (-1 == pid)
+			fail_msg("cannot fork: %s", zbx_strerror(errno));
+
+		zbx_mock_assert_result_eq("wait_for_request()", SUCCEED,
+				wait_for_request(&listener, keep_alive, &accept_time));
+		mock_serve_request(&listener, &requester, key, timeout);
+	}
+	else if (0 == strcmp(pending, "not accepted"))
+	{
+		listen_fd = mock_connect_pending(&listener, &client);
+
+		/* request sent before the connection was noticed is served */
+		mock_send_request(&requester, key, timeout, keep_alive);
+		zbx_mock_assert_result_eq("wait_for_request()", SUCCEED,
+				wait_for_request(&listener, keep_alive, &accept_time));
+		mock_serve_request(&listener, &requester, key, timeout);
+
+		/* session ends soon after, because no other listener accepts the connection */
+		time_start = zbx_time();
+		ret = wait_for_request(&listener, keep_alive, &accept_time);
+
+		zbx_mock_assert_result_eq("wait_for_request()", FAIL, ret);
+
+		if (keep_alive <= zbx_time() - time_start)
+			fail_msg("keep-alive session was not ended before its idle timeout");
+	}
+	else
+		fail_msg("unknown pending connection state \"%s\"", pending);
+out:
+	if (0 < pid)
+	{
+		int	status;
+
+		if (pid != waitpid(pid, &status, 0) || !WIFEXITED(status) || EXIT_SUCCESS != WEXITSTATUS(status))
+			fail_msg("other listener failed to accept connection");
+	}
+
+	if (-1 != client)
+		close(client);
+
+	if (-1 != listen_fd)
+		close(listen_fd);
+
+	zbx_tcp_close(&requester);
+	zbx_tcp_close(&listener);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	const char	*type;
+
+	ZBX_UNUSED(state);
+
+	type = zbx_mock_get_parameter_string("in.type");
+
+	if (0 == strcmp(type, "handshake"))
+	{
+		mock_check_handshake();
+	}
+	else if (0 == strcmp(type, "response"))
+	{
+		/* responses of agents with and without keep-alive support */
+		zbx_mock_assert_int_eq("zbx_agent_get_keep_alive()",
+				(int)zbx_mock_get_parameter_uint64("out.keep_alive"),
+				zbx_agent_get_keep_alive(zbx_mock_get_parameter_string("in.response")));
+	}
+	else
+		fail_msg("unknown test type \"%s\"", type);
+}
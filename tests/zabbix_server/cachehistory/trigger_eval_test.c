@@ -0,0 +1,149 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+#include "zbxmockdata.h"
+
+#include "../../../src/zabbix_server/cachehistory/trigger_eval.c"
+
+static unsigned char	mock_str_to_trigger_value(const char *str)
+{
+	if (0 == strcmp(str, "PROBLEM"))
+		return TRIGGER_VALUE_PROBLEM;
+
+	if (0 == strcmp(str, "OK"))
+		return TRIGGER_VALUE_OK;
+
+	if (0 == strcmp(str, "NONE"))
+		return TRIGGER_VALUE_NONE;
+
+	fail_msg("Unknown trigger value: %s", str);
+
+	return TRIGGER_VALUE_NONE;
+}
+
+typedef struct
+{
+	const char	*expression;
+	const char	*time;
+	unsigned char	value;
+}
+mock_trigger_t;
+
+static zbx_dc_trigger_t	*mock_trigger_create(const mock_trigger_t *mock, zbx_uint64_t triggerid)
+{
+	zbx_dc_trigger_t	*tr;
+	char			*error = NULL;
+
+	tr = (zbx_dc_trigger_t *)zbx_malloc(NULL, sizeof(zbx_dc_trigger_t));
+	memset(tr, 0, sizeof(zbx_dc_trigger_t));
+
+	tr->triggerid = triggerid;
+	tr->value = TRIGGER_VALUE_OK;
+	tr->recovery_mode = TRIGGER_RECOVERY_MODE_EXPRESSION;
+	tr->flags = ZBX_DC_TRIGGER_PROBLEM_EXPRESSION;
+
+	if (ZBX_MOCK_SUCCESS != zbx_strtime_to_timespec(mock->time, &tr->timespec))
+		fail_msg("Invalid trigger time format: %s", mock->time);
+
+	tr->eval_ctx = (zbx_eval_context_t *)zbx_malloc(NULL, sizeof(zbx_eval_context_t));
+
+	if (SUCCEED != zbx_eval_parse_expression(tr->eval_ctx, mock->expression, ZBX_EVAL_TRIGGER_EXPRESSION,
+			&error))
+	{
+		fail_msg("Cannot parse expression \"%s\": %s", mock->expression, error);
+	}
+
+	return tr;
+}
+
+static void	mock_trigger_free(zbx_dc_trigger_t *tr)
+{
+	zbx_eval_clear(tr->eval_ctx);
+	zbx_free(tr->eval_ctx);
+	zbx_free(tr->new_error);
+	zbx_free(tr);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_mock_handle_t	htriggers, htrigger;
+	zbx_mock_error_t	err;
+	zbx_vector_dc_trigger_t	triggers;
+	mock_trigger_t		*mocks = NULL;
+	int			i, j, repeat, mocks_num = 0, mocks_alloc = 0;
+
+	ZBX_UNUSED(state);
+
+	if (0 != setenv("TZ", zbx_mock_get_parameter_string("in.timezone"), 1))
+		fail_msg("Cannot set 'TZ' environment variable: %s", zbx_strerror(errno));
+
+	htriggers = zbx_mock_get_parameter_handle("in.triggers");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(htriggers, &htrigger))))
+	{
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read trigger: %s", zbx_mock_error_string(err));
+
+		if (mocks_num == mocks_alloc)
+		{
+			mocks_alloc += 8;
+			mocks = (mock_trigger_t *)zbx_realloc(mocks, sizeof(mock_trigger_t) * (size_t)mocks_alloc);
+		}
+
+		mocks[mocks_num].expression = zbx_mock_get_object_member_string(htrigger, "expression");
+		mocks[mocks_num].time = zbx_mock_get_object_member_string(htrigger, "time");
+		mocks[mocks_num].value = mock_str_to_trigger_value(zbx_mock_get_object_member_string(htrigger,
+				"value"));
+		mocks_num++;
+	}
+
+	zbx_vector_dc_trigger_create(&triggers);
+
+	/* interleave triggers evaluated at different times, so threads evaluate them concurrently */
+	repeat = (int)zbx_mock_get_parameter_uint64("in.repeat");
+
+	for (i = 0; i < repeat; i++)
+	{
+		for (j = 0; j < mocks_num; j++)
+		{
+			zbx_vector_dc_trigger_append(&triggers, mock_trigger_create(&mocks[j],
+					(zbx_uint64_t)triggers.values_num + 1));
+		}
+	}
+
+	zbx_set_trigger_eval_threads((int)zbx_mock_get_parameter_uint64("in.threads"));
+	evaluate_triggers(&triggers);
+
+	if (NULL == trigger_eval_pool)
+		fail_msg("triggers were not evaluated by evaluation threads");
+
+	for (i = 0; i < triggers.values_num; i++)
+	{
+		zbx_dc_trigger_t	*tr = triggers.values[i];
+
+		if (NULL != tr->new_error)
+			fail_msg("trigger " ZBX_FS_UI64 " evaluation failed: %s", tr->triggerid, tr->new_error);
+
+		zbx_mock_assert_int_eq("trigger value", mocks[i % mocks_num].value, tr->new_value);
+	}
+
+	for (i = 0; i < triggers.values_num; i++)
+		mock_trigger_free(triggers.values[i]);
+
+	zbx_vector_dc_trigger_destroy(&triggers);
+	zbx_free(mocks);
+}
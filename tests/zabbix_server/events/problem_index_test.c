@@ -0,0 +1,291 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+#include "zbxmockdata.h"
+#include "zbxmockdb.h"
+
+#include "zbxmutexs.h"
+
+#include "../../../src/zabbix_server/events/problem_index.c"
+
+static void	mock_read_eventids(zbx_mock_handle_t handle, zbx_vector_uint64_t *eventids)
+{
+	zbx_mock_handle_t	helement;
+	zbx_mock_error_t	err;
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(handle, &helement))))
+	{
+		zbx_uint64_t	eventid;
+
+		if (ZBX_MOCK_SUCCESS != err || ZBX_MOCK_SUCCESS != (err = zbx_mock_uint64(helement, &eventid)))
+			fail_msg("Cannot read event identifier: %s", zbx_mock_error_string(err));
+
+		zbx_vector_uint64_append(eventids, eventid);
+	}
+
+	zbx_vector_uint64_sort(eventids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+}
+
+static void	mock_read_tags(zbx_mock_handle_t handle, zbx_vector_tags_ptr_t *tags)
+{
+	zbx_mock_handle_t	htags, htag;
+	zbx_mock_error_t	err;
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_object_member(handle, "tags", &htags))
+		return;
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(htags, &htag))))
+	{
+		zbx_tag_t	*tag;
+
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read problem tag: %s", zbx_mock_error_string(err));
+
+		tag = (zbx_tag_t *)zbx_malloc(NULL, sizeof(zbx_tag_t));
+		tag->tag = zbx_strdup(NULL, zbx_mock_get_object_member_string(htag, "tag"));
+		tag->value = zbx_strdup(NULL, zbx_mock_get_object_member_string(htag, "value"));
+		zbx_vector_tags_ptr_append(tags, tag);
+	}
+}
+
+static unsigned char	mock_str_to_operator(const char *str)
+{
+	if (0 == strcmp(str, "equal"))
+		return ZBX_CONDITION_OPERATOR_EQUAL;
+
+	if (0 == strcmp(str, "like"))
+		return ZBX_CONDITION_OPERATOR_LIKE;
+
+	if (0 == strcmp(str, "exist"))
+		return ZBX_CONDITION_OPERATOR_EXIST;
+
+	fail_msg("Unknown tag filter operator: %s", str);
+
+	return ZBX_CONDITION_OPERATOR_EQUAL;
+}
+
+static void	mock_add_problems(zbx_mock_handle_t hstep)
+{
+	zbx_mock_handle_t	hproblems, hproblem;
+	zbx_mock_error_t	err;
+	zbx_vector_ptr_t	events;
+
+	zbx_vector_ptr_create(&events);
+
+	hproblems = zbx_mock_get_object_member_handle(hstep, "problems");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hproblems, &hproblem))))
+	{
+		zbx_db_event	*event;
+
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read problem: %s", zbx_mock_error_string(err));
+
+		event = (zbx_db_event *)zbx_malloc(NULL, sizeof(zbx_db_event));
+		memset(event, 0, sizeof(zbx_db_event));
+
+		event->eventid = zbx_mock_get_object_member_uint64(hproblem, "eventid");
+		event->objectid = zbx_mock_get_object_member_uint64(hproblem, "triggerid");
+		event->source = EVENT_SOURCE_TRIGGERS;
+		event->object = EVENT_OBJECT_TRIGGER;
+		zbx_vector_tags_ptr_create(&event->tags);
+		mock_read_tags(hproblem, &event->tags);
+
+		zbx_vector_ptr_append(&events, event);
+	}
+
+	problem_index_add_problems(&events);
+
+	for (int i = 0; i < events.values_num; i++)
+	{
+		zbx_db_event	*event = (zbx_db_event *)events.values[i];
+
+		zbx_vector_tags_ptr_clear_ext(&event->tags, zbx_free_tag);
+		zbx_vector_tags_ptr_destroy(&event->tags);
+		zbx_free(event);
+	}
+
+	zbx_vector_ptr_destroy(&events);
+}
+
+static void	mock_remove_problems(zbx_mock_handle_t hstep)
+{
+	zbx_vector_uint64_t	eventids;
+
+	zbx_vector_uint64_create(&eventids);
+	mock_read_eventids(zbx_mock_get_object_member_handle(hstep, "eventids"), &eventids);
+
+	zbx_problem_index_remove(&eventids);
+
+	zbx_vector_uint64_destroy(&eventids);
+}
+
+static void	mock_match_problems(zbx_mock_handle_t hstep)
+{
+	zbx_mock_handle_t			hfilters, hfilter;
+	zbx_mock_error_t			err;
+	zbx_vector_problem_tag_filter_t		filters;
+	zbx_vector_ptr_t			problems;
+	zbx_vector_uint64_t			eventids, returned_eventids;
+	int					ret, expected_ret;
+
+	zbx_vector_problem_tag_filter_create(&filters);
+	zbx_vector_ptr_create(&problems);
+	zbx_vector_uint64_create(&eventids);
+	zbx_vector_uint64_create(&returned_eventids);
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hstep, "filters", &hfilters))
+	{
+		while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hfilters, &hfilter))))
+		{
+			zbx_problem_tag_filter_t	filter;
+
+			if (ZBX_MOCK_SUCCESS != err)
+				fail_msg("Cannot read tag filter: %s", zbx_mock_error_string(err));
+
+			filter.tag = zbx_mock_get_object_member_string(hfilter, "tag");
+			filter.op = mock_str_to_operator(zbx_mock_get_object_member_string(hfilter, "operator"));
+			filter.value = (ZBX_CONDITION_OPERATOR_EXIST == filter.op ? NULL :
+					zbx_mock_get_object_member_string(hfilter, "value"));
+
+			zbx_vector_problem_tag_filter_append(&filters, filter);
+		}
+	}
+
+	ret = problem_index_get_problems(0 != filters.values_num ? &filters : NULL, &problems);
+	expected_ret = zbx_mock_str_to_return_code(zbx_mock_get_object_member_string(hstep, "result"));
+	zbx_mock_assert_result_eq("problem_index_get_problems() return value", expected_ret, ret);
+
+	if (SUCCEED == ret)
+	{
+		for (int i = 0; i < problems.values_num; i++)
+		{
+			zbx_vector_uint64_append(&returned_eventids,
+					((const zbx_event_problem_t *)problems.values[i])->eventid);
+		}
+
+		mock_read_eventids(zbx_mock_get_object_member_handle(hstep, "eventids"), &eventids);
+		zbx_mock_assert_vector_uint64_eq("matched problems", &eventids, &returned_eventids);
+	}
+
+	zbx_vector_uint64_destroy(&returned_eventids);
+	zbx_vector_uint64_destroy(&eventids);
+	zbx_vector_ptr_clear_ext(&problems, (zbx_clean_func_t)event_problem_free);
+	zbx_vector_ptr_destroy(&problems);
+	zbx_vector_problem_tag_filter_destroy(&filters);
+}
+
+static void	mock_sync(zbx_mock_handle_t hstep)
+{
+	int	ret, expected_ret, problems_num = 0;
+
+	/* force index reload */
+	problem_index->sync_time = 0;
+
+	ret = problem_index_sync(&problems_num);
+	expected_ret = zbx_mock_str_to_return_code(zbx_mock_get_object_member_string(hstep, "result"));
+	zbx_mock_assert_result_eq("problem_index_sync() return value", expected_ret, ret);
+
+	if (SUCCEED == ret)
+	{
+		zbx_mock_assert_int_eq("indexed problems", zbx_mock_get_object_member_int(hstep, "problems"),
+				problems_num);
+	}
+}
+
+static void	mock_check_index(zbx_mock_handle_t hstep)
+{
+	zbx_vector_uint64_t	eventids, indexed_eventids;
+	zbx_hashset_iter_t	iter;
+	zbx_pi_problem_t	*problem;
+
+	zbx_vector_uint64_create(&eventids);
+	zbx_vector_uint64_create(&indexed_eventids);
+
+	zbx_hashset_iter_reset(&problem_index->problems, &iter);
+	while (NULL != (problem = (zbx_pi_problem_t *)zbx_hashset_iter_next(&iter)))
+		zbx_vector_uint64_append(&indexed_eventids, problem->eventid);
+
+	zbx_vector_uint64_sort(&indexed_eventids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	mock_read_eventids(zbx_mock_get_object_member_handle(hstep, "eventids"), &eventids);
+	zbx_mock_assert_vector_uint64_eq("indexed problems", &eventids, &indexed_eventids);
+
+	zbx_vector_uint64_destroy(&indexed_eventids);
+	zbx_vector_uint64_destroy(&eventids);
+}
+
+static void	mock_age_problems(void)
+{
+	zbx_hashset_iter_t	iter;
+	zbx_pi_problem_t	*problem;
+
+	zbx_hashset_iter_reset(&problem_index->problems, &iter);
+	while (NULL != (problem = (zbx_pi_problem_t *)zbx_hashset_iter_next(&iter)))
+		problem->lastupdate -= PROBLEM_INDEX_SYNC_DELAY + 1;
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_mock_handle_t	hsteps, hstep;
+	zbx_mock_error_t	err;
+	char			*error = NULL;
+
+	ZBX_UNUSED(state);
+
+	if (SUCCEED != zbx_locks_create(&error))
+		fail_msg("cannot create locks: %s", error);
+
+	if (SUCCEED != zbx_problem_index_init(ZBX_MEBIBYTE, &error))
+		fail_msg("cannot initialize problem index: %s", error);
+
+	zbx_mockdb_init();
+
+	hsteps = zbx_mock_get_parameter_handle("in.steps");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hsteps, &hstep))))
+	{
+		const char	*action;
+
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read test step: %s", zbx_mock_error_string(err));
+
+		action = zbx_mock_get_object_member_string(hstep, "action");
+
+		if (0 == strcmp(action, "sync"))
+			mock_sync(hstep);
+		else if (0 == strcmp(action, "add"))
+			mock_add_problems(hstep);
+		else if (0 == strcmp(action, "remove"))
+			mock_remove_problems(hstep);
+		else if (0 == strcmp(action, "match"))
+			mock_match_problems(hstep);
+		else if (0 == strcmp(action, "check"))
+			mock_check_index(hstep);
+		else if (0 == strcmp(action, "age"))
+			mock_age_problems();
+		else if (0 == strcmp(action, "begin load"))
+			problem_index->loading = 1;
+		else if (0 == strcmp(action, "end load"))
+			pi_load((int)time(NULL));
+		else
+			fail_msg("Unknown test step action: %s", action);
+	}
+
+	zbx_mockdb_destroy();
+	zbx_problem_index_destroy();
+}